@@ -0,0 +1,364 @@
+#include "bus_i2c.h"
+
+#include <stm32wbxx_ll_i2c.h>
+#include <stm32wbxx_ll_system.h>
+
+/**
+ * The clocks the external I2C peripheral can make from its 64 MHz kernel clock, fastest first;
+ * with the timings that make them, as ST's tools work them out for standard rise times.
+ */
+static const struct {
+    uint32_t speed;
+    uint32_t timing;
+} pirate_i2c_rates[] = {
+    {1000, 0x00300B29},
+    {400, 0x00602173},
+    {100, 0x10707DBC},
+};
+
+/** Anything faster than this is Fast-mode Plus, which needs the pins' stronger drive. */
+#define PIRATE_I2C_FAST_MODE_MAX 400
+
+/** Finds the fastest of our rates that doesn't exceed the one asked for; or COUNT_OF(pirate_i2c_rates), if none. */
+static size_t pirate_i2c_rate_for(uint32_t kilohertz) {
+    for(size_t i = 0; i < COUNT_OF(pirate_i2c_rates); ++i) {
+        if(pirate_i2c_rates[i].speed <= kilohertz) {
+            return i;
+        }
+    }
+
+    return COUNT_OF(pirate_i2c_rates);
+}
+
+/** Loads a clock into the peripheral; which has to be stopped while it changes, so only between transactions. */
+static void pirate_i2c_apply_speed(PirateI2cBus* i2c, uint32_t kilohertz) {
+    I2C_TypeDef* peripheral = i2c->handle->bus->i2c;
+    size_t rate = pirate_i2c_rate_for(kilohertz);
+
+    furi_check(rate < COUNT_OF(pirate_i2c_rates));
+
+    LL_I2C_Disable(peripheral);
+    LL_I2C_SetTiming(peripheral, pirate_i2c_rates[rate].timing);
+    LL_I2C_Enable(peripheral);
+
+    // The external bus is I2C3's; only its pins' drive is ours to change.
+    if(pirate_i2c_rates[rate].speed > PIRATE_I2C_FAST_MODE_MAX) {
+        LL_SYSCFG_EnableFastModePlus(LL_SYSCFG_I2C_FASTMODEPLUS_I2C3);
+    } else {
+        LL_SYSCFG_DisableFastModePlus(LL_SYSCFG_I2C_FASTMODEPLUS_I2C3);
+    }
+
+    i2c->applied_speed = pirate_i2c_rates[rate].speed;
+}
+
+static void pirate_i2c_acquire(void* context) {
+    PirateI2cBus* i2c = context;
+
+    // Acquiring sets the peripheral up at the standard clock; and each run starts from there,
+    // so a command means the same thing every time.
+    furi_hal_i2c_acquire(i2c->handle);
+    i2c->speed = PIRATE_I2C_DEFAULT_SPEED;
+    i2c->applied_speed = PIRATE_I2C_DEFAULT_SPEED;
+}
+
+static void pirate_i2c_release(void* context) {
+    PirateI2cBus* i2c = context;
+
+    // Whoever has the bus next expects it at its usual drive strength.
+    LL_SYSCFG_DisableFastModePlus(LL_SYSCFG_I2C_FASTMODEPLUS_I2C3);
+    furi_hal_i2c_release(i2c->handle);
+}
+
+static bool pirate_i2c_set_speed(void* context, uint32_t kilohertz) {
+    PirateI2cBus* i2c = context;
+
+    // Zero asks for each device's fastest; which we'll work out as we meet them.
+    if(kilohertz == 0) {
+        i2c->speed = 0;
+        return true;
+    }
+
+    size_t rate = pirate_i2c_rate_for(kilohertz);
+    if(rate == COUNT_OF(pirate_i2c_rates)) {
+        return false;
+    }
+
+    i2c->speed = pirate_i2c_rates[rate].speed;
+    return true;
+}
+
+/**
+ * Reads the probe's window: the transaction's own register pointer written, then a repeated
+ * start, and a read.
+ */
+static bool pirate_i2c_probe_read(
+    PirateI2cBus* i2c,
+    uint8_t address,
+    const uint8_t* pointer,
+    size_t pointer_length,
+    uint8_t* data) {
+    return furi_hal_i2c_tx_ext(
+               i2c->handle,
+               address,
+               false,
+               pointer,
+               pointer_length,
+               FuriHalI2cBeginStart,
+               FuriHalI2cEndAwaitRestart,
+               PIRATE_I2C_TIMEOUT) &&
+           furi_hal_i2c_rx_ext(
+               i2c->handle,
+               address | 1,
+               false,
+               data,
+               PIRATE_I2C_PROBE_LENGTH,
+               FuriHalI2cBeginRestart,
+               FuriHalI2cEndStop,
+               PIRATE_I2C_TIMEOUT);
+}
+
+/**
+ * Works out the fastest clock a device reads back reliably at; see PirateI2cBus. Returns zero
+ * if the device didn't answer at all, so there's nothing to remember about it.
+ */
+static uint32_t pirate_i2c_probe(
+    PirateI2cBus* i2c,
+    uint8_t address,
+    const uint8_t* pointer,
+    size_t pointer_length) {
+    uint8_t reference[PIRATE_I2C_PROBE_LENGTH];
+    uint8_t readback[PIRATE_I2C_PROBE_LENGTH];
+    uint32_t fastest = PIRATE_I2C_DEFAULT_SPEED;
+
+    i2c->probes += 1;
+    pirate_i2c_apply_speed(i2c, PIRATE_I2C_DEFAULT_SPEED);
+
+    if(!pirate_i2c_probe_read(i2c, address, pointer, pointer_length, reference)) {
+        return 0;
+    }
+
+    // Registers that are still changing -- a counter, a conversion in progress -- prove nothing;
+    // the window has to read the same twice running to count.
+    bool settled = false;
+    for(size_t i = 0; (i < PIRATE_I2C_PROBE_SETTLE) && !settled; ++i) {
+        memcpy(readback, reference, sizeof(reference));
+        if(!pirate_i2c_probe_read(i2c, address, pointer, pointer_length, reference)) {
+            return fastest;
+        }
+        settled = (memcmp(readback, reference, sizeof(reference)) == 0);
+    }
+
+    // All ones is what a device that isn't driving the line at all reads as; which proves nothing.
+    bool blank = true;
+    for(size_t i = 0; i < sizeof(reference); ++i) {
+        blank = blank && (reference[i] == 0xFF);
+    }
+    if(!settled || blank) {
+        return fastest;
+    }
+
+    // Try each faster clock in turn, slowest first, until one lets us down.
+    for(size_t rate = COUNT_OF(pirate_i2c_rates) - 1; rate-- > 0;) {
+        pirate_i2c_apply_speed(i2c, pirate_i2c_rates[rate].speed);
+
+        for(size_t pass = 0; pass < PIRATE_I2C_PROBE_PASSES; ++pass) {
+            if(!pirate_i2c_probe_read(i2c, address, pointer, pointer_length, readback) ||
+               (memcmp(readback, reference, sizeof(reference)) != 0)) {
+                return fastest;
+            }
+        }
+
+        fastest = pirate_i2c_rates[rate].speed;
+    }
+
+    return fastest;
+}
+
+/**
+ * Under '@0', probes the device a transaction is about to address, if it's yet to be probed
+ * and the transaction opens by setting its register pointer; before the transaction's timed.
+ */
+static void pirate_i2c_prepare_transaction(
+    void* context,
+    const uint8_t* data,
+    size_t length,
+    PirateBusNext next) {
+    PirateI2cBus* i2c = context;
+
+    if((i2c->speed != 0) || (data[0] & 1)) {
+        return;
+    }
+
+    // Anything else -- a write of data, a bare read, an address on its own -- we can't read back
+    // without writing something the user didn't; so it just runs at the standard clock.
+    size_t pointer_length = length - 1;
+    if((next != PirateBusNextRestart) || (pointer_length == 0) ||
+       (pointer_length > PIRATE_I2C_PROBE_POINTER_MAX)) {
+        return;
+    }
+
+    uint16_t* known = &i2c->speeds->speeds[(data[0] >> 1) & 0x7F];
+    if(*known == 0) {
+        *known = pirate_i2c_probe(i2c, data[0], &data[1], pointer_length);
+    }
+}
+
+/**
+ * Sets the clock for the transfer about to begin, if it begins a transaction; mid-transaction,
+ * the clock has to stay as it is.
+ */
+static void pirate_i2c_prepare(PirateI2cBus* i2c) {
+    uint32_t speed = i2c->speed;
+
+    if(i2c->begin != FuriHalI2cBeginStart) {
+        return;
+    }
+
+    // Under '@0', devices that have been probed run at the fastest they were found to handle.
+    if(speed == 0) {
+        uint16_t known = i2c->speeds->speeds[(i2c->address >> 1) & 0x7F];
+        speed = known ? known : PIRATE_I2C_DEFAULT_SPEED;
+    }
+
+    if(speed != i2c->applied_speed) {
+        pirate_i2c_apply_speed(i2c, speed);
+    }
+}
+
+/** Translates what follows a transfer into how the HAL should end it. */
+static FuriHalI2cEnd pirate_i2c_end_for(PirateBusNext next) {
+    switch(next) {
+    case PirateBusNextContinue:
+        return FuriHalI2cEndPause;
+    case PirateBusNextRestart:
+        return FuriHalI2cEndAwaitRestart;
+    default:
+        return FuriHalI2cEndStop;
+    }
+}
+
+/** Works out how the transfer after this one will need to begin. */
+static FuriHalI2cBegin pirate_i2c_begin_after(FuriHalI2cEnd end) {
+    switch(end) {
+    case FuriHalI2cEndPause:
+        return FuriHalI2cBeginResume;
+    case FuriHalI2cEndAwaitRestart:
+        return FuriHalI2cBeginRestart;
+    default:
+        return FuriHalI2cBeginStart;
+    }
+}
+
+static bool pirate_i2c_start(void* context) {
+    PirateI2cBus* i2c = context;
+
+    // If the last transfer left the bus awaiting a restart, i2c->begin already says so.
+    i2c->have_address = false;
+    i2c->transferred = false;
+    if(i2c->begin == FuriHalI2cBeginResume) {
+        i2c->begin = FuriHalI2cBeginStart;
+    }
+
+    return true;
+}
+
+static bool pirate_i2c_stop(void* context) {
+    PirateI2cBus* i2c = context;
+    bool acked = true;
+
+    // An address with no data -- e.g. "[0xA0]" -- is a probe; we still owe the device a start and stop.
+    if(i2c->have_address && !i2c->transferred) {
+        pirate_i2c_prepare(i2c);
+        acked = furi_hal_i2c_is_device_ready(i2c->handle, i2c->address, PIRATE_I2C_TIMEOUT);
+    }
+
+    i2c->have_address = false;
+    i2c->transferred = false;
+    i2c->begin = FuriHalI2cBeginStart;
+    return acked;
+}
+
+static bool pirate_i2c_write(void* context, const uint8_t* data, size_t length, PirateBusNext next) {
+    PirateI2cBus* i2c = context;
+
+    // The first byte of each transaction is the address.
+    if(!i2c->have_address) {
+        i2c->address = data[0];
+        i2c->have_address = true;
+        data += 1;
+        length -= 1;
+
+        // The address is sent along with whatever transfer follows it.
+        if(length == 0) {
+            return true;
+        }
+    }
+
+    // We can't write to a read address.
+    if(i2c->address & 1) {
+        return false;
+    }
+
+    pirate_i2c_prepare(i2c);
+
+    FuriHalI2cEnd end = pirate_i2c_end_for(next);
+    bool acked = furi_hal_i2c_tx_ext(
+        i2c->handle, i2c->address, false, data, length, i2c->begin, end, PIRATE_I2C_TIMEOUT);
+
+    i2c->begin = pirate_i2c_begin_after(end);
+    i2c->transferred = true;
+    return acked;
+}
+
+static bool pirate_i2c_read(void* context, uint8_t* data, size_t length, PirateBusNext next) {
+    PirateI2cBus* i2c = context;
+
+    if(!i2c->have_address) {
+        return false;
+    }
+
+    // Reading against a write address means the user wants us to turn the bus around;
+    // the write that preceded us has already ended awaiting that restart.
+    pirate_i2c_prepare(i2c);
+
+    FuriHalI2cEnd end = pirate_i2c_end_for(next);
+    bool acked = furi_hal_i2c_rx_ext(
+        i2c->handle, i2c->address | 1, false, data, length, i2c->begin, end, PIRATE_I2C_TIMEOUT);
+
+    i2c->begin = pirate_i2c_begin_after(end);
+    i2c->transferred = true;
+    return acked;
+}
+
+static void pirate_i2c_delay_us(void* context, uint32_t microseconds) {
+    UNUSED(context);
+    furi_delay_us(microseconds);
+}
+
+void pirate_i2c_bus_init(
+    PirateBus* bus,
+    PirateI2cBus* i2c,
+    FuriHalI2cBusHandle* handle,
+    PirateI2cSpeedCache* speeds) {
+    furi_assert(speeds);
+
+    i2c->handle = handle;
+    i2c->have_address = false;
+    i2c->transferred = false;
+    i2c->begin = FuriHalI2cBeginStart;
+    i2c->speed = PIRATE_I2C_DEFAULT_SPEED;
+    i2c->applied_speed = PIRATE_I2C_DEFAULT_SPEED;
+    i2c->speeds = speeds;
+    i2c->probes = 0;
+
+    bus->acquire = pirate_i2c_acquire;
+    bus->release = pirate_i2c_release;
+    bus->prepare = pirate_i2c_prepare_transaction;
+    bus->start = pirate_i2c_start;
+    bus->stop = pirate_i2c_stop;
+    bus->write = pirate_i2c_write;
+    bus->read = pirate_i2c_read;
+    bus->delay_us = pirate_i2c_delay_us;
+    bus->set_speed = pirate_i2c_set_speed;
+    bus->context = i2c;
+}
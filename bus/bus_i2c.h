@@ -0,0 +1,82 @@
+#pragma once
+
+#include <furi_hal.h>
+
+#include "../lib/libpirate.h"
+
+/** Time we'll wait on any single I2C transfer, in milliseconds. */
+#define PIRATE_I2C_TIMEOUT 100
+
+/** The clock each run starts out at, in kHz; the others are 400 kHz, and Fast-mode Plus's 1 MHz. */
+#define PIRATE_I2C_DEFAULT_SPEED 100
+
+/** Bytes in the window the speed probe reads back; and how many times it must match, per clock. */
+#define PIRATE_I2C_PROBE_LENGTH 16
+#define PIRATE_I2C_PROBE_PASSES 4
+
+/** The longest register pointer the probe will write back; enough for 16-bit word addresses. */
+#define PIRATE_I2C_PROBE_POINTER_MAX 2
+
+/** Reads the probe makes at the standard clock, looking for the window to hold still. */
+#define PIRATE_I2C_PROBE_SETTLE 3
+
+/**
+ * The fastest clock each device has been found to handle, by 7-bit address, in kHz; zero if it's
+ * yet to be probed. Kept for as long as the app runs, so each device is only probed once.
+ */
+typedef struct {
+    uint16_t speeds[128];
+} PirateI2cSpeedCache;
+
+/**
+ * State for executing programs against an I2C bus.
+ *
+ * The first byte written after each '[' is the device address, in its 8-bit (shifted) form.
+ * Reads issued against a write address turn the bus around with a repeated start, so a
+ * register read can be written as "[0xA0 0x00 r:16]".
+ *
+ * '@100', '@400' and '@1000' set the clock for what follows, from the next transaction on;
+ * '@0' runs each device at the fastest it's been found to handle. A device is probed by the
+ * first transaction under '@0' that opens by setting its register pointer -- "[0xA0 0x00 r]"
+ * does; "[0xA0 0x00 0x55]" and "[0xA1 r]" don't -- before the transaction starts, or is timed.
+ * The probe writes that same pointer, of up to two bytes, and reads 16 bytes back, at 100 kHz
+ * until they read the same twice running, and then four times at each faster clock in turn.
+ * The fastest clock at which every read matched is the device's; a device whose registers read
+ * back as all ones, as an idle bus does, stays at 100 kHz. So the probe writes nothing the
+ * transaction wasn't going to; until a device has been probed, it runs at 100 kHz.
+ */
+typedef struct {
+    FuriHalI2cBusHandle* handle;
+
+    /** The address of the current transaction, if we've seen one. */
+    uint8_t address;
+    bool have_address;
+
+    /** True once anything has actually been sent to the current address. */
+    bool transferred;
+
+    /** How the next transfer needs to begin, given how the last one ended. */
+    FuriHalI2cBegin begin;
+
+    /** The clock asked for, in kHz, or zero for each device's fastest; and the one we're running at. */
+    uint32_t speed;
+    uint32_t applied_speed;
+
+    /** Where '@0' remembers each device's fastest clock; and how many devices it's probed. */
+    PirateI2cSpeedCache* speeds;
+    uint32_t probes;
+} PirateI2cBus;
+
+/**
+ * Sets up a PirateBus that talks to I2C via the given handle.
+ *
+ * @param bus       The bus to populate.
+ * @param i2c       Storage for the bus's state; must outlive the bus.
+ * @param handle    The I2C handle to use; typically &furi_hal_i2c_handle_external.
+ * @param speeds    Where '@0' keeps what it's learned, from one run to the next; must outlive the bus.
+ */
+void pirate_i2c_bus_init(
+    PirateBus* bus,
+    PirateI2cBus* i2c,
+    FuriHalI2cBusHandle* handle,
+    PirateI2cSpeedCache* speeds);
@@ -0,0 +1,134 @@
+#include "bus_i2c_bitbang.h"
+
+/** Waits out half a clock period. */
+static inline void pirate_i2c_bitbang_delay(PirateI2cBitbang* i2c) {
+    uint32_t start = DWT->CYCCNT;
+
+    while(DWT->CYCCNT - start < i2c->half_period) {
+    }
+}
+
+/** Lines are open drain: high just lets go, and leaves the pull-ups to do the rest. */
+static inline void pirate_i2c_bitbang_sda(bool level) {
+    furi_hal_gpio_write(PIRATE_I2C_BITBANG_SDA, level);
+}
+
+static inline void pirate_i2c_bitbang_scl_low(void) {
+    furi_hal_gpio_write(PIRATE_I2C_BITBANG_SCL, false);
+}
+
+/** Lets the clock go high; a slow device may hold it low until it's ready. */
+static void pirate_i2c_bitbang_scl_release(PirateI2cBitbang* i2c) {
+    uint32_t start = DWT->CYCCNT;
+    uint32_t timeout = PIRATE_I2C_BITBANG_STRETCH_TIMEOUT * furi_hal_cortex_instructions_per_microsecond();
+
+    furi_hal_gpio_write(PIRATE_I2C_BITBANG_SCL, true);
+    while(!furi_hal_gpio_read(PIRATE_I2C_BITBANG_SCL) && (DWT->CYCCNT - start < timeout)) {
+    }
+
+    pirate_i2c_bitbang_delay(i2c);
+}
+
+/** Clocks one bit out; SCL is low on entry and on exit. */
+static void pirate_i2c_bitbang_write_bit(PirateI2cBitbang* i2c, bool bit) {
+    pirate_i2c_bitbang_sda(bit);
+    pirate_i2c_bitbang_delay(i2c);
+    pirate_i2c_bitbang_scl_release(i2c);
+    pirate_i2c_bitbang_scl_low();
+}
+
+/** Clocks one bit in, sampled at the middle of the clock's high time. */
+static bool pirate_i2c_bitbang_read_bit(PirateI2cBitbang* i2c) {
+    pirate_i2c_bitbang_sda(true);
+    pirate_i2c_bitbang_delay(i2c);
+    pirate_i2c_bitbang_scl_release(i2c);
+
+    bool bit = furi_hal_gpio_read(PIRATE_I2C_BITBANG_SDA);
+    pirate_i2c_bitbang_scl_low();
+    return bit;
+}
+
+static void pirate_i2c_bitbang_configure_pins(PirateI2cBitbang* i2c) {
+    GpioPull pull = i2c->pull_ups ? GpioPullUp : GpioPullNo;
+
+    furi_hal_gpio_init(PIRATE_I2C_BITBANG_SCL, GpioModeOutputOpenDrain, pull, GpioSpeedVeryHigh);
+    furi_hal_gpio_init(PIRATE_I2C_BITBANG_SDA, GpioModeOutputOpenDrain, pull, GpioSpeedVeryHigh);
+}
+
+void pirate_i2c_bitbang_init(PirateI2cBitbang* i2c, uint32_t kilohertz, bool pull_ups) {
+    // Acquiring hands the pins to the peripheral; we take them straight back.
+    furi_hal_i2c_acquire(&furi_hal_i2c_handle_external);
+
+    i2c->pull_ups = pull_ups;
+    pirate_i2c_bitbang_set_speed(i2c, kilohertz);
+
+    furi_hal_gpio_write(PIRATE_I2C_BITBANG_SCL, true);
+    furi_hal_gpio_write(PIRATE_I2C_BITBANG_SDA, true);
+    pirate_i2c_bitbang_configure_pins(i2c);
+}
+
+void pirate_i2c_bitbang_deinit(PirateI2cBitbang* i2c) {
+    UNUSED(i2c);
+
+    furi_hal_gpio_write(PIRATE_I2C_BITBANG_SCL, true);
+    furi_hal_gpio_write(PIRATE_I2C_BITBANG_SDA, true);
+
+    // Releasing puts the pins back the way the HAL keeps them between transfers.
+    furi_hal_i2c_release(&furi_hal_i2c_handle_external);
+}
+
+void pirate_i2c_bitbang_set_speed(PirateI2cBitbang* i2c, uint32_t kilohertz) {
+    furi_check(kilohertz);
+
+    i2c->speed = kilohertz;
+    i2c->half_period = furi_hal_cortex_instructions_per_microsecond() * 1000 / (kilohertz * 2);
+}
+
+void pirate_i2c_bitbang_set_pull_ups(PirateI2cBitbang* i2c, bool pull_ups) {
+    i2c->pull_ups = pull_ups;
+    pirate_i2c_bitbang_configure_pins(i2c);
+}
+
+void pirate_i2c_bitbang_start(PirateI2cBitbang* i2c) {
+    // Mid-transaction, SCL is low; so SDA has to be let go first, or raising SCL would be a stop.
+    pirate_i2c_bitbang_sda(true);
+    pirate_i2c_bitbang_delay(i2c);
+    pirate_i2c_bitbang_scl_release(i2c);
+
+    pirate_i2c_bitbang_sda(false);
+    pirate_i2c_bitbang_delay(i2c);
+    pirate_i2c_bitbang_scl_low();
+}
+
+void pirate_i2c_bitbang_stop(PirateI2cBitbang* i2c) {
+    pirate_i2c_bitbang_scl_low();
+    pirate_i2c_bitbang_sda(false);
+    pirate_i2c_bitbang_delay(i2c);
+    pirate_i2c_bitbang_scl_release(i2c);
+
+    pirate_i2c_bitbang_sda(true);
+    pirate_i2c_bitbang_delay(i2c);
+}
+
+bool pirate_i2c_bitbang_write(PirateI2cBitbang* i2c, uint8_t data) {
+    for(uint8_t mask = 0x80; mask; mask >>= 1) {
+        pirate_i2c_bitbang_write_bit(i2c, data & mask);
+    }
+
+    // The device acknowledges by holding SDA low through the ninth clock.
+    return !pirate_i2c_bitbang_read_bit(i2c);
+}
+
+uint8_t pirate_i2c_bitbang_read(PirateI2cBitbang* i2c) {
+    uint8_t data = 0;
+
+    for(int bit = 0; bit < 8; ++bit) {
+        data = (data << 1) | pirate_i2c_bitbang_read_bit(i2c);
+    }
+
+    return data;
+}
+
+void pirate_i2c_bitbang_ack(PirateI2cBitbang* i2c, bool ack) {
+    pirate_i2c_bitbang_write_bit(i2c, !ack);
+}
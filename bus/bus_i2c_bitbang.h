@@ -0,0 +1,52 @@
+#pragma once
+
+#include <furi_hal.h>
+
+/** The external bus' pins; the same ones the I2C peripheral drives. */
+#define PIRATE_I2C_BITBANG_SCL (&gpio_ext_pc0)
+#define PIRATE_I2C_BITBANG_SDA (&gpio_ext_pc1)
+
+/** Longest we'll let a device stretch the clock, in microseconds, before carrying on regardless. */
+#define PIRATE_I2C_BITBANG_STRETCH_TIMEOUT 10000
+
+/**
+ * Byte-level I2C, bit-banged on the external bus' pins.
+ *
+ * The I2C peripheral works in whole transfers, and decides how each ends before it begins;
+ * this leaves every condition, byte and acknowledge bit to the caller, one at a time, as raw
+ * protocols like the Bus Pirate's expect. Both lines are open drain; devices may stretch the
+ * clock.
+ */
+typedef struct {
+    /** The clock we're running at, in kHz; and half its period, in CPU cycles. */
+    uint32_t speed;
+    uint32_t half_period;
+
+    /** Whether the pins' internal pull-ups are on; the header has none of its own. */
+    bool pull_ups;
+} PirateI2cBitbang;
+
+/**
+ * Takes over the external bus' pins, leaving both lines released. The I2C peripheral's lock
+ * is held until pirate_i2c_bitbang_deinit(), so nothing else can start a transfer underneath us.
+ */
+void pirate_i2c_bitbang_init(PirateI2cBitbang* i2c, uint32_t kilohertz, bool pull_ups);
+
+/** Releases both lines, and hands the pins back. */
+void pirate_i2c_bitbang_deinit(PirateI2cBitbang* i2c);
+
+void pirate_i2c_bitbang_set_speed(PirateI2cBitbang* i2c, uint32_t kilohertz);
+void pirate_i2c_bitbang_set_pull_ups(PirateI2cBitbang* i2c, bool pull_ups);
+
+/** Sends a start condition; or a repeated start, mid-transaction. */
+void pirate_i2c_bitbang_start(PirateI2cBitbang* i2c);
+void pirate_i2c_bitbang_stop(PirateI2cBitbang* i2c);
+
+/** Clocks out a byte, and returns whether it was acknowledged. */
+bool pirate_i2c_bitbang_write(PirateI2cBitbang* i2c, uint8_t data);
+
+/** Clocks in a byte. The acknowledge bit is left for pirate_i2c_bitbang_ack() to send. */
+uint8_t pirate_i2c_bitbang_read(PirateI2cBitbang* i2c);
+
+/** Sends the acknowledge bit after a read: an ACK asks for more, a NACK ends the read. */
+void pirate_i2c_bitbang_ack(PirateI2cBitbang* i2c, bool ack);
@@ -0,0 +1,329 @@
+#include "bus_onewire.h"
+
+#include <stm32wbxx_ll_dma.h>
+#include <stm32wbxx_ll_tim.h>
+
+/** The timer's update DMA loads each slot's pulse; its capture DMA stores each slot's edge. */
+#define PIRATE_ONEWIRE_DMA DMA2
+#define PIRATE_ONEWIRE_DMA_PULSES LL_DMA_CHANNEL_5
+#define PIRATE_ONEWIRE_DMA_EDGES LL_DMA_CHANNEL_6
+#define PIRATE_ONEWIRE_DMA_IRQ FuriHalInterruptIdDma2Ch5
+
+/** Most edges a reset slot can make that we care about: our own release, and the end of a presence pulse. */
+#define PIRATE_ONEWIRE_RESET_EDGES 2
+
+/** The pulses' channel finishes as the slot after the last begins; which is an idle one, so we stop there. */
+static void pirate_onewire_dma_isr(void* context) {
+    PirateOneWireBus* onewire = context;
+
+    if(LL_DMA_IsActiveFlag_TC5(PIRATE_ONEWIRE_DMA)) {
+        LL_DMA_ClearFlag_TC5(PIRATE_ONEWIRE_DMA);
+
+        LL_TIM_DisableCounter(TIM2);
+        furi_thread_flags_set(onewire->waiter, PIRATE_ONEWIRE_FLAG_DONE);
+    }
+}
+
+/**
+ * Runs a burst of slots, whose pulses are already in onewire->pulses, and sleeps until it's over.
+ *
+ * @param count         Number of slots.
+ * @param slot_us       Length of each slot.
+ * @param max_edges     Most edges to capture.
+ * @return The number of edges captured; or zero if the burst never finished.
+ */
+static size_t pirate_onewire_burst(PirateOneWireBus* onewire, size_t count, uint32_t slot_us, size_t max_edges) {
+    furi_check(count && count <= PIRATE_ONEWIRE_BURST_SLOTS);
+    furi_check(max_edges <= PIRATE_ONEWIRE_BURST_SLOTS);
+
+    // End on idle slots, which hold the line low for no time at all.
+    onewire->pulses[count] = 0;
+    onewire->pulses[count + 1] = 0;
+    furi_thread_flags_clear(PIRATE_ONEWIRE_FLAG_DONE);
+
+    // The update loads the first slot's pulse straight away, and we queue up the second; from
+    // then on, each update starts a slot with the pulse queued, and the DMA queues the next.
+    LL_TIM_SetAutoReload(TIM2, slot_us - 1);
+    LL_TIM_OC_SetCompareCH2(TIM2, onewire->pulses[0]);
+    LL_TIM_GenerateEvent_UPDATE(TIM2);
+    LL_TIM_OC_SetCompareCH2(TIM2, onewire->pulses[1]);
+    LL_TIM_ClearFlag_UPDATE(TIM2);
+    LL_TIM_ClearFlag_CC1(TIM2);
+    LL_TIM_ClearFlag_CC1OVR(TIM2);
+
+    LL_DMA_SetMemoryAddress(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_PULSES, (uintptr_t)&onewire->pulses[2]);
+    LL_DMA_SetDataLength(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_PULSES, count);
+    LL_DMA_EnableChannel(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_PULSES);
+
+    LL_DMA_SetMemoryAddress(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_EDGES, (uintptr_t)onewire->edges);
+    LL_DMA_SetDataLength(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_EDGES, max_edges);
+    LL_DMA_EnableChannel(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_EDGES);
+
+    LL_TIM_EnableDMAReq_UPDATE(TIM2);
+    LL_TIM_EnableDMAReq_CC1(TIM2);
+    LL_TIM_EnableCounter(TIM2);
+
+    uint32_t timeout = count * slot_us / 1000 + PIRATE_ONEWIRE_TIMEOUT;
+    uint32_t flags = furi_thread_flags_wait(PIRATE_ONEWIRE_FLAG_DONE, FuriFlagWaitAny, timeout);
+
+    // If the interrupt never came, the counter's still running; either way, it stops here.
+    LL_TIM_DisableCounter(TIM2);
+    LL_TIM_DisableDMAReq_UPDATE(TIM2);
+    LL_TIM_DisableDMAReq_CC1(TIM2);
+    LL_DMA_DisableChannel(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_PULSES);
+    LL_DMA_DisableChannel(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_EDGES);
+
+    onewire->slots += count;
+    if((flags & FuriFlagError) || !(flags & PIRATE_ONEWIRE_FLAG_DONE)) {
+        return 0;
+    }
+
+    return max_edges - LL_DMA_GetDataLength(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_EDGES);
+}
+
+/** Whether the device sent a one in the given slot: the line was back up before we sampled it. */
+static inline bool pirate_onewire_edge_bit(PirateOneWireBus* onewire, size_t slot) {
+    return onewire->edges[slot] <= PIRATE_ONEWIRE_SAMPLE_US;
+}
+
+static inline uint16_t pirate_onewire_pulse(bool bit) {
+    return bit ? PIRATE_ONEWIRE_WRITE_ONE_US : PIRATE_ONEWIRE_WRITE_ZERO_US;
+}
+
+void pirate_onewire_bus_acquire(PirateOneWireBus* onewire) {
+    onewire->waiter = furi_thread_get_current_id();
+    furi_hal_bus_enable(FuriHalBusTIM2);
+
+    // A tick a microsecond; the line is let go between bursts, since an idle slot pulses for no time.
+    LL_TIM_SetPrescaler(TIM2, furi_hal_cortex_instructions_per_microsecond() - 1);
+    LL_TIM_EnableARRPreload(TIM2);
+    LL_TIM_OC_SetMode(TIM2, LL_TIM_CHANNEL_CH2, LL_TIM_OCMODE_PWM2);
+    LL_TIM_OC_EnablePreload(TIM2, LL_TIM_CHANNEL_CH2);
+    LL_TIM_OC_SetCompareCH2(TIM2, 0);
+
+    // Channel 1 listens to channel 2's pin, for the line coming back up.
+    LL_TIM_IC_SetActiveInput(TIM2, LL_TIM_CHANNEL_CH1, LL_TIM_ACTIVEINPUT_INDIRECTTI);
+    LL_TIM_IC_SetPolarity(TIM2, LL_TIM_CHANNEL_CH1, LL_TIM_IC_POLARITY_RISING);
+    LL_TIM_CC_EnableChannel(TIM2, LL_TIM_CHANNEL_CH1 | LL_TIM_CHANNEL_CH2);
+
+    LL_DMA_ConfigTransfer(
+        PIRATE_ONEWIRE_DMA,
+        PIRATE_ONEWIRE_DMA_PULSES,
+        LL_DMA_DIRECTION_MEMORY_TO_PERIPH | LL_DMA_MODE_NORMAL | LL_DMA_PERIPH_NOINCREMENT |
+            LL_DMA_MEMORY_INCREMENT | LL_DMA_PDATAALIGN_WORD | LL_DMA_MDATAALIGN_HALFWORD |
+            LL_DMA_PRIORITY_VERYHIGH);
+    LL_DMA_SetPeriphRequest(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_PULSES, LL_DMAMUX_REQ_TIM2_UP);
+    LL_DMA_SetPeriphAddress(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_PULSES, (uintptr_t)&TIM2->CCR2);
+    LL_DMA_EnableIT_TC(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_PULSES);
+
+    LL_DMA_ConfigTransfer(
+        PIRATE_ONEWIRE_DMA,
+        PIRATE_ONEWIRE_DMA_EDGES,
+        LL_DMA_DIRECTION_PERIPH_TO_MEMORY | LL_DMA_MODE_NORMAL | LL_DMA_PERIPH_NOINCREMENT |
+            LL_DMA_MEMORY_INCREMENT | LL_DMA_PDATAALIGN_WORD | LL_DMA_MDATAALIGN_HALFWORD |
+            LL_DMA_PRIORITY_VERYHIGH);
+    LL_DMA_SetPeriphRequest(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_EDGES, LL_DMAMUX_REQ_TIM2_CH1);
+    LL_DMA_SetPeriphAddress(PIRATE_ONEWIRE_DMA, PIRATE_ONEWIRE_DMA_EDGES, (uintptr_t)&TIM2->CCR1);
+
+    furi_hal_interrupt_set_isr(PIRATE_ONEWIRE_DMA_IRQ, pirate_onewire_dma_isr, onewire);
+    furi_hal_gpio_init_ex(
+        PIRATE_ONEWIRE_PIN, GpioModeAltFunctionOpenDrain, GpioPullUp, GpioSpeedVeryHigh, GpioAltFn1TIM2);
+}
+
+void pirate_onewire_bus_release(PirateOneWireBus* onewire) {
+    UNUSED(onewire);
+
+    furi_hal_gpio_init(PIRATE_ONEWIRE_PIN, GpioModeAnalog, GpioPullNo, GpioSpeedLow);
+    furi_hal_interrupt_set_isr(PIRATE_ONEWIRE_DMA_IRQ, NULL, NULL);
+
+    LL_TIM_CC_DisableChannel(TIM2, LL_TIM_CHANNEL_CH1 | LL_TIM_CHANNEL_CH2);
+    furi_hal_bus_disable(FuriHalBusTIM2);
+}
+
+bool pirate_onewire_bus_reset(PirateOneWireBus* onewire, bool* present) {
+    onewire->pulses[0] = PIRATE_ONEWIRE_RESET_US;
+    onewire->resets += 1;
+
+    size_t edges = pirate_onewire_burst(onewire, 1, PIRATE_ONEWIRE_RESET_SLOT_US, PIRATE_ONEWIRE_RESET_EDGES);
+    if(!edges) {
+        return false;
+    }
+
+    // The line comes up when we let it go, and again after each presence pulse; unless a device
+    // was already holding it down by then.
+    *present = (edges > 1) || (onewire->edges[0] > PIRATE_ONEWIRE_RESET_US + PIRATE_ONEWIRE_SAMPLE_US);
+    return true;
+}
+
+bool pirate_onewire_bus_transfer(PirateOneWireBus* onewire, const uint8_t* tx, uint8_t* rx, size_t length) {
+    while(length) {
+        size_t bytes = MIN(length, (size_t)PIRATE_ONEWIRE_BURST_BYTES);
+        size_t slots = bytes * 8;
+
+        for(size_t slot = 0; slot < slots; ++slot) {
+            bool bit = tx ? (tx[slot / 8] >> (slot % 8)) & 1 : true;
+            onewire->pulses[slot] = pirate_onewire_pulse(bit);
+        }
+
+        // Every slot ends with the line coming back up; if one didn't, it's stuck low.
+        if(pirate_onewire_burst(onewire, slots, PIRATE_ONEWIRE_SLOT_US, slots) != slots) {
+            return false;
+        }
+
+        if(rx) {
+            memset(rx, 0, bytes);
+            for(size_t slot = 0; slot < slots; ++slot) {
+                rx[slot / 8] |= pirate_onewire_edge_bit(onewire, slot) << (slot % 8);
+            }
+            rx += bytes;
+        }
+
+        tx = tx ? tx + bytes : NULL;
+        length -= bytes;
+    }
+
+    return true;
+}
+
+void pirate_onewire_search_reset(PirateOneWireSearch* search) {
+    memset(search, 0, sizeof(*search));
+    search->last_discrepancy = -1;
+}
+
+bool pirate_onewire_bus_search(PirateOneWireBus* onewire, PirateOneWireSearch* search) {
+    uint8_t command = PIRATE_ONEWIRE_SEARCH_ROM;
+    bool present = false;
+    int last_zero = -1;
+
+    if(search->done) {
+        return false;
+    }
+
+    if(!pirate_onewire_bus_reset(onewire, &present)) {
+        return false;
+    }
+    if(!present) {
+        search->done = true;
+        return false;
+    }
+    if(!pirate_onewire_bus_transfer(onewire, &command, NULL, 1)) {
+        return false;
+    }
+
+    // Each bit is two reads, every device's bit and its complement, and then our choice of
+    // branch. The choice is all we have to think about; so it goes out in the same burst as the
+    // next bit's reads, which leaves one wakeup a bit.
+    onewire->pulses[0] = PIRATE_ONEWIRE_WRITE_ONE_US;
+    onewire->pulses[1] = PIRATE_ONEWIRE_WRITE_ONE_US;
+    if(pirate_onewire_burst(onewire, 2, PIRATE_ONEWIRE_SLOT_US, 2) != 2) {
+        return false;
+    }
+
+    size_t reads = 0;
+    for(int bit = 0; bit < 64; ++bit) {
+        bool id_bit = pirate_onewire_edge_bit(onewire, reads);
+        bool complement = pirate_onewire_edge_bit(onewire, reads + 1);
+        bool direction;
+
+        // Everyone went quiet; whoever we were following has left the bus.
+        if(id_bit && complement) {
+            return false;
+        }
+
+        if(id_bit != complement) {
+            direction = id_bit;
+        } else if(bit < search->last_discrepancy) {
+            direction = (search->rom[bit / 8] >> (bit % 8)) & 1;
+        } else {
+            direction = (bit == search->last_discrepancy);
+        }
+
+        if(!id_bit && !complement && !direction) {
+            last_zero = bit;
+        }
+
+        if(direction) {
+            search->rom[bit / 8] |= 1 << (bit % 8);
+        } else {
+            search->rom[bit / 8] &= ~(1 << (bit % 8));
+        }
+
+        size_t slots = (bit < 63) ? 3 : 1;
+        onewire->pulses[0] = pirate_onewire_pulse(direction);
+        onewire->pulses[1] = PIRATE_ONEWIRE_WRITE_ONE_US;
+        onewire->pulses[2] = PIRATE_ONEWIRE_WRITE_ONE_US;
+        if(pirate_onewire_burst(onewire, slots, PIRATE_ONEWIRE_SLOT_US, slots) != slots) {
+            return false;
+        }
+        reads = 1;
+    }
+
+    search->last_discrepancy = last_zero;
+    search->done = (last_zero < 0);
+
+    // A code that fails its CRC is noise, not a device.
+    return pirate_onewire_crc(search->rom, sizeof(search->rom)) == 0;
+}
+
+uint8_t pirate_onewire_crc(const uint8_t* data, size_t length) {
+    uint8_t crc = 0;
+
+    for(size_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for(int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8C : crc >> 1;
+        }
+    }
+
+    return crc;
+}
+
+static void pirate_onewire_acquire(void* context) {
+    pirate_onewire_bus_acquire(context);
+}
+
+static void pirate_onewire_release(void* context) {
+    pirate_onewire_bus_release(context);
+}
+
+static bool pirate_onewire_start(void* context) {
+    bool present = false;
+
+    // A reset nobody answers is as good as a NAK.
+    return pirate_onewire_bus_reset(context, &present) && present;
+}
+
+static bool pirate_onewire_stop(void* context) {
+    UNUSED(context);
+    return true;
+}
+
+static bool pirate_onewire_write(void* context, const uint8_t* data, size_t length, PirateBusNext next) {
+    UNUSED(next);
+    return pirate_onewire_bus_transfer(context, data, NULL, length);
+}
+
+static bool pirate_onewire_read(void* context, uint8_t* data, size_t length, PirateBusNext next) {
+    UNUSED(next);
+    return pirate_onewire_bus_transfer(context, NULL, data, length);
+}
+
+static void pirate_onewire_delay_us(void* context, uint32_t microseconds) {
+    UNUSED(context);
+    furi_delay_us(microseconds);
+}
+
+void pirate_onewire_bus_init(PirateBus* bus, PirateOneWireBus* onewire) {
+    memset(onewire, 0, sizeof(*onewire));
+
+    bus->acquire = pirate_onewire_acquire;
+    bus->release = pirate_onewire_release;
+    bus->prepare = NULL;
+    bus->start = pirate_onewire_start;
+    bus->stop = pirate_onewire_stop;
+    bus->write = pirate_onewire_write;
+    bus->read = pirate_onewire_read;
+    bus->delay_us = pirate_onewire_delay_us;
+    bus->set_speed = NULL;
+    bus->context = onewire;
+}
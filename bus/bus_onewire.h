@@ -0,0 +1,114 @@
+#pragma once
+
+#include <furi_hal.h>
+
+#include "../lib/libpirate.h"
+
+/**
+ * The pin the bus lives on: SPI SCK, which is also TIM2's channel 2. The line needs a pull-up;
+ * the pin's own is enough for a few devices on short wires, but 4.7k to 3.3 V is better.
+ */
+#define PIRATE_ONEWIRE_PIN (&gpio_ext_pb3)
+
+/** Slot timings at standard speed, in microseconds; each is one tick of the timer. */
+#define PIRATE_ONEWIRE_SLOT_US 70
+#define PIRATE_ONEWIRE_WRITE_ONE_US 6
+#define PIRATE_ONEWIRE_WRITE_ZERO_US 60
+#define PIRATE_ONEWIRE_RESET_US 480
+#define PIRATE_ONEWIRE_RESET_SLOT_US 960
+
+/** A read slot's line must be back up by this, after it fell, to read as a one. */
+#define PIRATE_ONEWIRE_SAMPLE_US 15
+
+/** Most bytes we'll hand the timer at once; longer transfers go in several bursts. */
+#define PIRATE_ONEWIRE_BURST_BYTES 16
+#define PIRATE_ONEWIRE_BURST_SLOTS (PIRATE_ONEWIRE_BURST_BYTES * 8)
+
+/**
+ * Longest a burst may run over its expected length, in milliseconds, before we give up on it. The
+ * host build gives it longer; its timer's a thread the host may put off for a while.
+ */
+#ifndef PIRATE_ONEWIRE_TIMEOUT
+#define PIRATE_ONEWIRE_TIMEOUT 10
+#endif
+
+/** Thread flag the DMA interrupt sets on whoever's waiting for a burst; theirs not to use for anything else. */
+#define PIRATE_ONEWIRE_FLAG_DONE (1UL << 23)
+
+/** ROM commands. */
+#define PIRATE_ONEWIRE_SEARCH_ROM 0xF0
+
+/**
+ * State for a 1-Wire bus, whose slots are made entirely in hardware.
+ *
+ * TIM2 counts microseconds, with one period per time slot. Channel 2 pulls the line low from
+ * the start of each slot until its compare, in PWM mode 2; so a slot's only parameter is how
+ * long it's held low, which the DMA loads from a table at each update. Channel 1 watches the
+ * same pin, and the DMA stores the time the line came back up in each slot; which is how long
+ * a device held it down, and so what it sent. The CPU sets up each burst of slots, sleeps
+ * until the DMA says they're done, and decodes the captures; it never times anything itself.
+ *
+ * '[' is a reset, which fails if nobody answers it with a presence pulse; ']' does nothing.
+ * So reading a lone device's ROM code is "[0x33 r:8]".
+ */
+typedef struct {
+    /** The thread that acquired the bus; woken by the DMA interrupt when a burst's last slot ends. */
+    FuriThreadId waiter;
+
+    /** How long each slot of a burst holds the line low; then two idle slots to end on. */
+    uint16_t pulses[PIRATE_ONEWIRE_BURST_SLOTS + 2];
+
+    /** When the line came back up in each slot, relative to its start. */
+    uint16_t edges[PIRATE_ONEWIRE_BURST_SLOTS];
+
+    /** Bus statistics, for the curious. */
+    uint32_t slots;
+    uint32_t resets;
+} PirateOneWireBus;
+
+/** Search state, carried from one device to the next. */
+typedef struct {
+    uint8_t rom[8];
+
+    /** The last bit where we took the 1 branch, with devices on the 0 branch yet to be found. */
+    int last_discrepancy;
+    bool done;
+} PirateOneWireSearch;
+
+/**
+ * Sets up a PirateBus that talks to 1-Wire devices on PIRATE_ONEWIRE_PIN.
+ *
+ * @param bus       The bus to populate.
+ * @param onewire   Storage for the bus's state; must outlive the bus.
+ */
+void pirate_onewire_bus_init(PirateBus* bus, PirateOneWireBus* onewire);
+
+/** Takes over the timer, the DMA channels and the pin; and gives them back. Bursts run on the acquiring thread. */
+void pirate_onewire_bus_acquire(PirateOneWireBus* onewire);
+void pirate_onewire_bus_release(PirateOneWireBus* onewire);
+
+/**
+ * Resets the bus. Returns false if the line's stuck low; otherwise, present is set to whether
+ * any device answered.
+ */
+bool pirate_onewire_bus_reset(PirateOneWireBus* onewire, bool* present);
+
+/**
+ * Moves bytes each way at once, least significant bit first: each bit written as a one is also
+ * a read slot, so reading is writing 0xFF. Either buffer may be NULL; filler is all ones.
+ * Returns false if any slot went wrong, such as the line being stuck low.
+ */
+bool pirate_onewire_bus_transfer(PirateOneWireBus* onewire, const uint8_t* tx, uint8_t* rx, size_t length);
+
+/** Starts a new search, from the bottom of the tree. */
+void pirate_onewire_search_reset(PirateOneWireSearch* search);
+
+/**
+ * Finds the next device on the bus, in the order of the ROM search algorithm, and leaves it
+ * selected. Returns false once there are no more; search->done says whether that was because
+ * we'd found them all, rather than because the bus went wrong.
+ */
+bool pirate_onewire_bus_search(PirateOneWireBus* onewire, PirateOneWireSearch* search);
+
+/** The Dallas/Maxim CRC-8, which guards ROM codes and scratchpads; zero over a valid one. */
+uint8_t pirate_onewire_crc(const uint8_t* data, size_t length);
@@ -0,0 +1,126 @@
+#include "bus_spi.h"
+
+#include <stm32wbxx_ll_spi.h>
+
+/** The rates the external SPI peripheral can make from its 64 MHz clock, fastest first. */
+static const struct {
+    uint32_t speed;
+    uint32_t prescaler;
+} pirate_spi_rates[] = {
+    {32000, LL_SPI_BAUDRATEPRESCALER_DIV2},
+    {16000, LL_SPI_BAUDRATEPRESCALER_DIV4},
+    {8000, LL_SPI_BAUDRATEPRESCALER_DIV8},
+    {4000, LL_SPI_BAUDRATEPRESCALER_DIV16},
+    {2000, LL_SPI_BAUDRATEPRESCALER_DIV32},
+    {1000, LL_SPI_BAUDRATEPRESCALER_DIV64},
+    {500, LL_SPI_BAUDRATEPRESCALER_DIV128},
+    {250, LL_SPI_BAUDRATEPRESCALER_DIV256},
+};
+
+/** Loads our prescaler into the peripheral; which has to be stopped while it changes. */
+static void pirate_spi_apply_speed(PirateSpiBus* spi) {
+    SPI_TypeDef* peripheral = spi->handle->bus->spi;
+
+    LL_SPI_Disable(peripheral);
+    LL_SPI_SetBaudRatePrescaler(peripheral, spi->prescaler);
+    LL_SPI_Enable(peripheral);
+}
+
+static bool pirate_spi_set_speed(void* context, uint32_t kilohertz) {
+    PirateSpiBus* spi = context;
+
+    for(size_t i = 0; i < COUNT_OF(pirate_spi_rates); ++i) {
+        if(pirate_spi_rates[i].speed <= kilohertz) {
+            spi->speed = pirate_spi_rates[i].speed;
+            spi->prescaler = pirate_spi_rates[i].prescaler;
+            pirate_spi_apply_speed(spi);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void pirate_spi_acquire(void* context) {
+    PirateSpiBus* spi = context;
+
+    // Acquiring the bus asserts CS for us; but that's for '[' to decide.
+    furi_hal_spi_acquire(spi->handle);
+    furi_hal_gpio_write(spi->handle->cs, true);
+
+    // Each run starts from the default clock, so a command means the same thing every time.
+    pirate_spi_set_speed(spi, PIRATE_SPI_DEFAULT_SPEED);
+}
+
+static void pirate_spi_release(void* context) {
+    PirateSpiBus* spi = context;
+    furi_hal_spi_release(spi->handle);
+}
+
+static bool pirate_spi_start(void* context) {
+    PirateSpiBus* spi = context;
+
+    // A '[' inside a transaction pulses CS, as a repeated start would.
+    if(!furi_hal_gpio_read(spi->handle->cs)) {
+        furi_hal_gpio_write(spi->handle->cs, true);
+    }
+    furi_hal_gpio_write(spi->handle->cs, false);
+    return true;
+}
+
+static bool pirate_spi_stop(void* context) {
+    PirateSpiBus* spi = context;
+    furi_hal_gpio_write(spi->handle->cs, true);
+    return true;
+}
+
+static bool pirate_spi_write(void* context, const uint8_t* data, size_t length, PirateBusNext next) {
+    UNUSED(next);
+    return pirate_spi_bus_transfer(context, data, NULL, length);
+}
+
+static bool pirate_spi_read(void* context, uint8_t* data, size_t length, PirateBusNext next) {
+    UNUSED(next);
+    return pirate_spi_bus_transfer(context, NULL, data, length);
+}
+
+static void pirate_spi_delay_us(void* context, uint32_t microseconds) {
+    UNUSED(context);
+    furi_delay_us(microseconds);
+}
+
+bool pirate_spi_bus_transfer(PirateSpiBus* spi, const uint8_t* tx, uint8_t* rx, size_t length) {
+    if(length < PIRATE_SPI_DMA_THRESHOLD) {
+        return furi_hal_spi_bus_trx(spi->handle, tx, rx, length, PIRATE_SPI_TIMEOUT);
+    }
+
+    // DMA only reads from the transmit buffer, and clocks out filler without one; the HAL just
+    // doesn't say so.
+    return furi_hal_spi_bus_trx_dma(spi->handle, (uint8_t*)tx, rx, length, PIRATE_SPI_TIMEOUT);
+}
+
+void pirate_spi_bus_set_mode(PirateSpiBus* spi, bool idle_high, bool second_edge) {
+    SPI_TypeDef* peripheral = spi->handle->bus->spi;
+
+    LL_SPI_Disable(peripheral);
+    LL_SPI_SetClockPolarity(peripheral, idle_high ? LL_SPI_POLARITY_HIGH : LL_SPI_POLARITY_LOW);
+    LL_SPI_SetClockPhase(peripheral, second_edge ? LL_SPI_PHASE_2EDGE : LL_SPI_PHASE_1EDGE);
+    LL_SPI_Enable(peripheral);
+}
+
+void pirate_spi_bus_init(PirateBus* bus, PirateSpiBus* spi, FuriHalSpiBusHandle* handle) {
+    spi->handle = handle;
+    spi->speed = PIRATE_SPI_DEFAULT_SPEED;
+    spi->prescaler = LL_SPI_BAUDRATEPRESCALER_DIV64;
+
+    bus->acquire = pirate_spi_acquire;
+    bus->release = pirate_spi_release;
+    bus->prepare = NULL;
+    bus->start = pirate_spi_start;
+    bus->stop = pirate_spi_stop;
+    bus->write = pirate_spi_write;
+    bus->read = pirate_spi_read;
+    bus->delay_us = pirate_spi_delay_us;
+    bus->set_speed = pirate_spi_set_speed;
+    bus->context = spi;
+}
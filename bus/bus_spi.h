@@ -0,0 +1,53 @@
+#pragma once
+
+#include <furi_hal.h>
+
+#include "../lib/libpirate.h"
+
+/** Time we'll wait on any single SPI transfer, in milliseconds. */
+#define PIRATE_SPI_TIMEOUT 100
+
+/** Transfers at least this long go by DMA; shorter ones cost less to just poll out. */
+#define PIRATE_SPI_DMA_THRESHOLD 8
+
+/** The clock we start each run at, in kHz; '@N' in a command changes it. */
+#define PIRATE_SPI_DEFAULT_SPEED 1000
+
+/**
+ * State for executing programs against an SPI bus.
+ *
+ * '[' asserts chip select, and ']' releases it; '@N' sets the clock to the fastest rate the
+ * peripheral can make that doesn't exceed N kHz. So reading a flash part's JEDEC ID at
+ * 8 MHz is "@8000 [0x9F r:3]".
+ */
+typedef struct {
+    FuriHalSpiBusHandle* handle;
+
+    /** The clock we're running at, in kHz; and the prescaler that makes it. */
+    uint32_t speed;
+    uint32_t prescaler;
+} PirateSpiBus;
+
+/**
+ * Sets up a PirateBus that talks to SPI via the given handle.
+ *
+ * @param bus       The bus to populate.
+ * @param spi       Storage for the bus's state; must outlive the bus.
+ * @param handle    The SPI handle to use; typically &furi_hal_spi_bus_handle_external.
+ */
+void pirate_spi_bus_init(PirateBus* bus, PirateSpiBus* spi, FuriHalSpiBusHandle* handle);
+
+/**
+ * Clocks data out and in at once, for callers that want raw full-duplex transfers rather than
+ * a PirateBus. Either buffer may be NULL: filler is sent without a transmit buffer, and what's
+ * received is dropped without a receive one. Long transfers go by DMA.
+ */
+bool pirate_spi_bus_transfer(PirateSpiBus* spi, const uint8_t* tx, uint8_t* rx, size_t length);
+
+/**
+ * Sets the clock's polarity and phase; the bus starts out in mode 0 each time it's acquired.
+ *
+ * @param idle_high     Whether the clock idles high (CPOL).
+ * @param second_edge   Whether data is sampled on the clock's second edge, rather than its first (CPHA).
+ */
+void pirate_spi_bus_set_mode(PirateSpiBus* spi, bool idle_high, bool second_edge);
@@ -0,0 +1,14 @@
+/**
+ * @file assets_icons.h
+ * Host stand-in for the firmware's built-in icon set.
+ */
+
+#pragma once
+
+#include <gui/icon_i.h>
+
+extern const Icon I_ButtonLeftSmall_3x5;
+extern const Icon I_ButtonRightSmall_3x5;
+extern const Icon I_KeyBackspace_16x9;
+extern const Icon I_KeyBackspaceSelected_16x9;
+extern const Icon I_file_10px;
@@ -0,0 +1,36 @@
+/**
+ * @file dialogs.c
+ * Host implementation of the dialogs stand-ins.
+ */
+
+#include <dialogs/dialogs.h>
+
+void dialog_file_browser_set_basic_options(
+    DialogsFileBrowserOptions* options,
+    const char* extension,
+    const Icon* icon) {
+    memset(options, 0, sizeof(*options));
+
+    options->extension = extension;
+    options->skip_assets = true;
+    options->hide_dot_files = true;
+    options->icon = icon;
+}
+
+bool dialog_file_browser_show(
+    DialogsApp* context,
+    FuriString* result_path,
+    FuriString* path,
+    const DialogsFileBrowserOptions* options) {
+    UNUSED(context);
+    UNUSED(path);
+    UNUSED(options);
+
+    const char* picked = getenv("PIRATE_HOST_SCRIPT");
+    if(!picked) {
+        return false;
+    }
+
+    furi_string_set_str(result_path, picked);
+    return true;
+}
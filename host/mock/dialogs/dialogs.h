@@ -0,0 +1,44 @@
+/**
+ * @file dialogs.h
+ * Host stand-in for the dialogs service; just enough of it to pick a file.
+ *
+ * There's no browser to show, so the file browser "picks" whatever path is in
+ * $PIRATE_HOST_SCRIPT, and is cancelled if that isn't set.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <gui/icon.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RECORD_DIALOGS "dialogs"
+
+typedef struct DialogsApp DialogsApp;
+
+typedef struct {
+    const char* extension;
+    const char* base_path;
+    bool skip_assets;
+    bool hide_dot_files;
+    const Icon* icon;
+    bool hide_ext;
+} DialogsFileBrowserOptions;
+
+void dialog_file_browser_set_basic_options(
+    DialogsFileBrowserOptions* options,
+    const char* extension,
+    const Icon* icon);
+
+bool dialog_file_browser_show(
+    DialogsApp* context,
+    FuriString* result_path,
+    FuriString* path,
+    const DialogsFileBrowserOptions* options);
+
+#ifdef __cplusplus
+}
+#endif
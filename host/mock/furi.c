@@ -0,0 +1,770 @@
+/**
+ * @file furi.c
+ * Host implementation of the Furi core stand-ins, on top of pthreads.
+ */
+
+#include <furi.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Crashes and logging.
+ */
+
+static FuriLogLevel furi_log_level = FuriLogLevelWarn;
+static pthread_mutex_t furi_log_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+void furi_crash(const char* message) {
+    fprintf(stderr, "furi_crash: %s\n", message ? message : "(no message)");
+    abort();
+}
+
+void furi_log_set_level(FuriLogLevel level) {
+    furi_log_level = level;
+}
+
+void furi_log_print_format(FuriLogLevel level, const char* tag, const char* format, ...) {
+    static const char* const level_names[] = {"", "E", "W", "I", "D"};
+    va_list args;
+
+    if(level > furi_log_level) {
+        return;
+    }
+
+    pthread_mutex_lock(&furi_log_mutex);
+    fprintf(stderr, "%lu [%s][%s] ", (unsigned long)furi_get_tick(), level_names[level], tag);
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+    pthread_mutex_unlock(&furi_log_mutex);
+}
+
+/**
+ * Kernel.
+ */
+
+static uint64_t furi_monotonic_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/** Ticks count from when the program started, as they do from boot on the device. */
+static uint64_t furi_tick_epoch;
+
+__attribute__((constructor)) static void furi_tick_init(void) {
+    furi_tick_epoch = furi_monotonic_us();
+}
+
+uint32_t furi_get_tick(void) {
+    return (furi_monotonic_us() - furi_tick_epoch) / 1000;
+}
+
+uint32_t furi_kernel_get_tick_frequency(void) {
+    return 1000;
+}
+
+uint32_t furi_ms_to_ticks(uint32_t milliseconds) {
+    return milliseconds;
+}
+
+void furi_delay_tick(uint32_t ticks) {
+    usleep(ticks * 1000);
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    usleep(milliseconds * 1000);
+}
+
+void furi_delay_us(uint32_t microseconds) {
+    uint64_t end = furi_monotonic_us() + microseconds;
+
+    // Short delays are usually timing-critical; spin rather than trusting the scheduler.
+    while(furi_monotonic_us() < end) {
+    }
+}
+
+/** Fills in an absolute deadline for a pthread timed wait, from a tick timeout. */
+static void furi_deadline(struct timespec* deadline, uint32_t timeout) {
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += timeout / 1000;
+    deadline->tv_nsec += (long)(timeout % 1000) * 1000000;
+    if(deadline->tv_nsec >= 1000000000) {
+        deadline->tv_sec += 1;
+        deadline->tv_nsec -= 1000000000;
+    }
+}
+
+/**
+ * Waits on a condition, honouring a Furi-style timeout.
+ * @return false if the wait timed out.
+ */
+static bool furi_cond_wait(
+    pthread_cond_t* cond,
+    pthread_mutex_t* mutex,
+    uint32_t timeout,
+    const struct timespec* deadline) {
+    if(timeout == FuriWaitForever) {
+        pthread_cond_wait(cond, mutex);
+        return true;
+    }
+    if(timeout == 0) {
+        return false;
+    }
+    return pthread_cond_timedwait(cond, mutex, deadline) != ETIMEDOUT;
+}
+
+/**
+ * Threads.
+ */
+
+struct FuriThread {
+    char* name;
+    FuriThreadCallback callback;
+    void* context;
+
+    pthread_t thread;
+    bool running;
+    uint32_t stack_size;
+
+    pthread_mutex_t flags_mutex;
+    pthread_cond_t flags_changed;
+    uint32_t flags;
+};
+
+static __thread FuriThread* furi_thread_current;
+
+static void furi_thread_init(FuriThread* thread) {
+    pthread_mutex_init(&thread->flags_mutex, NULL);
+    pthread_cond_init(&thread->flags_changed, NULL);
+}
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context) {
+    FuriThread* thread = calloc(1, sizeof(FuriThread));
+    furi_thread_init(thread);
+    thread->name = strdup(name);
+    thread->stack_size = stack_size;
+    thread->callback = callback;
+    thread->context = context;
+
+    return thread;
+}
+
+void furi_thread_free(FuriThread* thread) {
+    furi_assert(thread);
+    furi_check(!thread->running);
+
+    pthread_mutex_destroy(&thread->flags_mutex);
+    pthread_cond_destroy(&thread->flags_changed);
+    free(thread->name);
+    free(thread);
+}
+
+static void* furi_thread_body(void* context) {
+    FuriThread* thread = context;
+
+    furi_thread_current = thread;
+    thread->callback(thread->context);
+    return NULL;
+}
+
+void furi_thread_start(FuriThread* thread) {
+    furi_assert(thread);
+    furi_check(!thread->running);
+
+    // As on the device, a restarted thread begins with no pending flags.
+    thread->flags = 0;
+    thread->running = true;
+    furi_check(pthread_create(&thread->thread, NULL, furi_thread_body, thread) == 0);
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    furi_assert(thread);
+
+    // Joining a thread that was never started (or is already joined) returns immediately.
+    if(thread->running) {
+        pthread_join(thread->thread, NULL);
+        thread->running = false;
+    }
+    return true;
+}
+
+FuriThreadId furi_thread_get_id(FuriThread* thread) {
+    furi_assert(thread);
+    return thread;
+}
+
+FuriThreadId furi_thread_get_current_id(void) {
+    // Threads we didn't create (such as main) get a record the first time they ask.
+    if(!furi_thread_current) {
+        furi_thread_current = calloc(1, sizeof(FuriThread));
+        furi_thread_init(furi_thread_current);
+        furi_thread_current->name = strdup("host");
+
+        // The stack an external app's main thread gets, unless its manifest asks for more.
+        furi_thread_current->stack_size = 2048;
+    }
+    return furi_thread_current;
+}
+
+uint32_t furi_thread_get_stack_space(FuriThreadId thread_id) {
+    FuriThread* thread = thread_id;
+    furi_assert(thread);
+    return thread->stack_size;
+}
+
+void furi_thread_yield(void) {
+    sched_yield();
+}
+
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags) {
+    FuriThread* thread = thread_id;
+    uint32_t result;
+
+    pthread_mutex_lock(&thread->flags_mutex);
+    thread->flags |= flags;
+    result = thread->flags;
+    pthread_cond_broadcast(&thread->flags_changed);
+    pthread_mutex_unlock(&thread->flags_mutex);
+
+    return result;
+}
+
+uint32_t furi_thread_flags_clear(uint32_t flags) {
+    FuriThread* thread = furi_thread_get_current_id();
+    uint32_t result;
+
+    pthread_mutex_lock(&thread->flags_mutex);
+    result = thread->flags;
+    thread->flags &= ~flags;
+    pthread_mutex_unlock(&thread->flags_mutex);
+
+    return result;
+}
+
+uint32_t furi_thread_flags_get(void) {
+    FuriThread* thread = furi_thread_get_current_id();
+    uint32_t result;
+
+    pthread_mutex_lock(&thread->flags_mutex);
+    result = thread->flags;
+    pthread_mutex_unlock(&thread->flags_mutex);
+
+    return result;
+}
+
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout) {
+    FuriThread* thread = furi_thread_get_current_id();
+    struct timespec deadline;
+    uint32_t result = FuriFlagErrorTimeout;
+
+    furi_deadline(&deadline, timeout);
+    pthread_mutex_lock(&thread->flags_mutex);
+
+    while(true) {
+        uint32_t pending = thread->flags & flags;
+        bool satisfied = (options & FuriFlagWaitAll) ? (pending == flags) : (pending != 0);
+
+        if(satisfied) {
+            result = thread->flags;
+            if(!(options & FuriFlagNoClear)) {
+                thread->flags &= ~flags;
+            }
+            break;
+        }
+        if(!furi_cond_wait(&thread->flags_changed, &thread->flags_mutex, timeout, &deadline)) {
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&thread->flags_mutex);
+    return result;
+}
+
+/**
+ * Semaphores.
+ */
+
+struct FuriSemaphore {
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    uint32_t count;
+    uint32_t max_count;
+};
+
+FuriSemaphore* furi_semaphore_alloc(uint32_t max_count, uint32_t initial_count) {
+    FuriSemaphore* instance = calloc(1, sizeof(FuriSemaphore));
+
+    pthread_mutex_init(&instance->mutex, NULL);
+    pthread_cond_init(&instance->changed, NULL);
+    instance->count = initial_count;
+    instance->max_count = max_count;
+
+    return instance;
+}
+
+void furi_semaphore_free(FuriSemaphore* instance) {
+    furi_assert(instance);
+
+    pthread_mutex_destroy(&instance->mutex);
+    pthread_cond_destroy(&instance->changed);
+    free(instance);
+}
+
+FuriStatus furi_semaphore_acquire(FuriSemaphore* instance, uint32_t timeout) {
+    struct timespec deadline;
+    FuriStatus status = FuriStatusOk;
+
+    furi_deadline(&deadline, timeout);
+    pthread_mutex_lock(&instance->mutex);
+
+    while(!instance->count) {
+        if(!furi_cond_wait(&instance->changed, &instance->mutex, timeout, &deadline)) {
+            status = timeout ? FuriStatusErrorTimeout : FuriStatusErrorResource;
+            break;
+        }
+    }
+    if(status == FuriStatusOk) {
+        instance->count -= 1;
+    }
+
+    pthread_mutex_unlock(&instance->mutex);
+    return status;
+}
+
+FuriStatus furi_semaphore_release(FuriSemaphore* instance) {
+    FuriStatus status = FuriStatusOk;
+
+    pthread_mutex_lock(&instance->mutex);
+    if(instance->count < instance->max_count) {
+        instance->count += 1;
+        pthread_cond_signal(&instance->changed);
+    } else {
+        status = FuriStatusErrorResource;
+    }
+    pthread_mutex_unlock(&instance->mutex);
+
+    return status;
+}
+
+/**
+ * Mutexes.
+ */
+
+struct FuriMutex {
+    pthread_mutex_t mutex;
+};
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    FuriMutex* instance = calloc(1, sizeof(FuriMutex));
+    pthread_mutexattr_t attributes;
+
+    pthread_mutexattr_init(&attributes);
+    if(type == FuriMutexTypeRecursive) {
+        pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    }
+    pthread_mutex_init(&instance->mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+
+    return instance;
+}
+
+void furi_mutex_free(FuriMutex* instance) {
+    furi_assert(instance);
+
+    pthread_mutex_destroy(&instance->mutex);
+    free(instance);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* instance, uint32_t timeout) {
+    struct timespec deadline;
+
+    if(timeout == FuriWaitForever) {
+        pthread_mutex_lock(&instance->mutex);
+        return FuriStatusOk;
+    }
+    if(timeout == 0) {
+        return pthread_mutex_trylock(&instance->mutex) ? FuriStatusErrorResource : FuriStatusOk;
+    }
+
+    furi_deadline(&deadline, timeout);
+    return pthread_mutex_timedlock(&instance->mutex, &deadline) ? FuriStatusErrorTimeout :
+                                                                  FuriStatusOk;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* instance) {
+    return pthread_mutex_unlock(&instance->mutex) ? FuriStatusErrorResource : FuriStatusOk;
+}
+
+/**
+ * Message queues.
+ */
+
+struct FuriMessageQueue {
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+
+    uint8_t* storage;
+    uint32_t msg_count;
+    uint32_t msg_size;
+
+    uint32_t head;
+    uint32_t used;
+};
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size) {
+    FuriMessageQueue* instance = calloc(1, sizeof(FuriMessageQueue));
+
+    pthread_mutex_init(&instance->mutex, NULL);
+    pthread_cond_init(&instance->changed, NULL);
+    instance->storage = calloc(msg_count, msg_size);
+    instance->msg_count = msg_count;
+    instance->msg_size = msg_size;
+
+    return instance;
+}
+
+void furi_message_queue_free(FuriMessageQueue* instance) {
+    furi_assert(instance);
+
+    pthread_mutex_destroy(&instance->mutex);
+    pthread_cond_destroy(&instance->changed);
+    free(instance->storage);
+    free(instance);
+}
+
+FuriStatus
+    furi_message_queue_put(FuriMessageQueue* instance, const void* msg_ptr, uint32_t timeout) {
+    struct timespec deadline;
+    FuriStatus status = FuriStatusOk;
+
+    furi_deadline(&deadline, timeout);
+    pthread_mutex_lock(&instance->mutex);
+
+    while(instance->used == instance->msg_count) {
+        if(!furi_cond_wait(&instance->changed, &instance->mutex, timeout, &deadline)) {
+            status = timeout ? FuriStatusErrorTimeout : FuriStatusErrorResource;
+            break;
+        }
+    }
+    if(status == FuriStatusOk) {
+        uint32_t slot = (instance->head + instance->used) % instance->msg_count;
+        memcpy(instance->storage + slot * instance->msg_size, msg_ptr, instance->msg_size);
+        instance->used += 1;
+        pthread_cond_broadcast(&instance->changed);
+    }
+
+    pthread_mutex_unlock(&instance->mutex);
+    return status;
+}
+
+FuriStatus furi_message_queue_get(FuriMessageQueue* instance, void* msg_ptr, uint32_t timeout) {
+    struct timespec deadline;
+    FuriStatus status = FuriStatusOk;
+
+    furi_deadline(&deadline, timeout);
+    pthread_mutex_lock(&instance->mutex);
+
+    while(!instance->used) {
+        if(!furi_cond_wait(&instance->changed, &instance->mutex, timeout, &deadline)) {
+            status = timeout ? FuriStatusErrorTimeout : FuriStatusErrorResource;
+            break;
+        }
+    }
+    if(status == FuriStatusOk) {
+        memcpy(msg_ptr, instance->storage + instance->head * instance->msg_size, instance->msg_size);
+        instance->head = (instance->head + 1) % instance->msg_count;
+        instance->used -= 1;
+        pthread_cond_broadcast(&instance->changed);
+    }
+
+    pthread_mutex_unlock(&instance->mutex);
+    return status;
+}
+
+uint32_t furi_message_queue_get_count(FuriMessageQueue* instance) {
+    uint32_t count;
+
+    pthread_mutex_lock(&instance->mutex);
+    count = instance->used;
+    pthread_mutex_unlock(&instance->mutex);
+
+    return count;
+}
+
+FuriStatus furi_message_queue_reset(FuriMessageQueue* instance) {
+    pthread_mutex_lock(&instance->mutex);
+    instance->head = 0;
+    instance->used = 0;
+    pthread_cond_broadcast(&instance->changed);
+    pthread_mutex_unlock(&instance->mutex);
+
+    return FuriStatusOk;
+}
+
+/**
+ * Stream buffers.
+ */
+
+struct FuriStreamBuffer {
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+
+    uint8_t* storage;
+    size_t size;
+    size_t trigger_level;
+
+    size_t head;
+    size_t used;
+};
+
+FuriStreamBuffer* furi_stream_buffer_alloc(size_t size, size_t trigger_level) {
+    FuriStreamBuffer* instance = calloc(1, sizeof(FuriStreamBuffer));
+
+    pthread_mutex_init(&instance->mutex, NULL);
+    pthread_cond_init(&instance->changed, NULL);
+    instance->storage = calloc(size, 1);
+    instance->size = size;
+    instance->trigger_level = MAX(trigger_level, 1U);
+
+    return instance;
+}
+
+void furi_stream_buffer_free(FuriStreamBuffer* stream_buffer) {
+    furi_assert(stream_buffer);
+
+    pthread_mutex_destroy(&stream_buffer->mutex);
+    pthread_cond_destroy(&stream_buffer->changed);
+    free(stream_buffer->storage);
+    free(stream_buffer);
+}
+
+size_t furi_stream_buffer_send(
+    FuriStreamBuffer* stream_buffer,
+    const void* data,
+    size_t length,
+    uint32_t timeout) {
+    struct timespec deadline;
+    size_t sent = 0;
+
+    furi_deadline(&deadline, timeout);
+    pthread_mutex_lock(&stream_buffer->mutex);
+
+    // Like FreeRTOS, we write whatever fits; and only wait if nothing does.
+    while(stream_buffer->used == stream_buffer->size) {
+        if(!furi_cond_wait(&stream_buffer->changed, &stream_buffer->mutex, timeout, &deadline)) {
+            break;
+        }
+    }
+    while(sent < length && stream_buffer->used < stream_buffer->size) {
+        size_t tail = (stream_buffer->head + stream_buffer->used) % stream_buffer->size;
+        size_t span = MIN(length - sent, stream_buffer->size - stream_buffer->used);
+
+        // The free space can wrap; so copy it in at most two pieces.
+        span = MIN(span, stream_buffer->size - tail);
+        memcpy(&stream_buffer->storage[tail], (const uint8_t*)data + sent, span);
+        stream_buffer->used += span;
+        sent += span;
+    }
+    if(sent) {
+        pthread_cond_broadcast(&stream_buffer->changed);
+    }
+
+    pthread_mutex_unlock(&stream_buffer->mutex);
+    return sent;
+}
+
+size_t furi_stream_buffer_receive(
+    FuriStreamBuffer* stream_buffer,
+    void* data,
+    size_t length,
+    uint32_t timeout) {
+    struct timespec deadline;
+    size_t received = 0;
+
+    furi_deadline(&deadline, timeout);
+    pthread_mutex_lock(&stream_buffer->mutex);
+
+    while(stream_buffer->used < MIN(stream_buffer->trigger_level, length)) {
+        if(!furi_cond_wait(&stream_buffer->changed, &stream_buffer->mutex, timeout, &deadline)) {
+            break;
+        }
+    }
+    while(received < length && stream_buffer->used) {
+        size_t span = MIN(length - received, stream_buffer->used);
+        span = MIN(span, stream_buffer->size - stream_buffer->head);
+
+        memcpy((uint8_t*)data + received, &stream_buffer->storage[stream_buffer->head], span);
+        stream_buffer->head = (stream_buffer->head + span) % stream_buffer->size;
+        stream_buffer->used -= span;
+        received += span;
+    }
+    if(received) {
+        pthread_cond_broadcast(&stream_buffer->changed);
+    }
+
+    pthread_mutex_unlock(&stream_buffer->mutex);
+    return received;
+}
+
+size_t furi_stream_buffer_bytes_available(FuriStreamBuffer* stream_buffer) {
+    size_t used;
+
+    pthread_mutex_lock(&stream_buffer->mutex);
+    used = stream_buffer->used;
+    pthread_mutex_unlock(&stream_buffer->mutex);
+
+    return used;
+}
+
+size_t furi_stream_buffer_spaces_available(FuriStreamBuffer* stream_buffer) {
+    return stream_buffer->size - furi_stream_buffer_bytes_available(stream_buffer);
+}
+
+FuriStatus furi_stream_buffer_reset(FuriStreamBuffer* stream_buffer) {
+    pthread_mutex_lock(&stream_buffer->mutex);
+    stream_buffer->head = 0;
+    stream_buffer->used = 0;
+    pthread_cond_broadcast(&stream_buffer->changed);
+    pthread_mutex_unlock(&stream_buffer->mutex);
+
+    return FuriStatusOk;
+}
+
+/**
+ * Strings.
+ */
+
+struct FuriString {
+    char* data;
+    size_t size;
+    size_t capacity;
+};
+
+static void furi_string_reserve(FuriString* string, size_t size) {
+    if(size + 1 > string->capacity) {
+        string->capacity = MAX(size + 1, string->capacity * 2);
+        string->data = realloc(string->data, string->capacity);
+    }
+}
+
+FuriString* furi_string_alloc(void) {
+    FuriString* string = calloc(1, sizeof(FuriString));
+
+    furi_string_reserve(string, 16);
+    string->data[0] = 0;
+
+    return string;
+}
+
+FuriString* furi_string_alloc_set_str(const char* cstr) {
+    FuriString* string = furi_string_alloc();
+    furi_string_set_str(string, cstr);
+    return string;
+}
+
+static int furi_string_cat_vprintf(FuriString* string, const char format[], va_list args) {
+    va_list measure;
+
+    va_copy(measure, args);
+    int length = vsnprintf(NULL, 0, format, measure);
+    va_end(measure);
+
+    if(length > 0) {
+        furi_string_reserve(string, string->size + length);
+        vsnprintf(string->data + string->size, length + 1, format, args);
+        string->size += length;
+    }
+
+    return length;
+}
+
+FuriString* furi_string_alloc_printf(const char format[], ...) {
+    FuriString* string = furi_string_alloc();
+    va_list args;
+
+    va_start(args, format);
+    furi_string_cat_vprintf(string, format, args);
+    va_end(args);
+
+    return string;
+}
+
+void furi_string_free(FuriString* string) {
+    furi_assert(string);
+
+    free(string->data);
+    free(string);
+}
+
+void furi_string_reset(FuriString* string) {
+    string->size = 0;
+    string->data[0] = 0;
+}
+
+void furi_string_set_str(FuriString* string, const char* cstr) {
+    furi_string_reset(string);
+    furi_string_cat_str(string, cstr);
+}
+
+int furi_string_printf(FuriString* string, const char format[], ...) {
+    va_list args;
+
+    furi_string_reset(string);
+    va_start(args, format);
+    int result = furi_string_cat_vprintf(string, format, args);
+    va_end(args);
+
+    return result;
+}
+
+int furi_string_cat_printf(FuriString* string, const char format[], ...) {
+    va_list args;
+
+    va_start(args, format);
+    int result = furi_string_cat_vprintf(string, format, args);
+    va_end(args);
+
+    return result;
+}
+
+void furi_string_cat_str(FuriString* string, const char* cstr) {
+    size_t length = strlen(cstr);
+
+    furi_string_reserve(string, string->size + length);
+    memcpy(string->data + string->size, cstr, length + 1);
+    string->size += length;
+}
+
+const char* furi_string_get_cstr(const FuriString* string) {
+    return string->data;
+}
+
+size_t furi_string_size(const FuriString* string) {
+    return string->size;
+}
+
+/**
+ * Records. None of our host services keep state behind their record, so any
+ * non-null handle will do.
+ */
+
+void* furi_record_open(const char* name) {
+    static uint8_t record;
+
+    UNUSED(name);
+    return &record;
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
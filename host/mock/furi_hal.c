@@ -0,0 +1,1922 @@
+/**
+ * @file furi_hal.c
+ * Host implementation of the HAL stand-ins: a cycle counter, external GPIO, simulated I2C, SPI
+ * and 1-Wire buses, and the timer and DMA controllers the 1-Wire bus is driven by.
+ */
+
+#include "hal_mock.h"
+
+#include <stm32wbxx_ll_dma.h>
+#include <stm32wbxx_ll_system.h>
+#include <stm32wbxx_ll_tim.h>
+
+#include <pthread.h>
+#include <time.h>
+
+/** The device's core clock, which the emulated cycle counter runs at. */
+#define FURI_HAL_MOCK_CYCLES_PER_US 64
+
+static uint64_t furi_hal_mock_monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * Cortex.
+ */
+
+DWT_Type* furi_hal_mock_dwt(void) {
+    static __thread DWT_Type dwt;
+
+    // Like the real counter, this is free-running and wraps at 32 bits.
+    dwt.CYCCNT = (uint32_t)(furi_hal_mock_monotonic_ns() * FURI_HAL_MOCK_CYCLES_PER_US / 1000);
+    return &dwt;
+}
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return FURI_HAL_MOCK_CYCLES_PER_US;
+}
+
+void furi_hal_cortex_delay_us(uint32_t microseconds) {
+    furi_delay_us(microseconds);
+}
+
+/**
+ * GPIO.
+ */
+
+typedef struct {
+    GpioMode mode;
+    GpioAltFn alt_fn;
+    GpioExtiCallback callback;
+    void* context;
+} FuriHalMockGpio;
+
+typedef struct {
+    /** Must come first: pins point at it, and we find our way back from there. */
+    GPIO_TypeDef registers;
+    FuriHalMockGpio pins[16];
+} FuriHalMockGpioPort;
+
+/** Lines idle high, as they would on a pulled-up bus. */
+static FuriHalMockGpioPort furi_hal_mock_gpioa = {.registers.IDR = 0xFFFF};
+static FuriHalMockGpioPort furi_hal_mock_gpiob = {.registers.IDR = 0xFFFF};
+static FuriHalMockGpioPort furi_hal_mock_gpioc = {.registers.IDR = 0xFFFF};
+
+const GpioPin gpio_ext_pa4 = {.port = &furi_hal_mock_gpioa.registers, .pin = (1 << 4)};
+const GpioPin gpio_ext_pa6 = {.port = &furi_hal_mock_gpioa.registers, .pin = (1 << 6)};
+const GpioPin gpio_ext_pa7 = {.port = &furi_hal_mock_gpioa.registers, .pin = (1 << 7)};
+const GpioPin gpio_ext_pb3 = {.port = &furi_hal_mock_gpiob.registers, .pin = (1 << 3)};
+const GpioPin gpio_ext_pc0 = {.port = &furi_hal_mock_gpioc.registers, .pin = (1 << 0)};
+const GpioPin gpio_ext_pc1 = {.port = &furi_hal_mock_gpioc.registers, .pin = (1 << 1)};
+
+static FuriHalMockGpio* furi_hal_mock_gpio(const GpioPin* gpio) {
+    return &((FuriHalMockGpioPort*)gpio->port)->pins[__builtin_ctz(gpio->pin)];
+}
+
+static void furi_hal_mock_spi_chip_select(const GpioPin* gpio, bool level);
+static bool furi_hal_mock_i2c_pins_drive(const GpioPin* gpio, bool level);
+
+void furi_hal_gpio_init(const GpioPin* gpio, GpioMode mode, GpioPull pull, GpioSpeed speed) {
+    furi_hal_gpio_init_ex(gpio, mode, pull, speed, GpioAltFnUnused);
+}
+
+void furi_hal_gpio_init_simple(const GpioPin* gpio, GpioMode mode) {
+    furi_hal_gpio_init_ex(gpio, mode, GpioPullNo, GpioSpeedLow, GpioAltFnUnused);
+}
+
+void furi_hal_gpio_init_ex(
+    const GpioPin* gpio,
+    GpioMode mode,
+    GpioPull pull,
+    GpioSpeed speed,
+    GpioAltFn alt_fn) {
+    UNUSED(pull);
+    UNUSED(speed);
+
+    FuriHalMockGpio* pin = furi_hal_mock_gpio(gpio);
+    pin->mode = mode;
+    pin->alt_fn = alt_fn;
+}
+
+void furi_hal_gpio_add_int_callback(const GpioPin* gpio, GpioExtiCallback callback, void* context) {
+    FuriHalMockGpio* pin = furi_hal_mock_gpio(gpio);
+
+    furi_check(!pin->callback);
+    pin->context = context;
+    pin->callback = callback;
+}
+
+void furi_hal_gpio_remove_int_callback(const GpioPin* gpio) {
+    FuriHalMockGpio* pin = furi_hal_mock_gpio(gpio);
+
+    pin->callback = NULL;
+    pin->context = NULL;
+}
+
+void furi_hal_mock_gpio_write(const GpioPin* gpio, bool level) {
+    FuriHalMockGpio* pin = furi_hal_mock_gpio(gpio);
+    bool previous = furi_hal_gpio_read(gpio);
+
+    if(level) {
+        gpio->port->IDR |= gpio->pin;
+    } else {
+        gpio->port->IDR &= ~gpio->pin;
+    }
+
+    if(level == previous || !pin->callback) {
+        return;
+    }
+
+    bool triggered = (pin->mode == GpioModeInterruptRiseFall) ||
+                     (pin->mode == GpioModeInterruptRise && level) ||
+                     (pin->mode == GpioModeInterruptFall && !level);
+    if(triggered) {
+        pin->callback(pin->context);
+    }
+}
+
+void furi_hal_gpio_write(const GpioPin* gpio, bool state) {
+    // The I2C pins are open drain, and shared with whatever's on the far end of them.
+    if(furi_hal_mock_i2c_pins_drive(gpio, state)) {
+        return;
+    }
+
+    bool previous = furi_hal_gpio_read(gpio);
+
+    if(state) {
+        gpio->port->IDR |= gpio->pin;
+    } else {
+        gpio->port->IDR &= ~gpio->pin;
+    }
+
+    // Outputs don't raise interrupts; but one of them might be selecting a simulated device.
+    if(state != previous) {
+        furi_hal_mock_spi_chip_select(gpio, state);
+    }
+}
+
+/**
+ * I2C.
+ */
+
+struct FuriHalMockI2cBus {
+    pthread_mutex_t mutex;
+
+    /** Attached devices, by 7-bit address; and the fastest clock each keeps up with, in kHz. */
+    FuriHalMockI2cDevice devices[128];
+    bool present[128];
+    uint32_t max_speed[128];
+
+    /** The device the current transaction is addressed to, if any. */
+    FuriHalMockI2cDevice* active;
+
+    /** Whether reads from it come back garbled, because the bus is clocked too fast for it. */
+    bool overclocked;
+};
+
+/** The timing the HAL loads on each acquire, for a 100 kHz clock from the 64 MHz kernel clock. */
+#define FURI_HAL_MOCK_I2C_TIMINGS_100 0x10707DBC
+
+/**
+ * Kernel clocks each SCL period loses to synchronizing with the lines and waiting out their
+ * rise time, beyond what the timing register asks for; the reference timings assume about this.
+ */
+#define FURI_HAL_MOCK_I2C_SYNC_CYCLES 10
+
+/** Without Fast-mode Plus drive, the pins can't move the lines any faster than this, in kHz. */
+#define FURI_HAL_MOCK_I2C_FAST_MODE_MAX 400
+
+static I2C_TypeDef furi_hal_mock_i2c1;
+static I2C_TypeDef furi_hal_mock_i2c3;
+static FuriHalI2cBus furi_hal_mock_i2c_bus_power = {.i2c = &furi_hal_mock_i2c1};
+static FuriHalI2cBus furi_hal_mock_i2c_bus_external = {.i2c = &furi_hal_mock_i2c3};
+static struct FuriHalMockI2cBus furi_hal_mock_i2c_power = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+static struct FuriHalMockI2cBus furi_hal_mock_i2c_external = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+FuriHalI2cBusHandle furi_hal_i2c_handle_power = {
+    .bus = &furi_hal_mock_i2c_bus_power,
+    .mock = &furi_hal_mock_i2c_power,
+};
+FuriHalI2cBusHandle furi_hal_i2c_handle_external = {
+    .bus = &furi_hal_mock_i2c_bus_external,
+    .mock = &furi_hal_mock_i2c_external,
+};
+
+SYSCFG_TypeDef furi_hal_mock_syscfg;
+
+static bool furi_hal_mock_i2c_clocked;
+static uint64_t furi_hal_mock_i2c_bytes;
+
+/** The clock a handle's peripheral is set to, in kHz, as its timing register works out. */
+static uint32_t furi_hal_mock_i2c_speed(FuriHalI2cBusHandle* handle) {
+    uint32_t timing = LL_I2C_GetTiming(handle->bus->i2c);
+    uint32_t prescaler = ((timing & I2C_TIMINGR_PRESC) >> I2C_TIMINGR_PRESC_Pos) + 1;
+    uint32_t low = ((timing & I2C_TIMINGR_SCLL) >> I2C_TIMINGR_SCLL_Pos) + 1;
+    uint32_t high = ((timing & I2C_TIMINGR_SCLH) >> I2C_TIMINGR_SCLH_Pos) + 1;
+
+    return FURI_HAL_MOCK_CYCLES_PER_US * 1000 / (prescaler * (low + high) + FURI_HAL_MOCK_I2C_SYNC_CYCLES);
+}
+
+/**
+ * Accounts for a byte crossing the wire; taking as long as the peripheral's clock says it would,
+ * if there's a peripheral to ask. Whoever bit-bangs the pins paces themselves.
+ */
+static void furi_hal_mock_i2c_clock_byte(FuriHalI2cBusHandle* handle) {
+    furi_hal_mock_i2c_bytes += 1;
+
+    if(handle && furi_hal_mock_i2c_clocked) {
+        uint64_t end = furi_hal_mock_monotonic_ns() + 9ULL * 1000000 / furi_hal_mock_i2c_speed(handle);
+        while(furi_hal_mock_monotonic_ns() < end) {
+        }
+    }
+}
+
+static void furi_hal_mock_i2c_stop(FuriHalI2cBusHandle* handle) {
+    struct FuriHalMockI2cBus* mock = handle->mock;
+
+    if(mock->active && mock->active->stop) {
+        mock->active->stop(mock->active->context);
+    }
+    mock->active = NULL;
+}
+
+/** Runs the address phase of a transfer. Returns false if nobody acknowledged. */
+static bool furi_hal_mock_i2c_begin(
+    FuriHalI2cBusHandle* handle,
+    uint16_t address,
+    FuriHalI2cBegin begin,
+    bool read) {
+    struct FuriHalMockI2cBus* mock = handle->mock;
+    furi_check(LL_I2C_IsEnabled(handle->bus->i2c));
+
+    // Resuming carries on where the last transfer paused, with no address phase.
+    if(begin == FuriHalI2cBeginResume) {
+        return mock->active != NULL;
+    }
+
+    furi_hal_mock_i2c_clock_byte(handle);
+
+    FuriHalMockI2cDevice* device = NULL;
+    uint8_t index = (address >> 1) & 0x7F;
+    if(mock->present[index]) {
+        device = &mock->devices[index];
+    }
+
+    // Addressing still works on an overclocked device; it's the data it sends back that suffers.
+    uint32_t speed = furi_hal_mock_i2c_speed(handle);
+    bool fast_mode_plus = (handle->bus->i2c != &furi_hal_mock_i2c3) ||
+                          (SYSCFG->CFGR1 & SYSCFG_CFGR1_I2C3_FMP);
+    mock->overclocked = (mock->max_speed[index] && (speed > mock->max_speed[index])) ||
+                        (!fast_mode_plus && (speed > FURI_HAL_MOCK_I2C_FAST_MODE_MAX));
+
+    // A restart to a different device leaves the previous one waiting for a stop that never comes;
+    // that's fine for the simple devices we simulate.
+    mock->active = device;
+    if(!device || (device->start && !device->start(device->context, read))) {
+        furi_hal_mock_i2c_stop(handle);
+        return false;
+    }
+
+    return true;
+}
+
+static void furi_hal_mock_i2c_end(FuriHalI2cBusHandle* handle, FuriHalI2cEnd end) {
+    if(end == FuriHalI2cEndStop) {
+        furi_hal_mock_i2c_stop(handle);
+    }
+}
+
+void furi_hal_i2c_acquire(FuriHalI2cBusHandle* handle) {
+    pthread_mutex_lock(&handle->mock->mutex);
+
+    // As the HAL does, each acquire starts the peripheral afresh at the standard clock.
+    LL_I2C_Disable(handle->bus->i2c);
+    LL_I2C_SetTiming(handle->bus->i2c, FURI_HAL_MOCK_I2C_TIMINGS_100);
+    LL_I2C_Enable(handle->bus->i2c);
+}
+
+void furi_hal_i2c_release(FuriHalI2cBusHandle* handle) {
+    LL_I2C_Disable(handle->bus->i2c);
+    pthread_mutex_unlock(&handle->mock->mutex);
+}
+
+bool furi_hal_i2c_tx_ext(
+    FuriHalI2cBusHandle* handle,
+    uint16_t address,
+    bool ten_bit,
+    const uint8_t* data,
+    size_t size,
+    FuriHalI2cBegin begin,
+    FuriHalI2cEnd end,
+    uint32_t timeout) {
+    UNUSED(timeout);
+    furi_check(!ten_bit);
+
+    if(!furi_hal_mock_i2c_begin(handle, address, begin, false)) {
+        return false;
+    }
+
+    for(size_t i = 0; i < size; ++i) {
+        FuriHalMockI2cDevice* device = handle->mock->active;
+        furi_hal_mock_i2c_clock_byte(handle);
+
+        if(device->write && !device->write(device->context, data[i])) {
+            furi_hal_mock_i2c_stop(handle);
+            return false;
+        }
+    }
+
+    furi_hal_mock_i2c_end(handle, end);
+    return true;
+}
+
+bool furi_hal_i2c_rx_ext(
+    FuriHalI2cBusHandle* handle,
+    uint16_t address,
+    bool ten_bit,
+    uint8_t* data,
+    size_t size,
+    FuriHalI2cBegin begin,
+    FuriHalI2cEnd end,
+    uint32_t timeout) {
+    UNUSED(timeout);
+    furi_check(!ten_bit);
+
+    if(!furi_hal_mock_i2c_begin(handle, address, begin, true)) {
+        return false;
+    }
+
+    // Nothing drives the bus for a device without a read hook; the lines just float high. A device
+    // that can't keep up with the clock shifts each bit out a clock late, so the first reads high.
+    for(size_t i = 0; i < size; ++i) {
+        FuriHalMockI2cDevice* device = handle->mock->active;
+        furi_hal_mock_i2c_clock_byte(handle);
+
+        data[i] = device->read ? device->read(device->context) : 0xFF;
+        if(handle->mock->overclocked) {
+            data[i] = (data[i] >> 1) | 0x80;
+        }
+    }
+
+    furi_hal_mock_i2c_end(handle, end);
+    return true;
+}
+
+bool furi_hal_i2c_tx(
+    FuriHalI2cBusHandle* handle,
+    uint8_t address,
+    const uint8_t* data,
+    size_t size,
+    uint32_t timeout) {
+    return furi_hal_i2c_tx_ext(
+        handle, address, false, data, size, FuriHalI2cBeginStart, FuriHalI2cEndStop, timeout);
+}
+
+bool furi_hal_i2c_rx(
+    FuriHalI2cBusHandle* handle,
+    uint8_t address,
+    uint8_t* data,
+    size_t size,
+    uint32_t timeout) {
+    return furi_hal_i2c_rx_ext(
+        handle, address, false, data, size, FuriHalI2cBeginStart, FuriHalI2cEndStop, timeout);
+}
+
+bool furi_hal_i2c_trx(
+    FuriHalI2cBusHandle* handle,
+    uint8_t address,
+    const uint8_t* tx_data,
+    size_t tx_size,
+    uint8_t* rx_data,
+    size_t rx_size,
+    uint32_t timeout) {
+    return furi_hal_i2c_tx_ext(
+               handle,
+               address,
+               false,
+               tx_data,
+               tx_size,
+               FuriHalI2cBeginStart,
+               FuriHalI2cEndAwaitRestart,
+               timeout) &&
+           furi_hal_i2c_rx_ext(
+               handle,
+               address | 1,
+               false,
+               rx_data,
+               rx_size,
+               FuriHalI2cBeginRestart,
+               FuriHalI2cEndStop,
+               timeout);
+}
+
+bool furi_hal_i2c_is_device_ready(FuriHalI2cBusHandle* handle, uint8_t addr, uint32_t timeout) {
+    return furi_hal_i2c_tx_ext(
+        handle, addr, false, NULL, 0, FuriHalI2cBeginStart, FuriHalI2cEndStop, timeout);
+}
+
+/**
+ * I2C, bit-banged: a bit-level model of the external bus' pins, with a simulated target that
+ * answers on behalf of whichever attached device is addressed.
+ */
+
+typedef enum {
+    FuriHalMockI2cPinsIdle,
+    FuriHalMockI2cPinsAddress,
+    FuriHalMockI2cPinsWrite,
+    FuriHalMockI2cPinsRead,
+
+    /** Not acknowledged; nothing more to do until the next start or stop. */
+    FuriHalMockI2cPinsIgnore,
+} FuriHalMockI2cPinsState;
+
+static struct {
+    /** What the app's driving each line to; being open drain, high just means let go. */
+    bool scl;
+    bool sda;
+
+    /** Whether the target is holding SDA low. */
+    bool target_sda_low;
+
+    FuriHalMockI2cPinsState state;
+    FuriHalMockI2cDevice* device;
+    uint8_t shift;
+    uint8_t bits;
+
+    /** Whether we're in the ninth clock; and whether it was an ACK. */
+    bool ack_bit;
+    bool acked;
+} furi_hal_mock_i2c_pins = {.scl = true, .sda = true};
+
+static void furi_hal_mock_i2c_pins_set_line(const GpioPin* gpio, bool level) {
+    if(level) {
+        gpio->port->IDR |= gpio->pin;
+    } else {
+        gpio->port->IDR &= ~gpio->pin;
+    }
+}
+
+/** Works out what the lines read as, given everyone pulling on them. */
+static void furi_hal_mock_i2c_pins_settle(void) {
+    furi_hal_mock_i2c_pins_set_line(&gpio_ext_pc0, furi_hal_mock_i2c_pins.scl);
+    furi_hal_mock_i2c_pins_set_line(
+        &gpio_ext_pc1, furi_hal_mock_i2c_pins.sda && !furi_hal_mock_i2c_pins.target_sda_low);
+}
+
+/** The target puts the next bit of the byte being read on SDA. */
+static void furi_hal_mock_i2c_pins_drive_bit(void) {
+    furi_hal_mock_i2c_pins.target_sda_low = !(furi_hal_mock_i2c_pins.shift & (0x80 >> furi_hal_mock_i2c_pins.bits));
+    furi_hal_mock_i2c_pins.bits += 1;
+}
+
+/** Fetches the next byte for the app to read, and starts driving it. */
+static void furi_hal_mock_i2c_pins_load(void) {
+    FuriHalMockI2cDevice* device = furi_hal_mock_i2c_pins.device;
+
+    furi_hal_mock_i2c_pins.shift = device->read ? device->read(device->context) : 0xFF;
+    furi_hal_mock_i2c_pins.bits = 0;
+    furi_hal_mock_i2c_pins_drive_bit();
+}
+
+static void furi_hal_mock_i2c_pins_start(void) {
+    // As with the HAL, a repeated start leaves the previous device waiting on a stop.
+    furi_hal_mock_i2c_pins.state = FuriHalMockI2cPinsAddress;
+    furi_hal_mock_i2c_pins.shift = 0;
+    furi_hal_mock_i2c_pins.bits = 0;
+    furi_hal_mock_i2c_pins.ack_bit = false;
+    furi_hal_mock_i2c_pins.target_sda_low = false;
+}
+
+static void furi_hal_mock_i2c_pins_stop(void) {
+    FuriHalMockI2cDevice* device = furi_hal_mock_i2c_pins.device;
+
+    if(device && device->stop) {
+        device->stop(device->context);
+    }
+    furi_hal_mock_i2c_pins.device = NULL;
+    furi_hal_mock_i2c_pins.state = FuriHalMockI2cPinsIdle;
+    furi_hal_mock_i2c_pins.target_sda_low = false;
+}
+
+static void furi_hal_mock_i2c_pins_clock_rise(bool sda) {
+    if(furi_hal_mock_i2c_pins.ack_bit) {
+        // Reading, the app acknowledges; writing, we've already decided.
+        if(furi_hal_mock_i2c_pins.state == FuriHalMockI2cPinsRead) {
+            furi_hal_mock_i2c_pins.acked = !sda;
+        }
+    } else if(
+        furi_hal_mock_i2c_pins.state == FuriHalMockI2cPinsAddress ||
+        furi_hal_mock_i2c_pins.state == FuriHalMockI2cPinsWrite) {
+        furi_hal_mock_i2c_pins.shift = (furi_hal_mock_i2c_pins.shift << 1) | sda;
+        furi_hal_mock_i2c_pins.bits += 1;
+    }
+}
+
+/** Takes a whole byte from the app; returns whether the target acknowledges it. */
+static bool furi_hal_mock_i2c_pins_receive(void) {
+    struct FuriHalMockI2cBus* mock = &furi_hal_mock_i2c_external;
+    uint8_t data = furi_hal_mock_i2c_pins.shift;
+
+    furi_hal_mock_i2c_clock_byte(NULL);
+
+    if(furi_hal_mock_i2c_pins.state == FuriHalMockI2cPinsWrite) {
+        FuriHalMockI2cDevice* device = furi_hal_mock_i2c_pins.device;
+        return !device->write || device->write(device->context, data);
+    }
+
+    FuriHalMockI2cDevice* device = mock->present[data >> 1] ? &mock->devices[data >> 1] : NULL;
+    if(!device || (device->start && !device->start(device->context, data & 1))) {
+        furi_hal_mock_i2c_pins.device = NULL;
+        return false;
+    }
+
+    furi_hal_mock_i2c_pins.device = device;
+    return true;
+}
+
+/** Everything the target drives changes while SCL is low; so it all happens here. */
+static void furi_hal_mock_i2c_pins_clock_fall(void) {
+    switch(furi_hal_mock_i2c_pins.state) {
+    case FuriHalMockI2cPinsAddress:
+    case FuriHalMockI2cPinsWrite:
+        if(!furi_hal_mock_i2c_pins.ack_bit) {
+            if(furi_hal_mock_i2c_pins.bits == 8) {
+                furi_hal_mock_i2c_pins.ack_bit = true;
+                furi_hal_mock_i2c_pins.acked = furi_hal_mock_i2c_pins_receive();
+                furi_hal_mock_i2c_pins.target_sda_low = furi_hal_mock_i2c_pins.acked;
+            }
+            break;
+        }
+
+        // The ninth clock's over; on to the next byte, in whichever direction the address said.
+        furi_hal_mock_i2c_pins.ack_bit = false;
+        furi_hal_mock_i2c_pins.target_sda_low = false;
+        if(!furi_hal_mock_i2c_pins.acked) {
+            furi_hal_mock_i2c_pins.state = FuriHalMockI2cPinsIgnore;
+        } else if(furi_hal_mock_i2c_pins.state == FuriHalMockI2cPinsAddress && (furi_hal_mock_i2c_pins.shift & 1)) {
+            furi_hal_mock_i2c_pins.state = FuriHalMockI2cPinsRead;
+            furi_hal_mock_i2c_pins_load();
+        } else {
+            furi_hal_mock_i2c_pins.state = FuriHalMockI2cPinsWrite;
+            furi_hal_mock_i2c_pins.shift = 0;
+            furi_hal_mock_i2c_pins.bits = 0;
+        }
+        break;
+
+    case FuriHalMockI2cPinsRead:
+        if(furi_hal_mock_i2c_pins.ack_bit) {
+            furi_hal_mock_i2c_pins.ack_bit = false;
+            if(furi_hal_mock_i2c_pins.acked) {
+                furi_hal_mock_i2c_pins_load();
+            } else {
+                furi_hal_mock_i2c_pins.state = FuriHalMockI2cPinsIgnore;
+            }
+        } else if(furi_hal_mock_i2c_pins.bits < 8) {
+            furi_hal_mock_i2c_pins_drive_bit();
+        } else {
+            // Let go of SDA, so the app can acknowledge.
+            furi_hal_mock_i2c_clock_byte(NULL);
+            furi_hal_mock_i2c_pins.ack_bit = true;
+            furi_hal_mock_i2c_pins.target_sda_low = false;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/** Handles the app driving one of the I2C pins. Returns false if the pin's not one of them. */
+static bool furi_hal_mock_i2c_pins_drive(const GpioPin* gpio, bool level) {
+    if(gpio->port != gpio_ext_pc0.port || !(gpio->pin & (gpio_ext_pc0.pin | gpio_ext_pc1.pin))) {
+        return false;
+    }
+
+    bool scl = furi_hal_gpio_read(&gpio_ext_pc0);
+    bool sda = furi_hal_gpio_read(&gpio_ext_pc1);
+
+    if(gpio->pin == gpio_ext_pc0.pin) {
+        furi_hal_mock_i2c_pins.scl = level;
+    } else {
+        furi_hal_mock_i2c_pins.sda = level;
+    }
+    furi_hal_mock_i2c_pins_settle();
+
+    bool new_scl = furi_hal_gpio_read(&gpio_ext_pc0);
+    bool new_sda = furi_hal_gpio_read(&gpio_ext_pc1);
+
+    // SDA only ever moves under a high clock to start or stop a transaction.
+    if(scl && new_scl && (sda != new_sda)) {
+        if(new_sda) {
+            furi_hal_mock_i2c_pins_stop();
+        } else {
+            furi_hal_mock_i2c_pins_start();
+        }
+    } else if(!scl && new_scl) {
+        furi_hal_mock_i2c_pins_clock_rise(new_sda);
+    } else if(scl && !new_scl) {
+        furi_hal_mock_i2c_pins_clock_fall();
+    }
+
+    furi_hal_mock_i2c_pins_settle();
+    return true;
+}
+
+/**
+ * SPI.
+ */
+
+static SPI_TypeDef furi_hal_mock_spi1;
+static FuriHalSpiBus furi_hal_mock_spi_bus_r = {.spi = &furi_hal_mock_spi1};
+static pthread_mutex_t furi_hal_mock_spi_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+FuriHalSpiBusHandle furi_hal_spi_bus_handle_external = {
+    .bus = &furi_hal_mock_spi_bus_r,
+    .miso = &gpio_ext_pa6,
+    .mosi = &gpio_ext_pa7,
+    .sck = &gpio_ext_pb3,
+    .cs = &gpio_ext_pa4,
+};
+
+static FuriHalMockSpiDevice furi_hal_mock_spi_device;
+static bool furi_hal_mock_spi_clocked;
+static uint64_t furi_hal_mock_spi_bytes;
+static uint64_t furi_hal_mock_spi_dma_transfers;
+
+static void furi_hal_mock_spi_chip_select(const GpioPin* gpio, bool level) {
+    FuriHalMockSpiDevice* device = &furi_hal_mock_spi_device;
+
+    if(gpio != furi_hal_spi_bus_handle_external.cs) {
+        return;
+    }
+
+    if(!level && device->select) {
+        device->select(device->context);
+    } else if(level && device->deselect) {
+        device->deselect(device->context);
+    }
+}
+
+/** Moves a single byte each way, taking as long as the peripheral's clock says it would. */
+static uint8_t furi_hal_mock_spi_exchange(FuriHalSpiBusHandle* handle, uint8_t data) {
+    FuriHalMockSpiDevice* device = &furi_hal_mock_spi_device;
+    furi_hal_mock_spi_bytes += 1;
+
+    if(furi_hal_mock_spi_clocked) {
+        // The peripheral runs from the 64 MHz core clock, divided by 2^(BR + 1).
+        uint32_t divider = 2 << (LL_SPI_GetBaudRatePrescaler(handle->bus->spi) >> SPI_CR1_BR_Pos);
+        uint64_t end = furi_hal_mock_monotonic_ns() + 8ULL * divider * 1000 / FURI_HAL_MOCK_CYCLES_PER_US;
+        while(furi_hal_mock_monotonic_ns() < end) {
+        }
+    }
+
+    // Nothing drives MISO without a selected device; the line just floats high.
+    if(furi_hal_gpio_read(handle->cs) || !device->exchange) {
+        return 0xFF;
+    }
+    return device->exchange(device->context, data);
+}
+
+void furi_hal_spi_acquire(FuriHalSpiBusHandle* handle) {
+    pthread_mutex_lock(&furi_hal_mock_spi_mutex);
+    LL_SPI_Enable(handle->bus->spi);
+    furi_hal_gpio_write(handle->cs, false);
+}
+
+void furi_hal_spi_release(FuriHalSpiBusHandle* handle) {
+    furi_hal_gpio_write(handle->cs, true);
+    LL_SPI_Disable(handle->bus->spi);
+    pthread_mutex_unlock(&furi_hal_mock_spi_mutex);
+}
+
+bool furi_hal_spi_bus_trx(
+    FuriHalSpiBusHandle* handle,
+    const uint8_t* tx_buffer,
+    uint8_t* rx_buffer,
+    size_t size,
+    uint32_t timeout) {
+    UNUSED(timeout);
+    furi_check(handle->bus->spi->CR1 & SPI_CR1_SPE);
+
+    for(size_t i = 0; i < size; ++i) {
+        uint8_t received = furi_hal_mock_spi_exchange(handle, tx_buffer ? tx_buffer[i] : 0xFF);
+        if(rx_buffer) {
+            rx_buffer[i] = received;
+        }
+    }
+
+    return true;
+}
+
+bool furi_hal_spi_bus_tx(
+    FuriHalSpiBusHandle* handle,
+    const uint8_t* buffer,
+    size_t size,
+    uint32_t timeout) {
+    return furi_hal_spi_bus_trx(handle, buffer, NULL, size, timeout);
+}
+
+bool furi_hal_spi_bus_rx(FuriHalSpiBusHandle* handle, uint8_t* buffer, size_t size, uint32_t timeout) {
+    return furi_hal_spi_bus_trx(handle, NULL, buffer, size, timeout);
+}
+
+bool furi_hal_spi_bus_trx_dma(
+    FuriHalSpiBusHandle* handle,
+    uint8_t* tx_buffer,
+    uint8_t* rx_buffer,
+    size_t size,
+    uint32_t timeout_ms) {
+    furi_check(size > 0);
+
+    furi_hal_mock_spi_dma_transfers += 1;
+    return furi_hal_spi_bus_trx(handle, tx_buffer, rx_buffer, size, timeout_ms);
+}
+
+void furi_hal_mock_spi_set_clocked(bool clocked) {
+    furi_hal_mock_spi_clocked = clocked;
+}
+
+uint64_t furi_hal_mock_spi_get_byte_count(void) {
+    return furi_hal_mock_spi_bytes;
+}
+
+uint64_t furi_hal_mock_spi_get_dma_count(void) {
+    return furi_hal_mock_spi_dma_transfers;
+}
+
+/**
+ * Peripheral clocks and interrupts.
+ */
+
+static bool furi_hal_mock_bus_enabled[FuriHalBusMAX];
+
+static struct {
+    FuriHalInterruptISR isr;
+    void* context;
+} furi_hal_mock_interrupts[FuriHalInterruptIdMax];
+
+void furi_hal_bus_enable(FuriHalBus bus) {
+    furi_check(!furi_hal_mock_bus_enabled[bus]);
+    furi_hal_mock_bus_enabled[bus] = true;
+}
+
+void furi_hal_bus_disable(FuriHalBus bus) {
+    furi_check(furi_hal_mock_bus_enabled[bus]);
+    furi_hal_mock_bus_enabled[bus] = false;
+}
+
+bool furi_hal_bus_is_enabled(FuriHalBus bus) {
+    return furi_hal_mock_bus_enabled[bus];
+}
+
+void furi_hal_interrupt_set_isr(FuriHalInterruptId index, FuriHalInterruptISR isr, void* context) {
+    furi_check(index < FuriHalInterruptIdMax);
+    furi_check(!isr || !furi_hal_mock_interrupts[index].isr);
+
+    furi_hal_mock_interrupts[index].context = context;
+    furi_hal_mock_interrupts[index].isr = isr;
+}
+
+static void furi_hal_mock_interrupt(FuriHalInterruptId index) {
+    if(furi_hal_mock_interrupts[index].isr) {
+        furi_hal_mock_interrupts[index].isr(furi_hal_mock_interrupts[index].context);
+    }
+}
+
+/**
+ * DMA.
+ */
+
+DMA_TypeDef furi_hal_mock_dma1;
+DMA_TypeDef furi_hal_mock_dma2;
+
+/** Moves a single item on whichever enabled channel the request is routed to, if any. */
+static void furi_hal_mock_dma_request(uint32_t request) {
+    DMA_TypeDef* controllers[] = {DMA1, DMA2};
+    const FuriHalInterruptId first_interrupt[] = {FuriHalInterruptIdDma1Ch1, FuriHalInterruptIdDma2Ch1};
+
+    for(size_t i = 0; i < COUNT_OF(controllers); ++i) {
+        for(size_t channel = 0; channel < COUNT_OF(controllers[i]->channels); ++channel) {
+            DMA_Channel_TypeDef* ch = &controllers[i]->channels[channel];
+
+            if(ch->request != request || !(ch->CCR & DMA_CCR_EN) || !ch->CNDTR) {
+                continue;
+            }
+
+            uint32_t memory_size = 1 << ((ch->CCR & DMA_CCR_MSIZE) >> DMA_CCR_MSIZE_Pos);
+            uint32_t periph_size = 1 << ((ch->CCR & DMA_CCR_PSIZE) >> DMA_CCR_PSIZE_Pos);
+            uintptr_t memory = ch->CMAR + ((ch->CCR & DMA_CCR_MINC) ? ch->moved * memory_size : 0);
+            uintptr_t periph = ch->CPAR + ((ch->CCR & DMA_CCR_PINC) ? ch->moved * periph_size : 0);
+
+            // Narrower items are zero extended on their way to wider ones, and truncated on the way back.
+            uint32_t item = 0;
+            if(ch->CCR & DMA_CCR_DIR) {
+                memcpy(&item, (const void*)memory, memory_size);
+                memcpy((void*)periph, &item, periph_size);
+            } else {
+                memcpy(&item, (const void*)periph, periph_size);
+                memcpy((void*)memory, &item, memory_size);
+            }
+
+            ch->moved += 1;
+            ch->CNDTR -= 1;
+
+            if(!ch->CNDTR) {
+                controllers[i]->ISR |= DMA_ISR_TCIF(channel);
+                if(ch->CCR & DMA_CCR_TCIE) {
+                    furi_hal_mock_interrupt(first_interrupt[i] + channel);
+                }
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * TIM2. The counter ticks at the 64 MHz core clock over its prescaler. Channel 2 is PWM mode 2,
+ * driving the 1-Wire line low from each update until the compare; and channel 1 captures the
+ * line's edges, through TI2. Periods run in real time, on a thread of their own.
+ */
+
+TIM_TypeDef furi_hal_mock_tim2;
+
+typedef struct {
+    uint32_t time;
+    bool level;
+} FuriHalMockEdge;
+
+/** Largest number of edges the bus can make in a single period. */
+#define FURI_HAL_MOCK_EDGES_MAX 4
+
+static size_t furi_hal_mock_onewire_period(uint32_t low, uint32_t length, FuriHalMockEdge* edges);
+
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    pthread_t thread;
+    bool started;
+
+    /** True while the thread is mid-period, and so may be touching registers. */
+    bool running;
+
+    /** The compare the current period runs with, loaded from CCR2 at each update. */
+    uint32_t compare;
+} furi_hal_mock_tim = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .changed = PTHREAD_COND_INITIALIZER,
+};
+
+static bool furi_hal_mock_tim_in_interrupt(void) {
+    return furi_hal_mock_tim.started && pthread_equal(pthread_self(), furi_hal_mock_tim.thread);
+}
+
+void furi_hal_mock_tim_update(TIM_TypeDef* tim) {
+    furi_check(tim == TIM2);
+
+    tim->CNT = 0;
+    furi_hal_mock_tim.compare = tim->CCR2;
+    tim->SR |= TIM_SR_UIF;
+
+    if(tim->DIER & TIM_DIER_UDE) {
+        furi_hal_mock_dma_request(LL_DMAMUX_REQ_TIM2_UP);
+    }
+    if(tim->DIER & TIM_DIER_UIE) {
+        furi_hal_mock_interrupt(FuriHalInterruptIdTIM2);
+    }
+}
+
+static void furi_hal_mock_tim_capture(TIM_TypeDef* tim, uint32_t time) {
+    tim->CCR1 = time;
+
+    if(tim->SR & TIM_SR_CC1IF) {
+        tim->SR |= TIM_SR_CC1OF;
+    }
+    tim->SR |= TIM_SR_CC1IF;
+
+    // Reading the capture, as the DMA does, clears its flag.
+    if(tim->DIER & TIM_DIER_CC1DE) {
+        furi_hal_mock_dma_request(LL_DMAMUX_REQ_TIM2_CH1);
+        tim->SR &= ~TIM_SR_CC1IF;
+    }
+    if(tim->DIER & TIM_DIER_CC1IE) {
+        furi_hal_mock_interrupt(FuriHalInterruptIdTIM2);
+    }
+}
+
+/** Runs a single period, from one update to the next; returns how long it took, in nanoseconds. */
+static uint64_t furi_hal_mock_tim_period(TIM_TypeDef* tim) {
+    uint32_t length = tim->ARR + 1;
+    uint32_t low = 0;
+    FuriHalMockEdge edges[FURI_HAL_MOCK_EDGES_MAX];
+
+    // Only PWM mode 2, out of the timer's own pin function, ever pulls the line down.
+    bool driving = (tim->CCER & TIM_CCER_CC2E) &&
+                   ((tim->CCMR1 & TIM_CCMR1_OC2M) == LL_TIM_OCMODE_PWM2) &&
+                   (furi_hal_mock_gpio(&gpio_ext_pb3)->mode == GpioModeAltFunctionOpenDrain) &&
+                   (furi_hal_mock_gpio(&gpio_ext_pb3)->alt_fn == GpioAltFn1TIM2);
+    if(driving) {
+        low = MIN(furi_hal_mock_tim.compare, length);
+    }
+
+    size_t count = furi_hal_mock_onewire_period(low, length, edges);
+    bool capturing = (tim->CCER & TIM_CCER_CC1E) &&
+                     ((tim->CCMR1 & TIM_CCMR1_CC1S) == LL_TIM_ACTIVEINPUT_INDIRECTTI);
+    bool falling = tim->CCER & TIM_CCER_CC1P;
+
+    for(size_t i = 0; capturing && i < count; ++i) {
+        if(edges[i].level != falling) {
+            furi_hal_mock_tim_capture(tim, edges[i].time);
+        }
+    }
+
+    return (uint64_t)length * (tim->PSC + 1) * 1000 / FURI_HAL_MOCK_CYCLES_PER_US;
+}
+
+static void* furi_hal_mock_tim_worker(void* context) {
+    TIM_TypeDef* tim = context;
+
+    pthread_mutex_lock(&furi_hal_mock_tim.mutex);
+    for(;;) {
+        while(!(tim->CR1 & TIM_CR1_CEN)) {
+            pthread_cond_wait(&furi_hal_mock_tim.changed, &furi_hal_mock_tim.mutex);
+        }
+
+        furi_hal_mock_tim.running = true;
+        uint64_t deadline = furi_hal_mock_monotonic_ns();
+
+        while(tim->CR1 & TIM_CR1_CEN) {
+            pthread_mutex_unlock(&furi_hal_mock_tim.mutex);
+
+            // Each period's edges land together, and then we wait out the rest of it; which is
+            // all anyone can tell, since nothing looks at the counter mid-period.
+            deadline += furi_hal_mock_tim_period(tim);
+            if(deadline > furi_hal_mock_monotonic_ns()) {
+                struct timespec until = {
+                    .tv_sec = deadline / 1000000000,
+                    .tv_nsec = deadline % 1000000000,
+                };
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL);
+            }
+
+            // The interrupts run as the next period begins, so they may well stop the counter.
+            if(tim->CR1 & TIM_CR1_CEN) {
+                furi_hal_mock_tim_update(tim);
+            }
+
+            pthread_mutex_lock(&furi_hal_mock_tim.mutex);
+        }
+
+        furi_hal_mock_tim.running = false;
+        pthread_cond_broadcast(&furi_hal_mock_tim.changed);
+    }
+
+    return NULL;
+}
+
+void furi_hal_mock_tim_counter_changed(TIM_TypeDef* tim) {
+    furi_check(tim == TIM2);
+    furi_check(furi_hal_mock_bus_enabled[FuriHalBusTIM2]);
+
+    // Interrupts stop the counter from the timer's own thread; which notices on its own.
+    if(furi_hal_mock_tim_in_interrupt()) {
+        return;
+    }
+
+    pthread_mutex_lock(&furi_hal_mock_tim.mutex);
+
+    if(!furi_hal_mock_tim.started && (tim->CR1 & TIM_CR1_CEN)) {
+        furi_check(pthread_create(&furi_hal_mock_tim.thread, NULL, furi_hal_mock_tim_worker, tim) == 0);
+        pthread_detach(furi_hal_mock_tim.thread);
+        furi_hal_mock_tim.started = true;
+    }
+    pthread_cond_broadcast(&furi_hal_mock_tim.changed);
+
+    // Once a stopped counter's been noticed, nothing more happens until it starts again.
+    while(!(tim->CR1 & TIM_CR1_CEN) && furi_hal_mock_tim.running) {
+        pthread_cond_wait(&furi_hal_mock_tim.changed, &furi_hal_mock_tim.mutex);
+    }
+
+    pthread_mutex_unlock(&furi_hal_mock_tim.mutex);
+}
+
+/**
+ * Simulated devices.
+ */
+
+void furi_hal_mock_i2c_attach(uint8_t address, const FuriHalMockI2cDevice* device) {
+    furi_check(address < 128);
+
+    furi_hal_i2c_acquire(&furi_hal_i2c_handle_external);
+    furi_hal_mock_i2c_external.devices[address] = *device;
+    furi_hal_mock_i2c_external.present[address] = true;
+    furi_hal_mock_i2c_external.max_speed[address] = 0;
+    furi_hal_i2c_release(&furi_hal_i2c_handle_external);
+}
+
+void furi_hal_mock_i2c_detach(uint8_t address) {
+    furi_check(address < 128);
+
+    furi_hal_i2c_acquire(&furi_hal_i2c_handle_external);
+    furi_hal_mock_i2c_external.present[address] = false;
+    furi_hal_i2c_release(&furi_hal_i2c_handle_external);
+}
+
+void furi_hal_mock_i2c_set_max_speed(uint8_t address, uint32_t kilohertz) {
+    furi_check(address < 128);
+
+    furi_hal_i2c_acquire(&furi_hal_i2c_handle_external);
+    furi_hal_mock_i2c_external.max_speed[address] = kilohertz;
+    furi_hal_i2c_release(&furi_hal_i2c_handle_external);
+}
+
+void furi_hal_mock_i2c_set_clocked(bool clocked) {
+    furi_hal_mock_i2c_clocked = clocked;
+}
+
+uint64_t furi_hal_mock_i2c_get_byte_count(void) {
+    return furi_hal_mock_i2c_bytes;
+}
+
+typedef struct {
+    uint8_t* memory;
+    size_t size;
+    uint8_t address_bytes;
+
+    /** The part's internal address counter, and how many word address bytes we've seen. */
+    uint32_t pointer;
+    uint8_t address_received;
+} FuriHalMockEeprom;
+
+uint8_t furi_hal_mock_eeprom_byte(uint32_t offset) {
+    return (uint8_t)(offset ^ (offset >> 8));
+}
+
+static bool furi_hal_mock_eeprom_start(void* context, bool read) {
+    FuriHalMockEeprom* eeprom = context;
+
+    // A write always begins with a fresh word address.
+    if(!read) {
+        eeprom->address_received = 0;
+    }
+    return true;
+}
+
+static bool furi_hal_mock_eeprom_write(void* context, uint8_t data) {
+    FuriHalMockEeprom* eeprom = context;
+
+    if(eeprom->address_received < eeprom->address_bytes) {
+        eeprom->pointer = ((eeprom->pointer << 8) | data) % eeprom->size;
+        eeprom->address_received += 1;
+    } else {
+        eeprom->memory[eeprom->pointer] = data;
+        eeprom->pointer = (eeprom->pointer + 1) % eeprom->size;
+    }
+
+    return true;
+}
+
+static uint8_t furi_hal_mock_eeprom_read(void* context) {
+    FuriHalMockEeprom* eeprom = context;
+    uint8_t data = eeprom->memory[eeprom->pointer];
+
+    eeprom->pointer = (eeprom->pointer + 1) % eeprom->size;
+    return data;
+}
+
+void furi_hal_mock_i2c_attach_eeprom(uint8_t address, size_t size, uint8_t address_bytes) {
+    FuriHalMockEeprom* eeprom = calloc(1, sizeof(FuriHalMockEeprom));
+
+    // Simulated parts live as long as the program does.
+    eeprom->memory = malloc(size);
+    eeprom->size = size;
+    eeprom->address_bytes = address_bytes;
+    for(size_t i = 0; i < size; ++i) {
+        eeprom->memory[i] = furi_hal_mock_eeprom_byte(i);
+    }
+
+    FuriHalMockI2cDevice device = {
+        .start = furi_hal_mock_eeprom_start,
+        .write = furi_hal_mock_eeprom_write,
+        .read = furi_hal_mock_eeprom_read,
+        .context = eeprom,
+    };
+    furi_hal_mock_i2c_attach(address, &device);
+}
+
+void furi_hal_mock_spi_attach(const FuriHalMockSpiDevice* device) {
+    pthread_mutex_lock(&furi_hal_mock_spi_mutex);
+    furi_hal_mock_spi_device = *device;
+    pthread_mutex_unlock(&furi_hal_mock_spi_mutex);
+}
+
+typedef enum {
+    FuriHalMockFlashCommand,
+    FuriHalMockFlashAddress,
+    FuriHalMockFlashDummy,
+    FuriHalMockFlashData,
+    FuriHalMockFlashIgnore,
+} FuriHalMockFlashPhase;
+
+typedef struct {
+    uint8_t* memory;
+    size_t size;
+
+    /** Where we are in the current command, and the command itself. */
+    FuriHalMockFlashPhase phase;
+    uint8_t command;
+    uint32_t address;
+    uint8_t address_received;
+    uint8_t id_position;
+
+    bool write_enabled;
+} FuriHalMockFlash;
+
+static void furi_hal_mock_flash_select(void* context) {
+    FuriHalMockFlash* flash = context;
+
+    flash->phase = FuriHalMockFlashCommand;
+    flash->address = 0;
+    flash->address_received = 0;
+    flash->id_position = 0;
+}
+
+static void furi_hal_mock_flash_deselect(void* context) {
+    FuriHalMockFlash* flash = context;
+
+    // Erases happen once CS rises, and only if the whole command arrived.
+    if(flash->write_enabled && flash->phase == FuriHalMockFlashData) {
+        if(flash->command == 0x20) {
+            memset(&flash->memory[flash->address & ~0xFFFU & (flash->size - 1)], 0xFF, MIN(4096, flash->size));
+        }
+    }
+    if(flash->write_enabled && flash->phase == FuriHalMockFlashIgnore && flash->command == 0xC7) {
+        memset(flash->memory, 0xFF, flash->size);
+    }
+
+    // Anything that modified the array uses up the write enable.
+    if(flash->command == 0x02 || flash->command == 0x20 || flash->command == 0xC7) {
+        flash->write_enabled = false;
+    }
+    flash->command = 0;
+}
+
+static uint8_t furi_hal_mock_flash_data(FuriHalMockFlash* flash, uint8_t data) {
+    // Winbond-style ID: manufacturer, memory type, then log2 of the capacity.
+    const uint8_t id[] = {0xEF, 0x40, (uint8_t)__builtin_ctz(flash->size)};
+    uint32_t offset = flash->address & (flash->size - 1);
+
+    switch(flash->command) {
+    case 0x9F:
+        return (flash->id_position < sizeof(id)) ? id[flash->id_position++] : 0xFF;
+    case 0x05:
+        return flash->write_enabled ? 0x02 : 0x00;
+    case 0x03:
+    case 0x0B:
+        flash->address += 1;
+        return flash->memory[offset];
+    case 0x02:
+        // Programming can only clear bits; and wraps within the 256-byte page.
+        if(flash->write_enabled) {
+            flash->memory[offset] &= data;
+        }
+        flash->address = (flash->address & ~0xFFU) | ((flash->address + 1) & 0xFF);
+        return 0xFF;
+    default:
+        return 0xFF;
+    }
+}
+
+static uint8_t furi_hal_mock_flash_exchange(void* context, uint8_t data) {
+    FuriHalMockFlash* flash = context;
+
+    switch(flash->phase) {
+    case FuriHalMockFlashCommand:
+        flash->command = data;
+
+        switch(data) {
+        case 0x03:
+        case 0x0B:
+        case 0x02:
+        case 0x20:
+            flash->phase = FuriHalMockFlashAddress;
+            break;
+        case 0x06:
+            flash->write_enabled = true;
+            flash->phase = FuriHalMockFlashIgnore;
+            break;
+        case 0x04:
+            flash->write_enabled = false;
+            flash->phase = FuriHalMockFlashIgnore;
+            break;
+        case 0x9F:
+        case 0x05:
+            flash->phase = FuriHalMockFlashData;
+            break;
+        default:
+            flash->phase = FuriHalMockFlashIgnore;
+            break;
+        }
+        return 0xFF;
+
+    case FuriHalMockFlashAddress:
+        flash->address = (flash->address << 8) | data;
+        if(++flash->address_received == 3) {
+            flash->phase = (flash->command == 0x0B) ? FuriHalMockFlashDummy : FuriHalMockFlashData;
+        }
+        return 0xFF;
+
+    case FuriHalMockFlashDummy:
+        flash->phase = FuriHalMockFlashData;
+        return 0xFF;
+
+    case FuriHalMockFlashData:
+        return furi_hal_mock_flash_data(flash, data);
+
+    default:
+        return 0xFF;
+    }
+}
+
+void furi_hal_mock_spi_attach_flash(size_t size) {
+    FuriHalMockFlash* flash = calloc(1, sizeof(FuriHalMockFlash));
+    furi_check(size && !(size & (size - 1)));
+
+    // Like the EEPROM, this lives as long as the program does.
+    flash->memory = malloc(size);
+    flash->size = size;
+    for(size_t i = 0; i < size; ++i) {
+        flash->memory[i] = furi_hal_mock_eeprom_byte(i);
+    }
+
+    FuriHalMockSpiDevice device = {
+        .select = furi_hal_mock_flash_select,
+        .deselect = furi_hal_mock_flash_deselect,
+        .exchange = furi_hal_mock_flash_exchange,
+        .context = flash,
+    };
+    furi_hal_mock_spi_attach(&device);
+}
+
+/**
+ * 1-Wire: thermometers in the image of the DS18B20, on TIM2's pin. The line's edges are worked
+ * out a whole period at a time, from how long the timer holds it low; times are in timer ticks,
+ * which the driver sets to a microsecond.
+ */
+
+/** Longest a device may hold the line low for a zero, and how long its presence pulse lasts. */
+#define FURI_HAL_MOCK_ONEWIRE_ZERO_US 30
+#define FURI_HAL_MOCK_ONEWIRE_PRESENCE_DELAY_US 30
+#define FURI_HAL_MOCK_ONEWIRE_PRESENCE_US 120
+
+/** Lows at least this long are resets; and a line that's back up by this is a one. */
+#define FURI_HAL_MOCK_ONEWIRE_RESET_US 480
+#define FURI_HAL_MOCK_ONEWIRE_SAMPLE_US 15
+
+#define FURI_HAL_MOCK_ONEWIRE_DEVICES_MAX 64
+
+typedef enum {
+    FuriHalMockOneWireIdle, //< waiting for a reset
+    FuriHalMockOneWireRomCommand,
+    FuriHalMockOneWireSending, //< sending buffer, then idle
+    FuriHalMockOneWireMatching, //< taking a ROM code to compare against our own
+    FuriHalMockOneWireSearching,
+    FuriHalMockOneWireFunction, //< selected, and waiting for a function command
+    FuriHalMockOneWireReceiving, //< taking bytes into the scratchpad
+} FuriHalMockOneWireState;
+
+typedef struct {
+    uint8_t rom[8];
+    uint8_t scratchpad[9];
+
+    FuriHalMockOneWireState state;
+
+    /** What we're sending or receiving, and how far through it we are, in bits. */
+    uint8_t buffer[9];
+    uint32_t bit;
+    uint32_t bits;
+
+    /** Where a search is in its bit's three slots: our bit, its complement, the master's choice. */
+    uint8_t search_phase;
+} FuriHalMockOneWireDevice;
+
+static FuriHalMockOneWireDevice furi_hal_mock_onewire_devices[FURI_HAL_MOCK_ONEWIRE_DEVICES_MAX];
+static size_t furi_hal_mock_onewire_device_count;
+static uint64_t furi_hal_mock_onewire_slots;
+
+/** The Dallas/Maxim CRC-8 that guards ROM codes and scratchpads. */
+static uint8_t furi_hal_mock_onewire_crc(const uint8_t* data, size_t length) {
+    uint8_t crc = 0;
+
+    for(size_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for(int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8C : crc >> 1;
+        }
+    }
+
+    return crc;
+}
+
+static bool furi_hal_mock_onewire_buffer_bit(const uint8_t* buffer, uint32_t bit) {
+    return buffer[bit / 8] & (1 << (bit % 8));
+}
+
+static void furi_hal_mock_onewire_expect(FuriHalMockOneWireDevice* device, FuriHalMockOneWireState state, uint32_t bits) {
+    device->state = state;
+    device->bit = 0;
+    device->bits = bits;
+    memset(device->buffer, 0, sizeof(device->buffer));
+}
+
+static void furi_hal_mock_onewire_send(FuriHalMockOneWireDevice* device, const uint8_t* data, size_t length) {
+    furi_hal_mock_onewire_expect(device, FuriHalMockOneWireSending, length * 8);
+    memcpy(device->buffer, data, length);
+}
+
+/** Returns false if the device holds the line low through this slot, to send a zero. */
+static bool furi_hal_mock_onewire_device_bit(FuriHalMockOneWireDevice* device) {
+    switch(device->state) {
+    case FuriHalMockOneWireSending:
+        return furi_hal_mock_onewire_buffer_bit(device->buffer, device->bit);
+    case FuriHalMockOneWireSearching: {
+        bool bit = furi_hal_mock_onewire_buffer_bit(device->rom, device->bit);
+        return (device->search_phase == 0) ? bit : (device->search_phase == 1) ? !bit : true;
+    }
+    default:
+        return true;
+    }
+}
+
+static void furi_hal_mock_onewire_command(FuriHalMockOneWireDevice* device, uint8_t command) {
+    if(device->state == FuriHalMockOneWireRomCommand) {
+        switch(command) {
+        case 0x33: // read ROM
+            furi_hal_mock_onewire_send(device, device->rom, sizeof(device->rom));
+            break;
+        case 0x55: // match ROM
+            furi_hal_mock_onewire_expect(device, FuriHalMockOneWireMatching, 64);
+            break;
+        case 0xCC: // skip ROM
+            furi_hal_mock_onewire_expect(device, FuriHalMockOneWireFunction, 8);
+            break;
+        case 0xF0: // search ROM
+            furi_hal_mock_onewire_expect(device, FuriHalMockOneWireSearching, 64);
+            device->search_phase = 0;
+            break;
+        default: // alarm search included; we never have an alarm
+            device->state = FuriHalMockOneWireIdle;
+            break;
+        }
+        return;
+    }
+
+    switch(command) {
+    case 0x44: // convert T; we're always done, and read as ones while "converting"
+        device->state = FuriHalMockOneWireIdle;
+        break;
+    case 0xBE: // read scratchpad
+        furi_hal_mock_onewire_send(device, device->scratchpad, sizeof(device->scratchpad));
+        break;
+    case 0x4E: // write scratchpad: TH, TL and configuration
+        furi_hal_mock_onewire_expect(device, FuriHalMockOneWireReceiving, 24);
+        break;
+    default:
+        device->state = FuriHalMockOneWireIdle;
+        break;
+    }
+}
+
+/** Moves the device along, given the bit the slot carried. */
+static void furi_hal_mock_onewire_device_slot(FuriHalMockOneWireDevice* device, bool bit) {
+    switch(device->state) {
+    case FuriHalMockOneWireIdle:
+        return;
+
+    case FuriHalMockOneWireSending:
+        if(++device->bit == device->bits) {
+            device->state = FuriHalMockOneWireIdle;
+        }
+        return;
+
+    case FuriHalMockOneWireSearching:
+        if(device->search_phase < 2) {
+            device->search_phase += 1;
+            return;
+        }
+
+        // The master went the other way; we sit out the rest of the search.
+        device->search_phase = 0;
+        if(bit != furi_hal_mock_onewire_buffer_bit(device->rom, device->bit)) {
+            device->state = FuriHalMockOneWireIdle;
+        } else if(++device->bit == 64) {
+            furi_hal_mock_onewire_expect(device, FuriHalMockOneWireFunction, 8);
+        }
+        return;
+
+    case FuriHalMockOneWireMatching:
+        if(bit != furi_hal_mock_onewire_buffer_bit(device->rom, device->bit)) {
+            device->state = FuriHalMockOneWireIdle;
+        } else if(++device->bit == 64) {
+            furi_hal_mock_onewire_expect(device, FuriHalMockOneWireFunction, 8);
+        }
+        return;
+
+    case FuriHalMockOneWireRomCommand:
+    case FuriHalMockOneWireFunction:
+    case FuriHalMockOneWireReceiving:
+        if(bit) {
+            device->buffer[device->bit / 8] |= 1 << (device->bit % 8);
+        }
+        if(++device->bit < device->bits) {
+            return;
+        }
+
+        if(device->state == FuriHalMockOneWireReceiving) {
+            memcpy(&device->scratchpad[2], device->buffer, 3);
+            device->scratchpad[8] = furi_hal_mock_onewire_crc(device->scratchpad, 8);
+            device->state = FuriHalMockOneWireIdle;
+        } else {
+            furi_hal_mock_onewire_command(device, device->buffer[0]);
+        }
+        return;
+    }
+}
+
+static size_t furi_hal_mock_onewire_period(uint32_t low, uint32_t length, FuriHalMockEdge* edges) {
+    size_t count = 0;
+
+    if(!low) {
+        return 0;
+    }
+
+    furi_hal_mock_onewire_slots += 1;
+    edges[count++] = (FuriHalMockEdge){.time = 0, .level = false};
+
+    // A reset: everyone answers it with a presence pulse, once the line's been let go.
+    if(low >= FURI_HAL_MOCK_ONEWIRE_RESET_US) {
+        for(size_t i = 0; i < furi_hal_mock_onewire_device_count; ++i) {
+            furi_hal_mock_onewire_expect(&furi_hal_mock_onewire_devices[i], FuriHalMockOneWireRomCommand, 8);
+        }
+
+        if(low < length) {
+            edges[count++] = (FuriHalMockEdge){.time = low, .level = true};
+        }
+
+        uint32_t presence = low + FURI_HAL_MOCK_ONEWIRE_PRESENCE_DELAY_US;
+        if(furi_hal_mock_onewire_device_count && presence < length) {
+            edges[count++] = (FuriHalMockEdge){.time = presence, .level = false};
+            if(presence + FURI_HAL_MOCK_ONEWIRE_PRESENCE_US < length) {
+                edges[count++] =
+                    (FuriHalMockEdge){.time = presence + FURI_HAL_MOCK_ONEWIRE_PRESENCE_US, .level = true};
+            }
+        }
+        return count;
+    }
+
+    // Otherwise a time slot: the line is the AND of everyone on it.
+    uint32_t release = low;
+    for(size_t i = 0; i < furi_hal_mock_onewire_device_count; ++i) {
+        if(!furi_hal_mock_onewire_device_bit(&furi_hal_mock_onewire_devices[i])) {
+            release = MAX(release, (uint32_t)FURI_HAL_MOCK_ONEWIRE_ZERO_US);
+        }
+    }
+
+    bool bit = release <= FURI_HAL_MOCK_ONEWIRE_SAMPLE_US;
+    for(size_t i = 0; i < furi_hal_mock_onewire_device_count; ++i) {
+        furi_hal_mock_onewire_device_slot(&furi_hal_mock_onewire_devices[i], bit);
+    }
+
+    if(release < length) {
+        edges[count++] = (FuriHalMockEdge){.time = release, .level = true};
+    }
+    return count;
+}
+
+void furi_hal_mock_onewire_get_rom(size_t index, uint8_t rom[8]) {
+    // Family 0x28, then a serial number that's anything but sequential, then the CRC.
+    uint32_t serial = (uint32_t)(index + 1) * 2654435761U;
+
+    rom[0] = 0x28;
+    for(size_t i = 0; i < 6; ++i) {
+        rom[i + 1] = (uint8_t)(serial >> ((i % 4) * 8)) ^ (uint8_t)(i * 0x35);
+    }
+    rom[7] = furi_hal_mock_onewire_crc(rom, 7);
+}
+
+void furi_hal_mock_onewire_attach_thermometers(size_t count) {
+    furi_check(count <= FURI_HAL_MOCK_ONEWIRE_DEVICES_MAX);
+    furi_check(!furi_hal_mock_tim.running);
+
+    memset(furi_hal_mock_onewire_devices, 0, sizeof(furi_hal_mock_onewire_devices));
+    for(size_t i = 0; i < count; ++i) {
+        FuriHalMockOneWireDevice* device = &furi_hal_mock_onewire_devices[i];
+
+        // Each reads a little warmer than the last, from 20 C, in sixteenths of a degree.
+        int16_t temperature = (20 * 16) + (int16_t)(i * 8);
+        const uint8_t scratchpad[8] = {
+            temperature & 0xFF, temperature >> 8, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10};
+
+        furi_hal_mock_onewire_get_rom(i, device->rom);
+        memcpy(device->scratchpad, scratchpad, sizeof(scratchpad));
+        device->scratchpad[8] = furi_hal_mock_onewire_crc(scratchpad, sizeof(scratchpad));
+    }
+
+    furi_hal_mock_onewire_device_count = count;
+}
+
+uint64_t furi_hal_mock_onewire_get_slot_count(void) {
+    return furi_hal_mock_onewire_slots;
+}
+
+/**
+ * Serial.
+ */
+
+struct FuriHalSerialHandle {
+    FuriHalSerialId id;
+    bool acquired;
+    uint32_t baud;
+
+    FuriHalSerialDmaRxCallback rx_callback;
+    void* rx_context;
+    bool report_errors;
+
+    /** The DMA's circular buffer; bytes are taken from the head. */
+    uint8_t dma[FURI_HAL_MOCK_SERIAL_DMA_SIZE];
+    size_t head;
+    size_t used;
+
+    FuriHalMockSerialTxCallback tx_callback;
+    void* tx_context;
+};
+
+/** Held while "interrupts" run; so once dma_rx_stop returns, no callback is in flight. */
+static pthread_mutex_t furi_hal_mock_serial_mutex = PTHREAD_MUTEX_INITIALIZER;
+static FuriHalSerialHandle furi_hal_mock_serial_handles[FuriHalSerialIdMax] = {
+    [FuriHalSerialIdUsart] = {.id = FuriHalSerialIdUsart},
+    [FuriHalSerialIdLpuart] = {.id = FuriHalSerialIdLpuart},
+};
+
+FuriHalSerialHandle* furi_hal_serial_control_acquire(FuriHalSerialId serial_id) {
+    FuriHalSerialHandle* handle = &furi_hal_mock_serial_handles[serial_id];
+    furi_check(serial_id < FuriHalSerialIdMax);
+
+    pthread_mutex_lock(&furi_hal_mock_serial_mutex);
+    if(handle->acquired) {
+        handle = NULL;
+    } else {
+        handle->acquired = true;
+    }
+    pthread_mutex_unlock(&furi_hal_mock_serial_mutex);
+
+    return handle;
+}
+
+void furi_hal_serial_control_release(FuriHalSerialHandle* handle) {
+    furi_check(handle->acquired && !handle->rx_callback);
+    handle->acquired = false;
+}
+
+void furi_hal_serial_init(FuriHalSerialHandle* handle, uint32_t baud) {
+    furi_check(handle->acquired);
+    handle->baud = baud;
+    handle->head = 0;
+    handle->used = 0;
+}
+
+void furi_hal_serial_deinit(FuriHalSerialHandle* handle) {
+    furi_check(!handle->rx_callback);
+    handle->baud = 0;
+}
+
+void furi_hal_serial_set_br(FuriHalSerialHandle* handle, uint32_t baud) {
+    furi_check(baud);
+    handle->baud = baud;
+}
+
+void furi_hal_serial_tx(FuriHalSerialHandle* handle, const uint8_t* buffer, size_t buffer_size) {
+    furi_check(handle->baud);
+
+    // Ten bits a byte: start, eight data, stop. The caller would just be waiting on the
+    // peripheral; so we sleep, rather than spin, and leave the CPU to everyone else.
+    uint64_t duration = 10000000000ULL * buffer_size / handle->baud;
+    struct timespec delay = {.tv_sec = duration / 1000000000, .tv_nsec = duration % 1000000000};
+    nanosleep(&delay, NULL);
+
+    if(handle->tx_callback) {
+        handle->tx_callback(handle->tx_context, buffer, buffer_size);
+    }
+}
+
+void furi_hal_serial_tx_wait_complete(FuriHalSerialHandle* handle) {
+    // Our transmits finish before they return.
+    UNUSED(handle);
+}
+
+void furi_hal_serial_dma_rx_start(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialDmaRxCallback callback,
+    void* context,
+    bool report_errors) {
+    pthread_mutex_lock(&furi_hal_mock_serial_mutex);
+    handle->rx_callback = callback;
+    handle->rx_context = context;
+    handle->report_errors = report_errors;
+    handle->head = 0;
+    handle->used = 0;
+    pthread_mutex_unlock(&furi_hal_mock_serial_mutex);
+}
+
+void furi_hal_serial_dma_rx_stop(FuriHalSerialHandle* handle) {
+    pthread_mutex_lock(&furi_hal_mock_serial_mutex);
+    handle->rx_callback = NULL;
+    handle->rx_context = NULL;
+    pthread_mutex_unlock(&furi_hal_mock_serial_mutex);
+}
+
+size_t furi_hal_serial_dma_rx(FuriHalSerialHandle* handle, uint8_t* data, size_t len) {
+    size_t count = MIN(len, handle->used);
+
+    for(size_t i = 0; i < count; ++i) {
+        data[i] = handle->dma[handle->head];
+        handle->head = (handle->head + 1) % FURI_HAL_MOCK_SERIAL_DMA_SIZE;
+    }
+    handle->used -= count;
+
+    return count;
+}
+
+void furi_hal_mock_serial_set_tx_callback(
+    FuriHalSerialId serial_id,
+    FuriHalMockSerialTxCallback callback,
+    void* context) {
+    furi_check(serial_id < FuriHalSerialIdMax);
+    furi_hal_mock_serial_handles[serial_id].tx_callback = callback;
+    furi_hal_mock_serial_handles[serial_id].tx_context = context;
+}
+
+size_t furi_hal_mock_serial_receive(FuriHalSerialId serial_id, const uint8_t* data, size_t length) {
+    FuriHalSerialHandle* handle = &furi_hal_mock_serial_handles[serial_id];
+    const size_t half = FURI_HAL_MOCK_SERIAL_DMA_SIZE / 2;
+    size_t received = 0;
+
+    furi_check(serial_id < FuriHalSerialIdMax);
+    pthread_mutex_lock(&furi_hal_mock_serial_mutex);
+
+    // Nobody's listening; the bytes just fall on the floor.
+    if(!handle->rx_callback) {
+        pthread_mutex_unlock(&furi_hal_mock_serial_mutex);
+        return 0;
+    }
+
+    for(size_t i = 0; i < length; ++i) {
+        if(handle->used == FURI_HAL_MOCK_SERIAL_DMA_SIZE) {
+            if(handle->report_errors) {
+                handle->rx_callback(handle, FuriHalSerialRxEventOverrunError, 0, handle->rx_context);
+            }
+            continue;
+        }
+
+        size_t tail = (handle->head + handle->used) % FURI_HAL_MOCK_SERIAL_DMA_SIZE;
+        handle->dma[tail] = data[i];
+        handle->used += 1;
+        received += 1;
+
+        // The half- and full-transfer interrupts fire as the DMA passes each half of its buffer.
+        if(((tail + 1) % half) == 0) {
+            handle->rx_callback(handle, FuriHalSerialRxEventData, handle->used, handle->rx_context);
+        }
+    }
+
+    if(handle->used) {
+        handle->rx_callback(handle, FuriHalSerialRxEventIdle, handle->used, handle->rx_context);
+    }
+
+    pthread_mutex_unlock(&furi_hal_mock_serial_mutex);
+    return received;
+}
+
+uint32_t furi_hal_mock_serial_get_baud(FuriHalSerialId serial_id) {
+    furi_check(serial_id < FuriHalSerialIdMax);
+    return furi_hal_mock_serial_handles[serial_id].baud;
+}
+
+/**
+ * USB.
+ */
+
+struct FuriHalUsbInterface {
+    const char* name;
+};
+
+FuriHalUsbInterface usb_cdc_single = {.name = "cdc_single"};
+FuriHalUsbInterface usb_cdc_dual = {.name = "cdc_dual"};
+
+static FuriHalUsbInterface* furi_hal_mock_usb_config = &usb_cdc_single;
+static bool furi_hal_mock_usb_locked;
+
+FuriHalUsbInterface* furi_hal_usb_get_config(void) {
+    return furi_hal_mock_usb_config;
+}
+
+bool furi_hal_usb_set_config(FuriHalUsbInterface* new_if, void* ctx) {
+    UNUSED(ctx);
+
+    if(furi_hal_mock_usb_locked) {
+        return false;
+    }
+    furi_hal_mock_usb_config = new_if;
+    return true;
+}
+
+void furi_hal_usb_lock(void) {
+    furi_hal_mock_usb_locked = true;
+}
+
+void furi_hal_usb_unlock(void) {
+    furi_hal_mock_usb_locked = false;
+}
+
+bool furi_hal_usb_is_locked(void) {
+    return furi_hal_mock_usb_locked;
+}
+
+/**
+ * USB CDC.
+ */
+
+#define FURI_HAL_MOCK_CDC_INTERFACES 2
+
+typedef struct {
+    CdcCallbacks* callbacks;
+    void* context;
+    struct usb_cdc_line_coding line_coding;
+
+    FuriHalMockCdcHostCallback host;
+    void* host_context;
+
+    /** The packet the host last sent, until the app takes it. */
+    uint8_t out[CDC_DATA_SZ];
+    uint16_t out_length;
+} FuriHalMockCdc;
+
+static pthread_mutex_t furi_hal_mock_cdc_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t furi_hal_mock_cdc_taken = PTHREAD_COND_INITIALIZER;
+static FuriHalMockCdc furi_hal_mock_cdc[FURI_HAL_MOCK_CDC_INTERFACES] = {
+    {.line_coding = {.dwDTERate = 115200, .bDataBits = 8}},
+    {.line_coding = {.dwDTERate = 115200, .bDataBits = 8}},
+};
+
+static FuriHalMockCdc* furi_hal_mock_cdc_get(uint8_t if_num) {
+    furi_check(if_num < FURI_HAL_MOCK_CDC_INTERFACES);
+    return &furi_hal_mock_cdc[if_num];
+}
+
+void furi_hal_cdc_set_callbacks(uint8_t if_num, CdcCallbacks* cb, void* context) {
+    FuriHalMockCdc* cdc = furi_hal_mock_cdc_get(if_num);
+
+    pthread_mutex_lock(&furi_hal_mock_cdc_mutex);
+    cdc->callbacks = cb;
+    cdc->context = context;
+    bool connected = (cdc->host != NULL);
+    pthread_mutex_unlock(&furi_hal_mock_cdc_mutex);
+
+    // As on the device, a new listener hears straight away if a host is already there.
+    if(cb && cb->state_callback && connected) {
+        cb->state_callback(context, CdcStateConnected);
+    }
+}
+
+struct usb_cdc_line_coding* furi_hal_cdc_get_port_settings(uint8_t if_num) {
+    return &furi_hal_mock_cdc_get(if_num)->line_coding;
+}
+
+void furi_hal_cdc_send(uint8_t if_num, uint8_t* buf, uint16_t len) {
+    FuriHalMockCdc* cdc = furi_hal_mock_cdc_get(if_num);
+    furi_check(len <= CDC_DATA_SZ);
+
+    pthread_mutex_lock(&furi_hal_mock_cdc_mutex);
+    FuriHalMockCdcHostCallback host = cdc->host;
+    void* host_context = cdc->host_context;
+    CdcCallbacks* callbacks = cdc->callbacks;
+    void* context = cdc->context;
+    pthread_mutex_unlock(&furi_hal_mock_cdc_mutex);
+
+    // Without a host, the packet never leaves; just like a real, unplugged endpoint.
+    if(!host) {
+        return;
+    }
+
+    host(host_context, buf, len);
+    if(callbacks && callbacks->tx_ep_callback) {
+        callbacks->tx_ep_callback(context);
+    }
+}
+
+int32_t furi_hal_cdc_receive(uint8_t if_num, uint8_t* buf, uint16_t max_len) {
+    FuriHalMockCdc* cdc = furi_hal_mock_cdc_get(if_num);
+
+    pthread_mutex_lock(&furi_hal_mock_cdc_mutex);
+    int32_t length = MIN(max_len, cdc->out_length);
+    memcpy(buf, cdc->out, length);
+    cdc->out_length = 0;
+    pthread_cond_broadcast(&furi_hal_mock_cdc_taken);
+    pthread_mutex_unlock(&furi_hal_mock_cdc_mutex);
+
+    return length;
+}
+
+static void furi_hal_mock_cdc_notify_state(FuriHalMockCdc* cdc, CdcState state) {
+    pthread_mutex_lock(&furi_hal_mock_cdc_mutex);
+    CdcCallbacks* callbacks = cdc->callbacks;
+    void* context = cdc->context;
+    pthread_mutex_unlock(&furi_hal_mock_cdc_mutex);
+
+    if(callbacks && callbacks->state_callback) {
+        callbacks->state_callback(context, state);
+    }
+}
+
+void furi_hal_mock_cdc_connect(uint8_t if_num, FuriHalMockCdcHostCallback callback, void* context) {
+    FuriHalMockCdc* cdc = furi_hal_mock_cdc_get(if_num);
+    furi_check(callback);
+
+    pthread_mutex_lock(&furi_hal_mock_cdc_mutex);
+    cdc->host = callback;
+    cdc->host_context = context;
+    cdc->out_length = 0;
+    pthread_mutex_unlock(&furi_hal_mock_cdc_mutex);
+
+    furi_hal_mock_cdc_notify_state(cdc, CdcStateConnected);
+}
+
+void furi_hal_mock_cdc_disconnect(uint8_t if_num) {
+    FuriHalMockCdc* cdc = furi_hal_mock_cdc_get(if_num);
+
+    pthread_mutex_lock(&furi_hal_mock_cdc_mutex);
+    cdc->host = NULL;
+    cdc->host_context = NULL;
+    cdc->out_length = 0;
+    pthread_cond_broadcast(&furi_hal_mock_cdc_taken);
+    pthread_mutex_unlock(&furi_hal_mock_cdc_mutex);
+
+    furi_hal_mock_cdc_notify_state(cdc, CdcStateDisconnected);
+}
+
+size_t furi_hal_mock_cdc_host_send(uint8_t if_num, const uint8_t* data, size_t length, uint32_t timeout) {
+    FuriHalMockCdc* cdc = furi_hal_mock_cdc_get(if_num);
+    size_t sent = 0;
+
+    while(sent < length) {
+        struct timespec deadline;
+        bool ready = true;
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeout / 1000;
+        deadline.tv_nsec += (long)(timeout % 1000) * 1000000;
+        if(deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        pthread_mutex_lock(&furi_hal_mock_cdc_mutex);
+        while(cdc->host && cdc->out_length && ready) {
+            ready = (pthread_cond_timedwait(&furi_hal_mock_cdc_taken, &furi_hal_mock_cdc_mutex, &deadline) == 0);
+        }
+        if(!cdc->host || cdc->out_length) {
+            pthread_mutex_unlock(&furi_hal_mock_cdc_mutex);
+            break;
+        }
+
+        uint16_t packet = MIN(length - sent, (size_t)CDC_DATA_SZ);
+        memcpy(cdc->out, &data[sent], packet);
+        cdc->out_length = packet;
+        sent += packet;
+
+        CdcCallbacks* callbacks = cdc->callbacks;
+        void* context = cdc->context;
+        pthread_mutex_unlock(&furi_hal_mock_cdc_mutex);
+
+        if(callbacks && callbacks->rx_ep_callback) {
+            callbacks->rx_ep_callback(context);
+        }
+    }
+
+    return sent;
+}
+
+void furi_hal_mock_cdc_set_line_coding(uint8_t if_num, uint32_t baud) {
+    FuriHalMockCdc* cdc = furi_hal_mock_cdc_get(if_num);
+
+    pthread_mutex_lock(&furi_hal_mock_cdc_mutex);
+    cdc->line_coding.dwDTERate = baud;
+    CdcCallbacks* callbacks = cdc->callbacks;
+    void* context = cdc->context;
+    pthread_mutex_unlock(&furi_hal_mock_cdc_mutex);
+
+    if(callbacks && callbacks->config_callback) {
+        callbacks->config_callback(context, &cdc->line_coding);
+    }
+}
@@ -0,0 +1,331 @@
+/**
+ * @file furi_hal.h
+ * Host stand-in for the Furi HAL.
+ *
+ * Buses are simulated; see hal_mock.h for the hooks that let a test or benchmark
+ * decide how simulated devices respond.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <stm32wbxx_ll_i2c.h>
+#include <stm32wbxx_ll_spi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Cortex: the cycle counter is emulated from the host's monotonic clock, at the
+ * device's 64 MHz, so cycle-based timing code reads sensibly on the host.
+ */
+
+typedef struct {
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+/** Host-only: refreshes and returns the emulated DWT block. */
+DWT_Type* furi_hal_mock_dwt(void);
+#define DWT (furi_hal_mock_dwt())
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
+void furi_hal_cortex_delay_us(uint32_t microseconds);
+
+/**
+ * GPIO. Only the external header's pins we use exist; their levels are driven from
+ * hal_mock.h, and interrupt callbacks run synchronously, from whoever drives them.
+ */
+
+typedef struct {
+    volatile uint32_t IDR;
+} GPIO_TypeDef;
+
+typedef struct {
+    GPIO_TypeDef* port;
+    uint16_t pin;
+} GpioPin;
+
+typedef enum {
+    GpioModeInput,
+    GpioModeOutputPushPull,
+    GpioModeOutputOpenDrain,
+    GpioModeAltFunctionPushPull,
+    GpioModeAltFunctionOpenDrain,
+    GpioModeAnalog,
+    GpioModeInterruptRise,
+    GpioModeInterruptFall,
+    GpioModeInterruptRiseFall,
+} GpioMode;
+
+typedef enum {
+    GpioPullNo,
+    GpioPullUp,
+    GpioPullDown,
+} GpioPull;
+
+typedef enum {
+    GpioSpeedLow,
+    GpioSpeedMedium,
+    GpioSpeedHigh,
+    GpioSpeedVeryHigh,
+} GpioSpeed;
+
+/** Only the alternate functions something here uses. */
+typedef enum {
+    GpioAltFnUnused,
+    GpioAltFn1TIM2,
+} GpioAltFn;
+
+typedef void (*GpioExtiCallback)(void* context);
+
+extern const GpioPin gpio_ext_pa4;
+extern const GpioPin gpio_ext_pa6;
+extern const GpioPin gpio_ext_pa7;
+extern const GpioPin gpio_ext_pb3;
+extern const GpioPin gpio_ext_pc0;
+extern const GpioPin gpio_ext_pc1;
+
+void furi_hal_gpio_init(const GpioPin* gpio, GpioMode mode, GpioPull pull, GpioSpeed speed);
+void furi_hal_gpio_init_simple(const GpioPin* gpio, GpioMode mode);
+void furi_hal_gpio_init_ex(
+    const GpioPin* gpio,
+    GpioMode mode,
+    GpioPull pull,
+    GpioSpeed speed,
+    GpioAltFn alt_fn);
+void furi_hal_gpio_add_int_callback(const GpioPin* gpio, GpioExtiCallback callback, void* context);
+void furi_hal_gpio_remove_int_callback(const GpioPin* gpio);
+void furi_hal_gpio_write(const GpioPin* gpio, bool state);
+
+static inline bool furi_hal_gpio_read(const GpioPin* gpio) {
+    return (gpio->port->IDR & gpio->pin) != 0;
+}
+
+/**
+ * Peripheral clocks and interrupts. Only TIM2 and the DMA controllers are simulated; see
+ * stm32wbxx_ll_tim.h and stm32wbxx_ll_dma.h. Their interrupts run on the simulated timer's own
+ * thread, as they'd preempt whatever was running on the device.
+ */
+
+typedef enum {
+    FuriHalBusTIM2,
+
+    FuriHalBusMAX,
+} FuriHalBus;
+
+/** Like the real thing, enabling a bus that's already enabled is a crash. */
+void furi_hal_bus_enable(FuriHalBus bus);
+void furi_hal_bus_disable(FuriHalBus bus);
+bool furi_hal_bus_is_enabled(FuriHalBus bus);
+
+typedef enum {
+    FuriHalInterruptIdTIM2,
+
+    FuriHalInterruptIdDma1Ch1,
+    FuriHalInterruptIdDma1Ch2,
+    FuriHalInterruptIdDma1Ch3,
+    FuriHalInterruptIdDma1Ch4,
+    FuriHalInterruptIdDma1Ch5,
+    FuriHalInterruptIdDma1Ch6,
+    FuriHalInterruptIdDma1Ch7,
+
+    FuriHalInterruptIdDma2Ch1,
+    FuriHalInterruptIdDma2Ch2,
+    FuriHalInterruptIdDma2Ch3,
+    FuriHalInterruptIdDma2Ch4,
+    FuriHalInterruptIdDma2Ch5,
+    FuriHalInterruptIdDma2Ch6,
+    FuriHalInterruptIdDma2Ch7,
+
+    FuriHalInterruptIdMax,
+} FuriHalInterruptId;
+
+typedef void (*FuriHalInterruptISR)(void* context);
+
+/** Sets, or with a NULL isr clears, an interrupt's handler; one may only replace the other via NULL. */
+void furi_hal_interrupt_set_isr(FuriHalInterruptId index, FuriHalInterruptISR isr, void* context);
+
+/**
+ * I2C. Like the real thing, acquiring a handle enables its peripheral at the standard 100 kHz
+ * clock; what's written to the timing register after that sets the speed of the simulated bus.
+ */
+
+typedef struct {
+    I2C_TypeDef* i2c;
+} FuriHalI2cBus;
+
+typedef struct {
+    FuriHalI2cBus* bus;
+
+    /** Host-only: the simulated devices on the bus. */
+    struct FuriHalMockI2cBus* mock;
+} FuriHalI2cBusHandle;
+
+typedef enum {
+    FuriHalI2cBeginStart,
+    FuriHalI2cBeginRestart,
+    FuriHalI2cBeginResume,
+} FuriHalI2cBegin;
+
+typedef enum {
+    FuriHalI2cEndStop,
+    FuriHalI2cEndAwaitRestart,
+    FuriHalI2cEndPause,
+} FuriHalI2cEnd;
+
+extern FuriHalI2cBusHandle furi_hal_i2c_handle_power;
+extern FuriHalI2cBusHandle furi_hal_i2c_handle_external;
+
+void furi_hal_i2c_acquire(FuriHalI2cBusHandle* handle);
+void furi_hal_i2c_release(FuriHalI2cBusHandle* handle);
+bool furi_hal_i2c_tx(
+    FuriHalI2cBusHandle* handle,
+    uint8_t address,
+    const uint8_t* data,
+    size_t size,
+    uint32_t timeout);
+bool furi_hal_i2c_tx_ext(
+    FuriHalI2cBusHandle* handle,
+    uint16_t address,
+    bool ten_bit,
+    const uint8_t* data,
+    size_t size,
+    FuriHalI2cBegin begin,
+    FuriHalI2cEnd end,
+    uint32_t timeout);
+bool furi_hal_i2c_rx(
+    FuriHalI2cBusHandle* handle,
+    uint8_t address,
+    uint8_t* data,
+    size_t size,
+    uint32_t timeout);
+bool furi_hal_i2c_rx_ext(
+    FuriHalI2cBusHandle* handle,
+    uint16_t address,
+    bool ten_bit,
+    uint8_t* data,
+    size_t size,
+    FuriHalI2cBegin begin,
+    FuriHalI2cEnd end,
+    uint32_t timeout);
+bool furi_hal_i2c_trx(
+    FuriHalI2cBusHandle* handle,
+    uint8_t address,
+    const uint8_t* tx_data,
+    size_t tx_size,
+    uint8_t* rx_data,
+    size_t rx_size,
+    uint32_t timeout);
+bool furi_hal_i2c_is_device_ready(FuriHalI2cBusHandle* handle, uint8_t addr, uint32_t timeout);
+
+/**
+ * SPI. Only the external bus exists. Like the real thing, acquiring a handle pulls its CS
+ * low, and releasing it lets CS go high again; the simulated device attached through
+ * hal_mock.h is selected for as long as CS is low.
+ */
+
+typedef struct {
+    SPI_TypeDef* spi;
+} FuriHalSpiBus;
+
+typedef struct {
+    FuriHalSpiBus* bus;
+    const GpioPin* miso;
+    const GpioPin* mosi;
+    const GpioPin* sck;
+    const GpioPin* cs;
+} FuriHalSpiBusHandle;
+
+extern FuriHalSpiBusHandle furi_hal_spi_bus_handle_external;
+
+void furi_hal_spi_acquire(FuriHalSpiBusHandle* handle);
+void furi_hal_spi_release(FuriHalSpiBusHandle* handle);
+bool furi_hal_spi_bus_tx(
+    FuriHalSpiBusHandle* handle,
+    const uint8_t* buffer,
+    size_t size,
+    uint32_t timeout);
+bool furi_hal_spi_bus_rx(FuriHalSpiBusHandle* handle, uint8_t* buffer, size_t size, uint32_t timeout);
+bool furi_hal_spi_bus_trx(
+    FuriHalSpiBusHandle* handle,
+    const uint8_t* tx_buffer,
+    uint8_t* rx_buffer,
+    size_t size,
+    uint32_t timeout);
+
+/** Either buffer may be NULL: to transmit without receiving, or to receive while sending filler. */
+bool furi_hal_spi_bus_trx_dma(
+    FuriHalSpiBusHandle* handle,
+    uint8_t* tx_buffer,
+    uint8_t* rx_buffer,
+    size_t size,
+    uint32_t timeout_ms);
+
+/**
+ * Serial. What arrives on RX is driven from hal_mock.h, and lands in a small circular DMA buffer;
+ * the receive callback runs synchronously, from whoever drives it, as the DMA interrupt would.
+ * Transmitting takes as long as the baud rate says it should.
+ */
+
+typedef enum {
+    FuriHalSerialIdUsart,
+    FuriHalSerialIdLpuart,
+
+    FuriHalSerialIdMax,
+} FuriHalSerialId;
+
+typedef enum {
+    FuriHalSerialRxEventData = (1 << 0),
+    FuriHalSerialRxEventIdle = (1 << 1),
+    FuriHalSerialRxEventFrameError = (1 << 2),
+    FuriHalSerialRxEventNoiseError = (1 << 3),
+    FuriHalSerialRxEventOverrunError = (1 << 4),
+} FuriHalSerialRxEvent;
+
+typedef struct FuriHalSerialHandle FuriHalSerialHandle;
+
+typedef void (*FuriHalSerialDmaRxCallback)(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialRxEvent event,
+    size_t data_len,
+    void* context);
+
+/** Returns NULL if someone else already has the port. */
+FuriHalSerialHandle* furi_hal_serial_control_acquire(FuriHalSerialId serial_id);
+void furi_hal_serial_control_release(FuriHalSerialHandle* handle);
+
+void furi_hal_serial_init(FuriHalSerialHandle* handle, uint32_t baud);
+void furi_hal_serial_deinit(FuriHalSerialHandle* handle);
+void furi_hal_serial_set_br(FuriHalSerialHandle* handle, uint32_t baud);
+void furi_hal_serial_tx(FuriHalSerialHandle* handle, const uint8_t* buffer, size_t buffer_size);
+void furi_hal_serial_tx_wait_complete(FuriHalSerialHandle* handle);
+
+void furi_hal_serial_dma_rx_start(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialDmaRxCallback callback,
+    void* context,
+    bool report_errors);
+void furi_hal_serial_dma_rx_stop(FuriHalSerialHandle* handle);
+
+/** Copies received bytes out of the DMA buffer; only valid from within the receive callback. */
+size_t furi_hal_serial_dma_rx(FuriHalSerialHandle* handle, uint8_t* data, size_t len);
+
+/**
+ * USB. Only the configurations' identities matter here; what they do is up to furi_hal_usb_cdc.h.
+ */
+
+typedef struct FuriHalUsbInterface FuriHalUsbInterface;
+
+extern FuriHalUsbInterface usb_cdc_single;
+extern FuriHalUsbInterface usb_cdc_dual;
+
+FuriHalUsbInterface* furi_hal_usb_get_config(void);
+bool furi_hal_usb_set_config(FuriHalUsbInterface* new_if, void* ctx);
+void furi_hal_usb_lock(void);
+void furi_hal_usb_unlock(void);
+bool furi_hal_usb_is_locked(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file furi_hal_pty.c
+ * Pseudo-terminals standing in for a USB host, so real host tools can talk to the app.
+ *
+ * Kept apart from furi_hal.c, as termios.h defines names -- CR1, for one -- that clash with
+ * the register stand-ins.
+ */
+
+#define _GNU_SOURCE
+
+#include "hal_mock.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+/** Copies whatever the app sends out to the terminal. */
+static void furi_hal_mock_cdc_pty_send(void* context, const uint8_t* data, size_t length) {
+    int master = (int)(intptr_t)context;
+
+    while(length) {
+        ssize_t written = write(master, data, length);
+        if(written <= 0) {
+            return;
+        }
+        data += written;
+        length -= written;
+    }
+}
+
+typedef struct {
+    int master;
+    uint8_t if_num;
+} FuriHalMockCdcPty;
+
+/** Feeds whatever's written to the terminal to the app, for as long as we're running. */
+static void* furi_hal_mock_cdc_pty_receive(void* context) {
+    FuriHalMockCdcPty* pty = context;
+    uint8_t buffer[4096];
+    ssize_t length;
+
+    while((length = read(pty->master, buffer, sizeof(buffer))) > 0) {
+        size_t sent = 0;
+
+        // Like a real host, we hold on to what the app's not ready for; however long that takes.
+        while(sent < (size_t)length) {
+            sent += furi_hal_mock_cdc_host_send(pty->if_num, &buffer[sent], length - sent, 1000);
+        }
+    }
+
+    return NULL;
+}
+
+const char* furi_hal_mock_cdc_open_pty(uint8_t if_num) {
+    static char path[64];
+    struct termios settings;
+    pthread_t thread;
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if((master < 0) || grantpt(master) || unlockpt(master) || ptsname_r(master, path, sizeof(path))) {
+        return NULL;
+    }
+
+    // Serial ports start out raw. Holding our own end open means the terminal survives each tool
+    // that opens and closes it, as a port would.
+    int slave = open(path, O_RDWR | O_NOCTTY);
+    if((slave < 0) || tcgetattr(slave, &settings)) {
+        return NULL;
+    }
+    cfmakeraw(&settings);
+    tcsetattr(slave, TCSANOW, &settings);
+
+    FuriHalMockCdcPty* pty = malloc(sizeof(FuriHalMockCdcPty));
+    pty->master = master;
+    pty->if_num = if_num;
+
+    furi_hal_mock_cdc_connect(if_num, furi_hal_mock_cdc_pty_send, (void*)(intptr_t)master);
+    pthread_create(&thread, NULL, furi_hal_mock_cdc_pty_receive, pty);
+    pthread_detach(thread);
+
+    return path;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file furi_hal_usb_cdc.h
+ * Host stand-in for the Furi HAL's USB CDC interfaces.
+ *
+ * Whatever's on the far end of the cable is played from hal_mock.h; the endpoint callbacks
+ * run synchronously, from whoever plays it, as the USB interrupt would.
+ */
+
+#pragma once
+
+#include <furi_hal.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Size of a full-speed bulk packet; the most a single send or receive moves. */
+#define CDC_DATA_SZ 64
+
+struct usb_cdc_line_coding {
+    uint32_t dwDTERate;
+    uint8_t bCharFormat;
+    uint8_t bParityType;
+    uint8_t bDataBits;
+} __attribute__((packed));
+
+typedef enum {
+    CdcStateDisconnected,
+    CdcStateConnected,
+} CdcState;
+
+typedef struct {
+    void (*tx_ep_callback)(void* context);
+    void (*rx_ep_callback)(void* context);
+    void (*state_callback)(void* context, CdcState state);
+    void (*ctrl_line_callback)(void* context, uint8_t state);
+    void (*config_callback)(void* context, struct usb_cdc_line_coding* config);
+} CdcCallbacks;
+
+void furi_hal_cdc_set_callbacks(uint8_t if_num, CdcCallbacks* cb, void* context);
+struct usb_cdc_line_coding* furi_hal_cdc_get_port_settings(uint8_t if_num);
+
+/** Queues a single packet for the host; tx_ep_callback runs once it's been taken. */
+void furi_hal_cdc_send(uint8_t if_num, uint8_t* buf, uint16_t len);
+
+/** Takes the packet the host last sent, if there is one; returns its length. */
+int32_t furi_hal_cdc_receive(uint8_t if_num, uint8_t* buf, uint16_t max_len);
+
+#ifdef __cplusplus
+}
+#endif
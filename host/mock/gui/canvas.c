@@ -0,0 +1,236 @@
+/**
+ * @file canvas.c
+ * Host implementation of the canvas, drawing into a 128x64 1bpp frame buffer.
+ *
+ * We carry no fonts: each glyph is drawn as a 5x7 cell patterned from its character
+ * code. That's illegible, but costs the same pixel work as real text.
+ */
+
+#include "canvas_i.h"
+#include "icon_i.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CANVAS_STRIDE (CANVAS_WIDTH / 8)
+#define CANVAS_GLYPH_WIDTH 5
+#define CANVAS_GLYPH_HEIGHT 7
+#define CANVAS_GLYPH_ADVANCE 6
+
+struct Canvas {
+    uint8_t buffer[CANVAS_STRIDE * CANVAS_HEIGHT];
+    Color color;
+    Font font;
+};
+
+Canvas* canvas_alloc(void) {
+    Canvas* canvas = calloc(1, sizeof(Canvas));
+    canvas->color = ColorBlack;
+    canvas->font = FontSecondary;
+    return canvas;
+}
+
+void canvas_free(Canvas* canvas) {
+    free(canvas);
+}
+
+uint8_t* canvas_get_buffer(Canvas* canvas) {
+    return canvas->buffer;
+}
+
+size_t canvas_get_buffer_size(Canvas* canvas) {
+    return sizeof(canvas->buffer);
+}
+
+void canvas_clear(Canvas* canvas) {
+    memset(canvas->buffer, 0, sizeof(canvas->buffer));
+}
+
+void canvas_set_color(Canvas* canvas, Color color) {
+    canvas->color = color;
+}
+
+void canvas_invert_color(Canvas* canvas) {
+    if(canvas->color != ColorXOR) {
+        canvas->color = (canvas->color == ColorBlack) ? ColorWhite : ColorBlack;
+    }
+}
+
+void canvas_set_font(Canvas* canvas, Font font) {
+    canvas->font = font;
+}
+
+uint8_t canvas_width(Canvas* canvas) {
+    (void)canvas;
+    return CANVAS_WIDTH;
+}
+
+uint8_t canvas_height(Canvas* canvas) {
+    (void)canvas;
+    return CANVAS_HEIGHT;
+}
+
+uint8_t canvas_current_font_height(Canvas* canvas) {
+    switch(canvas->font) {
+    case FontPrimary:
+        return 8;
+    case FontBigNumbers:
+        return 18;
+    default:
+        return CANVAS_GLYPH_HEIGHT;
+    }
+}
+
+uint16_t canvas_string_width(Canvas* canvas, const char* str) {
+    (void)canvas;
+    return strlen(str) * CANVAS_GLYPH_ADVANCE;
+}
+
+void canvas_draw_dot(Canvas* canvas, int32_t x, int32_t y) {
+    if(x < 0 || y < 0 || x >= CANVAS_WIDTH || y >= CANVAS_HEIGHT) {
+        return;
+    }
+
+    uint8_t* byte = &canvas->buffer[y * CANVAS_STRIDE + x / 8];
+    uint8_t bit = 1 << (x % 8);
+
+    switch(canvas->color) {
+    case ColorWhite:
+        *byte &= ~bit;
+        break;
+    case ColorBlack:
+        *byte |= bit;
+        break;
+    case ColorXOR:
+        *byte ^= bit;
+        break;
+    }
+}
+
+void canvas_draw_line(Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    int32_t dx = abs(x2 - x1), sx = (x1 < x2) ? 1 : -1;
+    int32_t dy = -abs(y2 - y1), sy = (y1 < y2) ? 1 : -1;
+    int32_t error = dx + dy;
+
+    while(true) {
+        canvas_draw_dot(canvas, x1, y1);
+        if(x1 == x2 && y1 == y2) {
+            break;
+        }
+
+        int32_t doubled = 2 * error;
+        if(doubled >= dy) {
+            error += dy;
+            x1 += sx;
+        }
+        if(doubled <= dx) {
+            error += dx;
+            y1 += sy;
+        }
+    }
+}
+
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    for(size_t row = 0; row < height; ++row) {
+        for(size_t column = 0; column < width; ++column) {
+            canvas_draw_dot(canvas, x + column, y + row);
+        }
+    }
+}
+
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    if(!width || !height) {
+        return;
+    }
+
+    canvas_draw_line(canvas, x, y, x + width - 1, y);
+    canvas_draw_line(canvas, x, y + height - 1, x + width - 1, y + height - 1);
+    canvas_draw_line(canvas, x, y + 1, x, y + height - 2);
+    canvas_draw_line(canvas, x + width - 1, y + 1, x + width - 1, y + height - 2);
+}
+
+void canvas_draw_glyph(Canvas* canvas, int32_t x, int32_t y, uint16_t ch) {
+    uint32_t pattern = ch * 0x9E3779B1U;
+
+    // Glyphs sit on the baseline at y, as they do with the firmware's fonts.
+    for(int32_t row = 0; row < CANVAS_GLYPH_HEIGHT; ++row) {
+        uint8_t bits = (pattern >> (row * 4)) & 0x1F;
+
+        for(int32_t column = 0; column < CANVAS_GLYPH_WIDTH; ++column) {
+            if(bits & (1 << column)) {
+                canvas_draw_dot(canvas, x + column, y - CANVAS_GLYPH_HEIGHT + row);
+            }
+        }
+    }
+}
+
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* str) {
+    for(; *str; ++str, x += CANVAS_GLYPH_ADVANCE) {
+        canvas_draw_glyph(canvas, x, y, *str);
+    }
+}
+
+void canvas_draw_str_aligned(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    Align horizontal,
+    Align vertical,
+    const char* str) {
+    int32_t width = canvas_string_width(canvas, str);
+    int32_t height = canvas_current_font_height(canvas);
+
+    switch(horizontal) {
+    case AlignRight:
+        x -= width;
+        break;
+    case AlignCenter:
+        x -= width / 2;
+        break;
+    default:
+        break;
+    }
+
+    switch(vertical) {
+    case AlignTop:
+        y += height;
+        break;
+    case AlignCenter:
+        y += height / 2;
+        break;
+    default:
+        break;
+    }
+
+    canvas_draw_str(canvas, x, y, str);
+}
+
+void canvas_draw_xbm(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    size_t height,
+    const uint8_t* bitmap) {
+    size_t stride = (width + 7) / 8;
+
+    for(size_t row = 0; row < height; ++row) {
+        for(size_t column = 0; column < width; ++column) {
+            if(bitmap[row * stride + column / 8] & (1 << (column % 8))) {
+                canvas_draw_dot(canvas, x + column, y + row);
+            }
+        }
+    }
+}
+
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon) {
+    canvas_draw_xbm(canvas, x, y, icon->width, icon->height, icon->frames[0]);
+}
+
+uint8_t icon_get_width(const Icon* instance) {
+    return instance->width;
+}
+
+uint8_t icon_get_height(const Icon* instance) {
+    return instance->height;
+}
@@ -0,0 +1,24 @@
+/**
+ * @file canvas_i.h
+ * Host stand-in for the canvas internals: allocation, and access to the frame buffer.
+ */
+
+#pragma once
+
+#include "canvas.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Host-only: allocates a stand-alone canvas, for driving draw callbacks directly. */
+Canvas* canvas_alloc(void);
+void canvas_free(Canvas* canvas);
+
+/** Returns the raw frame buffer; on the host, one byte per eight horizontal pixels. */
+uint8_t* canvas_get_buffer(Canvas* canvas);
+size_t canvas_get_buffer_size(Canvas* canvas);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,55 @@
+/**
+ * @file elements.c
+ * Host implementation of the common GUI drawing elements.
+ */
+
+#include "elements.h"
+
+void elements_slightly_rounded_frame(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    size_t height) {
+    canvas_draw_line(canvas, x + 1, y, x + width - 2, y);
+    canvas_draw_line(canvas, x + 1, y + height - 1, x + width - 2, y + height - 1);
+    canvas_draw_line(canvas, x, y + 1, x, y + height - 2);
+    canvas_draw_line(canvas, x + width - 1, y + 1, x + width - 1, y + height - 2);
+}
+
+/** Draws a button label in a box along the bottom edge of the screen. */
+static void elements_button(Canvas* canvas, int32_t x, Align align, const char* str) {
+    int32_t width = canvas_string_width(canvas, str) + 4;
+
+    if(align == AlignRight) {
+        x -= width;
+    } else if(align == AlignCenter) {
+        x -= width / 2;
+    }
+
+    canvas_draw_box(canvas, x, CANVAS_HEIGHT - 10, width, 10);
+    canvas_invert_color(canvas);
+    canvas_draw_str(canvas, x + 2, CANVAS_HEIGHT - 2, str);
+    canvas_invert_color(canvas);
+}
+
+void elements_button_left(Canvas* canvas, const char* str) {
+    elements_button(canvas, 0, AlignLeft, str);
+}
+
+void elements_button_right(Canvas* canvas, const char* str) {
+    elements_button(canvas, CANVAS_WIDTH, AlignRight, str);
+}
+
+void elements_button_center(Canvas* canvas, const char* str) {
+    elements_button(canvas, CANVAS_WIDTH / 2, AlignCenter, str);
+}
+
+void elements_scrollbar(Canvas* canvas, uint16_t pos, uint16_t total) {
+    canvas_draw_line(canvas, CANVAS_WIDTH - 2, 0, CANVAS_WIDTH - 2, CANVAS_HEIGHT - 1);
+
+    if(total) {
+        int32_t block = CANVAS_HEIGHT / total;
+        canvas_draw_box(canvas, CANVAS_WIDTH - 3, pos * CANVAS_HEIGHT / total, 3, block ? block : 1);
+    }
+}
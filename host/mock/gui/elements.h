@@ -0,0 +1,19 @@
+/**
+ * @file elements.h
+ * Host stand-in for the common GUI drawing elements.
+ */
+
+#pragma once
+
+#include "canvas.h"
+
+void elements_slightly_rounded_frame(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    size_t height);
+void elements_button_left(Canvas* canvas, const char* str);
+void elements_button_right(Canvas* canvas, const char* str);
+void elements_button_center(Canvas* canvas, const char* str);
+void elements_scrollbar(Canvas* canvas, uint16_t pos, uint16_t total);
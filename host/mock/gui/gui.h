@@ -0,0 +1,11 @@
+/**
+ * @file gui.h
+ * Host stand-in for the GUI service.
+ */
+
+#pragma once
+
+#include "canvas.h"
+#include "view.h"
+
+typedef struct Gui Gui;
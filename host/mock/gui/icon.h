@@ -0,0 +1,13 @@
+/**
+ * @file icon.h
+ * Host stand-in for GUI icons.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct Icon Icon;
+
+uint8_t icon_get_width(const Icon* instance);
+uint8_t icon_get_height(const Icon* instance);
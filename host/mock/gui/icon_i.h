@@ -0,0 +1,16 @@
+/**
+ * @file icon_i.h
+ * Host stand-in for the GUI icon internals.
+ */
+
+#pragma once
+
+#include "icon.h"
+
+struct Icon {
+    const uint8_t width;
+    const uint8_t height;
+    const uint8_t frame_count;
+    const uint8_t frame_rate;
+    const uint8_t* const* frames;
+};
@@ -0,0 +1,190 @@
+/**
+ * @file submenu.c
+ * Host implementation of the submenu module.
+ */
+
+#include "submenu.h"
+
+#include <furi.h>
+#include <gui/elements.h>
+
+#define SUBMENU_MAX_ITEMS 32
+#define SUBMENU_VISIBLE_ITEMS 4
+
+typedef struct {
+    char* label;
+    uint32_t index;
+    SubmenuItemCallback callback;
+    void* callback_context;
+} SubmenuItem;
+
+typedef struct {
+    char* header;
+    SubmenuItem items[SUBMENU_MAX_ITEMS];
+    size_t item_count;
+    size_t selected;
+} SubmenuModel;
+
+struct Submenu {
+    View* view;
+};
+
+static void submenu_view_draw_callback(Canvas* canvas, void* _model) {
+    SubmenuModel* model = _model;
+    size_t first = (model->selected >= SUBMENU_VISIBLE_ITEMS) ? model->selected - SUBMENU_VISIBLE_ITEMS + 1 : 0;
+    int32_t y = 10;
+
+    canvas_clear(canvas);
+    canvas_set_color(canvas, ColorBlack);
+
+    if(model->header) {
+        canvas_set_font(canvas, FontPrimary);
+        canvas_draw_str(canvas, 4, y, model->header);
+        y += 12;
+    }
+
+    canvas_set_font(canvas, FontSecondary);
+    for(size_t i = first; i < model->item_count && i < first + SUBMENU_VISIBLE_ITEMS; ++i, y += 12) {
+        if(i == model->selected) {
+            canvas_draw_box(canvas, 0, y - 9, CANVAS_WIDTH - 4, 12);
+            canvas_set_color(canvas, ColorWhite);
+        }
+        canvas_draw_str(canvas, 6, y, model->items[i].label);
+        canvas_set_color(canvas, ColorBlack);
+    }
+
+    elements_scrollbar(canvas, model->selected, model->item_count);
+}
+
+/** Runs the callback for the item at the given position, outside of the model lock. */
+static bool submenu_activate(Submenu* submenu, size_t position, bool by_index) {
+    SubmenuItemCallback callback = NULL;
+    void* callback_context = NULL;
+    uint32_t index = 0;
+
+    with_view_model(
+        submenu->view, SubmenuModel * model, {
+            for(size_t i = 0; i < model->item_count; ++i) {
+                if(by_index ? (model->items[i].index == position) : (i == position)) {
+                    callback = model->items[i].callback;
+                    callback_context = model->items[i].callback_context;
+                    index = model->items[i].index;
+                    model->selected = i;
+                    break;
+                }
+            }
+        }, true);
+
+    if(callback) {
+        callback(callback_context, index);
+    }
+    return callback != NULL;
+}
+
+static bool submenu_view_input_callback(InputEvent* event, void* context) {
+    Submenu* submenu = context;
+    size_t selected = 0;
+
+    if(event->type != InputTypeShort && event->type != InputTypeRepeat) {
+        return false;
+    }
+
+    switch(event->key) {
+    case InputKeyUp:
+    case InputKeyDown:
+        with_view_model(
+            submenu->view, SubmenuModel * model, {
+                if(model->item_count) {
+                    size_t offset = (event->key == InputKeyUp) ? model->item_count - 1 : 1;
+                    model->selected = (model->selected + offset) % model->item_count;
+                }
+            }, true);
+        return true;
+    case InputKeyOk:
+        with_view_model(
+            submenu->view, SubmenuModel * model, { selected = model->selected; }, false);
+        return submenu_activate(submenu, selected, false);
+    default:
+        return false;
+    }
+}
+
+Submenu* submenu_alloc(void) {
+    Submenu* submenu = malloc(sizeof(Submenu));
+
+    submenu->view = view_alloc();
+    view_set_context(submenu->view, submenu);
+    view_allocate_model(submenu->view, ViewModelTypeLocking, sizeof(SubmenuModel));
+    view_set_draw_callback(submenu->view, submenu_view_draw_callback);
+    view_set_input_callback(submenu->view, submenu_view_input_callback);
+
+    return submenu;
+}
+
+void submenu_free(Submenu* submenu) {
+    furi_assert(submenu);
+
+    submenu_reset(submenu);
+    view_free(submenu->view);
+    free(submenu);
+}
+
+View* submenu_get_view(Submenu* submenu) {
+    return submenu->view;
+}
+
+void submenu_add_item(
+    Submenu* submenu,
+    const char* label,
+    uint32_t index,
+    SubmenuItemCallback callback,
+    void* callback_context) {
+    with_view_model(
+        submenu->view, SubmenuModel * model, {
+            furi_check(model->item_count < SUBMENU_MAX_ITEMS);
+
+            SubmenuItem* item = &model->items[model->item_count++];
+            item->label = strdup(label);
+            item->index = index;
+            item->callback = callback;
+            item->callback_context = callback_context;
+        }, true);
+}
+
+void submenu_reset(Submenu* submenu) {
+    with_view_model(
+        submenu->view, SubmenuModel * model, {
+            for(size_t i = 0; i < model->item_count; ++i) {
+                free(model->items[i].label);
+            }
+            free(model->header);
+
+            model->header = NULL;
+            model->item_count = 0;
+            model->selected = 0;
+        }, true);
+}
+
+void submenu_set_selected_item(Submenu* submenu, uint32_t index) {
+    with_view_model(
+        submenu->view, SubmenuModel * model, {
+            for(size_t i = 0; i < model->item_count; ++i) {
+                if(model->items[i].index == index) {
+                    model->selected = i;
+                    break;
+                }
+            }
+        }, true);
+}
+
+void submenu_set_header(Submenu* submenu, const char* header) {
+    with_view_model(
+        submenu->view, SubmenuModel * model, {
+            free(model->header);
+            model->header = header ? strdup(header) : NULL;
+        }, true);
+}
+
+bool submenu_select_item(Submenu* submenu, uint32_t index) {
+    return submenu_activate(submenu, index, true);
+}
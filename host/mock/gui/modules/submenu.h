@@ -0,0 +1,35 @@
+/**
+ * @file submenu.h
+ * Host stand-in for the submenu module.
+ */
+
+#pragma once
+
+#include <gui/view.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Submenu Submenu;
+typedef void (*SubmenuItemCallback)(void* context, uint32_t index);
+
+Submenu* submenu_alloc(void);
+void submenu_free(Submenu* submenu);
+View* submenu_get_view(Submenu* submenu);
+void submenu_add_item(
+    Submenu* submenu,
+    const char* label,
+    uint32_t index,
+    SubmenuItemCallback callback,
+    void* callback_context);
+void submenu_reset(Submenu* submenu);
+void submenu_set_selected_item(Submenu* submenu, uint32_t index);
+void submenu_set_header(Submenu* submenu, const char* header);
+
+/** Host-only: activates the item with the given index, as if the user had pressed OK on it. */
+bool submenu_select_item(Submenu* submenu, uint32_t index);
+
+#ifdef __cplusplus
+}
+#endif
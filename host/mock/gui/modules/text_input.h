@@ -0,0 +1,10 @@
+/**
+ * @file text_input.h
+ * Host stand-in for the text input module. The pirate app only includes it.
+ */
+
+#pragma once
+
+#include <gui/view.h>
+
+typedef struct TextInput TextInput;
@@ -0,0 +1,212 @@
+/**
+ * @file widget.c
+ * Host implementation of the widget module. Elements are drawn as plain strings,
+ * and buttons as the firmware's button elements.
+ */
+
+#include "widget.h"
+
+#include <furi.h>
+#include <gui/elements.h>
+
+#define WIDGET_MAX_ELEMENTS 16
+
+typedef struct {
+    uint8_t x;
+    uint8_t y;
+    Align horizontal;
+    Align vertical;
+    Font font;
+    char* text;
+
+    /** Set only for buttons, which are drawn along the bottom of the screen. */
+    bool button;
+    GuiButtonType button_type;
+    ButtonCallback callback;
+    void* context;
+} WidgetElement;
+
+typedef struct {
+    WidgetElement elements[WIDGET_MAX_ELEMENTS];
+    size_t element_count;
+} WidgetModel;
+
+struct Widget {
+    View* view;
+};
+
+static void widget_view_draw_callback(Canvas* canvas, void* _model) {
+    WidgetModel* model = _model;
+
+    canvas_clear(canvas);
+    canvas_set_color(canvas, ColorBlack);
+
+    for(size_t i = 0; i < model->element_count; ++i) {
+        WidgetElement* element = &model->elements[i];
+        int32_t y = element->y;
+
+        if(element->button) {
+            canvas_set_font(canvas, FontSecondary);
+            if(element->button_type == GuiButtonTypeLeft) {
+                elements_button_left(canvas, element->text);
+            } else if(element->button_type == GuiButtonTypeCenter) {
+                elements_button_center(canvas, element->text);
+            } else {
+                elements_button_right(canvas, element->text);
+            }
+            continue;
+        }
+
+        // Multi-line text is drawn one line at a time, as the firmware's elements do.
+        canvas_set_font(canvas, element->font);
+        for(char* line = element->text; line; y += canvas_current_font_height(canvas) + 1) {
+            char* end = strchr(line, '\n');
+
+            if(end) {
+                *end = 0;
+            }
+            canvas_draw_str_aligned(canvas, element->x, y, element->horizontal, element->vertical, line);
+            if(end) {
+                *end = '\n';
+            }
+
+            line = end ? end + 1 : NULL;
+        }
+    }
+}
+
+static bool widget_view_input_callback(InputEvent* event, void* context) {
+    Widget* widget = context;
+    WidgetElement pressed = {0};
+
+    static const InputKey keys[] = {
+        [GuiButtonTypeLeft] = InputKeyLeft,
+        [GuiButtonTypeCenter] = InputKeyOk,
+        [GuiButtonTypeRight] = InputKeyRight,
+    };
+
+    // Find the button first, and call it once we've let go of the model; it may reset the widget.
+    with_view_model(
+        widget->view, WidgetModel * model, {
+            for(size_t i = 0; i < model->element_count; ++i) {
+                WidgetElement* element = &model->elements[i];
+
+                if(element->button && element->callback && (keys[element->button_type] == event->key)) {
+                    pressed = *element;
+                }
+            }
+        }, false);
+
+    if(!pressed.callback) {
+        return false;
+    }
+
+    pressed.callback(pressed.button_type, event->type, pressed.context);
+    return true;
+}
+
+/** Adds a copy of the given element, and of its text. */
+static void widget_add_element(Widget* widget, WidgetElement prototype) {
+    with_view_model(
+        widget->view, WidgetModel * model, {
+            furi_check(model->element_count < WIDGET_MAX_ELEMENTS);
+
+            WidgetElement* element = &model->elements[model->element_count++];
+            *element = prototype;
+            element->text = strdup(prototype.text);
+        }, true);
+}
+
+Widget* widget_alloc(void) {
+    Widget* widget = malloc(sizeof(Widget));
+
+    widget->view = view_alloc();
+    view_set_context(widget->view, widget);
+    view_allocate_model(widget->view, ViewModelTypeLocking, sizeof(WidgetModel));
+    view_set_draw_callback(widget->view, widget_view_draw_callback);
+    view_set_input_callback(widget->view, widget_view_input_callback);
+
+    return widget;
+}
+
+void widget_free(Widget* widget) {
+    furi_assert(widget);
+
+    widget_reset(widget);
+    view_free(widget->view);
+    free(widget);
+}
+
+void widget_reset(Widget* widget) {
+    with_view_model(
+        widget->view, WidgetModel * model, {
+            for(size_t i = 0; i < model->element_count; ++i) {
+                free(model->elements[i].text);
+            }
+            model->element_count = 0;
+        }, true);
+}
+
+View* widget_get_view(Widget* widget) {
+    return widget->view;
+}
+
+void widget_add_string_element(
+    Widget* widget,
+    uint8_t x,
+    uint8_t y,
+    Align horizontal,
+    Align vertical,
+    Font font,
+    const char* text) {
+    widget_add_element(
+        widget,
+        (WidgetElement){
+            .x = x, .y = y, .horizontal = horizontal, .vertical = vertical, .font = font, .text = (char*)text});
+}
+
+void widget_add_string_multiline_element(
+    Widget* widget,
+    uint8_t x,
+    uint8_t y,
+    Align horizontal,
+    Align vertical,
+    Font font,
+    const char* text) {
+    widget_add_element(
+        widget,
+        (WidgetElement){
+            .x = x, .y = y, .horizontal = horizontal, .vertical = vertical, .font = font, .text = (char*)text});
+}
+
+void widget_add_text_scroll_element(
+    Widget* widget,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height,
+    const char* text) {
+    UNUSED(width);
+    UNUSED(height);
+    widget_add_element(
+        widget,
+        (WidgetElement){
+            .x = x, .y = y, .horizontal = AlignLeft, .vertical = AlignTop, .font = FontSecondary, .text = (char*)text});
+}
+
+void widget_add_button_element(
+    Widget* widget,
+    GuiButtonType button_type,
+    const char* text,
+    ButtonCallback callback,
+    void* context) {
+    widget_add_element(
+        widget,
+        (WidgetElement){
+            .font = FontSecondary,
+            .text = (char*)text,
+            .button = true,
+            .button_type = button_type,
+            .callback = callback,
+            .context = context});
+}
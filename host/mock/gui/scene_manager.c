@@ -0,0 +1,137 @@
+/**
+ * @file scene_manager.c
+ * Host implementation of the scene manager.
+ */
+
+#include "scene_manager.h"
+
+#include <furi.h>
+
+#define SCENE_MANAGER_STACK_DEPTH 16
+
+struct SceneManager {
+    const SceneManagerHandlers* handlers;
+    void* context;
+
+    uint32_t stack[SCENE_MANAGER_STACK_DEPTH];
+    size_t depth;
+
+    uint32_t* states;
+};
+
+SceneManager* scene_manager_alloc(const SceneManagerHandlers* app_scene_handlers, void* context) {
+    SceneManager* scene_manager = calloc(1, sizeof(SceneManager));
+
+    scene_manager->handlers = app_scene_handlers;
+    scene_manager->context = context;
+    scene_manager->states = calloc(app_scene_handlers->scene_num, sizeof(uint32_t));
+
+    return scene_manager;
+}
+
+void scene_manager_free(SceneManager* scene_manager) {
+    furi_assert(scene_manager);
+
+    free(scene_manager->states);
+    free(scene_manager);
+}
+
+void scene_manager_set_scene_state(SceneManager* scene_manager, uint32_t scene_id, uint32_t state) {
+    furi_check(scene_id < scene_manager->handlers->scene_num);
+    scene_manager->states[scene_id] = state;
+}
+
+uint32_t scene_manager_get_scene_state(const SceneManager* scene_manager, uint32_t scene_id) {
+    furi_check(scene_id < scene_manager->handlers->scene_num);
+    return scene_manager->states[scene_id];
+}
+
+uint32_t scene_manager_get_current_scene(SceneManager* scene_manager) {
+    return scene_manager->depth ? scene_manager->stack[scene_manager->depth - 1] : UINT32_MAX;
+}
+
+static bool scene_manager_dispatch(SceneManager* scene_manager, SceneManagerEvent event) {
+    if(!scene_manager->depth) {
+        return false;
+    }
+
+    uint32_t scene_id = scene_manager_get_current_scene(scene_manager);
+    return scene_manager->handlers->on_event_handlers[scene_id](scene_manager->context, event);
+}
+
+bool scene_manager_handle_custom_event(SceneManager* scene_manager, uint32_t custom_event) {
+    SceneManagerEvent event = {.type = SceneManagerEventTypeCustom, .event = custom_event};
+    return scene_manager_dispatch(scene_manager, event);
+}
+
+bool scene_manager_handle_back_event(SceneManager* scene_manager) {
+    SceneManagerEvent event = {.type = SceneManagerEventTypeBack};
+
+    if(scene_manager_dispatch(scene_manager, event)) {
+        return true;
+    }
+    return scene_manager_previous_scene(scene_manager);
+}
+
+void scene_manager_handle_tick_event(SceneManager* scene_manager) {
+    SceneManagerEvent event = {.type = SceneManagerEventTypeTick};
+    scene_manager_dispatch(scene_manager, event);
+}
+
+void scene_manager_next_scene(SceneManager* scene_manager, uint32_t next_scene_id) {
+    furi_check(next_scene_id < scene_manager->handlers->scene_num);
+    furi_check(scene_manager->depth < SCENE_MANAGER_STACK_DEPTH);
+
+    if(scene_manager->depth) {
+        uint32_t scene_id = scene_manager_get_current_scene(scene_manager);
+        scene_manager->handlers->on_exit_handlers[scene_id](scene_manager->context);
+    }
+
+    scene_manager->stack[scene_manager->depth++] = next_scene_id;
+    scene_manager->handlers->on_enter_handlers[next_scene_id](scene_manager->context);
+}
+
+bool scene_manager_previous_scene(SceneManager* scene_manager) {
+    if(!scene_manager->depth) {
+        return false;
+    }
+
+    uint32_t scene_id = scene_manager->stack[--scene_manager->depth];
+    scene_manager->handlers->on_exit_handlers[scene_id](scene_manager->context);
+
+    // Leaving the first scene leaves the application, as on the device.
+    if(!scene_manager->depth) {
+        return false;
+    }
+
+    scene_id = scene_manager_get_current_scene(scene_manager);
+    scene_manager->handlers->on_enter_handlers[scene_id](scene_manager->context);
+    return true;
+}
+
+bool scene_manager_search_and_switch_to_previous_scene(
+    SceneManager* scene_manager,
+    uint32_t scene_id) {
+    size_t depth = scene_manager->depth;
+
+    while(depth && scene_manager->stack[depth - 1] != scene_id) {
+        depth -= 1;
+    }
+    if(!depth) {
+        return false;
+    }
+
+    uint32_t current = scene_manager_get_current_scene(scene_manager);
+    scene_manager->handlers->on_exit_handlers[current](scene_manager->context);
+    scene_manager->depth = depth;
+    scene_manager->handlers->on_enter_handlers[scene_id](scene_manager->context);
+    return true;
+}
+
+void scene_manager_stop(SceneManager* scene_manager) {
+    if(scene_manager->depth) {
+        uint32_t scene_id = scene_manager_get_current_scene(scene_manager);
+        scene_manager->handlers->on_exit_handlers[scene_id](scene_manager->context);
+    }
+    scene_manager->depth = 0;
+}
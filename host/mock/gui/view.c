@@ -0,0 +1,100 @@
+/**
+ * @file view.c
+ * Host implementation of GUI views.
+ */
+
+#include "view_i.h"
+
+#include <furi.h>
+
+View* view_alloc(void) {
+    View* view = calloc(1, sizeof(View));
+    pthread_mutexattr_t attributes;
+
+    // Models may be re-entered from within a draw or input callback, as on the device.
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&view->model_mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+
+    return view;
+}
+
+void view_free(View* view) {
+    furi_assert(view);
+
+    view_free_model(view);
+    pthread_mutex_destroy(&view->model_mutex);
+    free(view);
+}
+
+void view_set_context(View* view, void* context) {
+    view->context = context;
+}
+
+void view_set_draw_callback(View* view, ViewDrawCallback callback) {
+    view->draw_callback = callback;
+}
+
+void view_set_input_callback(View* view, ViewInputCallback callback) {
+    view->input_callback = callback;
+}
+
+void view_set_custom_callback(View* view, ViewCustomCallback callback) {
+    view->custom_callback = callback;
+}
+
+void view_set_enter_callback(View* view, ViewCallback callback) {
+    view->enter_callback = callback;
+}
+
+void view_set_exit_callback(View* view, ViewCallback callback) {
+    view->exit_callback = callback;
+}
+
+void view_allocate_model(View* view, ViewModelType type, size_t size) {
+    furi_check(!view->model);
+
+    view->model_type = type;
+    view->model = calloc(1, size);
+}
+
+void view_free_model(View* view) {
+    free(view->model);
+    view->model = NULL;
+    view->model_type = ViewModelTypeNone;
+}
+
+void* view_get_model(View* view) {
+    if(view->model_type == ViewModelTypeLocking) {
+        pthread_mutex_lock(&view->model_mutex);
+    }
+    return view->model;
+}
+
+void view_commit_model(View* view, bool update) {
+    if(update) {
+        view->update_count += 1;
+    }
+    if(view->model_type == ViewModelTypeLocking) {
+        pthread_mutex_unlock(&view->model_mutex);
+    }
+}
+
+void view_draw(View* view, Canvas* canvas) {
+    if(!view->draw_callback) {
+        return;
+    }
+
+    void* model = view_get_model(view);
+    view->draw_callback(canvas, model);
+    view_commit_model(view, false);
+}
+
+bool view_input(View* view, InputEvent* event) {
+    return view->input_callback && view->input_callback(event, view->context);
+}
+
+uint32_t view_get_update_count(View* view) {
+    return view->update_count;
+}
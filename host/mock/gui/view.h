@@ -0,0 +1,61 @@
+/**
+ * @file view.h
+ * Host stand-in for GUI views.
+ */
+
+#pragma once
+
+#include <input/input.h>
+
+#include "canvas.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct View View;
+
+typedef void (*ViewDrawCallback)(Canvas* canvas, void* model);
+typedef bool (*ViewInputCallback)(InputEvent* event, void* context);
+typedef bool (*ViewCustomCallback)(uint32_t event, void* context);
+typedef uint32_t (*ViewNavigationCallback)(void* context);
+typedef void (*ViewCallback)(void* context);
+
+typedef enum {
+    ViewModelTypeNone,
+    ViewModelTypeLockFree,
+    ViewModelTypeLocking,
+} ViewModelType;
+
+View* view_alloc(void);
+void view_free(View* view);
+void view_set_context(View* view, void* context);
+void view_set_draw_callback(View* view, ViewDrawCallback callback);
+void view_set_input_callback(View* view, ViewInputCallback callback);
+void view_set_custom_callback(View* view, ViewCustomCallback callback);
+void view_set_enter_callback(View* view, ViewCallback callback);
+void view_set_exit_callback(View* view, ViewCallback callback);
+void view_allocate_model(View* view, ViewModelType type, size_t size);
+void view_free_model(View* view);
+void* view_get_model(View* view);
+void view_commit_model(View* view, bool update);
+
+/** Host-only: runs the view's draw callback against the given canvas. */
+void view_draw(View* view, Canvas* canvas);
+
+/** Host-only: delivers an input event to the view. */
+bool view_input(View* view, InputEvent* event);
+
+/** Host-only: number of commits that requested a redraw. */
+uint32_t view_get_update_count(View* view);
+
+#define with_view_model(view, type, code, update) \
+    {                                             \
+        type = view_get_model(view);              \
+        {code};                                   \
+        view_commit_model(view, update);          \
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,228 @@
+/**
+ * @file view_dispatcher.c
+ * Host implementation of the view dispatcher.
+ */
+
+#include "view_dispatcher.h"
+#include "view_i.h"
+
+#include <furi.h>
+
+#define VIEW_DISPATCHER_MAX_VIEWS 32
+#define VIEW_DISPATCHER_QUEUE_DEPTH 16
+
+typedef enum {
+    ViewDispatcherMessageCustom,
+    ViewDispatcherMessageInput,
+    ViewDispatcherMessageStop,
+} ViewDispatcherMessageType;
+
+typedef struct {
+    ViewDispatcherMessageType type;
+    uint32_t event;
+    InputEvent input;
+} ViewDispatcherMessage;
+
+struct ViewDispatcher {
+    FuriMessageQueue* queue;
+
+    View* views[VIEW_DISPATCHER_MAX_VIEWS];
+    View* current_view;
+
+    ViewDispatcherCustomEventCallback custom_event_callback;
+    ViewDispatcherNavigationEventCallback navigation_event_callback;
+    ViewDispatcherTickEventCallback tick_event_callback;
+    uint32_t tick_period;
+    void* event_context;
+};
+
+ViewDispatcher* view_dispatcher_alloc(void) {
+    ViewDispatcher* view_dispatcher = calloc(1, sizeof(ViewDispatcher));
+    view_dispatcher->tick_period = FuriWaitForever;
+    return view_dispatcher;
+}
+
+void view_dispatcher_free(ViewDispatcher* view_dispatcher) {
+    furi_assert(view_dispatcher);
+
+    if(view_dispatcher->queue) {
+        furi_message_queue_free(view_dispatcher->queue);
+    }
+    free(view_dispatcher);
+}
+
+void view_dispatcher_enable_queue(ViewDispatcher* view_dispatcher) {
+    furi_check(!view_dispatcher->queue);
+    view_dispatcher->queue =
+        furi_message_queue_alloc(VIEW_DISPATCHER_QUEUE_DEPTH, sizeof(ViewDispatcherMessage));
+}
+
+void view_dispatcher_set_event_callback_context(ViewDispatcher* view_dispatcher, void* context) {
+    view_dispatcher->event_context = context;
+}
+
+void view_dispatcher_set_custom_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherCustomEventCallback callback) {
+    view_dispatcher->custom_event_callback = callback;
+}
+
+void view_dispatcher_set_navigation_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherNavigationEventCallback callback) {
+    view_dispatcher->navigation_event_callback = callback;
+}
+
+void view_dispatcher_set_tick_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherTickEventCallback callback,
+    uint32_t tick_period) {
+    view_dispatcher->tick_event_callback = callback;
+    view_dispatcher->tick_period = tick_period;
+}
+
+void view_dispatcher_add_view(ViewDispatcher* view_dispatcher, uint32_t view_id, View* view) {
+    furi_check(view_id < VIEW_DISPATCHER_MAX_VIEWS);
+    furi_check(!view_dispatcher->views[view_id]);
+
+    view_dispatcher->views[view_id] = view;
+}
+
+void view_dispatcher_remove_view(ViewDispatcher* view_dispatcher, uint32_t view_id) {
+    furi_check(view_id < VIEW_DISPATCHER_MAX_VIEWS);
+
+    if(view_dispatcher->current_view == view_dispatcher->views[view_id]) {
+        view_dispatcher->current_view = NULL;
+    }
+    view_dispatcher->views[view_id] = NULL;
+}
+
+void view_dispatcher_switch_to_view(ViewDispatcher* view_dispatcher, uint32_t view_id) {
+    furi_check(view_id < VIEW_DISPATCHER_MAX_VIEWS);
+
+    View* view = view_dispatcher->views[view_id];
+    furi_check(view);
+
+    if(view == view_dispatcher->current_view) {
+        return;
+    }
+
+    if(view_dispatcher->current_view && view_dispatcher->current_view->exit_callback) {
+        view_dispatcher->current_view->exit_callback(view_dispatcher->current_view->context);
+    }
+    view_dispatcher->current_view = view;
+    if(view->enter_callback) {
+        view->enter_callback(view->context);
+    }
+}
+
+View* view_dispatcher_get_current_view(ViewDispatcher* view_dispatcher) {
+    return view_dispatcher->current_view;
+}
+
+void view_dispatcher_attach_to_gui(
+    ViewDispatcher* view_dispatcher,
+    Gui* gui,
+    ViewDispatcherType type) {
+    UNUSED(view_dispatcher);
+    UNUSED(gui);
+    UNUSED(type);
+}
+
+static void view_dispatcher_post(ViewDispatcher* view_dispatcher, const ViewDispatcherMessage* message) {
+    furi_check(view_dispatcher->queue);
+    furi_check(furi_message_queue_put(view_dispatcher->queue, message, FuriWaitForever) == FuriStatusOk);
+}
+
+void view_dispatcher_send_custom_event(ViewDispatcher* view_dispatcher, uint32_t event) {
+    ViewDispatcherMessage message = {.type = ViewDispatcherMessageCustom, .event = event};
+    view_dispatcher_post(view_dispatcher, &message);
+}
+
+void view_dispatcher_send_input(ViewDispatcher* view_dispatcher, const InputEvent* event) {
+    ViewDispatcherMessage message = {.type = ViewDispatcherMessageInput, .input = *event};
+    view_dispatcher_post(view_dispatcher, &message);
+}
+
+void view_dispatcher_stop(ViewDispatcher* view_dispatcher) {
+    ViewDispatcherMessage message = {.type = ViewDispatcherMessageStop};
+    view_dispatcher_post(view_dispatcher, &message);
+}
+
+static void view_dispatcher_handle_input(ViewDispatcher* view_dispatcher, InputEvent* event) {
+    View* view = view_dispatcher->current_view;
+
+    if(view && view_input(view, event)) {
+        return;
+    }
+
+    // Unconsumed Back presses navigate; if nobody wants them either, the application exits.
+    if(event->key == InputKeyBack && event->type == InputTypeShort) {
+        bool handled = view_dispatcher->navigation_event_callback &&
+                       view_dispatcher->navigation_event_callback(view_dispatcher->event_context);
+        if(!handled) {
+            view_dispatcher_stop(view_dispatcher);
+        }
+    }
+}
+
+/** Delivers a single message. Returns false if it asked us to stop. */
+static bool view_dispatcher_deliver(ViewDispatcher* view_dispatcher, ViewDispatcherMessage* message) {
+    switch(message->type) {
+    case ViewDispatcherMessageCustom: {
+        View* view = view_dispatcher->current_view;
+
+        if(view && view->custom_callback && view->custom_callback(message->event, view->context)) {
+            break;
+        }
+        if(view_dispatcher->custom_event_callback) {
+            view_dispatcher->custom_event_callback(view_dispatcher->event_context, message->event);
+        }
+        break;
+    }
+    case ViewDispatcherMessageInput:
+        view_dispatcher_handle_input(view_dispatcher, &message->input);
+        break;
+    case ViewDispatcherMessageStop:
+        return false;
+    }
+
+    return true;
+}
+
+void view_dispatcher_run(ViewDispatcher* view_dispatcher) {
+    ViewDispatcherMessage message;
+
+    furi_check(view_dispatcher->queue);
+
+    while(true) {
+        FuriStatus status =
+            furi_message_queue_get(view_dispatcher->queue, &message, view_dispatcher->tick_period);
+
+        if(status == FuriStatusErrorTimeout) {
+            if(view_dispatcher->tick_event_callback) {
+                view_dispatcher->tick_event_callback(view_dispatcher->event_context);
+            }
+            continue;
+        }
+        if(!view_dispatcher_deliver(view_dispatcher, &message)) {
+            break;
+        }
+    }
+}
+
+size_t view_dispatcher_process_queue(ViewDispatcher* view_dispatcher) {
+    ViewDispatcherMessage message;
+    size_t delivered = 0;
+
+    furi_check(view_dispatcher->queue);
+
+    while(furi_message_queue_get(view_dispatcher->queue, &message, 0) == FuriStatusOk) {
+        if(!view_dispatcher_deliver(view_dispatcher, &message)) {
+            break;
+        }
+        delivered += 1;
+    }
+
+    return delivered;
+}
@@ -0,0 +1,25 @@
+/**
+ * @file view_i.h
+ * Host view internals, shared with the view dispatcher.
+ */
+
+#pragma once
+
+#include "view.h"
+
+#include <pthread.h>
+
+struct View {
+    ViewDrawCallback draw_callback;
+    ViewInputCallback input_callback;
+    ViewCustomCallback custom_callback;
+    ViewCallback enter_callback;
+    ViewCallback exit_callback;
+    void* context;
+
+    ViewModelType model_type;
+    void* model;
+    pthread_mutex_t model_mutex;
+
+    uint32_t update_count;
+};
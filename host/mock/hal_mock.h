@@ -0,0 +1,189 @@
+/**
+ * @file hal_mock.h
+ * Host-only hooks into the simulated hardware behind furi_hal.h.
+ *
+ * The external I2C, SPI and 1-Wire buses start out empty; attach simulated devices to them
+ * before running anything that talks to the buses. The serial ports and USB are silent until
+ * something is played into them.
+ */
+
+#pragma once
+
+#include <furi_hal.h>
+#include <furi_hal_usb_cdc.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** A simulated I2C device. Every callback is optional. */
+typedef struct {
+    /** Called when the device is addressed; return false to NAK. */
+    bool (*start)(void* context, bool read);
+
+    /** Called with each byte written to the device; return false to NAK. */
+    bool (*write)(void* context, uint8_t data);
+
+    /** Called for each byte read from the device. */
+    uint8_t (*read)(void* context);
+
+    /** Called when a transaction addressed to the device ends with a stop. */
+    void (*stop)(void* context);
+
+    void* context;
+} FuriHalMockI2cDevice;
+
+/**
+ * Attaches a device to the external bus at the given 7-bit address. It answers transfers made
+ * through the HAL, and transactions bit-banged on the bus' pins alike.
+ */
+void furi_hal_mock_i2c_attach(uint8_t address, const FuriHalMockI2cDevice* device);
+
+/** Removes whatever device is attached at the given 7-bit address. */
+void furi_hal_mock_i2c_detach(uint8_t address);
+
+/**
+ * Attaches a simulated 24Cxx-style EEPROM at the given 7-bit address.
+ *
+ * The part behaves like the real thing for random and sequential access: writes set
+ * the word address and then store data; reads auto-increment and roll over at the end
+ * of the array. Its initial contents are a known pattern; see furi_hal_mock_eeprom_byte().
+ */
+void furi_hal_mock_i2c_attach_eeprom(uint8_t address, size_t size, uint8_t address_bytes);
+
+/** Returns the byte a freshly attached simulated EEPROM holds at the given offset. */
+uint8_t furi_hal_mock_eeprom_byte(uint32_t offset);
+
+/**
+ * Sets the fastest clock the device at the given 7-bit address keeps up with, in kHz; zero, the
+ * default, is no limit. Clocked any faster, it still acknowledges; but it sends each bit a clock
+ * late, so what's read from it comes back shifted right, with the top bit high. Past 400 kHz, the
+ * bus needs the I2C3 Fast-mode Plus drive enabled, too, or every device's reads go the same way.
+ */
+void furi_hal_mock_i2c_set_max_speed(uint8_t address, uint32_t kilohertz);
+
+/**
+ * Paces transfers by the clock the I2C peripheral's timing register sets, as the real bus would:
+ * each byte on the wire, address bytes included, takes nine bit times. By default, transfers are
+ * instantaneous.
+ */
+void furi_hal_mock_i2c_set_clocked(bool clocked);
+
+/** Number of bytes, address bytes included, that have crossed the external bus. */
+uint64_t furi_hal_mock_i2c_get_byte_count(void);
+
+/** A simulated SPI device. Every callback is optional. */
+typedef struct {
+    /** Called when CS falls, and when it rises again. */
+    void (*select)(void* context);
+    void (*deselect)(void* context);
+
+    /** Called for each byte clocked while selected; returns the byte the device sends back. */
+    uint8_t (*exchange)(void* context, uint8_t data);
+
+    void* context;
+} FuriHalMockSpiDevice;
+
+/** Attaches a device to the external SPI bus, replacing any that was there. */
+void furi_hal_mock_spi_attach(const FuriHalMockSpiDevice* device);
+
+/**
+ * Attaches a simulated 25-series SPI NOR flash of the given size, which must be a power of two.
+ *
+ * It answers JEDEC ID (0x9F), status (0x05), read (0x03) and fast read (0x0B); and, once write
+ * enabled (0x06), page program (0x02), 4K sector erase (0x20) and chip erase (0xC7). It starts
+ * out holding the same pattern as a simulated EEPROM; see furi_hal_mock_eeprom_byte().
+ */
+void furi_hal_mock_spi_attach_flash(size_t size);
+
+/**
+ * Paces transfers by the clock the SPI peripheral is set to, as the real bus would.
+ * By default, transfers are instantaneous.
+ */
+void furi_hal_mock_spi_set_clocked(bool clocked);
+
+/** Number of bytes that have crossed the external SPI bus; and how many transfers used DMA. */
+uint64_t furi_hal_mock_spi_get_byte_count(void);
+uint64_t furi_hal_mock_spi_get_dma_count(void);
+
+/**
+ * Attaches simulated DS18B20-style thermometers to the 1-Wire bus, replacing any that were there.
+ * The bus lives on SPI SCK's pin, and only sees what TIM2's channel 2 drives onto it, in PWM mode 2.
+ *
+ * Each device answers resets with a presence pulse; the read (0x33), match (0x55), skip (0xCC)
+ * and search (0xF0) ROM commands; and, once selected, convert (0x44), read scratchpad (0xBE)
+ * and write scratchpad (0x4E). The first reads 20 C, and each one after half a degree warmer.
+ * Slots run in real time, so a search takes as long as it would on the wire.
+ */
+void furi_hal_mock_onewire_attach_thermometers(size_t count);
+
+/** Fetches the ROM code of the simulated thermometer at the given index. */
+void furi_hal_mock_onewire_get_rom(size_t index, uint8_t rom[8]);
+
+/** Number of time slots, resets included, that have crossed the 1-Wire bus. */
+uint64_t furi_hal_mock_onewire_get_slot_count(void);
+
+/** Size of each serial port's circular DMA receive buffer, as on the device. */
+#define FURI_HAL_MOCK_SERIAL_DMA_SIZE 256
+
+/** Called with whatever the app transmits on a serial port, once it's been clocked out. */
+typedef void (*FuriHalMockSerialTxCallback)(void* context, const uint8_t* data, size_t length);
+
+void furi_hal_mock_serial_set_tx_callback(
+    FuriHalSerialId serial_id,
+    FuriHalMockSerialTxCallback callback,
+    void* context);
+
+/**
+ * Plays bytes into a serial port's RX line, followed by the line going idle.
+ *
+ * The receive callback hears about them as the DMA would report them: at each half and full
+ * buffer, and at idle. Bytes that find the buffer still full are lost, and reported as overruns.
+ *
+ * @return The number of bytes that made it into the DMA buffer.
+ */
+size_t furi_hal_mock_serial_receive(FuriHalSerialId serial_id, const uint8_t* data, size_t length);
+
+/** The rate the app last set a serial port to. */
+uint32_t furi_hal_mock_serial_get_baud(FuriHalSerialId serial_id);
+
+/** Called with each packet the app sends the host on a CDC interface. */
+typedef void (*FuriHalMockCdcHostCallback)(void* context, const uint8_t* data, size_t length);
+
+/**
+ * Plugs a host into a CDC interface; the host takes every packet as soon as it's sent.
+ * Replaces any host that was already connected.
+ */
+void furi_hal_mock_cdc_connect(uint8_t if_num, FuriHalMockCdcHostCallback callback, void* context);
+void furi_hal_mock_cdc_disconnect(uint8_t if_num);
+
+/**
+ * Sends data from the host, a packet at a time. Like a real host, we can't send a packet
+ * until the app has taken the last one.
+ *
+ * @param timeout   How long to wait for the app to take each packet, in milliseconds.
+ * @return The number of bytes the app took delivery of.
+ */
+size_t furi_hal_mock_cdc_host_send(uint8_t if_num, const uint8_t* data, size_t length, uint32_t timeout);
+
+/** Sets the line coding, as a host's terminal program would when the port is opened. */
+void furi_hal_mock_cdc_set_line_coding(uint8_t if_num, uint32_t baud);
+
+/**
+ * Plugs a pseudo-terminal in as a CDC interface's host, so ordinary host tools can open it
+ * like any USB serial port. Whatever's written to the terminal is sent to the app, and
+ * everything the app sends comes out of it. Replaces any host that was already connected.
+ *
+ * @return The path to open, e.g. /dev/pts/3; or NULL if no terminal could be made.
+ */
+const char* furi_hal_mock_cdc_open_pty(uint8_t if_num);
+
+/**
+ * Drives an external pin to the given level, as something on the far side of the header
+ * would; any interrupt callback the edge triggers runs before this returns.
+ */
+void furi_hal_mock_gpio_write(const GpioPin* gpio, bool level);
+
+#ifdef __cplusplus
+}
+#endif
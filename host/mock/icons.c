@@ -0,0 +1,35 @@
+/**
+ * @file icons.c
+ * Host stand-ins for the icons the app draws. Each is a solid block of the right size.
+ */
+
+#include "assets_icons.h"
+#include "pirate_icons.h"
+
+/** Enough set bits for the largest icon we stand in for. */
+static const uint8_t icon_solid[64] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+static const uint8_t* const icon_solid_frames[] = {icon_solid};
+
+#define ICON_STAND_IN(name, w, h)       \
+    const Icon name = {                 \
+        .width = w,                     \
+        .height = h,                    \
+        .frame_count = 1,               \
+        .frame_rate = 0,                \
+        .frames = icon_solid_frames,    \
+    }
+
+ICON_STAND_IN(I_ButtonLeftSmall_3x5, 3, 5);
+ICON_STAND_IN(I_ButtonRightSmall_3x5, 3, 5);
+ICON_STAND_IN(I_KeyBackspace_16x9, 16, 9);
+ICON_STAND_IN(I_KeyBackspaceSelected_16x9, 16, 9);
+ICON_STAND_IN(I_KeySend_24x11, 24, 11);
+ICON_STAND_IN(I_KeySendSelected_24x11, 24, 11);
+ICON_STAND_IN(I_KeySpace_12x9, 12, 9);
+ICON_STAND_IN(I_KeySpaceSelected_12x9, 12, 9);
+ICON_STAND_IN(I_file_10px, 10, 10);
@@ -0,0 +1,13 @@
+/**
+ * @file pirate_icons.h
+ * Host stand-in for the icon header fbt generates from assets/.
+ */
+
+#pragma once
+
+#include <gui/icon_i.h>
+
+extern const Icon I_KeySend_24x11;
+extern const Icon I_KeySendSelected_24x11;
+extern const Icon I_KeySpace_12x9;
+extern const Icon I_KeySpaceSelected_12x9;
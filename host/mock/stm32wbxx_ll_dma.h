@@ -0,0 +1,146 @@
+/**
+ * @file stm32wbxx_ll_dma.h
+ * Host stand-in for the parts of the ST low-level DMA driver we use, DMAMUX requests included.
+ *
+ * The registers are plain memory. Peripherals simulated in furi_hal.c raise their requests
+ * against whichever enabled channel the DMAMUX routes them to; each request moves one item,
+ * and the last of a channel's items raises its transfer complete interrupt.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    volatile uint32_t CCR;
+    volatile uint32_t CNDTR;
+
+    /** Addresses are pointer-sized here, so they survive a 64-bit host. */
+    volatile uintptr_t CPAR;
+    volatile uintptr_t CMAR;
+
+    /** Host-only: the DMAMUX request routed to this channel; and items moved since it was enabled. */
+    volatile uint32_t request;
+    volatile uint32_t moved;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+    volatile uint32_t ISR;
+    volatile uint32_t IFCR;
+    DMA_Channel_TypeDef channels[7];
+} DMA_TypeDef;
+
+extern DMA_TypeDef furi_hal_mock_dma1;
+extern DMA_TypeDef furi_hal_mock_dma2;
+#define DMA1 (&furi_hal_mock_dma1)
+#define DMA2 (&furi_hal_mock_dma2)
+
+#define LL_DMA_CHANNEL_1 0x0UL
+#define LL_DMA_CHANNEL_2 0x1UL
+#define LL_DMA_CHANNEL_3 0x2UL
+#define LL_DMA_CHANNEL_4 0x3UL
+#define LL_DMA_CHANNEL_5 0x4UL
+#define LL_DMA_CHANNEL_6 0x5UL
+#define LL_DMA_CHANNEL_7 0x6UL
+
+#define DMA_CCR_EN (0x1UL << 0)
+#define DMA_CCR_TCIE (0x1UL << 1)
+#define DMA_CCR_DIR (0x1UL << 4)
+#define DMA_CCR_CIRC (0x1UL << 5)
+#define DMA_CCR_PINC (0x1UL << 6)
+#define DMA_CCR_MINC (0x1UL << 7)
+#define DMA_CCR_PSIZE_Pos 8
+#define DMA_CCR_PSIZE (0x3UL << DMA_CCR_PSIZE_Pos)
+#define DMA_CCR_MSIZE_Pos 10
+#define DMA_CCR_MSIZE (0x3UL << DMA_CCR_MSIZE_Pos)
+#define DMA_CCR_PL (0x3UL << 12)
+
+/** Each channel's flags take four bits of ISR and IFCR: global, complete, half, error. */
+#define DMA_ISR_TCIF(channel) (0x2UL << ((channel) * 4))
+
+#define LL_DMA_DIRECTION_PERIPH_TO_MEMORY 0x0UL
+#define LL_DMA_DIRECTION_MEMORY_TO_PERIPH DMA_CCR_DIR
+#define LL_DMA_MODE_NORMAL 0x0UL
+#define LL_DMA_MODE_CIRCULAR DMA_CCR_CIRC
+#define LL_DMA_PERIPH_NOINCREMENT 0x0UL
+#define LL_DMA_PERIPH_INCREMENT DMA_CCR_PINC
+#define LL_DMA_MEMORY_NOINCREMENT 0x0UL
+#define LL_DMA_MEMORY_INCREMENT DMA_CCR_MINC
+#define LL_DMA_PDATAALIGN_BYTE (0x0UL << DMA_CCR_PSIZE_Pos)
+#define LL_DMA_PDATAALIGN_HALFWORD (0x1UL << DMA_CCR_PSIZE_Pos)
+#define LL_DMA_PDATAALIGN_WORD (0x2UL << DMA_CCR_PSIZE_Pos)
+#define LL_DMA_MDATAALIGN_BYTE (0x0UL << DMA_CCR_MSIZE_Pos)
+#define LL_DMA_MDATAALIGN_HALFWORD (0x1UL << DMA_CCR_MSIZE_Pos)
+#define LL_DMA_MDATAALIGN_WORD (0x2UL << DMA_CCR_MSIZE_Pos)
+#define LL_DMA_PRIORITY_LOW (0x0UL << 12)
+#define LL_DMA_PRIORITY_VERYHIGH (0x3UL << 12)
+
+/** Only the requests something simulated can raise. */
+#define LL_DMAMUX_REQ_TIM2_CH1 0x3AUL
+#define LL_DMAMUX_REQ_TIM2_UP 0x3EUL
+
+static inline void LL_DMA_ConfigTransfer(DMA_TypeDef* dma, uint32_t channel, uint32_t configuration) {
+    DMA_Channel_TypeDef* ch = &dma->channels[channel];
+    ch->CCR = (ch->CCR & (DMA_CCR_EN | DMA_CCR_TCIE)) | configuration;
+}
+
+static inline void LL_DMA_SetPeriphRequest(DMA_TypeDef* dma, uint32_t channel, uint32_t request) {
+    dma->channels[channel].request = request;
+}
+
+static inline void LL_DMA_SetPeriphAddress(DMA_TypeDef* dma, uint32_t channel, uintptr_t address) {
+    dma->channels[channel].CPAR = address;
+}
+
+static inline void LL_DMA_SetMemoryAddress(DMA_TypeDef* dma, uint32_t channel, uintptr_t address) {
+    dma->channels[channel].CMAR = address;
+}
+
+static inline void LL_DMA_SetDataLength(DMA_TypeDef* dma, uint32_t channel, uint32_t length) {
+    dma->channels[channel].CNDTR = length;
+}
+
+static inline uint32_t LL_DMA_GetDataLength(DMA_TypeDef* dma, uint32_t channel) {
+    return dma->channels[channel].CNDTR;
+}
+
+static inline void LL_DMA_EnableIT_TC(DMA_TypeDef* dma, uint32_t channel) {
+    dma->channels[channel].CCR |= DMA_CCR_TCIE;
+}
+
+static inline void LL_DMA_DisableIT_TC(DMA_TypeDef* dma, uint32_t channel) {
+    dma->channels[channel].CCR &= ~DMA_CCR_TCIE;
+}
+
+static inline void LL_DMA_EnableChannel(DMA_TypeDef* dma, uint32_t channel) {
+    dma->channels[channel].moved = 0;
+    dma->channels[channel].CCR |= DMA_CCR_EN;
+}
+
+static inline void LL_DMA_DisableChannel(DMA_TypeDef* dma, uint32_t channel) {
+    dma->channels[channel].CCR &= ~DMA_CCR_EN;
+}
+
+static inline uint32_t LL_DMA_IsActiveFlag_TC5(DMA_TypeDef* dma) {
+    return (dma->ISR & DMA_ISR_TCIF(LL_DMA_CHANNEL_5)) != 0;
+}
+
+static inline void LL_DMA_ClearFlag_TC5(DMA_TypeDef* dma) {
+    dma->ISR &= ~DMA_ISR_TCIF(LL_DMA_CHANNEL_5);
+}
+
+static inline uint32_t LL_DMA_IsActiveFlag_TC6(DMA_TypeDef* dma) {
+    return (dma->ISR & DMA_ISR_TCIF(LL_DMA_CHANNEL_6)) != 0;
+}
+
+static inline void LL_DMA_ClearFlag_TC6(DMA_TypeDef* dma) {
+    dma->ISR &= ~DMA_ISR_TCIF(LL_DMA_CHANNEL_6);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,56 @@
+/**
+ * @file stm32wbxx_ll_i2c.h
+ * Host stand-in for the parts of the ST low-level I2C driver we use.
+ *
+ * Only the timing register and the enable bit exist; the simulated bus in furi_hal.c reads the
+ * timing back to decide how long each transfer takes, and whether its devices can keep up.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    volatile uint32_t CR1;
+    volatile uint32_t TIMINGR;
+} I2C_TypeDef;
+
+#define I2C_CR1_PE (0x1UL << 0)
+
+#define I2C_TIMINGR_SCLL_Pos 0
+#define I2C_TIMINGR_SCLL (0xFFUL << I2C_TIMINGR_SCLL_Pos)
+#define I2C_TIMINGR_SCLH_Pos 8
+#define I2C_TIMINGR_SCLH (0xFFUL << I2C_TIMINGR_SCLH_Pos)
+#define I2C_TIMINGR_PRESC_Pos 28
+#define I2C_TIMINGR_PRESC (0xFUL << I2C_TIMINGR_PRESC_Pos)
+
+static inline void LL_I2C_Enable(I2C_TypeDef* i2c) {
+    i2c->CR1 |= I2C_CR1_PE;
+}
+
+static inline void LL_I2C_Disable(I2C_TypeDef* i2c) {
+    i2c->CR1 &= ~I2C_CR1_PE;
+}
+
+static inline uint32_t LL_I2C_IsEnabled(I2C_TypeDef* i2c) {
+    return (i2c->CR1 & I2C_CR1_PE) != 0;
+}
+
+/** Like the real thing, this only takes while the peripheral's disabled. */
+static inline void LL_I2C_SetTiming(I2C_TypeDef* i2c, uint32_t timing) {
+    if(!(i2c->CR1 & I2C_CR1_PE)) {
+        i2c->TIMINGR = timing;
+    }
+}
+
+static inline uint32_t LL_I2C_GetTiming(I2C_TypeDef* i2c) {
+    return i2c->TIMINGR;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,67 @@
+/**
+ * @file stm32wbxx_ll_spi.h
+ * Host stand-in for the parts of the ST low-level SPI driver we use.
+ *
+ * Only the clock settings and the enable bit exist; the simulated bus in furi_hal.c reads the
+ * prescaler back to decide how long each transfer takes, and takes no notice of the rest.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    volatile uint32_t CR1;
+} SPI_TypeDef;
+
+#define SPI_CR1_CPHA (0x1UL << 0)
+#define SPI_CR1_CPOL (0x1UL << 1)
+#define SPI_CR1_BR_Pos 3
+#define SPI_CR1_BR (0x7UL << SPI_CR1_BR_Pos)
+#define SPI_CR1_SPE (0x1UL << 6)
+
+#define LL_SPI_BAUDRATEPRESCALER_DIV2 (0x0UL << SPI_CR1_BR_Pos)
+#define LL_SPI_BAUDRATEPRESCALER_DIV4 (0x1UL << SPI_CR1_BR_Pos)
+#define LL_SPI_BAUDRATEPRESCALER_DIV8 (0x2UL << SPI_CR1_BR_Pos)
+#define LL_SPI_BAUDRATEPRESCALER_DIV16 (0x3UL << SPI_CR1_BR_Pos)
+#define LL_SPI_BAUDRATEPRESCALER_DIV32 (0x4UL << SPI_CR1_BR_Pos)
+#define LL_SPI_BAUDRATEPRESCALER_DIV64 (0x5UL << SPI_CR1_BR_Pos)
+#define LL_SPI_BAUDRATEPRESCALER_DIV128 (0x6UL << SPI_CR1_BR_Pos)
+#define LL_SPI_BAUDRATEPRESCALER_DIV256 (0x7UL << SPI_CR1_BR_Pos)
+
+#define LL_SPI_POLARITY_LOW 0x0UL
+#define LL_SPI_POLARITY_HIGH SPI_CR1_CPOL
+#define LL_SPI_PHASE_1EDGE 0x0UL
+#define LL_SPI_PHASE_2EDGE SPI_CR1_CPHA
+
+static inline void LL_SPI_Enable(SPI_TypeDef* spi) {
+    spi->CR1 |= SPI_CR1_SPE;
+}
+
+static inline void LL_SPI_Disable(SPI_TypeDef* spi) {
+    spi->CR1 &= ~SPI_CR1_SPE;
+}
+
+static inline void LL_SPI_SetBaudRatePrescaler(SPI_TypeDef* spi, uint32_t prescaler) {
+    spi->CR1 = (spi->CR1 & ~SPI_CR1_BR) | prescaler;
+}
+
+static inline void LL_SPI_SetClockPolarity(SPI_TypeDef* spi, uint32_t polarity) {
+    spi->CR1 = (spi->CR1 & ~SPI_CR1_CPOL) | polarity;
+}
+
+static inline void LL_SPI_SetClockPhase(SPI_TypeDef* spi, uint32_t phase) {
+    spi->CR1 = (spi->CR1 & ~SPI_CR1_CPHA) | phase;
+}
+
+static inline uint32_t LL_SPI_GetBaudRatePrescaler(SPI_TypeDef* spi) {
+    return spi->CR1 & SPI_CR1_BR;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,40 @@
+/**
+ * @file stm32wbxx_ll_system.h
+ * Host stand-in for the parts of the ST low-level system configuration driver we use.
+ *
+ * Only the Fast-mode Plus drive bits exist; the simulated I2C bus in furi_hal.c won't run
+ * its lines faster than 400 kHz without them, as the real pins can't.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    volatile uint32_t CFGR1;
+} SYSCFG_TypeDef;
+
+extern SYSCFG_TypeDef furi_hal_mock_syscfg;
+#define SYSCFG (&furi_hal_mock_syscfg)
+
+#define SYSCFG_CFGR1_I2C1_FMP (0x1UL << 20)
+#define SYSCFG_CFGR1_I2C3_FMP (0x1UL << 22)
+
+#define LL_SYSCFG_I2C_FASTMODEPLUS_I2C1 SYSCFG_CFGR1_I2C1_FMP
+#define LL_SYSCFG_I2C_FASTMODEPLUS_I2C3 SYSCFG_CFGR1_I2C3_FMP
+
+static inline void LL_SYSCFG_EnableFastModePlus(uint32_t configuration) {
+    SYSCFG->CFGR1 |= configuration;
+}
+
+static inline void LL_SYSCFG_DisableFastModePlus(uint32_t configuration) {
+    SYSCFG->CFGR1 &= ~configuration;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,173 @@
+/**
+ * @file stm32wbxx_ll_tim.h
+ * Host stand-in for the parts of the ST low-level timer driver we use.
+ *
+ * Only TIM2 exists, and only as far as PWM on channel 2 and input capture on channel 1 go.
+ * The registers are plain memory; starting the counter, or forcing an update, hands them to
+ * the simulated timer in furi_hal_timer.c, which runs its periods against the simulated 1-Wire
+ * bus in real time, and raises DMA requests and interrupts as the real one would.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    volatile uint32_t CR1;
+    volatile uint32_t DIER;
+    volatile uint32_t SR;
+    volatile uint32_t CCMR1;
+    volatile uint32_t CCER;
+    volatile uint32_t CNT;
+    volatile uint32_t PSC;
+    volatile uint32_t ARR;
+    volatile uint32_t CCR1;
+    volatile uint32_t CCR2;
+} TIM_TypeDef;
+
+extern TIM_TypeDef furi_hal_mock_tim2;
+#define TIM2 (&furi_hal_mock_tim2)
+
+/** Host-only: tell the simulated timer its counter, or its registers, have been poked. */
+void furi_hal_mock_tim_counter_changed(TIM_TypeDef* tim);
+void furi_hal_mock_tim_update(TIM_TypeDef* tim);
+
+#define TIM_CR1_CEN (0x1UL << 0)
+#define TIM_CR1_ARPE (0x1UL << 7)
+
+#define TIM_DIER_UIE (0x1UL << 0)
+#define TIM_DIER_CC1IE (0x1UL << 1)
+#define TIM_DIER_UDE (0x1UL << 8)
+#define TIM_DIER_CC1DE (0x1UL << 9)
+
+#define TIM_SR_UIF (0x1UL << 0)
+#define TIM_SR_CC1IF (0x1UL << 1)
+#define TIM_SR_CC1OF (0x1UL << 9)
+
+#define TIM_CCMR1_CC1S (0x3UL << 0)
+#define TIM_CCMR1_OC2PE (0x1UL << 11)
+#define TIM_CCMR1_OC2M (0x7UL << 12)
+
+#define TIM_CCER_CC1E (0x1UL << 0)
+#define TIM_CCER_CC1P (0x1UL << 1)
+#define TIM_CCER_CC2E (0x1UL << 4)
+
+#define LL_TIM_CHANNEL_CH1 TIM_CCER_CC1E
+#define LL_TIM_CHANNEL_CH2 TIM_CCER_CC2E
+
+#define LL_TIM_OCMODE_PWM1 (0x6UL << 12)
+#define LL_TIM_OCMODE_PWM2 (0x7UL << 12)
+
+#define LL_TIM_ACTIVEINPUT_DIRECTTI (0x1UL << 0)
+#define LL_TIM_ACTIVEINPUT_INDIRECTTI (0x2UL << 0)
+
+#define LL_TIM_IC_POLARITY_RISING 0x0UL
+#define LL_TIM_IC_POLARITY_FALLING TIM_CCER_CC1P
+
+static inline void LL_TIM_SetPrescaler(TIM_TypeDef* tim, uint32_t prescaler) {
+    tim->PSC = prescaler;
+}
+
+static inline void LL_TIM_SetAutoReload(TIM_TypeDef* tim, uint32_t auto_reload) {
+    tim->ARR = auto_reload;
+}
+
+static inline void LL_TIM_SetCounter(TIM_TypeDef* tim, uint32_t counter) {
+    tim->CNT = counter;
+}
+
+static inline void LL_TIM_EnableARRPreload(TIM_TypeDef* tim) {
+    tim->CR1 |= TIM_CR1_ARPE;
+}
+
+/** Only channel 2 can be an output, here. */
+static inline void LL_TIM_OC_SetMode(TIM_TypeDef* tim, uint32_t channel, uint32_t mode) {
+    (void)channel;
+    tim->CCMR1 = (tim->CCMR1 & ~TIM_CCMR1_OC2M) | mode;
+}
+
+static inline void LL_TIM_OC_EnablePreload(TIM_TypeDef* tim, uint32_t channel) {
+    (void)channel;
+    tim->CCMR1 |= TIM_CCMR1_OC2PE;
+}
+
+static inline void LL_TIM_OC_SetCompareCH2(TIM_TypeDef* tim, uint32_t compare) {
+    tim->CCR2 = compare;
+}
+
+/** Only channel 1 can capture, here. */
+static inline void LL_TIM_IC_SetActiveInput(TIM_TypeDef* tim, uint32_t channel, uint32_t input) {
+    (void)channel;
+    tim->CCMR1 = (tim->CCMR1 & ~TIM_CCMR1_CC1S) | input;
+}
+
+static inline void LL_TIM_IC_SetPolarity(TIM_TypeDef* tim, uint32_t channel, uint32_t polarity) {
+    (void)channel;
+    tim->CCER = (tim->CCER & ~TIM_CCER_CC1P) | polarity;
+}
+
+static inline uint32_t LL_TIM_IC_GetCaptureCH1(TIM_TypeDef* tim) {
+    return tim->CCR1;
+}
+
+static inline void LL_TIM_CC_EnableChannel(TIM_TypeDef* tim, uint32_t channels) {
+    tim->CCER |= channels;
+}
+
+static inline void LL_TIM_CC_DisableChannel(TIM_TypeDef* tim, uint32_t channels) {
+    tim->CCER &= ~channels;
+}
+
+static inline void LL_TIM_EnableDMAReq_UPDATE(TIM_TypeDef* tim) {
+    tim->DIER |= TIM_DIER_UDE;
+}
+
+static inline void LL_TIM_DisableDMAReq_UPDATE(TIM_TypeDef* tim) {
+    tim->DIER &= ~TIM_DIER_UDE;
+}
+
+static inline void LL_TIM_EnableDMAReq_CC1(TIM_TypeDef* tim) {
+    tim->DIER |= TIM_DIER_CC1DE;
+}
+
+static inline void LL_TIM_DisableDMAReq_CC1(TIM_TypeDef* tim) {
+    tim->DIER &= ~TIM_DIER_CC1DE;
+}
+
+static inline void LL_TIM_ClearFlag_UPDATE(TIM_TypeDef* tim) {
+    tim->SR &= ~TIM_SR_UIF;
+}
+
+static inline void LL_TIM_ClearFlag_CC1(TIM_TypeDef* tim) {
+    tim->SR &= ~TIM_SR_CC1IF;
+}
+
+static inline void LL_TIM_ClearFlag_CC1OVR(TIM_TypeDef* tim) {
+    tim->SR &= ~TIM_SR_CC1OF;
+}
+
+static inline void LL_TIM_GenerateEvent_UPDATE(TIM_TypeDef* tim) {
+    furi_hal_mock_tim_update(tim);
+}
+
+static inline void LL_TIM_EnableCounter(TIM_TypeDef* tim) {
+    tim->CR1 |= TIM_CR1_CEN;
+    furi_hal_mock_tim_counter_changed(tim);
+}
+
+static inline void LL_TIM_DisableCounter(TIM_TypeDef* tim) {
+    tim->CR1 &= ~TIM_CR1_CEN;
+    furi_hal_mock_tim_counter_changed(tim);
+}
+
+static inline uint32_t LL_TIM_IsEnabledCounter(TIM_TypeDef* tim) {
+    return (tim->CR1 & TIM_CR1_CEN) != 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,166 @@
+/**
+ * @file storage.c
+ * Host implementation of the storage stand-ins.
+ *
+ * Firmware paths are mapped beneath PIRATE_HOST_STORAGE_ROOT, which may be overridden
+ * at runtime through the environment variable of the same name.
+ */
+
+#include <storage/storage.h>
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef PIRATE_HOST_STORAGE_ROOT
+#define PIRATE_HOST_STORAGE_ROOT "storage"
+#endif
+
+struct File {
+    FILE* stream;
+};
+
+/** Translates a firmware path into a host one. */
+static FuriString* storage_host_path(const char* path) {
+    const char* root = getenv("PIRATE_HOST_STORAGE_ROOT");
+    return furi_string_alloc_printf("%s%s", root ? root : PIRATE_HOST_STORAGE_ROOT, path);
+}
+
+/** Creates every directory leading up to the given host path; the firmware does this for app data. */
+static void storage_host_make_parents(const char* host_path) {
+    char* path = strdup(host_path);
+
+    for(char* separator = strchr(path + 1, '/'); separator; separator = strchr(separator + 1, '/')) {
+        *separator = 0;
+        mkdir(path, 0755);
+        *separator = '/';
+    }
+
+    free(path);
+}
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    return calloc(1, sizeof(File));
+}
+
+void storage_file_free(File* file) {
+    furi_assert(file);
+
+    if(file->stream) {
+        storage_file_close(file);
+    }
+    free(file);
+}
+
+bool storage_file_open(File* file, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode) {
+    FuriString* host_path = storage_host_path(path);
+    const char* name = furi_string_get_cstr(host_path);
+    bool exists = (access(name, F_OK) == 0);
+    const char* mode = NULL;
+
+    storage_host_make_parents(name);
+
+    switch(open_mode) {
+    case FSOM_OPEN_EXISTING:
+        mode = exists ? ((access_mode & FSAM_WRITE) ? "r+b" : "rb") : NULL;
+        break;
+    case FSOM_OPEN_ALWAYS:
+        mode = exists ? ((access_mode & FSAM_WRITE) ? "r+b" : "rb") : "w+b";
+        break;
+    case FSOM_OPEN_APPEND:
+        mode = "a+b";
+        break;
+    case FSOM_CREATE_NEW:
+        mode = exists ? NULL : "w+b";
+        break;
+    case FSOM_CREATE_ALWAYS:
+        mode = "w+b";
+        break;
+    }
+
+    file->stream = mode ? fopen(name, mode) : NULL;
+    furi_string_free(host_path);
+
+    return file->stream != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(!file->stream) {
+        return false;
+    }
+
+    fclose(file->stream);
+    file->stream = NULL;
+    return true;
+}
+
+bool storage_file_is_open(File* file) {
+    return file->stream != NULL;
+}
+
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read) {
+    return file->stream ? fread(buff, 1, bytes_to_read, file->stream) : 0;
+}
+
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write) {
+    return file->stream ? fwrite(buff, 1, bytes_to_write, file->stream) : 0;
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start) {
+    return file->stream && (fseek(file->stream, offset, from_start ? SEEK_SET : SEEK_CUR) == 0);
+}
+
+uint64_t storage_file_tell(File* file) {
+    return file->stream ? (uint64_t)ftell(file->stream) : 0;
+}
+
+uint64_t storage_file_size(File* file) {
+    struct stat info;
+
+    if(!file->stream) {
+        return 0;
+    }
+
+    fflush(file->stream);
+    return fstat(fileno(file->stream), &info) ? 0 : (uint64_t)info.st_size;
+}
+
+bool storage_file_sync(File* file) {
+    return file->stream && (fflush(file->stream) == 0);
+}
+
+bool storage_file_eof(File* file) {
+    return !file->stream || (storage_file_tell(file) >= storage_file_size(file));
+}
+
+bool storage_simply_mkdir(Storage* storage, const char* path) {
+    UNUSED(storage);
+
+    FuriString* host_path = storage_host_path(path);
+    storage_host_make_parents(furi_string_get_cstr(host_path));
+    bool created = (mkdir(furi_string_get_cstr(host_path), 0755) == 0) || (errno == EEXIST);
+    furi_string_free(host_path);
+
+    return created;
+}
+
+bool storage_simply_remove(Storage* storage, const char* path) {
+    UNUSED(storage);
+
+    FuriString* host_path = storage_host_path(path);
+    bool removed = (remove(furi_string_get_cstr(host_path)) == 0) || (errno == ENOENT);
+    furi_string_free(host_path);
+
+    return removed;
+}
+
+bool storage_file_exists(Storage* storage, const char* path) {
+    UNUSED(storage);
+
+    FuriString* host_path = storage_host_path(path);
+    bool exists = (access(furi_string_get_cstr(host_path), F_OK) == 0);
+    furi_string_free(host_path);
+
+    return exists;
+}
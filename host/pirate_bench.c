@@ -0,0 +1,1558 @@
+/**
+ * @file pirate_bench.c
+ * Throughput benchmarks for the command parser and executor.
+ *
+ * Every case is a row in one of the two tables near the end of this file. Corpora of generated
+ * Bus Pirate commands, from a few characters to well past the 128-character command buffer,
+ * are fed through the lexer, the compiler, the program cache and the interpreter, a case per
+ * command length; and the rest drive the buses, the engine, the command input, the views and
+ * the USB modes, against the simulated hardware, a case each.
+ * Results are written as JSON, so they can be diffed and tracked between builds:
+ *
+ *   pirate_bench [-o results.json] [-t seconds per case] [-n commands per corpus] [-s seed]
+ *
+ * Alongside throughput, each case reports the peak stack depth of a single iteration
+ * (measured on a painted stack), and heap use: the peak while setting up and running,
+ * and the number of allocations made per iteration, which should be zero on hot paths.
+ *
+ * These only measure; whether the code does the right thing is for the tests in test/.
+ */
+
+#include <furi.h>
+#include <furi_hal.h>
+#include <hal_mock.h>
+#include <gui/canvas_i.h>
+
+#include <malloc.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../bus/bus_i2c.h"
+#include "../bus/bus_spi.h"
+#include "../lib/libpirate.h"
+#include "../pirate_bbio.h"
+#include "../pirate_bridge.h"
+#include "../pirate_bridge_meter.h"
+#include "../pirate_engine.h"
+#include "../pirate_hex_dump.h"
+#include "../pirate_input.h"
+#include "../pirate_onewire.h"
+#include "../pirate_result.h"
+#include "../pirate_sniffer.h"
+
+#define PIRATE_BENCH_STACK_SIZE (256 * 1024)
+#define PIRATE_BENCH_STACK_PAINT 0xA5
+
+/** Command lengths we generate corpora for; the GUI's buffer holds 128. */
+static const size_t pirate_bench_lengths[] = {16, 32, 64, 128, 256, 512};
+
+/**
+ * Heap accounting. The bench is linked with --wrap for the allocator, so every
+ * allocation the app and the mocks make passes through here.
+ */
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+void __real_free(void* pointer);
+char* __real_strdup(const char* string);
+
+static size_t pirate_bench_heap_current;
+static size_t pirate_bench_heap_peak;
+static uint64_t pirate_bench_heap_allocations;
+
+static void pirate_bench_heap_add(void* pointer) {
+    if(pointer) {
+        size_t current = __atomic_add_fetch(
+            &pirate_bench_heap_current, malloc_usable_size(pointer), __ATOMIC_RELAXED);
+        __atomic_add_fetch(&pirate_bench_heap_allocations, 1, __ATOMIC_RELAXED);
+
+        // Racy, but only ever low by a hair; good enough for a high-water mark.
+        if(current > pirate_bench_heap_peak) {
+            pirate_bench_heap_peak = current;
+        }
+    }
+}
+
+static void pirate_bench_heap_remove(void* pointer) {
+    if(pointer) {
+        __atomic_sub_fetch(
+            &pirate_bench_heap_current, malloc_usable_size(pointer), __ATOMIC_RELAXED);
+    }
+}
+
+void* __wrap_malloc(size_t size) {
+    void* pointer = __real_malloc(size);
+    pirate_bench_heap_add(pointer);
+    return pointer;
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    void* pointer = __real_calloc(count, size);
+    pirate_bench_heap_add(pointer);
+    return pointer;
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    pirate_bench_heap_remove(pointer);
+    pointer = __real_realloc(pointer, size);
+    pirate_bench_heap_add(pointer);
+    return pointer;
+}
+
+void __wrap_free(void* pointer) {
+    pirate_bench_heap_remove(pointer);
+    __real_free(pointer);
+}
+
+char* __wrap_strdup(const char* string) {
+    char* copy = __real_strdup(string);
+    pirate_bench_heap_add(copy);
+    return copy;
+}
+
+/**
+ * Command generation.
+ */
+
+typedef struct {
+    char** commands;
+    size_t count;
+    size_t length;
+} PirateBenchCorpus;
+
+static uint32_t pirate_bench_random(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/** Appends one random, syntactically valid element to a command; updates the nesting depths. */
+static int pirate_bench_generate_element(
+    char* buffer,
+    size_t space,
+    uint32_t* seed,
+    int* transactions,
+    int* loops) {
+    uint32_t choice = pirate_bench_random(seed) % 16;
+    uint32_t value = pirate_bench_random(seed);
+
+    switch(choice) {
+    case 0:
+        // A '[' inside a transaction is a repeated start; one ']' still ends it.
+        *transactions = 1;
+        return snprintf(buffer, space, "[");
+    case 1:
+        if(*transactions) {
+            *transactions -= 1;
+            return snprintf(buffer, space, "]");
+        }
+        return 0;
+    case 2:
+        return snprintf(buffer, space, "r ");
+    case 3:
+        return snprintf(buffer, space, "r:%lu ", (unsigned long)(value % 16 + 1));
+    case 4:
+        return snprintf(buffer, space, "& ");
+    case 5:
+        return snprintf(buffer, space, "&:%lu ", (unsigned long)(value % 8 + 1));
+    case 6:
+        return snprintf(buffer, space, "0x%02lX:%lu ", (unsigned long)(value & 0xFF), (unsigned long)(value % 16 + 2));
+    case 7:
+        return snprintf(buffer, space, "%lu ", (unsigned long)(value & 0xFF));
+    case 8: {
+        char bits[9];
+        for(int i = 0; i < 8; ++i) {
+            bits[i] = (value & (1 << i)) ? '1' : '0';
+        }
+        bits[8] = 0;
+        return snprintf(buffer, space, "0b%s ", bits);
+    }
+    case 9:
+        if(*loops < PIRATE_LOOP_DEPTH - 1) {
+            *loops += 1;
+            return snprintf(buffer, space, "{ ");
+        }
+        return 0;
+    case 10:
+        if(*loops) {
+            *loops -= 1;
+            return snprintf(buffer, space, "}:%lu ", (unsigned long)(value % 4 + 1));
+        }
+        return 0;
+    default:
+        return snprintf(buffer, space, "0x%02lX ", (unsigned long)(value & 0xFF));
+    }
+}
+
+/** Generates a balanced command of roughly the given length. */
+static char* pirate_bench_generate(size_t length, uint32_t* seed) {
+    // Leave room to close whatever is still open once we hit the target length.
+    size_t capacity = length + 64;
+    char* command = malloc(capacity);
+    size_t used = 0;
+    int transactions = 0, loops = 0;
+
+    while(used + 8 < length) {
+        used += pirate_bench_generate_element(
+            command + used, capacity - used, seed, &transactions, &loops);
+    }
+    while(loops--) {
+        used += snprintf(command + used, capacity - used, "}:2 ");
+    }
+    while(transactions--) {
+        used += snprintf(command + used, capacity - used, "]");
+    }
+
+    return command;
+}
+
+static void pirate_bench_corpus_init(PirateBenchCorpus* corpus, size_t length, size_t count, uint32_t seed) {
+    corpus->commands = malloc(count * sizeof(char*));
+    corpus->count = count;
+    corpus->length = length;
+
+    for(size_t i = 0; i < count; ++i) {
+        corpus->commands[i] = pirate_bench_generate(length, &seed);
+    }
+}
+
+static void pirate_bench_corpus_free(PirateBenchCorpus* corpus) {
+    for(size_t i = 0; i < corpus->count; ++i) {
+        free(corpus->commands[i]);
+    }
+    free(corpus->commands);
+}
+
+/**
+ * Measurement.
+ */
+
+/** One benchmark: runs a single iteration, and reports how much work it did. */
+typedef struct {
+    const char* name;
+
+    /** Optional; called once before timing starts, and after it ends. */
+    void (*setup)(void* context);
+    void (*teardown)(void* context);
+
+    /** Runs one iteration; adds to the work counters. */
+    void (*iterate)(void* context, uint64_t counters[3]);
+
+    /** What each work counter counts, per second; NULL if unused. */
+    const char* counter_names[3];
+
+    void* context;
+} PirateBenchCase;
+
+typedef struct {
+    double seconds;
+    uint64_t iterations;
+    uint64_t counters[3];
+
+    size_t stack_bytes;
+    size_t heap_peak_bytes;
+    double allocations_per_iteration;
+} PirateBenchResult;
+
+static double pirate_bench_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+typedef struct {
+    const PirateBenchCase* bench;
+    uint64_t counters[3];
+} PirateBenchStackProbe;
+
+static void* pirate_bench_stack_probe(void* context) {
+    PirateBenchStackProbe* probe = context;
+
+    if(probe->bench) {
+        probe->bench->iterate(probe->bench->context, probe->counters);
+    }
+    return NULL;
+}
+
+/** Runs a single iteration on a freshly painted stack, and returns how deep it went. */
+static size_t pirate_bench_stack_depth(const PirateBenchCase* bench) {
+    uint8_t* stack = __real_malloc(PIRATE_BENCH_STACK_SIZE);
+    PirateBenchStackProbe probe = {.bench = bench};
+    pthread_attr_t attributes;
+    pthread_t thread;
+
+    memset(stack, PIRATE_BENCH_STACK_PAINT, PIRATE_BENCH_STACK_SIZE);
+    pthread_attr_init(&attributes);
+    pthread_attr_setstack(&attributes, stack, PIRATE_BENCH_STACK_SIZE);
+    pthread_create(&thread, &attributes, pirate_bench_stack_probe, &probe);
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attributes);
+
+    // Stacks grow down; the first byte that's lost its paint marks the deepest point.
+    size_t untouched = 0;
+    while(untouched < PIRATE_BENCH_STACK_SIZE && stack[untouched] == PIRATE_BENCH_STACK_PAINT) {
+        untouched += 1;
+    }
+
+    __real_free(stack);
+    return PIRATE_BENCH_STACK_SIZE - untouched;
+}
+
+static void pirate_bench_run(const PirateBenchCase* bench, double min_seconds, PirateBenchResult* result) {
+    memset(result, 0, sizeof(*result));
+
+    size_t heap_before = pirate_bench_heap_current;
+    pirate_bench_heap_peak = heap_before;
+
+    if(bench->setup) {
+        bench->setup(bench->context);
+    }
+
+    // Run once first, so one-off costs like lazy symbol binding don't count against the case.
+    uint64_t warmup[3] = {0};
+    bench->iterate(bench->context, warmup);
+
+    // Depth is relative to a thread that does nothing, so thread overhead cancels out.
+    result->stack_bytes = pirate_bench_stack_depth(bench) - pirate_bench_stack_depth(NULL);
+
+    // Time in doubling batches, so cheap iterations aren't swamped by clock reads.
+    uint64_t batch = 1;
+    uint64_t allocations = pirate_bench_heap_allocations;
+    double start = pirate_bench_now();
+
+    while(true) {
+        for(uint64_t i = 0; i < batch; ++i) {
+            bench->iterate(bench->context, result->counters);
+        }
+        result->iterations += batch;
+        result->seconds = pirate_bench_now() - start;
+
+        if(result->seconds >= min_seconds) {
+            break;
+        }
+        batch *= 2;
+    }
+
+    result->allocations_per_iteration =
+        (double)(pirate_bench_heap_allocations - allocations) / result->iterations;
+
+    if(bench->teardown) {
+        bench->teardown(bench->context);
+    }
+    result->heap_peak_bytes = pirate_bench_heap_peak - heap_before;
+}
+
+static void pirate_bench_report(FILE* output, const PirateBenchCase* bench, const PirateBenchResult* result, bool last) {
+    fprintf(output, "    {\n      \"name\": \"%s\",\n", bench->name);
+    fprintf(output, "      \"iterations\": %llu,\n", (unsigned long long)result->iterations);
+    fprintf(output, "      \"seconds\": %.6f,\n", result->seconds);
+    fprintf(output, "      \"iterations_per_second\": %.1f,\n", result->iterations / result->seconds);
+
+    for(int i = 0; i < 3; ++i) {
+        if(bench->counter_names[i]) {
+            fprintf(output, "      \"%s\": %.1f,\n", bench->counter_names[i], result->counters[i] / result->seconds);
+        }
+    }
+
+    fprintf(output, "      \"stack_bytes\": %zu,\n", result->stack_bytes);
+    fprintf(output, "      \"heap_peak_bytes\": %zu,\n", result->heap_peak_bytes);
+    fprintf(output, "      \"allocations_per_iteration\": %.3f\n", result->allocations_per_iteration);
+    fprintf(output, "    }%s\n", last ? "" : ",");
+}
+
+/**
+ * Cases.
+ */
+
+typedef struct {
+    PirateBenchCorpus corpus;
+    size_t next;
+
+    /** Compiled versions of the corpus; entries that didn't compile are skipped. */
+    PirateProgram* programs;
+    size_t program_count;
+
+    PirateProgramCache cache;
+} PirateBenchCorpusContext;
+
+static const char* pirate_bench_next_command(PirateBenchCorpusContext* context) {
+    const char* command = context->corpus.commands[context->next];
+    context->next = (context->next + 1) % context->corpus.count;
+    return command;
+}
+
+static void pirate_bench_lex(void* context, uint64_t counters[3]) {
+    const char* command = pirate_bench_next_command(context);
+    size_t length = strlen(command);
+    size_t offset = 0;
+    PirateToken token;
+
+    do {
+        offset = pirate_lex_token(command, length, offset, &token);
+        counters[0] += 1;
+    } while(token.type != PirateTokenEnd && token.type != PirateTokenInvalid);
+    counters[1] += length;
+}
+
+static void pirate_bench_compile(void* context, uint64_t counters[3]) {
+    static PirateProgram program;
+    const char* command = pirate_bench_next_command(context);
+    size_t length = strlen(command);
+
+    if(pirate_compile(command, length, &program, NULL) == PirateErrorNone) {
+        counters[0] += program.length;
+    } else {
+        counters[2] += 1;
+    }
+    counters[1] += length;
+}
+
+static void pirate_bench_cache_setup(void* context) {
+    PirateBenchCorpusContext* corpus = context;
+    pirate_cache_reset(&corpus->cache);
+}
+
+static void pirate_bench_cache(void* context, uint64_t counters[3]) {
+    PirateBenchCorpusContext* corpus = context;
+    PirateError error;
+
+    // Cycle through fewer commands than the cache holds, as a user re-running commands would.
+    const char* command = corpus->corpus.commands[corpus->next];
+    corpus->next = (corpus->next + 1) % PIRATE_CACHE_ENTRIES;
+
+    uint32_t hits = corpus->cache.hits;
+    pirate_cache_get(&corpus->cache, command, &error, NULL);
+    counters[(corpus->cache.hits != hits) ? 0 : 1] += 1;
+}
+
+/** A bus that accepts everything instantly, so we measure only the interpreter. */
+static bool pirate_bench_null_condition(void* context) {
+    UNUSED(context);
+    return true;
+}
+
+static bool pirate_bench_null_write(void* context, const uint8_t* data, size_t length, PirateBusNext next) {
+    UNUSED(data);
+    UNUSED(next);
+    *(uint64_t*)context += length;
+    return true;
+}
+
+static bool pirate_bench_null_read(void* context, uint8_t* data, size_t length, PirateBusNext next) {
+    UNUSED(next);
+    memset(data, 0xFF, length);
+    *(uint64_t*)context += length;
+    return true;
+}
+
+static void pirate_bench_null_delay(void* context, uint32_t microseconds) {
+    UNUSED(context);
+    UNUSED(microseconds);
+}
+
+static void pirate_bench_discard(void* context, const uint8_t* data, size_t length) {
+    UNUSED(context);
+    UNUSED(data);
+    UNUSED(length);
+}
+
+static void pirate_bench_execute_setup(void* context) {
+    PirateBenchCorpusContext* corpus = context;
+
+    corpus->programs = malloc(corpus->corpus.count * sizeof(PirateProgram));
+    corpus->program_count = 0;
+
+    for(size_t i = 0; i < corpus->corpus.count; ++i) {
+        const char* command = corpus->corpus.commands[i];
+        if(pirate_compile(command, strlen(command), &corpus->programs[corpus->program_count], NULL) ==
+           PirateErrorNone) {
+            corpus->program_count += 1;
+        }
+    }
+}
+
+static void pirate_bench_execute_teardown(void* context) {
+    PirateBenchCorpusContext* corpus = context;
+    free(corpus->programs);
+}
+
+static void pirate_bench_execute(void* context, uint64_t counters[3]) {
+    PirateBenchCorpusContext* corpus = context;
+    uint64_t bytes = 0;
+
+    if(!corpus->program_count) {
+        return;
+    }
+
+    PirateBus bus = {
+        .start = pirate_bench_null_condition,
+        .stop = pirate_bench_null_condition,
+        .write = pirate_bench_null_write,
+        .read = pirate_bench_null_read,
+        .delay_us = pirate_bench_null_delay,
+        .context = &bytes,
+    };
+    PirateSink sink = {.data = pirate_bench_discard};
+    PirateExecReport report;
+
+    const PirateProgram* program = &corpus->programs[corpus->next];
+    corpus->next = (corpus->next + 1) % corpus->program_count;
+
+    pirate_execute(program, &bus, &sink, &report);
+    counters[0] += report.transactions;
+    counters[1] += bytes;
+    counters[2] += program->length;
+}
+
+/** Commands for the simulated I2C bus, which answers as a 24C512 at 0xA0. */
+static const char* const pirate_bench_i2c_commands[] = {
+    "[0xA0 0x00 0x00 r:64]",
+    "[0xA0 0x00 0x10 0xDE 0xAD 0xBE 0xEF]",
+    "{[0xA0 0x00 0x00 r:4]}:16",
+    "[0xA0]",
+};
+
+typedef struct {
+    PirateProgram programs[COUNT_OF(pirate_bench_i2c_commands)];
+    size_t next;
+
+    PirateBus bus;
+    PirateI2cBus i2c;
+    PirateI2cSpeedCache speeds;
+} PirateBenchI2cContext;
+
+static void pirate_bench_i2c_setup(void* context) {
+    PirateBenchI2cContext* i2c = context;
+
+    for(size_t i = 0; i < COUNT_OF(pirate_bench_i2c_commands); ++i) {
+        const char* command = pirate_bench_i2c_commands[i];
+        furi_check(pirate_compile(command, strlen(command), &i2c->programs[i], NULL) == PirateErrorNone);
+    }
+    pirate_i2c_bus_init(&i2c->bus, &i2c->i2c, &furi_hal_i2c_handle_external, &i2c->speeds);
+}
+
+static void pirate_bench_i2c(void* context, uint64_t counters[3]) {
+    PirateBenchI2cContext* i2c = context;
+    PirateSink sink = {.data = pirate_bench_discard};
+    PirateExecReport report;
+    uint64_t bytes = furi_hal_mock_i2c_get_byte_count();
+
+    const PirateProgram* program = &i2c->programs[i2c->next];
+    i2c->next = (i2c->next + 1) % COUNT_OF(i2c->programs);
+
+    i2c->bus.acquire(i2c->bus.context);
+    furi_check(pirate_execute(program, &i2c->bus, &sink, &report) == PirateExecOk);
+    i2c->bus.release(i2c->bus.context);
+
+    counters[0] += report.transactions;
+    counters[1] += furi_hal_mock_i2c_get_byte_count() - bytes;
+}
+
+/** A 256-byte EEPROM read on a bus clocked as the real one is; at the standard clock, or each device's fastest. */
+typedef struct {
+    const char* command;
+    PirateProgram program;
+
+    PirateBus bus;
+    PirateI2cBus i2c;
+    PirateI2cSpeedCache speeds;
+} PirateBenchI2cSpeedContext;
+
+static void pirate_bench_i2c_speed_setup(void* context) {
+    PirateBenchI2cSpeedContext* i2c = context;
+
+    furi_check(pirate_compile(i2c->command, strlen(i2c->command), &i2c->program, NULL) == PirateErrorNone);
+    memset(&i2c->speeds, 0, sizeof(i2c->speeds));
+    pirate_i2c_bus_init(&i2c->bus, &i2c->i2c, &furi_hal_i2c_handle_external, &i2c->speeds);
+    furi_hal_mock_i2c_set_clocked(true);
+}
+
+static void pirate_bench_i2c_speed_teardown(void* context) {
+    UNUSED(context);
+    furi_hal_mock_i2c_set_clocked(false);
+}
+
+static void pirate_bench_i2c_speed(void* context, uint64_t counters[3]) {
+    PirateBenchI2cSpeedContext* i2c = context;
+    PirateSink sink = {.data = pirate_bench_discard};
+    PirateExecReport report;
+    uint32_t probes = i2c->i2c.probes;
+    uint64_t bytes = furi_hal_mock_i2c_get_byte_count();
+
+    i2c->bus.acquire(i2c->bus.context);
+    furi_check(pirate_execute(&i2c->program, &i2c->bus, &sink, &report) == PirateExecOk);
+    i2c->bus.release(i2c->bus.context);
+
+    counters[0] += furi_hal_mock_i2c_get_byte_count() - bytes;
+    counters[1] += report.transactions;
+    counters[2] += i2c->i2c.probes - probes;
+}
+
+/** Commands for the simulated SPI flash; mostly bulk reads, as in flash bring-up. */
+static const char* const pirate_bench_spi_commands[] = {
+    "@8000 [0x9F r:3]",
+    "[0x03 0 0 0 r:256]",
+    "[0x06] [0x02 0 0x10 0 0xDE 0xAD 0xBE 0xEF 0x01 0x02 0x03 0x04]",
+    "[0x0B 0 0x01 0 0 r:4096]",
+};
+
+typedef struct {
+    PirateProgram programs[COUNT_OF(pirate_bench_spi_commands)];
+    size_t next;
+
+    PirateBus bus;
+    PirateSpiBus spi;
+} PirateBenchSpiContext;
+
+static void pirate_bench_spi_setup(void* context) {
+    PirateBenchSpiContext* spi = context;
+
+    for(size_t i = 0; i < COUNT_OF(pirate_bench_spi_commands); ++i) {
+        const char* command = pirate_bench_spi_commands[i];
+        furi_check(pirate_compile(command, strlen(command), &spi->programs[i], NULL) == PirateErrorNone);
+    }
+    furi_hal_mock_spi_attach_flash(1 << 20);
+    pirate_spi_bus_init(&spi->bus, &spi->spi, &furi_hal_spi_bus_handle_external);
+}
+
+static void pirate_bench_spi(void* context, uint64_t counters[3]) {
+    PirateBenchSpiContext* spi = context;
+    PirateSink sink = {.data = pirate_bench_discard};
+    PirateExecReport report;
+    uint64_t bytes = furi_hal_mock_spi_get_byte_count();
+    uint64_t transfers = furi_hal_mock_spi_get_dma_count();
+
+    const PirateProgram* program = &spi->programs[spi->next];
+    spi->next = (spi->next + 1) % COUNT_OF(spi->programs);
+
+    spi->bus.acquire(spi->bus.context);
+    furi_check(pirate_execute(program, &spi->bus, &sink, &report) == PirateExecOk);
+    spi->bus.release(spi->bus.context);
+
+    counters[0] += report.transactions;
+    counters[1] += furi_hal_mock_spi_get_byte_count() - bytes;
+    counters[2] += furi_hal_mock_spi_get_dma_count() - transfers;
+}
+
+/** Room for a result store and an engine; a little more than the app needs for them. */
+#define PIRATE_BENCH_ARENA_SIZE 8192
+
+/** A full round trip through the engine thread, as the GUI does it. */
+typedef struct {
+    PirateArena arena;
+    uint8_t arena_storage[PIRATE_BENCH_ARENA_SIZE];
+
+    ViewDispatcher* view_dispatcher;
+    PirateResultStore* results;
+    PirateEngine* engine;
+    PirateProgram program;
+    volatile bool complete;
+
+    /** Commands queued up and sent together; 0 runs each on its own. */
+    uint8_t batch;
+} PirateBenchEngineContext;
+
+#define PIRATE_BENCH_ENGINE_EVENT 1
+
+static bool pirate_bench_engine_event(void* context, uint32_t event) {
+    PirateBenchEngineContext* engine = context;
+
+    engine->complete = (event == PIRATE_BENCH_ENGINE_EVENT);
+    return true;
+}
+
+static void pirate_bench_engine_setup(void* context) {
+    PirateBenchEngineContext* engine = context;
+    const char* command = "[0xA0 0x00 0x00 r:64]";
+
+    engine->view_dispatcher = view_dispatcher_alloc();
+    view_dispatcher_enable_queue(engine->view_dispatcher);
+    view_dispatcher_set_event_callback_context(engine->view_dispatcher, engine);
+    view_dispatcher_set_custom_event_callback(engine->view_dispatcher, pirate_bench_engine_event);
+
+    pirate_arena_init(&engine->arena, engine->arena_storage, sizeof(engine->arena_storage));
+    engine->results = pirate_result_store_alloc(&engine->arena);
+    engine->engine = pirate_engine_alloc(
+        engine->view_dispatcher, PIRATE_BENCH_ENGINE_EVENT, engine->results, &engine->arena);
+    furi_check(pirate_compile(command, strlen(command), &engine->program, NULL) == PirateErrorNone);
+}
+
+static void pirate_bench_engine_teardown(void* context) {
+    PirateBenchEngineContext* engine = context;
+
+    pirate_engine_free(engine->engine);
+    pirate_result_store_free(engine->results);
+    view_dispatcher_free(engine->view_dispatcher);
+}
+
+static void pirate_bench_engine(void* context, uint64_t counters[3]) {
+    PirateBenchEngineContext* engine = context;
+
+    engine->complete = false;
+    if(engine->batch) {
+        for(uint8_t i = 0; i < engine->batch; ++i) {
+            furi_check(pirate_engine_queue(engine->engine, &engine->program));
+        }
+        furi_check(pirate_engine_run_queue(engine->engine));
+    } else {
+        furi_check(pirate_engine_run(engine->engine, &engine->program));
+    }
+
+    while(!engine->complete) {
+        view_dispatcher_process_queue(engine->view_dispatcher);
+    }
+
+    counters[0] += MAX(engine->batch, 1);
+}
+
+/** Redraws of the command input while a direction is held, as the GUI does them. */
+typedef struct {
+    PirateInput* input;
+    Canvas* canvas;
+    char command[129];
+} PirateBenchInputContext;
+
+static void pirate_bench_input_setup(void* context) {
+    PirateBenchInputContext* input = context;
+
+    strcpy(input->command, "[0xA0 0x00 0x00 r:64]");
+    input->input = pirate_input_alloc();
+    input->canvas = canvas_alloc();
+    pirate_input_set_result_callback(
+        input->input, NULL, NULL, NULL, input->command, sizeof(input->command) - 1);
+}
+
+static void pirate_bench_input_teardown(void* context) {
+    PirateBenchInputContext* input = context;
+
+    canvas_free(input->canvas);
+    pirate_input_free(input->input);
+}
+
+static void pirate_bench_input(void* context, uint64_t counters[3]) {
+    PirateBenchInputContext* input = context;
+    View* view = pirate_input_get_view(input->input);
+    InputEvent event = {.key = InputKeyRight, .type = InputTypeRepeat};
+
+    view_input(view, &event);
+    view_draw(view, input->canvas);
+
+    counters[0] += 1;
+}
+
+/**
+ * A held key whose repeats come in four to a frame. They're gathered up while the frame's
+ * pending; so the model should be updated once a frame, not once a repeat.
+ */
+static void pirate_bench_input_backlog(void* context, uint64_t counters[3]) {
+    PirateBenchInputContext* input = context;
+    View* view = pirate_input_get_view(input->input);
+    InputEvent event = {.key = InputKeyRight, .type = InputTypeRepeat};
+    uint32_t updates = view_get_update_count(view);
+
+    for(size_t i = 0; i < 4; ++i) {
+        view_input(view, &event);
+    }
+    view_draw(view, input->canvas);
+
+    counters[0] += 1;
+    counters[1] += 4;
+    counters[2] += view_get_update_count(view) - updates;
+}
+
+/** Edits in the middle of a multi-kilobyte script, as when inserting into a long command. */
+typedef struct {
+    PirateInput* input;
+    char script[4097];
+} PirateBenchEditContext;
+
+static void pirate_bench_input_press(PirateInput* input, InputKey key, InputType type) {
+    InputEvent event = {.key = key, .type = type};
+    view_input(pirate_input_get_view(input), &event);
+}
+
+static void pirate_bench_edit_setup(void* context) {
+    PirateBenchEditContext* edit = context;
+    size_t length = 0;
+
+    while(length + 16 < sizeof(edit->script) - 1) {
+        length += snprintf(&edit->script[length], 17, "[0xA0 0x%02X r:4]", (unsigned)(length & 0xFF));
+    }
+
+    edit->input = pirate_input_alloc();
+    pirate_input_set_result_callback(
+        edit->input, NULL, NULL, NULL, edit->script, sizeof(edit->script) - 1);
+
+    // Walk the cursor back to the middle of the script, then return to the '[' key.
+    pirate_bench_input_press(edit->input, InputKeyUp, InputTypeShort);
+    for(size_t i = 0; i < length / 2; ++i) {
+        pirate_bench_input_press(edit->input, InputKeyLeft, InputTypeShort);
+    }
+    pirate_bench_input_press(edit->input, InputKeyDown, InputTypeShort);
+}
+
+static void pirate_bench_edit_teardown(void* context) {
+    PirateBenchEditContext* edit = context;
+    pirate_input_free(edit->input);
+}
+
+static void pirate_bench_edit(void* context, uint64_t counters[3]) {
+    PirateBenchEditContext* edit = context;
+
+    pirate_bench_input_press(edit->input, InputKeyOk, InputTypeShort);
+    pirate_bench_input_press(edit->input, InputKeyBack, InputTypeLong);
+
+    counters[0] += 2;
+}
+
+/** Predictions taken from the bar and backed out again; each edit asks for new ones. */
+typedef struct {
+    PirateInput* input;
+    PiratePredictor predictor;
+    char command[129];
+} PirateBenchPredictContext;
+
+static void pirate_bench_predict_callback(
+    void* context,
+    const char* text,
+    size_t length,
+    PiratePredictions* predictions) {
+    PirateBenchPredictContext* predict = context;
+    pirate_predict(&predict->predictor, text, length, predictions);
+}
+
+static void pirate_bench_predict_setup(void* context) {
+    PirateBenchPredictContext* predict = context;
+
+    pirate_predict_reset(&predict->predictor);
+    for(size_t i = 0; i < COUNT_OF(pirate_bench_i2c_commands); ++i) {
+        pirate_predict_learn(&predict->predictor, pirate_bench_i2c_commands[i]);
+    }
+
+    // Every step between "[0xA0 " and "[0xA0 0x00 " has something to offer; so the cursor
+    // stays on the bar throughout.
+    strcpy(predict->command, "[0xA0 ");
+    predict->input = pirate_input_alloc();
+    pirate_input_set_result_callback(
+        predict->input, NULL, NULL, NULL, predict->command, sizeof(predict->command) - 1);
+    pirate_input_set_prediction_callback(predict->input, pirate_bench_predict_callback, predict);
+    pirate_bench_input_press(predict->input, InputKeyUp, InputTypeShort);
+}
+
+static void pirate_bench_predict_teardown(void* context) {
+    PirateBenchPredictContext* predict = context;
+    pirate_input_free(predict->input);
+}
+
+static void pirate_bench_predict(void* context, uint64_t counters[3]) {
+    PirateBenchPredictContext* predict = context;
+
+    // Take "0x00 ", then back it out.
+    pirate_bench_input_press(predict->input, InputKeyOk, InputTypeShort);
+    for(size_t i = 0; i < 5; ++i) {
+        pirate_bench_input_press(predict->input, InputKeyBack, InputTypeLong);
+    }
+
+    counters[0] += 6;
+}
+
+/** 400 kHz traffic on the sniffed bus, driven edge by edge through the simulated pins. */
+typedef struct {
+    ViewDispatcher* view_dispatcher;
+    PirateSniffer* sniffer;
+    uint32_t next_line;
+
+    /** When we last moved a line; each half bit is held for as long as it would be on the wire. */
+    uint32_t last_edge;
+} PirateBenchSnifferContext;
+
+#define PIRATE_BENCH_SNIFFER_EVENT 1
+
+/** Half of a 400 kHz bit, in cycles of the 64 MHz core clock. */
+#define PIRATE_BENCH_SNIFFER_HALF_BIT 80
+
+static void pirate_bench_sniffer_line(void* context, uint32_t number, const char* text) {
+    PirateBenchSnifferContext* sniff = context;
+    UNUSED(text);
+    sniff->next_line = number;
+}
+
+static bool pirate_bench_sniffer_event(void* context, uint32_t event) {
+    PirateBenchSnifferContext* sniff = context;
+    UNUSED(event);
+
+    // Read the transcript back as the GUI would, so the decoder's locking is part of the cost.
+    pirate_sniffer_read_lines(sniff->sniffer, sniff->next_line, pirate_bench_sniffer_line, sniff);
+    return true;
+}
+
+static void pirate_bench_sniffer_drive(PirateBenchSnifferContext* sniff, const GpioPin* pin, bool level) {
+    while(DWT->CYCCNT - sniff->last_edge < PIRATE_BENCH_SNIFFER_HALF_BIT) {
+    }
+
+    sniff->last_edge = DWT->CYCCNT;
+    furi_hal_mock_gpio_write(pin, level);
+}
+
+/** Clocks out a byte and its acknowledge, starting and ending with SCL low. */
+static void pirate_bench_sniffer_byte(PirateBenchSnifferContext* sniff, uint8_t data, bool ack) {
+    uint16_t bits = (data << 1) | !ack;
+
+    for(int bit = 8; bit >= 0; --bit) {
+        pirate_bench_sniffer_drive(sniff, &gpio_ext_pc1, bits & (1 << bit));
+        pirate_bench_sniffer_drive(sniff, &gpio_ext_pc0, true);
+        pirate_bench_sniffer_drive(sniff, &gpio_ext_pc0, false);
+    }
+}
+
+static void pirate_bench_sniffer_setup(void* context) {
+    PirateBenchSnifferContext* sniff = context;
+
+    sniff->view_dispatcher = view_dispatcher_alloc();
+    view_dispatcher_enable_queue(sniff->view_dispatcher);
+    view_dispatcher_set_event_callback_context(sniff->view_dispatcher, sniff);
+    view_dispatcher_set_custom_event_callback(sniff->view_dispatcher, pirate_bench_sniffer_event);
+
+    sniff->sniffer = pirate_sniffer_alloc(sniff->view_dispatcher, PIRATE_BENCH_SNIFFER_EVENT);
+    furi_check(pirate_sniffer_start(sniff->sniffer));
+    sniff->last_edge = DWT->CYCCNT;
+}
+
+static void pirate_bench_sniffer_teardown(void* context) {
+    PirateBenchSnifferContext* sniff = context;
+
+    pirate_sniffer_free(sniff->sniffer);
+    view_dispatcher_free(sniff->view_dispatcher);
+}
+
+/** One random read of a 24Cxx EEPROM: [A0+ 00+ 00+ [A1+ 8 bytes ] */
+static void pirate_bench_sniffer(void* context, uint64_t counters[3]) {
+    PirateBenchSnifferContext* sniff = context;
+    PirateSnifferStats before, after;
+
+    pirate_sniffer_get_stats(sniff->sniffer, &before);
+
+    pirate_bench_sniffer_drive(sniff, &gpio_ext_pc1, false);
+    pirate_bench_sniffer_drive(sniff, &gpio_ext_pc0, false);
+    pirate_bench_sniffer_byte(sniff, 0xA0, true);
+    pirate_bench_sniffer_byte(sniff, 0x00, true);
+    pirate_bench_sniffer_byte(sniff, 0x00, true);
+
+    pirate_bench_sniffer_drive(sniff, &gpio_ext_pc1, true);
+    pirate_bench_sniffer_drive(sniff, &gpio_ext_pc0, true);
+    pirate_bench_sniffer_drive(sniff, &gpio_ext_pc1, false);
+    pirate_bench_sniffer_drive(sniff, &gpio_ext_pc0, false);
+    pirate_bench_sniffer_byte(sniff, 0xA1, true);
+    for(int i = 0; i < 8; ++i) {
+        pirate_bench_sniffer_byte(sniff, i, i < 7);
+    }
+
+    pirate_bench_sniffer_drive(sniff, &gpio_ext_pc1, false);
+    pirate_bench_sniffer_drive(sniff, &gpio_ext_pc0, true);
+    pirate_bench_sniffer_drive(sniff, &gpio_ext_pc1, true);
+
+    view_dispatcher_process_queue(sniff->view_dispatcher);
+    pirate_sniffer_get_stats(sniff->sniffer, &after);
+
+    counters[0] += after.samples - before.samples;
+    counters[1] += (after.overruns + after.late) - (before.overruns + before.late);
+    counters[2] += after.transactions - before.transactions;
+}
+
+/** 1 Mbaud traffic through the USB-to-UART bridge, with its meter redrawing as the GUI would. */
+typedef struct {
+    ViewDispatcher* view_dispatcher;
+    PirateBridge* bridge;
+    PirateBridgeMeter* meter;
+    Canvas* canvas;
+
+    /** What's come out of each end; counted on the bridge's own threads. */
+    volatile uint64_t to_host;
+    volatile uint64_t to_uart;
+
+    uint8_t pattern[CDC_DATA_SZ];
+    uint32_t last_burst;
+} PirateBenchBridgeContext;
+
+#define PIRATE_BENCH_BRIDGE_EVENT 1
+#define PIRATE_BENCH_BRIDGE_BAUD 1000000
+
+/** Bytes we play into the UART at once; and how long they take on the wire, in core cycles. */
+#define PIRATE_BENCH_BRIDGE_BURST 10
+#define PIRATE_BENCH_BRIDGE_BURST_CYCLES (PIRATE_BENCH_BRIDGE_BURST * 10 * 64000000ULL / PIRATE_BENCH_BRIDGE_BAUD)
+
+static bool pirate_bench_bridge_event(void* context, uint32_t event) {
+    PirateBenchBridgeContext* bridge = context;
+    PirateBridgeStats stats;
+    UNUSED(event);
+
+    pirate_bridge_get_stats(bridge->bridge, &stats);
+    pirate_bridge_meter_set_stats(bridge->meter, &stats);
+    view_draw(pirate_bridge_meter_get_view(bridge->meter), bridge->canvas);
+    return true;
+}
+
+static void pirate_bench_bridge_host(void* context, const uint8_t* data, size_t length) {
+    PirateBenchBridgeContext* bridge = context;
+    UNUSED(data);
+    bridge->to_host += length;
+}
+
+static void pirate_bench_bridge_uart(void* context, const uint8_t* data, size_t length) {
+    PirateBenchBridgeContext* bridge = context;
+    UNUSED(data);
+    bridge->to_uart += length;
+}
+
+static void pirate_bench_bridge_setup(void* context) {
+    PirateBenchBridgeContext* bridge = context;
+
+    bridge->view_dispatcher = view_dispatcher_alloc();
+    view_dispatcher_enable_queue(bridge->view_dispatcher);
+    view_dispatcher_set_event_callback_context(bridge->view_dispatcher, bridge);
+    view_dispatcher_set_custom_event_callback(bridge->view_dispatcher, pirate_bench_bridge_event);
+    bridge->meter = pirate_bridge_meter_alloc();
+    bridge->canvas = canvas_alloc();
+
+    for(size_t i = 0; i < sizeof(bridge->pattern); ++i) {
+        bridge->pattern[i] = i;
+    }
+
+    furi_hal_mock_serial_set_tx_callback(FuriHalSerialIdUsart, pirate_bench_bridge_uart, bridge);
+    bridge->bridge = pirate_bridge_alloc(bridge->view_dispatcher, PIRATE_BENCH_BRIDGE_EVENT);
+    furi_check(pirate_bridge_start(bridge->bridge));
+    furi_hal_mock_cdc_connect(PIRATE_BRIDGE_CDC_INTERFACE, pirate_bench_bridge_host, bridge);
+    furi_hal_mock_cdc_set_line_coding(PIRATE_BRIDGE_CDC_INTERFACE, PIRATE_BENCH_BRIDGE_BAUD);
+
+    bridge->last_burst = DWT->CYCCNT;
+}
+
+static void pirate_bench_bridge_teardown(void* context) {
+    PirateBenchBridgeContext* bridge = context;
+
+    furi_hal_mock_cdc_disconnect(PIRATE_BRIDGE_CDC_INTERFACE);
+    pirate_bridge_free(bridge->bridge);
+    furi_hal_mock_serial_set_tx_callback(FuriHalSerialIdUsart, NULL, NULL);
+
+    canvas_free(bridge->canvas);
+    pirate_bridge_meter_free(bridge->meter);
+    view_dispatcher_free(bridge->view_dispatcher);
+}
+
+/** A millisecond on the wire: a packet from the host, if the UART's taken the last, and 100 bytes back. */
+static void pirate_bench_bridge(void* context, uint64_t counters[3]) {
+    PirateBenchBridgeContext* bridge = context;
+    uint64_t to_host = bridge->to_host;
+    uint64_t to_uart = bridge->to_uart;
+    size_t lost = 0;
+
+    furi_hal_mock_cdc_host_send(PIRATE_BRIDGE_CDC_INTERFACE, bridge->pattern, sizeof(bridge->pattern), 0);
+
+    for(size_t sent = 0; sent < 100; sent += PIRATE_BENCH_BRIDGE_BURST) {
+        while(DWT->CYCCNT - bridge->last_burst < PIRATE_BENCH_BRIDGE_BURST_CYCLES) {
+        }
+        bridge->last_burst = DWT->CYCCNT;
+
+        lost += PIRATE_BENCH_BRIDGE_BURST -
+                furi_hal_mock_serial_receive(FuriHalSerialIdUsart, &bridge->pattern[sent % 50], PIRATE_BENCH_BRIDGE_BURST);
+    }
+
+    view_dispatcher_process_queue(bridge->view_dispatcher);
+
+    counters[0] += bridge->to_host - to_host;
+    counters[1] += bridge->to_uart - to_uart;
+    counters[2] += lost;
+}
+
+/** A host reading SPI flash through the Bus Pirate binary protocol, as flashrom does, at 8 MHz. */
+typedef struct {
+    ViewDispatcher* view_dispatcher;
+    PirateBbio* bbio;
+
+    /** What's come back to the host, counted on the protocol's thread; and when to tell us. */
+    volatile uint64_t received;
+    volatile uint64_t packets;
+    volatile uint64_t expected;
+    FuriSemaphore* answered;
+
+    uint32_t address;
+} PirateBenchBbioContext;
+
+#define PIRATE_BENCH_BBIO_EVENT 1
+
+/** Bytes each read command asks for; the most one write-then-read can carry. */
+#define PIRATE_BENCH_BBIO_READ PIRATE_BBIO_TRANSFER_SIZE
+
+static bool pirate_bench_bbio_event(void* context, uint32_t event) {
+    PirateBenchBbioContext* bbio = context;
+    PirateBbioStats stats;
+    UNUSED(event);
+
+    pirate_bbio_get_stats(bbio->bbio, &stats);
+    return true;
+}
+
+static void pirate_bench_bbio_host(void* context, const uint8_t* data, size_t length) {
+    PirateBenchBbioContext* bbio = context;
+    UNUSED(data);
+
+    bbio->received += length;
+    bbio->packets += 1;
+    if(bbio->expected && (bbio->received >= bbio->expected)) {
+        bbio->expected = 0;
+        furi_semaphore_release(bbio->answered);
+    }
+}
+
+/** Sends a command, and waits for the given number of bytes to come back. */
+static void pirate_bench_bbio_command(PirateBenchBbioContext* bbio, const uint8_t* command, size_t length, size_t answer) {
+    bbio->expected = bbio->received + answer;
+    furi_check(furi_hal_mock_cdc_host_send(PIRATE_BBIO_CDC_INTERFACE, command, length, 1000) == length);
+    furi_check(furi_semaphore_acquire(bbio->answered, 1000) == FuriStatusOk);
+}
+
+static void pirate_bench_bbio_setup(void* context) {
+    PirateBenchBbioContext* bbio = context;
+    static const uint8_t enter[20] = {0};
+    static const uint8_t spi_8mhz[] = {0x01, 0x67};
+
+    bbio->view_dispatcher = view_dispatcher_alloc();
+    view_dispatcher_enable_queue(bbio->view_dispatcher);
+    view_dispatcher_set_event_callback_context(bbio->view_dispatcher, bbio);
+    view_dispatcher_set_custom_event_callback(bbio->view_dispatcher, pirate_bench_bbio_event);
+    bbio->answered = furi_semaphore_alloc(1, 0);
+
+    furi_hal_mock_spi_attach_flash(1 << 20);
+    furi_hal_mock_spi_set_clocked(true);
+
+    bbio->bbio = pirate_bbio_alloc(bbio->view_dispatcher, PIRATE_BENCH_BBIO_EVENT);
+    furi_check(pirate_bbio_start(bbio->bbio));
+    furi_hal_mock_cdc_connect(PIRATE_BBIO_CDC_INTERFACE, pirate_bench_bbio_host, bbio);
+
+    // "BBIO1", then "SPI1" and an acknowledgement of the speed.
+    pirate_bench_bbio_command(bbio, enter, sizeof(enter), 5);
+    pirate_bench_bbio_command(bbio, spi_8mhz, sizeof(spi_8mhz), 5);
+}
+
+static void pirate_bench_bbio_teardown(void* context) {
+    PirateBenchBbioContext* bbio = context;
+
+    furi_hal_mock_cdc_disconnect(PIRATE_BBIO_CDC_INTERFACE);
+    pirate_bbio_free(bbio->bbio);
+    furi_hal_mock_spi_set_clocked(false);
+
+    furi_semaphore_free(bbio->answered);
+    view_dispatcher_free(bbio->view_dispatcher);
+}
+
+/** One write-then-read: a 0x03 read command and address out, then 4 KiB of flash back. */
+static void pirate_bench_bbio(void* context, uint64_t counters[3]) {
+    PirateBenchBbioContext* bbio = context;
+    uint64_t received = bbio->received;
+    uint64_t packets = bbio->packets;
+    uint8_t command[] = {
+        0x04,
+        0x00,
+        0x04,
+        PIRATE_BENCH_BBIO_READ >> 8,
+        PIRATE_BENCH_BBIO_READ & 0xFF,
+        0x03,
+        bbio->address >> 16,
+        bbio->address >> 8,
+        bbio->address,
+    };
+
+    bbio->address = (bbio->address + PIRATE_BENCH_BBIO_READ) % (1 << 20);
+    pirate_bench_bbio_command(bbio, command, sizeof(command), 1 + PIRATE_BENCH_BBIO_READ);
+    view_dispatcher_process_queue(bbio->view_dispatcher);
+
+    // The acknowledgement's not flash data; so it doesn't count.
+    counters[0] += bbio->received - received - 1;
+    counters[1] += bbio->packets - packets;
+    counters[2] += 1;
+}
+
+/** A ROM search of a bus of 1-Wire thermometers, run on the scanner's thread as the app does. */
+typedef struct {
+    ViewDispatcher* view_dispatcher;
+    PirateOneWireScanner* scanner;
+    bool complete;
+} PirateBenchOneWireContext;
+
+#define PIRATE_BENCH_ONEWIRE_EVENT 1
+#define PIRATE_BENCH_ONEWIRE_DEVICES 20
+
+static bool pirate_bench_onewire_event(void* context, uint32_t event) {
+    PirateBenchOneWireContext* onewire = context;
+
+    onewire->complete = (event == PIRATE_BENCH_ONEWIRE_EVENT);
+    return true;
+}
+
+static void pirate_bench_onewire_setup(void* context) {
+    PirateBenchOneWireContext* onewire = context;
+
+    furi_hal_mock_onewire_attach_thermometers(PIRATE_BENCH_ONEWIRE_DEVICES);
+
+    onewire->view_dispatcher = view_dispatcher_alloc();
+    view_dispatcher_enable_queue(onewire->view_dispatcher);
+    view_dispatcher_set_event_callback_context(onewire->view_dispatcher, onewire);
+    view_dispatcher_set_custom_event_callback(onewire->view_dispatcher, pirate_bench_onewire_event);
+    onewire->scanner = pirate_onewire_scanner_alloc(onewire->view_dispatcher, PIRATE_BENCH_ONEWIRE_EVENT);
+}
+
+static void pirate_bench_onewire_teardown(void* context) {
+    PirateBenchOneWireContext* onewire = context;
+
+    pirate_onewire_scanner_free(onewire->scanner);
+    view_dispatcher_free(onewire->view_dispatcher);
+    furi_hal_mock_onewire_attach_thermometers(0);
+}
+
+/** One full search; which, the slots being real time, mostly measures how little time we waste between them. */
+static void pirate_bench_onewire(void* context, uint64_t counters[3]) {
+    PirateBenchOneWireContext* onewire = context;
+    PirateOneWireScanResult result;
+
+    onewire->complete = false;
+    furi_check(pirate_onewire_scanner_start(onewire->scanner));
+    while(!onewire->complete) {
+        view_dispatcher_process_queue(onewire->view_dispatcher);
+    }
+
+    pirate_onewire_scanner_get_result(onewire->scanner, &result);
+
+    // A search that loses its way is counted, rather than taken down with the rest of the run;
+    // what it found still counts, as do the slots it spent.
+    counters[0] += result.count;
+    counters[1] += result.slots;
+    if(result.bus_error || result.count != PIRATE_BENCH_ONEWIRE_DEVICES) {
+        counters[2] += 1;
+    }
+}
+
+/** Scrolling the result dump a row at a time, as a held key does; the same whatever the result's size. */
+typedef struct {
+    uint32_t length;
+
+    PirateArena arena;
+    uint8_t arena_storage[PIRATE_BENCH_ARENA_SIZE];
+    PirateResultStore* results;
+    PirateHexDump* hex_dump;
+    Canvas* canvas;
+    uint32_t rows;
+    uint32_t top_row;
+} PirateBenchHexDumpContext;
+
+static void pirate_bench_hex_dump_setup(void* context) {
+    PirateBenchHexDumpContext* dump = context;
+    uint8_t data[256];
+
+    // Anything past the ring goes out to the card, and has to come back from it as we scroll.
+    pirate_arena_init(&dump->arena, dump->arena_storage, sizeof(dump->arena_storage));
+    dump->results = pirate_result_store_alloc(&dump->arena);
+    pirate_result_store_begin(dump->results, dump->length);
+    for(uint32_t offset = 0; offset < dump->length; offset += sizeof(data)) {
+        size_t count = MIN(dump->length - offset, sizeof(data));
+
+        for(size_t i = 0; i < count; ++i) {
+            data[i] = (uint8_t)((offset + i) * 7);
+        }
+        furi_check(pirate_result_store_write(dump->results, data, count));
+    }
+    pirate_result_store_end(dump->results);
+
+    dump->hex_dump = pirate_hex_dump_alloc();
+    dump->canvas = canvas_alloc();
+    dump->rows = (dump->length + PIRATE_HEX_DUMP_ROW_BYTES - 1) / PIRATE_HEX_DUMP_ROW_BYTES;
+    dump->top_row = 0;
+    pirate_hex_dump_set_result(dump->hex_dump, dump->results);
+}
+
+static void pirate_bench_hex_dump_teardown(void* context) {
+    PirateBenchHexDumpContext* dump = context;
+
+    pirate_hex_dump_free(dump->hex_dump);
+    canvas_free(dump->canvas);
+    pirate_result_store_free(dump->results);
+}
+
+/** One row down and a redraw; from the bottom, back to the top, so we're always reading fresh rows. */
+static void pirate_bench_hex_dump(void* context, uint64_t counters[3]) {
+    PirateBenchHexDumpContext* dump = context;
+    View* view = pirate_hex_dump_get_view(dump->hex_dump);
+    InputEvent event = {.key = InputKeyDown, .type = InputTypeRepeat};
+
+    if(++dump->top_row + PIRATE_HEX_DUMP_ROWS > dump->rows) {
+        event = (InputEvent){.key = InputKeyLeft, .type = InputTypeLong};
+        dump->top_row = 0;
+    }
+
+    view_input(view, &event);
+    view_draw(view, dump->canvas);
+
+    counters[0] += 1;
+}
+
+/**
+ * The table of cases.
+ */
+
+/** Cases run once against each corpus, as "<name>/<command length>"; each gets its corpus as its context. */
+static const PirateBenchCase pirate_bench_corpus_cases[] = {
+    {
+        .name = "lex",
+        .iterate = pirate_bench_lex,
+        .counter_names = {"tokens_per_second", "source_bytes_per_second", NULL},
+    },
+    {
+        .name = "compile",
+        .iterate = pirate_bench_compile,
+        .counter_names = {"bytecode_bytes_per_second", "source_bytes_per_second", "errors_per_second"},
+    },
+    {
+        .name = "cache",
+        .setup = pirate_bench_cache_setup,
+        .iterate = pirate_bench_cache,
+        .counter_names = {"hits_per_second", "misses_per_second", NULL},
+    },
+    {
+        .name = "execute",
+        .setup = pirate_bench_execute_setup,
+        .teardown = pirate_bench_execute_teardown,
+        .iterate = pirate_bench_execute,
+        .counter_names = {"transactions_per_second", "bus_bytes_per_second", "bytecode_bytes_per_second"},
+    },
+};
+
+/** Cases that go through the buses, the engine and the views; each run once, with its own context. */
+static const PirateBenchCase pirate_bench_cases[] = {
+    {
+        .name = "execute/i2c",
+        .setup = pirate_bench_i2c_setup,
+        .iterate = pirate_bench_i2c,
+        .counter_names = {"transactions_per_second", "bus_bytes_per_second", NULL},
+        .context = &(PirateBenchI2cContext){},
+    },
+    {
+        .name = "execute/spi",
+        .setup = pirate_bench_spi_setup,
+        .iterate = pirate_bench_spi,
+        .counter_names = {"transactions_per_second", "bus_bytes_per_second", "dma_transfers_per_second"},
+        .context = &(PirateBenchSpiContext){},
+    },
+    {
+        .name = "engine/round_trip",
+        .setup = pirate_bench_engine_setup,
+        .teardown = pirate_bench_engine_teardown,
+        .iterate = pirate_bench_engine,
+        .counter_names = {"commands_per_second", NULL, NULL},
+        .context = &(PirateBenchEngineContext){},
+    },
+    {
+        .name = "engine/batch_8",
+        .setup = pirate_bench_engine_setup,
+        .teardown = pirate_bench_engine_teardown,
+        .iterate = pirate_bench_engine,
+        .counter_names = {"commands_per_second", NULL, NULL},
+        .context = &(PirateBenchEngineContext){.batch = PIRATE_ENGINE_BATCH_MAX},
+    },
+    {
+        .name = "input/held_key",
+        .setup = pirate_bench_input_setup,
+        .teardown = pirate_bench_input_teardown,
+        .iterate = pirate_bench_input,
+        .counter_names = {"frames_per_second", NULL, NULL},
+        .context = &(PirateBenchInputContext){},
+    },
+    {
+        .name = "input/held_key_backlog",
+        .setup = pirate_bench_input_setup,
+        .teardown = pirate_bench_input_teardown,
+        .iterate = pirate_bench_input_backlog,
+        .counter_names = {"frames_per_second", "repeats_per_second", "updates_per_second"},
+        .context = &(PirateBenchInputContext){},
+    },
+    {
+        .name = "input/edit_4k",
+        .setup = pirate_bench_edit_setup,
+        .teardown = pirate_bench_edit_teardown,
+        .iterate = pirate_bench_edit,
+        .counter_names = {"edits_per_second", NULL, NULL},
+        .context = &(PirateBenchEditContext){},
+    },
+    {
+        .name = "input/predict",
+        .setup = pirate_bench_predict_setup,
+        .teardown = pirate_bench_predict_teardown,
+        .iterate = pirate_bench_predict,
+        .counter_names = {"keys_per_second", NULL, NULL},
+        .context = &(PirateBenchPredictContext){},
+    },
+    {
+        .name = "sniffer/i2c_400k",
+        .setup = pirate_bench_sniffer_setup,
+        .teardown = pirate_bench_sniffer_teardown,
+        .iterate = pirate_bench_sniffer,
+        .counter_names = {"edges_per_second", "lost_edges_per_second", "transactions_per_second"},
+        .context = &(PirateBenchSnifferContext){},
+    },
+    {
+        .name = "bridge/uart_1m",
+        .setup = pirate_bench_bridge_setup,
+        .teardown = pirate_bench_bridge_teardown,
+        .iterate = pirate_bench_bridge,
+        .counter_names = {"uart_to_usb_bytes_per_second", "usb_to_uart_bytes_per_second", "lost_bytes_per_second"},
+        .context = &(PirateBenchBridgeContext){},
+    },
+    {
+        .name = "bbio/spi_read_8m",
+        .setup = pirate_bench_bbio_setup,
+        .teardown = pirate_bench_bbio_teardown,
+        .iterate = pirate_bench_bbio,
+        .counter_names = {"spi_bytes_per_second", "usb_packets_per_second", "commands_per_second"},
+        .context = &(PirateBenchBbioContext){},
+    },
+    {
+        .name = "onewire/search_20",
+        .setup = pirate_bench_onewire_setup,
+        .teardown = pirate_bench_onewire_teardown,
+        .iterate = pirate_bench_onewire,
+        .counter_names = {"devices_per_second", "slots_per_second", "failed_searches_per_second"},
+        .context = &(PirateBenchOneWireContext){},
+    },
+    {
+        .name = "i2c/eeprom_read_100k",
+        .setup = pirate_bench_i2c_speed_setup,
+        .teardown = pirate_bench_i2c_speed_teardown,
+        .iterate = pirate_bench_i2c_speed,
+        .counter_names = {"bus_bytes_per_second", "transactions_per_second", "probes_per_second"},
+        .context = &(PirateBenchI2cSpeedContext){.command = "[0xA0 0x00 0x00 r:256]"},
+    },
+    {
+        .name = "i2c/eeprom_read_auto",
+        .setup = pirate_bench_i2c_speed_setup,
+        .teardown = pirate_bench_i2c_speed_teardown,
+        .iterate = pirate_bench_i2c_speed,
+        .counter_names = {"bus_bytes_per_second", "transactions_per_second", "probes_per_second"},
+        .context = &(PirateBenchI2cSpeedContext){.command = "@0 [0xA0 0x00 0x00 r:256]"},
+    },
+    {
+        .name = "hexdump/scroll_16",
+        .setup = pirate_bench_hex_dump_setup,
+        .teardown = pirate_bench_hex_dump_teardown,
+        .iterate = pirate_bench_hex_dump,
+        .counter_names = {"frames_per_second", NULL, NULL},
+        .context = &(PirateBenchHexDumpContext){.length = 16},
+    },
+    {
+        .name = "hexdump/scroll_64k",
+        .setup = pirate_bench_hex_dump_setup,
+        .teardown = pirate_bench_hex_dump_teardown,
+        .iterate = pirate_bench_hex_dump,
+        .counter_names = {"frames_per_second", NULL, NULL},
+        .context = &(PirateBenchHexDumpContext){.length = 65536},
+    },
+};
+
+/**
+ * Entry point.
+ */
+
+static void pirate_bench_usage(const char* name) {
+    fprintf(stderr, "usage: %s [-o output.json] [-t seconds] [-n commands] [-s seed]\n", name);
+}
+
+int main(int argc, char** argv) {
+    const char* output_path = NULL;
+    double min_seconds = 0.2;
+    size_t corpus_size = 256;
+    uint32_t seed = 0x50495241;
+    int option;
+
+    while((option = getopt(argc, argv, "o:t:n:s:h")) != -1) {
+        switch(option) {
+        case 'o':
+            output_path = optarg;
+            break;
+        case 't':
+            min_seconds = atof(optarg);
+            break;
+        case 'n':
+            corpus_size = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            pirate_bench_usage(argv[0]);
+            return option == 'h' ? 0 : 1;
+        }
+    }
+    if(!corpus_size || !seed) {
+        pirate_bench_usage(argv[0]);
+        return 1;
+    }
+
+    FILE* output = output_path ? fopen(output_path, "w") : stdout;
+    if(!output) {
+        perror(output_path);
+        return 1;
+    }
+
+    furi_log_set_level(FuriLogLevelNone);
+    furi_hal_mock_i2c_attach_eeprom(0x50, 65536, 2);
+
+    size_t length_count = COUNT_OF(pirate_bench_lengths);
+    size_t corpus_case_count = length_count * COUNT_OF(pirate_bench_corpus_cases);
+    size_t case_count = corpus_case_count + COUNT_OF(pirate_bench_cases);
+    PirateBenchCorpusContext* corpora = calloc(length_count, sizeof(PirateBenchCorpusContext));
+
+    for(size_t i = 0; i < length_count; ++i) {
+        size_t length = pirate_bench_lengths[i];
+        pirate_bench_corpus_init(&corpora[i].corpus, length, corpus_size, seed + length);
+    }
+
+    fprintf(output, "{\n  \"benchmark\": \"pirate\",\n  \"version\": 1,\n");
+    fprintf(output, "  \"seed\": %lu,\n  \"corpus_size\": %zu,\n", (unsigned long)seed, corpus_size);
+    fprintf(output, "  \"results\": [\n");
+
+    // The corpus cases come first, grouped by command length; then everything else.
+    for(size_t i = 0; i < case_count; ++i) {
+        PirateBenchCase bench;
+        PirateBenchResult result;
+        char name[32];
+
+        if(i < corpus_case_count) {
+            size_t corpus = i / COUNT_OF(pirate_bench_corpus_cases);
+
+            bench = pirate_bench_corpus_cases[i % COUNT_OF(pirate_bench_corpus_cases)];
+            snprintf(name, sizeof(name), "%s/%zu", bench.name, pirate_bench_lengths[corpus]);
+            bench.name = name;
+            bench.context = &corpora[corpus];
+        } else {
+            bench = pirate_bench_cases[i - corpus_case_count];
+        }
+
+        fprintf(stderr, "%s...\n", bench.name);
+        pirate_bench_run(&bench, min_seconds, &result);
+        pirate_bench_report(output, &bench, &result, i == case_count - 1);
+    }
+
+    fprintf(output, "  ]\n}\n");
+
+    if(output != stdout) {
+        fclose(output);
+    }
+
+    for(size_t i = 0; i < length_count; ++i) {
+        pirate_bench_corpus_free(&corpora[i].corpus);
+    }
+    free(corpora);
+
+    return 0;
+}
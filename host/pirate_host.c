@@ -0,0 +1,124 @@
+/**
+ * @file pirate_host.c
+ * Runs the pirate app on a workstation, against the stand-ins in mock/.
+ *
+ * Buttons are read from stdin, one character each:
+ *   u d l r  -- directions        o  -- OK          b  -- Back
+ *   U D L R  -- held directions   O  -- long OK     B  -- long Back
+ *   p        -- print the screen
+ * Everything else is ignored, so key sequences can be piped in from a file.
+ *
+ * A simulated 24C512 EEPROM answers at 0x50 (0xA0 in the app's 8-bit notation); and a simulated
+ * 8 Mbit SPI flash sits on the external SPI bus, reporting JEDEC ID EF 40 14.
+ * The file browser picks $PIRATE_HOST_SCRIPT, if it's set; e.g. /ext/apps_data/pirate/init.pirate.
+ *
+ * If $PIRATE_HOST_CDC_PTY is set, the second USB CDC interface -- the one the UART bridge and the
+ * Bus Pirate binary mode use -- is plugged into a pseudo-terminal, and that path is linked to it;
+ * so host tools can be pointed at it, e.g. flashrom -p buspirate_spi:dev=/tmp/pirate.
+ */
+
+#include <furi.h>
+#include <furi_hal.h>
+#include <hal_mock.h>
+#include <gui/canvas_i.h>
+
+#include <ctype.h>
+#include <unistd.h>
+
+#include "../pirate_app.h"
+
+/** Time we give the app to react to a button, before we'd draw the result. */
+#define PIRATE_HOST_SETTLE_MS 20
+
+PirateApp* alloc_pirate_app();
+void free_pirate_app(PirateApp* app);
+
+/** Prints the current view as text, two pixel rows to a line. */
+static void pirate_host_print_screen(PirateApp* app) {
+    static const char* const cells[] = {" ", "▀", "▄", "█"};
+    View* view = view_dispatcher_get_current_view(app->view_dispatcher);
+    Canvas* canvas = canvas_alloc();
+
+    if(view) {
+        view_draw(view, canvas);
+    }
+
+    const uint8_t* buffer = canvas_get_buffer(canvas);
+    for(int y = 0; y < CANVAS_HEIGHT; y += 2) {
+        for(int x = 0; x < CANVAS_WIDTH; ++x) {
+            bool top = buffer[y * (CANVAS_WIDTH / 8) + x / 8] & (1 << (x % 8));
+            bool bottom = buffer[(y + 1) * (CANVAS_WIDTH / 8) + x / 8] & (1 << (x % 8));
+            fputs(cells[top | (bottom << 1)], stdout);
+        }
+        fputc('\n', stdout);
+    }
+    fflush(stdout);
+
+    canvas_free(canvas);
+}
+
+static bool pirate_host_key_for(char character, InputEvent* event) {
+    static const char keys[] = "udlrob";
+
+    const char* key = strchr(keys, tolower(character));
+    if(!key || !character) {
+        return false;
+    }
+
+    event->key = (InputKey[]){
+        InputKeyUp, InputKeyDown, InputKeyLeft, InputKeyRight, InputKeyOk, InputKeyBack}[key - keys];
+    event->type = isupper(character) ? InputTypeLong : InputTypeShort;
+    return true;
+}
+
+/** Feeds stdin to the app as button presses, until we run out. */
+static int32_t pirate_host_input_worker(void* context) {
+    PirateApp* app = context;
+    InputEvent event = {0};
+    int character;
+
+    while((character = getchar()) != EOF) {
+        if(character == 'p') {
+            furi_delay_ms(PIRATE_HOST_SETTLE_MS);
+            pirate_host_print_screen(app);
+        } else if(pirate_host_key_for(character, &event)) {
+            event.sequence += 1;
+            view_dispatcher_send_input(app->view_dispatcher, &event);
+            furi_delay_ms(PIRATE_HOST_SETTLE_MS);
+        }
+    }
+
+    view_dispatcher_stop(app->view_dispatcher);
+    return 0;
+}
+
+int main(void) {
+    furi_log_set_level(getenv("PIRATE_HOST_DEBUG") ? FuriLogLevelDebug : FuriLogLevelWarn);
+    furi_hal_mock_i2c_attach_eeprom(0x50, 65536, 2);
+    furi_hal_mock_i2c_set_max_speed(0x50, 400);
+    furi_hal_mock_spi_attach_flash(1 << 20);
+
+    const char* link = getenv("PIRATE_HOST_CDC_PTY");
+    if(link) {
+        const char* path = furi_hal_mock_cdc_open_pty(PIRATE_BBIO_CDC_INTERFACE);
+
+        unlink(link);
+        if(!path || symlink(path, link)) {
+            fprintf(stderr, "couldn't make a terminal for USB at %s\n", link);
+            return 1;
+        }
+        fprintf(stderr, "USB CDC interface %d is %s, linked from %s\n", PIRATE_BBIO_CDC_INTERFACE, path, link);
+    }
+
+    PirateApp* app = alloc_pirate_app();
+    FuriThread* input = furi_thread_alloc_ex("HostInput", 0, pirate_host_input_worker, app);
+
+    scene_manager_next_scene(app->scene_manager, PirateSceneStart);
+    furi_thread_start(input);
+    view_dispatcher_run(app->view_dispatcher);
+
+    // If the app exited on its own, stdin may still be open; don't wait on it.
+    fclose(stdin);
+    free_pirate_app(app);
+    return 0;
+}
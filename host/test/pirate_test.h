@@ -0,0 +1,128 @@
+/**
+ * @file pirate_test.h
+ * Just enough harness for the host tests.
+ *
+ * Each test file builds into its own program. Its tests are plain functions, run from main()
+ * with PIRATE_TEST_RUN(); a failed check says where it was and what it saw, and the test
+ * carries on, so one run shows everything that's wrong. main() returns pirate_test_finish(),
+ * which is non-zero if anything failed; and so fails the build.
+ */
+
+#pragma once
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char* pirate_test_name;
+static unsigned pirate_test_failed_checks;
+static unsigned pirate_test_count;
+static unsigned pirate_test_failed_tests;
+
+/** Records a check; printing where it was, and why, if it failed. Returns whether it passed. */
+static inline bool __attribute__((format(printf, 4, 5)))
+    pirate_test_check(bool passed, const char* file, int line, const char* format, ...) {
+    va_list arguments;
+
+    if(passed) {
+        return true;
+    }
+
+    fprintf(stderr, "%s:%d: %s: ", file, line, pirate_test_name);
+    va_start(arguments, format);
+    vfprintf(stderr, format, arguments);
+    va_end(arguments);
+    fputc('\n', stderr);
+
+    pirate_test_failed_checks += 1;
+    return false;
+}
+
+/** Prints a run of bytes in hex, for a failed check to show what it saw. */
+static inline void pirate_test_print_bytes(const char* label, const uint8_t* bytes, size_t length) {
+    fprintf(stderr, "    %s:", label);
+    for(size_t i = 0; i < length; ++i) {
+        fprintf(stderr, " %02X", bytes[i]);
+    }
+    fputc('\n', stderr);
+}
+
+static inline bool pirate_test_check_bytes(
+    const char* file,
+    int line,
+    const char* expression,
+    const uint8_t* actual,
+    size_t actual_length,
+    const uint8_t* expected,
+    size_t expected_length) {
+    bool passed = (actual_length == expected_length) &&
+                  (memcmp(actual, expected, expected_length) == 0);
+
+    if(!pirate_test_check(passed, file, line, "%s isn't what was expected", expression)) {
+        pirate_test_print_bytes("expected", expected, expected_length);
+        pirate_test_print_bytes("actual  ", actual, actual_length);
+    }
+    return passed;
+}
+
+#define PIRATE_CHECK(condition) \
+    pirate_test_check((condition), __FILE__, __LINE__, "expected %s", #condition)
+
+#define PIRATE_CHECK_EQUAL(actual, expected)                           \
+    do {                                                               \
+        long long _actual = (long long)(actual);                       \
+        long long _expected = (long long)(expected);                   \
+        pirate_test_check(                                             \
+            _actual == _expected,                                      \
+            __FILE__,                                                  \
+            __LINE__,                                                  \
+            "%s is %lld; expected %s, %lld",                           \
+            #actual,                                                   \
+            _actual,                                                   \
+            #expected,                                                 \
+            _expected);                                                \
+    } while(0)
+
+#define PIRATE_CHECK_STRING(actual, expected)                  \
+    do {                                                       \
+        const char* _actual = (actual);                        \
+        const char* _expected = (expected);                    \
+        pirate_test_check(                                     \
+            strcmp(_actual, _expected) == 0,                   \
+            __FILE__,                                          \
+            __LINE__,                                          \
+            "%s is\n    \"%s\"\n  expected\n    \"%s\"",       \
+            #actual,                                           \
+            _actual,                                           \
+            _expected);                                        \
+    } while(0)
+
+#define PIRATE_CHECK_BYTES(actual, actual_length, expected, expected_length) \
+    pirate_test_check_bytes(                                                 \
+        __FILE__, __LINE__, #actual, (actual), (actual_length), (expected), (expected_length))
+
+/** Runs a single test function, and reports how it went. */
+#define PIRATE_TEST_RUN(test)                                          \
+    do {                                                               \
+        unsigned _failed = pirate_test_failed_checks;                  \
+        pirate_test_name = #test;                                      \
+        test();                                                        \
+        bool _passed = (pirate_test_failed_checks == _failed);         \
+        pirate_test_count += 1;                                        \
+        pirate_test_failed_tests += _passed ? 0 : 1;                   \
+        fprintf(stderr, "%s %s\n", _passed ? "ok  " : "FAIL", #test); \
+    } while(0)
+
+/** Prints a summary of every test run; returns the program's exit status. */
+static inline int pirate_test_finish(const char* suite) {
+    fprintf(
+        stderr,
+        "%s: %u of %u tests passed\n",
+        suite,
+        pirate_test_count - pirate_test_failed_tests,
+        pirate_test_count);
+    return pirate_test_failed_tests ? 1 : 0;
+}
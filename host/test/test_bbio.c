@@ -0,0 +1,239 @@
+/**
+ * @file test_bbio.c
+ * Tests for the binary mode: what a host sees come back over USB for each command, in each mode,
+ * from a simulated flash on SPI and a simulated EEPROM on I2C.
+ */
+
+#include <furi.h>
+#include <hal_mock.h>
+
+#include "../../pirate_bbio.h"
+
+#include "pirate_test.h"
+
+#define TEST_BBIO_EVENT 1
+
+/** The most any test waits to hear back; more than enough for the largest read. */
+#define TEST_BBIO_ANSWER_MAX (1 + PIRATE_BBIO_TRANSFER_SIZE)
+
+typedef struct {
+    ViewDispatcher* view_dispatcher;
+    PirateBbio* bbio;
+
+    /** What's come back since the last command; filled on the protocol's thread. */
+    uint8_t answer[TEST_BBIO_ANSWER_MAX];
+    volatile size_t received;
+    volatile size_t expected;
+    FuriSemaphore* answered;
+} TestBbio;
+
+static bool test_bbio_event(void* context, uint32_t event) {
+    UNUSED(context);
+    UNUSED(event);
+    return true;
+}
+
+static void test_bbio_host(void* context, const uint8_t* data, size_t length) {
+    TestBbio* test = context;
+
+    for(size_t i = 0; i < length; ++i) {
+        if(test->received < sizeof(test->answer)) {
+            test->answer[test->received] = data[i];
+        }
+        test->received += 1;
+    }
+
+    if(test->expected && (test->received >= test->expected)) {
+        test->expected = 0;
+        furi_semaphore_release(test->answered);
+    }
+}
+
+static void test_bbio_start(TestBbio* test) {
+    memset(test, 0, sizeof(*test));
+
+    test->view_dispatcher = view_dispatcher_alloc();
+    view_dispatcher_enable_queue(test->view_dispatcher);
+    view_dispatcher_set_event_callback_context(test->view_dispatcher, test);
+    view_dispatcher_set_custom_event_callback(test->view_dispatcher, test_bbio_event);
+    test->answered = furi_semaphore_alloc(1, 0);
+
+    test->bbio = pirate_bbio_alloc(test->view_dispatcher, TEST_BBIO_EVENT);
+    furi_check(pirate_bbio_start(test->bbio));
+    furi_hal_mock_cdc_connect(PIRATE_BBIO_CDC_INTERFACE, test_bbio_host, test);
+}
+
+static void test_bbio_stop(TestBbio* test) {
+    furi_hal_mock_cdc_disconnect(PIRATE_BBIO_CDC_INTERFACE);
+    pirate_bbio_free(test->bbio);
+
+    furi_semaphore_free(test->answered);
+    view_dispatcher_free(test->view_dispatcher);
+}
+
+/**
+ * Sends a command, and waits for the given number of bytes to come back. Returns how many did;
+ * fewer if it timed out, or more if the answer was longer than expected.
+ */
+static size_t test_bbio_command(TestBbio* test, const void* command, size_t length, size_t answer) {
+    test->received = 0;
+    test->expected = answer;
+    furi_check(furi_hal_mock_cdc_host_send(PIRATE_BBIO_CDC_INTERFACE, command, length, 1000) == length);
+
+    furi_semaphore_acquire(test->answered, 1000);
+    test->expected = 0;
+
+    // Anything more than expected would arrive right behind what was.
+    furi_delay_ms(10);
+    return test->received;
+}
+
+/** Sends a command, given as TEST_BBIO_BYTES(), and checks what comes back is exactly the rest. */
+#define TEST_BBIO_CHECK_ANSWER(test, command, ...)                                     \
+    do {                                                                               \
+        const uint8_t _command[] = command;                                            \
+        const uint8_t _expected[] = {__VA_ARGS__};                                     \
+        size_t _received =                                                             \
+            test_bbio_command((test), _command, sizeof(_command), sizeof(_expected));  \
+        PIRATE_CHECK_BYTES((test)->answer, _received, _expected, sizeof(_expected));   \
+    } while(0)
+
+#define TEST_BBIO_BYTES(...) {__VA_ARGS__}
+
+/** Twenty zeroes into binary mode, as every host starts. */
+static void test_bbio_enter(TestBbio* test) {
+    static const uint8_t zeroes[20] = {0};
+
+    PIRATE_CHECK_EQUAL(test_bbio_command(test, zeroes, sizeof(zeroes), 5), 5);
+    PIRATE_CHECK_BYTES(test->answer, 5, (const uint8_t*)"BBIO1", 5);
+}
+
+static void test_bbio_modes(void) {
+    static const char banner[] = "\x01\r\nBus Pirate v3.5\r\nFirmware v7.0 (Flipper Pirate)\r\nHiZ>";
+    TestBbio test;
+
+    test_bbio_start(&test);
+
+    // Short of twenty zeroes, we're still at the terminal; and it says nothing. The rest,
+    // however they're split, get us in.
+    static const uint8_t zeroes[20] = {0};
+    PIRATE_CHECK_EQUAL(test_bbio_command(&test, zeroes, 3, 1), 0);
+    PIRATE_CHECK_EQUAL(test_bbio_command(&test, zeroes, 17, 5), 5);
+    PIRATE_CHECK_BYTES(test.answer, 5, (const uint8_t*)"BBIO1", 5);
+
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x00), 'B', 'B', 'I', 'O', '1');
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x01), 'S', 'P', 'I', '1');
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x00), 'B', 'B', 'I', 'O', '1');
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x02), 'I', '2', 'C', '1');
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x01), 'I', '2', 'C', '1');
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x00), 'B', 'B', 'I', 'O', '1');
+
+    // Modes we don't have are refused.
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x03), 0x00);
+
+    // Back out to the terminal, with the version banner; and from there, back in.
+    size_t received = test_bbio_command(&test, (const uint8_t[]){0x0F}, 1, sizeof(banner) - 1);
+    PIRATE_CHECK_BYTES(test.answer, received, (const uint8_t*)banner, sizeof(banner) - 1);
+    test_bbio_enter(&test);
+
+    test_bbio_stop(&test);
+}
+
+static void test_bbio_spi(void) {
+    TestBbio test;
+
+    furi_hal_mock_spi_attach_flash(1 << 20);
+    test_bbio_start(&test);
+    test_bbio_enter(&test);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x01), 'S', 'P', 'I', '1');
+
+    // Speed, and the configuration; each acknowledged. The two slowest speeds we can't do.
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x67), 0x01);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x8A), 0x01);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x60), 0x00);
+
+    // The flash's ID, by write-then-read with chip select; and again byte by byte, selecting by hand.
+    TEST_BBIO_CHECK_ANSWER(
+        &test, TEST_BBIO_BYTES(0x04, 0x00, 0x01, 0x00, 0x03, 0x9F), 0x01, 0xEF, 0x40, 0x14);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x02), 0x01);
+    TEST_BBIO_CHECK_ANSWER(
+        &test, TEST_BBIO_BYTES(0x13, 0x9F, 0x00, 0x00, 0x00), 0x01, 0xFF, 0xEF, 0x40, 0x14);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x03), 0x01);
+
+    // The largest read there is, from the middle of the array.
+    static const uint8_t read[] = {0x04, 0x00, 0x04, 0x10, 0x00, 0x03, 0x01, 0x23, 0x45};
+    uint8_t expected[TEST_BBIO_ANSWER_MAX];
+
+    expected[0] = 0x01;
+    for(size_t i = 0; i < PIRATE_BBIO_TRANSFER_SIZE; ++i) {
+        expected[1 + i] = furi_hal_mock_eeprom_byte(0x012345 + i);
+    }
+    size_t received = test_bbio_command(&test, read, sizeof(read), sizeof(expected));
+    PIRATE_CHECK_BYTES(test.answer, received, expected, sizeof(expected));
+
+    // Asking for more than that is refused before any of the data's taken.
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x04, 0x00, 0x01, 0x10, 0x01), 0x00);
+
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x00), 'B', 'B', 'I', 'O', '1');
+    test_bbio_stop(&test);
+}
+
+static void test_bbio_i2c(void) {
+    TestBbio test;
+
+    furi_hal_mock_i2c_attach_eeprom(0x50, 65536, 2);
+    test_bbio_start(&test);
+    test_bbio_enter(&test);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x02), 'I', '2', 'C', '1');
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x63), 0x01);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x64), 0x00);
+
+    // Write-then-read: the address goes out among the written bytes. The first sets the EEPROM's
+    // word address, and reads nothing; the second reads on from there.
+    TEST_BBIO_CHECK_ANSWER(
+        &test,
+        TEST_BBIO_BYTES(0x08, 0x00, 0x03, 0x00, 0x00, 0xA0, 0x00, 0x10),
+        0x01);
+    TEST_BBIO_CHECK_ANSWER(
+        &test,
+        TEST_BBIO_BYTES(0x08, 0x00, 0x01, 0x00, 0x04, 0xA1),
+        0x01,
+        furi_hal_mock_eeprom_byte(0x10),
+        furi_hal_mock_eeprom_byte(0x11),
+        furi_hal_mock_eeprom_byte(0x12),
+        furi_hal_mock_eeprom_byte(0x13));
+
+    // Nothing answers at 0x51; a NACK is answered 0x00, with nothing read.
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x08, 0x00, 0x01, 0x00, 0x04, 0xA3), 0x00);
+
+    // The same by hand: start, a bulk write answered with each byte's ACK, a read, and stop.
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x02), 0x01);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x12, 0xA0, 0x00, 0x20), 0x01, 0x00, 0x00, 0x00);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x02), 0x01);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x10, 0xA3), 0x01, 0x01);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x03), 0x01);
+
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x02), 0x01);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x10, 0xA1), 0x01, 0x00);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x04), furi_hal_mock_eeprom_byte(0x20));
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x07), 0x01);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x03), 0x01);
+
+    // Commands the mode doesn't have.
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x05), 0x00);
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0xF0), 0x00);
+
+    TEST_BBIO_CHECK_ANSWER(&test, TEST_BBIO_BYTES(0x00), 'B', 'B', 'I', 'O', '1');
+    test_bbio_stop(&test);
+    furi_hal_mock_i2c_detach(0x50);
+}
+
+int main(void) {
+    furi_log_set_level(FuriLogLevelNone);
+
+    PIRATE_TEST_RUN(test_bbio_modes);
+    PIRATE_TEST_RUN(test_bbio_spi);
+    PIRATE_TEST_RUN(test_bbio_i2c);
+
+    return pirate_test_finish("bbio");
+}
@@ -0,0 +1,210 @@
+/**
+ * @file test_engine.c
+ * Tests for the engine: commands as long as the editor takes, split into a batch of programs,
+ * and run through the engine thread against a simulated device on I2C.
+ */
+
+#include <furi.h>
+#include <hal_mock.h>
+
+#include "../../pirate_app.h"
+#include "../../pirate_engine.h"
+
+#include "pirate_test.h"
+
+#define TEST_ENGINE_EVENT 1
+
+/** Room for a result store and an engine; as the benchmarks give them. */
+#define TEST_ENGINE_ARENA_SIZE 8192
+
+typedef struct {
+    PirateArena arena;
+    uint8_t arena_storage[TEST_ENGINE_ARENA_SIZE];
+
+    ViewDispatcher* view_dispatcher;
+    PirateResultStore* results;
+    PirateEngine* engine;
+    volatile bool complete;
+} TestEngine;
+
+/** A device at 0x50 with a byte pointer: the first byte written sets it, and the rest are stored. */
+typedef struct {
+    uint8_t memory[256];
+    uint8_t pointer;
+    bool addressed;
+    uint32_t transactions;
+} TestEngineDevice;
+
+static bool test_engine_event(void* context, uint32_t event) {
+    TestEngine* test = context;
+
+    test->complete = (event == TEST_ENGINE_EVENT);
+    return true;
+}
+
+static bool test_engine_device_start(void* context, bool read) {
+    TestEngineDevice* device = context;
+
+    device->addressed = read;
+    device->transactions += 1;
+    return true;
+}
+
+static bool test_engine_device_write(void* context, uint8_t data) {
+    TestEngineDevice* device = context;
+
+    if(!device->addressed) {
+        device->pointer = data;
+        device->addressed = true;
+    } else {
+        device->memory[device->pointer++] = data;
+    }
+    return true;
+}
+
+static void test_engine_setup(TestEngine* test, TestEngineDevice* device) {
+    const FuriHalMockI2cDevice hooks = {
+        .start = test_engine_device_start,
+        .write = test_engine_device_write,
+        .context = device,
+    };
+
+    memset(device, 0, sizeof(*device));
+    furi_hal_mock_i2c_attach(0x50, &hooks);
+
+    test->view_dispatcher = view_dispatcher_alloc();
+    view_dispatcher_enable_queue(test->view_dispatcher);
+    view_dispatcher_set_event_callback_context(test->view_dispatcher, test);
+    view_dispatcher_set_custom_event_callback(test->view_dispatcher, test_engine_event);
+
+    pirate_arena_init(&test->arena, test->arena_storage, sizeof(test->arena_storage));
+    test->results = pirate_result_store_alloc(&test->arena);
+    test->engine =
+        pirate_engine_alloc(test->view_dispatcher, TEST_ENGINE_EVENT, test->results, &test->arena);
+    pirate_engine_set_bus(test->engine, PirateEngineBusI2c);
+}
+
+static void test_engine_teardown(TestEngine* test) {
+    pirate_engine_free(test->engine);
+    pirate_result_store_free(test->results);
+    view_dispatcher_free(test->view_dispatcher);
+    furi_hal_mock_i2c_detach(0x50);
+}
+
+/** Runs whatever's queued, and waits for it to finish. */
+static void test_engine_run_queue(TestEngine* test, PirateEngineResult* result) {
+    test->complete = false;
+    if(!PIRATE_CHECK(pirate_engine_run_queue(test->engine))) {
+        return;
+    }
+
+    while(!test->complete) {
+        view_dispatcher_process_queue(test->view_dispatcher);
+    }
+    pirate_engine_get_result(test->engine, result);
+}
+
+/** Fills a command buffer, to the last character, with copies of a transaction. */
+static size_t test_engine_fill(char* command, const char* format) {
+    size_t length = 0;
+
+    for(uint32_t i = 0; length < PIRATE_COMMAND_MAX_LENGTH; ++i) {
+        char transaction[32];
+        int count = snprintf(transaction, sizeof(transaction), format, (unsigned)(i & 0xFF));
+
+        // Whatever won't fit whole is left as spaces.
+        if(length + count > PIRATE_COMMAND_MAX_LENGTH) {
+            memset(&command[length], ' ', PIRATE_COMMAND_MAX_LENGTH - length);
+            length = PIRATE_COMMAND_MAX_LENGTH;
+            break;
+        }
+        memcpy(&command[length], transaction, count);
+        length += count;
+        if(length < PIRATE_COMMAND_MAX_LENGTH) {
+            command[length++] = ' ';
+        }
+    }
+
+    command[length] = 0;
+    return length;
+}
+
+static void test_engine_long_command(void) {
+    static char command[PIRATE_COMMAND_MAX_LENGTH + 1];
+    TestEngineDevice device;
+    TestEngine test;
+    PirateEngineResult result;
+    PirateProgram program;
+    PirateError error;
+    size_t error_offset = 0;
+
+    test_engine_setup(&test, &device);
+    test_engine_fill(command, "[0xA0 0x%02X 0x12]");
+    PIRATE_CHECK_EQUAL(strlen(command), PIRATE_COMMAND_MAX_LENGTH);
+
+    // Far too long for one program; but it goes in as several, and runs as if it were one.
+    PIRATE_CHECK_EQUAL(
+        pirate_compile(command, strlen(command), &program, NULL), PirateErrorProgramTooLong);
+    if(PIRATE_CHECK(pirate_engine_queue_long(test.engine, command, &error, &error_offset))) {
+        PIRATE_CHECK(pirate_engine_queue_length(test.engine) > 1);
+
+        test_engine_run_queue(&test, &result);
+        PIRATE_CHECK_EQUAL(result.status, PirateExecOk);
+        PIRATE_CHECK_EQUAL(result.commands, result.batch_length);
+        PIRATE_CHECK_EQUAL(result.transactions, 241);
+        PIRATE_CHECK_EQUAL(result.bytes_written, 241 * 3);
+    }
+
+    // Every transaction reached the device; the last one's the 241st, at 0xF0.
+    PIRATE_CHECK_EQUAL(device.transactions, 241);
+    for(uint32_t i = 0; i <= 0xF0; ++i) {
+        if(device.memory[i] != 0x12) {
+            PIRATE_CHECK_EQUAL(device.memory[i], 0x12);
+            break;
+        }
+    }
+    PIRATE_CHECK_EQUAL(device.memory[0xF1], 0);
+
+    test_engine_teardown(&test);
+}
+
+static void test_engine_long_command_errors(void) {
+    static char command[PIRATE_COMMAND_MAX_LENGTH + 1];
+    TestEngineDevice device;
+    TestEngine test;
+    PirateProgram program;
+    PirateError error;
+    size_t error_offset = 0;
+
+    test_engine_setup(&test, &device);
+    pirate_compile("[0xA0]", 6, &program, NULL);
+    PIRATE_CHECK(pirate_engine_queue(test.engine, &program));
+
+    // Reads take more program than writes; this many don't fit in the batch. Nothing's
+    // added, and the error's where the batch ran out.
+    test_engine_fill(command, "[0xA1 r]");
+    PIRATE_CHECK(!pirate_engine_queue_long(test.engine, command, &error, &error_offset));
+    PIRATE_CHECK_EQUAL(error, PirateErrorProgramTooLong);
+    PIRATE_CHECK(error_offset > 0);
+    PIRATE_CHECK(command[error_offset - 1] == ']');
+    PIRATE_CHECK_EQUAL(pirate_engine_queue_length(test.engine), 1);
+
+    // A mistake anywhere in the command keeps all of it out; its offset is into the whole text.
+    test_engine_fill(command, "[0xA0 0x%02X 0x12]");
+    command[3008] = '}';
+    PIRATE_CHECK(!pirate_engine_queue_long(test.engine, command, &error, &error_offset));
+    PIRATE_CHECK_EQUAL(error, PirateErrorUnbalancedLoop);
+    PIRATE_CHECK_EQUAL(error_offset, 3008);
+    PIRATE_CHECK_EQUAL(pirate_engine_queue_length(test.engine), 1);
+
+    test_engine_teardown(&test);
+}
+
+int main(void) {
+    furi_log_set_level(FuriLogLevelNone);
+
+    PIRATE_TEST_RUN(test_engine_long_command);
+    PIRATE_TEST_RUN(test_engine_long_command_errors);
+
+    return pirate_test_finish("engine");
+}
@@ -0,0 +1,164 @@
+/**
+ * @file test_history.c
+ * Tests for the command history: that each entry is read back by its age, through the index,
+ * and that the index survives the history being closed and opened again.
+ */
+
+#include <furi.h>
+#include <storage/storage.h>
+
+#include "../../pirate_history.h"
+
+#include "pirate_test.h"
+
+/** Starts each test with no history on the card. */
+static PirateHistory* test_history_open_empty(void) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_remove(storage, PIRATE_HISTORY_LOG_PATH);
+    storage_simply_remove(storage, PIRATE_HISTORY_INDEX_PATH);
+    furi_record_close(RECORD_STORAGE);
+
+    return pirate_history_alloc();
+}
+
+static void test_history_empty(void) {
+    PirateHistory* history = test_history_open_empty();
+    char buffer[16] = "untouched";
+
+    PIRATE_CHECK_EQUAL(pirate_history_count(history), 0);
+    PIRATE_CHECK(!pirate_history_get(history, 0, buffer, sizeof(buffer)));
+    PIRATE_CHECK_STRING(buffer, "untouched");
+
+    pirate_history_free(history);
+}
+
+static void test_history_ages(void) {
+    PirateHistory* history = test_history_open_empty();
+    char buffer[64];
+
+    PIRATE_CHECK(pirate_history_append(history, "[0xA0 0x00 r:4]"));
+    PIRATE_CHECK(pirate_history_append(history, "[0xA0]"));
+    PIRATE_CHECK(pirate_history_append(history, "{[0xA1 r]}:3"));
+    PIRATE_CHECK_EQUAL(pirate_history_count(history), 3);
+
+    // Age zero is the newest; the oldest is count - 1, and there's nothing beyond it.
+    PIRATE_CHECK(pirate_history_get(history, 0, buffer, sizeof(buffer)));
+    PIRATE_CHECK_STRING(buffer, "{[0xA1 r]}:3");
+    PIRATE_CHECK(pirate_history_get(history, 1, buffer, sizeof(buffer)));
+    PIRATE_CHECK_STRING(buffer, "[0xA0]");
+    PIRATE_CHECK(pirate_history_get(history, 2, buffer, sizeof(buffer)));
+    PIRATE_CHECK_STRING(buffer, "[0xA0 0x00 r:4]");
+    PIRATE_CHECK(!pirate_history_get(history, 3, buffer, sizeof(buffer)));
+
+    // Entries too long for the buffer are cut short; but still terminated.
+    PIRATE_CHECK(pirate_history_get(history, 2, buffer, 6));
+    PIRATE_CHECK_STRING(buffer, "[0xA0");
+
+    pirate_history_free(history);
+}
+
+static void test_history_duplicates(void) {
+    PirateHistory* history = test_history_open_empty();
+    char long_command[300];
+    char buffer[sizeof(long_command)];
+
+    // Running the same command again doesn't fill the history with it; and empty ones aren't kept.
+    PIRATE_CHECK(pirate_history_append(history, "[0xA0]"));
+    PIRATE_CHECK(pirate_history_append(history, "[0xA0]"));
+    PIRATE_CHECK(pirate_history_append(history, ""));
+    PIRATE_CHECK_EQUAL(pirate_history_count(history), 1);
+
+    // A prefix of the latest isn't the latest; nor is something that's only further back.
+    PIRATE_CHECK(pirate_history_append(history, "[0xA"));
+    PIRATE_CHECK(pirate_history_append(history, "[0xA0]"));
+    PIRATE_CHECK_EQUAL(pirate_history_count(history), 3);
+
+    // Commands longer than a compare chunk are matched chunk by chunk, to the last character.
+    memset(long_command, '1', sizeof(long_command) - 1);
+    long_command[sizeof(long_command) - 1] = 0;
+    PIRATE_CHECK(pirate_history_append(history, long_command));
+    PIRATE_CHECK(pirate_history_append(history, long_command));
+    PIRATE_CHECK_EQUAL(pirate_history_count(history), 4);
+
+    long_command[sizeof(long_command) - 2] = '2';
+    PIRATE_CHECK(pirate_history_append(history, long_command));
+    PIRATE_CHECK_EQUAL(pirate_history_count(history), 5);
+
+    PIRATE_CHECK(pirate_history_get(history, 0, buffer, sizeof(buffer)));
+    PIRATE_CHECK_STRING(buffer, long_command);
+    PIRATE_CHECK(pirate_history_get(history, 2, buffer, sizeof(buffer)));
+    PIRATE_CHECK_STRING(buffer, "[0xA0]");
+
+    pirate_history_free(history);
+}
+
+static void test_history_reopen(void) {
+    PirateHistory* history = test_history_open_empty();
+    char buffer[32];
+    char command[32];
+
+    for(uint32_t i = 0; i < 100; ++i) {
+        snprintf(command, sizeof(command), "[0xA0 0x%02lX r:%lu]", (unsigned long)i, (unsigned long)i + 1);
+        pirate_history_append(history, command);
+    }
+    pirate_history_free(history);
+
+    // The count comes from the index's size; and every entry is where the index says.
+    history = pirate_history_alloc();
+    PIRATE_CHECK_EQUAL(pirate_history_count(history), 100);
+    for(uint32_t age = 0; age < 100; ++age) {
+        uint32_t i = 99 - age;
+
+        snprintf(command, sizeof(command), "[0xA0 0x%02lX r:%lu]", (unsigned long)i, (unsigned long)i + 1);
+        PIRATE_CHECK(pirate_history_get(history, age, buffer, sizeof(buffer)));
+        if(strcmp(buffer, command) != 0) {
+            PIRATE_CHECK_STRING(buffer, command);
+            break;
+        }
+    }
+    pirate_history_free(history);
+}
+
+static void test_history_torn_index(void) {
+    PirateHistory* history = test_history_open_empty();
+    char buffer[32];
+
+    pirate_history_append(history, "[0xA0]");
+    pirate_history_append(history, "[0xA2]");
+    pirate_history_free(history);
+
+    // Half of an offset, as a write cut short by pulling the card would leave.
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* index = storage_file_alloc(storage);
+    PIRATE_CHECK(storage_file_open(index, PIRATE_HISTORY_INDEX_PATH, FSAM_WRITE, FSOM_OPEN_APPEND));
+    PIRATE_CHECK_EQUAL(storage_file_write(index, "\x01\x02", 2), 2);
+    storage_file_close(index);
+    storage_file_free(index);
+    furi_record_close(RECORD_STORAGE);
+
+    // It's ignored; and the next entry's offset goes over it.
+    history = pirate_history_alloc();
+    PIRATE_CHECK_EQUAL(pirate_history_count(history), 2);
+    PIRATE_CHECK(pirate_history_append(history, "[0xA4]"));
+    pirate_history_free(history);
+
+    history = pirate_history_alloc();
+    PIRATE_CHECK_EQUAL(pirate_history_count(history), 3);
+    PIRATE_CHECK(pirate_history_get(history, 0, buffer, sizeof(buffer)));
+    PIRATE_CHECK_STRING(buffer, "[0xA4]");
+    PIRATE_CHECK(pirate_history_get(history, 1, buffer, sizeof(buffer)));
+    PIRATE_CHECK_STRING(buffer, "[0xA2]");
+    pirate_history_free(history);
+}
+
+int main(void) {
+    furi_log_set_level(FuriLogLevelNone);
+
+    PIRATE_TEST_RUN(test_history_empty);
+    PIRATE_TEST_RUN(test_history_ages);
+    PIRATE_TEST_RUN(test_history_duplicates);
+    PIRATE_TEST_RUN(test_history_reopen);
+    PIRATE_TEST_RUN(test_history_torn_index);
+
+    return pirate_test_finish("history");
+}
@@ -0,0 +1,221 @@
+/**
+ * @file test_i2c_decoder.c
+ * Tests for the I2C decoder: the events it makes of the samples the sniffer takes, for whole
+ * transactions driven as a controller would drive them.
+ */
+
+#include <furi.h>
+
+#include "../../lib/pirate_i2c_decoder.h"
+
+#include "pirate_test.h"
+
+#define TEST_I2C_DECODER_SAMPLES_MAX 512
+
+/**
+ * A run of samples, as the sniffer would take them off the bus: one for each SDA edge, and one
+ * for each rising edge of SCL. SCL falling isn't sampled; so the lines are tracked here, to know
+ * what the next edge sees.
+ */
+typedef struct {
+    uint8_t samples[TEST_I2C_DECODER_SAMPLES_MAX];
+    size_t length;
+    bool sda;
+} TestI2cDecoderStream;
+
+static void test_i2c_decoder_sample(TestI2cDecoderStream* stream, uint8_t sample) {
+    furi_check(stream->length < TEST_I2C_DECODER_SAMPLES_MAX);
+    stream->samples[stream->length++] = sample;
+}
+
+/** Moves SDA while SCL is low, as a transmitter does between bits. */
+static void test_i2c_decoder_sda(TestI2cDecoderStream* stream, bool sda) {
+    if(sda != stream->sda) {
+        stream->sda = sda;
+        test_i2c_decoder_sample(stream, sda ? PIRATE_I2C_SAMPLE_SDA : 0);
+    }
+}
+
+/** Raises SCL, and lowers it again. */
+static void test_i2c_decoder_clock(TestI2cDecoderStream* stream) {
+    test_i2c_decoder_sample(
+        stream,
+        PIRATE_I2C_SAMPLE_CLOCK | PIRATE_I2C_SAMPLE_SCL | (stream->sda ? PIRATE_I2C_SAMPLE_SDA : 0));
+}
+
+static void test_i2c_decoder_init(TestI2cDecoderStream* stream) {
+    stream->length = 0;
+    stream->sda = true;
+}
+
+/** A start from an idle bus; or, mid-transaction, a repeated start. */
+static void test_i2c_decoder_start(TestI2cDecoderStream* stream, bool repeated) {
+    if(repeated) {
+        test_i2c_decoder_sda(stream, true);
+        test_i2c_decoder_clock(stream);
+    }
+
+    stream->sda = false;
+    test_i2c_decoder_sample(stream, PIRATE_I2C_SAMPLE_SCL);
+}
+
+static void test_i2c_decoder_byte(TestI2cDecoderStream* stream, uint8_t value, bool ack) {
+    for(int bit = 7; bit >= 0; --bit) {
+        test_i2c_decoder_sda(stream, (value >> bit) & 1);
+        test_i2c_decoder_clock(stream);
+    }
+
+    test_i2c_decoder_sda(stream, !ack);
+    test_i2c_decoder_clock(stream);
+}
+
+static void test_i2c_decoder_stop(TestI2cDecoderStream* stream) {
+    test_i2c_decoder_sda(stream, false);
+    test_i2c_decoder_clock(stream);
+
+    stream->sda = true;
+    test_i2c_decoder_sample(stream, PIRATE_I2C_SAMPLE_SCL | PIRATE_I2C_SAMPLE_SDA);
+}
+
+/**
+ * Runs a stream through a fresh decoder, and writes out the events it made: "S" and "Sr" for
+ * starts, "P" for a stop, and each byte in hex with "+" if it was acknowledged or "-" if not;
+ * addresses with an "@" in front.
+ */
+static void test_i2c_decoder_run(const TestI2cDecoderStream* stream, char* transcript, size_t size) {
+    PirateI2cDecoder decoder;
+    PirateI2cEvent event;
+    size_t length = 0;
+
+    transcript[0] = 0;
+    pirate_i2c_decoder_reset(&decoder);
+
+    for(size_t i = 0; i < stream->length; ++i) {
+        if(!pirate_i2c_decoder_feed(&decoder, stream->samples[i], &event)) {
+            continue;
+        }
+
+        const char* separator = length ? " " : "";
+        switch(event.type) {
+        case PirateI2cEventStart:
+            length += snprintf(&transcript[length], size - length, "%sS", separator);
+            break;
+        case PirateI2cEventRestart:
+            length += snprintf(&transcript[length], size - length, "%sSr", separator);
+            break;
+        case PirateI2cEventStop:
+            length += snprintf(&transcript[length], size - length, "%sP", separator);
+            break;
+        case PirateI2cEventAddress:
+        case PirateI2cEventData:
+            length += snprintf(
+                &transcript[length],
+                size - length,
+                "%s%s%02X%c",
+                separator,
+                event.type == PirateI2cEventAddress ? "@" : "",
+                event.value,
+                event.ack ? '+' : '-');
+            break;
+        }
+        furi_check(length < size);
+    }
+}
+
+static void test_i2c_decoder_write(void) {
+    TestI2cDecoderStream stream;
+    char transcript[128];
+
+    test_i2c_decoder_init(&stream);
+    test_i2c_decoder_start(&stream, false);
+    test_i2c_decoder_byte(&stream, 0xA0, true);
+    test_i2c_decoder_byte(&stream, 0x12, true);
+    test_i2c_decoder_byte(&stream, 0xFF, true);
+    test_i2c_decoder_byte(&stream, 0x00, true);
+    test_i2c_decoder_stop(&stream);
+
+    test_i2c_decoder_run(&stream, transcript, sizeof(transcript));
+    PIRATE_CHECK_STRING(transcript, "S @A0+ 12+ FF+ 00+ P");
+}
+
+static void test_i2c_decoder_write_read(void) {
+    TestI2cDecoderStream stream;
+    char transcript[128];
+
+    // Setting a pointer, then reading from it; the controller NAKs the last byte it wants. The
+    // repeated start's SCL rise, with SDA high, is no bit of anything.
+    test_i2c_decoder_init(&stream);
+    test_i2c_decoder_start(&stream, false);
+    test_i2c_decoder_byte(&stream, 0xA0, true);
+    test_i2c_decoder_byte(&stream, 0x40, true);
+    test_i2c_decoder_start(&stream, true);
+    test_i2c_decoder_byte(&stream, 0xA1, true);
+    test_i2c_decoder_byte(&stream, 0x5A, true);
+    test_i2c_decoder_byte(&stream, 0xC3, false);
+    test_i2c_decoder_stop(&stream);
+
+    test_i2c_decoder_run(&stream, transcript, sizeof(transcript));
+    PIRATE_CHECK_STRING(transcript, "S @A0+ 40+ Sr @A1+ 5A+ C3- P");
+}
+
+static void test_i2c_decoder_nak(void) {
+    TestI2cDecoderStream stream;
+    char transcript[128];
+
+    // Nobody at the address: the controller gives up, and the next transaction starts afresh.
+    test_i2c_decoder_init(&stream);
+    test_i2c_decoder_start(&stream, false);
+    test_i2c_decoder_byte(&stream, 0x90, false);
+    test_i2c_decoder_stop(&stream);
+    test_i2c_decoder_start(&stream, false);
+    test_i2c_decoder_byte(&stream, 0xA0, true);
+    test_i2c_decoder_byte(&stream, 0x01, false);
+    test_i2c_decoder_stop(&stream);
+
+    test_i2c_decoder_run(&stream, transcript, sizeof(transcript));
+    PIRATE_CHECK_STRING(transcript, "S @90- P S @A0+ 01- P");
+}
+
+static void test_i2c_decoder_noise(void) {
+    TestI2cDecoderStream stream;
+    char transcript[128];
+
+    // SDA may do what it likes while SCL is low; only where it is when SCL rises counts. The
+    // same goes for an idle bus's clock, with no start to begin a transaction.
+    test_i2c_decoder_init(&stream);
+    test_i2c_decoder_clock(&stream);
+    test_i2c_decoder_start(&stream, false);
+
+    for(int bit = 7; bit >= 0; --bit) {
+        bool level = (0xA5 >> bit) & 1;
+
+        for(int glitch = 0; glitch < 3; ++glitch) {
+            test_i2c_decoder_sda(&stream, !stream.sda);
+        }
+        test_i2c_decoder_sda(&stream, level);
+        test_i2c_decoder_clock(&stream);
+    }
+    test_i2c_decoder_sda(&stream, true);
+    test_i2c_decoder_sda(&stream, false);
+    test_i2c_decoder_clock(&stream);
+
+    test_i2c_decoder_sda(&stream, true);
+    test_i2c_decoder_sda(&stream, false);
+    test_i2c_decoder_byte(&stream, 0x3C, true);
+    test_i2c_decoder_stop(&stream);
+    test_i2c_decoder_clock(&stream);
+
+    test_i2c_decoder_run(&stream, transcript, sizeof(transcript));
+    PIRATE_CHECK_STRING(transcript, "S @A5+ 3C+ P");
+}
+
+int main(void) {
+    furi_log_set_level(FuriLogLevelNone);
+
+    PIRATE_TEST_RUN(test_i2c_decoder_write);
+    PIRATE_TEST_RUN(test_i2c_decoder_write_read);
+    PIRATE_TEST_RUN(test_i2c_decoder_nak);
+    PIRATE_TEST_RUN(test_i2c_decoder_noise);
+
+    return pirate_test_finish("i2c_decoder");
+}
@@ -0,0 +1,338 @@
+/**
+ * @file test_input.c
+ * Tests for the command editor's text and tokens: that edits through the gap buffer leave the
+ * text they should, and that the tokens kept up to date edit by edit are the ones a full
+ * re-tokenize would find.
+ *
+ * Also, that a held key's repeats are gathered up while a frame's pending, and applied in one
+ * update when the key's let go, another's held instead, or the frame's taken too long.
+ *
+ * These reach into the editor's internals; so it's built into this file, rather than linked.
+ */
+
+#include "../../pirate_input.c"
+
+#include "pirate_test.h"
+
+#define TEST_INPUT_MAX_LENGTH 64
+#define TEST_INPUT_EDITS 20000
+
+#define TEST_INPUT_VIEW 0
+#define TEST_INPUT_FRAME_EVENT 1
+
+/** Characters the random edits pick from; enough to make every kind of token, and break them. */
+static const char test_input_alphabet[] = "[]{}r&:@0x1fA5b  ";
+
+static uint32_t test_input_seed;
+
+static uint32_t test_input_random(uint32_t range) {
+    test_input_seed = test_input_seed * 1664525 + 1013904223;
+    return (test_input_seed >> 8) % range;
+}
+
+/** Sets a model up to edit the given buffer, as pirate_input_set_result_callback() would. */
+static void test_input_model_init(PirateInputModel* model, char* chars, uint16_t max_length) {
+    memset(model, 0, sizeof(*model));
+    model->chars = chars;
+    model->char_count = strlen(chars);
+    model->gap_start = model->char_count;
+    model->selected_char = model->char_count;
+    model->max_length = max_length;
+    pirate_input_tokenize_all(model);
+}
+
+/** Checks the model's text, read across the gap, is the given string. */
+static bool test_input_check_text(PirateInputModel* model, const char* expected) {
+    char text[TEST_INPUT_MAX_LENGTH];
+
+    for(uint16_t i = 0; i < model->char_count; ++i) {
+        text[i] = pirate_input_char_at(model, i);
+    }
+    text[model->char_count] = 0;
+
+    PIRATE_CHECK_STRING(text, expected);
+    return strcmp(text, expected) == 0;
+}
+
+/** Checks the model's tokens are those of a fresh model, tokenized from scratch. */
+static bool test_input_check_tokens(PirateInputModel* model) {
+    char text[TEST_INPUT_MAX_LENGTH];
+    PirateInputModel fresh;
+    bool passed;
+
+    for(uint16_t i = 0; i < model->char_count; ++i) {
+        text[i] = pirate_input_char_at(model, i);
+    }
+    text[model->char_count] = 0;
+    test_input_model_init(&fresh, text, sizeof(text));
+
+    passed = PIRATE_CHECK(model->token_count == fresh.token_count);
+    for(uint16_t i = 0; passed && (i < model->token_count); ++i) {
+        const PirateInputToken* actual = &model->tokens[i];
+        const PirateInputToken* expected = &fresh.tokens[i];
+
+        const PirateInputNesting* actual_nesting = &actual->nesting;
+        const PirateInputNesting* expected_nesting = &expected->nesting;
+
+        // Each token's record of the brackets open after it has to be right too; the next edit
+        // stops checking where it finds one unchanged.
+        passed = pirate_test_check(
+            (actual->offset == expected->offset) && (actual->length == expected->length) &&
+                (actual->type == expected->type) && (actual->malformed == expected->malformed) &&
+                (actual->misplaced == expected->misplaced) &&
+                (memcmp(actual_nesting, expected_nesting, sizeof(PirateInputNesting)) == 0),
+            __FILE__,
+            __LINE__,
+            "token %u of \"%s\" is %u+%u type %u%s%s (%d %d %u); expected %u+%u type %u%s%s (%d %d %u)",
+            i,
+            text,
+            actual->offset,
+            actual->length,
+            actual->type,
+            actual->malformed ? " malformed" : "",
+            actual->misplaced ? " misplaced" : "",
+            (int16_t)actual_nesting->open_start,
+            (int16_t)actual_nesting->loop,
+            actual_nesting->loop_depth,
+            expected->offset,
+            expected->length,
+            expected->type,
+            expected->malformed ? " malformed" : "",
+            expected->misplaced ? " misplaced" : "",
+            (int16_t)expected_nesting->open_start,
+            (int16_t)expected_nesting->loop,
+            expected_nesting->loop_depth);
+    }
+
+    free(fresh.tokens);
+    return passed;
+}
+
+static void test_input_gap_edits(void) {
+    char chars[TEST_INPUT_MAX_LENGTH] = "[0xA0 0x00 r:4]";
+    char expected[TEST_INPUT_MAX_LENGTH] = "[0xA0 0x00 r:4]";
+    PirateInputModel model;
+
+    test_input_model_init(&model, chars, sizeof(chars));
+
+    // Insert and delete at the end, in the middle, and at the start; the gap follows the cursor.
+    model.selected_char = 5;
+    priate_input_insert_character(&model, ' ');
+    priate_input_insert_character(&model, '1');
+    memmove(&expected[7], &expected[5], strlen(&expected[5]) + 1);
+    memcpy(&expected[5], " 1", 2);
+    test_input_check_text(&model, expected);
+    PIRATE_CHECK_EQUAL(model.selected_char, 7);
+
+    model.selected_char = 1;
+    pirate_input_backspace(&model);
+    memmove(&expected[0], &expected[1], strlen(expected));
+    test_input_check_text(&model, expected);
+    PIRATE_CHECK_EQUAL(model.selected_char, 0);
+
+    // Nothing before the cursor; nothing to delete.
+    pirate_input_backspace(&model);
+    test_input_check_text(&model, expected);
+
+    model.selected_char = model.char_count;
+    pirate_input_backspace(&model);
+    expected[strlen(expected) - 1] = 0;
+    test_input_check_text(&model, expected);
+
+    // The buffer fills up to one short of its size, leaving room for the terminator.
+    while(model.char_count < sizeof(chars)) {
+        uint16_t count = model.char_count;
+
+        model.selected_char = count / 2;
+        priate_input_insert_character(&model, 'r');
+        if(model.char_count == count) {
+            break;
+        }
+        memmove(&expected[count / 2 + 1], &expected[count / 2], count - count / 2 + 1);
+        expected[count / 2] = 'r';
+    }
+    PIRATE_CHECK_EQUAL(model.char_count, sizeof(chars) - 1);
+    test_input_check_text(&model, expected);
+
+    // Closing the gap leaves the plain string behind.
+    pirate_input_close_gap(&model);
+    PIRATE_CHECK_STRING(chars, expected);
+
+    free(model.tokens);
+}
+
+static void test_input_random_edits(void) {
+    char chars[TEST_INPUT_MAX_LENGTH] = "";
+    char expected[TEST_INPUT_MAX_LENGTH] = "";
+    PirateInputModel model;
+
+    test_input_seed = 1;
+    test_input_model_init(&model, chars, sizeof(chars));
+
+    // Bursts of edits at one place, as the editor makes them, then off to somewhere else.
+    for(uint32_t edit = 0; edit < TEST_INPUT_EDITS; ++edit) {
+        uint16_t count = model.char_count;
+
+        if(test_input_random(8) == 0) {
+            model.selected_char = test_input_random(count + 1);
+            model.first_visible_char = 0;
+        }
+        uint16_t cursor = model.selected_char;
+
+        // Lean towards inserting while the buffer's short; and deleting once it's long.
+        if(test_input_random(TEST_INPUT_MAX_LENGTH) >= count) {
+            char value = test_input_alphabet[test_input_random(sizeof(test_input_alphabet) - 1)];
+
+            priate_input_insert_character(&model, value);
+            if(count + 1u < sizeof(chars)) {
+                memmove(&expected[cursor + 1], &expected[cursor], count - cursor + 1);
+                expected[cursor] = value;
+            }
+        } else {
+            pirate_input_backspace(&model);
+            if(cursor > 0) {
+                memmove(&expected[cursor - 1], &expected[cursor], count - cursor + 1);
+            }
+        }
+
+        if(!test_input_check_text(&model, expected) || !test_input_check_tokens(&model)) {
+            fprintf(stderr, "    after edit %lu\n", (unsigned long)edit);
+            break;
+        }
+    }
+
+    free(model.tokens);
+}
+
+static void test_input_tokens(void) {
+    char chars[TEST_INPUT_MAX_LENGTH] = "[0xA0 0x00 r:4]";
+    PirateInputModel model;
+
+    test_input_model_init(&model, chars, sizeof(chars));
+
+    // Joining two tokens into one, and splitting them again.
+    PIRATE_CHECK_EQUAL(model.token_count, 6);
+    model.selected_char = 6;
+    pirate_input_backspace(&model);
+    PIRATE_CHECK_EQUAL(model.token_count, 5);
+    PIRATE_CHECK(model.tokens[1].malformed);
+    test_input_check_tokens(&model);
+
+    priate_input_insert_character(&model, ' ');
+    PIRATE_CHECK_EQUAL(model.token_count, 6);
+    PIRATE_CHECK(!model.tokens[1].malformed);
+    test_input_check_tokens(&model);
+
+    // Taking away the ']' leaves the '[' unclosed; putting it back closes it.
+    model.selected_char = model.char_count;
+    pirate_input_backspace(&model);
+    PIRATE_CHECK(model.tokens[0].misplaced);
+    test_input_check_tokens(&model);
+
+    priate_input_insert_character(&model, ']');
+    PIRATE_CHECK(!model.tokens[0].misplaced);
+    test_input_check_tokens(&model);
+
+    free(model.tokens);
+}
+
+static void test_input_press(PirateInput* input, InputKey key, InputType type) {
+    InputEvent event = {.key = key, .type = type};
+    view_input(pirate_input_get_view(input), &event);
+}
+
+static uint16_t test_input_cursor(PirateInput* input) {
+    uint16_t cursor = 0;
+
+    with_view_model(
+        pirate_input_get_view(input), PirateInputModel * model, {
+            cursor = model->selected_char;
+        }, false);
+    return cursor;
+}
+
+static void test_input_repeats(void) {
+    char chars[TEST_INPUT_MAX_LENGTH] = "[0xA0 0x00 r:4]";
+    PirateInput* input = pirate_input_alloc();
+    View* view = pirate_input_get_view(input);
+    Canvas* canvas = canvas_alloc();
+
+    // Shown by a dispatcher, as in the app; the draw posts to it.
+    ViewDispatcher* view_dispatcher = view_dispatcher_alloc();
+    view_dispatcher_enable_queue(view_dispatcher);
+    view_dispatcher_add_view(view_dispatcher, TEST_INPUT_VIEW, view);
+    view_dispatcher_switch_to_view(view_dispatcher, TEST_INPUT_VIEW);
+    pirate_input_set_frame_event(input, view_dispatcher, TEST_INPUT_FRAME_EVENT);
+
+    pirate_input_set_result_callback(input, NULL, NULL, NULL, chars, sizeof(chars) - 1);
+    test_input_press(input, InputKeyUp, InputTypeShort);
+    view_draw(view, canvas);
+
+    uint16_t cursor = test_input_cursor(input);
+    uint32_t updates = view_get_update_count(view);
+
+    // With nothing waiting to be drawn, a repeat is applied straight away...
+    test_input_press(input, InputKeyLeft, InputTypeRepeat);
+    PIRATE_CHECK_EQUAL(test_input_cursor(input), cursor - 1);
+    PIRATE_CHECK_EQUAL(view_get_update_count(view), updates + 1);
+
+    // ... but while its frame's pending, the next are held back; until the key's released.
+    test_input_press(input, InputKeyLeft, InputTypeRepeat);
+    test_input_press(input, InputKeyLeft, InputTypeRepeat);
+    test_input_press(input, InputKeyLeft, InputTypeRepeat);
+    PIRATE_CHECK_EQUAL(test_input_cursor(input), cursor - 1);
+    PIRATE_CHECK_EQUAL(view_get_update_count(view), updates + 1);
+
+    test_input_press(input, InputKeyLeft, InputTypeRelease);
+    PIRATE_CHECK_EQUAL(test_input_cursor(input), cursor - 4);
+    PIRATE_CHECK_EQUAL(view_get_update_count(view), updates + 2);
+
+    // Holding a different key applies the last one's first; so keys still land in order.
+    test_input_press(input, InputKeyRight, InputTypeRepeat);
+    test_input_press(input, InputKeyRight, InputTypeRepeat);
+    PIRATE_CHECK_EQUAL(view_get_update_count(view), updates + 2);
+
+    test_input_press(input, InputKeyLeft, InputTypeRepeat);
+    PIRATE_CHECK_EQUAL(test_input_cursor(input), cursor - 2);
+    PIRATE_CHECK_EQUAL(view_get_update_count(view), updates + 3);
+
+    // A frame that never comes only holds repeats back for so long.
+    input->frame_requested -= furi_ms_to_ticks(PIRATE_INPUT_FRAME_TIMEOUT_MS);
+    test_input_press(input, InputKeyLeft, InputTypeRepeat);
+    PIRATE_CHECK_EQUAL(test_input_cursor(input), cursor - 4);
+    PIRATE_CHECK_EQUAL(view_get_update_count(view), updates + 4);
+
+    // Drawing the frame is enough to have what was held back for it applied; no further key
+    // needed. That's done on the input thread, once the draw's word of it arrives.
+    test_input_press(input, InputKeyLeft, InputTypeRepeat);
+    PIRATE_CHECK_EQUAL(test_input_cursor(input), cursor - 4);
+    view_draw(view, canvas);
+    PIRATE_CHECK_EQUAL(test_input_cursor(input), cursor - 4);
+    PIRATE_CHECK_EQUAL(view_dispatcher_process_queue(view_dispatcher), 1);
+    PIRATE_CHECK_EQUAL(test_input_cursor(input), cursor - 5);
+    PIRATE_CHECK_EQUAL(view_get_update_count(view), updates + 5);
+
+    // Once that frame's drawn too, with nothing held back, the next repeat goes straight through.
+    view_draw(view, canvas);
+    view_dispatcher_process_queue(view_dispatcher);
+    PIRATE_CHECK_EQUAL(view_get_update_count(view), updates + 5);
+    test_input_press(input, InputKeyLeft, InputTypeRepeat);
+    PIRATE_CHECK_EQUAL(test_input_cursor(input), cursor - 6);
+    PIRATE_CHECK_EQUAL(view_get_update_count(view), updates + 6);
+
+    view_dispatcher_remove_view(view_dispatcher, TEST_INPUT_VIEW);
+    view_dispatcher_free(view_dispatcher);
+    canvas_free(canvas);
+    pirate_input_free(input);
+}
+
+int main(void) {
+    furi_log_set_level(FuriLogLevelNone);
+
+    PIRATE_TEST_RUN(test_input_gap_edits);
+    PIRATE_TEST_RUN(test_input_tokens);
+    PIRATE_TEST_RUN(test_input_random_edits);
+    PIRATE_TEST_RUN(test_input_repeats);
+
+    return pirate_test_finish("input");
+}
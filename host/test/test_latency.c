@@ -0,0 +1,178 @@
+/**
+ * @file test_latency.c
+ * Tests for the streaming latency statistics: the summary of known distributions, and how far
+ * its percentiles may stray from the exact ones.
+ */
+
+#include <furi.h>
+#include <stdlib.h>
+
+#include "../../lib/pirate_latency.h"
+
+#include "pirate_test.h"
+
+#define TEST_LATENCY_SAMPLES_MAX 4096
+
+static int test_latency_compare(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * Records every sample; and checks each percentile against the exact one, by nearest rank. It
+ * may be no less, and no more than a quarter-octave (one sub-bucket's width) above it.
+ */
+static void test_latency_check_bound(uint32_t* samples, size_t count) {
+    PirateLatency latency;
+
+    pirate_latency_reset(&latency);
+    for(size_t i = 0; i < count; ++i) {
+        pirate_latency_record(&latency, samples[i]);
+    }
+    qsort(samples, count, sizeof(samples[0]), test_latency_compare);
+
+    for(uint8_t percentile = 0; percentile <= 100; ++percentile) {
+        size_t rank = (count * percentile + 99) / 100;
+        uint32_t exact = samples[rank ? rank - 1 : 0];
+        uint32_t estimate = pirate_latency_percentile(&latency, percentile);
+
+        if(!PIRATE_CHECK(estimate >= exact) || !PIRATE_CHECK(estimate - exact <= exact / 4) ||
+           !PIRATE_CHECK(estimate <= samples[count - 1])) {
+            fprintf(stderr, "    p%u is %u; exactly, %u\n", percentile, estimate, exact);
+            return;
+        }
+    }
+}
+
+/** A small generator of our own, so every run sees the same samples. */
+static uint32_t test_latency_random(uint32_t* state) {
+    *state = *state * 1664525 + 1013904223;
+    return *state >> 8;
+}
+
+static void test_latency_empty(void) {
+    PirateLatency latency;
+    PirateLatencySummary summary;
+
+    pirate_latency_reset(&latency);
+    pirate_latency_summarize(&latency, &summary);
+
+    PIRATE_CHECK_EQUAL(summary.count, 0);
+    PIRATE_CHECK_EQUAL(summary.min, 0);
+    PIRATE_CHECK_EQUAL(summary.mean, 0);
+    PIRATE_CHECK_EQUAL(summary.p50, 0);
+    PIRATE_CHECK_EQUAL(summary.p99, 0);
+    PIRATE_CHECK_EQUAL(summary.max, 0);
+    PIRATE_CHECK_EQUAL(pirate_latency_percentile(&latency, 50), 0);
+}
+
+static void test_latency_single(void) {
+    PirateLatency latency;
+    PirateLatencySummary summary;
+
+    // Every statistic of a single sample is that sample; the percentiles clamped to it, rather
+    // than being the top of its bucket.
+    pirate_latency_reset(&latency);
+    pirate_latency_record(&latency, 1000);
+    pirate_latency_summarize(&latency, &summary);
+
+    PIRATE_CHECK_EQUAL(summary.count, 1);
+    PIRATE_CHECK_EQUAL(summary.min, 1000);
+    PIRATE_CHECK_EQUAL(summary.mean, 1000);
+    PIRATE_CHECK_EQUAL(summary.p50, 1000);
+    PIRATE_CHECK_EQUAL(summary.p90, 1000);
+    PIRATE_CHECK_EQUAL(summary.p99, 1000);
+    PIRATE_CHECK_EQUAL(summary.max, 1000);
+    PIRATE_CHECK_EQUAL(pirate_latency_percentile(&latency, 0), 1000);
+
+    // Zero's a sample like any other.
+    pirate_latency_reset(&latency);
+    pirate_latency_record(&latency, 0);
+    pirate_latency_summarize(&latency, &summary);
+
+    PIRATE_CHECK_EQUAL(summary.count, 1);
+    PIRATE_CHECK_EQUAL(summary.min, 0);
+    PIRATE_CHECK_EQUAL(summary.p99, 0);
+    PIRATE_CHECK_EQUAL(summary.max, 0);
+}
+
+static void test_latency_known(void) {
+    PirateLatency latency;
+    PirateLatencySummary summary;
+
+    // The smallest samples each have a bucket of their own, so come out exactly.
+    pirate_latency_reset(&latency);
+    for(uint32_t i = 0; i < 100; ++i) {
+        pirate_latency_record(&latency, i % 4);
+    }
+    pirate_latency_summarize(&latency, &summary);
+
+    PIRATE_CHECK_EQUAL(summary.count, 100);
+    PIRATE_CHECK_EQUAL(summary.min, 0);
+    PIRATE_CHECK_EQUAL(summary.mean, 1);
+    PIRATE_CHECK_EQUAL(summary.p50, 1);
+    PIRATE_CHECK_EQUAL(summary.p90, 3);
+    PIRATE_CHECK_EQUAL(summary.p99, 3);
+    PIRATE_CHECK_EQUAL(summary.max, 3);
+
+    // A long tail: nine in ten at 10, which shares its bucket with 11; the rest at 10000, whose
+    // bucket's top is clamped to what we saw.
+    pirate_latency_reset(&latency);
+    for(uint32_t i = 0; i < 100; ++i) {
+        pirate_latency_record(&latency, (i < 90) ? 10 : 10000);
+    }
+    pirate_latency_summarize(&latency, &summary);
+
+    PIRATE_CHECK_EQUAL(summary.min, 10);
+    PIRATE_CHECK_EQUAL(summary.mean, 1009);
+    PIRATE_CHECK_EQUAL(summary.p50, 11);
+    PIRATE_CHECK_EQUAL(summary.p90, 11);
+    PIRATE_CHECK_EQUAL(summary.p99, 10000);
+    PIRATE_CHECK_EQUAL(summary.max, 10000);
+
+    // The very largest samples, whose total overflows 32 bits, and whose bucket tops out at the
+    // largest sample there is.
+    pirate_latency_reset(&latency);
+    pirate_latency_record(&latency, UINT32_MAX);
+    pirate_latency_record(&latency, UINT32_MAX - 1);
+    pirate_latency_summarize(&latency, &summary);
+
+    PIRATE_CHECK_EQUAL(summary.mean, UINT32_MAX - 1);
+    PIRATE_CHECK_EQUAL(summary.p50, UINT32_MAX);
+    PIRATE_CHECK_EQUAL(summary.max, UINT32_MAX);
+}
+
+static void test_latency_bound(void) {
+    static uint32_t samples[TEST_LATENCY_SAMPLES_MAX];
+    uint32_t state = 1;
+
+    // Every value up to a few octaves, each once.
+    for(uint32_t i = 0; i < 1000; ++i) {
+        samples[i] = i + 1;
+    }
+    test_latency_check_bound(samples, 1000);
+
+    // Spread evenly over the whole 32-bit range, and over a few orders of magnitude at once.
+    for(uint32_t i = 0; i < TEST_LATENCY_SAMPLES_MAX; ++i) {
+        samples[i] = test_latency_random(&state) << 8;
+    }
+    test_latency_check_bound(samples, TEST_LATENCY_SAMPLES_MAX);
+
+    for(uint32_t i = 0; i < TEST_LATENCY_SAMPLES_MAX; ++i) {
+        samples[i] = test_latency_random(&state) >> (test_latency_random(&state) % 24);
+    }
+    test_latency_check_bound(samples, TEST_LATENCY_SAMPLES_MAX);
+}
+
+int main(void) {
+    furi_log_set_level(FuriLogLevelNone);
+
+    PIRATE_TEST_RUN(test_latency_empty);
+    PIRATE_TEST_RUN(test_latency_single);
+    PIRATE_TEST_RUN(test_latency_known);
+    PIRATE_TEST_RUN(test_latency_bound);
+
+    return pirate_test_finish("latency");
+}
@@ -0,0 +1,827 @@
+/**
+ * @file test_libpirate.c
+ * Tests for the command compiler, its cache, and the interpreter.
+ *
+ * Commands are compiled and their bytecode checked byte for byte; then run against a bus that
+ * writes down every call made on it, and against a device on the simulated I2C bus, to check
+ * the interpreter asks the bus for exactly what the command says.
+ */
+
+#include <furi.h>
+#include <furi_hal.h>
+#include <hal_mock.h>
+
+#include "../../bus/bus_i2c.h"
+#include "../../lib/libpirate.h"
+
+#include "pirate_test.h"
+
+/** A transcript of calls on a bus or device, one short word each, space separated. */
+typedef struct {
+    char text[512];
+    size_t length;
+} PirateTestTranscript;
+
+static void __attribute__((format(printf, 2, 3)))
+    pirate_test_transcribe(PirateTestTranscript* transcript, const char* format, ...) {
+    va_list arguments;
+
+    if(transcript->length && (transcript->length < sizeof(transcript->text) - 1)) {
+        transcript->text[transcript->length++] = ' ';
+    }
+
+    va_start(arguments, format);
+    int written = vsnprintf(
+        &transcript->text[transcript->length],
+        sizeof(transcript->text) - transcript->length,
+        format,
+        arguments);
+    va_end(arguments);
+
+    if(written > 0) {
+        transcript->length =
+            MIN(transcript->length + written, sizeof(transcript->text) - 1);
+    }
+}
+
+/**
+ * Compiler.
+ */
+
+/** Compiles a command, and checks it made exactly the given bytecode, and read count. */
+static void pirate_test_check_compiles(
+    const char* file,
+    int line,
+    const char* text,
+    uint32_t read_count,
+    const uint8_t* expected,
+    size_t expected_length) {
+    PirateProgram program;
+    size_t error_offset = 0;
+    PirateError error = pirate_compile(text, strlen(text), &program, &error_offset);
+
+    if(!pirate_test_check(
+           error == PirateErrorNone,
+           file,
+           line,
+           "\"%s\" didn't compile: %s, at %zu",
+           text,
+           pirate_error_description(error),
+           error_offset)) {
+        return;
+    }
+
+    // Every program ends in a PirateOpEnd, past its length.
+    pirate_test_check_bytes(file, line, text, program.code, program.length + 1, expected, expected_length);
+    pirate_test_check(
+        program.read_count == read_count,
+        file,
+        line,
+        "\"%s\" reads %lu bytes; expected %lu",
+        text,
+        (unsigned long)program.read_count,
+        (unsigned long)read_count);
+}
+
+#define PIRATE_CHECK_COMPILES(text, read_count, ...) \
+    pirate_test_check_compiles(                      \
+        __FILE__,                                    \
+        __LINE__,                                    \
+        (text),                                      \
+        (read_count),                                \
+        (const uint8_t[]){__VA_ARGS__, PirateOpEnd}, \
+        sizeof((const uint8_t[]){__VA_ARGS__, PirateOpEnd}))
+
+/** Checks a command fails to compile, for the given reason, at the given offset into its text. */
+static void pirate_test_check_error(
+    const char* file,
+    int line,
+    const char* text,
+    PirateError expected,
+    size_t expected_offset) {
+    PirateProgram program;
+    size_t error_offset = SIZE_MAX;
+    PirateError error = pirate_compile(text, strlen(text), &program, &error_offset);
+
+    pirate_test_check(
+        (error == expected) && (error_offset == expected_offset),
+        file,
+        line,
+        "\"%s\" gave \"%s\" at %zu; expected \"%s\" at %zu",
+        text,
+        pirate_error_description(error),
+        error_offset,
+        pirate_error_description(expected),
+        expected_offset);
+    pirate_test_check(
+        program.length == 0, file, line, "\"%s\" left %u bytes of program", text, program.length);
+}
+
+#define PIRATE_CHECK_ERROR(text, error, offset) \
+    pirate_test_check_error(__FILE__, __LINE__, (text), (error), (offset))
+
+static void test_compile_transaction(void) {
+    PIRATE_CHECK_COMPILES(
+        "[0xA0 0x00 r:4]",
+        4,
+        PirateOpStart,
+        PirateOpWrite, 2, 0xA0, 0x00,
+        PirateOpRead, 4, 0,
+        PirateOpStop);
+
+    // Literals in every base pack into a single write; separators are interchangeable.
+    PIRATE_CHECK_COMPILES(
+        "[160,0b1\t16 r]",
+        1,
+        PirateOpStart,
+        PirateOpWrite, 3, 0xA0, 0x01, 0x10,
+        PirateOpRead, 1, 0,
+        PirateOpStop);
+
+    // A repeated start splits the write, so the bus is turned around between them.
+    PIRATE_CHECK_COMPILES(
+        "[0xA0 0x10 [0xA1 r:2]",
+        2,
+        PirateOpStart,
+        PirateOpWrite, 2, 0xA0, 0x10,
+        PirateOpStart,
+        PirateOpWrite, 1, 0xA1,
+        PirateOpRead, 2, 0,
+        PirateOpStop);
+}
+
+static void test_compile_repeats(void) {
+    // Short repeats of a byte are unrolled into its write...
+    PIRATE_CHECK_COMPILES(
+        "[0xA0 0x55:3]",
+        0,
+        PirateOpStart,
+        PirateOpWrite, 4, 0xA0, 0x55, 0x55, 0x55,
+        PirateOpStop);
+    PIRATE_CHECK_COMPILES(
+        "[0xA0 0x55:7]",
+        0,
+        PirateOpStart,
+        PirateOpWrite, 8, 0xA0, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        PirateOpStop);
+
+    // ... and longer ones are left to the interpreter; even when the byte's alone in its write.
+    PIRATE_CHECK_COMPILES(
+        "[0xA0 0x55:8]",
+        0,
+        PirateOpStart,
+        PirateOpWrite, 1, 0xA0,
+        PirateOpWriteRepeat, 0x55, 8, 0,
+        PirateOpStop);
+    PIRATE_CHECK_COMPILES(
+        "[0xFF:300]",
+        0,
+        PirateOpStart,
+        PirateOpWriteRepeat, 0xFF, 0x2C, 0x01,
+        PirateOpStop);
+
+    // Reads and delays take their counts as operands.
+    PIRATE_CHECK_COMPILES(
+        "[0xA1 r:300] &:50",
+        300,
+        PirateOpStart,
+        PirateOpWrite, 1, 0xA1,
+        PirateOpRead, 0x2C, 0x01,
+        PirateOpStop,
+        PirateOpDelay, 50, 0);
+}
+
+static void test_compile_loops(void) {
+    // A loop's count lives in its begin; its end points back there.
+    PIRATE_CHECK_COMPILES(
+        "{[0xA0 0x00 r:4]}:3",
+        12,
+        PirateOpLoopBegin, 3, 0,
+        PirateOpStart,
+        PirateOpWrite, 2, 0xA0, 0x00,
+        PirateOpRead, 4, 0,
+        PirateOpStop,
+        PirateOpLoopEnd, 0, 0);
+
+    // Without a count, a loop runs once; and nested loops multiply their reads.
+    PIRATE_CHECK_COMPILES(
+        "[0xA0] {{[0xA1 r:2]}:5}",
+        10,
+        PirateOpStart,
+        PirateOpWrite, 1, 0xA0,
+        PirateOpStop,
+        PirateOpLoopBegin, 1, 0,
+        PirateOpLoopBegin, 5, 0,
+        PirateOpStart,
+        PirateOpWrite, 1, 0xA1,
+        PirateOpRead, 2, 0,
+        PirateOpStop,
+        PirateOpLoopEnd, 8, 0,
+        PirateOpLoopEnd, 5, 0);
+    PIRATE_CHECK_COMPILES(
+        "{{[0xA1 r:2]}:5}:3",
+        30,
+        PirateOpLoopBegin, 3, 0,
+        PirateOpLoopBegin, 5, 0,
+        PirateOpStart,
+        PirateOpWrite, 1, 0xA1,
+        PirateOpRead, 2, 0,
+        PirateOpStop,
+        PirateOpLoopEnd, 3, 0,
+        PirateOpLoopEnd, 0, 0);
+}
+
+static void test_compile_speed(void) {
+    PIRATE_CHECK_COMPILES(
+        "@400 [0xA0] @0",
+        0,
+        PirateOpSpeed, 0x90, 0x01,
+        PirateOpStart,
+        PirateOpWrite, 1, 0xA0,
+        PirateOpStop,
+        PirateOpSpeed, 0, 0);
+}
+
+static void test_compile_errors(void) {
+    PIRATE_CHECK_ERROR("[0xA0 zz]", PirateErrorInvalidToken, 6);
+    PIRATE_CHECK_ERROR("[0xA0 0xG0]", PirateErrorInvalidToken, 6);
+    PIRATE_CHECK_ERROR("[0xA0 0x100]", PirateErrorValueTooLarge, 6);
+    PIRATE_CHECK_ERROR("[0xA0 r:0]", PirateErrorValueTooLarge, 7);
+    PIRATE_CHECK_ERROR("[0xA0 r:65536]", PirateErrorValueTooLarge, 7);
+    PIRATE_CHECK_ERROR("@65536", PirateErrorValueTooLarge, 0);
+    PIRATE_CHECK_ERROR("[:3 0xA0]", PirateErrorMisplacedRepeat, 1);
+    PIRATE_CHECK_ERROR(":3", PirateErrorMisplacedRepeat, 0);
+
+    // Unclosed openers are blamed where they opened; stray closers where they are.
+    PIRATE_CHECK_ERROR("[0xA0 r", PirateErrorUnbalancedStart, 0);
+    PIRATE_CHECK_ERROR("[0xA0] [0xA1 [0xA2", PirateErrorUnbalancedStart, 7);
+    PIRATE_CHECK_ERROR("[0xA0] 0x00]", PirateErrorUnbalancedStop, 11);
+    PIRATE_CHECK_ERROR("{[0xA0]", PirateErrorUnbalancedLoop, 0);
+    PIRATE_CHECK_ERROR("{[0xA0]} {", PirateErrorUnbalancedLoop, 9);
+    PIRATE_CHECK_ERROR("[0xA0]}", PirateErrorUnbalancedLoop, 6);
+    PIRATE_CHECK_ERROR("{{{{{[0xA0]}}}}}", PirateErrorLoopTooDeep, 4);
+
+    // A program that won't fit is blamed on the first token that doesn't.
+    char text[PIRATE_PROGRAM_MAX_LENGTH * 2 + 3];
+    size_t length = 0;
+    text[length++] = '[';
+    for(size_t i = 0; i < PIRATE_PROGRAM_MAX_LENGTH; ++i) {
+        text[length++] = '1';
+        text[length++] = ' ';
+    }
+    text[length++] = ']';
+    text[length] = 0;
+
+    // Each write run carries at most 255 bytes; and the program holds its PirateOpEnd too.
+    size_t fits = PIRATE_PROGRAM_MAX_LENGTH - 1 - 1 - 2 - 2;
+    PIRATE_CHECK_ERROR(text, PirateErrorProgramTooLong, 1 + fits * 2);
+}
+
+/**
+ * Program cache.
+ */
+
+static void test_compile_part(void) {
+    char text[PIRATE_PROGRAM_MAX_LENGTH * 3];
+    PirateProgram program;
+    size_t consumed;
+    size_t offset;
+
+    // Anything that fits is compiled whole.
+    PIRATE_CHECK_EQUAL(
+        pirate_compile_part("[0xA0 r] ", 9, &program, &consumed, NULL), PirateErrorNone);
+    PIRATE_CHECK_EQUAL(consumed, 9);
+
+    // Repeated writes that don't fit stop the program before the value, not between it and
+    // its ':7'.
+    size_t length = 0;
+    while(length + 7 < sizeof(text)) {
+        length += snprintf(&text[length], sizeof(text) - length, "0x55:7 ");
+    }
+    PIRATE_CHECK_EQUAL(
+        pirate_compile_part(text, length, &program, &consumed, NULL), PirateErrorNone);
+    PIRATE_CHECK(consumed < length);
+    PIRATE_CHECK(text[consumed - 1] == '7');
+    PIRATE_CHECK_EQUAL(program.source_length, consumed);
+
+    // A loop, with its repeat, is one piece; and a transaction that won't fit by itself is an
+    // error, blamed on where it ran out.
+    length = snprintf(text, sizeof(text), "[0xA0] {[0xA1 r]}:2 [0xA0");
+    for(size_t i = 0; i < PIRATE_PROGRAM_MAX_LENGTH; ++i) {
+        text[length++] = ' ';
+        text[length++] = '1';
+    }
+    text[length++] = ']';
+    PIRATE_CHECK_EQUAL(
+        pirate_compile_part(text, length, &program, &consumed, &offset), PirateErrorNone);
+    PIRATE_CHECK_EQUAL(consumed, 19);
+
+    size_t rest = length - consumed;
+    PIRATE_CHECK_EQUAL(
+        pirate_compile_part(&text[consumed], rest, &program, &consumed, &offset),
+        PirateErrorProgramTooLong);
+    PIRATE_CHECK(offset > 6);
+}
+
+static void test_cache_hits(void) {
+    PirateProgramCache cache;
+    PirateError error;
+
+    pirate_cache_reset(&cache);
+
+    const PirateProgram* first = pirate_cache_get(&cache, "[0xA0 r]", &error, NULL);
+    const PirateProgram* second = pirate_cache_get(&cache, "[0xA0 r]", &error, NULL);
+    PIRATE_CHECK(first && (first == second));
+    PIRATE_CHECK_EQUAL(cache.misses, 1);
+    PIRATE_CHECK_EQUAL(cache.hits, 1);
+
+    // Once every slot's taken, the least recently used is the one that goes.
+    for(size_t i = 0; i < PIRATE_CACHE_ENTRIES; ++i) {
+        char command[16];
+
+        snprintf(command, sizeof(command), "[0x%02X]", (unsigned)(2 * i));
+        pirate_cache_get(&cache, command, &error, NULL);
+    }
+    PIRATE_CHECK_EQUAL(cache.misses, 1 + PIRATE_CACHE_ENTRIES);
+    pirate_cache_get(&cache, "[0x0E]", &error, NULL);
+    pirate_cache_get(&cache, "[0xA0 r]", &error, NULL);
+    PIRATE_CHECK_EQUAL(cache.misses, 2 + PIRATE_CACHE_ENTRIES);
+}
+
+static void test_cache_collision(void) {
+    static const uint8_t expected[] = {PirateOpStart, PirateOpWrite, 1, 0xA2, PirateOpStop};
+    PirateProgramCache cache;
+    PirateError error;
+
+    pirate_cache_reset(&cache);
+    pirate_cache_get(&cache, "[0xA0]", &error, NULL);
+
+    // Make the cached command's hash collide with another of the same length; which a real
+    // 32-bit hash will, given enough commands.
+    PirateCacheEntry* entry = NULL;
+    for(size_t i = 0; i < PIRATE_CACHE_ENTRIES; ++i) {
+        if(cache.entries[i].valid) {
+            entry = &cache.entries[i];
+        }
+    }
+    PIRATE_CHECK(entry != NULL);
+    if(!entry) {
+        return;
+    }
+    entry->program.hash = pirate_hash("[0xA2]", 6);
+
+    // It's still a different command; so it's compiled, not handed the other's program.
+    const PirateProgram* program = pirate_cache_get(&cache, "[0xA2]", &error, NULL);
+    PIRATE_CHECK_EQUAL(cache.hits, 0);
+    PIRATE_CHECK_EQUAL(cache.misses, 2);
+    PIRATE_CHECK(program && (program != &entry->program));
+    if(program) {
+        PIRATE_CHECK_BYTES(program->code, program->length, expected, sizeof(expected));
+    }
+}
+
+static void test_cache_failure(void) {
+    PirateProgramCache cache;
+    PirateError error;
+    size_t error_offset;
+    char command[16];
+
+    pirate_cache_reset(&cache);
+    for(size_t i = 0; i < PIRATE_CACHE_ENTRIES; ++i) {
+        snprintf(command, sizeof(command), "[0x%02X]", (unsigned)(2 * i));
+        pirate_cache_get(&cache, command, &error, NULL);
+    }
+
+    // A command that doesn't compile says why; and leaves every program that did in place.
+    PIRATE_CHECK(pirate_cache_get(&cache, "[0xA0 zz]", &error, &error_offset) == NULL);
+    PIRATE_CHECK_EQUAL(error, PirateErrorInvalidToken);
+    PIRATE_CHECK_EQUAL(error_offset, 6);
+
+    for(size_t i = 0; i < PIRATE_CACHE_ENTRIES; ++i) {
+        snprintf(command, sizeof(command), "[0x%02X]", (unsigned)(2 * i));
+        PIRATE_CHECK(pirate_cache_get(&cache, command, &error, NULL) != NULL);
+    }
+    PIRATE_CHECK_EQUAL(cache.hits, PIRATE_CACHE_ENTRIES);
+}
+
+static void test_cache_long_command(void) {
+    char text[PIRATE_CACHE_SOURCE_MAX + 8] = "[0xA0";
+    PirateProgramCache cache;
+    PirateError error;
+
+    pirate_cache_reset(&cache);
+    pirate_cache_get(&cache, "[0xA0]", &error, NULL);
+
+    size_t length = strlen(text);
+    while(length + 3 < sizeof(text)) {
+        text[length++] = ' ';
+        text[length++] = '1';
+    }
+    text[length++] = ']';
+    text[length] = 0;
+
+    // Too long to keep a copy of; so it's compiled every time, and pushes nothing out.
+    PIRATE_CHECK(pirate_cache_get(&cache, text, &error, NULL) != NULL);
+    PIRATE_CHECK(pirate_cache_get(&cache, text, &error, NULL) != NULL);
+    PIRATE_CHECK(pirate_cache_get(&cache, "[0xA0]", &error, NULL) != NULL);
+    PIRATE_CHECK_EQUAL(cache.misses, 3);
+    PIRATE_CHECK_EQUAL(cache.hits, 1);
+}
+
+/**
+ * Interpreter, against a bus that writes down what's asked of it.
+ */
+
+typedef struct {
+    PirateTestTranscript calls;
+
+    /** What reads return: a counter, so every byte read is different. */
+    uint8_t next_read;
+
+    /** The number of the call to fail, counting from one; zero if none should. */
+    uint32_t fail_call;
+    uint32_t call;
+} PirateTestBus;
+
+static const char* pirate_test_next_name(PirateBusNext next) {
+    switch(next) {
+    case PirateBusNextContinue:
+        return "more";
+    case PirateBusNextRestart:
+        return "restart";
+    case PirateBusNextStop:
+        return "stop";
+    }
+    return "?";
+}
+
+static bool pirate_test_bus_succeeds(PirateTestBus* bus) {
+    bus->call += 1;
+    return bus->call != bus->fail_call;
+}
+
+static bool pirate_test_bus_start(void* context) {
+    PirateTestBus* bus = context;
+    pirate_test_transcribe(&bus->calls, "[");
+    return pirate_test_bus_succeeds(bus);
+}
+
+static bool pirate_test_bus_stop(void* context) {
+    PirateTestBus* bus = context;
+    pirate_test_transcribe(&bus->calls, "]");
+    return pirate_test_bus_succeeds(bus);
+}
+
+static bool pirate_test_bus_write(void* context, const uint8_t* data, size_t length, PirateBusNext next) {
+    PirateTestBus* bus = context;
+
+    pirate_test_transcribe(&bus->calls, "w");
+    for(size_t i = 0; i < length; ++i) {
+        pirate_test_transcribe(&bus->calls, "%02X", data[i]);
+    }
+    pirate_test_transcribe(&bus->calls, "/%s", pirate_test_next_name(next));
+    return pirate_test_bus_succeeds(bus);
+}
+
+static bool pirate_test_bus_read(void* context, uint8_t* data, size_t length, PirateBusNext next) {
+    PirateTestBus* bus = context;
+
+    for(size_t i = 0; i < length; ++i) {
+        data[i] = bus->next_read++;
+    }
+    pirate_test_transcribe(&bus->calls, "r%zu/%s", length, pirate_test_next_name(next));
+    return pirate_test_bus_succeeds(bus);
+}
+
+static void pirate_test_bus_delay(void* context, uint32_t microseconds) {
+    PirateTestBus* bus = context;
+    pirate_test_transcribe(&bus->calls, "&%lu", (unsigned long)microseconds);
+}
+
+static bool pirate_test_bus_set_speed(void* context, uint32_t kilohertz) {
+    PirateTestBus* bus = context;
+    pirate_test_transcribe(&bus->calls, "@%lu", (unsigned long)kilohertz);
+    return pirate_test_bus_succeeds(bus);
+}
+
+typedef struct {
+    uint8_t data[1024];
+    size_t length;
+    uint32_t chunks;
+
+    uint32_t begins;
+    uint32_t ends;
+} PirateTestSink;
+
+static void pirate_test_sink_data(void* context, const uint8_t* data, size_t length) {
+    PirateTestSink* sink = context;
+
+    if(sink->length + length <= sizeof(sink->data)) {
+        memcpy(&sink->data[sink->length], data, length);
+    }
+    sink->length += length;
+    sink->chunks += 1;
+}
+
+static void pirate_test_sink_begin(void* context) {
+    PirateTestSink* sink = context;
+    sink->begins += 1;
+}
+
+static void pirate_test_sink_end(void* context) {
+    PirateTestSink* sink = context;
+    sink->ends += 1;
+}
+
+/** Runs a program against a fresh test bus; returns how the run went. */
+static PirateExecStatus pirate_test_execute(
+    const PirateProgram* program,
+    PirateTestBus* test_bus,
+    PirateTestSink* test_sink,
+    PirateExecReport* report) {
+    PirateBus bus = {
+        .start = pirate_test_bus_start,
+        .stop = pirate_test_bus_stop,
+        .write = pirate_test_bus_write,
+        .read = pirate_test_bus_read,
+        .delay_us = pirate_test_bus_delay,
+        .set_speed = pirate_test_bus_set_speed,
+        .context = test_bus,
+    };
+    PirateSink sink = {
+        .data = pirate_test_sink_data,
+        .transaction_begin = pirate_test_sink_begin,
+        .transaction_end = pirate_test_sink_end,
+        .context = test_sink,
+    };
+
+    return pirate_execute(program, &bus, &sink, report);
+}
+
+/** Compiles and runs a command against a fresh test bus; returns how the run went. */
+static PirateExecStatus pirate_test_run(
+    const char* text,
+    PirateTestBus* test_bus,
+    PirateTestSink* test_sink,
+    PirateExecReport* report) {
+    PirateProgram program;
+
+    if(!PIRATE_CHECK(pirate_compile(text, strlen(text), &program, NULL) == PirateErrorNone)) {
+        return PirateExecInvalidProgram;
+    }
+    return pirate_test_execute(&program, test_bus, test_sink, report);
+}
+
+static void test_execute_transaction(void) {
+    PirateTestBus bus = {0};
+    PirateTestSink sink = {0};
+    PirateExecReport report;
+
+    PIRATE_CHECK_EQUAL(pirate_test_run("[0xA0 0x00 r:4]", &bus, &sink, &report), PirateExecOk);
+    PIRATE_CHECK_STRING(bus.calls.text, "[ w A0 00 /restart r4/stop ]");
+    PIRATE_CHECK_BYTES(sink.data, sink.length, ((const uint8_t[]){0, 1, 2, 3}), 4);
+    PIRATE_CHECK_EQUAL(report.transactions, 1);
+    PIRATE_CHECK_EQUAL(report.bytes_written, 2);
+    PIRATE_CHECK_EQUAL(sink.begins, 1);
+    PIRATE_CHECK_EQUAL(sink.ends, 1);
+}
+
+static void test_execute_next_transfer(void) {
+    PirateTestBus bus = {0};
+    PirateTestSink sink = {0};
+
+    // Each transfer's told what follows it: more of the same, a turnaround, or the stop.
+    pirate_test_run("[0xA0 0x00 [0xA1 r r:2] & [0xA0 0x01:9 0x02]", &bus, &sink, NULL);
+    PIRATE_CHECK_STRING(
+        bus.calls.text,
+        "[ w A0 00 /restart [ w A1 /restart r1/more r2/stop ] &1 "
+        "[ w A0 /more w 01 01 01 01 01 01 01 01 01 /more w 02 /stop ]");
+
+    // Long reads go to the bus, and to the sink, a chunk at a time.
+    memset(&bus, 0, sizeof(bus));
+    memset(&sink, 0, sizeof(sink));
+    pirate_test_run("[0xA1 r:100]", &bus, &sink, NULL);
+    PIRATE_CHECK_STRING(bus.calls.text, "[ w A1 /restart r64/more r36/stop ]");
+    PIRATE_CHECK_EQUAL(sink.length, 100);
+    PIRATE_CHECK_EQUAL(sink.chunks, 2);
+    PIRATE_CHECK_EQUAL(sink.data[99], 99);
+}
+
+static void test_execute_loops(void) {
+    PirateTestBus bus = {0};
+    PirateTestSink sink = {0};
+    PirateExecReport report;
+
+    PIRATE_CHECK_EQUAL(pirate_test_run("{[0xA0 r]}:3", &bus, &sink, &report), PirateExecOk);
+    PIRATE_CHECK_STRING(
+        bus.calls.text,
+        "[ w A0 /restart r1/stop ] [ w A0 /restart r1/stop ] [ w A0 /restart r1/stop ]");
+    PIRATE_CHECK_EQUAL(report.transactions, 3);
+    PIRATE_CHECK_EQUAL(sink.begins, 3);
+    PIRATE_CHECK_EQUAL(sink.length, 3);
+
+    // A loop inside a transaction continues it; the last pass runs into whatever follows.
+    memset(&bus, 0, sizeof(bus));
+    memset(&sink, 0, sizeof(sink));
+    pirate_test_run("[0xA1 {r}:3 ] @400", &bus, &sink, &report);
+    PIRATE_CHECK_STRING(bus.calls.text, "[ w A1 /restart r1/more r1/more r1/stop ] @400");
+    PIRATE_CHECK_EQUAL(report.transactions, 1);
+}
+
+static void test_execute_failure(void) {
+    PirateTestBus bus = {.fail_call = 3};
+    PirateTestSink sink = {0};
+    PirateExecReport report;
+
+    // The third call -- the read -- fails; nothing's asked of the bus after it.
+    PIRATE_CHECK_EQUAL(
+        pirate_test_run("[0xA0 0x00 r:4] [0xA0]", &bus, &sink, &report), PirateExecBusError);
+    PIRATE_CHECK_STRING(bus.calls.text, "[ w A0 00 /restart r4/stop");
+    PIRATE_CHECK_EQUAL(report.transactions, 0);
+    PIRATE_CHECK_EQUAL(report.error_offset, 5);
+}
+
+static void test_execute_cached(void) {
+    PirateProgramCache cache;
+    PirateTestBus bus = {0};
+    PirateTestSink sink = {0};
+    PirateError error;
+    char command[32];
+
+    // Fill every slot with programs longer than the one that replaces the oldest of them...
+    pirate_cache_reset(&cache);
+    for(size_t i = 0; i < PIRATE_CACHE_ENTRIES; ++i) {
+        snprintf(command, sizeof(command), "[0xA0 0x%02X r r]", (unsigned)i);
+        pirate_cache_get(&cache, command, &error, NULL);
+    }
+
+    // ... which still has to end where it does; its last write is followed by nothing.
+    const PirateProgram* program = pirate_cache_get(&cache, "0x55", &error, NULL);
+    if(PIRATE_CHECK(program != NULL)) {
+        PIRATE_CHECK_EQUAL(program->code[program->length], PirateOpEnd);
+        PIRATE_CHECK_EQUAL(pirate_test_execute(program, &bus, &sink, NULL), PirateExecOk);
+        PIRATE_CHECK_STRING(bus.calls.text, "w 55 /stop");
+    }
+}
+
+/**
+ * Interpreter, against a device on the simulated I2C bus.
+ */
+
+typedef struct {
+    PirateTestTranscript calls;
+    uint8_t next_read;
+} PirateTestDevice;
+
+static bool pirate_test_device_start(void* context, bool read) {
+    PirateTestDevice* device = context;
+    pirate_test_transcribe(&device->calls, read ? "S(r)" : "S(w)");
+    return true;
+}
+
+static bool pirate_test_device_write(void* context, uint8_t data) {
+    PirateTestDevice* device = context;
+    pirate_test_transcribe(&device->calls, "%02X", data);
+    return true;
+}
+
+static uint8_t pirate_test_device_read(void* context) {
+    PirateTestDevice* device = context;
+    pirate_test_transcribe(&device->calls, "r");
+    return device->next_read++;
+}
+
+static void pirate_test_device_stop(void* context) {
+    PirateTestDevice* device = context;
+    pirate_test_transcribe(&device->calls, "P");
+}
+
+/** Runs a command on the simulated I2C bus, with a test device at 0x50; returns what it saw. */
+static PirateExecStatus
+    pirate_test_run_i2c(const char* text, PirateTestDevice* device, PirateTestSink* test_sink) {
+    const FuriHalMockI2cDevice hooks = {
+        .start = pirate_test_device_start,
+        .write = pirate_test_device_write,
+        .read = pirate_test_device_read,
+        .stop = pirate_test_device_stop,
+        .context = device,
+    };
+    static PirateI2cSpeedCache speeds;
+    PirateI2cBus i2c;
+    PirateBus bus;
+    PirateProgram program;
+    PirateSink sink = {.data = pirate_test_sink_data, .context = test_sink};
+
+    furi_hal_mock_i2c_attach(0x50, &hooks);
+    pirate_i2c_bus_init(&bus, &i2c, &furi_hal_i2c_handle_external, &speeds);
+
+    PirateExecStatus status = PirateExecInvalidProgram;
+    if(PIRATE_CHECK(pirate_compile(text, strlen(text), &program, NULL) == PirateErrorNone)) {
+        bus.acquire(bus.context);
+        status = pirate_execute(&program, &bus, &sink, NULL);
+        bus.release(bus.context);
+    }
+
+    furi_hal_mock_i2c_detach(0x50);
+    return status;
+}
+
+static void test_execute_i2c(void) {
+    PirateTestDevice device = {.next_read = 0x10};
+    PirateTestSink sink = {0};
+
+    // A register read: the pointer's written, and the bus turned around with a repeated start.
+    PIRATE_CHECK_EQUAL(pirate_test_run_i2c("[0xA0 0x00 r:4]", &device, &sink), PirateExecOk);
+    PIRATE_CHECK_STRING(device.calls.text, "S(w) 00 S(r) r r r r P");
+    PIRATE_CHECK_BYTES(sink.data, sink.length, ((const uint8_t[]){0x10, 0x11, 0x12, 0x13}), 4);
+
+    // Writes split across runs are still one transfer on the wire; a bare address is a probe.
+    memset(&device, 0, sizeof(device));
+    memset(&sink, 0, sizeof(sink));
+    PIRATE_CHECK_EQUAL(
+        pirate_test_run_i2c("[0xA0 0x10 0x55:9 0x02] [0xA0]", &device, &sink), PirateExecOk);
+    PIRATE_CHECK_STRING(
+        device.calls.text, "S(w) 10 55 55 55 55 55 55 55 55 55 02 P S(w) P");
+
+    // Nobody answers at 0x51; the run stops at its first transaction.
+    memset(&device, 0, sizeof(device));
+    PIRATE_CHECK_EQUAL(
+        pirate_test_run_i2c("[0xA2 0x00] [0xA0 0x00]", &device, &sink), PirateExecBusError);
+    PIRATE_CHECK_STRING(device.calls.text, "");
+}
+
+/** Bytes that had crossed the bus when each transaction began and ended; the last of each. */
+typedef struct {
+    uint64_t begin_bytes;
+    uint64_t end_bytes;
+} PirateTestTiming;
+
+static void pirate_test_timing_begin(void* context) {
+    PirateTestTiming* timing = context;
+    timing->begin_bytes = furi_hal_mock_i2c_get_byte_count();
+}
+
+static void pirate_test_timing_end(void* context) {
+    PirateTestTiming* timing = context;
+    timing->end_bytes = furi_hal_mock_i2c_get_byte_count();
+}
+
+static void test_execute_i2c_probe(void) {
+    PirateI2cSpeedCache speeds = {0};
+    PirateTestTiming timing = {0};
+    PirateSink sink = {
+        .transaction_begin = pirate_test_timing_begin,
+        .transaction_end = pirate_test_timing_end,
+        .context = &timing,
+    };
+    PirateProgram program;
+    PirateI2cBus i2c;
+    PirateBus bus;
+
+    furi_hal_mock_i2c_attach_eeprom(0x50, 256, 1);
+    furi_hal_mock_i2c_set_max_speed(0x50, 400);
+    pirate_i2c_bus_init(&bus, &i2c, &furi_hal_i2c_handle_external, &speeds);
+    bus.acquire(bus.context);
+
+    // A write that doesn't set a pointer to read back from isn't probed; nor is a bare address.
+    pirate_compile("@0 [0xA0 0x00 0x55] [0xA0]", 26, &program, NULL);
+    PIRATE_CHECK_EQUAL(pirate_execute(&program, &bus, &sink, NULL), PirateExecOk);
+    PIRATE_CHECK_EQUAL(i2c.probes, 0);
+    PIRATE_CHECK_EQUAL(speeds.speeds[0x50], 0);
+
+    // A register read is; before it's timed, so only its own seven bytes count towards it.
+    uint64_t bytes = furi_hal_mock_i2c_get_byte_count();
+    pirate_compile("@0 [0xA0 0x10 r:4]", 18, &program, NULL);
+    PIRATE_CHECK_EQUAL(pirate_execute(&program, &bus, &sink, NULL), PirateExecOk);
+    PIRATE_CHECK_EQUAL(i2c.probes, 1);
+    PIRATE_CHECK_EQUAL(speeds.speeds[0x50], 400);
+    PIRATE_CHECK(timing.begin_bytes > bytes);
+    PIRATE_CHECK_EQUAL(timing.end_bytes - timing.begin_bytes, 7);
+
+    bus.release(bus.context);
+    furi_hal_mock_i2c_detach(0x50);
+}
+
+int main(void) {
+    furi_log_set_level(FuriLogLevelNone);
+
+    PIRATE_TEST_RUN(test_compile_transaction);
+    PIRATE_TEST_RUN(test_compile_repeats);
+    PIRATE_TEST_RUN(test_compile_loops);
+    PIRATE_TEST_RUN(test_compile_speed);
+    PIRATE_TEST_RUN(test_compile_errors);
+    PIRATE_TEST_RUN(test_compile_part);
+    PIRATE_TEST_RUN(test_cache_hits);
+    PIRATE_TEST_RUN(test_cache_collision);
+    PIRATE_TEST_RUN(test_cache_failure);
+    PIRATE_TEST_RUN(test_cache_long_command);
+    PIRATE_TEST_RUN(test_execute_transaction);
+    PIRATE_TEST_RUN(test_execute_next_transfer);
+    PIRATE_TEST_RUN(test_execute_loops);
+    PIRATE_TEST_RUN(test_execute_failure);
+    PIRATE_TEST_RUN(test_execute_cached);
+    PIRATE_TEST_RUN(test_execute_i2c);
+    PIRATE_TEST_RUN(test_execute_i2c_probe);
+
+    return pirate_test_finish("libpirate");
+}
@@ -0,0 +1,217 @@
+/**
+ * @file test_predict.c
+ * Tests for command completion: what it learns from commands, how it keys what follows an
+ * address, and how its fixed-size tables make room and age.
+ */
+
+#include <furi.h>
+
+#include "../../lib/pirate_predict.h"
+
+#include "pirate_test.h"
+
+/** Learns the same command a number of times over. */
+static void test_predict_learn(PiratePredictor* predictor, const char* command, uint32_t times) {
+    for(uint32_t i = 0; i < times; ++i) {
+        pirate_predict_learn(predictor, command);
+    }
+}
+
+/**
+ * Checks the predictions for a transaction typed so far: in order, separated by spaces; and how
+ * much of the text they'd replace.
+ */
+static void test_predict_check(
+    const PiratePredictor* predictor,
+    const char* text,
+    const char* expected,
+    size_t replace,
+    const char* file,
+    int line) {
+    PiratePredictions predictions;
+    char actual[PIRATE_PREDICT_MAX * PIRATE_PREDICT_TEXT_MAX] = {0};
+    size_t length = 0;
+
+    pirate_predict(predictor, text, strlen(text), &predictions);
+    for(uint8_t i = 0; i < predictions.count; ++i) {
+        length += snprintf(
+            &actual[length], sizeof(actual) - length, "%s%s", i ? " " : "", predictions.text[i]);
+    }
+
+    pirate_test_check(
+        strcmp(actual, expected) == 0,
+        file,
+        line,
+        "predictions for \"%s\" are \"%s\"; expected \"%s\"",
+        text,
+        actual,
+        expected);
+    if(predictions.count) {
+        pirate_test_check(
+            predictions.replace == replace,
+            file,
+            line,
+            "predictions for \"%s\" replace %u; expected %u",
+            text,
+            predictions.replace,
+            (unsigned)replace);
+    }
+}
+
+#define TEST_PREDICT_CHECK(predictor, text, expected, replace) \
+    test_predict_check((predictor), (text), (expected), (replace), __FILE__, __LINE__)
+
+/** The count an address has in the table; zero if it isn't there. */
+static uint8_t test_predict_address_count(const PiratePredictor* predictor, uint8_t address) {
+    for(uint8_t i = 0; i < predictor->address_count; ++i) {
+        if(predictor->addresses[i].value == address) {
+            return predictor->addresses[i].count;
+        }
+    }
+    return 0;
+}
+
+static void test_predict_positions(void) {
+    PiratePredictor predictor;
+
+    pirate_predict_reset(&predictor);
+    TEST_PREDICT_CHECK(&predictor, "[", "", 0);
+
+    test_predict_learn(&predictor, "[0xA0 0x00 r]", 3);
+    test_predict_learn(&predictor, "[0xA0 0x10 r:4]", 1);
+
+    // Typing a transaction out one word at a time: the address, then what followed it, then
+    // what followed that.
+    TEST_PREDICT_CHECK(&predictor, "[", "0xA0", 0);
+    TEST_PREDICT_CHECK(&predictor, "[0x", "0xA0", 2);
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 ", "0x00 0x10", 0);
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 0x00 ", "r", 0);
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 0x10 ", "r:4", 0);
+
+    // Nothing's learned past a read, nor past the depth we predict to; nor for text that isn't
+    // a transaction.
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 0x00 r ", "", 0);
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 0x00 0x01 0x02 ", "", 0);
+    TEST_PREDICT_CHECK(&predictor, "0xA0 ", "", 0);
+}
+
+static void test_predict_previous(void) {
+    PiratePredictor predictor;
+
+    pirate_predict_reset(&predictor);
+    test_predict_learn(&predictor, "[0xA0 0x00 0x11]", 1);
+    test_predict_learn(&predictor, "[0xA0 0x01 0x22]", 1);
+    test_predict_learn(&predictor, "[0xB0 0x00 0x33]", 1);
+
+    // What follows a byte is keyed on the address as well as on the byte itself.
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 0x00 ", "0x11", 0);
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 0x01 ", "0x22", 0);
+    TEST_PREDICT_CHECK(&predictor, "[0xB0 0x00 ", "0x33", 0);
+    TEST_PREDICT_CHECK(&predictor, "[0xB0 0x01 ", "", 0);
+
+    // And on its position: the second byte after an address isn't offered as the first.
+    TEST_PREDICT_CHECK(&predictor, "[0xB0 ", "0x00", 0);
+
+    // A repeated start begins a transaction of its own, learned like any other.
+    test_predict_learn(&predictor, "[0xA0 0x00 [0xA1 r:2]", 2);
+    TEST_PREDICT_CHECK(&predictor, "[", "0xA0 0xA1 0xB0", 0);
+    TEST_PREDICT_CHECK(&predictor, "[0xA1 ", "r:2", 0);
+}
+
+static void test_predict_repeats(void) {
+    PiratePredictor predictor;
+
+    pirate_predict_reset(&predictor);
+
+    // A read's count is folded into it, rather than being learned as something of its own.
+    test_predict_learn(&predictor, "[0xA0 r:16]", 2);
+    test_predict_learn(&predictor, "[0xA0 r]", 1);
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 ", "r:16 r", 0);
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 r:", "r:16", 2);
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 R", "r:16 r", 1);
+
+    // A repeated byte counts once, and what follows it is keyed on the byte.
+    test_predict_learn(&predictor, "[0xB0 0x00:3 0x44]", 1);
+    TEST_PREDICT_CHECK(&predictor, "[0xB0 ", "0x00", 0);
+    TEST_PREDICT_CHECK(&predictor, "[0xB0 0x00:3 ", "0x44", 0);
+}
+
+static void test_predict_prefix(void) {
+    PiratePredictor predictor;
+
+    pirate_predict_reset(&predictor);
+    test_predict_learn(&predictor, "[0xA0 0x10]", 4);
+    test_predict_learn(&predictor, "[0xA0 0x1F]", 3);
+    test_predict_learn(&predictor, "[0xA0 0x20]", 2);
+    test_predict_learn(&predictor, "[0xA0 r]", 1);
+
+    // Only what starts with the half-typed word, whatever its case; best first.
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 ", "0x10 0x1F 0x20 r", 0);
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 0x1", "0x10 0x1F", 3);
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 0X1f", "0x1F", 4);
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 0x3", "", 0);
+
+    // Longer than anything we'd offer, it can't be the start of any of it.
+    TEST_PREDICT_CHECK(&predictor, "[0xA0 0x10000000", "", 0);
+}
+
+static void test_predict_eviction(void) {
+    PiratePredictor predictor;
+    char command[8];
+
+    pirate_predict_reset(&predictor);
+    test_predict_learn(&predictor, "[0x10]", 3);
+    for(uint8_t address = 0x11; address < 0x10 + PIRATE_PREDICT_ADDRESSES; ++address) {
+        snprintf(command, sizeof(command), "[0x%02X]", address);
+        test_predict_learn(&predictor, command, 1);
+    }
+    PIRATE_CHECK_EQUAL(predictor.address_count, PIRATE_PREDICT_ADDRESSES);
+
+    // The table's full; the next address takes the place of the least used, the longest unseen.
+    test_predict_learn(&predictor, "[0x20]", 1);
+    PIRATE_CHECK_EQUAL(predictor.address_count, PIRATE_PREDICT_ADDRESSES);
+    PIRATE_CHECK_EQUAL(test_predict_address_count(&predictor, 0x11), 0);
+    PIRATE_CHECK_EQUAL(test_predict_address_count(&predictor, 0x12), 1);
+    PIRATE_CHECK_EQUAL(test_predict_address_count(&predictor, 0x20), 1);
+
+    // Ties go to whatever we saw last.
+    TEST_PREDICT_CHECK(&predictor, "[", "0x10 0x20 0x17 0x16", 0);
+    TEST_PREDICT_CHECK(&predictor, "[0x11", "", 0);
+    TEST_PREDICT_CHECK(&predictor, "[0x12", "0x12", 4);
+}
+
+static void test_predict_halving(void) {
+    PiratePredictor predictor;
+
+    pirate_predict_reset(&predictor);
+    test_predict_learn(&predictor, "[0xA0]", UINT8_MAX);
+    test_predict_learn(&predictor, "[0xB0]", 100);
+    test_predict_learn(&predictor, "[0xC0]", 3);
+    PIRATE_CHECK_EQUAL(test_predict_address_count(&predictor, 0xA0), UINT8_MAX);
+
+    // Rather than overflow, every count halves; the order stays as it was, and whatever's
+    // barely used fades towards nothing.
+    test_predict_learn(&predictor, "[0xA0]", 1);
+    PIRATE_CHECK_EQUAL(test_predict_address_count(&predictor, 0xA0), 128);
+    PIRATE_CHECK_EQUAL(test_predict_address_count(&predictor, 0xB0), 50);
+    PIRATE_CHECK_EQUAL(test_predict_address_count(&predictor, 0xC0), 1);
+    TEST_PREDICT_CHECK(&predictor, "[", "0xA0 0xB0 0xC0", 0);
+
+    // Which lets what we use now overtake what we used to.
+    test_predict_learn(&predictor, "[0xB0]", 79);
+    PIRATE_CHECK_EQUAL(test_predict_address_count(&predictor, 0xB0), 129);
+    TEST_PREDICT_CHECK(&predictor, "[", "0xB0 0xA0 0xC0", 0);
+}
+
+int main(void) {
+    furi_log_set_level(FuriLogLevelNone);
+
+    PIRATE_TEST_RUN(test_predict_positions);
+    PIRATE_TEST_RUN(test_predict_previous);
+    PIRATE_TEST_RUN(test_predict_repeats);
+    PIRATE_TEST_RUN(test_predict_prefix);
+    PIRATE_TEST_RUN(test_predict_eviction);
+    PIRATE_TEST_RUN(test_predict_halving);
+
+    return pirate_test_finish("predict");
+}
@@ -0,0 +1,177 @@
+/**
+ * @file test_ring.c
+ * Tests for the byte ring, around the end of its storage and of its stream positions.
+ */
+
+#include <furi.h>
+
+#include "../../lib/pirate_ring.h"
+
+#include "pirate_test.h"
+
+#define TEST_RING_CAPACITY 16
+
+/** The byte at a given stream position; so anything read back can be checked against where it was. */
+static uint8_t test_ring_byte(uint32_t position) {
+    return (uint8_t)(position * 7 + 3);
+}
+
+static void test_ring_write_read_wrap(void) {
+    uint8_t storage[TEST_RING_CAPACITY];
+    uint8_t data[TEST_RING_CAPACITY];
+    PirateRing ring;
+    uint32_t written = 0;
+    uint32_t read = 0;
+
+    pirate_ring_init(&ring, storage, sizeof(storage));
+
+    // Chunk sizes that don't divide the capacity, so every offset into the storage gets a turn
+    // at being where a chunk wraps.
+    for(uint32_t round = 0; round < 64; ++round) {
+        uint32_t length = 1 + (round * 5) % (TEST_RING_CAPACITY - 1);
+
+        for(uint32_t i = 0; i < length; ++i) {
+            data[i] = test_ring_byte(written + i);
+        }
+        PIRATE_CHECK_EQUAL(pirate_ring_write(&ring, data, length), length);
+        written += length;
+        PIRATE_CHECK_EQUAL(pirate_ring_used(&ring), written - read);
+
+        uint32_t count = pirate_ring_read(&ring, data, length);
+        PIRATE_CHECK_EQUAL(count, length);
+        for(uint32_t i = 0; i < count; ++i) {
+            if(data[i] != test_ring_byte(read + i)) {
+                PIRATE_CHECK_EQUAL(data[i], test_ring_byte(read + i));
+                break;
+            }
+        }
+        read += count;
+    }
+
+    PIRATE_CHECK_EQUAL(pirate_ring_head(&ring), written);
+    PIRATE_CHECK_EQUAL(pirate_ring_used(&ring), 0);
+    PIRATE_CHECK_EQUAL(pirate_ring_space(&ring), TEST_RING_CAPACITY);
+}
+
+static void test_ring_full(void) {
+    uint8_t storage[TEST_RING_CAPACITY];
+    uint8_t data[TEST_RING_CAPACITY * 2];
+    PirateRing ring;
+
+    pirate_ring_init(&ring, storage, sizeof(storage));
+    for(uint32_t i = 0; i < sizeof(data); ++i) {
+        data[i] = test_ring_byte(i);
+    }
+
+    // Only what fits is taken; the rest is the caller's to keep.
+    PIRATE_CHECK_EQUAL(pirate_ring_write(&ring, data, 10), 10);
+    PIRATE_CHECK_EQUAL(pirate_ring_write(&ring, &data[10], 10), 6);
+    PIRATE_CHECK_EQUAL(pirate_ring_space(&ring), 0);
+    PIRATE_CHECK(!pirate_ring_put(&ring, 0xFF));
+
+    // Freeing a little lets exactly that much back in, at the start of the storage.
+    uint8_t out[TEST_RING_CAPACITY];
+    PIRATE_CHECK_EQUAL(pirate_ring_read(&ring, out, 3), 3);
+    PIRATE_CHECK(pirate_ring_put(&ring, data[16]));
+    PIRATE_CHECK_EQUAL(pirate_ring_write(&ring, &data[17], 10), 2);
+    PIRATE_CHECK(!pirate_ring_put(&ring, 0xFF));
+
+    PIRATE_CHECK_EQUAL(pirate_ring_read(&ring, out, sizeof(out)), TEST_RING_CAPACITY);
+    PIRATE_CHECK_BYTES(out, TEST_RING_CAPACITY, &data[3], TEST_RING_CAPACITY);
+}
+
+static void test_ring_peek_wrap(void) {
+    uint8_t storage[TEST_RING_CAPACITY];
+    uint8_t data[TEST_RING_CAPACITY];
+    const uint8_t* run;
+    PirateRing ring;
+
+    pirate_ring_init(&ring, storage, sizeof(storage));
+    for(uint32_t i = 0; i < sizeof(data); ++i) {
+        data[i] = test_ring_byte(i);
+    }
+
+    // Leave the unread bytes straddling the end of the storage.
+    pirate_ring_write(&ring, data, 12);
+    pirate_ring_consume(&ring, 12);
+    pirate_ring_write(&ring, data, 10);
+
+    // The first run stops at the end of the storage; the second picks up at its start.
+    PIRATE_CHECK_EQUAL(pirate_ring_peek_contiguous(&ring, &run), 4);
+    PIRATE_CHECK(run == &storage[12]);
+    PIRATE_CHECK_BYTES(run, 4, data, 4);
+    PIRATE_CHECK_EQUAL(pirate_ring_consume(&ring, 4), 4);
+
+    PIRATE_CHECK_EQUAL(pirate_ring_peek_contiguous(&ring, &run), 6);
+    PIRATE_CHECK(run == &storage[0]);
+    PIRATE_CHECK_BYTES(run, 6, &data[4], 6);
+
+    // Consuming more than's there only takes what is.
+    PIRATE_CHECK_EQUAL(pirate_ring_consume(&ring, 100), 6);
+    PIRATE_CHECK_EQUAL(pirate_ring_peek_contiguous(&ring, &run), 0);
+}
+
+static void test_ring_position_wrap(void) {
+    uint8_t storage[TEST_RING_CAPACITY];
+    uint8_t data[TEST_RING_CAPACITY];
+    uint8_t out[TEST_RING_CAPACITY];
+    PirateRing ring;
+
+    // Positions are 32-bit counts, which a long enough session runs past; used and space
+    // have to come out right across that, as well as across the end of the storage.
+    pirate_ring_init(&ring, storage, sizeof(storage));
+    ring.head = UINT32_MAX - 5;
+    ring.tail = UINT32_MAX - 5;
+
+    for(uint32_t i = 0; i < sizeof(data); ++i) {
+        data[i] = test_ring_byte(i);
+    }
+
+    PIRATE_CHECK_EQUAL(pirate_ring_write(&ring, data, 12), 12);
+    PIRATE_CHECK_EQUAL(pirate_ring_head(&ring), 6);
+    PIRATE_CHECK_EQUAL(pirate_ring_used(&ring), 12);
+    PIRATE_CHECK_EQUAL(pirate_ring_space(&ring), 4);
+
+    PIRATE_CHECK_EQUAL(pirate_ring_read(&ring, out, sizeof(out)), 12);
+    PIRATE_CHECK_BYTES(out, 12, data, 12);
+    PIRATE_CHECK_EQUAL(pirate_ring_used(&ring), 0);
+}
+
+static void test_ring_copy_at(void) {
+    uint8_t storage[TEST_RING_CAPACITY];
+    uint8_t data[40];
+    uint8_t out[TEST_RING_CAPACITY];
+    PirateRing ring;
+
+    pirate_ring_init(&ring, storage, sizeof(storage));
+    for(uint32_t i = 0; i < sizeof(data); ++i) {
+        data[i] = test_ring_byte(i);
+    }
+
+    // Consumed bytes can still be copied back out by position, until they're overwritten.
+    for(uint32_t position = 0; position < sizeof(data); position += 8) {
+        pirate_ring_write(&ring, &data[position], 8);
+        pirate_ring_consume(&ring, 8);
+    }
+
+    // Only the last capacity's worth, 24 to 39, is still held; and it wraps within the storage.
+    PIRATE_CHECK_EQUAL(pirate_ring_copy_at(&ring, 24, out, sizeof(out)), 16);
+    PIRATE_CHECK_BYTES(out, 16, &data[24], 16);
+    PIRATE_CHECK_EQUAL(pirate_ring_copy_at(&ring, 30, out, 4), 4);
+    PIRATE_CHECK_BYTES(out, 4, &data[30], 4);
+    PIRATE_CHECK_EQUAL(pirate_ring_copy_at(&ring, 36, out, sizeof(out)), 4);
+    PIRATE_CHECK_BYTES(out, 4, &data[36], 4);
+
+    PIRATE_CHECK_EQUAL(pirate_ring_copy_at(&ring, 23, out, sizeof(out)), 0);
+    PIRATE_CHECK_EQUAL(pirate_ring_copy_at(&ring, 40, out, sizeof(out)), 0);
+}
+
+int main(void) {
+    PIRATE_TEST_RUN(test_ring_write_read_wrap);
+    PIRATE_TEST_RUN(test_ring_full);
+    PIRATE_TEST_RUN(test_ring_peek_wrap);
+    PIRATE_TEST_RUN(test_ring_position_wrap);
+    PIRATE_TEST_RUN(test_ring_copy_at);
+
+    return pirate_test_finish("ring");
+}
@@ -3,3 +3,934 @@
 //
 
 #include "libpirate.h"
+
+#include <string.h>
+
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+/**
+ * Lexer.
+ */
+
+bool pirate_is_separator(char c) {
+    return (c == ' ') || (c == ',') || (c == '\t');
+}
+
+static bool pirate_is_word_character(char c) {
+    return ((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z'));
+}
+
+/** Returns the value of a digit in the given base, or -1 if it isn't one. */
+static int pirate_digit_value(char c, uint8_t base) {
+    int value = -1;
+
+    if((c >= '0') && (c <= '9')) {
+        value = c - '0';
+    } else if((c >= 'a') && (c <= 'f')) {
+        value = c - 'a' + 10;
+    } else if((c >= 'A') && (c <= 'F')) {
+        value = c - 'A' + 10;
+    }
+
+    return (value < base) ? value : -1;
+}
+
+/**
+ * Lexes a numeric literal starting at offset.
+ *
+ * @return The position immediately after the literal. Sets *valid to false if
+ *         the literal was malformed; in which case we've consumed the whole word.
+ */
+static size_t
+    pirate_lex_number(const char* text, size_t length, size_t offset, uint32_t* value, bool* valid) {
+    uint8_t base = 10;
+    size_t digits = 0;
+
+    *value = 0;
+    *valid = true;
+
+    // Figure out our base from any prefix.
+    if((offset + 1 < length) && (text[offset] == '0')) {
+        if((text[offset + 1] == 'x') || (text[offset + 1] == 'X')) {
+            base = 16;
+            offset += 2;
+        } else if((text[offset + 1] == 'b') || (text[offset + 1] == 'B')) {
+            base = 2;
+            offset += 2;
+        }
+    }
+
+    while((offset < length) && pirate_is_word_character(text[offset])) {
+        int digit = pirate_digit_value(text[offset], base);
+
+        // Anything that isn't a digit in our base poisons the whole word.
+        if(digit < 0) {
+            *valid = false;
+        } else if(*value > (UINT32_MAX - digit) / base) {
+            // Saturate, rather than wrapping; the compiler will flag this as too large.
+            *value = UINT32_MAX;
+        } else {
+            *value = (*value * base) + digit;
+        }
+
+        ++digits;
+        ++offset;
+    }
+
+    if(digits == 0) {
+        *valid = false;
+    }
+
+    return offset;
+}
+
+size_t pirate_lex_token(const char* text, size_t length, size_t offset, PirateToken* token) {
+    bool valid = true;
+    size_t end;
+
+    // Skip any separators; they only exist to delimit tokens.
+    while((offset < length) && pirate_is_separator(text[offset])) {
+        ++offset;
+    }
+
+    token->offset = offset;
+    token->length = 0;
+    token->value = 0;
+
+    if((offset >= length) || (text[offset] == 0)) {
+        token->type = PirateTokenEnd;
+        return offset;
+    }
+
+    end = offset + 1;
+
+    switch(text[offset]) {
+    case '[':
+        token->type = PirateTokenStart;
+        break;
+    case ']':
+        token->type = PirateTokenStop;
+        break;
+    case '{':
+        token->type = PirateTokenLoopBegin;
+        break;
+    case '}':
+        token->type = PirateTokenLoopEnd;
+        break;
+    case '&':
+        token->type = PirateTokenDelay;
+        break;
+    case ':':
+        token->type = PirateTokenRepeat;
+        end = pirate_lex_number(text, length, offset + 1, &token->value, &valid);
+        break;
+    case '@':
+        token->type = PirateTokenSpeed;
+        end = pirate_lex_number(text, length, offset + 1, &token->value, &valid);
+        break;
+
+    default:
+        // A lone 'r' is a read; but 'r' can't start any other word.
+        if(((text[offset] == 'r') || (text[offset] == 'R')) &&
+           ((end >= length) || !pirate_is_word_character(text[end]))) {
+            token->type = PirateTokenRead;
+        } else if((text[offset] >= '0') && (text[offset] <= '9')) {
+            token->type = PirateTokenValue;
+            end = pirate_lex_number(text, length, offset, &token->value, &valid);
+        } else {
+            valid = false;
+
+            // Swallow the rest of the word, so the error covers all of it.
+            while((end < length) && pirate_is_word_character(text[end])) {
+                ++end;
+            }
+        }
+        break;
+    }
+
+    if(!valid) {
+        token->type = PirateTokenInvalid;
+    }
+
+    token->length = end - offset;
+    return end;
+}
+
+/**
+ * Compiler.
+ */
+
+typedef struct {
+    /** Offset of the loop's PirateOpLoopBegin, and where in the text it started. */
+    uint16_t begin;
+    uint16_t text_offset;
+
+    /** The program's read count when the loop began; lets us scale reads by iterations. */
+    uint32_t read_count;
+} PirateCompilerLoop;
+
+typedef struct {
+    PirateProgram* program;
+
+    /** Offset of the opcode most recently emitted, or -1 if there isn't one. */
+    int32_t last_op;
+
+    /** Loops that are currently open. */
+    PirateCompilerLoop loops[PIRATE_LOOP_DEPTH];
+    uint8_t loop_depth;
+
+    /** Bytes read by a single pass through the most recently closed loop. */
+    uint32_t last_loop_reads;
+} PirateCompiler;
+
+static bool pirate_emit(PirateCompiler* compiler, const uint8_t* bytes, size_t count) {
+    PirateProgram* program = compiler->program;
+
+    // Always leave room for our terminating PirateOpEnd.
+    if(program->length + count >= PIRATE_PROGRAM_MAX_LENGTH) {
+        return false;
+    }
+
+    compiler->last_op = program->length;
+    memcpy(&program->code[program->length], bytes, count);
+    program->length += count;
+
+    return true;
+}
+
+static bool pirate_emit_u16_op(PirateCompiler* compiler, PirateOpcode opcode, uint16_t operand) {
+    uint8_t op[] = {opcode, operand & 0xFF, operand >> 8};
+    return pirate_emit(compiler, op, sizeof(op));
+}
+
+/** Appends a literal byte to the program, extending the current write run if we can. */
+static bool pirate_emit_write(PirateCompiler* compiler, uint8_t value) {
+    PirateProgram* program = compiler->program;
+
+    if((compiler->last_op >= 0) && (program->code[compiler->last_op] == PirateOpWrite) &&
+       (program->code[compiler->last_op + 1] < PIRATE_WRITE_RUN_MAX)) {
+        if(program->length + 1 >= PIRATE_PROGRAM_MAX_LENGTH) {
+            return false;
+        }
+
+        program->code[compiler->last_op + 1] += 1;
+        program->code[program->length++] = value;
+        return true;
+    }
+
+    uint8_t op[] = {PirateOpWrite, 1, value};
+    return pirate_emit(compiler, op, sizeof(op));
+}
+
+static uint16_t pirate_read_u16(const uint8_t* operand) {
+    return operand[0] | (operand[1] << 8);
+}
+
+/** Converts the last byte of the current write run into a PirateOpWriteRepeat. */
+static bool pirate_emit_write_repeat(PirateCompiler* compiler, uint16_t count) {
+    PirateProgram* program = compiler->program;
+    uint8_t* run = &program->code[compiler->last_op];
+    uint8_t value = program->code[program->length - 1];
+
+    // Pull the byte back out of its run; dropping the run entirely if that was all it held.
+    if(run[1] == 1) {
+        program->length = compiler->last_op;
+    } else {
+        run[1] -= 1;
+        program->length -= 1;
+    }
+
+    uint8_t op[] = {PirateOpWriteRepeat, value, count & 0xFF, count >> 8};
+    return pirate_emit(compiler, op, sizeof(op));
+}
+
+/** Applies a ':N' repeat to whatever was emitted by the previous token. */
+static PirateError
+    pirate_apply_repeat(PirateCompiler* compiler, PirateTokenType previous, uint32_t count) {
+    PirateProgram* program = compiler->program;
+    uint8_t* op;
+
+    if((count == 0) || (count > UINT16_MAX)) {
+        return PirateErrorValueTooLarge;
+    }
+
+    switch(previous) {
+    case PirateTokenRead:
+        op = &program->code[compiler->last_op];
+        program->read_count += count - 1;
+        op[1] = count & 0xFF;
+        op[2] = count >> 8;
+        return PirateErrorNone;
+
+    case PirateTokenDelay:
+        op = &program->code[compiler->last_op];
+        op[1] = count & 0xFF;
+        op[2] = count >> 8;
+        return PirateErrorNone;
+
+    case PirateTokenValue: {
+        // The value we're repeating is always the last byte we emitted.
+        uint8_t value = program->code[program->length - 1];
+
+        // Long repeats are executed natively, rather than being expanded into the program.
+        if(count >= PIRATE_WRITE_UNROLL_MAX) {
+            return pirate_emit_write_repeat(compiler, count) ? PirateErrorNone :
+                                                               PirateErrorProgramTooLong;
+        }
+
+        for(uint32_t i = 1; i < count; ++i) {
+            if(!pirate_emit_write(compiler, value)) {
+                return PirateErrorProgramTooLong;
+            }
+        }
+        return PirateErrorNone;
+    }
+
+    case PirateTokenLoopEnd: {
+        // Our last op is the PirateOpLoopEnd; its operand points back to where the count lives.
+        op = &program->code[pirate_read_u16(&program->code[compiler->last_op + 1])];
+        op[1] = count & 0xFF;
+        op[2] = count >> 8;
+
+        // Account for the reads of every extra pass through the loop.
+        uint64_t reads = program->read_count + (uint64_t)compiler->last_loop_reads * (count - 1);
+        program->read_count = (reads > UINT32_MAX) ? UINT32_MAX : reads;
+        return PirateErrorNone;
+    }
+
+    default:
+        return PirateErrorMisplacedRepeat;
+    }
+}
+
+PirateError pirate_compile(
+    const char* text,
+    size_t length,
+    PirateProgram* program,
+    size_t* error_offset) {
+    PirateCompiler compiler = {.program = program, .last_op = -1, .loop_depth = 0};
+    PirateTokenType previous = PirateTokenEnd;
+    PirateError error = PirateErrorNone;
+    PirateToken token;
+
+    // Position of the outermost unclosed '[', if any.
+    int32_t open_start = -1;
+    size_t position = 0;
+
+    program->hash = pirate_hash(text, length);
+    program->source_length = length;
+    program->read_count = 0;
+    program->length = 0;
+
+    do {
+        position = pirate_lex_token(text, length, position, &token);
+
+        switch(token.type) {
+        case PirateTokenEnd:
+            if(compiler.loop_depth > 0) {
+                token.offset = compiler.loops[compiler.loop_depth - 1].text_offset;
+                error = PirateErrorUnbalancedLoop;
+            } else if(open_start >= 0) {
+                token.offset = open_start;
+                error = PirateErrorUnbalancedStart;
+            }
+            break;
+
+        case PirateTokenStart:
+            // A second '[' inside a transaction is a repeated start.
+            if(open_start < 0) {
+                open_start = token.offset;
+            }
+            if(!pirate_emit(&compiler, (uint8_t[]){PirateOpStart}, 1)) {
+                error = PirateErrorProgramTooLong;
+            }
+            break;
+
+        case PirateTokenStop:
+            if(open_start < 0) {
+                error = PirateErrorUnbalancedStop;
+            } else if(!pirate_emit(&compiler, (uint8_t[]){PirateOpStop}, 1)) {
+                error = PirateErrorProgramTooLong;
+            }
+            open_start = -1;
+            break;
+
+        case PirateTokenValue:
+            if(token.value > 0xFF) {
+                error = PirateErrorValueTooLarge;
+            } else if(!pirate_emit_write(&compiler, token.value)) {
+                error = PirateErrorProgramTooLong;
+            }
+            break;
+
+        case PirateTokenRead:
+            program->read_count += 1;
+            if(!pirate_emit_u16_op(&compiler, PirateOpRead, 1)) {
+                error = PirateErrorProgramTooLong;
+            }
+            break;
+
+        case PirateTokenDelay:
+            if(!pirate_emit_u16_op(&compiler, PirateOpDelay, 1)) {
+                error = PirateErrorProgramTooLong;
+            }
+            break;
+
+        case PirateTokenRepeat:
+            error = pirate_apply_repeat(&compiler, previous, token.value);
+            break;
+
+        case PirateTokenSpeed:
+            if(token.value > UINT16_MAX) {
+                error = PirateErrorValueTooLarge;
+            } else if(!pirate_emit_u16_op(&compiler, PirateOpSpeed, token.value)) {
+                error = PirateErrorProgramTooLong;
+            }
+            break;
+
+        case PirateTokenLoopBegin: {
+            PirateCompilerLoop* loop = &compiler.loops[compiler.loop_depth];
+
+            if(compiler.loop_depth == PIRATE_LOOP_DEPTH) {
+                error = PirateErrorLoopTooDeep;
+                break;
+            }
+
+            loop->begin = program->length;
+            loop->text_offset = token.offset;
+            loop->read_count = program->read_count;
+
+            // Loops run once unless a ':N' follows their closing brace.
+            if(!pirate_emit_u16_op(&compiler, PirateOpLoopBegin, 1)) {
+                error = PirateErrorProgramTooLong;
+            }
+
+            compiler.loop_depth += 1;
+            break;
+        }
+
+        case PirateTokenLoopEnd: {
+            if(compiler.loop_depth == 0) {
+                error = PirateErrorUnbalancedLoop;
+                break;
+            }
+
+            PirateCompilerLoop* loop = &compiler.loops[--compiler.loop_depth];
+            compiler.last_loop_reads = program->read_count - loop->read_count;
+
+            if(!pirate_emit_u16_op(&compiler, PirateOpLoopEnd, loop->begin)) {
+                error = PirateErrorProgramTooLong;
+            }
+            break;
+        }
+
+        case PirateTokenInvalid:
+            error = PirateErrorInvalidToken;
+            break;
+        }
+
+        previous = token.type;
+    } while((token.type != PirateTokenEnd) && (error == PirateErrorNone));
+
+    if(error != PirateErrorNone) {
+        if(error_offset) {
+            *error_offset = token.offset;
+        }
+        program->length = 0;
+        return error;
+    }
+
+    program->code[program->length] = PirateOpEnd;
+    return PirateErrorNone;
+}
+
+/**
+ * Returns where the last of the text's top-level pieces that ends by the limit ends; or zero if
+ * none does. A piece ends after a token that leaves no transaction or loop open, unless a ':N'
+ * follows to repeat it.
+ */
+static size_t pirate_last_piece_end(const char* text, size_t length, size_t limit) {
+    PirateToken token;
+    size_t piece_end = 0;
+    size_t candidate = 0;
+    size_t position = 0;
+    uint32_t loop_depth = 0;
+    bool open = false;
+
+    do {
+        position = pirate_lex_token(text, length, position, &token);
+
+        if((candidate > 0) && (token.type != PirateTokenRepeat)) {
+            if(candidate > limit) {
+                break;
+            }
+            piece_end = candidate;
+        }
+        candidate = 0;
+
+        switch(token.type) {
+        case PirateTokenStart:
+            open = true;
+            break;
+        case PirateTokenStop:
+            open = false;
+            break;
+        case PirateTokenLoopBegin:
+            loop_depth += 1;
+            break;
+        case PirateTokenLoopEnd:
+            loop_depth -= (loop_depth > 0);
+            break;
+        default:
+            break;
+        }
+
+        if(!open && (loop_depth == 0) && (token.type != PirateTokenEnd)) {
+            candidate = position;
+        }
+    } while(token.type != PirateTokenEnd);
+
+    return piece_end;
+}
+
+PirateError pirate_compile_part(
+    const char* text,
+    size_t length,
+    PirateProgram* program,
+    size_t* consumed,
+    size_t* error_offset) {
+    size_t offset = 0;
+    PirateError error = pirate_compile(text, length, program, &offset);
+
+    *consumed = length;
+
+    // Everything up to the token that didn't fit did; so a prefix ending before it will too.
+    if(error == PirateErrorProgramTooLong) {
+        size_t end = pirate_last_piece_end(text, length, offset);
+
+        if(end > 0) {
+            *consumed = end;
+            error = pirate_compile(text, end, program, &offset);
+        }
+    }
+
+    if((error != PirateErrorNone) && error_offset) {
+        *error_offset = offset;
+    }
+    return error;
+}
+
+/**
+ * Interpreter.
+ */
+
+typedef struct {
+    /** Offset of the loop's PirateOpLoopBegin. */
+    uint16_t begin;
+
+    /** Iterations left, including the current one. */
+    uint16_t remaining;
+} PirateExecLoop;
+
+typedef struct {
+    const PirateProgram* program;
+    const PirateBus* bus;
+    const PirateSink* sink;
+
+    PirateExecLoop loops[PIRATE_LOOP_DEPTH];
+    uint8_t loop_depth;
+
+    uint32_t transactions;
+    uint32_t bytes_written;
+
+    /** True from a transaction's first start, until its stop. */
+    bool in_transaction;
+} PirateExecution;
+
+/** Returns the size of the instruction at the given offset, including its operands. */
+static size_t pirate_instruction_size(const PirateProgram* program, size_t offset) {
+    switch(program->code[offset]) {
+    case PirateOpWrite:
+        return 2 + program->code[offset + 1];
+    case PirateOpRead:
+    case PirateOpDelay:
+    case PirateOpLoopBegin:
+    case PirateOpLoopEnd:
+    case PirateOpSpeed:
+        return 3;
+    case PirateOpWriteRepeat:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+/**
+ * Figures out what follows a transfer, following loops as they'll actually execute.
+ * Delays and loop bookkeeping don't count, as they don't touch the bus.
+ */
+static PirateBusNext
+    pirate_next_transfer(const PirateExecution* execution, size_t offset, PirateOpcode current) {
+    const PirateProgram* program = execution->program;
+
+    // Loops we've entered during this scan, and the executing loop a scan-time '}' refers to.
+    uint8_t entered = 0;
+    int level = execution->loop_depth - 1;
+
+    // A loop with no transfers in it would otherwise have us spinning; once we've looked at
+    // more instructions than the program has, let every loop fall through.
+    size_t budget = program->length;
+
+    offset += pirate_instruction_size(program, offset);
+
+    while(true) {
+        uint8_t opcode = program->code[offset];
+
+        switch(opcode) {
+        case PirateOpWrite:
+        case PirateOpWriteRepeat:
+            return ((current == PirateOpWrite) || (current == PirateOpWriteRepeat)) ?
+                       PirateBusNextContinue :
+                       PirateBusNextRestart;
+        case PirateOpRead:
+            return (current == PirateOpRead) ? PirateBusNextContinue : PirateBusNextRestart;
+        case PirateOpStart:
+            return PirateBusNextRestart;
+        case PirateOpStop:
+        case PirateOpEnd:
+            return PirateBusNextStop;
+
+        case PirateOpLoopBegin:
+            entered += 1;
+            break;
+
+        case PirateOpLoopEnd: {
+            uint16_t begin = pirate_read_u16(&program->code[offset + 1]);
+            uint16_t remaining;
+
+            // Loops we entered mid-scan are on their first pass; others we can ask the executor about.
+            if(entered) {
+                remaining = pirate_read_u16(&program->code[begin + 1]);
+            } else {
+                remaining = (level >= 0) ? execution->loops[level].remaining : 1;
+            }
+
+            if(budget && (remaining > 1)) {
+                offset = begin;
+            } else if(entered) {
+                entered -= 1;
+            } else {
+                level -= 1;
+            }
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        budget = budget ? budget - 1 : 0;
+        offset += pirate_instruction_size(program, offset);
+    }
+}
+
+static PirateExecStatus pirate_execute_read(PirateExecution* execution, size_t offset) {
+    const PirateBus* bus = execution->bus;
+    const PirateSink* sink = execution->sink;
+
+    uint8_t chunk[PIRATE_READ_CHUNK];
+    uint16_t remaining = pirate_read_u16(&execution->program->code[offset + 1]);
+    PirateBusNext next = pirate_next_transfer(execution, offset, PirateOpRead);
+
+    // Long reads are broken up, so we can hand data off as it arrives and respond to aborts.
+    while(remaining) {
+        size_t length = MIN(remaining, sizeof(chunk));
+        remaining -= length;
+
+        if(!bus->read(bus->context, chunk, length, remaining ? PirateBusNextContinue : next)) {
+            return PirateExecBusError;
+        }
+        if(sink->data) {
+            sink->data(sink->context, chunk, length);
+        }
+        if(remaining && sink->should_abort && sink->should_abort(sink->context)) {
+            return PirateExecAborted;
+        }
+    }
+
+    return PirateExecOk;
+}
+
+static PirateExecStatus pirate_execute_write_repeat(PirateExecution* execution, size_t offset) {
+    const PirateBus* bus = execution->bus;
+    const uint8_t* op = &execution->program->code[offset];
+
+    uint8_t chunk[PIRATE_READ_CHUNK];
+    uint16_t remaining = pirate_read_u16(&op[2]);
+    PirateBusNext next = pirate_next_transfer(execution, offset, PirateOpWriteRepeat);
+
+    memset(chunk, op[1], MIN(remaining, sizeof(chunk)));
+
+    while(remaining) {
+        size_t length = MIN(remaining, sizeof(chunk));
+        remaining -= length;
+
+        if(!bus->write(bus->context, chunk, length, remaining ? PirateBusNextContinue : next)) {
+            return PirateExecBusError;
+        }
+        execution->bytes_written += length;
+    }
+
+    return PirateExecOk;
+}
+
+/** Executes a single instruction; updates *offset to point to the next one to execute. */
+static PirateExecStatus pirate_execute_instruction(PirateExecution* execution, size_t* offset) {
+    const PirateBus* bus = execution->bus;
+    const uint8_t* op = &execution->program->code[*offset];
+    PirateExecStatus status = PirateExecOk;
+
+    switch(op[0]) {
+    case PirateOpStart:
+        if(!execution->in_transaction && bus->prepare && (op[1] == PirateOpWrite)) {
+            bus->prepare(
+                bus->context, &op[3], op[2], pirate_next_transfer(execution, *offset + 1, PirateOpWrite));
+        }
+        if(!execution->in_transaction && execution->sink->transaction_begin) {
+            execution->sink->transaction_begin(execution->sink->context);
+        }
+        execution->in_transaction = true;
+
+        status = bus->start(bus->context) ? PirateExecOk : PirateExecBusError;
+        break;
+    case PirateOpStop:
+        status = bus->stop(bus->context) ? PirateExecOk : PirateExecBusError;
+
+        if(status == PirateExecOk) {
+            if(execution->in_transaction && execution->sink->transaction_end) {
+                execution->sink->transaction_end(execution->sink->context);
+            }
+            execution->in_transaction = false;
+            execution->transactions += 1;
+        }
+        break;
+    case PirateOpWrite:
+        status = bus->write(
+                     bus->context,
+                     &op[2],
+                     op[1],
+                     pirate_next_transfer(execution, *offset, PirateOpWrite)) ?
+                     PirateExecOk :
+                     PirateExecBusError;
+        if(status == PirateExecOk) {
+            execution->bytes_written += op[1];
+        }
+        break;
+    case PirateOpWriteRepeat:
+        status = pirate_execute_write_repeat(execution, *offset);
+        break;
+    case PirateOpRead:
+        status = pirate_execute_read(execution, *offset);
+        break;
+    case PirateOpDelay:
+        bus->delay_us(bus->context, pirate_read_u16(&op[1]));
+        break;
+    case PirateOpSpeed:
+        status = (bus->set_speed && bus->set_speed(bus->context, pirate_read_u16(&op[1]))) ?
+                     PirateExecOk :
+                     PirateExecBusError;
+        break;
+
+    case PirateOpLoopBegin: {
+        if(execution->loop_depth == PIRATE_LOOP_DEPTH) {
+            return PirateExecInvalidProgram;
+        }
+
+        PirateExecLoop* loop = &execution->loops[execution->loop_depth++];
+        loop->begin = *offset;
+        loop->remaining = pirate_read_u16(&op[1]);
+        break;
+    }
+
+    case PirateOpLoopEnd: {
+        if(execution->loop_depth == 0) {
+            return PirateExecInvalidProgram;
+        }
+
+        // Either jump back to the top of the loop body, or fall out of the loop.
+        PirateExecLoop* loop = &execution->loops[execution->loop_depth - 1];
+        if(--loop->remaining) {
+            *offset = loop->begin + pirate_instruction_size(execution->program, loop->begin);
+            return PirateExecOk;
+        }
+
+        execution->loop_depth -= 1;
+        break;
+    }
+
+    default:
+        return PirateExecInvalidProgram;
+    }
+
+    if(status == PirateExecOk) {
+        *offset += pirate_instruction_size(execution->program, *offset);
+    }
+
+    return status;
+}
+
+PirateExecStatus pirate_execute(
+    const PirateProgram* program,
+    const PirateBus* bus,
+    const PirateSink* sink,
+    PirateExecReport* report) {
+    PirateExecution execution = {
+        .program = program,
+        .bus = bus,
+        .sink = sink,
+        .loop_depth = 0,
+        .transactions = 0,
+        .bytes_written = 0,
+        .in_transaction = false,
+    };
+    PirateExecStatus status = PirateExecOk;
+    size_t offset = 0;
+
+    while((status == PirateExecOk) && (offset < program->length)) {
+        if(sink->should_abort && sink->should_abort(sink->context)) {
+            status = PirateExecAborted;
+            break;
+        }
+
+        status = pirate_execute_instruction(&execution, &offset);
+    }
+
+    if(report) {
+        report->error_offset = offset;
+        report->transactions = execution.transactions;
+        report->bytes_written = execution.bytes_written;
+    }
+
+    return status;
+}
+
+const char* pirate_exec_status_description(PirateExecStatus status) {
+    switch(status) {
+    case PirateExecOk:
+        return "OK";
+    case PirateExecBusError:
+        return "Bus error / NAK";
+    case PirateExecAborted:
+        return "Aborted";
+    case PirateExecInvalidProgram:
+        return "Invalid program";
+    }
+
+    return "Unknown status";
+}
+
+/**
+ * Program cache.
+ */
+
+uint32_t pirate_hash(const char* text, size_t length) {
+    // FNV-1a; cheap, and plenty good for a handful of short strings.
+    uint32_t hash = 2166136261u;
+
+    for(size_t i = 0; i < length; ++i) {
+        hash ^= (uint8_t)text[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+void pirate_cache_reset(PirateProgramCache* cache) {
+    memset(cache, 0, sizeof(*cache));
+}
+
+const PirateProgram* pirate_cache_get(
+    PirateProgramCache* cache,
+    const char* text,
+    PirateError* error,
+    size_t* error_offset) {
+    size_t length = strlen(text);
+    uint32_t hash = pirate_hash(text, length);
+    PirateCacheEntry* victim = &cache->entries[0];
+
+    cache->clock += 1;
+
+    // If we've compiled this command recently, we can skip straight to execution. The hash
+    // and length rule out almost every entry cheaply; the text itself has the final say.
+    for(size_t i = 0; i < PIRATE_CACHE_ENTRIES; ++i) {
+        PirateCacheEntry* entry = &cache->entries[i];
+
+        if(entry->valid && (entry->program.hash == hash) &&
+           (entry->program.source_length == length) && (memcmp(entry->source, text, length) == 0)) {
+            entry->last_used = cache->clock;
+            cache->hits += 1;
+
+            *error = PirateErrorNone;
+            return &entry->program;
+        }
+
+        // Otherwise, keep track of the least recently used slot, preferring empty ones.
+        if(!victim->valid) {
+            continue;
+        }
+        if(!entry->valid || (entry->last_used < victim->last_used)) {
+            victim = entry;
+        }
+    }
+
+    // Miss; compile to one side, and only replace the slot we're evicting if that worked.
+    cache->misses += 1;
+    *error = pirate_compile(text, length, &cache->scratch, error_offset);
+    if(*error != PirateErrorNone) {
+        return NULL;
+    }
+
+    // Commands too long to keep a copy of aren't kept at all.
+    if(length > PIRATE_CACHE_SOURCE_MAX) {
+        return &cache->scratch;
+    }
+
+    // Only as much of the code as there is; but with its PirateOpEnd, which the interpreter looks
+    // ahead to.
+    memcpy(
+        &victim->program,
+        &cache->scratch,
+        offsetof(PirateProgram, code) + cache->scratch.length + 1);
+    memcpy(victim->source, text, length);
+    victim->valid = true;
+    victim->last_used = cache->clock;
+
+    return &victim->program;
+}
+
+const char* pirate_error_description(PirateError error) {
+    switch(error) {
+    case PirateErrorNone:
+        return "OK";
+    case PirateErrorInvalidToken:
+        return "Invalid token";
+    case PirateErrorValueTooLarge:
+        return "Value out of range";
+    case PirateErrorMisplacedRepeat:
+        return "Nothing to repeat";
+    case PirateErrorUnbalancedStart:
+        return "Unclosed [";
+    case PirateErrorUnbalancedStop:
+        return "] without [";
+    case PirateErrorProgramTooLong:
+        return "Command too long";
+    case PirateErrorUnbalancedLoop:
+        return "Unbalanced { }";
+    case PirateErrorLoopTooDeep:
+        return "Loops nested too deeply";
+    }
+
+    return "Unknown error";
+}
@@ -5,4 +5,297 @@
 #ifndef UNLEASHED_FIRMWARE_LIBPIRATE_H
 #define UNLEASHED_FIRMWARE_LIBPIRATE_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Largest compiled program we'll produce, in bytes of bytecode. */
+#define PIRATE_PROGRAM_MAX_LENGTH 384
+
+/** Number of compiled programs we keep around for re-use. */
+#define PIRATE_CACHE_ENTRIES 8
+
+/** Longest command, in characters, the cache keeps a program for; longer ones compile every time. */
+#define PIRATE_CACHE_SOURCE_MAX 128
+
+/** Largest number of bytes a single PirateOpWrite can carry. */
+#define PIRATE_WRITE_RUN_MAX 255
+
+/** Reads are handed to the bus (and to the sink) in chunks of at most this many bytes. */
+#define PIRATE_READ_CHUNK 64
+
+/** How deeply '{' loops may be nested. */
+#define PIRATE_LOOP_DEPTH 4
+
+/** Repeated writes shorter than this are simply unrolled. */
+#define PIRATE_WRITE_UNROLL_MAX 8
+
+/**
+ * Bytecode instructions.
+ *
+ * Multi-byte operands are little endian. Consecutive literal bytes are packed
+ * into a single write, so a typical I2C transaction compiles to a handful of ops.
+ */
+typedef enum {
+    PirateOpEnd = 0x00, //< end of program
+    PirateOpStart, //< bus start / chip select; no operands
+    PirateOpStop, //< bus stop / chip deselect; no operands
+    PirateOpWrite, //< <count:u8> <bytes...>
+    PirateOpRead, //< <count:u16>
+    PirateOpDelay, //< <microseconds:u16>
+    PirateOpWriteRepeat, //< <value:u8> <count:u16>
+    PirateOpLoopBegin, //< <iterations:u16>
+    PirateOpLoopEnd, //< <offset of matching PirateOpLoopBegin:u16>
+    PirateOpSpeed, //< <kilohertz:u16>
+} PirateOpcode;
+
+/** Lexical tokens of the Bus Pirate command syntax. */
+typedef enum {
+    PirateTokenEnd, //< end of input
+    PirateTokenStart, //< '['
+    PirateTokenStop, //< ']'
+    PirateTokenValue, //< 0x.., 0b.., or decimal literal
+    PirateTokenRead, //< 'r'
+    PirateTokenDelay, //< '&'
+    PirateTokenRepeat, //< ':N', applied to the previous token
+    PirateTokenLoopBegin, //< '{'
+    PirateTokenLoopEnd, //< '}'; takes a ':N' to loop N times
+    PirateTokenSpeed, //< '@N'; sets the bus clock to N kHz, or with '@0', picks it automatically
+    PirateTokenInvalid, //< anything we couldn't make sense of
+} PirateTokenType;
+
+typedef struct {
+    PirateTokenType type;
+
+    /** Position and extent of the token within the source text. */
+    uint16_t offset;
+    uint16_t length;
+
+    /** Numeric value, for values and repeats. */
+    uint32_t value;
+} PirateToken;
+
+typedef enum {
+    PirateErrorNone,
+    PirateErrorInvalidToken,
+    PirateErrorValueTooLarge,
+    PirateErrorMisplacedRepeat,
+    PirateErrorUnbalancedStart,
+    PirateErrorUnbalancedStop,
+    PirateErrorProgramTooLong,
+    PirateErrorUnbalancedLoop,
+    PirateErrorLoopTooDeep,
+} PirateError;
+
+/** A compiled command, ready to be handed to a bus. */
+typedef struct {
+    /** Hash and length of the source text this program was compiled from. */
+    uint32_t hash;
+    uint16_t source_length;
+
+    /** Total number of bytes the program will read from the bus, across all loop iterations. */
+    uint32_t read_count;
+
+    uint16_t length;
+    uint8_t code[PIRATE_PROGRAM_MAX_LENGTH];
+} PirateProgram;
+
+typedef struct {
+    PirateProgram program;
+
+    /** The text the program was compiled from; a matching hash is only a hint. */
+    char source[PIRATE_CACHE_SOURCE_MAX];
+
+    uint32_t last_used;
+    bool valid;
+} PirateCacheEntry;
+
+/** What follows a transfer; buses like I2C need to know this to end a transfer correctly. */
+typedef enum {
+    PirateBusNextContinue, //< more data follows, in the same direction
+    PirateBusNextRestart, //< a repeated start, or a change of direction, follows
+    PirateBusNextStop, //< a stop, or the end of the program, follows
+} PirateBusNext;
+
+/** A bus that programs can be executed against. */
+typedef struct {
+    /** Optional; claims and releases the underlying hardware around a run. */
+    void (*acquire)(void* context);
+    void (*release)(void* context);
+
+    /**
+     * Optional; called ahead of each transaction, before the sink hears of it, with the
+     * transaction's first write and what follows that write, if it opens with one. Lets a bus
+     * get ready for the device about to be addressed without that counting as the transaction's.
+     */
+    void (*prepare)(void* context, const uint8_t* data, size_t length, PirateBusNext next);
+
+    bool (*start)(void* context);
+    bool (*stop)(void* context);
+    bool (*write)(void* context, const uint8_t* data, size_t length, PirateBusNext next);
+    bool (*read)(void* context, uint8_t* data, size_t length, PirateBusNext next);
+    void (*delay_us)(void* context, uint32_t microseconds);
+
+    /**
+     * Optional; sets the bus clock for what follows, to the fastest rate the bus has that
+     * doesn't exceed the one asked for. Returns false if it can't go that slow; programs
+     * that set a speed on a bus without this fail there. Zero asks the bus to pick its own
+     * clock, device by device; buses that can't fail it, as they would any speed too slow.
+     */
+    bool (*set_speed)(void* context, uint32_t kilohertz);
+
+    void* context;
+} PirateBus;
+
+/** Receives the results of an execution. */
+typedef struct {
+    /** Called with each chunk of data read from the bus. */
+    void (*data)(void* context, const uint8_t* data, size_t length);
+
+    /** Optional; polled between operations, so long runs can be cancelled. */
+    bool (*should_abort)(void* context);
+
+    /**
+     * Optional; called just before each transaction's first start, and just after its stop,
+     * so transactions can be timed. Repeated starts within a transaction aren't reported.
+     */
+    void (*transaction_begin)(void* context);
+    void (*transaction_end)(void* context);
+
+    void* context;
+} PirateSink;
+
+/** Statistics and diagnostics from a single execution. */
+typedef struct {
+    /** Bytecode offset of the operation that failed, if any. */
+    size_t error_offset;
+
+    /** Number of bus transactions (i.e. stops) completed. */
+    uint32_t transactions;
+
+    /** Number of bytes the bus accepted from us. */
+    uint32_t bytes_written;
+} PirateExecReport;
+
+typedef enum {
+    PirateExecOk,
+    PirateExecBusError, //< the bus reported a failure, such as a NAK
+    PirateExecAborted, //< the sink asked us to stop
+    PirateExecInvalidProgram,
+} PirateExecStatus;
+
+/** Small LRU cache of compiled programs, keyed by their source; the hash only narrows the search. */
+typedef struct {
+    PirateCacheEntry entries[PIRATE_CACHE_ENTRIES];
+    uint32_t clock;
+
+    /** Where misses are compiled; so a command that doesn't compile evicts nothing. */
+    PirateProgram scratch;
+
+    /** Statistics, for the curious. */
+    uint32_t hits;
+    uint32_t misses;
+} PirateProgramCache;
+
+/** Returns true if the character only separates tokens; tokens never span one. */
+bool pirate_is_separator(char c);
+
+/**
+ * Reads a single token from the given text.
+ *
+ * @param text      The command text. Need not be null terminated.
+ * @param length    The length of the command text.
+ * @param offset    The position to start lexing from; leading separators are skipped.
+ * @param token     Populated with the token found.
+ * @return The position immediately after the token.
+ */
+size_t pirate_lex_token(const char* text, size_t length, size_t offset, PirateToken* token);
+
+/**
+ * Compiles a command string into bytecode.
+ *
+ * @param text          The command text.
+ * @param length        The length of the command text.
+ * @param program       The program to populate.
+ * @param error_offset  If non-null, populated with the text offset of any error.
+ * @return PirateErrorNone on success, or the reason compilation failed.
+ */
+PirateError pirate_compile(
+    const char* text,
+    size_t length,
+    PirateProgram* program,
+    size_t* error_offset);
+
+/**
+ * Compiles as much of a command as fits in one program; for commands too long to compile whole.
+ *
+ * The program stops between two of the command's top-level pieces -- whole transactions and
+ * loops, with any repeat; and delays, speeds or writes outside of both -- so the rest can be
+ * compiled and run after it, to the same effect.
+ *
+ * @param text          The command text.
+ * @param length        The length of the command text.
+ * @param program       The program to populate.
+ * @param consumed      Populated with how much of the text the program covers.
+ * @param error_offset  If non-null, populated with the text offset of any error.
+ * @return PirateErrorNone on success, or the reason compilation failed; PirateErrorProgramTooLong
+ *         only if the first piece is too long by itself.
+ */
+PirateError pirate_compile_part(
+    const char* text,
+    size_t length,
+    PirateProgram* program,
+    size_t* consumed,
+    size_t* error_offset);
+
+/** Returns the hash used to key the program cache. */
+uint32_t pirate_hash(const char* text, size_t length);
+
+/** Empties a program cache. */
+void pirate_cache_reset(PirateProgramCache* cache);
+
+/**
+ * Fetches the compiled program for a command, compiling it only if we haven't seen it recently.
+ *
+ * @param cache         The cache to search.
+ * @param text          The null-terminated command text.
+ * @param error         Populated with the compile result.
+ * @param error_offset  If non-null, populated with the text offset of any error.
+ * @return The compiled program, or NULL if the command doesn't compile.
+ *         Valid until the next call into the cache.
+ */
+const PirateProgram* pirate_cache_get(
+    PirateProgramCache* cache,
+    const char* text,
+    PirateError* error,
+    size_t* error_offset);
+
+/**
+ * Runs a compiled program against a bus. Does not acquire or release the bus.
+ *
+ * @param program       The program to execute.
+ * @param bus           The bus to execute against.
+ * @param sink          Receives any data read.
+ * @param report        If non-null, populated with statistics about the run.
+ */
+PirateExecStatus pirate_execute(
+    const PirateProgram* program,
+    const PirateBus* bus,
+    const PirateSink* sink,
+    PirateExecReport* report);
+
+/** Returns a short, human-readable description of an execution result. */
+const char* pirate_exec_status_description(PirateExecStatus status);
+
+/** Returns a short, human-readable description of a compile error. */
+const char* pirate_error_description(PirateError error);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif //UNLEASHED_FIRMWARE_LIBPIRATE_H
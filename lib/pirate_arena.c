@@ -0,0 +1,66 @@
+//
+// Fixed-size bump allocator.
+//
+
+#include "pirate_arena.h"
+
+#include <string.h>
+
+/** Every block starts on a boundary fit for any type. */
+#define PIRATE_ARENA_ALIGNMENT _Alignof(max_align_t)
+
+static size_t pirate_arena_align(size_t size) {
+    return (size + PIRATE_ARENA_ALIGNMENT - 1) & ~(PIRATE_ARENA_ALIGNMENT - 1);
+}
+
+void pirate_arena_init(PirateArena* arena, void* storage, size_t capacity) {
+    uintptr_t start = (uintptr_t)storage;
+    size_t skip = pirate_arena_align(start) - start;
+
+    // Give up any unaligned lead-in, so every offset we hand out is aligned too.
+    skip = (skip > capacity) ? capacity : skip;
+    arena->storage = (uint8_t*)storage + skip;
+    arena->capacity = capacity - skip;
+    arena->used = 0;
+    arena->high_water = 0;
+}
+
+void* pirate_arena_alloc(PirateArena* arena, size_t size) {
+    size_t aligned = pirate_arena_align(size);
+
+    if((aligned < size) || (aligned > arena->capacity - arena->used)) {
+        return NULL;
+    }
+
+    void* block = &arena->storage[arena->used];
+    memset(block, 0, size);
+
+    arena->used += aligned;
+    if(arena->used > arena->high_water) {
+        arena->high_water = arena->used;
+    }
+
+    return block;
+}
+
+size_t pirate_arena_mark(const PirateArena* arena) {
+    return arena->used;
+}
+
+void pirate_arena_release(PirateArena* arena, size_t mark) {
+    if(mark < arena->used) {
+        arena->used = mark;
+    }
+}
+
+size_t pirate_arena_used(const PirateArena* arena) {
+    return arena->used;
+}
+
+size_t pirate_arena_high_water(const PirateArena* arena) {
+    return arena->high_water;
+}
+
+size_t pirate_arena_capacity(const PirateArena* arena) {
+    return arena->capacity;
+}
@@ -0,0 +1,61 @@
+//
+// Fixed-size bump allocator.
+//
+
+#ifndef UNLEASHED_FIRMWARE_PIRATE_ARENA_H
+#define UNLEASHED_FIRMWARE_PIRATE_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A region of memory handed out front to back, and handed back in reverse. Nothing is ever
+ * freed on its own; instead, callers take a mark, allocate, and release back to the mark.
+ *
+ * The arena keeps the most it's ever had handed out, so we can see how close to full it's run.
+ * It does no locking; only one thread may allocate from it at a time.
+ */
+typedef struct {
+    uint8_t* storage;
+    size_t capacity;
+
+    /** Bytes currently handed out; and the most that ever have been. */
+    size_t used;
+    size_t high_water;
+} PirateArena;
+
+/** Sets up an empty arena over the given storage. */
+void pirate_arena_init(PirateArena* arena, void* storage, size_t capacity);
+
+/**
+ * Hands out a zeroed block, aligned for any type.
+ *
+ * @return The block; or NULL if there's not enough room left, in which case nothing changes.
+ */
+void* pirate_arena_alloc(PirateArena* arena, size_t size);
+
+/** Returns a mark, which pirate_arena_release() can later roll the arena back to. */
+size_t pirate_arena_mark(const PirateArena* arena);
+
+/** Hands back everything allocated since the given mark was taken. */
+void pirate_arena_release(PirateArena* arena, size_t mark);
+
+/** Returns the number of bytes currently handed out. */
+size_t pirate_arena_used(const PirateArena* arena);
+
+/** Returns the most bytes that have ever been handed out at once. */
+size_t pirate_arena_high_water(const PirateArena* arena);
+
+/** Returns the size of the arena. */
+size_t pirate_arena_capacity(const PirateArena* arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //UNLEASHED_FIRMWARE_PIRATE_ARENA_H
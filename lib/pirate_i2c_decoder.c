@@ -0,0 +1,64 @@
+//
+// Decodes I2C traffic from samples of its two lines.
+//
+
+#include "pirate_i2c_decoder.h"
+
+/** Eight data bits, and the acknowledge bit that follows them. */
+#define PIRATE_I2C_BITS_PER_BYTE 9
+
+void pirate_i2c_decoder_reset(PirateI2cDecoder* decoder) {
+    decoder->shift = 0;
+    decoder->bit_count = 0;
+    decoder->in_transaction = false;
+    decoder->expect_address = false;
+}
+
+bool pirate_i2c_decoder_feed(PirateI2cDecoder* decoder, uint8_t sample, PirateI2cEvent* event) {
+    bool sda = sample & PIRATE_I2C_SAMPLE_SDA;
+
+    // Data only changes while SCL is low; so an SDA edge with SCL high is a start or a stop.
+    if(!(sample & PIRATE_I2C_SAMPLE_CLOCK)) {
+        if(!(sample & PIRATE_I2C_SAMPLE_SCL)) {
+            return false;
+        }
+
+        decoder->shift = 0;
+        decoder->bit_count = 0;
+
+        if(!sda) {
+            event->type = decoder->in_transaction ? PirateI2cEventRestart : PirateI2cEventStart;
+            decoder->in_transaction = true;
+            decoder->expect_address = true;
+            return true;
+        }
+
+        if(decoder->in_transaction) {
+            event->type = PirateI2cEventStop;
+            decoder->in_transaction = false;
+            return true;
+        }
+
+        return false;
+    }
+
+    // Otherwise, SCL has just risen, and SDA holds the next bit.
+    if(!decoder->in_transaction) {
+        return false;
+    }
+
+    decoder->shift = (decoder->shift << 1) | sda;
+    if(++decoder->bit_count < PIRATE_I2C_BITS_PER_BYTE) {
+        return false;
+    }
+
+    // The ninth bit is the acknowledge; a low there means the byte was accepted.
+    event->type = decoder->expect_address ? PirateI2cEventAddress : PirateI2cEventData;
+    event->value = decoder->shift >> 1;
+    event->ack = !(decoder->shift & 1);
+
+    decoder->shift = 0;
+    decoder->bit_count = 0;
+    decoder->expect_address = false;
+    return true;
+}
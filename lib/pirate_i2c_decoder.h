@@ -0,0 +1,68 @@
+//
+// Decodes I2C traffic from samples of its two lines.
+//
+
+#ifndef UNLEASHED_FIRMWARE_PIRATE_I2C_DECODER_H
+#define UNLEASHED_FIRMWARE_PIRATE_I2C_DECODER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Each sample is a single byte: the levels of both lines, taken just after an edge,
+ * and which line's edge it was taken on.
+ */
+#define PIRATE_I2C_SAMPLE_SCL (1 << 0)
+#define PIRATE_I2C_SAMPLE_SDA (1 << 1)
+
+/** Set if the sample was taken on a rising edge of SCL; clear if on any edge of SDA. */
+#define PIRATE_I2C_SAMPLE_CLOCK (1 << 2)
+
+typedef enum {
+    PirateI2cEventStart,
+    PirateI2cEventRestart,
+    PirateI2cEventStop,
+    PirateI2cEventAddress, //< the first byte after a start; value includes the R/W bit
+    PirateI2cEventData,
+} PirateI2cEventType;
+
+typedef struct {
+    PirateI2cEventType type;
+
+    /** For addresses and data: the byte, and whether it was acknowledged. */
+    uint8_t value;
+    bool ack;
+} PirateI2cEvent;
+
+typedef struct {
+    /** The bits of the current byte (and its ACK) clocked in so far. */
+    uint16_t shift;
+    uint8_t bit_count;
+
+    bool in_transaction;
+    bool expect_address;
+} PirateI2cDecoder;
+
+/** Forgets any transaction in progress. */
+void pirate_i2c_decoder_reset(PirateI2cDecoder* decoder);
+
+/**
+ * Feeds a single sample through the decoder.
+ *
+ * @param decoder   The decoder state.
+ * @param sample    The sample, made from the PIRATE_I2C_SAMPLE_ bits.
+ * @param event     Populated if the sample completes an event.
+ * @return True iff an event was produced.
+ */
+bool pirate_i2c_decoder_feed(PirateI2cDecoder* decoder, uint8_t sample, PirateI2cEvent* event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //UNLEASHED_FIRMWARE_PIRATE_I2C_DECODER_H
@@ -0,0 +1,97 @@
+//
+// Streaming latency statistics.
+//
+
+#include "pirate_latency.h"
+
+#include <string.h>
+
+/** Bits of each sample, below its leading one, that pick its sub-bucket. */
+#define PIRATE_LATENCY_SUB_BITS 2
+
+/** Returns the bucket a sample belongs in. */
+static uint32_t pirate_latency_bucket(uint32_t sample) {
+    // Small samples each get their own bucket...
+    if(sample < PIRATE_LATENCY_SUB_BUCKETS) {
+        return sample;
+    }
+
+    // ... and larger ones share buckets by their leading bits.
+    uint32_t magnitude = 31 - __builtin_clz(sample);
+    uint32_t sub_bucket = (sample >> (magnitude - PIRATE_LATENCY_SUB_BITS)) & (PIRATE_LATENCY_SUB_BUCKETS - 1);
+
+    return (magnitude - PIRATE_LATENCY_SUB_BITS + 1) * PIRATE_LATENCY_SUB_BUCKETS + sub_bucket;
+}
+
+/** Returns the largest sample that would land in the given bucket. */
+static uint32_t pirate_latency_bucket_limit(uint32_t bucket) {
+    if(bucket < PIRATE_LATENCY_SUB_BUCKETS) {
+        return bucket;
+    }
+
+    uint32_t magnitude = bucket / PIRATE_LATENCY_SUB_BUCKETS + PIRATE_LATENCY_SUB_BITS - 1;
+    uint32_t sub_bucket = bucket % PIRATE_LATENCY_SUB_BUCKETS;
+    uint32_t width = 1U << (magnitude - PIRATE_LATENCY_SUB_BITS);
+
+    // Computed as the last value, rather than one past it, so the top bucket doesn't overflow.
+    return ((PIRATE_LATENCY_SUB_BUCKETS + sub_bucket) * width) + (width - 1);
+}
+
+void pirate_latency_reset(PirateLatency* latency) {
+    memset(latency, 0, sizeof(*latency));
+    latency->min = UINT32_MAX;
+}
+
+void pirate_latency_record(PirateLatency* latency, uint32_t sample) {
+    latency->count += 1;
+    latency->total += sample;
+    latency->buckets[pirate_latency_bucket(sample)] += 1;
+
+    if(sample < latency->min) {
+        latency->min = sample;
+    }
+    if(sample > latency->max) {
+        latency->max = sample;
+    }
+}
+
+uint32_t pirate_latency_percentile(const PirateLatency* latency, uint8_t percentile) {
+    if(!latency->count) {
+        return 0;
+    }
+
+    // The rank of the sample we're after, counting from one.
+    uint64_t rank = ((uint64_t)latency->count * percentile + 99) / 100;
+    uint64_t seen = 0;
+
+    if(rank == 0) {
+        return latency->min;
+    }
+
+    for(uint32_t bucket = pirate_latency_bucket(latency->min); bucket < PIRATE_LATENCY_BUCKETS; ++bucket) {
+        seen += latency->buckets[bucket];
+
+        if(seen >= rank) {
+            uint32_t limit = pirate_latency_bucket_limit(bucket);
+            return (limit < latency->max) ? limit : latency->max;
+        }
+    }
+
+    return latency->max;
+}
+
+void pirate_latency_summarize(const PirateLatency* latency, PirateLatencySummary* summary) {
+    memset(summary, 0, sizeof(*summary));
+
+    if(!latency->count) {
+        return;
+    }
+
+    summary->count = latency->count;
+    summary->min = latency->min;
+    summary->mean = (uint32_t)(latency->total / latency->count);
+    summary->p50 = pirate_latency_percentile(latency, 50);
+    summary->p90 = pirate_latency_percentile(latency, 90);
+    summary->p99 = pirate_latency_percentile(latency, 99);
+    summary->max = latency->max;
+}
@@ -0,0 +1,70 @@
+//
+// Streaming latency statistics.
+//
+
+#ifndef UNLEASHED_FIRMWARE_PIRATE_LATENCY_H
+#define UNLEASHED_FIRMWARE_PIRATE_LATENCY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Buckets per power of two; percentiles are accurate to within one of these. */
+#define PIRATE_LATENCY_SUB_BUCKETS 4
+
+/** Enough buckets to cover the whole range of a 32-bit sample. */
+#define PIRATE_LATENCY_BUCKETS (32 * PIRATE_LATENCY_SUB_BUCKETS)
+
+/**
+ * Running statistics over a stream of samples, in whatever units the caller likes.
+ *
+ * Samples aren't kept; instead they're counted into a log-linear histogram, so percentiles
+ * come out within a quarter-octave of the truth, however many samples we see.
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+
+    uint32_t buckets[PIRATE_LATENCY_BUCKETS];
+} PirateLatency;
+
+/** A snapshot of the interesting parts of a PirateLatency. */
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t mean;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+} PirateLatencySummary;
+
+/** Forgets every sample seen so far. */
+void pirate_latency_reset(PirateLatency* latency);
+
+/** Adds a single sample. */
+void pirate_latency_record(PirateLatency* latency, uint32_t sample);
+
+/**
+ * Estimates a percentile of the samples seen so far.
+ *
+ * @param percentile    The percentile to find, from 0 to 100.
+ * @return The largest value that could be in the percentile's bucket, clamped to the samples
+ *         actually seen; or zero if there are no samples.
+ */
+uint32_t pirate_latency_percentile(const PirateLatency* latency, uint8_t percentile);
+
+/** Summarizes the samples seen so far; every value is zero if there aren't any. */
+void pirate_latency_summarize(const PirateLatency* latency, PirateLatencySummary* summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //UNLEASHED_FIRMWARE_PIRATE_LATENCY_H
@@ -0,0 +1,254 @@
+//
+// Command completion, learned from the commands we've run.
+//
+
+#include "pirate_predict.h"
+#include "libpirate.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+/** Returns true iff a is a better prediction than b: used more, or, failing that, more lately. */
+static bool pirate_predict_better(const PiratePredictEntry* a, const PiratePredictEntry* b) {
+    if(a->count != b->count) {
+        return a->count > b->count;
+    }
+    return (int16_t)(a->last_seen - b->last_seen) > 0;
+}
+
+/** Counts one more sighting of an entry; making room for it if it's new, and the table's full. */
+static void pirate_predict_count(
+    PiratePredictEntry* table,
+    uint8_t capacity,
+    uint8_t* size,
+    const PiratePredictEntry* seen) {
+    PiratePredictEntry* entry = NULL;
+
+    for(uint8_t i = 0; i < *size; ++i) {
+        if((table[i].address == seen->address) && (table[i].position == seen->position) &&
+           (table[i].previous == seen->previous) && (table[i].read == seen->read) &&
+           (table[i].value == seen->value)) {
+            entry = &table[i];
+            break;
+        }
+    }
+
+    if(entry == NULL) {
+        if(*size < capacity) {
+            entry = &table[(*size)++];
+        } else {
+            entry = &table[0];
+            for(uint8_t i = 1; i < capacity; ++i) {
+                if(pirate_predict_better(entry, &table[i])) {
+                    entry = &table[i];
+                }
+            }
+        }
+
+        *entry = *seen;
+        entry->count = 0;
+    }
+
+    // Rather than let a count overflow, halve them all; which keeps their order, and lets
+    // whatever we've stopped using fall away.
+    if(entry->count == UINT8_MAX) {
+        for(uint8_t i = 0; i < *size; ++i) {
+            table[i].count /= 2;
+        }
+    }
+
+    entry->count += 1;
+    entry->last_seen = seen->last_seen;
+}
+
+void pirate_predict_reset(PiratePredictor* predictor) {
+    memset(predictor, 0, sizeof(*predictor));
+}
+
+void pirate_predict_learn(PiratePredictor* predictor, const char* command) {
+    const size_t length = strlen(command);
+    PiratePredictEntry seen = {0};
+    PirateToken token;
+    size_t offset = 0;
+
+    // Anything past the depth we predict to, or that isn't a plain byte or read, ends what we learn
+    // of a transaction; -1 means we're not in one we're learning from. A read ends it too, as
+    // nothing's keyed on one.
+    int16_t position = -1;
+    uint8_t previous = 0;
+
+    predictor->clock += 1;
+    seen.last_seen = predictor->clock;
+
+    while(true) {
+        offset = pirate_lex_token(command, length, offset, &token);
+        if(token.type == PirateTokenEnd) {
+            break;
+        }
+
+        // A repeated start begins a transaction of its own; often to a different address.
+        if(token.type == PirateTokenStart) {
+            position = 0;
+            continue;
+        }
+        if((position < 0) || (position > PIRATE_PREDICT_DEPTH)) {
+            continue;
+        }
+
+        if((token.type == PirateTokenValue) && (token.value <= UINT8_MAX)) {
+            seen.read = false;
+            seen.value = token.value;
+        } else if(token.type == PirateTokenRead) {
+            PirateToken next;
+            size_t after = pirate_lex_token(command, length, offset, &next);
+
+            seen.read = true;
+            seen.value = 1;
+            if((next.type == PirateTokenRepeat) && next.value && (next.value <= UINT16_MAX)) {
+                seen.value = next.value;
+                offset = after;
+            }
+        } else if((token.type == PirateTokenRepeat) && (position > 0)) {
+            // A repeated byte; we've counted it once, which is enough to suggest it.
+            continue;
+        } else {
+            position = -1;
+            continue;
+        }
+
+        if(position == 0) {
+            if(seen.read) {
+                position = -1;
+                continue;
+            }
+
+            seen.address = 0;
+            seen.position = 0;
+            seen.previous = 0;
+            pirate_predict_count(
+                predictor->addresses, PIRATE_PREDICT_ADDRESSES, &predictor->address_count, &seen);
+            seen.address = seen.value;
+        } else {
+            seen.position = position;
+            seen.previous = previous;
+            pirate_predict_count(
+                predictor->followers, PIRATE_PREDICT_FOLLOWERS, &predictor->follower_count, &seen);
+        }
+
+        previous = seen.value;
+        position = seen.read ? -1 : position + 1;
+    }
+}
+
+/** Writes out an entry the way it'd be typed. */
+static void pirate_predict_format(const PiratePredictEntry* entry, char* text, size_t size) {
+    if(!entry->read) {
+        snprintf(text, size, "0x%02X", (unsigned)entry->value);
+    } else if(entry->value == 1) {
+        snprintf(text, size, "r");
+    } else {
+        snprintf(text, size, "r:%u", (unsigned)entry->value);
+    }
+}
+
+/** Returns true iff the text starts with the given prefix, ignoring case. */
+static bool pirate_predict_has_prefix(const char* text, const char* prefix, size_t prefix_length) {
+    for(size_t i = 0; i < prefix_length; ++i) {
+        if(tolower((unsigned char)text[i]) != tolower((unsigned char)prefix[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void pirate_predict(
+    const PiratePredictor* predictor,
+    const char* text,
+    size_t length,
+    PiratePredictions* predictions) {
+    const PiratePredictEntry* best[PIRATE_PREDICT_MAX];
+    PirateToken token;
+    size_t offset = 0;
+    uint8_t address = 0;
+    uint8_t previous = 0;
+    uint8_t position = 0;
+
+    predictions->count = 0;
+    predictions->replace = 0;
+
+    // Whatever word is half-typed at the end is what we're completing; it's not context.
+    size_t prefix = length;
+    while((prefix > 0) && (isalnum((unsigned char)text[prefix - 1]) || (text[prefix - 1] == ':'))) {
+        --prefix;
+    }
+    if(length - prefix >= PIRATE_PREDICT_TEXT_MAX) {
+        return;
+    }
+
+    // The context is the transaction's start, and the plain bytes that follow it.
+    offset = pirate_lex_token(text, prefix, offset, &token);
+    if(token.type != PirateTokenStart) {
+        return;
+    }
+
+    while(true) {
+        offset = pirate_lex_token(text, prefix, offset, &token);
+        if(token.type == PirateTokenEnd) {
+            break;
+        }
+
+        if((token.type == PirateTokenRepeat) && (position > 0)) {
+            continue;
+        }
+
+        // Only bytes lead anywhere; after a read, anything goes.
+        if((token.type != PirateTokenValue) || (token.value > UINT8_MAX) ||
+           (++position > PIRATE_PREDICT_DEPTH)) {
+            return;
+        }
+
+        address = (position == 1) ? token.value : address;
+        previous = token.value;
+    }
+
+    const PiratePredictEntry* table = position ? predictor->followers : predictor->addresses;
+    const uint8_t size = position ? predictor->follower_count : predictor->address_count;
+    char candidate[PIRATE_PREDICT_TEXT_MAX];
+    uint8_t count = 0;
+
+    // Keep the best few that fit, in order; the tables are small enough to just walk.
+    for(uint8_t i = 0; i < size; ++i) {
+        const PiratePredictEntry* entry = &table[i];
+
+        if((entry->position != position) ||
+           (position && ((entry->address != address) || (entry->previous != previous)))) {
+            continue;
+        }
+
+        pirate_predict_format(entry, candidate, sizeof(candidate));
+        if(!pirate_predict_has_prefix(candidate, &text[prefix], length - prefix)) {
+            continue;
+        }
+
+        uint8_t slot = count;
+        while((slot > 0) && pirate_predict_better(entry, best[slot - 1])) {
+            if(slot < PIRATE_PREDICT_MAX) {
+                best[slot] = best[slot - 1];
+            }
+            --slot;
+        }
+
+        if(slot < PIRATE_PREDICT_MAX) {
+            best[slot] = entry;
+            count += (count < PIRATE_PREDICT_MAX) ? 1 : 0;
+        }
+    }
+
+    for(uint8_t i = 0; i < count; ++i) {
+        pirate_predict_format(best[i], predictions->text[i], sizeof(predictions->text[i]));
+    }
+
+    predictions->count = count;
+    predictions->replace = length - prefix;
+}
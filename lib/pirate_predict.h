@@ -0,0 +1,98 @@
+//
+// Command completion, learned from the commands we've run.
+//
+
+#ifndef UNLEASHED_FIRMWARE_PIRATE_PREDICT_H
+#define UNLEASHED_FIRMWARE_PIRATE_PREDICT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Addresses we keep counts for; and things we've seen follow them. */
+#define PIRATE_PREDICT_ADDRESSES 8
+#define PIRATE_PREDICT_FOLLOWERS 32
+
+/** How far into a transaction, counting from its address, we learn and predict. */
+#define PIRATE_PREDICT_DEPTH 2
+
+/** Most predictions offered at once; and the longest one, "r:65535", with its null. */
+#define PIRATE_PREDICT_MAX 4
+#define PIRATE_PREDICT_TEXT_MAX 8
+
+/** Something we've seen at a given place in a transaction; and how often, and how lately. */
+typedef struct {
+    /** The transaction's address; unused for the addresses themselves. */
+    uint8_t address;
+
+    /** 0 for the address; 1 for what came right after it, and so on. */
+    uint8_t position;
+
+    /** The byte just before it; the address itself, for whatever came right after that. */
+    uint8_t previous;
+
+    /** Either a byte written, or a read of this many bytes. */
+    bool read;
+    uint16_t value;
+
+    uint8_t count;
+    uint16_t last_seen;
+} PiratePredictEntry;
+
+/**
+ * Counts of the addresses our transactions go to, and of what we write or read right after
+ * them. Everything is fixed-size: once a table's full, its least used entry makes way; and
+ * counts are halved before they overflow, so old habits fade.
+ */
+typedef struct {
+    PiratePredictEntry addresses[PIRATE_PREDICT_ADDRESSES];
+    uint8_t address_count;
+
+    PiratePredictEntry followers[PIRATE_PREDICT_FOLLOWERS];
+    uint8_t follower_count;
+
+    /** Commands learned so far; breaks ties in favour of whatever we saw last. */
+    uint16_t clock;
+} PiratePredictor;
+
+/** What might come next, best first. */
+typedef struct {
+    /** Characters at the end of the text that each prediction would replace: the partial word being typed. */
+    uint8_t replace;
+
+    uint8_t count;
+    char text[PIRATE_PREDICT_MAX][PIRATE_PREDICT_TEXT_MAX];
+} PiratePredictions;
+
+/** Forgets everything learned. */
+void pirate_predict_reset(PiratePredictor* predictor);
+
+/** Counts the addresses, and what follows them, in each of a command's transactions. */
+void pirate_predict_learn(PiratePredictor* predictor, const char* command);
+
+/**
+ * Predicts what comes next in a transaction.
+ *
+ * Right after its '[', that's an address; after the address, the bytes and reads that have
+ * followed it before; and after one of those bytes, what's followed that byte at that address.
+ * Only predictions that start with any partial word at the end of the text are offered.
+ *
+ * @param text      The transaction so far, from its '[' up to the cursor.
+ * @param length    The length of the text.
+ * @param predictions Populated with the predictions; count is zero if there are none.
+ */
+void pirate_predict(
+    const PiratePredictor* predictor,
+    const char* text,
+    size_t length,
+    PiratePredictions* predictions);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //UNLEASHED_FIRMWARE_PIRATE_PREDICT_H
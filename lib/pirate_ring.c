@@ -0,0 +1,130 @@
+//
+// Single-producer, single-consumer byte ring.
+//
+
+#include "pirate_ring.h"
+
+#include <string.h>
+
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+/**
+ * Each side reads the other's index with acquire semantics, and publishes its own with release
+ * semantics; so data copied in is always visible before the index that covers it.
+ */
+#define pirate_ring_load(index) __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+#define pirate_ring_store(index, value) __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+
+void pirate_ring_init(PirateRing* ring, uint8_t* storage, uint32_t capacity) {
+    ring->storage = storage;
+    ring->capacity = capacity;
+    pirate_ring_reset(ring);
+}
+
+void pirate_ring_reset(PirateRing* ring) {
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+uint32_t pirate_ring_used(const PirateRing* ring) {
+    return pirate_ring_load(ring->head) - pirate_ring_load(ring->tail);
+}
+
+uint32_t pirate_ring_space(const PirateRing* ring) {
+    return ring->capacity - pirate_ring_used(ring);
+}
+
+uint32_t pirate_ring_head(const PirateRing* ring) {
+    return pirate_ring_load(ring->head);
+}
+
+/** Copies into the ring at the given position, handling the wrap. */
+static void
+    pirate_ring_copy_in(PirateRing* ring, uint32_t position, const uint8_t* data, uint32_t length) {
+    uint32_t index = position & (ring->capacity - 1);
+    uint32_t first = MIN(length, ring->capacity - index);
+
+    memcpy(&ring->storage[index], data, first);
+    memcpy(ring->storage, data + first, length - first);
+}
+
+/** Copies out of the ring from the given position, handling the wrap. */
+static void pirate_ring_copy_out(
+    const PirateRing* ring,
+    uint32_t position,
+    uint8_t* data,
+    uint32_t length) {
+    uint32_t index = position & (ring->capacity - 1);
+    uint32_t first = MIN(length, ring->capacity - index);
+
+    memcpy(data, &ring->storage[index], first);
+    memcpy(data + first, ring->storage, length - first);
+}
+
+uint32_t pirate_ring_write(PirateRing* ring, const uint8_t* data, uint32_t length) {
+    uint32_t head = ring->head;
+    uint32_t space = pirate_ring_space(ring);
+    uint32_t count = MIN(length, space);
+
+    pirate_ring_copy_in(ring, head, data, count);
+    pirate_ring_store(ring->head, head + count);
+
+    return count;
+}
+
+bool pirate_ring_put(PirateRing* ring, uint8_t data) {
+    uint32_t head = ring->head;
+
+    if(head - pirate_ring_load(ring->tail) == ring->capacity) {
+        return false;
+    }
+
+    ring->storage[head & (ring->capacity - 1)] = data;
+    pirate_ring_store(ring->head, head + 1);
+    return true;
+}
+
+uint32_t pirate_ring_read(PirateRing* ring, uint8_t* data, uint32_t length) {
+    uint32_t tail = ring->tail;
+    uint32_t used = pirate_ring_used(ring);
+    uint32_t count = MIN(length, used);
+
+    pirate_ring_copy_out(ring, tail, data, count);
+    pirate_ring_store(ring->tail, tail + count);
+
+    return count;
+}
+
+uint32_t pirate_ring_peek_contiguous(const PirateRing* ring, const uint8_t** data) {
+    uint32_t tail = ring->tail;
+    uint32_t index = tail & (ring->capacity - 1);
+
+    uint32_t used = pirate_ring_used(ring);
+
+    *data = &ring->storage[index];
+    return MIN(used, ring->capacity - index);
+}
+
+uint32_t pirate_ring_consume(PirateRing* ring, uint32_t length) {
+    uint32_t used = pirate_ring_used(ring);
+    uint32_t count = MIN(length, used);
+
+    pirate_ring_store(ring->tail, ring->tail + count);
+    return count;
+}
+
+uint32_t
+    pirate_ring_copy_at(const PirateRing* ring, uint32_t position, uint8_t* data, uint32_t length) {
+    uint32_t head = pirate_ring_load(ring->head);
+    uint32_t oldest = (head > ring->capacity) ? head - ring->capacity : 0;
+
+    if((position < oldest) || (position >= head)) {
+        return 0;
+    }
+
+    length = MIN(length, head - position);
+    pirate_ring_copy_out(ring, position, data, length);
+    return length;
+}
@@ -0,0 +1,85 @@
+//
+// Single-producer, single-consumer byte ring.
+//
+
+#ifndef UNLEASHED_FIRMWARE_PIRATE_RING_H
+#define UNLEASHED_FIRMWARE_PIRATE_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Lock-free byte ring, safe for exactly one producer and one consumer running concurrently
+ * (including one of them running in interrupt context).
+ *
+ * Positions are absolute stream offsets -- the number of bytes ever written or consumed --
+ * which lets callers refer to data by where it appeared in the stream.
+ */
+typedef struct {
+    uint8_t* storage;
+
+    /** Size of storage; must be a power of two. */
+    uint32_t capacity;
+
+    /** Total bytes ever written; only ever modified by the producer. */
+    uint32_t head;
+
+    /** Total bytes ever consumed; only ever modified by the consumer. */
+    uint32_t tail;
+} PirateRing;
+
+/** Sets up a ring around the given storage, whose size must be a power of two. */
+void pirate_ring_init(PirateRing* ring, uint8_t* storage, uint32_t capacity);
+
+/** Empties the ring, and restarts its positions from zero. Not safe against concurrent access. */
+void pirate_ring_reset(PirateRing* ring);
+
+/** Returns the number of bytes waiting to be consumed. */
+uint32_t pirate_ring_used(const PirateRing* ring);
+
+/** Returns the number of bytes that can be written without overrunning the consumer. */
+uint32_t pirate_ring_space(const PirateRing* ring);
+
+/** Returns the total number of bytes ever written. */
+uint32_t pirate_ring_head(const PirateRing* ring);
+
+/** Producer: copies in as much of data as fits. Returns the number of bytes written. */
+uint32_t pirate_ring_write(PirateRing* ring, const uint8_t* data, uint32_t length);
+
+/** Producer: adds a single byte, if there's room; cheap enough to call per interrupt. */
+bool pirate_ring_put(PirateRing* ring, uint8_t data);
+
+/** Consumer: copies out up to length bytes. Returns the number of bytes read. */
+uint32_t pirate_ring_read(PirateRing* ring, uint8_t* data, uint32_t length);
+
+/**
+ * Consumer: returns a pointer to the next contiguous run of unconsumed bytes, without consuming them.
+ * Pair with pirate_ring_consume() to drain the ring without an intermediate copy.
+ */
+uint32_t pirate_ring_peek_contiguous(const PirateRing* ring, const uint8_t** data);
+
+/** Consumer: marks up to length bytes as consumed. Returns the number of bytes consumed. */
+uint32_t pirate_ring_consume(PirateRing* ring, uint32_t length);
+
+/**
+ * Copies out bytes by stream position, whether or not they've been consumed.
+ *
+ * Only the most recent `capacity` bytes are still held; positions older than that,
+ * or not yet written, are skipped. Meant for use once the producer has gone quiet;
+ * an active producer may overwrite the oldest bytes mid-copy.
+ *
+ * @return The number of bytes copied, starting from position.
+ */
+uint32_t
+    pirate_ring_copy_at(const PirateRing* ring, uint32_t position, uint8_t* data, uint32_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //UNLEASHED_FIRMWARE_PIRATE_RING_H
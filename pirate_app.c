@@ -3,6 +3,13 @@
 const char* TAG = "Pirate";
 
 #include "scene/scenes.h"
+#include "scene/scene_command.h"
+#include "scene/scene_eeprom.h"
+#include "scene/scene_scan.h"
+#include "scene/scene_sniff.h"
+#include "scene/scene_bridge.h"
+#include "scene/scene_bbio.h"
+#include "scene/scene_onewire.h"
 
 void pirate_reset_command(PirateApp* app) {
     // Populate a default command, for convenience.
@@ -12,7 +19,7 @@ void pirate_reset_command(PirateApp* app) {
     app->command[3] = 0;
 
     // Restore our protective terminal null, just in case.
-    app->command[128] = 0;
+    app->command[PIRATE_COMMAND_MAX_LENGTH] = 0;
 }
 
 
@@ -48,6 +55,45 @@ PirateApp *alloc_pirate_app() {
 
     app->submenu = submenu_alloc();
     app->input = pirate_input_alloc();
+    pirate_input_set_frame_event(app->input, app->view_dispatcher, PirateInputFrameDrawn);
+    app->widget = widget_alloc();
+    app->scan_grid = pirate_scan_grid_alloc();
+    app->sniff_log = pirate_sniff_log_alloc();
+    app->bridge_meter = pirate_bridge_meter_alloc();
+    app->hex_dump = pirate_hex_dump_alloc();
+
+    app->history = pirate_history_alloc();
+
+    // Learn our habits from our recent commands, oldest first, so the latest count as latest.
+    // The command buffer isn't in use yet; it's filled in with its default below.
+    pirate_predict_reset(&app->predictor);
+    uint32_t learned = MIN(pirate_history_count(app->history), (uint32_t)PIRATE_PREDICT_SEED_COMMANDS);
+    for(uint32_t age = learned; age > 0; --age) {
+        if(pirate_history_get(app->history, age - 1, app->command, sizeof(app->command))) {
+            pirate_predict_learn(&app->predictor, app->command);
+        }
+    }
+
+    // Carve out everything our commands are compiled and run with, once, up front...
+    app->arena_storage = (uint8_t*)malloc(PIRATE_ARENA_SIZE);
+    pirate_arena_init(&app->arena, app->arena_storage, PIRATE_ARENA_SIZE);
+    app->programs = (PirateProgramCache*)pirate_arena_alloc(&app->arena, sizeof(PirateProgramCache));
+    furi_check(app->programs);
+    pirate_cache_reset(app->programs);
+
+    // ... and start our execution engine, which will report back via custom events.
+    app->results = pirate_result_store_alloc(&app->arena);
+    app->engine = pirate_engine_alloc(app->view_dispatcher, PirateCommandExecuted, app->results, &app->arena);
+    app->eeprom = pirate_eeprom_dump_alloc(app->view_dispatcher, PirateEepromDumpProgress, PirateEepromDumpComplete);
+    app->eeprom_part = NULL;
+    app->scanner = pirate_scanner_alloc(app->view_dispatcher, PirateScanComplete);
+    app->sniffer = pirate_sniffer_alloc(app->view_dispatcher, PirateSniffUpdated);
+    app->bridge = pirate_bridge_alloc(app->view_dispatcher, PirateBridgeUpdated);
+    app->bbio = pirate_bbio_alloc(app->view_dispatcher, PirateBbioUpdated);
+    app->onewire_scanner = pirate_onewire_scanner_alloc(app->view_dispatcher, PirateOneWireSearchComplete);
+
+    app->dialogs = furi_record_open(RECORD_DIALOGS);
+    app->script_path = furi_string_alloc_set_str(PIRATE_SCRIPT_DIRECTORY);
 
     // Start off with no active command.
     pirate_reset_command(app);
@@ -62,6 +108,11 @@ PirateApp *alloc_pirate_app() {
     // Add each of our views, so we can display them.
     view_dispatcher_add_view(app->view_dispatcher, PirateSubmenuView, submenu_get_view(app->submenu));
     view_dispatcher_add_view(app->view_dispatcher, PirateInputView, pirate_input_get_view(app->input));
+    view_dispatcher_add_view(app->view_dispatcher, PirateWidgetView, widget_get_view(app->widget));
+    view_dispatcher_add_view(app->view_dispatcher, PirateScanView, pirate_scan_grid_get_view(app->scan_grid));
+    view_dispatcher_add_view(app->view_dispatcher, PirateSniffView, pirate_sniff_log_get_view(app->sniff_log));
+    view_dispatcher_add_view(app->view_dispatcher, PirateBridgeView, pirate_bridge_meter_get_view(app->bridge_meter));
+    view_dispatcher_add_view(app->view_dispatcher, PirateHexDumpView, pirate_hex_dump_get_view(app->hex_dump));
 
 
     return app;
@@ -74,6 +125,21 @@ void free_pirate_app(PirateApp *app) {
     // Remove all of our possible active views...
     view_dispatcher_remove_view(app->view_dispatcher, PirateSubmenuView);
     view_dispatcher_remove_view(app->view_dispatcher, PirateInputView);
+    view_dispatcher_remove_view(app->view_dispatcher, PirateWidgetView);
+    view_dispatcher_remove_view(app->view_dispatcher, PirateScanView);
+    view_dispatcher_remove_view(app->view_dispatcher, PirateSniffView);
+    view_dispatcher_remove_view(app->view_dispatcher, PirateBridgeView);
+    view_dispatcher_remove_view(app->view_dispatcher, PirateHexDumpView);
+
+    // Stop our engine before anything it might report to goes away.
+    pirate_engine_free(app->engine);
+    pirate_eeprom_dump_free(app->eeprom);
+    pirate_scanner_free(app->scanner);
+    pirate_sniffer_free(app->sniffer);
+    pirate_bridge_free(app->bridge);
+    pirate_bbio_free(app->bbio);
+    pirate_onewire_scanner_free(app->onewire_scanner);
+    pirate_result_store_free(app->results);
 
     // ... and free our app state.
     scene_manager_free(app->scene_manager);
@@ -81,7 +147,17 @@ void free_pirate_app(PirateApp *app) {
 
     submenu_free(app->submenu);
     pirate_input_free(app->input);
+    widget_free(app->widget);
+    pirate_scan_grid_free(app->scan_grid);
+    pirate_sniff_log_free(app->sniff_log);
+    pirate_bridge_meter_free(app->bridge_meter);
+    pirate_hex_dump_free(app->hex_dump);
 
+    furi_string_free(app->script_path);
+    furi_record_close(RECORD_DIALOGS);
+
+    pirate_history_free(app->history);
+    free(app->arena_storage);
     free(app);
 }
 
@@ -11,18 +11,62 @@
 #include <gui/modules/submenu.h>
 #include <gui/modules/text_input.h>
 
+#include <dialogs/dialogs.h>
+#include <storage/storage.h>
+
 #include "lib/libpirate.h"
+#include "lib/pirate_arena.h"
+#include "lib/pirate_predict.h"
+#include "pirate_eeprom.h"
+#include "pirate_engine.h"
+#include "pirate_history.h"
+#include "pirate_result.h"
+#include "pirate_scan.h"
+#include "pirate_script.h"
+#include "pirate_sniffer.h"
+#include "pirate_bridge.h"
+#include "pirate_bbio.h"
+#include "pirate_onewire.h"
 
 #include "scene/scenes.h"
 #include "views.h"
 
 #include "pirate_icons.h"
 #include "pirate_input.h"
+#include "pirate_scan_grid.h"
+#include "pirate_sniff_log.h"
+#include "pirate_bridge_meter.h"
+#include "pirate_hex_dump.h"
+
+
+/** Longest command we can edit; long enough for multi-transaction scripts. */
+#define PIRATE_COMMAND_MAX_LENGTH 4096
+
+/**
+ * Memory reserved, at startup, for everything commands are compiled and run with: the program
+ * cache, the engine, and the result store; and whatever a run borrows on top. The Memory Usage
+ * screen shows how much of it's ever been needed.
+ */
+#define PIRATE_ARENA_SIZE 12288
+
+/** How many of our most recent commands we learn from at startup, to predict the next. */
+#define PIRATE_PREDICT_SEED_COMMANDS 64
 
+/** Log tag shared by the whole application. */
+extern const char* TAG;
 
 typedef enum {
     NoOperation,
-    I2COperation
+    I2COperation,
+    EepromDumpOperation,
+    ScanOperation,
+    ScriptOperation,
+    SniffOperation,
+    SPIOperation,
+    BridgeOperation,
+    BbioOperation,
+    OneWireOperation,
+    OneWireSearchOperation
 } OperationType;
 
 typedef struct {
@@ -37,13 +81,63 @@ typedef struct {
     /** Input capture machine. */
     PirateInput *input;
 
+    /** Generic widget, for presenting results. */
+    Widget *widget;
+
+    /** Page-at-a-time dump of whatever our last command read. */
+    PirateHexDump *hex_dump;
+
+    /** Runs our commands in the background. */
+    PirateEngine *engine;
+
+    /**
+     * Where our commands are compiled and run; nothing on that path touches the heap. Its
+     * storage is an allocation of its own, so the app never needs one block big enough for both.
+     */
+    PirateArena arena;
+    uint8_t *arena_storage;
+
     /** The buffer for the currently captured command. We allocate one extra so there's always a null. */
-    char command[129];
+    char command[PIRATE_COMMAND_MAX_LENGTH + 1];
     OperationType operation;
 
-    /** The buffer for the command result. */
-    uint8_t result[512];
-    uint16_t result_length;
+    /** Every command we've run, kept on the SD card. */
+    PirateHistory *history;
+
+    /** What our transactions usually look like; the editor's prediction bar offers it. */
+    PiratePredictor predictor;
+
+    /** Recently compiled commands, so re-running a command skips straight to execution. */
+    PirateProgramCache *programs;
+
+    /** Where the engine puts the data our commands read. */
+    PirateResultStore *results;
+
+    /** EEPROM dumper, and the part it's working on. */
+    PirateEepromDump *eeprom;
+    const PirateEepromPart *eeprom_part;
+
+    /** Bus scanner, and the grid that shows what it found. */
+    PirateScanner *scanner;
+    PirateScanGrid *scan_grid;
+
+    /** Bus sniffer, and the transcript of what it heard. */
+    PirateSniffer *sniffer;
+    PirateSniffLog *sniff_log;
+
+    /** USB-to-UART bridge, and its throughput meter. */
+    PirateBridge *bridge;
+    PirateBridgeMeter *bridge_meter;
+
+    /** Bus Pirate binary protocol, for host tools on USB. */
+    PirateBbio *bbio;
+
+    /** 1-Wire ROM search. */
+    PirateOneWireScanner *onewire_scanner;
+
+    /** File picker, and the script we last picked with it. */
+    DialogsApp *dialogs;
+    FuriString *script_path;
 
 } PirateApp;
 
@@ -0,0 +1,732 @@
+#include "pirate_bbio.h"
+
+#include "pirate_update.h"
+
+#include "bus/bus_i2c_bitbang.h"
+#include "bus/bus_spi.h"
+
+#include <furi_hal.h>
+#include <furi_hal_usb_cdc.h>
+
+#define PIRATE_BBIO_STACK_SIZE 2048
+
+/** Zero bytes in a row that take the terminal into binary mode. */
+#define PIRATE_BBIO_ENTRY_ZEROES 20
+
+/** The clock raw I2C runs at until the host picks one, in kHz. */
+#define PIRATE_BBIO_I2C_DEFAULT_SPEED 100
+
+/** Most a single bulk command moves. */
+#define PIRATE_BBIO_BULK_SIZE 16
+
+/** What the Bus Pirate's terminal prints on reset; tools read the versions back out of it. */
+static const char pirate_bbio_banner[] =
+    "\r\nBus Pirate v3.5\r\nFirmware v7.0 (Flipper Pirate)\r\nHiZ>";
+
+/** The rates each raw mode's speed command selects between, in kHz. */
+static const uint32_t pirate_bbio_spi_speeds[] = {30, 125, 250, 1000, 2000, 2600, 4000, 8000};
+static const uint32_t pirate_bbio_i2c_speeds[] = {5, 50, 100, 400};
+
+typedef enum {
+    PirateBbioFlagExit = (1 << 0),
+    PirateBbioFlagUsbReceived = (1 << 1),
+    PirateBbioFlagUsbSent = (1 << 2),
+    PirateBbioFlagUsbState = (1 << 3),
+} PirateBbioFlag;
+
+#define PIRATE_BBIO_FLAGS \
+    (PirateBbioFlagExit | PirateBbioFlagUsbReceived | PirateBbioFlagUsbSent | PirateBbioFlagUsbState)
+
+struct PirateBbio {
+    FuriThread* worker;
+
+    /** Where we report updates; and what we last reported. */
+    PirateUpdateNotifier updates;
+    uint32_t reported;
+
+    /** What we've taken over, and what we have to put back. */
+    FuriHalUsbInterface* usb_previous;
+    CdcCallbacks cdc_callbacks;
+
+    /** USB's state, as its interrupt last told us; and whether we've been told to stop. */
+    volatile bool connected;
+    bool exiting;
+
+    /** The host's last packet, and how far through it we are. */
+    uint8_t in[CDC_DATA_SZ];
+    size_t in_length;
+    size_t in_position;
+
+    /** Our answer so far; sent whenever it fills a packet, or we're left waiting on the host. */
+    uint8_t out[CDC_DATA_SZ];
+    size_t out_length;
+
+    /** Whether USB still has our last packet; and whether it was a full one, which leaves the transfer open. */
+    bool usb_busy;
+    bool usb_transfer_open;
+
+    PirateBbioMode mode;
+    uint8_t zeroes;
+
+    /** The buses the raw modes drive. */
+    PirateBus spi_bus;
+    PirateSpiBus spi;
+    PirateI2cBitbang i2c;
+
+    /** Data for the command at hand; big enough for a whole write-then-read. */
+    uint8_t buffer[PIRATE_BBIO_TRANSFER_SIZE];
+
+    uint32_t spi_bytes;
+    uint32_t i2c_bytes;
+    uint32_t errors;
+
+    /** Cycles spent transferring over SPI; wraps, but the rate window never spans that long. */
+    uint32_t spi_cycles;
+
+    /** Throughput, as of the end of the last rate window; and the counts it started from. */
+    uint32_t spi_rate;
+    uint32_t spi_bus_rate;
+    uint32_t window_start;
+    uint32_t window_spi_bytes;
+    uint32_t window_spi_cycles;
+
+    bool running;
+};
+
+/**
+ * Interrupt context: the USB endpoints.
+ */
+
+static void pirate_bbio_usb_tx_callback(void* context) {
+    PirateBbio* bbio = context;
+    furi_thread_flags_set(furi_thread_get_id(bbio->worker), PirateBbioFlagUsbSent);
+}
+
+static void pirate_bbio_usb_rx_callback(void* context) {
+    PirateBbio* bbio = context;
+    furi_thread_flags_set(furi_thread_get_id(bbio->worker), PirateBbioFlagUsbReceived);
+}
+
+static void pirate_bbio_usb_state_callback(void* context, CdcState state) {
+    PirateBbio* bbio = context;
+
+    bbio->connected = (state == CdcStateConnected);
+    furi_thread_flags_set(furi_thread_get_id(bbio->worker), PirateBbioFlagUsbState);
+}
+
+/**
+ * Reporting; from our worker.
+ */
+
+/** Closes the current rate window, if it's run its length; so the end-to-end rate falls back to zero once traffic stops. */
+static void pirate_bbio_update_rates(PirateBbio* bbio, uint32_t now) {
+    uint32_t elapsed = now - bbio->window_start;
+
+    if(elapsed < furi_ms_to_ticks(PIRATE_BBIO_RATE_WINDOW)) {
+        return;
+    }
+
+    uint32_t bytes = bbio->spi_bytes - bbio->window_spi_bytes;
+    uint32_t cycles = bbio->spi_cycles - bbio->window_spi_cycles;
+
+    bbio->spi_rate = (uint64_t)bytes * furi_kernel_get_tick_frequency() / elapsed;
+
+    // The bus' own rate is down to the clock the host picked; so it holds until there's more to measure.
+    if(cycles) {
+        bbio->spi_bus_rate =
+            (uint64_t)bytes * furi_hal_cortex_instructions_per_microsecond() * 1000000 / cycles;
+    }
+
+    bbio->window_spi_bytes = bbio->spi_bytes;
+    bbio->window_spi_cycles = bbio->spi_cycles;
+    bbio->window_start = now;
+}
+
+/** Changes whenever anything we report does; close enough, for deciding whether to redraw. */
+static uint32_t pirate_bbio_activity(PirateBbio* bbio) {
+    return bbio->spi_bytes + bbio->i2c_bytes + bbio->spi_rate + bbio->spi_bus_rate + bbio->errors +
+           bbio->spi.speed + bbio->i2c.speed + bbio->mode + bbio->connected;
+}
+
+static void pirate_bbio_report(PirateBbio* bbio) {
+    uint32_t now = furi_get_tick();
+    pirate_bbio_update_rates(bbio, now);
+
+    uint32_t activity = pirate_bbio_activity(bbio);
+    if((activity != bbio->reported) && pirate_update_notifier_request(&bbio->updates)) {
+        bbio->reported = activity;
+    }
+}
+
+/**
+ * Transport: bytes to and from the host, a packet at a time.
+ */
+
+/** Waits for something to happen: USB taking our packet, the host sending one, or being told to stop. */
+static void pirate_bbio_wait(PirateBbio* bbio) {
+    uint32_t flags = furi_thread_flags_wait(
+        PIRATE_BBIO_FLAGS, FuriFlagWaitAny, furi_ms_to_ticks(PIRATE_BBIO_UPDATE_INTERVAL));
+
+    if(!(flags & FuriFlagError)) {
+        if(flags & PirateBbioFlagExit) {
+            bbio->exiting = true;
+        }
+        if(flags & PirateBbioFlagUsbSent) {
+            bbio->usb_busy = false;
+        }
+    }
+
+    // An unplugged endpoint never finishes sending; there's nothing there to wait on.
+    if(!bbio->connected) {
+        bbio->usb_busy = false;
+    }
+
+    pirate_bbio_report(bbio);
+}
+
+/** Hands USB our answer so far, once it's done with the last. Returns false if we're stopping. */
+static bool pirate_bbio_flush(PirateBbio* bbio) {
+    if(!bbio->out_length && !bbio->usb_transfer_open) {
+        return true;
+    }
+
+    while(bbio->usb_busy && !bbio->exiting) {
+        pirate_bbio_wait(bbio);
+    }
+    if(bbio->exiting) {
+        return false;
+    }
+
+    // A full packet tells the host there's more to come; so if an answer ends on one, an empty
+    // packet has to follow it. With nobody to send to, the answer's just dropped.
+    if(bbio->connected) {
+        bbio->usb_transfer_open = (bbio->out_length == sizeof(bbio->out));
+        bbio->usb_busy = true;
+        furi_hal_cdc_send(PIRATE_BBIO_CDC_INTERFACE, bbio->out, bbio->out_length);
+    } else {
+        bbio->usb_transfer_open = false;
+    }
+
+    bbio->out_length = 0;
+    return true;
+}
+
+/** Adds to our answer. Returns false if we're stopping. */
+static bool pirate_bbio_put(PirateBbio* bbio, const void* data, size_t length) {
+    const uint8_t* bytes = data;
+
+    while(length) {
+        size_t chunk = MIN(length, sizeof(bbio->out) - bbio->out_length);
+
+        memcpy(&bbio->out[bbio->out_length], bytes, chunk);
+        bbio->out_length += chunk;
+        bytes += chunk;
+        length -= chunk;
+
+        if((bbio->out_length == sizeof(bbio->out)) && !pirate_bbio_flush(bbio)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool pirate_bbio_put_byte(PirateBbio* bbio, uint8_t data) {
+    return pirate_bbio_put(bbio, &data, 1);
+}
+
+/** Takes the next bytes the host sends, however long they take to come. Returns false if we're stopping. */
+static bool pirate_bbio_get(PirateBbio* bbio, uint8_t* data, size_t length) {
+    while(length) {
+        while(bbio->in_position == bbio->in_length) {
+            int32_t received = furi_hal_cdc_receive(PIRATE_BBIO_CDC_INTERFACE, bbio->in, sizeof(bbio->in));
+            if(received > 0) {
+                bbio->in_length = received;
+                bbio->in_position = 0;
+                pirate_bbio_report(bbio);
+                break;
+            }
+
+            // We're about to wait on the host; which may well be waiting on what we've said so far.
+            if(!pirate_bbio_flush(bbio)) {
+                return false;
+            }
+            pirate_bbio_wait(bbio);
+            if(bbio->exiting) {
+                return false;
+            }
+        }
+
+        size_t chunk = MIN(length, bbio->in_length - bbio->in_position);
+        memcpy(data, &bbio->in[bbio->in_position], chunk);
+        bbio->in_position += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    return true;
+}
+
+/** Reads a big-endian 16-bit length, as the write-then-read commands give them. */
+static bool pirate_bbio_get_length(PirateBbio* bbio, size_t* length) {
+    uint8_t bytes[2];
+
+    if(!pirate_bbio_get(bbio, bytes, sizeof(bytes))) {
+        return false;
+    }
+
+    *length = (bytes[0] << 8) | bytes[1];
+    return true;
+}
+
+/** Answers a command we couldn't carry out. */
+static bool pirate_bbio_fail(PirateBbio* bbio) {
+    bbio->errors += 1;
+    return pirate_bbio_put_byte(bbio, 0x00);
+}
+
+/**
+ * Modes.
+ */
+
+/** Hands back whatever bus the last mode had, and sets up the next's from its defaults. */
+static void pirate_bbio_set_mode(PirateBbio* bbio, PirateBbioMode mode) {
+    if(bbio->mode == PirateBbioModeSpi) {
+        bbio->spi_bus.release(bbio->spi_bus.context);
+    } else if(bbio->mode == PirateBbioModeI2c) {
+        pirate_i2c_bitbang_deinit(&bbio->i2c);
+    }
+
+    // Acquiring leaves CS high, and the clock at its default.
+    if(mode == PirateBbioModeSpi) {
+        bbio->spi_bus.acquire(bbio->spi_bus.context);
+    } else if(mode == PirateBbioModeI2c) {
+        pirate_i2c_bitbang_init(&bbio->i2c, PIRATE_BBIO_I2C_DEFAULT_SPEED, false);
+    }
+
+    bbio->mode = mode;
+}
+
+/** Just enough of the terminal for tools to find their way into binary mode, and to read our version. */
+static bool pirate_bbio_terminal(PirateBbio* bbio, uint8_t command) {
+    if(command) {
+        bbio->zeroes = 0;
+
+        switch(command) {
+        case '#':
+            return pirate_bbio_put(bbio, pirate_bbio_banner, strlen(pirate_bbio_banner));
+        case '\r':
+            return pirate_bbio_put(bbio, "\r\nHiZ>", 6);
+        default:
+            return true;
+        }
+    }
+
+    if(++bbio->zeroes < PIRATE_BBIO_ENTRY_ZEROES) {
+        return true;
+    }
+
+    bbio->zeroes = 0;
+    pirate_bbio_set_mode(bbio, PirateBbioModeBitbang);
+    return pirate_bbio_put(bbio, "BBIO1", 5);
+}
+
+static bool pirate_bbio_bitbang(PirateBbio* bbio, uint8_t command) {
+    switch(command) {
+    case 0x00:
+        return pirate_bbio_put(bbio, "BBIO1", 5);
+    case 0x01:
+        pirate_bbio_set_mode(bbio, PirateBbioModeSpi);
+        return pirate_bbio_put(bbio, "SPI1", 4);
+    case 0x02:
+        pirate_bbio_set_mode(bbio, PirateBbioModeI2c);
+        return pirate_bbio_put(bbio, "I2C1", 4);
+    case 0x0F:
+        pirate_bbio_set_mode(bbio, PirateBbioModeTerminal);
+        return pirate_bbio_put_byte(bbio, 0x01) &&
+               pirate_bbio_put(bbio, pirate_bbio_banner, strlen(pirate_bbio_banner));
+    default:
+        return pirate_bbio_fail(bbio);
+    }
+}
+
+/**
+ * Raw SPI.
+ */
+
+static void pirate_bbio_spi_select(PirateBbio* bbio, bool selected) {
+    furi_hal_gpio_write(bbio->spi.handle->cs, !selected);
+}
+
+/** Runs a transfer, counting its bytes and the time the bus took over them. */
+static bool pirate_bbio_spi_transfer(PirateBbio* bbio, const uint8_t* tx, uint8_t* rx, size_t length) {
+    if(!length) {
+        return true;
+    }
+
+    uint32_t start = DWT->CYCCNT;
+    bool success = pirate_spi_bus_transfer(&bbio->spi, tx, rx, length);
+
+    bbio->spi_cycles += DWT->CYCCNT - start;
+    bbio->spi_bytes += length;
+    return success;
+}
+
+/** 0001xxxx: exchanges 1-16 bytes, answering each with the byte that came back. */
+static bool pirate_bbio_spi_bulk(PirateBbio* bbio, size_t length) {
+    uint8_t* tx = bbio->buffer;
+    uint8_t* rx = &bbio->buffer[PIRATE_BBIO_BULK_SIZE];
+
+    if(!pirate_bbio_put_byte(bbio, 0x01) || !pirate_bbio_get(bbio, tx, length)) {
+        return false;
+    }
+
+    if(!pirate_bbio_spi_transfer(bbio, tx, rx, length)) {
+        bbio->errors += 1;
+    }
+    return pirate_bbio_put(bbio, rx, length);
+}
+
+/** 0x04 and 0x05: writes, then reads, up to 4 KiB each way; with or without chip select around them. */
+static bool pirate_bbio_spi_write_read(PirateBbio* bbio, bool chip_select) {
+    size_t write_length;
+    size_t read_length;
+
+    if(!pirate_bbio_get_length(bbio, &write_length) || !pirate_bbio_get_length(bbio, &read_length)) {
+        return false;
+    }
+
+    // As on the Bus Pirate, we refuse before taking any data.
+    if((write_length > sizeof(bbio->buffer)) || (read_length > sizeof(bbio->buffer))) {
+        return pirate_bbio_fail(bbio);
+    }
+    if(!pirate_bbio_get(bbio, bbio->buffer, write_length)) {
+        return false;
+    }
+
+    if(chip_select) {
+        pirate_bbio_spi_select(bbio, true);
+    }
+    bool success = pirate_bbio_spi_transfer(bbio, bbio->buffer, NULL, write_length) &&
+                   pirate_bbio_spi_transfer(bbio, NULL, bbio->buffer, read_length);
+    if(chip_select) {
+        pirate_bbio_spi_select(bbio, false);
+    }
+
+    if(!success) {
+        return pirate_bbio_fail(bbio);
+    }
+    return pirate_bbio_put_byte(bbio, 0x01) && pirate_bbio_put(bbio, bbio->buffer, read_length);
+}
+
+static bool pirate_bbio_spi(PirateBbio* bbio, uint8_t command) {
+    // 1000wxyz: output type, clock idle level, clock edge, sample point. Our pins are always
+    // push-pull, and always sample mid-bit; and the Pirate's edge bit is CPHA, inverted.
+    if(command & 0x80) {
+        pirate_spi_bus_set_mode(&bbio->spi, command & 0x04, !(command & 0x02));
+        return pirate_bbio_put_byte(bbio, 0x01);
+    }
+
+    switch(command >> 4) {
+    case 0x1:
+        return pirate_bbio_spi_bulk(bbio, (command & 0x0F) + 1);
+
+    // 0100wxyz: power, pull-ups, AUX and CS; only CS is ours to change.
+    case 0x4:
+        furi_hal_gpio_write(bbio->spi.handle->cs, command & 0x01);
+        return pirate_bbio_put_byte(bbio, 0x01);
+
+    // 01100xxx: clock speed. We go no slower than 250 kHz, so the two slowest are refused.
+    case 0x6:
+        if((command & 0x08) ||
+           !bbio->spi_bus.set_speed(bbio->spi_bus.context, pirate_bbio_spi_speeds[command & 0x07])) {
+            return pirate_bbio_fail(bbio);
+        }
+        return pirate_bbio_put_byte(bbio, 0x01);
+
+    case 0x0:
+        break;
+
+    default:
+        return pirate_bbio_fail(bbio);
+    }
+
+    switch(command) {
+    case 0x00:
+        pirate_bbio_set_mode(bbio, PirateBbioModeBitbang);
+        return pirate_bbio_put(bbio, "BBIO1", 5);
+    case 0x01:
+        return pirate_bbio_put(bbio, "SPI1", 4);
+    case 0x02:
+    case 0x03:
+        pirate_bbio_spi_select(bbio, command == 0x02);
+        return pirate_bbio_put_byte(bbio, 0x01);
+    case 0x04:
+    case 0x05:
+        return pirate_bbio_spi_write_read(bbio, command == 0x04);
+    default:
+        return pirate_bbio_fail(bbio);
+    }
+}
+
+/**
+ * Raw I2C.
+ */
+
+/** 0001xxxx: writes 1-16 bytes, answering each with 0x00 if it was acknowledged, or 0x01 if not. */
+static bool pirate_bbio_i2c_bulk(PirateBbio* bbio, size_t length) {
+    uint8_t* data = bbio->buffer;
+    uint8_t* acks = &bbio->buffer[PIRATE_BBIO_BULK_SIZE];
+
+    if(!pirate_bbio_put_byte(bbio, 0x01) || !pirate_bbio_get(bbio, data, length)) {
+        return false;
+    }
+
+    for(size_t i = 0; i < length; ++i) {
+        acks[i] = pirate_i2c_bitbang_write(&bbio->i2c, data[i]) ? 0x00 : 0x01;
+    }
+
+    bbio->i2c_bytes += length;
+    return pirate_bbio_put(bbio, acks, length);
+}
+
+/**
+ * 0x08: a whole transaction in one go. Starts, writes up to 4 KiB, reads up to 4 KiB -- with
+ * a NACK on the last byte -- and stops. If any written byte isn't acknowledged, we stop there,
+ * and answer 0x00. The host includes the address bytes among what's written.
+ */
+static bool pirate_bbio_i2c_write_read(PirateBbio* bbio) {
+    size_t write_length;
+    size_t read_length;
+
+    if(!pirate_bbio_get_length(bbio, &write_length) || !pirate_bbio_get_length(bbio, &read_length)) {
+        return false;
+    }
+    if((write_length > sizeof(bbio->buffer)) || (read_length > sizeof(bbio->buffer))) {
+        return pirate_bbio_fail(bbio);
+    }
+    if(!pirate_bbio_get(bbio, bbio->buffer, write_length)) {
+        return false;
+    }
+
+    pirate_i2c_bitbang_start(&bbio->i2c);
+
+    for(size_t i = 0; i < write_length; ++i) {
+        bbio->i2c_bytes += 1;
+
+        // A NACK is an answer, not a failure; so it doesn't count against us.
+        if(!pirate_i2c_bitbang_write(&bbio->i2c, bbio->buffer[i])) {
+            pirate_i2c_bitbang_stop(&bbio->i2c);
+            return pirate_bbio_put_byte(bbio, 0x00);
+        }
+    }
+
+    for(size_t i = 0; i < read_length; ++i) {
+        bbio->buffer[i] = pirate_i2c_bitbang_read(&bbio->i2c);
+        pirate_i2c_bitbang_ack(&bbio->i2c, i + 1 < read_length);
+    }
+    bbio->i2c_bytes += read_length;
+
+    pirate_i2c_bitbang_stop(&bbio->i2c);
+    return pirate_bbio_put_byte(bbio, 0x01) && pirate_bbio_put(bbio, bbio->buffer, read_length);
+}
+
+static bool pirate_bbio_i2c(PirateBbio* bbio, uint8_t command) {
+    switch(command >> 4) {
+    case 0x1:
+        return pirate_bbio_i2c_bulk(bbio, (command & 0x0F) + 1);
+
+    // 0100wxyz: power, pull-ups, AUX and CS; only the pull-ups are ours to change.
+    case 0x4:
+        pirate_i2c_bitbang_set_pull_ups(&bbio->i2c, command & 0x04);
+        return pirate_bbio_put_byte(bbio, 0x01);
+
+    // 011000xx: clock speed.
+    case 0x6:
+        if(command & 0x0C) {
+            return pirate_bbio_fail(bbio);
+        }
+        pirate_i2c_bitbang_set_speed(&bbio->i2c, pirate_bbio_i2c_speeds[command & 0x03]);
+        return pirate_bbio_put_byte(bbio, 0x01);
+
+    case 0x0:
+        break;
+
+    default:
+        return pirate_bbio_fail(bbio);
+    }
+
+    switch(command) {
+    case 0x00:
+        pirate_bbio_set_mode(bbio, PirateBbioModeBitbang);
+        return pirate_bbio_put(bbio, "BBIO1", 5);
+    case 0x01:
+        return pirate_bbio_put(bbio, "I2C1", 4);
+    case 0x02:
+        pirate_i2c_bitbang_start(&bbio->i2c);
+        return pirate_bbio_put_byte(bbio, 0x01);
+    case 0x03:
+        pirate_i2c_bitbang_stop(&bbio->i2c);
+        return pirate_bbio_put_byte(bbio, 0x01);
+
+    // The acknowledge bit is the host's next command; so a read leaves it unsent.
+    case 0x04:
+        bbio->i2c_bytes += 1;
+        return pirate_bbio_put_byte(bbio, pirate_i2c_bitbang_read(&bbio->i2c));
+    case 0x06:
+    case 0x07:
+        pirate_i2c_bitbang_ack(&bbio->i2c, command == 0x06);
+        return pirate_bbio_put_byte(bbio, 0x01);
+
+    case 0x08:
+        return pirate_bbio_i2c_write_read(bbio);
+    default:
+        return pirate_bbio_fail(bbio);
+    }
+}
+
+/**
+ * Worker.
+ */
+
+static int32_t pirate_bbio_worker(void* context) {
+    PirateBbio* bbio = context;
+    uint8_t command;
+
+    while(pirate_bbio_get(bbio, &command, 1)) {
+        bool running = false;
+
+        switch(bbio->mode) {
+        case PirateBbioModeTerminal:
+            running = pirate_bbio_terminal(bbio, command);
+            break;
+        case PirateBbioModeBitbang:
+            running = pirate_bbio_bitbang(bbio, command);
+            break;
+        case PirateBbioModeSpi:
+            running = pirate_bbio_spi(bbio, command);
+            break;
+        case PirateBbioModeI2c:
+            running = pirate_bbio_i2c(bbio, command);
+            break;
+        }
+
+        if(!running) {
+            break;
+        }
+    }
+
+    // Whatever bus the host left us holding goes back before we do.
+    pirate_bbio_set_mode(bbio, PirateBbioModeTerminal);
+    return 0;
+}
+
+/**
+ * Public API; called from the GUI thread.
+ */
+
+PirateBbio* pirate_bbio_alloc(ViewDispatcher* view_dispatcher, uint32_t update_event) {
+    PirateBbio* bbio = malloc(sizeof(PirateBbio));
+    memset(bbio, 0, sizeof(*bbio));
+
+    pirate_update_notifier_init(
+        &bbio->updates, view_dispatcher, update_event, PIRATE_BBIO_UPDATE_INTERVAL);
+    bbio->worker = furi_thread_alloc_ex("PirateBbio", PIRATE_BBIO_STACK_SIZE, pirate_bbio_worker, bbio);
+
+    pirate_spi_bus_init(&bbio->spi_bus, &bbio->spi, &furi_hal_spi_bus_handle_external);
+    pirate_i2c_bitbang_set_speed(&bbio->i2c, PIRATE_BBIO_I2C_DEFAULT_SPEED);
+
+    bbio->cdc_callbacks = (CdcCallbacks){
+        .tx_ep_callback = pirate_bbio_usb_tx_callback,
+        .rx_ep_callback = pirate_bbio_usb_rx_callback,
+        .state_callback = pirate_bbio_usb_state_callback,
+    };
+
+    return bbio;
+}
+
+void pirate_bbio_free(PirateBbio* bbio) {
+    furi_assert(bbio);
+
+    pirate_bbio_stop(bbio);
+    furi_thread_free(bbio->worker);
+    free(bbio);
+}
+
+bool pirate_bbio_start(PirateBbio* bbio) {
+    furi_assert(bbio);
+
+    if(bbio->running) {
+        return false;
+    }
+
+    // We need a second CDC interface, so the Flipper's own CLI can keep the first.
+    bbio->usb_previous = furi_hal_usb_get_config();
+    furi_hal_usb_unlock();
+    if(!furi_hal_usb_set_config(&usb_cdc_dual, NULL)) {
+        return false;
+    }
+
+    // Neither our thread nor USB's callbacks are up yet; so all of this is still ours.
+    bbio->connected = false;
+    bbio->exiting = false;
+    bbio->in_length = 0;
+    bbio->in_position = 0;
+    bbio->out_length = 0;
+    bbio->usb_busy = false;
+    bbio->usb_transfer_open = false;
+    bbio->mode = PirateBbioModeTerminal;
+    bbio->zeroes = 0;
+    bbio->spi_bytes = 0;
+    bbio->i2c_bytes = 0;
+    bbio->errors = 0;
+    bbio->spi_cycles = 0;
+    bbio->spi_rate = 0;
+    bbio->spi_bus_rate = 0;
+    bbio->window_spi_bytes = 0;
+    bbio->window_spi_cycles = 0;
+    bbio->reported = pirate_bbio_activity(bbio);
+    pirate_update_notifier_reset(&bbio->updates);
+    bbio->window_start = furi_get_tick();
+
+    bbio->running = true;
+    furi_thread_start(bbio->worker);
+    furi_hal_cdc_set_callbacks(PIRATE_BBIO_CDC_INTERFACE, &bbio->cdc_callbacks, bbio);
+
+    return true;
+}
+
+void pirate_bbio_stop(PirateBbio* bbio) {
+    furi_assert(bbio);
+
+    if(!bbio->running) {
+        return;
+    }
+
+    // Unhook USB before the thread goes, so no callback's left setting its flags.
+    furi_hal_cdc_set_callbacks(PIRATE_BBIO_CDC_INTERFACE, NULL, NULL);
+
+    furi_thread_flags_set(furi_thread_get_id(bbio->worker), PirateBbioFlagExit);
+    furi_thread_join(bbio->worker);
+
+    furi_hal_usb_unlock();
+    furi_hal_usb_set_config(bbio->usb_previous, NULL);
+
+    bbio->running = false;
+}
+
+void pirate_bbio_get_stats(PirateBbio* bbio, PirateBbioStats* stats) {
+    furi_assert(bbio);
+
+    stats->connected = bbio->connected;
+    stats->mode = bbio->mode;
+    stats->spi_speed = bbio->spi.speed;
+    stats->i2c_speed = bbio->i2c.speed;
+    stats->spi_bytes = bbio->spi_bytes;
+    stats->spi_rate = bbio->spi_rate;
+    stats->spi_bus_rate = bbio->spi_bus_rate;
+    stats->i2c_bytes = bbio->i2c_bytes;
+    stats->errors = bbio->errors;
+
+    pirate_update_notifier_ack(&bbio->updates);
+}
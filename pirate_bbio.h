@@ -0,0 +1,96 @@
+/**
+ * @file pirate_bbio.h
+ * The Bus Pirate's binary protocol ("BBIO"), spoken over USB CDC.
+ *
+ * Host tools written for a Bus Pirate -- flashrom, pyBusPirateLite and the like -- can drive
+ * the external SPI and I2C buses directly, without going through the on-screen keyboard.
+ * A worker thread takes the host's bytes off the endpoint a packet at a time, and answers in
+ * whole packets; nothing but counters ever reaches the GUI thread.
+ *
+ * We start out as the Bus Pirate's terminal would, and twenty 0x00 bytes enter binary mode,
+ * which answers "BBIO1". From there:
+ *
+ *   0x01  raw SPI ("SPI1"), on the external SPI bus; bulk transfers go by DMA.
+ *   0x02  raw I2C ("I2C1"), bit-banged on the external I2C bus' pins, so that every
+ *         condition and acknowledge bit is the host's to send.
+ *   0x0F  reset to the terminal, which answers 0x01 and the usual version banner.
+ *
+ * Each submode's command set is the Bus Pirate's; 0x00 returns to binary mode from either.
+ * The Flipper's 3.3 V supply is always on and its pins have no AUX line, so the peripheral
+ * commands only act on chip select and the pull-ups. Commands we don't support are answered
+ * with 0x00.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <gui/view_dispatcher.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The CDC interface we take; the first stays with the Flipper's own CLI. */
+#define PIRATE_BBIO_CDC_INTERFACE 1
+
+/** Most a single write-then-read command can move each way; the Bus Pirate's own limit. */
+#define PIRATE_BBIO_TRANSFER_SIZE 4096
+
+/** Minimum time between our update events, in milliseconds; the screen can't show more. */
+#define PIRATE_BBIO_UPDATE_INTERVAL 100
+
+/** Time we average throughput over, in milliseconds. */
+#define PIRATE_BBIO_RATE_WINDOW 500
+
+typedef enum {
+    PirateBbioModeTerminal,
+    PirateBbioModeBitbang,
+    PirateBbioModeSpi,
+    PirateBbioModeI2c,
+} PirateBbioMode;
+
+typedef struct {
+    bool connected;
+    PirateBbioMode mode;
+
+    /** The clocks the host has asked for, in kHz. */
+    uint32_t spi_speed;
+    uint32_t i2c_speed;
+
+    /** Bytes moved over SPI, counting each direction; how many a second lately, end to end;
+     *  and how many a second while the bus was actually transferring. */
+    uint32_t spi_bytes;
+    uint32_t spi_rate;
+    uint32_t spi_bus_rate;
+
+    /** Bytes moved over I2C, each way. */
+    uint32_t i2c_bytes;
+
+    /** Commands we couldn't carry out, or didn't understand. */
+    uint32_t errors;
+} PirateBbioStats;
+
+typedef struct PirateBbio PirateBbio;
+
+/**
+ * @param view_dispatcher   Receives our update events.
+ * @param update_event      Custom event sent when the stats have changed.
+ */
+PirateBbio* pirate_bbio_alloc(ViewDispatcher* view_dispatcher, uint32_t update_event);
+void pirate_bbio_free(PirateBbio* bbio);
+
+/**
+ * Takes over a USB CDC interface, and starts listening on it from the terminal.
+ * Returns false if we're already running, or if USB is in use elsewhere.
+ */
+bool pirate_bbio_start(PirateBbio* bbio);
+
+/** Stops, releasing whichever bus the host had, and puts USB back as we found it. Safe to call if we're not running. */
+void pirate_bbio_stop(PirateBbio* bbio);
+
+/** Reads the current stats, and allows the next update event to be sent. */
+void pirate_bbio_get_stats(PirateBbio* bbio, PirateBbioStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,396 @@
+#include "pirate_bridge.h"
+#include "pirate_update.h"
+
+#include <furi_hal.h>
+#include <furi_hal_usb_cdc.h>
+
+#define PIRATE_BRIDGE_STACK_SIZE 1024
+
+/** How much we take off the DMA buffer at a time; it's copied through the interrupt's stack. */
+#define PIRATE_BRIDGE_DMA_CHUNK 64
+
+typedef enum {
+    PirateBridgeFlagExit = (1 << 0),
+
+    // For the worker.
+    PirateBridgeFlagUartReceived = (1 << 1),
+    PirateBridgeFlagUsbSent = (1 << 2),
+    PirateBridgeFlagUsbState = (1 << 3),
+    PirateBridgeFlagLineCoding = (1 << 4),
+
+    // For the transmitter.
+    PirateBridgeFlagUsbReceived = (1 << 5),
+} PirateBridgeFlag;
+
+#define PIRATE_BRIDGE_WORKER_FLAGS                                                     \
+    (PirateBridgeFlagExit | PirateBridgeFlagUartReceived | PirateBridgeFlagUsbSent | \
+     PirateBridgeFlagUsbState | PirateBridgeFlagLineCoding)
+#define PIRATE_BRIDGE_TX_FLAGS (PirateBridgeFlagExit | PirateBridgeFlagUsbReceived)
+
+struct PirateBridge {
+    /** Carries UART to USB, and looks after the line settings. */
+    FuriThread* worker;
+
+    /** Carries USB to UART; kept apart, as the UART transmits by polling, and would hold up the other direction. */
+    FuriThread* transmitter;
+
+    /** Where we report updates. */
+    PirateUpdateNotifier updates;
+
+    /** What we've taken over, and what we have to put back. */
+    FuriHalSerialHandle* serial;
+    FuriHalUsbInterface* usb_previous;
+    CdcCallbacks cdc_callbacks;
+
+    /** Filled by the UART's interrupt; drained to USB by our worker. */
+    FuriStreamBuffer* rx_stream;
+
+    /** USB's state, as its interrupt last told us; and the rate the host last asked for. */
+    volatile bool connected;
+    volatile uint32_t requested_baud;
+    uint32_t baud;
+
+    /** Whether USB still has our last packet; and whether it was a full one, which leaves the transfer open. */
+    bool usb_busy;
+    bool usb_transfer_open;
+
+    volatile uint32_t uart_to_usb;
+    volatile uint32_t usb_to_uart;
+    volatile uint32_t overruns;
+    volatile uint32_t dropped;
+    volatile uint32_t line_errors;
+
+    /** Throughput, as of the end of the last rate window; and the counts it started from. */
+    uint32_t uart_to_usb_rate;
+    uint32_t usb_to_uart_rate;
+    uint32_t window_start;
+    uint32_t window_uart_to_usb;
+    uint32_t window_usb_to_uart;
+
+    bool running;
+};
+
+/**
+ * Interrupt context: the UART's DMA, and the USB endpoints.
+ */
+
+static void pirate_bridge_uart_callback(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialRxEvent event,
+    size_t data_len,
+    void* context) {
+    PirateBridge* bridge = context;
+
+    if(event & (FuriHalSerialRxEventData | FuriHalSerialRxEventIdle)) {
+        uint8_t chunk[PIRATE_BRIDGE_DMA_CHUNK];
+
+        while(data_len) {
+            size_t length = furi_hal_serial_dma_rx(handle, chunk, MIN(data_len, sizeof(chunk)));
+            if(!length) {
+                break;
+            }
+
+            // We can't wait here; what doesn't fit is lost, and counted.
+            size_t stored = furi_stream_buffer_send(bridge->rx_stream, chunk, length, 0);
+            bridge->dropped += length - stored;
+            data_len -= length;
+        }
+
+        furi_thread_flags_set(furi_thread_get_id(bridge->worker), PirateBridgeFlagUartReceived);
+    }
+
+    if(event & FuriHalSerialRxEventOverrunError) {
+        bridge->overruns += 1;
+    }
+    if(event & (FuriHalSerialRxEventFrameError | FuriHalSerialRxEventNoiseError)) {
+        bridge->line_errors += 1;
+    }
+}
+
+static void pirate_bridge_usb_tx_callback(void* context) {
+    PirateBridge* bridge = context;
+    furi_thread_flags_set(furi_thread_get_id(bridge->worker), PirateBridgeFlagUsbSent);
+}
+
+static void pirate_bridge_usb_rx_callback(void* context) {
+    PirateBridge* bridge = context;
+    furi_thread_flags_set(furi_thread_get_id(bridge->transmitter), PirateBridgeFlagUsbReceived);
+}
+
+static void pirate_bridge_usb_state_callback(void* context, CdcState state) {
+    PirateBridge* bridge = context;
+
+    bridge->connected = (state == CdcStateConnected);
+    furi_thread_flags_set(furi_thread_get_id(bridge->worker), PirateBridgeFlagUsbState);
+}
+
+static void pirate_bridge_usb_config_callback(void* context, struct usb_cdc_line_coding* config) {
+    PirateBridge* bridge = context;
+
+    bridge->requested_baud = config->dwDTERate;
+    furi_thread_flags_set(furi_thread_get_id(bridge->worker), PirateBridgeFlagLineCoding);
+}
+
+/**
+ * Worker: UART to USB.
+ */
+
+/** Hands USB its next packet, if it's ready for one and we have anything to send. */
+static void pirate_bridge_usb_send(PirateBridge* bridge) {
+    uint8_t packet[CDC_DATA_SZ];
+
+    if(bridge->usb_busy) {
+        return;
+    }
+
+    size_t length = furi_stream_buffer_receive(bridge->rx_stream, packet, sizeof(packet), 0);
+
+    // A full packet tells the host there's more to come; so if the data ends on one, an empty
+    // packet has to follow it, or the host sits on what it has.
+    if(!length && !bridge->usb_transfer_open) {
+        return;
+    }
+    bridge->usb_transfer_open = (length == sizeof(packet));
+    bridge->usb_busy = true;
+
+    furi_hal_cdc_send(PIRATE_BRIDGE_CDC_INTERFACE, packet, length);
+    bridge->uart_to_usb += length;
+}
+
+/** Throws away whatever we've received; with nobody to send it to, it'd only be stale by the time there was. */
+static void pirate_bridge_discard(PirateBridge* bridge) {
+    uint8_t packet[CDC_DATA_SZ];
+
+    while(furi_stream_buffer_receive(bridge->rx_stream, packet, sizeof(packet), 0)) {
+    }
+    bridge->usb_busy = false;
+    bridge->usb_transfer_open = false;
+}
+
+/** Closes the current rate window, if it's run its length; so rates fall back to zero once traffic stops. */
+static void pirate_bridge_update_rates(PirateBridge* bridge, uint32_t now) {
+    uint32_t elapsed = now - bridge->window_start;
+
+    if(elapsed < furi_ms_to_ticks(PIRATE_BRIDGE_RATE_WINDOW)) {
+        return;
+    }
+
+    uint32_t uart_to_usb = bridge->uart_to_usb;
+    uint32_t usb_to_uart = bridge->usb_to_uart;
+    uint64_t frequency = furi_kernel_get_tick_frequency();
+
+    bridge->uart_to_usb_rate = (uart_to_usb - bridge->window_uart_to_usb) * frequency / elapsed;
+    bridge->usb_to_uart_rate = (usb_to_uart - bridge->window_usb_to_uart) * frequency / elapsed;
+    bridge->window_uart_to_usb = uart_to_usb;
+    bridge->window_usb_to_uart = usb_to_uart;
+    bridge->window_start = now;
+}
+
+/** Changes whenever anything we report does; close enough, for deciding whether to redraw. */
+static uint32_t pirate_bridge_activity(PirateBridge* bridge) {
+    return bridge->uart_to_usb + bridge->usb_to_uart + bridge->uart_to_usb_rate +
+           bridge->usb_to_uart_rate + bridge->overruns + bridge->dropped + bridge->line_errors +
+           bridge->baud + bridge->connected;
+}
+
+static int32_t pirate_bridge_worker(void* context) {
+    PirateBridge* bridge = context;
+    uint32_t reported = pirate_bridge_activity(bridge);
+
+    while(true) {
+        uint32_t flags = furi_thread_flags_wait(
+            PIRATE_BRIDGE_WORKER_FLAGS,
+            FuriFlagWaitAny,
+            furi_ms_to_ticks(PIRATE_BRIDGE_UPDATE_INTERVAL));
+
+        if(!(flags & FuriFlagError)) {
+            if(flags & PirateBridgeFlagExit) {
+                break;
+            }
+            if(flags & PirateBridgeFlagUsbSent) {
+                bridge->usb_busy = false;
+            }
+
+            // The host's terminal sets the rate; zero just means it hasn't.
+            uint32_t requested = bridge->requested_baud;
+            if((flags & PirateBridgeFlagLineCoding) && requested && (requested != bridge->baud)) {
+                furi_hal_serial_set_br(bridge->serial, requested);
+                bridge->baud = requested;
+            }
+        }
+
+        if(bridge->connected) {
+            pirate_bridge_usb_send(bridge);
+        } else {
+            pirate_bridge_discard(bridge);
+        }
+
+        pirate_bridge_update_rates(bridge, furi_get_tick());
+
+        uint32_t activity = pirate_bridge_activity(bridge);
+        if((activity != reported) && pirate_update_notifier_request(&bridge->updates)) {
+            reported = activity;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Transmitter: USB to UART.
+ */
+
+static int32_t pirate_bridge_transmitter(void* context) {
+    PirateBridge* bridge = context;
+    uint8_t packet[CDC_DATA_SZ];
+
+    while(true) {
+        uint32_t flags = furi_thread_flags_wait(PIRATE_BRIDGE_TX_FLAGS, FuriFlagWaitAny, FuriWaitForever);
+        if(flags & FuriFlagError) {
+            continue;
+        }
+        if(flags & PirateBridgeFlagExit) {
+            break;
+        }
+
+        // The host can't send its next packet until we've taken this one; so that's all the flow control we need.
+        int32_t length;
+        while((length = furi_hal_cdc_receive(PIRATE_BRIDGE_CDC_INTERFACE, packet, sizeof(packet))) > 0) {
+            furi_hal_serial_tx(bridge->serial, packet, length);
+            bridge->usb_to_uart += length;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Public API; called from the GUI thread.
+ */
+
+PirateBridge* pirate_bridge_alloc(ViewDispatcher* view_dispatcher, uint32_t update_event) {
+    PirateBridge* bridge = malloc(sizeof(PirateBridge));
+    memset(bridge, 0, sizeof(*bridge));
+
+    pirate_update_notifier_init(
+        &bridge->updates, view_dispatcher, update_event, PIRATE_BRIDGE_UPDATE_INTERVAL);
+    bridge->rx_stream = furi_stream_buffer_alloc(PIRATE_BRIDGE_RX_BUFFER_SIZE, 1);
+    bridge->worker =
+        furi_thread_alloc_ex("PirateBridge", PIRATE_BRIDGE_STACK_SIZE, pirate_bridge_worker, bridge);
+    bridge->transmitter = furi_thread_alloc_ex(
+        "PirateBridgeTx", PIRATE_BRIDGE_STACK_SIZE, pirate_bridge_transmitter, bridge);
+
+    bridge->cdc_callbacks = (CdcCallbacks){
+        .tx_ep_callback = pirate_bridge_usb_tx_callback,
+        .rx_ep_callback = pirate_bridge_usb_rx_callback,
+        .state_callback = pirate_bridge_usb_state_callback,
+        .config_callback = pirate_bridge_usb_config_callback,
+    };
+
+    return bridge;
+}
+
+void pirate_bridge_free(PirateBridge* bridge) {
+    furi_assert(bridge);
+
+    pirate_bridge_stop(bridge);
+    furi_thread_free(bridge->worker);
+    furi_thread_free(bridge->transmitter);
+    furi_stream_buffer_free(bridge->rx_stream);
+    free(bridge);
+}
+
+bool pirate_bridge_start(PirateBridge* bridge) {
+    furi_assert(bridge);
+
+    if(bridge->running) {
+        return false;
+    }
+
+    // The USART may already be someone else's; e.g. an expansion module's.
+    bridge->serial = furi_hal_serial_control_acquire(FuriHalSerialIdUsart);
+    if(!bridge->serial) {
+        return false;
+    }
+
+    // We need a second CDC interface, so the Flipper's own CLI can keep the first.
+    bridge->usb_previous = furi_hal_usb_get_config();
+    furi_hal_usb_unlock();
+    if(!furi_hal_usb_set_config(&usb_cdc_dual, NULL)) {
+        furi_hal_serial_control_release(bridge->serial);
+        bridge->serial = NULL;
+        return false;
+    }
+
+    // Neither thread is up yet, nor are the UART's and USB's callbacks; so this is all still ours.
+    struct usb_cdc_line_coding* line_coding = furi_hal_cdc_get_port_settings(PIRATE_BRIDGE_CDC_INTERFACE);
+    bridge->baud = line_coding->dwDTERate ? line_coding->dwDTERate : PIRATE_BRIDGE_DEFAULT_BAUD;
+    bridge->requested_baud = bridge->baud;
+    bridge->connected = false;
+    bridge->usb_busy = false;
+    bridge->usb_transfer_open = false;
+    bridge->uart_to_usb = 0;
+    bridge->usb_to_uart = 0;
+    bridge->overruns = 0;
+    bridge->dropped = 0;
+    bridge->line_errors = 0;
+    bridge->uart_to_usb_rate = 0;
+    bridge->usb_to_uart_rate = 0;
+    bridge->window_uart_to_usb = 0;
+    bridge->window_usb_to_uart = 0;
+    pirate_update_notifier_reset(&bridge->updates);
+    bridge->window_start = furi_get_tick();
+    furi_stream_buffer_reset(bridge->rx_stream);
+
+    bridge->running = true;
+    furi_thread_start(bridge->worker);
+    furi_thread_start(bridge->transmitter);
+
+    furi_hal_serial_init(bridge->serial, bridge->baud);
+    furi_hal_serial_dma_rx_start(bridge->serial, pirate_bridge_uart_callback, bridge, true);
+    furi_hal_cdc_set_callbacks(PIRATE_BRIDGE_CDC_INTERFACE, &bridge->cdc_callbacks, bridge);
+
+    return true;
+}
+
+void pirate_bridge_stop(PirateBridge* bridge) {
+    furi_assert(bridge);
+
+    if(!bridge->running) {
+        return;
+    }
+
+    // Unhook USB and the UART before the threads go, so no callback's left setting their flags.
+    furi_hal_cdc_set_callbacks(PIRATE_BRIDGE_CDC_INTERFACE, NULL, NULL);
+    furi_hal_serial_dma_rx_stop(bridge->serial);
+
+    furi_thread_flags_set(furi_thread_get_id(bridge->worker), PirateBridgeFlagExit);
+    furi_thread_flags_set(furi_thread_get_id(bridge->transmitter), PirateBridgeFlagExit);
+    furi_thread_join(bridge->worker);
+    furi_thread_join(bridge->transmitter);
+
+    furi_hal_serial_deinit(bridge->serial);
+    furi_hal_serial_control_release(bridge->serial);
+    bridge->serial = NULL;
+
+    furi_hal_usb_unlock();
+    furi_hal_usb_set_config(bridge->usb_previous, NULL);
+
+    bridge->running = false;
+}
+
+void pirate_bridge_get_stats(PirateBridge* bridge, PirateBridgeStats* stats) {
+    furi_assert(bridge);
+
+    stats->baud = bridge->baud;
+    stats->connected = bridge->connected;
+    stats->uart_to_usb = bridge->uart_to_usb;
+    stats->usb_to_uart = bridge->usb_to_uart;
+    stats->uart_to_usb_rate = bridge->uart_to_usb_rate;
+    stats->usb_to_uart_rate = bridge->usb_to_uart_rate;
+    stats->overruns = bridge->overruns;
+    stats->dropped = bridge->dropped;
+    stats->line_errors = bridge->line_errors;
+
+    pirate_update_notifier_ack(&bridge->updates);
+}
@@ -0,0 +1,77 @@
+/**
+ * @file pirate_bridge.h
+ * USB-to-UART bridge.
+ *
+ * Bytes pass between the USB CDC endpoint and the USART without ever touching the GUI thread.
+ * Received bytes are taken off the UART's circular DMA buffer by its interrupt, in blocks, and
+ * parked in a stream buffer; a worker thread hands them to USB a packet at a time. In the other
+ * direction, each packet the host sends is taken off the endpoint whole, and goes straight out
+ * of the UART. The host's line coding sets the baud rate, as with any USB serial adapter.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <gui/view_dispatcher.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The CDC interface we take; the first stays with the Flipper's own CLI. */
+#define PIRATE_BRIDGE_CDC_INTERFACE 1
+
+/** The rate we run at until the host asks for something else. */
+#define PIRATE_BRIDGE_DEFAULT_BAUD 115200
+
+/** Received bytes we can hold while USB catches up; at 1 Mbaud, about forty milliseconds' worth. */
+#define PIRATE_BRIDGE_RX_BUFFER_SIZE 4096
+
+/** Minimum time between our update events, in milliseconds; the screen can't show more. */
+#define PIRATE_BRIDGE_UPDATE_INTERVAL 100
+
+/** Time we average throughput over, in milliseconds. */
+#define PIRATE_BRIDGE_RATE_WINDOW 500
+
+typedef struct {
+    uint32_t baud;
+    bool connected;
+
+    /** Bytes carried each way; and how many a second, lately. */
+    uint32_t uart_to_usb;
+    uint32_t usb_to_uart;
+    uint32_t uart_to_usb_rate;
+    uint32_t usb_to_uart_rate;
+
+    /** Times the UART lost bytes before we could take them; and bytes we had no room to hold. */
+    uint32_t overruns;
+    uint32_t dropped;
+
+    /** Bytes that arrived garbled: framing or noise errors. */
+    uint32_t line_errors;
+} PirateBridgeStats;
+
+typedef struct PirateBridge PirateBridge;
+
+/**
+ * @param view_dispatcher   Receives our update events.
+ * @param update_event      Custom event sent when the stats have changed.
+ */
+PirateBridge* pirate_bridge_alloc(ViewDispatcher* view_dispatcher, uint32_t update_event);
+void pirate_bridge_free(PirateBridge* bridge);
+
+/**
+ * Takes over the USART and a USB CDC interface, and starts bridging them.
+ * Returns false if we're already running, or if the USART or USB are in use elsewhere.
+ */
+bool pirate_bridge_start(PirateBridge* bridge);
+
+/** Stops bridging, and puts the USART and USB back as we found them. Safe to call if we're not running. */
+void pirate_bridge_stop(PirateBridge* bridge);
+
+/** Reads the current stats, and allows the next update event to be sent. */
+void pirate_bridge_get_stats(PirateBridge* bridge, PirateBridgeStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,125 @@
+#include "pirate_bridge_meter.h"
+#include <furi.h>
+
+struct PirateBridgeMeter {
+    View* view;
+};
+
+typedef struct {
+    PirateBridgeStats stats;
+} PirateBridgeMeterModel;
+
+static const uint8_t header_height = 10;
+
+/**
+ * @brief Format a rate in bytes per second; kilobytes, to one decimal place, once it's big enough
+ */
+static void pirate_bridge_meter_format_rate(char* text, size_t size, uint32_t rate) {
+    if(rate >= 10000) {
+        snprintf(
+            text,
+            size,
+            "%lu.%lu kB/s",
+            (unsigned long)(rate / 1000),
+            (unsigned long)((rate % 1000) / 100));
+    } else {
+        snprintf(text, size, "%lu B/s", (unsigned long)rate);
+    }
+}
+
+/**
+ * @brief Draw one direction: its rate on the first line, and its running total on the second
+ */
+static void pirate_bridge_meter_draw_direction(
+    Canvas* canvas,
+    uint8_t y,
+    const char* label,
+    uint32_t total,
+    uint32_t rate) {
+    char text[24];
+
+    canvas_draw_str(canvas, 0, y, label);
+    pirate_bridge_meter_format_rate(text, sizeof(text), rate);
+    canvas_draw_str_aligned(canvas, 127, y, AlignRight, AlignBottom, text);
+
+    snprintf(text, sizeof(text), "%lu bytes", (unsigned long)total);
+    canvas_draw_str_aligned(canvas, 127, y + 9, AlignRight, AlignBottom, text);
+}
+
+/**
+ * @brief Draw callback
+ */
+static void pirate_bridge_meter_draw_callback(Canvas* canvas, void* _model) {
+    PirateBridgeMeterModel* model = _model;
+    const PirateBridgeStats* stats = &model->stats;
+    char text[64];
+
+    canvas_clear(canvas);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_set_font(canvas, FontSecondary);
+
+    canvas_draw_str(canvas, 0, 8, "UART Bridge");
+    snprintf(text, sizeof(text), "%lu baud", (unsigned long)stats->baud);
+    canvas_draw_str_aligned(canvas, 127, 8, AlignRight, AlignBottom, text);
+    canvas_draw_line(canvas, 0, header_height - 1, 127, header_height - 1);
+
+    pirate_bridge_meter_draw_direction(canvas, 19, "USB > UART", stats->usb_to_uart, stats->usb_to_uart_rate);
+    pirate_bridge_meter_draw_direction(canvas, 40, "UART > USB", stats->uart_to_usb, stats->uart_to_usb_rate);
+
+    // Losses are the thing to watch; so they take the place of the status line once there are any.
+    uint32_t lost = stats->overruns + stats->dropped + stats->line_errors;
+    if(lost) {
+        snprintf(
+            text,
+            sizeof(text),
+            "LOST %lu ovr, %lu full, %lu err",
+            (unsigned long)stats->overruns,
+            (unsigned long)stats->dropped,
+            (unsigned long)stats->line_errors);
+    } else if(!stats->connected) {
+        snprintf(text, sizeof(text), "Waiting for USB host...");
+    } else {
+        snprintf(text, sizeof(text), "TX pin 13, RX pin 14");
+    }
+    canvas_draw_str(canvas, 0, 63, text);
+}
+
+PirateBridgeMeter* pirate_bridge_meter_alloc() {
+    PirateBridgeMeter* bridge_meter = malloc(sizeof(PirateBridgeMeter));
+    bridge_meter->view = view_alloc();
+    view_set_context(bridge_meter->view, bridge_meter);
+    view_allocate_model(bridge_meter->view, ViewModelTypeLocking, sizeof(PirateBridgeMeterModel));
+    view_set_draw_callback(bridge_meter->view, pirate_bridge_meter_draw_callback);
+
+    pirate_bridge_meter_reset(bridge_meter);
+    return bridge_meter;
+}
+
+void pirate_bridge_meter_free(PirateBridgeMeter* bridge_meter) {
+    furi_assert(bridge_meter);
+    view_free(bridge_meter->view);
+    free(bridge_meter);
+}
+
+View* pirate_bridge_meter_get_view(PirateBridgeMeter* bridge_meter) {
+    furi_assert(bridge_meter);
+    return bridge_meter->view;
+}
+
+void pirate_bridge_meter_reset(PirateBridgeMeter* bridge_meter) {
+    furi_assert(bridge_meter);
+
+    with_view_model(
+        bridge_meter->view, PirateBridgeMeterModel * model, {
+            memset(model, 0, sizeof(*model));
+        }, true);
+}
+
+void pirate_bridge_meter_set_stats(PirateBridgeMeter* bridge_meter, const PirateBridgeStats* stats) {
+    furi_assert(bridge_meter);
+
+    with_view_model(
+        bridge_meter->view, PirateBridgeMeterModel * model, {
+            memcpy(&model->stats, stats, sizeof(*stats));
+        }, true);
+}
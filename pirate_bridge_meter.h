@@ -0,0 +1,32 @@
+/**
+ * @file pirate_bridge_meter.h
+ * GUI: live throughput of the USB-to-UART bridge.
+ */
+
+#pragma once
+
+#include <gui/view.h>
+
+#include "pirate_bridge.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct PirateBridgeMeter PirateBridgeMeter;
+
+PirateBridgeMeter* pirate_bridge_meter_alloc();
+void pirate_bridge_meter_free(PirateBridgeMeter* bridge_meter);
+
+/** Get meter view, for adding to a view dispatcher. */
+View* pirate_bridge_meter_get_view(PirateBridgeMeter* bridge_meter);
+
+/** Zeroes the counters. */
+void pirate_bridge_meter_reset(PirateBridgeMeter* bridge_meter);
+
+/** Updates the counters, and redraws. */
+void pirate_bridge_meter_set_stats(PirateBridgeMeter* bridge_meter, const PirateBridgeStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,319 @@
+#include "pirate_eeprom.h"
+
+#include <furi_hal.h>
+#include <storage/storage.h>
+
+#define PIRATE_EEPROM_STACK_SIZE 1024
+
+/** Time we'll wait on each block; generous, to allow for clock stretching. */
+#define PIRATE_EEPROM_TIMEOUT 250
+
+/** Sent through the filled queue to tell the writer the reader is done. */
+#define PIRATE_EEPROM_END_OF_DUMP 0xFF
+
+const PirateEepromPart pirate_eeprom_parts[] = {
+    {"24C01", 128, 1},
+    {"24C02", 256, 1},
+    {"24C04", 512, 1},
+    {"24C08", 1024, 1},
+    {"24C16", 2048, 1},
+    {"24C32", 4096, 2},
+    {"24C64", 8192, 2},
+    {"24C128", 16384, 2},
+    {"24C256", 32768, 2},
+    {"24C512", 65536, 2},
+};
+const size_t pirate_eeprom_part_count = COUNT_OF(pirate_eeprom_parts);
+
+typedef struct {
+    uint8_t buffer;
+    uint16_t length;
+} PirateEepromBlock;
+
+struct PirateEepromDump {
+    FuriThread* reader;
+    FuriThread* writer;
+
+    /** Our ping-pong buffers, and the queues that pass their indices between threads. */
+    uint8_t buffers[2][PIRATE_EEPROM_BLOCK_SIZE];
+    FuriMessageQueue* free_buffers;
+    FuriMessageQueue* filled_buffers;
+
+    ViewDispatcher* view_dispatcher;
+    uint32_t progress_event;
+    uint32_t complete_event;
+
+    /** What we're dumping, and where to. */
+    const PirateEepromPart* part;
+    uint8_t address;
+    FuriString* path;
+    Storage* storage;
+    File* file;
+
+    volatile bool busy;
+    volatile bool abort;
+    volatile bool storage_failed;
+    volatile uint32_t bytes_written;
+
+    PirateEepromResult result;
+};
+
+/**
+ * Writer thread: moves filled buffers onto the card, and hands them back.
+ */
+
+static int32_t pirate_eeprom_writer(void* context) {
+    PirateEepromDump* dump = context;
+    PirateEepromBlock block;
+    uint32_t next_report = PIRATE_EEPROM_PROGRESS_INTERVAL;
+
+    while(true) {
+        furi_message_queue_get(dump->filled_buffers, &block, FuriWaitForever);
+        if(block.buffer == PIRATE_EEPROM_END_OF_DUMP) {
+            break;
+        }
+
+        // Once the card has failed, we just recycle buffers until the reader notices.
+        if(!dump->storage_failed) {
+            size_t written = storage_file_write(dump->file, dump->buffers[block.buffer], block.length);
+
+            if(written == block.length) {
+                dump->bytes_written += written;
+            } else {
+                dump->storage_failed = true;
+                dump->abort = true;
+            }
+        }
+
+        furi_message_queue_put(dump->free_buffers, &block.buffer, FuriWaitForever);
+
+        if(dump->bytes_written >= next_report) {
+            next_report += PIRATE_EEPROM_PROGRESS_INTERVAL;
+            view_dispatcher_send_custom_event(dump->view_dispatcher, dump->progress_event);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Reader thread: streams the part off the bus, one buffer at a time.
+ */
+
+static PirateEepromStatus pirate_eeprom_read_all(PirateEepromDump* dump) {
+    FuriHalI2cBusHandle* handle = &furi_hal_i2c_handle_external;
+    const PirateEepromPart* part = dump->part;
+    uint8_t word_address[2] = {0, 0};
+    uint32_t offset = 0;
+
+    // Point the part's address counter at zero, and then turn the bus around for one long
+    // sequential read; the part auto-increments through the whole array for us.
+    if(!furi_hal_i2c_tx_ext(
+           handle,
+           dump->address,
+           false,
+           word_address,
+           part->address_bytes,
+           FuriHalI2cBeginStart,
+           FuriHalI2cEndAwaitRestart,
+           PIRATE_EEPROM_TIMEOUT)) {
+        return PirateEepromStatusNak;
+    }
+
+    FuriHalI2cBegin begin = FuriHalI2cBeginRestart;
+
+    while(offset < part->size) {
+        uint8_t buffer;
+        uint16_t length = MIN(part->size - offset, (uint32_t)PIRATE_EEPROM_BLOCK_SIZE);
+        bool last = (offset + length == part->size);
+
+        // Wait for the writer to hand us a buffer; this is the only place we ever wait on the card.
+        furi_message_queue_get(dump->free_buffers, &buffer, FuriWaitForever);
+
+        // Pausing between blocks keeps the transaction open; we only stop after the final byte.
+        // If we're aborting, we finish with a stop now, so the bus is left idle.
+        bool stop = last || dump->abort;
+        if(!furi_hal_i2c_rx_ext(
+               handle,
+               dump->address | 1,
+               false,
+               dump->buffers[buffer],
+               length,
+               begin,
+               stop ? FuriHalI2cEndStop : FuriHalI2cEndPause,
+               PIRATE_EEPROM_TIMEOUT)) {
+            furi_message_queue_put(dump->free_buffers, &buffer, FuriWaitForever);
+            return PirateEepromStatusNak;
+        }
+
+        PirateEepromBlock block = {.buffer = buffer, .length = length};
+        furi_message_queue_put(dump->filled_buffers, &block, FuriWaitForever);
+
+        begin = FuriHalI2cBeginResume;
+        offset += length;
+        dump->result.bytes_read = offset;
+
+        if(stop && !last) {
+            return PirateEepromStatusAborted;
+        }
+    }
+
+    return PirateEepromStatusOk;
+}
+
+static int32_t pirate_eeprom_reader(void* context) {
+    PirateEepromDump* dump = context;
+    uint32_t start = furi_get_tick();
+
+    memset(&dump->result, 0, sizeof(dump->result));
+    dump->bytes_written = 0;
+    dump->storage_failed = false;
+
+    // Both buffers start out free.
+    for(uint8_t i = 0; i < COUNT_OF(dump->buffers); ++i) {
+        furi_message_queue_put(dump->free_buffers, &i, FuriWaitForever);
+    }
+
+    dump->file = storage_file_alloc(dump->storage);
+    if(storage_file_open(
+           dump->file, furi_string_get_cstr(dump->path), FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        furi_thread_start(dump->writer);
+
+        furi_hal_i2c_acquire(&furi_hal_i2c_handle_external);
+        dump->result.status = pirate_eeprom_read_all(dump);
+        furi_hal_i2c_release(&furi_hal_i2c_handle_external);
+
+        // Let the writer drain whatever's left, then tidy up.
+        PirateEepromBlock end = {.buffer = PIRATE_EEPROM_END_OF_DUMP};
+        furi_message_queue_put(dump->filled_buffers, &end, FuriWaitForever);
+        furi_thread_join(dump->writer);
+
+        storage_file_close(dump->file);
+    } else {
+        dump->storage_failed = true;
+    }
+    storage_file_free(dump->file);
+    dump->file = NULL;
+
+    // Storage problems trump whatever the reader thinks happened.
+    if(dump->storage_failed) {
+        dump->result.status = PirateEepromStatusStorageError;
+    }
+
+    dump->result.bytes_written = dump->bytes_written;
+    dump->result.duration_ms = furi_get_tick() - start;
+
+    furi_message_queue_reset(dump->free_buffers);
+    furi_message_queue_reset(dump->filled_buffers);
+
+    dump->busy = false;
+    view_dispatcher_send_custom_event(dump->view_dispatcher, dump->complete_event);
+    return 0;
+}
+
+/**
+ * Public API.
+ */
+
+PirateEepromDump* pirate_eeprom_dump_alloc(
+    ViewDispatcher* view_dispatcher,
+    uint32_t progress_event,
+    uint32_t complete_event) {
+    PirateEepromDump* dump = malloc(sizeof(PirateEepromDump));
+    memset(dump, 0, sizeof(*dump));
+
+    dump->view_dispatcher = view_dispatcher;
+    dump->progress_event = progress_event;
+    dump->complete_event = complete_event;
+
+    dump->path = furi_string_alloc();
+    dump->storage = furi_record_open(RECORD_STORAGE);
+
+    dump->free_buffers = furi_message_queue_alloc(COUNT_OF(dump->buffers), sizeof(uint8_t));
+    dump->filled_buffers =
+        furi_message_queue_alloc(COUNT_OF(dump->buffers) + 1, sizeof(PirateEepromBlock));
+
+    dump->reader = furi_thread_alloc_ex(
+        "PirateEepromRead", PIRATE_EEPROM_STACK_SIZE, pirate_eeprom_reader, dump);
+    dump->writer = furi_thread_alloc_ex(
+        "PirateEepromWrite", PIRATE_EEPROM_STACK_SIZE, pirate_eeprom_writer, dump);
+
+    return dump;
+}
+
+void pirate_eeprom_dump_free(PirateEepromDump* dump) {
+    furi_assert(dump);
+
+    // The reader always runs to completion; just make that quick.
+    dump->abort = true;
+    furi_thread_join(dump->reader);
+
+    furi_thread_free(dump->reader);
+    furi_thread_free(dump->writer);
+    furi_message_queue_free(dump->free_buffers);
+    furi_message_queue_free(dump->filled_buffers);
+
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(dump->path);
+    free(dump);
+}
+
+bool pirate_eeprom_dump_start(
+    PirateEepromDump* dump,
+    const PirateEepromPart* part,
+    uint8_t address,
+    const char* path) {
+    furi_assert(dump);
+
+    if(dump->busy) {
+        return false;
+    }
+
+    // Reap the last run's thread before we reuse it.
+    furi_thread_join(dump->reader);
+
+    dump->part = part;
+    dump->address = address;
+    furi_string_set_str(dump->path, path);
+
+    dump->abort = false;
+    dump->busy = true;
+    furi_thread_start(dump->reader);
+
+    return true;
+}
+
+void pirate_eeprom_dump_abort(PirateEepromDump* dump) {
+    furi_assert(dump);
+    dump->abort = true;
+}
+
+bool pirate_eeprom_dump_is_busy(PirateEepromDump* dump) {
+    furi_assert(dump);
+    return dump->busy;
+}
+
+uint32_t pirate_eeprom_dump_get_progress(PirateEepromDump* dump) {
+    furi_assert(dump);
+    return dump->bytes_written;
+}
+
+void pirate_eeprom_dump_get_result(PirateEepromDump* dump, PirateEepromResult* result) {
+    furi_assert(dump);
+    memcpy(result, &dump->result, sizeof(*result));
+}
+
+const char* pirate_eeprom_status_description(PirateEepromStatus status) {
+    switch(status) {
+    case PirateEepromStatusOk:
+        return "Done";
+    case PirateEepromStatusNak:
+        return "No response from part";
+    case PirateEepromStatusStorageError:
+        return "SD card error";
+    case PirateEepromStatusAborted:
+        return "Aborted";
+    }
+
+    return "Unknown status";
+}
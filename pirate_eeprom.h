@@ -0,0 +1,97 @@
+/**
+ * @file pirate_eeprom.h
+ * Dumps 24Cxx-family I2C EEPROMs to the SD card.
+ *
+ * A reader thread streams the whole array in one sequential-read transaction, while a writer
+ * thread stores the previous block; the two trade a pair of ping-pong buffers, so the bus
+ * never waits on the card except when the card is genuinely slower.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <gui/view_dispatcher.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Size of each of our two ping-pong buffers. */
+#define PIRATE_EEPROM_BLOCK_SIZE 512
+
+/** How often we report progress, in bytes. */
+#define PIRATE_EEPROM_PROGRESS_INTERVAL 4096
+
+/** Default (8-bit) device address; all address pins tied low. */
+#define PIRATE_EEPROM_DEFAULT_ADDRESS 0xA0
+
+typedef struct {
+    const char* name;
+
+    /** Total size, in bytes. */
+    uint32_t size;
+
+    /** Number of word-address bytes; small parts put the excess bits in the device address. */
+    uint8_t address_bytes;
+} PirateEepromPart;
+
+extern const PirateEepromPart pirate_eeprom_parts[];
+extern const size_t pirate_eeprom_part_count;
+
+typedef enum {
+    PirateEepromStatusOk,
+    PirateEepromStatusNak,
+    PirateEepromStatusStorageError,
+    PirateEepromStatusAborted,
+} PirateEepromStatus;
+
+typedef struct {
+    PirateEepromStatus status;
+    uint32_t bytes_read;
+    uint32_t bytes_written;
+    uint32_t duration_ms;
+} PirateEepromResult;
+
+typedef struct PirateEepromDump PirateEepromDump;
+
+/**
+ * @param view_dispatcher   Receives our progress and completion events.
+ * @param progress_event    Custom event sent every PIRATE_EEPROM_PROGRESS_INTERVAL bytes.
+ * @param complete_event    Custom event sent once the dump has finished, for any reason.
+ */
+PirateEepromDump* pirate_eeprom_dump_alloc(
+    ViewDispatcher* view_dispatcher,
+    uint32_t progress_event,
+    uint32_t complete_event);
+
+/** Aborts any dump in progress, and frees the dumper. */
+void pirate_eeprom_dump_free(PirateEepromDump* dump);
+
+/**
+ * Starts dumping a part. Never blocks.
+ *
+ * @param part      The part to dump.
+ * @param address   The part's 8-bit device address.
+ * @param path      The file to dump to; overwritten if it exists.
+ * @return False if a dump is already running.
+ */
+bool pirate_eeprom_dump_start(
+    PirateEepromDump* dump,
+    const PirateEepromPart* part,
+    uint8_t address,
+    const char* path);
+
+void pirate_eeprom_dump_abort(PirateEepromDump* dump);
+bool pirate_eeprom_dump_is_busy(PirateEepromDump* dump);
+
+/** Returns the number of bytes safely on the card so far. */
+uint32_t pirate_eeprom_dump_get_progress(PirateEepromDump* dump);
+
+/** Fetches the result of the most recently finished dump. */
+void pirate_eeprom_dump_get_result(PirateEepromDump* dump, PirateEepromResult* result);
+
+const char* pirate_eeprom_status_description(PirateEepromStatus status);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,523 @@
+#include "pirate_engine.h"
+
+#include "bus/bus_i2c.h"
+#include "bus/bus_onewire.h"
+#include "bus/bus_spi.h"
+
+#include <furi_hal.h>
+#include <storage/storage.h>
+
+#define PIRATE_ENGINE_STACK_SIZE 2048
+
+typedef enum {
+    PirateEngineFlagRun = (1 << 0),
+    PirateEngineFlagExit = (1 << 1),
+    PirateEngineFlagRunScript = (1 << 2),
+} PirateEngineFlag;
+
+struct PirateEngine {
+    FuriThread* thread;
+
+    /** Where we report completion. */
+    ViewDispatcher* view_dispatcher;
+    uint32_t complete_event;
+
+    /** The bus we execute against, and the state of each one it can be. */
+    PirateBus bus;
+    PirateI2cBus i2c;
+    PirateSpiBus spi;
+    PirateOneWireBus onewire;
+
+    /** The fastest clock each I2C device's been found to handle; kept for as long as we are. */
+    PirateI2cSpeedCache i2c_speeds;
+
+    /**
+     * Our private copies of the programs to run. A batch is queued up here from the GUI
+     * thread, then handed to the worker whole; a single command is just a batch of one.
+     */
+    PirateProgram batch[PIRATE_ENGINE_BATCH_MAX];
+    uint8_t queued;
+    uint8_t batch_length;
+
+    /**
+     * The script being run, if any; each of its lines is compiled into our program in turn.
+     * Its state is only needed while it runs, so it's borrowed from the arena for each run.
+     */
+    Storage* storage;
+    File* script_file;
+    char script_path[PIRATE_ENGINE_PATH_MAX + 1];
+    PirateArena* arena;
+
+    PirateResultStore* results;
+    PirateEngineResult result;
+
+    /** Transaction timing for the current run, in cycles. */
+    PirateLatency latency;
+    PirateLatency gaps;
+    uint32_t transaction_began;
+    uint32_t transaction_ended;
+    bool have_transaction;
+
+    volatile bool busy;
+    volatile bool abort;
+};
+
+/**
+ * Sink callbacks; called from the worker thread.
+ */
+
+static void pirate_engine_handle_data(void* context, const uint8_t* data, size_t length) {
+    PirateEngine* engine = context;
+
+    // This only fails if we've been cancelled, in which case the interpreter will stop shortly.
+    pirate_result_store_write(engine->results, data, length);
+    engine->result.bytes_read += length;
+}
+
+static bool pirate_engine_should_abort(void* context) {
+    PirateEngine* engine = context;
+    return engine->abort;
+}
+
+static void pirate_engine_transaction_begin(void* context) {
+    PirateEngine* engine = context;
+    engine->transaction_began = DWT->CYCCNT;
+
+    if(engine->have_transaction) {
+        pirate_latency_record(&engine->gaps, engine->transaction_began - engine->transaction_ended);
+    }
+}
+
+static void pirate_engine_transaction_end(void* context) {
+    PirateEngine* engine = context;
+    engine->transaction_ended = DWT->CYCCNT;
+    engine->have_transaction = true;
+
+    // Unsigned subtraction keeps this right across a wrap of the counter.
+    pirate_latency_record(&engine->latency, engine->transaction_ended - engine->transaction_began);
+}
+
+/** Clears out the last run's results, ready for a new one. */
+static void pirate_engine_begin_run(PirateEngine* engine) {
+    memset(&engine->result, 0, sizeof(engine->result));
+
+    pirate_latency_reset(&engine->latency);
+    pirate_latency_reset(&engine->gaps);
+    engine->have_transaction = false;
+}
+
+/** Boils the run's timing down into its result. */
+static void pirate_engine_end_run(PirateEngine* engine) {
+    pirate_latency_summarize(&engine->latency, &engine->result.latency);
+    pirate_latency_summarize(&engine->gaps, &engine->result.gaps);
+    engine->result.cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+    engine->result.bus_cycles = engine->latency.total;
+}
+
+/** Takes the bus, if it needs taking; nothing else may use it until we let it go. */
+static void pirate_engine_acquire(PirateEngine* engine) {
+    if(engine->bus.acquire) {
+        engine->bus.acquire(engine->bus.context);
+    }
+}
+
+static void pirate_engine_release(PirateEngine* engine) {
+    if(engine->bus.release) {
+        engine->bus.release(engine->bus.context);
+    }
+}
+
+/** Runs a program on the bus we've already acquired, adding its statistics to the result. */
+static PirateExecStatus pirate_engine_execute_program(PirateEngine* engine, const PirateProgram* program) {
+    PirateSink sink = {
+        .data = pirate_engine_handle_data,
+        .should_abort = pirate_engine_should_abort,
+        .transaction_begin = pirate_engine_transaction_begin,
+        .transaction_end = pirate_engine_transaction_end,
+        .context = engine,
+    };
+
+    PirateExecReport report;
+    PirateExecStatus status = pirate_execute(program, &engine->bus, &sink, &report);
+
+    engine->result.error_offset = report.error_offset;
+    engine->result.transactions += report.transactions;
+    engine->result.bytes_written += report.bytes_written;
+    engine->result.commands += 1;
+
+    return status;
+}
+
+static void pirate_engine_execute(PirateEngine* engine) {
+    uint32_t expected = 0;
+
+    pirate_engine_begin_run(engine);
+    engine->result.batch_length = engine->batch_length;
+
+    for(uint8_t i = 0; i < engine->batch_length; ++i) {
+        expected += engine->batch[i].read_count;
+    }
+    pirate_result_store_begin(engine->results, expected);
+
+    uint32_t start = furi_get_tick();
+
+    // The whole batch runs back to back under a single acquire; so nothing else gets the bus
+    // between commands, and the gaps between them are only as long as our own overhead.
+    pirate_engine_acquire(engine);
+    for(uint8_t i = 0; i < engine->batch_length; ++i) {
+        engine->result.status = pirate_engine_execute_program(engine, &engine->batch[i]);
+
+        if(engine->result.status != PirateExecOk) {
+            break;
+        }
+        if(engine->abort && (i + 1 < engine->batch_length)) {
+            engine->result.status = PirateExecAborted;
+            break;
+        }
+    }
+    pirate_engine_release(engine);
+
+    engine->result.duration_ms = furi_get_tick() - start;
+
+    pirate_result_store_end(engine->results);
+    pirate_engine_end_run(engine);
+}
+
+static void pirate_engine_execute_script(PirateEngine* engine) {
+    size_t mark = pirate_arena_mark(engine->arena);
+    PirateScript* script = pirate_arena_alloc(engine->arena, sizeof(PirateScript));
+    PirateScriptStatus status = PirateScriptStatusOpenFailed;
+
+    // The arena's sized to leave room for this; so running out is a bug, not bad luck.
+    furi_check(script);
+
+    pirate_engine_begin_run(engine);
+    pirate_result_store_begin(engine->results, UINT32_MAX);
+
+    uint32_t start = furi_get_tick();
+
+    // Each line is compiled straight into our program, and run before the next is read;
+    // so only one line of the script is ever in memory.
+    if(pirate_script_open(script, engine->script_file, engine->script_path)) {
+        while((status = pirate_script_next(script, &engine->batch[0])) == PirateScriptStatusOk) {
+            pirate_engine_acquire(engine);
+            engine->result.status = pirate_engine_execute_program(engine, &engine->batch[0]);
+            pirate_engine_release(engine);
+
+            if(engine->result.status != PirateExecOk) {
+                break;
+            }
+            if(engine->abort) {
+                engine->result.status = PirateExecAborted;
+                break;
+            }
+        }
+    }
+
+    engine->result.duration_ms = furi_get_tick() - start;
+    engine->result.script = true;
+    engine->result.script_status = status;
+    engine->result.script_line = script->line_number;
+    engine->result.compile_error = script->error;
+
+    pirate_script_close(script);
+    pirate_result_store_end(engine->results);
+    pirate_engine_end_run(engine);
+
+    pirate_arena_release(engine->arena, mark);
+}
+
+static int32_t pirate_engine_worker(void* context) {
+    PirateEngine* engine = context;
+
+    while(true) {
+        uint32_t flags = furi_thread_flags_wait(
+            PirateEngineFlagRun | PirateEngineFlagRunScript | PirateEngineFlagExit,
+            FuriFlagWaitAny,
+            FuriWaitForever);
+
+        if(flags & PirateEngineFlagExit) {
+            break;
+        }
+
+        if(flags & (PirateEngineFlagRun | PirateEngineFlagRunScript)) {
+            if(flags & PirateEngineFlagRunScript) {
+                pirate_engine_execute_script(engine);
+            } else {
+                pirate_engine_execute(engine);
+            }
+
+            // Mark ourselves idle before we notify, so the GUI can immediately queue another run.
+            engine->busy = false;
+            view_dispatcher_send_custom_event(engine->view_dispatcher, engine->complete_event);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Public API; called from the GUI thread.
+ */
+
+PirateEngine* pirate_engine_alloc(
+    ViewDispatcher* view_dispatcher,
+    uint32_t complete_event,
+    PirateResultStore* results,
+    PirateArena* arena) {
+    PirateEngine* engine = pirate_arena_alloc(arena, sizeof(PirateEngine));
+    furi_check(engine);
+
+    engine->view_dispatcher = view_dispatcher;
+    engine->complete_event = complete_event;
+    engine->results = results;
+    engine->arena = arena;
+
+    engine->storage = furi_record_open(RECORD_STORAGE);
+    engine->script_file = storage_file_alloc(engine->storage);
+
+    pirate_i2c_bus_init(
+        &engine->bus, &engine->i2c, &furi_hal_i2c_handle_external, &engine->i2c_speeds);
+
+    engine->thread =
+        furi_thread_alloc_ex("PirateEngine", PIRATE_ENGINE_STACK_SIZE, pirate_engine_worker, engine);
+    furi_thread_start(engine->thread);
+
+    return engine;
+}
+
+void pirate_engine_free(PirateEngine* engine) {
+    furi_assert(engine);
+
+    // A run waiting on a full result ring would never look at the abort flag; so cancel the
+    // store too, or the join below could wait forever.
+    pirate_engine_abort(engine);
+    furi_thread_flags_set(furi_thread_get_id(engine->thread), PirateEngineFlagExit);
+    furi_thread_join(engine->thread);
+    furi_thread_free(engine->thread);
+
+    storage_file_free(engine->script_file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+bool pirate_engine_run(PirateEngine* engine, const PirateProgram* program) {
+    furi_assert(engine);
+
+    if(engine->busy) {
+        return false;
+    }
+
+    pirate_engine_clear_queue(engine);
+    pirate_engine_queue(engine, program);
+    return pirate_engine_run_queue(engine);
+}
+
+bool pirate_engine_queue(PirateEngine* engine, const PirateProgram* program) {
+    furi_assert(engine);
+
+    // The worker only looks at the batch while it's running one.
+    if(engine->busy || (engine->queued == PIRATE_ENGINE_BATCH_MAX)) {
+        return false;
+    }
+
+    memcpy(&engine->batch[engine->queued++], program, sizeof(PirateProgram));
+    return true;
+}
+
+bool pirate_engine_queue_long(
+    PirateEngine* engine,
+    const char* text,
+    PirateError* error,
+    size_t* error_offset) {
+    furi_assert(engine);
+
+    size_t queued = engine->queued;
+    size_t length = strlen(text);
+    size_t start = 0;
+
+    *error = PirateErrorNone;
+    if(engine->busy) {
+        return false;
+    }
+
+    // Compile straight into the batch; it's only ours to run once every piece is in.
+    while(start < length) {
+        size_t consumed;
+
+        if(engine->queued == PIRATE_ENGINE_BATCH_MAX) {
+            *error = PirateErrorProgramTooLong;
+            *error_offset = start;
+            break;
+        }
+
+        PirateProgram* program = &engine->batch[engine->queued];
+        *error = pirate_compile_part(&text[start], length - start, program, &consumed, error_offset);
+        if(*error != PirateErrorNone) {
+            *error_offset += start;
+            break;
+        }
+
+        // Trailing space compiles to nothing; there's no need to run it.
+        if(program->length > 0) {
+            engine->queued += 1;
+        }
+        start += consumed;
+    }
+
+    if(*error != PirateErrorNone) {
+        engine->queued = queued;
+        return false;
+    }
+    return true;
+}
+
+size_t pirate_engine_queue_length(PirateEngine* engine) {
+    furi_assert(engine);
+    return engine->queued;
+}
+
+void pirate_engine_clear_queue(PirateEngine* engine) {
+    furi_assert(engine);
+
+    if(!engine->busy) {
+        engine->queued = 0;
+    }
+}
+
+bool pirate_engine_run_queue(PirateEngine* engine) {
+    furi_assert(engine);
+
+    if(engine->busy || !engine->queued) {
+        return false;
+    }
+
+    engine->batch_length = engine->queued;
+    engine->queued = 0;
+    engine->abort = false;
+    engine->busy = true;
+
+    furi_thread_flags_set(furi_thread_get_id(engine->thread), PirateEngineFlagRun);
+    return true;
+}
+
+bool pirate_engine_run_script(PirateEngine* engine, const char* path) {
+    furi_assert(engine);
+
+    if(engine->busy || (strlen(path) > PIRATE_ENGINE_PATH_MAX)) {
+        return false;
+    }
+
+    // Scripts compile each line into the batch's first slot; anything queued there is gone.
+    engine->queued = 0;
+
+    strcpy(engine->script_path, path);
+    engine->abort = false;
+    engine->busy = true;
+
+    furi_thread_flags_set(furi_thread_get_id(engine->thread), PirateEngineFlagRunScript);
+    return true;
+}
+
+bool pirate_engine_set_bus(PirateEngine* engine, PirateEngineBus bus) {
+    furi_assert(engine);
+
+    if(engine->busy) {
+        return false;
+    }
+
+    // Only the worker touches the bus during a run; and there isn't one.
+    if(bus == PirateEngineBusSpi) {
+        pirate_spi_bus_init(&engine->bus, &engine->spi, &furi_hal_spi_bus_handle_external);
+    } else if(bus == PirateEngineBusOneWire) {
+        pirate_onewire_bus_init(&engine->bus, &engine->onewire);
+    } else {
+        pirate_i2c_bus_init(
+            &engine->bus, &engine->i2c, &furi_hal_i2c_handle_external, &engine->i2c_speeds);
+    }
+    return true;
+}
+
+void pirate_engine_abort(PirateEngine* engine) {
+    furi_assert(engine);
+    engine->abort = true;
+    pirate_result_store_cancel(engine->results);
+}
+
+uint32_t pirate_engine_get_stack_headroom(PirateEngine* engine) {
+    furi_assert(engine);
+    return furi_thread_get_stack_space(furi_thread_get_id(engine->thread));
+}
+
+bool pirate_engine_is_busy(PirateEngine* engine) {
+    furi_assert(engine);
+    return engine->busy;
+}
+
+void pirate_engine_get_result(PirateEngine* engine, PirateEngineResult* result) {
+    furi_assert(engine);
+    memcpy(result, &engine->result, sizeof(*result));
+}
+
+uint32_t pirate_engine_result_transactions_per_second(const PirateEngineResult* result) {
+    // Runs quicker than a tick are rounded up, so we never divide by zero.
+    return (uint64_t)result->transactions * 1000 / MAX(result->duration_ms, 1U);
+}
+
+uint32_t pirate_engine_result_bytes_per_second(const PirateEngineResult* result) {
+    uint64_t bytes = (uint64_t)result->bytes_read + result->bytes_written;
+
+    if(!result->bus_cycles) {
+        return 0;
+    }
+    return MIN(bytes * result->cycles_per_us * 1000000 / result->bus_cycles, (uint64_t)UINT32_MAX);
+}
+
+bool pirate_engine_result_export(const PirateEngineResult* result, const char* command) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    FuriString* row = furi_string_alloc();
+    bool success = false;
+
+    if(storage_file_open(file, PIRATE_ENGINE_LATENCY_PATH, FSAM_WRITE, FSOM_OPEN_APPEND)) {
+        if(!storage_file_size(file)) {
+            furi_string_cat_str(
+                row,
+                "command,status,transactions,duration_ms,cycles_per_us,min_cycles,mean_cycles,"
+                "p50_cycles,p90_cycles,p99_cycles,max_cycles,gap_mean_cycles,gap_max_cycles\n");
+        }
+
+        // Commands are quoted, as they're usually full of commas.
+        furi_string_cat_str(row, "\"");
+        for(const char* c = command; *c; ++c) {
+            if(*c == '"') {
+                furi_string_cat_str(row, "\"\"");
+            } else {
+                furi_string_cat_printf(row, "%c", *c);
+            }
+        }
+        furi_string_cat_printf(
+            row,
+            "\",%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+            pirate_exec_status_description(result->status),
+            (unsigned long)result->transactions,
+            (unsigned long)result->duration_ms,
+            (unsigned long)result->cycles_per_us,
+            (unsigned long)result->latency.min,
+            (unsigned long)result->latency.mean,
+            (unsigned long)result->latency.p50,
+            (unsigned long)result->latency.p90,
+            (unsigned long)result->latency.p99,
+            (unsigned long)result->latency.max,
+            (unsigned long)result->gaps.mean,
+            (unsigned long)result->gaps.max);
+
+        size_t length = furi_string_size(row);
+        success = (storage_file_write(file, furi_string_get_cstr(row), length) == length);
+        storage_file_close(file);
+    }
+
+    furi_string_free(row);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return success;
+}
@@ -0,0 +1,210 @@
+/**
+ * @file pirate_engine.h
+ * Command execution engine: runs compiled programs on a worker thread.
+ *
+ * The GUI hands the engine a program (or a script to stream off the SD card) and carries on;
+ * when the run finishes the engine posts a custom event to the view dispatcher, so nothing on
+ * the GUI side ever waits on the bus.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <gui/view_dispatcher.h>
+
+#include "lib/libpirate.h"
+#include "lib/pirate_arena.h"
+#include "lib/pirate_latency.h"
+#include "pirate_result.h"
+#include "pirate_script.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Where exported latency statistics are appended, one run per row. */
+#define PIRATE_ENGINE_LATENCY_PATH APP_DATA_PATH("latency.csv")
+
+/** Longest script path we'll run. */
+#define PIRATE_ENGINE_PATH_MAX 255
+
+/** Most commands a batch can hold. */
+#define PIRATE_ENGINE_BATCH_MAX 8
+
+typedef struct PirateEngine PirateEngine;
+
+/** The buses the engine can run commands against. */
+typedef enum {
+    PirateEngineBusI2c,
+    PirateEngineBusSpi,
+    PirateEngineBusOneWire,
+} PirateEngineBus;
+
+/** Summary of the most recent run. */
+typedef struct {
+    PirateExecStatus status;
+
+    /** Bytecode offset of the operation that failed, if any. */
+    size_t error_offset;
+
+    /** Number of bytes read from, and written to, the bus. */
+    uint32_t bytes_read;
+    uint32_t bytes_written;
+
+    /** Number of bus transactions completed. */
+    uint32_t transactions;
+
+    /** Wall-clock duration of the run, in milliseconds. */
+    uint32_t duration_ms;
+
+    /**
+     * Time spent in each transaction, from just before its start to just after its stop; and
+     * in the gaps between them, which is our own overhead plus any delays asked for. Both are
+     * timed in CPU cycles; cycles_per_us converts them to wall time.
+     */
+    PirateLatencySummary latency;
+    PirateLatencySummary gaps;
+    uint32_t cycles_per_us;
+
+    /** Total time spent inside transactions, in cycles. */
+    uint64_t bus_cycles;
+
+    /** Number of commands run; one, unless we were running a batch or a script. */
+    uint32_t commands;
+
+    /** For batches: how many commands were queued to run; it stopped short if commands is fewer. */
+    uint32_t batch_length;
+
+    /** For scripts: whether the script itself ran to the end, and if not, where it stopped. */
+    bool script;
+    PirateScriptStatus script_status;
+    uint32_t script_line;
+    PirateError compile_error;
+} PirateEngineResult;
+
+/** Returns the transaction rate of a run, in transactions per second. */
+uint32_t pirate_engine_result_transactions_per_second(const PirateEngineResult* result);
+
+/**
+ * Returns the data rate of a run, in bytes per second, read and written combined. Only time
+ * spent inside transactions counts; so this is what the bus itself managed.
+ */
+uint32_t pirate_engine_result_bytes_per_second(const PirateEngineResult* result);
+
+/**
+ * Appends a run's latency statistics to PIRATE_ENGINE_LATENCY_PATH, as a row of CSV.
+ * The file gets a header row when it's first created.
+ *
+ * @param result    The run to export.
+ * @param command   What was run; the command text, or the script's path.
+ * @return False if the row couldn't be written.
+ */
+bool pirate_engine_result_export(const PirateEngineResult* result, const char* command);
+
+/**
+ * Allocates an engine, and starts its worker thread.
+ *
+ * Runs never touch the heap: the engine lives in the arena, and borrows anything it needs for
+ * a single run from the arena, giving it back at the end of the run. Nothing else may allocate
+ * from the arena once the engine's running.
+ *
+ * @param view_dispatcher   The dispatcher to notify when a run completes.
+ * @param complete_event    The custom event to send on completion.
+ * @param results           Store to receive data read from the bus.
+ * @param arena             Where the engine lives; it must outlast the engine.
+ */
+PirateEngine* pirate_engine_alloc(
+    ViewDispatcher* view_dispatcher,
+    uint32_t complete_event,
+    PirateResultStore* results,
+    PirateArena* arena);
+
+/** Stops the worker thread, aborting any run in progress, and frees the engine. */
+void pirate_engine_free(PirateEngine* engine);
+
+/**
+ * Starts running a program. Never blocks; the program is copied, so the caller's may go away.
+ * Anything queued is discarded.
+ *
+ * @return False if the engine was already busy, in which case nothing happens.
+ */
+bool pirate_engine_run(PirateEngine* engine, const PirateProgram* program);
+
+/**
+ * Adds a program to the batch the next pirate_engine_run_queue() will run. The program is
+ * copied, so the caller's may go away.
+ *
+ * @return False if the engine's busy, or the batch already holds PIRATE_ENGINE_BATCH_MAX programs.
+ */
+bool pirate_engine_queue(PirateEngine* engine, const PirateProgram* program);
+
+/**
+ * Compiles a command too long for one program into as many as it takes, and adds them to the
+ * batch; each stops between two of the command's transactions or loops, so running them back
+ * to back has the same effect as running the command whole.
+ *
+ * @param text          The command text.
+ * @param error         Populated with why the command couldn't be queued; PirateErrorNone if
+ *                      the engine's busy.
+ * @param error_offset  Populated with the text offset of any compile error. If the batch runs
+ *                      out of room, the error's PirateErrorProgramTooLong, at the first piece
+ *                      that didn't fit.
+ * @return False, with nothing added, if the command couldn't be queued whole.
+ */
+bool pirate_engine_queue_long(
+    PirateEngine* engine,
+    const char* text,
+    PirateError* error,
+    size_t* error_offset);
+
+/** Returns the number of programs queued to run. */
+size_t pirate_engine_queue_length(PirateEngine* engine);
+
+/** Discards everything queued; does nothing while a run's in progress. */
+void pirate_engine_clear_queue(PirateEngine* engine);
+
+/**
+ * Starts running everything queued, in order, and empties the queue. Never blocks.
+ *
+ * The bus is acquired once for the whole batch, and the programs are run back to back, with
+ * no trip through the GUI between them; the batch stops at the first program that fails.
+ * It completes with a single event, and a single result, covering every program run.
+ *
+ * @return False if the engine was already busy, or nothing's queued; in which case nothing happens.
+ */
+bool pirate_engine_run_queue(PirateEngine* engine);
+
+/**
+ * Starts running a script file, one line at a time. Never blocks; the script is streamed off
+ * the card by the worker thread, and stops at the first line that fails.
+ *
+ * Since we can't know up front how much a script will read, its reads always go to the SD card.
+ * Anything queued is discarded.
+ *
+ * @return False if the engine was already busy, or the path is longer than
+ *         PIRATE_ENGINE_PATH_MAX; in which case nothing happens.
+ */
+bool pirate_engine_run_script(PirateEngine* engine, const char* path);
+
+/**
+ * Chooses the bus that later runs talk to; the engine starts out on I2C.
+ *
+ * @return False if a run is in progress, in which case nothing changes.
+ */
+bool pirate_engine_set_bus(PirateEngine* engine, PirateEngineBus bus);
+
+/** Asks any run in progress to stop at the next opportunity. */
+void pirate_engine_abort(PirateEngine* engine);
+
+/** Returns the least stack the worker thread has had to spare, in bytes, since it started. */
+uint32_t pirate_engine_get_stack_headroom(PirateEngine* engine);
+
+/** Returns true iff a run is in progress. */
+bool pirate_engine_is_busy(PirateEngine* engine);
+
+/** Fetches the summary of the most recently completed run. */
+void pirate_engine_get_result(PirateEngine* engine, PirateEngineResult* result);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,227 @@
+#include "pirate_hex_dump.h"
+#include <furi.h>
+#include <gui/elements.h>
+
+struct PirateHexDump {
+    View* view;
+};
+
+typedef struct {
+    PirateResultStore* results;
+    uint32_t length;
+
+    /** The first row on screen; and the bytes of every row that is, as of the last scroll. */
+    uint32_t top_row;
+    uint8_t window[PIRATE_HEX_DUMP_ROWS * PIRATE_HEX_DUMP_ROW_BYTES];
+    size_t window_length;
+} PirateHexDumpModel;
+
+static const uint8_t header_height = 10;
+static const uint8_t row_height = 9;
+
+/** Past 64 KiB, offsets need more digits than fit beside the ASCII column; so it goes. */
+static const uint32_t ascii_limit = 0x10000;
+
+static uint32_t pirate_hex_dump_row_count(uint32_t length) {
+    return (length + PIRATE_HEX_DUMP_ROW_BYTES - 1) / PIRATE_HEX_DUMP_ROW_BYTES;
+}
+
+/** The top row that puts the end of the result at the bottom of the screen. */
+static uint32_t pirate_hex_dump_last_top_row(uint32_t length) {
+    uint32_t rows = pirate_hex_dump_row_count(length);
+    return (rows > PIRATE_HEX_DUMP_ROWS) ? rows - PIRATE_HEX_DUMP_ROWS : 0;
+}
+
+/**
+ * @brief Formats a single row: its offset, its bytes in hex, and then, for results that leave
+ * room, as ASCII
+ */
+static void pirate_hex_dump_format_row(
+    char* text,
+    size_t size,
+    uint32_t offset,
+    const uint8_t* data,
+    size_t count,
+    bool ascii) {
+    static const char digits[] = "0123456789ABCDEF";
+    size_t position = snprintf(text, size, ascii ? "%04lX" : "%06lX", (unsigned long)offset);
+
+    for(size_t i = 0; i < PIRATE_HEX_DUMP_ROW_BYTES; ++i) {
+        text[position++] = ' ';
+        text[position++] = (i < count) ? digits[data[i] >> 4] : ' ';
+        text[position++] = (i < count) ? digits[data[i] & 0xF] : ' ';
+    }
+
+    if(ascii) {
+        text[position++] = ' ';
+        for(size_t i = 0; i < count; ++i) {
+            text[position++] = ((data[i] >= 0x20) && (data[i] < 0x7F)) ? data[i] : '.';
+        }
+    }
+
+    text[position] = 0;
+}
+
+/**
+ * @brief Draw callback
+ */
+static void pirate_hex_dump_draw_callback(Canvas* canvas, void* _model) {
+    PirateHexDumpModel* model = _model;
+    char text[32];
+
+    canvas_clear(canvas);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_set_font(canvas, FontSecondary);
+
+    snprintf(text, sizeof(text), "%lu bytes", (unsigned long)model->length);
+    canvas_draw_str(canvas, 0, 8, text);
+    canvas_draw_line(canvas, 0, header_height - 1, 127, header_height - 1);
+
+    if(!model->length) {
+        canvas_draw_str_aligned(canvas, 64, 36, AlignCenter, AlignCenter, "Nothing was read.");
+        return;
+    }
+
+    // Each row's position is where its window bytes say it is; a short window means the
+    // store couldn't give us the rest, and those rows stay blank.
+    canvas_set_font(canvas, FontKeyboard);
+    for(uint8_t row = 0; row < PIRATE_HEX_DUMP_ROWS; ++row) {
+        size_t start = row * PIRATE_HEX_DUMP_ROW_BYTES;
+        if(start >= model->window_length) {
+            break;
+        }
+
+        uint32_t offset = (model->top_row + row) * PIRATE_HEX_DUMP_ROW_BYTES;
+        size_t count = MIN(model->window_length - start, (size_t)PIRATE_HEX_DUMP_ROW_BYTES);
+
+        pirate_hex_dump_format_row(
+            text, sizeof(text), offset, &model->window[start], count, model->length <= ascii_limit);
+        canvas_draw_str(canvas, 0, header_height + row_height * (row + 1) - 1, text);
+    }
+
+    elements_scrollbar(canvas, model->top_row, pirate_hex_dump_last_top_row(model->length) + 1);
+}
+
+/**
+ * @brief Moves to the given top row, and reads back what's now on screen
+ *
+ * The store may have to go to the SD card for it; so we read outside the model's lock, and
+ * the GUI never waits on the card to draw.
+ */
+static void pirate_hex_dump_scroll_to(PirateHexDump* hex_dump, int64_t top_row) {
+    PirateResultStore* results = NULL;
+    uint32_t length = 0;
+    uint8_t window[PIRATE_HEX_DUMP_ROWS * PIRATE_HEX_DUMP_ROW_BYTES];
+    size_t window_length = 0;
+
+    with_view_model(
+        hex_dump->view, PirateHexDumpModel * model, {
+            results = model->results;
+            length = model->length;
+        }, false);
+
+    top_row = CLAMP(top_row, (int64_t)pirate_hex_dump_last_top_row(length), 0);
+
+    uint32_t offset = top_row * PIRATE_HEX_DUMP_ROW_BYTES;
+    size_t wanted = MIN(length - MIN(offset, length), sizeof(window));
+    while(results && (window_length < wanted)) {
+        size_t count = pirate_result_store_read(
+            results, offset + window_length, &window[window_length], wanted - window_length);
+        if(!count) {
+            break;
+        }
+        window_length += count;
+    }
+
+    with_view_model(
+        hex_dump->view, PirateHexDumpModel * model, {
+            model->top_row = top_row;
+            memcpy(model->window, window, window_length);
+            model->window_length = window_length;
+        }, true);
+}
+
+/**
+ * @brief Input callback
+ */
+static bool pirate_hex_dump_input_callback(InputEvent* event, void* context) {
+    PirateHexDump* hex_dump = context;
+    furi_assert(hex_dump);
+    int64_t top_row = 0;
+    uint32_t length = 0;
+
+    if(event->type != InputTypeShort && event->type != InputTypeRepeat && event->type != InputTypeLong) {
+        return false;
+    }
+    if(event->key != InputKeyUp && event->key != InputKeyDown && event->key != InputKeyLeft &&
+       event->key != InputKeyRight) {
+        return false;
+    }
+
+    with_view_model(
+        hex_dump->view, PirateHexDumpModel * model, {
+            top_row = model->top_row;
+            length = model->length;
+        }, false);
+
+    if(event->type == InputTypeLong) {
+        if(event->key == InputKeyLeft) {
+            top_row = 0;
+        } else if(event->key == InputKeyRight) {
+            top_row = pirate_hex_dump_last_top_row(length);
+        } else {
+            return true;
+        }
+    } else if(event->key == InputKeyUp) {
+        top_row -= 1;
+    } else if(event->key == InputKeyDown) {
+        top_row += 1;
+    } else if(event->key == InputKeyLeft) {
+        top_row -= PIRATE_HEX_DUMP_ROWS;
+    } else {
+        top_row += PIRATE_HEX_DUMP_ROWS;
+    }
+
+    pirate_hex_dump_scroll_to(hex_dump, top_row);
+    return true;
+}
+
+PirateHexDump* pirate_hex_dump_alloc() {
+    PirateHexDump* hex_dump = malloc(sizeof(PirateHexDump));
+    hex_dump->view = view_alloc();
+    view_set_context(hex_dump->view, hex_dump);
+    view_allocate_model(hex_dump->view, ViewModelTypeLocking, sizeof(PirateHexDumpModel));
+    view_set_draw_callback(hex_dump->view, pirate_hex_dump_draw_callback);
+    view_set_input_callback(hex_dump->view, pirate_hex_dump_input_callback);
+
+    with_view_model(
+        hex_dump->view, PirateHexDumpModel * model, {
+            memset(model, 0, sizeof(*model));
+        }, false);
+
+    return hex_dump;
+}
+
+void pirate_hex_dump_free(PirateHexDump* hex_dump) {
+    furi_assert(hex_dump);
+    view_free(hex_dump->view);
+    free(hex_dump);
+}
+
+View* pirate_hex_dump_get_view(PirateHexDump* hex_dump) {
+    furi_assert(hex_dump);
+    return hex_dump->view;
+}
+
+void pirate_hex_dump_set_result(PirateHexDump* hex_dump, PirateResultStore* results) {
+    furi_assert(hex_dump);
+
+    with_view_model(
+        hex_dump->view, PirateHexDumpModel * model, {
+            model->results = results;
+            model->length = results ? pirate_result_store_length(results) : 0;
+            model->window_length = 0;
+        }, false);
+
+    pirate_hex_dump_scroll_to(hex_dump, 0);
+}
@@ -0,0 +1,42 @@
+/**
+ * @file pirate_hex_dump.h
+ * GUI: scrolling hex and ASCII dump of a command's result.
+ *
+ * Only the rows on screen are ever read, or formatted; each scroll reads its screenful back out
+ * of the result store, so paging through a 64 KiB result spooled to SD costs no more than
+ * paging through 16 bytes still in RAM.
+ */
+
+#pragma once
+
+#include <gui/view.h>
+
+#include "pirate_result.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bytes shown on each row; and rows on each screen. */
+#define PIRATE_HEX_DUMP_ROW_BYTES 4
+#define PIRATE_HEX_DUMP_ROWS 6
+
+typedef struct PirateHexDump PirateHexDump;
+
+PirateHexDump* pirate_hex_dump_alloc();
+void pirate_hex_dump_free(PirateHexDump* hex_dump);
+
+/** Get dump view, for adding to a view dispatcher. */
+View* pirate_hex_dump_get_view(PirateHexDump* hex_dump);
+
+/**
+ * Shows a finished result, from its start. Up and Down scroll a row at a time, Left and Right a
+ * screen; held, Left and Right jump to either end.
+ *
+ * @param results   The store to read from; it must hold still, and outlive the view's showing it.
+ */
+void pirate_hex_dump_set_result(PirateHexDump* hex_dump, PirateResultStore* results);
+
+#ifdef __cplusplus
+}
+#endif
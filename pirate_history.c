@@ -0,0 +1,180 @@
+#include "pirate_history.h"
+
+#include <storage/storage.h>
+
+/** Size of the chunks we compare against the most recent entry in. */
+#define PIRATE_HISTORY_COMPARE_CHUNK 64
+
+struct PirateHistory {
+    Storage* storage;
+
+    /** Both files stay open for as long as we do; NULL if they couldn't be opened. */
+    File* log;
+    File* index;
+
+    /** Entries in the index, and the length of the log they point into. */
+    uint32_t count;
+    uint32_t log_size;
+};
+
+static void pirate_history_close(PirateHistory* history) {
+    if(history->log) {
+        storage_file_close(history->log);
+        storage_file_free(history->log);
+        history->log = NULL;
+    }
+    if(history->index) {
+        storage_file_close(history->index);
+        storage_file_free(history->index);
+        history->index = NULL;
+    }
+
+    history->count = 0;
+    history->log_size = 0;
+}
+
+/**
+ * Finds where an entry lives in the log.
+ *
+ * @param entry     The entry's position in the index; 0 is the oldest.
+ * @param start     Populated with the entry's offset in the log.
+ * @param length    Populated with the most the entry can span; it ends at its newline.
+ */
+static bool
+    pirate_history_locate(PirateHistory* history, uint32_t entry, uint32_t* start, uint32_t* length) {
+    uint32_t offsets[2] = {0, history->log_size};
+    size_t wanted = (entry + 1 < history->count) ? sizeof(offsets) : sizeof(offsets[0]);
+
+    if(!storage_file_seek(history->index, entry * sizeof(uint32_t), true) ||
+       (storage_file_read(history->index, offsets, wanted) != wanted)) {
+        return false;
+    }
+
+    // Never trust the index further than the log we actually have.
+    if((offsets[0] > offsets[1]) || (offsets[1] > history->log_size)) {
+        return false;
+    }
+
+    *start = offsets[0];
+    *length = offsets[1] - offsets[0];
+    return true;
+}
+
+/** Returns true iff the given command is the same as the most recent entry. */
+static bool pirate_history_matches_latest(PirateHistory* history, const char* command, size_t length) {
+    char chunk[PIRATE_HISTORY_COMPARE_CHUNK];
+    uint32_t start;
+    uint32_t span;
+
+    // Entries are followed by their newline; so a match spans exactly one more than the command.
+    if(!history->count || !pirate_history_locate(history, history->count - 1, &start, &span) ||
+       (span != length + 1) || !storage_file_seek(history->log, start, true)) {
+        return false;
+    }
+
+    for(size_t position = 0; position < length; position += sizeof(chunk)) {
+        size_t size = MIN(sizeof(chunk), length - position);
+
+        if((storage_file_read(history->log, chunk, size) != size) ||
+           (memcmp(chunk, &command[position], size) != 0)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Public API.
+ */
+
+PirateHistory* pirate_history_alloc() {
+    PirateHistory* history = malloc(sizeof(PirateHistory));
+    memset(history, 0, sizeof(*history));
+
+    history->storage = furi_record_open(RECORD_STORAGE);
+    history->log = storage_file_alloc(history->storage);
+    history->index = storage_file_alloc(history->storage);
+
+    if(!storage_file_open(history->log, PIRATE_HISTORY_LOG_PATH, FSAM_READ_WRITE, FSOM_OPEN_ALWAYS) ||
+       !storage_file_open(
+           history->index, PIRATE_HISTORY_INDEX_PATH, FSAM_READ_WRITE, FSOM_OPEN_ALWAYS)) {
+        FURI_LOG_W("PirateHistory", "can't open command history; it won't be kept");
+        pirate_history_close(history);
+        return history;
+    }
+
+    // A torn final write can leave a partial offset; it's simply ignored, and later overwritten.
+    history->count = storage_file_size(history->index) / sizeof(uint32_t);
+    history->log_size = storage_file_size(history->log);
+
+    return history;
+}
+
+void pirate_history_free(PirateHistory* history) {
+    furi_assert(history);
+
+    pirate_history_close(history);
+    furi_record_close(RECORD_STORAGE);
+    free(history);
+}
+
+uint32_t pirate_history_count(PirateHistory* history) {
+    furi_assert(history);
+    return history->count;
+}
+
+bool pirate_history_append(PirateHistory* history, const char* command) {
+    furi_assert(history);
+
+    uint32_t offset = history->log_size;
+    size_t length = strlen(command);
+
+    if(!history->log) {
+        return false;
+    }
+    if(!length || pirate_history_matches_latest(history, command, length)) {
+        return true;
+    }
+
+    // The log is written first, so the index never points past what's actually there.
+    if(!storage_file_seek(history->log, offset, true) ||
+       (storage_file_write(history->log, command, length) != length) ||
+       (storage_file_write(history->log, "\n", 1) != 1)) {
+        return false;
+    }
+    history->log_size += length + 1;
+
+    if(!storage_file_seek(history->index, history->count * sizeof(uint32_t), true) ||
+       (storage_file_write(history->index, &offset, sizeof(offset)) != sizeof(offset))) {
+        return false;
+    }
+    history->count += 1;
+
+    return true;
+}
+
+bool pirate_history_get(PirateHistory* history, uint32_t age, char* buffer, size_t size) {
+    furi_assert(history);
+    furi_assert(size);
+
+    uint32_t start;
+    uint32_t span;
+
+    if((age >= history->count) ||
+       !pirate_history_locate(history, history->count - 1 - age, &start, &span) ||
+       !storage_file_seek(history->log, start, true)) {
+        return false;
+    }
+
+    size_t read = storage_file_read(history->log, buffer, MIN(span, size - 1));
+    buffer[read] = 0;
+
+    // The entry ends at its newline; anything after that belongs to a write that was cut short.
+    char* newline = memchr(buffer, '\n', read);
+    if(newline) {
+        *newline = 0;
+    }
+
+    return true;
+}
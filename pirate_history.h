@@ -0,0 +1,53 @@
+/**
+ * @file pirate_history.h
+ * Persistent history of the commands we've run.
+ *
+ * Commands are appended to a plain-text log on the SD card, one per line. Alongside it we
+ * keep an index of where each entry starts, as an array of 32-bit offsets; so opening the
+ * history costs the same however long it gets, and any entry can be read with two seeks.
+ * Nothing is held in RAM; entries are read as they're asked for.
+ */
+
+#pragma once
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The log itself, and the index of where each of its entries starts. */
+#define PIRATE_HISTORY_LOG_PATH APP_DATA_PATH("history.log")
+#define PIRATE_HISTORY_INDEX_PATH APP_DATA_PATH("history.idx")
+
+typedef struct PirateHistory PirateHistory;
+
+/** Opens the history; if the card's unavailable, the history simply stays empty. */
+PirateHistory* pirate_history_alloc();
+void pirate_history_free(PirateHistory* history);
+
+/** Returns the number of entries in the history. */
+uint32_t pirate_history_count(PirateHistory* history);
+
+/**
+ * Adds a command to the history; unless it's empty, or the same as the most recent entry.
+ *
+ * @return False if the command couldn't be stored.
+ */
+bool pirate_history_append(PirateHistory* history, const char* command);
+
+/**
+ * Reads back an entry.
+ *
+ * @param history   The history to read from.
+ * @param age       Which entry to read: 0 for the most recent, 1 for the one before, and so on.
+ * @param buffer    Populated with the entry, as a null-terminated string. Left untouched
+ *                  if the entry doesn't exist; truncated if it doesn't fit.
+ * @param size      The size of the buffer, including room for the terminating null.
+ * @return True iff the entry exists, and was read into the buffer.
+ */
+bool pirate_history_get(PirateHistory* history, uint32_t age, char* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
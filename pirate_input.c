@@ -1,12 +1,54 @@
 #include "pirate_input.h"
 #include <gui/elements.h>
+#include <gui/canvas_i.h>
 #include <furi.h>
+#include <furi_hal.h>
+#include <ctype.h>
 
 #include <assets_icons.h>
 #include "pirate_icons.h"
+#include "lib/libpirate.h"
+#include "lib/pirate_latency.h"
+
+/** Tokens we make room for up front; the list grows from here as the command does. */
+#define PIRATE_INPUT_INITIAL_TOKENS 32
+
+/** Most tokens a single-character edit can produce before we re-synchronize; "ab" -> "a[b" makes three. */
+#define PIRATE_INPUT_MAX_RELEXED 4
+
+/** Stands in for a token's offset where there's no such token. */
+#define PIRATE_INPUT_NO_TOKEN UINT16_MAX
+
+/** Longest we'll hold back a held key's repeats waiting for a frame, should one never come. */
+#define PIRATE_INPUT_FRAME_TIMEOUT_MS 100
 
 struct PirateInput {
     View* view;
+
+    /**
+     * Repeats of a held key, not yet applied. They're gathered up while a frame's still
+     * pending, and applied all at once when it's been drawn; so however fast they come, the
+     * model's updated, and redrawn, at most once a frame. Only the input thread touches these.
+     */
+    InputKey repeat_key;
+    uint32_t repeat_count;
+    uint32_t repeat_arrival;
+
+    /** Repeats, and the updates they were applied in, since the key was last released. */
+    uint32_t run_repeats;
+    uint32_t run_updates;
+
+    /** Set when we ask for a redraw; cleared by the draw callback, without the model's lock. */
+    volatile bool frame_pending;
+    uint32_t frame_requested;
+
+    /**
+     * Where the draw callback posts word that the frame's on screen, so what's been held back
+     * can be applied on the input thread; with no more than one such event in flight.
+     */
+    ViewDispatcher* view_dispatcher;
+    uint32_t frame_event;
+    volatile bool frame_event_pending;
 };
 
 typedef struct {
@@ -16,22 +58,119 @@ typedef struct {
 } PirateInputKey;
 
 typedef struct {
+    const PirateInputKey* keys;
+    uint8_t size;
+} PirateInputRow;
+
+/** Which brackets are open at some point in the command. */
+typedef struct {
+    /** Offset of the '[' whose transaction is still open; or PIRATE_INPUT_NO_TOKEN. */
+    uint16_t open_start;
+
+    /**
+     * Offset of the innermost '{' still open; or PIRATE_INPUT_NO_TOKEN. Just after a '{', that's
+     * the '{' itself; so '{' tokens keep the loop enclosing them here instead.
+     */
+    uint16_t loop;
+
+    /** How many '{' are open; including any nested too deeply to compile. */
+    uint16_t loop_depth;
+} PirateInputNesting;
+
+typedef struct {
+    /** Position and extent of the token within the input buffer. */
+    uint16_t offset;
+    uint16_t length;
+    uint8_t type; // PirateTokenType
+
+    /** Set if the token can't be valid on its own; e.g. a bad hex literal. */
+    bool malformed : 1;
+
+    /** Set if the token is fine, but doesn't fit where it is; e.g. an unbalanced '['. */
+    bool misplaced : 1;
+
+    /** Which brackets are open just after this token; so an edit can tell when it stops mattering. */
+    PirateInputNesting nesting;
+} PirateInputToken;
+
+typedef struct {
+    /**
+     * The text being edited, held as a gap buffer: the characters before the cursor sit at
+     * the start of the buffer, and the ones after it at the end, so edits at the cursor
+     * move nothing. The gap is closed up whenever anyone else might look at the buffer.
+     */
     char* chars;
-    uint8_t char_count;
-    uint8_t max_length;
+    uint16_t char_count;
+    uint16_t max_length;
+
+    /** Where the gap starts; it runs for (max_length - char_count) characters. */
+    uint16_t gap_start;
+
+    /** Which keyboard we're showing. */
+    PirateInputLayout layout;
+
+    /** The keyboard, pre-rendered in the canvas' own buffer format; see pirate_input_render_keyboard_layer. */
+    uint8_t* keyboard_layer;
+    size_t keyboard_layer_size;
+
+    /** Duration of the most recent redraw, and a running average over recent ones. */
+    uint32_t frame_us;
+    uint32_t frame_us_average;
+
+    /**
+     * When the oldest change not yet on screen came in, as a cycle count; the next frame drawn
+     * adds how long it took to show to our input-to-pixel latencies, in microseconds.
+     */
+    uint32_t change_arrival;
+    bool change_pending;
+    PirateLatency latency;
+
+    /** Our view; its draw callback lets it know each frame's done. */
+    PirateInput* pirate_input;
+
+    /** The buffer, as tokens; kept up to date as each character is edited. */
+    PirateInputToken* tokens;
+    uint16_t token_count;
+    size_t token_capacity;
 
     PirateInputCallback input_callback;
     CharChangedCallback changed_callback;
     void* callback_context;
 
-    uint8_t selected_char;
-    int8_t selected_row; // row -1 - input, row 0 & 1 & 2 - keyboard
+    /** Where Up on the input row fetches earlier commands from, and how far back we've gone. */
+    PirateInputHistoryCallback history_callback;
+    void* history_context;
+
+    /** Who's told when OK is held on the send key; and how many commands they're holding. */
+    PirateInputCallback queue_callback;
+    void* queue_context;
+    uint8_t queued;
+    uint32_t history_age;
+
+    /** Where the prediction bar's contents come from; what it holds now; and which one's picked. */
+    PirateInputPredictionCallback prediction_callback;
+    void* prediction_context;
+    PiratePredictions predictions;
+    uint8_t selected_prediction;
+
+    uint16_t selected_char;
+    int8_t selected_row; // row -2 - input, row -1 - predictions, row 0 & 1 & 2 - keyboard
     uint8_t selected_column;
-    uint8_t first_visible_char;
+    uint16_t first_visible_char;
 } PirateInputModel;
 
+static const int8_t input_row = -2;
+static const int8_t prediction_row = -1;
+
+/** The prediction bar sits in the strip between the input box and the keyboard. */
+static const uint8_t prediction_bar_y = 13;
+static const uint8_t prediction_bar_height = 10;
+
+/** Tokens we'll look back through, from the cursor, for the start of its transaction. */
+static const uint8_t prediction_context_tokens = 8;
+
 static const uint8_t keyboard_origin_x = 7;
-static const uint8_t keyboard_origin_y = 17;
+static const uint8_t keyboard_origin_y = 21;
 static const uint8_t keyboard_row_count = 3;
 static const uint8_t enter_symbol = '\r';
 static const uint8_t backspace_symbol = '\b';
@@ -49,7 +188,33 @@ static const PirateInputKey keyboard_keys_row_1[] = {
     {'&', 66, 12},
     {space_symbol, 77, 12},
     {backspace_symbol, 103, 4},
-    // room for one more?
+};
+
+/** I2C keeps its ',' and takes '@', for the clock, in the last gap on the row. */
+static const PirateInputKey i2c_keyboard_keys_row_1[] = {
+    {'[', 0, 12},
+    {']', 11, 12},
+    {'r', 22, 12},
+    {'x', 33, 12},
+    {'b', 44, 12},
+    {',', 55, 12},
+    {'&', 66, 12},
+    {space_symbol, 77, 12},
+    {'@', 91, 12},
+    {backspace_symbol, 103, 4},
+};
+
+/** SPI has no use for ',' as a separator; its key makes way for '@', which sets the clock. */
+static const PirateInputKey spi_keyboard_keys_row_1[] = {
+    {'[', 0, 12},
+    {']', 11, 12},
+    {'r', 22, 12},
+    {'x', 33, 12},
+    {'b', 44, 12},
+    {'@', 55, 12},
+    {'&', 66, 12},
+    {space_symbol, 77, 12},
+    {backspace_symbol, 103, 4},
 };
 
 static const PirateInputKey keyboard_keys_row_2[] = {
@@ -77,54 +242,514 @@ static const PirateInputKey keyboard_keys_row_3[] = {
 
 
 
+/** Each layout's rows; the digits are the same for every bus. */
+static const PirateInputRow keyboard_layouts[][3] = {
+    [PirateInputLayoutI2c] =
+        {
+            {i2c_keyboard_keys_row_1, COUNT_OF(i2c_keyboard_keys_row_1)},
+            {keyboard_keys_row_2, COUNT_OF(keyboard_keys_row_2)},
+            {keyboard_keys_row_3, COUNT_OF(keyboard_keys_row_3)},
+        },
+    [PirateInputLayoutSpi] =
+        {
+            {spi_keyboard_keys_row_1, COUNT_OF(spi_keyboard_keys_row_1)},
+            {keyboard_keys_row_2, COUNT_OF(keyboard_keys_row_2)},
+            {keyboard_keys_row_3, COUNT_OF(keyboard_keys_row_3)},
+        },
+    [PirateInputLayoutOneWire] =
+        {
+            {keyboard_keys_row_1, COUNT_OF(keyboard_keys_row_1)},
+            {keyboard_keys_row_2, COUNT_OF(keyboard_keys_row_2)},
+            {keyboard_keys_row_3, COUNT_OF(keyboard_keys_row_3)},
+        },
+};
+
 /**
  * @brief Get row size
  * 
+ * @param model
  * @param row_index Index of row 
  * @return uint8_t Row size
  */
-static uint8_t pirate_input_get_row_size(uint8_t row_index) {
-    uint8_t row_size = 0;
-
-    switch(row_index + 1) {
-    case 1:
-        row_size = sizeof(keyboard_keys_row_1) / sizeof(PirateInputKey);
-        break;
-    case 2:
-        row_size = sizeof(keyboard_keys_row_2) / sizeof(PirateInputKey);
-        break;
-    case 3:
-        row_size = sizeof(keyboard_keys_row_3) / sizeof(PirateInputKey);
-        break;
-    }
-
-    return row_size;
+static uint8_t pirate_input_get_row_size(PirateInputModel* model, uint8_t row_index) {
+    return (row_index < keyboard_row_count) ? keyboard_layouts[model->layout][row_index].size : 0;
 }
 
 /**
  * @brief Get row pointer
  * 
+ * @param model
  * @param row_index Index of row 
  * @return const PirateInputKey* Row pointer
  */
-static const PirateInputKey* pirate_input_get_row(uint8_t row_index) {
-    const PirateInputKey* row = NULL;
+static const PirateInputKey* pirate_input_get_row(PirateInputModel* model, uint8_t row_index) {
+    return (row_index < keyboard_row_count) ? keyboard_layouts[model->layout][row_index].keys : NULL;
+}
+
+/**
+ * @brief Get the length of the gap in our buffer
+ *
+ * @param model
+ * @return uint16_t Gap length
+ */
+static uint16_t pirate_input_gap_length(PirateInputModel* model) {
+    return model->max_length - model->char_count;
+}
+
+/**
+ * @brief Get a character of the text, skipping over the gap
+ *
+ * @param model
+ * @param position Position within the text
+ * @return char The character
+ */
+static char pirate_input_char_at(PirateInputModel* model, uint16_t position) {
+    if(position >= model->gap_start) {
+        position += pirate_input_gap_length(model);
+    }
+    return model->chars[position];
+}
+
+/**
+ * @brief Move the gap to the given position in the text
+ *
+ * This costs the distance moved; which, for edits at the cursor, is almost always nothing.
+ *
+ * @param model
+ * @param position Position within the text
+ */
+static void pirate_input_move_gap(PirateInputModel* model, uint16_t position) {
+    const uint16_t gap_length = pirate_input_gap_length(model);
+
+    if(position < model->gap_start) {
+        memmove(
+            &model->chars[position + gap_length],
+            &model->chars[position],
+            model->gap_start - position);
+    } else if(position > model->gap_start) {
+        memmove(
+            &model->chars[model->gap_start],
+            &model->chars[model->gap_start + gap_length],
+            position - model->gap_start);
+    }
+
+    model->gap_start = position;
+}
+
+/**
+ * @brief Close up the gap, leaving a plain null-terminated string in the buffer
+ *
+ * @param model
+ */
+static void pirate_input_close_gap(PirateInputModel* model) {
+    if(model->chars) {
+        pirate_input_move_gap(model, model->char_count);
+        model->chars[model->char_count] = 0;
+    }
+}
+
+/**
+ * @brief Lex a single token from the input buffer
+ *
+ * Tokens are lexed in place on whichever side of the gap they fall. A token that runs up
+ * against the gap may continue past it; so we move the gap out of its way first, which
+ * costs no more than the token's own length.
+ *
+ * @param model
+ * @param offset Position to start lexing from
+ * @param token Populated with the token found; PirateTokenEnd at the end of the buffer
+ * @return size_t Position immediately after the token
+ */
+static size_t pirate_input_lex(PirateInputModel* model, size_t offset, PirateInputToken* token) {
+    PirateToken lexed;
+    size_t end = 0;
+
+    if(offset < model->gap_start) {
+        end = pirate_lex_token(model->chars, model->gap_start, offset, &lexed);
 
-    switch(row_index + 1) {
-    case 1:
-        row = keyboard_keys_row_1;
+        if((end == model->gap_start) && (lexed.type != PirateTokenEnd) &&
+           (model->gap_start < model->char_count)) {
+            uint16_t position = model->gap_start;
+
+            while((position < model->char_count) &&
+                  !pirate_is_separator(pirate_input_char_at(model, position))) {
+                ++position;
+            }
+
+            pirate_input_move_gap(model, position);
+            end = pirate_lex_token(model->chars, model->gap_start, offset, &lexed);
+        }
+    }
+
+    // Text after the gap sits gap_length characters further on; offsetting our base pointer
+    // lets the lexer work in text positions. It never looks behind the offset it's given.
+    if((offset >= model->gap_start) || ((lexed.type == PirateTokenEnd) && (end == model->gap_start))) {
+        end = pirate_lex_token(
+            model->chars + pirate_input_gap_length(model),
+            model->char_count,
+            MAX(offset, model->gap_start),
+            &lexed);
+    }
+
+    token->offset = lexed.offset;
+    token->length = lexed.length;
+    token->type = lexed.type;
+    token->misplaced = false;
+
+    // Catch anything that's wrong regardless of context, using the compiler's limits.
+    switch(lexed.type) {
+    case PirateTokenInvalid:
+        token->malformed = true;
+        break;
+    case PirateTokenValue:
+        token->malformed = (lexed.value > 0xFF);
         break;
-    case 2:
-        row = keyboard_keys_row_2;
+    case PirateTokenRepeat:
+        token->malformed = (lexed.value == 0) || (lexed.value > UINT16_MAX);
         break;
-    case 3:
-        row = keyboard_keys_row_3;
+    case PirateTokenSpeed:
+        token->malformed = (lexed.value > UINT16_MAX);
         break;
+    default:
+        token->malformed = false;
+        break;
+    }
+
+    return end;
+}
+
+/**
+ * @brief Make sure our token list has room for the given number of tokens
+ *
+ * @param model
+ * @param count Number of tokens needed
+ */
+static void pirate_input_reserve_tokens(PirateInputModel* model, size_t count) {
+    size_t capacity = MAX(model->token_capacity, PIRATE_INPUT_INITIAL_TOKENS);
+
+    if(model->tokens && (count <= model->token_capacity)) {
+        return;
+    }
+
+    while(capacity < count) {
+        capacity *= 2;
+    }
+
+    model->tokens = realloc(model->tokens, capacity * sizeof(PirateInputToken));
+    model->token_capacity = capacity;
+}
+
+/**
+ * @brief Find the first token that ends at or after the given position
+ *
+ * @param model
+ * @param position Position within the text
+ * @return uint16_t Index of the token; or the token count, if there's no such token
+ */
+static uint16_t pirate_input_find_token(PirateInputModel* model, uint16_t position) {
+    uint16_t low = 0;
+    uint16_t high = model->token_count;
+
+    // Tokens are kept in order, and never overlap, so their ends are sorted too.
+    while(low < high) {
+        uint16_t middle = low + (high - low) / 2;
+
+        if(model->tokens[middle].offset + model->tokens[middle].length < position) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * @brief Find which brackets are open just before the given token
+ *
+ * @param model
+ * @param index Index of the token; or the token count, for the end of the command
+ * @return PirateInputNesting
+ */
+static PirateInputNesting pirate_input_nesting_before(PirateInputModel* model, uint16_t index) {
+    PirateInputNesting nesting = {PIRATE_INPUT_NO_TOKEN, PIRATE_INPUT_NO_TOKEN, 0};
+
+    if(index > 0) {
+        const PirateInputToken* token = &model->tokens[index - 1];
+
+        nesting = token->nesting;
+        if(token->type == PirateTokenLoopBegin) {
+            nesting.loop = token->offset;
+        }
+    }
+
+    return nesting;
+}
+
+/**
+ * @brief Flag, or clear, every bracket still open at the end of the command as missing its closer
+ *
+ * This follows the chain of open loops back from the end; so it costs the nesting depth, however
+ * long the command is.
+ *
+ * @param model
+ * @param unclosed Whether to flag the brackets, or clear them
+ */
+static void pirate_input_mark_unclosed(PirateInputModel* model, bool unclosed) {
+    PirateInputNesting nesting = pirate_input_nesting_before(model, model->token_count);
+
+    if(nesting.open_start != PIRATE_INPUT_NO_TOKEN) {
+        model->tokens[pirate_input_find_token(model, nesting.open_start + 1)].misplaced = unclosed;
+    }
+
+    // Loops nested too deeply are flagged as such; their being open too is beside the point.
+    while(nesting.loop != PIRATE_INPUT_NO_TOKEN) {
+        PirateInputToken* loop = &model->tokens[pirate_input_find_token(model, nesting.loop + 1)];
+
+        if(nesting.loop_depth <= PIRATE_LOOP_DEPTH) {
+            loop->misplaced = unclosed;
+        }
+        nesting.loop = loop->nesting.loop;
+        nesting.loop_depth -= 1;
+    }
+}
+
+/**
+ * @brief Check that tokens fit together; e.g. that brackets balance
+ *
+ * Each token records which brackets are open just after it. We work forward from the first
+ * token that might have changed, and stop at the first kept token whose record comes out as
+ * it was; from there on, every token would check out as it did before. So an edit costs only
+ * the tokens whose surroundings it changed, not the whole command.
+ *
+ * A loop's record also names the loop around it, which is what a '}' goes back to; so we can
+ * only stop once every loop opened since the edit is one we've seen come out as before.
+ *
+ * @param model
+ * @param from Index of the first token to check
+ * @param kept_from Index of the first token whose record is from before the edit; or the token
+ *                  count, if there are none
+ */
+static void pirate_input_check_structure(PirateInputModel* model, uint16_t from, uint16_t kept_from) {
+    PirateInputToken* tokens = model->tokens;
+    PirateInputNesting nesting = pirate_input_nesting_before(model, from);
+    PirateTokenType previous = from ? tokens[from - 1].type : PirateTokenEnd;
+
+    // How many of the innermost open loops were opened, or moved, by the edit.
+    uint16_t changed_loops = 0;
+
+    for(uint16_t i = from; i < model->token_count; ++i) {
+        PirateInputToken* token = &tokens[i];
+        PirateInputNesting recorded = nesting;
+        token->misplaced = false;
+
+        switch(token->type) {
+        case PirateTokenStart:
+            // As in the compiler, a second '[' is a repeated start; only the outermost needs closing.
+            if(nesting.open_start == PIRATE_INPUT_NO_TOKEN) {
+                nesting.open_start = token->offset;
+            }
+            recorded = nesting;
+            break;
+
+        case PirateTokenStop:
+            token->misplaced = (nesting.open_start == PIRATE_INPUT_NO_TOKEN);
+            nesting.open_start = PIRATE_INPUT_NO_TOKEN;
+            recorded = nesting;
+            break;
+
+        case PirateTokenRepeat:
+            token->misplaced = (previous != PirateTokenRead) && (previous != PirateTokenDelay) &&
+                               (previous != PirateTokenValue) && (previous != PirateTokenLoopEnd);
+            break;
+
+        case PirateTokenLoopBegin:
+            // Loops nested too deeply are flagged here; we still count them, so their '}' balances.
+            token->misplaced = (nesting.loop_depth >= PIRATE_LOOP_DEPTH);
+            nesting.loop_depth += 1;
+            recorded.loop_depth = nesting.loop_depth;
+            nesting.loop = token->offset;
+
+            if(changed_loops || (i < kept_from) ||
+               (memcmp(&token->nesting, &recorded, sizeof(recorded)) != 0)) {
+                changed_loops += 1;
+            }
+            break;
+
+        case PirateTokenLoopEnd:
+            if(nesting.loop_depth == 0) {
+                token->misplaced = true;
+            } else {
+                const PirateInputToken* loop = &tokens[pirate_input_find_token(model, nesting.loop + 1)];
+
+                nesting.loop = loop->nesting.loop;
+                nesting.loop_depth -= 1;
+                changed_loops -= changed_loops ? 1 : 0;
+            }
+            recorded = nesting;
+            break;
+
+        default:
+            break;
+        }
+
+        bool unchanged = (i >= kept_from) && (memcmp(&token->nesting, &recorded, sizeof(recorded)) == 0);
+
+        token->nesting = recorded;
+        previous = token->type;
+
+        if(unchanged && !changed_loops) {
+            break;
+        }
+    }
+
+    pirate_input_mark_unclosed(model, true);
+}
+
+/**
+ * @brief Re-tokenize the whole input buffer
+ *
+ * @param model
+ */
+static void pirate_input_tokenize_all(PirateInputModel* model) {
+    PirateInputToken token;
+    size_t offset = 0;
+
+    model->token_count = 0;
+
+    while(model->chars) {
+        offset = pirate_input_lex(model, offset, &token);
+        if(token.type == PirateTokenEnd) {
+            break;
+        }
+
+        pirate_input_reserve_tokens(model, model->token_count + 1);
+        model->tokens[model->token_count++] = token;
+    }
+
+    pirate_input_check_structure(model, 0, model->token_count);
+}
+
+/**
+ * @brief Update our tokens after a single character was inserted or removed
+ *
+ * Only the token(s) around the edit are lexed again. We stop as soon as a token starts
+ * where one of the old tokens did; from there on, the text is unchanged, so the old
+ * tokens still stand, and just need to be moved.
+ *
+ * @param model
+ * @param position Position of the character that was inserted or removed
+ * @param delta +1 for an insertion, or -1 for a removal
+ */
+static void pirate_input_tokenize_edit(PirateInputModel* model, uint16_t position, int8_t delta) {
+    PirateInputToken relexed[PIRATE_INPUT_MAX_RELEXED];
+    uint16_t relexed_count = 0;
+    uint16_t resume;
+    size_t offset;
+
+    // Tokens that end before the edit can't have changed; even their terminating character is intact.
+    const uint16_t first = pirate_input_find_token(model, position);
+
+    // Old tokens starting here or later hold text the edit didn't touch.
+    const uint16_t untouched_from = (delta > 0) ? position : position + 1;
+
+    offset = first ? model->tokens[first - 1].offset + model->tokens[first - 1].length : 0;
+    resume = first;
+
+    while(true) {
+        PirateInputToken token;
+
+        offset = pirate_input_lex(model, offset, &token);
+        if(token.type == PirateTokenEnd) {
+            resume = model->token_count;
+            break;
+        }
+
+        // Find the first old token that could line up with this one...
+        while((resume < model->token_count) &&
+              ((model->tokens[resume].offset < untouched_from) ||
+               (model->tokens[resume].offset + delta < token.offset))) {
+            ++resume;
+        }
+
+        // ... and if it does, the rest of the old tokens are still good.
+        if((resume < model->token_count) && (model->tokens[resume].offset + delta == token.offset)) {
+            break;
+        }
+
+        // This shouldn't be possible; but if the edit ran long, just start over.
+        if(relexed_count == PIRATE_INPUT_MAX_RELEXED) {
+            pirate_input_tokenize_all(model);
+            return;
+        }
+        relexed[relexed_count++] = token;
+    }
+
+    // Brackets left open by the end are flagged by where they are; which the edit may change.
+    pirate_input_mark_unclosed(model, false);
+
+    // Splice our new tokens in place of the ones they replace, and move the rest along.
+    const uint16_t kept = model->token_count - resume;
+    pirate_input_reserve_tokens(model, first + relexed_count + kept);
+
+    PirateInputToken* tokens = model->tokens;
+    memmove(&tokens[first + relexed_count], &tokens[resume], kept * sizeof(PirateInputToken));
+    memcpy(&tokens[first], relexed, relexed_count * sizeof(PirateInputToken));
+    model->token_count = first + relexed_count + kept;
+
+    // Kept tokens' records name brackets by offset; those past the edit have moved along too.
+    for(uint16_t i = first + relexed_count; i < model->token_count; ++i) {
+        PirateInputNesting* nesting = &tokens[i].nesting;
+
+        tokens[i].offset += delta;
+        if((nesting->open_start >= untouched_from) && (nesting->open_start != PIRATE_INPUT_NO_TOKEN)) {
+            nesting->open_start += delta;
+        }
+        if((nesting->loop >= untouched_from) && (nesting->loop != PIRATE_INPUT_NO_TOKEN)) {
+            nesting->loop += delta;
+        }
     }
 
-    return row;
+    pirate_input_check_structure(model, first, first + relexed_count);
 }
 
+/**
+ * @brief Underline any invalid tokens that are on screen
+ *
+ * @param canvas
+ * @param model
+ * @param text_x Left edge of the text
+ * @param text_y Baseline of the text
+ * @param visible_end Position just after the last visible character
+ */
+static void pirate_input_draw_errors(
+    Canvas* canvas,
+    PirateInputModel* model,
+    uint8_t text_x,
+    uint8_t text_y,
+    uint16_t visible_end) {
+    for(uint16_t i = pirate_input_find_token(model, model->first_visible_char + 1);
+        i < model->token_count;
+        ++i) {
+        const PirateInputToken* token = &model->tokens[i];
+        uint16_t start = MAX(token->offset, model->first_visible_char);
+        uint16_t end = MIN(token->offset + token->length, visible_end);
+
+        if(token->offset >= visible_end) {
+            break;
+        }
+        if((!token->malformed && !token->misplaced) || (start >= end)) {
+            continue;
+        }
+
+        canvas_draw_line(
+            canvas,
+            text_x + 2 + (start - model->first_visible_char) * 7,
+            text_y + 2,
+            text_x + 2 + (end - model->first_visible_char) * 7 - 3,
+            text_y + 2);
+    }
+}
 
 /**
  * @brief Draw input box (common view)
@@ -134,23 +759,24 @@ static const PirateInputKey* pirate_input_get_row(uint8_t row_index) {
  */
 static void pirate_input_draw_input(Canvas* canvas, PirateInputModel* model) {
     const uint8_t text_x = 8;
-    const uint8_t text_y = 13;
+    const uint8_t text_y = 9;
 
-    elements_slightly_rounded_frame(canvas, 6, 2, 116, 15);
+    elements_slightly_rounded_frame(canvas, 6, 0, 116, 13);
 
-    canvas_draw_icon(canvas, 2, 7, &I_ButtonLeftSmall_3x5);
-    canvas_draw_icon(canvas, 123, 7, &I_ButtonRightSmall_3x5);
+    canvas_draw_icon(canvas, 2, 4, &I_ButtonLeftSmall_3x5);
+    canvas_draw_icon(canvas, 123, 4, &I_ButtonRightSmall_3x5);
 
     uint8_t drawable_max = max_drawable_chars;
     if (model->selected_char >= model->char_count) {
         drawable_max -= 1;
     }
 
-    uint8_t i;
-    for(i = model->first_visible_char;
-        i < model->first_visible_char + MIN(model->char_count + 1, drawable_max);
-        i++) {
+    const uint16_t visible_end = model->first_visible_char + MIN(model->char_count + 1, drawable_max);
+
+    uint16_t i;
+    for(i = model->first_visible_char; i < visible_end; i++) {
         uint8_t char_position = i - model->first_visible_char;
+        char character = (i < model->char_count) ? pirate_input_char_at(model, i) : 0;
 
         if(i == model->selected_char) {
             canvas_draw_glyph(
@@ -159,12 +785,12 @@ static void pirate_input_draw_input(Canvas* canvas, PirateInputModel* model) {
                 text_y,
                 '|');
         }
-        if ((model->chars[i] != ' ') && (model->chars[i] != 0)) {
+        if ((character != ' ') && (character != 0)) {
             canvas_draw_glyph(
                 canvas,
                 text_x + 2 + char_position * 7,
                 text_y,
-                model->chars[i]);
+                character);
         }
     }
 
@@ -177,13 +803,15 @@ static void pirate_input_draw_input(Canvas* canvas, PirateInputModel* model) {
             '|');
     }
 
+    pirate_input_draw_errors(canvas, model, text_x, text_y, visible_end);
+
 
     if(model->max_length - model->first_visible_char > max_drawable_chars) {
-        canvas_draw_icon(canvas, 123, 7, &I_ButtonRightSmall_3x5);
+        canvas_draw_icon(canvas, 123, 4, &I_ButtonRightSmall_3x5);
     }
 
     if(model->first_visible_char > 0) {
-        canvas_draw_icon(canvas, 1, 7, &I_ButtonLeftSmall_3x5);
+        canvas_draw_icon(canvas, 1, 4, &I_ButtonLeftSmall_3x5);
     }
 }
 
@@ -195,25 +823,26 @@ static void pirate_input_draw_input(Canvas* canvas, PirateInputModel* model) {
  */
 static void pirate_input_draw_input_selected(Canvas* canvas, PirateInputModel* model) {
     const uint8_t text_x = 7;
-    const uint8_t text_y = 13;
+    const uint8_t text_y = 9;
 
-    canvas_draw_box(canvas, 0, 0, 127, 19);
+    canvas_draw_box(canvas, 0, 0, 127, 13);
     canvas_invert_color(canvas);
 
-    elements_slightly_rounded_frame(canvas, 6, 2, 115, 15);
-    canvas_draw_icon(canvas, 2, 7, &I_ButtonLeftSmall_3x5);
-    canvas_draw_icon(canvas, 122, 7, &I_ButtonRightSmall_3x5);
+    elements_slightly_rounded_frame(canvas, 6, 0, 115, 13);
+    canvas_draw_icon(canvas, 2, 4, &I_ButtonLeftSmall_3x5);
+    canvas_draw_icon(canvas, 122, 4, &I_ButtonRightSmall_3x5);
 
     uint8_t drawable_max = max_drawable_chars;
     if (model->selected_char >= model->char_count) {
         drawable_max -= 1;
     }
 
-    uint8_t i;
-    for(i = model->first_visible_char;
-        i < model->first_visible_char + MIN(model->char_count + 1, drawable_max);
-        i++) {
+    const uint16_t visible_end = model->first_visible_char + MIN(model->char_count + 1, drawable_max);
+
+    uint16_t i;
+    for(i = model->first_visible_char; i < visible_end; i++) {
         uint8_t char_position = i - model->first_visible_char;
+        char character = (i < model->char_count) ? pirate_input_char_at(model, i) : 0;
 
         if(i == model->selected_char) {
             canvas_draw_glyph(
@@ -222,12 +851,12 @@ static void pirate_input_draw_input_selected(Canvas* canvas, PirateInputModel* m
                 text_y,
                 '|');
         }
-        if ((model->chars[i] != ' ') && (model->chars[i] != 0)) {
+        if ((character != ' ') && (character != 0)) {
             canvas_draw_glyph(
                 canvas,
                 text_x + 2 + char_position * 7,
                 text_y,
-                model->chars[i]);
+                character);
         }
     }
 
@@ -240,12 +869,14 @@ static void pirate_input_draw_input_selected(Canvas* canvas, PirateInputModel* m
             '|');
     }
 
+    pirate_input_draw_errors(canvas, model, text_x, text_y, visible_end);
+
     if(model->char_count - model->first_visible_char > max_drawable_chars) {
-        canvas_draw_icon(canvas, 123, 7, &I_ButtonRightSmall_3x5);
+        canvas_draw_icon(canvas, 123, 4, &I_ButtonRightSmall_3x5);
     }
 
     if(model->first_visible_char > 0) {
-        canvas_draw_icon(canvas, 1, 7, &I_ButtonLeftSmall_3x5);
+        canvas_draw_icon(canvas, 1, 4, &I_ButtonLeftSmall_3x5);
     }
 
     canvas_invert_color(canvas);
@@ -262,11 +893,18 @@ static bool pirate_input_keyboard_selected(PirateInputModel* model) {
 
 /**
  * @brief Do transition from keyboard
- * 
- * @param model 
+ *
+ * From the input row, we stop at the prediction bar on the way down; but only if it has
+ * something to offer.
+ *
+ * @param model
  */
 static void pirate_input_transition_from_keyboard(PirateInputModel* model) {
-    model->selected_row += 1;
+    if((model->selected_row == input_row) && model->predictions.count) {
+        model->selected_row = prediction_row;
+    } else {
+        model->selected_row = 0;
+    }
 }
 
 /**
@@ -312,6 +950,7 @@ static void pirate_input_dec_selected_char(PirateInputModel* model) {
  */
 static void pirate_input_call_input_callback(PirateInputModel* model) {
     if(model->input_callback != NULL) {
+        pirate_input_close_gap(model);
         model->input_callback(model->callback_context);
     }
 }
@@ -322,33 +961,126 @@ static void pirate_input_call_input_callback(PirateInputModel* model) {
  * @param model 
  */
 static void pirate_input_call_changed_callback(PirateInputModel* model) {
+    // Closing the gap costs the length of the text; so we only do it for those who'll look.
     if(model->changed_callback != NULL) {
+        pirate_input_close_gap(model);
         model->changed_callback(model->callback_context);
     }
 }
 
 /**
- * @brief Clear selected byte 
+ * @brief Returns true iff the character could be part of a word; e.g. a literal, or "r:16"
+ *
+ * @param character
  */
+static bool pirate_input_is_word_character(char character) {
+    return isalnum((unsigned char)character) || (character == ':');
+}
 
-static void pirate_input_backspace(PirateInputModel* model) {
+/**
+ * @brief Ask for predictions of what comes next at the cursor
+ *
+ * Only the cursor's own transaction is handed over. We find where it starts from our
+ * tokens, looking back only a few; so this costs the same however long the command is.
+ *
+ * @param model
+ */
+static void pirate_input_update_predictions(PirateInputModel* model) {
+    const uint16_t cursor = model->selected_char;
+    uint16_t end;
 
-    // If we don't have anything to delete, we're done.
-    if (model->selected_char == 0) {
-        return;
+    model->predictions.count = 0;
+    model->predictions.replace = 0;
+
+    // Predictions complete whole words; there's nothing to offer in the middle of one.
+    if(!model->prediction_callback || !model->chars ||
+       ((cursor < model->char_count) && pirate_input_is_word_character(pirate_input_char_at(model, cursor)))) {
+        end = 0;
+    } else {
+        // The tokens before the cursor; the last of which may run right up to it.
+        end = pirate_input_find_token(model, cursor);
+        if((end < model->token_count) && (model->tokens[end].offset < cursor)) {
+            end += 1;
+        }
     }
 
-    uint8_t char_to_delete = model->selected_char - 1;
+    for(uint16_t i = end; (i > 0) && (end - i < prediction_context_tokens); --i) {
+        const PirateInputToken* token = &model->tokens[i - 1];
+
+        if(token->type == PirateTokenStop) {
+            break;
+        }
+        if(token->type == PirateTokenStart) {
+            // With the gap at the cursor, everything before it is one plain run of text.
+            pirate_input_move_gap(model, cursor);
+            model->prediction_callback(
+                model->prediction_context,
+                &model->chars[token->offset],
+                cursor - token->offset,
+                &model->predictions);
+            break;
+        }
+    }
+
+    if(model->selected_prediction >= model->predictions.count) {
+        model->selected_prediction = 0;
+    }
+    if((model->selected_row == prediction_row) && !model->predictions.count) {
+        model->selected_row = 0;
+    }
+}
+
+/**
+ * @brief Clear selected byte 
+ */
+
+static void pirate_input_backspace(PirateInputModel* model) {
 
-    // Move each character back.
-    for (uint8_t i = char_to_delete; i < model->char_count - 1; ++i) {
-        model->chars[i] = model->chars[i + 1];
+    // If we don't have anything to delete, we're done.
+    if (model->selected_char == 0) {
+        return;
     }
 
+    uint16_t char_to_delete = model->selected_char - 1;
+
+    // Bring the gap to the cursor, and let it swallow the character before it.
+    pirate_input_move_gap(model, model->selected_char);
+    model->gap_start -= 1;
     model->char_count -= 1;
-    model->chars[model->char_count] = 0;
+    pirate_input_tokenize_edit(model, char_to_delete, -1);
 
     pirate_input_dec_selected_char(model);
+    pirate_input_update_predictions(model);
+    pirate_input_call_changed_callback(model);
+}
+
+/**
+ * @brief Replace the buffer with the next older command from our history
+ *
+ * @param model
+ */
+static void pirate_input_recall_history(PirateInputModel* model) {
+    if(!model->history_callback || !model->chars) {
+        return;
+    }
+
+    // The callback leaves the buffer alone if it has nothing for us; otherwise it fills
+    // the whole thing, gap and all, with a plain string.
+    if(!model->history_callback(
+           model->history_context, model->history_age, model->chars, model->max_length)) {
+        return;
+    }
+    model->history_age += 1;
+
+    model->char_count = strlen(model->chars);
+    model->gap_start = model->char_count;
+    model->selected_char = model->char_count;
+    model->first_visible_char = (model->char_count > max_drawable_chars - 2) ?
+                                    model->char_count - (max_drawable_chars - 2) :
+                                    0;
+
+    pirate_input_tokenize_all(model);
+    pirate_input_update_predictions(model);
     pirate_input_call_changed_callback(model);
 }
 
@@ -358,8 +1090,14 @@ static void pirate_input_backspace(PirateInputModel* model) {
  * @param model 
  */
 static void pirate_input_handle_up(PirateInputModel* model) {
-    if(model->selected_row > -1) {
+    if(model->selected_row > 0) {
         model->selected_row -= 1;
+    } else if(model->selected_row == 0) {
+        model->selected_row = model->predictions.count ? prediction_row : input_row;
+    } else if(model->selected_row == prediction_row) {
+        model->selected_row = input_row;
+    } else {
+        pirate_input_recall_history(model);
     }
 }
 
@@ -388,10 +1126,14 @@ static void pirate_input_handle_left(PirateInputModel* model) {
         if(model->selected_column > 0) {
             model->selected_column -= 1;
         } else {
-            model->selected_column = pirate_input_get_row_size(model->selected_row) - 1;
+            model->selected_column = pirate_input_get_row_size(model, model->selected_row) - 1;
         }
+    } else if(model->selected_row == prediction_row) {
+        model->selected_prediction = model->selected_prediction ? model->selected_prediction - 1 :
+                                                                  model->predictions.count - 1;
     } else {
         pirate_input_dec_selected_char(model);
+        pirate_input_update_predictions(model);
     }
 }
 
@@ -402,36 +1144,92 @@ static void pirate_input_handle_left(PirateInputModel* model) {
  */
 static void pirate_input_handle_right(PirateInputModel* model) {
     if(pirate_input_keyboard_selected(model)) {
-        if(model->selected_column < pirate_input_get_row_size(model->selected_row) - 1) {
+        if(model->selected_column < pirate_input_get_row_size(model, model->selected_row) - 1) {
             model->selected_column += 1;
         } else {
             model->selected_column = 0;
         }
+    } else if(model->selected_row == prediction_row) {
+        model->selected_prediction = (model->selected_prediction + 1) % model->predictions.count;
     } else {
         pirate_input_inc_selected_char(model);
+        pirate_input_update_predictions(model);
     }
 }
 
 static void priate_input_insert_character(PirateInputModel* model, char value) {
 
-    // If our buffer is full, don't add anything.
-    if (model->char_count + 1 == model->max_length) {
+    // If our buffer is full, don't add anything. We always keep room for a terminating null.
+    if (model->char_count + 1 >= model->max_length) {
         return;
     }
 
-    // Move all characters forward... 
-    for (int i = model->char_count; i > model->selected_char; --i) {
-        model->chars[i] = model->chars[i - 1];
-    }
-
-    // ... and add our character to the buffer.
-    model->chars[model->selected_char] = value;
+    // Bring the gap to the cursor, and fill in its first character.
+    pirate_input_move_gap(model, model->selected_char);
+    model->chars[model->gap_start] = value;
+    model->gap_start += 1;
     model->char_count += 1;
+    pirate_input_tokenize_edit(model, model->selected_char, 1);
 
     pirate_input_inc_selected_char(model);
+    pirate_input_update_predictions(model);
     pirate_input_call_changed_callback(model);
 }
 
+/**
+ * @brief Replace the word being typed with the selected prediction, and start the next
+ *
+ * @param model
+ */
+static void pirate_input_accept_prediction(PirateInputModel* model) {
+    char text[PIRATE_PREDICT_TEXT_MAX];
+
+    if(model->selected_prediction >= model->predictions.count) {
+        return;
+    }
+
+    // Each edit asks for new predictions; so hold on to the one we're taking.
+    memcpy(text, model->predictions.text[model->selected_prediction], sizeof(text));
+
+    for(uint8_t i = model->predictions.replace; i > 0; --i) {
+        pirate_input_backspace(model);
+    }
+    for(const char* character = text; *character; ++character) {
+        priate_input_insert_character(model, *character);
+    }
+
+    // Leave the cursor ready for the next word; which is what the bar will be offering now.
+    if((model->selected_char >= model->char_count) ||
+       !pirate_is_separator(pirate_input_char_at(model, model->selected_char))) {
+        priate_input_insert_character(model, ' ');
+    }
+
+    model->selected_prediction = 0;
+    model->selected_row = model->predictions.count ? prediction_row : 0;
+}
+
+
+/**
+ * @brief Returns true iff the cursor's on the send key
+ *
+ * @param model
+ */
+static bool pirate_input_send_selected(PirateInputModel* model) {
+    return pirate_input_keyboard_selected(model) &&
+           (pirate_input_get_row(model, model->selected_row)[model->selected_column].value == enter_symbol);
+}
+
+/**
+ * @brief Handle OK button held on the send key, which queues the command instead of sending it
+ *
+ * @param model
+ */
+static void pirate_input_handle_queue(PirateInputModel* model) {
+    if(model->queue_callback != NULL) {
+        pirate_input_close_gap(model);
+        model->queue_callback(model->queue_context);
+    }
+}
 
 /**
  * @brief Handle OK button
@@ -440,7 +1238,7 @@ static void priate_input_insert_character(PirateInputModel* model, char value) {
  */
 static void pirate_input_handle_ok(PirateInputModel* model) {
     if(pirate_input_keyboard_selected(model)) {
-        uint8_t value = pirate_input_get_row(model->selected_row)[model->selected_column].value;
+        uint8_t value = pirate_input_get_row(model, model->selected_row)[model->selected_column].value;
 
         if(value == enter_symbol) {
             pirate_input_call_input_callback(model);
@@ -454,11 +1252,143 @@ static void pirate_input_handle_ok(PirateInputModel* model) {
 
             priate_input_insert_character(model, value);
         }
+    } else if(model->selected_row == prediction_row) {
+        pirate_input_accept_prediction(model);
     } else {
         pirate_input_transition_from_keyboard(model);
     }
 }
 
+/**
+ * @brief Draw a single keyboard key
+ *
+ * @param canvas
+ * @param key
+ * @param selected true if the key has the cursor
+ * @param framed true if the key will get the cursor when the keyboard is entered
+ */
+static void pirate_input_draw_key(
+    Canvas* canvas,
+    const PirateInputKey* key,
+    bool selected,
+    bool framed) {
+    const Icon* icon = NULL;
+    int32_t x = keyboard_origin_x + key->x;
+    int32_t y = keyboard_origin_y + key->y;
+
+    if(key->value == enter_symbol) {
+        icon = selected ? &I_KeySendSelected_24x11 : &I_KeySend_24x11;
+    } else if(key->value == backspace_symbol) {
+        icon = selected ? &I_KeyBackspaceSelected_16x9 : &I_KeyBackspace_16x9;
+    } else if(key->value == space_symbol) {
+        icon = selected ? &I_KeySpaceSelected_12x9 : &I_KeySpace_12x9;
+        x -= 1;
+        y -= 6;
+    }
+
+    if(icon) {
+        // Selected icons are drawn over the unselected ones in the keyboard layer; clear those first.
+        if(selected) {
+            canvas_set_color(canvas, ColorWhite);
+            canvas_draw_box(canvas, x, y, icon_get_width(icon), icon_get_height(icon));
+        }
+
+        canvas_set_color(canvas, ColorBlack);
+        canvas_draw_icon(canvas, x, y, icon);
+        return;
+    }
+
+    canvas_set_color(canvas, ColorBlack);
+    if(selected) {
+        canvas_draw_box(canvas, x - 3, y - 10, 11, 13);
+        canvas_set_color(canvas, ColorWhite);
+    } else if(framed) {
+        canvas_draw_frame(canvas, x - 3, y - 10, 11, 13);
+    }
+
+    canvas_draw_glyph(canvas, x, y, key->value);
+    canvas_set_color(canvas, ColorBlack);
+}
+
+/**
+ * @brief Draw the keyboard, with nothing selected, and keep a copy of it
+ *
+ * The keyboard never changes, so we render it once, and merge the copy into each frame
+ * after that; only the selected key needs to be drawn on top.
+ *
+ * @param canvas
+ * @param model
+ */
+static void pirate_input_render_keyboard_layer(Canvas* canvas, PirateInputModel* model) {
+    model->keyboard_layer_size = canvas_get_buffer_size(canvas);
+    model->keyboard_layer = malloc(model->keyboard_layer_size);
+
+    canvas_clear(canvas);
+    canvas_set_font(canvas, FontKeyboard);
+
+    for(uint8_t row = 0; row < keyboard_row_count; row++) {
+        const uint8_t column_count = pirate_input_get_row_size(model, row);
+        const PirateInputKey* keys = pirate_input_get_row(model, row);
+
+        for(size_t column = 0; column < column_count; column++) {
+            pirate_input_draw_key(canvas, &keys[column], false, false);
+        }
+    }
+
+    memcpy(model->keyboard_layer, canvas_get_buffer(canvas), model->keyboard_layer_size);
+    canvas_clear(canvas);
+}
+
+/**
+ * @brief Merge the cached keyboard into the frame
+ *
+ * The layer was captured from a blank frame, so OR-ing it in works whatever the
+ * canvas' buffer layout is.
+ *
+ * @param canvas
+ * @param model
+ */
+static void pirate_input_draw_keyboard_layer(Canvas* canvas, PirateInputModel* model) {
+    uint8_t* buffer = canvas_get_buffer(canvas);
+
+    for(size_t i = 0; i < model->keyboard_layer_size; ++i) {
+        buffer[i] |= model->keyboard_layer[i];
+    }
+}
+
+/**
+ * @brief Draw the prediction bar; each prediction gets a chip, for as many as fit
+ *
+ * @param canvas
+ * @param model
+ */
+static void pirate_input_draw_predictions(Canvas* canvas, PirateInputModel* model) {
+    const uint8_t text_y = prediction_bar_y + prediction_bar_height - 2;
+    uint8_t x = keyboard_origin_x - 3;
+
+    for(uint8_t i = 0; i < model->predictions.count; ++i) {
+        const char* text = model->predictions.text[i];
+        const uint8_t width = canvas_string_width(canvas, text) + 5;
+
+        if(x + width > canvas_width(canvas)) {
+            break;
+        }
+
+        canvas_set_color(canvas, ColorBlack);
+        if((model->selected_row == prediction_row) && (i == model->selected_prediction)) {
+            canvas_draw_box(canvas, x, prediction_bar_y, width, prediction_bar_height);
+            canvas_set_color(canvas, ColorWhite);
+        } else {
+            canvas_draw_frame(canvas, x, prediction_bar_y, width, prediction_bar_height);
+        }
+
+        canvas_draw_str(canvas, x + 3, text_y, text);
+        x += width + 3;
+    }
+
+    canvas_set_color(canvas, ColorBlack);
+}
+
 /**
  * @brief Draw callback
  * 
@@ -467,97 +1397,151 @@ static void pirate_input_handle_ok(PirateInputModel* model) {
  */
 static void pirate_input_view_draw_callback(Canvas* canvas, void* _model) {
     PirateInputModel* model = _model;
+    uint32_t start = DWT->CYCCNT;
+
+    if(!model->keyboard_layer) {
+        pirate_input_render_keyboard_layer(canvas, model);
+    }
 
     canvas_clear(canvas);
+    pirate_input_draw_keyboard_layer(canvas, model);
+
     canvas_set_color(canvas, ColorBlack);
     canvas_set_font(canvas, FontKeyboard);
 
-    if(model->selected_row == -1) {
+    if(model->selected_row == input_row) {
         pirate_input_draw_input_selected(canvas, model);
     } else {
         pirate_input_draw_input(canvas, model);
     }
+    pirate_input_draw_predictions(canvas, model);
 
-    for(uint8_t row = 0; row < keyboard_row_count; row++) {
-        const uint8_t column_count = pirate_input_get_row_size(row);
-        const PirateInputKey* keys = pirate_input_get_row(row);
+    // Of the keyboard, only the key under the cursor differs from the cached layer.
+    const uint8_t row = MAX(model->selected_row, 0);
+    if(model->selected_column < pirate_input_get_row_size(model, row)) {
+        const PirateInputKey* key = &pirate_input_get_row(model, row)[model->selected_column];
+        pirate_input_draw_key(canvas, key, model->selected_row >= 0, model->selected_row < 0);
+    }
 
-        for(size_t column = 0; column < column_count; column++) {
-            if(keys[column].value == enter_symbol) {
-                canvas_set_color(canvas, ColorBlack);
-                if(model->selected_row == row && model->selected_column == column) {
-                    canvas_draw_icon(
-                        canvas,
-                        keyboard_origin_x + keys[column].x,
-                        keyboard_origin_y + keys[column].y,
-                        &I_KeySendSelected_24x11);
-                } else {
-                    canvas_draw_icon(
-                        canvas,
-                        keyboard_origin_x + keys[column].x,
-                        keyboard_origin_y + keys[column].y,
-                        &I_KeySend_24x11);
-                }
-            } else if(keys[column].value == backspace_symbol) {
-                canvas_set_color(canvas, ColorBlack);
-                if(model->selected_row == row && model->selected_column == column) {
-                    canvas_draw_icon(
-                        canvas,
-                        keyboard_origin_x + keys[column].x,
-                        keyboard_origin_y + keys[column].y,
-                        &I_KeyBackspaceSelected_16x9);
-                } else {
-                    canvas_draw_icon(
-                        canvas,
-                        keyboard_origin_x + keys[column].x,
-                        keyboard_origin_y + keys[column].y,
-                        &I_KeyBackspace_16x9);
-                }
-            } else if(keys[column].value == space_symbol) {
-                canvas_set_color(canvas, ColorBlack);
-                if(model->selected_row == row && model->selected_column == column) {
-                    canvas_draw_icon(
-                        canvas,
-                        keyboard_origin_x + keys[column].x - 1,
-                        keyboard_origin_y + keys[column].y - 6,
-                        &I_KeySpaceSelected_12x9);
-                } else {
-                    canvas_draw_icon(
-                        canvas,
-                        keyboard_origin_x + keys[column].x - 1,
-                        keyboard_origin_y + keys[column].y - 6,
-                        &I_KeySpace_12x9);
-                }
-            } else {
-                if(model->selected_row == row && model->selected_column == column) {
-                    canvas_set_color(canvas, ColorBlack);
-                    canvas_draw_box(
-                        canvas,
-                        keyboard_origin_x + keys[column].x - 3,
-                        keyboard_origin_y + keys[column].y - 10,
-                        11,
-                        13);
-                    canvas_set_color(canvas, ColorWhite);
-                } else if(model->selected_row == -1 && row == 0 && model->selected_column == column) {
-                    canvas_set_color(canvas, ColorBlack);
-                    canvas_draw_frame(
-                        canvas,
-                        keyboard_origin_x + keys[column].x - 3,
-                        keyboard_origin_y + keys[column].y - 10,
-                        11,
-                        13);
-                } else {
-                    canvas_set_color(canvas, ColorBlack);
-                }
+    // Anything queued goes out along with the next send; so show how much, above the send key.
+    if(model->queued) {
+        char queued[5];
+        snprintf(queued, sizeof(queued), "+%u", (unsigned)model->queued);
+
+        canvas_set_color(canvas, ColorBlack);
+        canvas_draw_str_aligned(canvas, 114, 49, AlignCenter, AlignBottom, queued);
+    }
+
+    // Keep track of how long frames take, so we can see the cost of redraws during key repeat.
+    const uint32_t end = DWT->CYCCNT;
+    model->frame_us = (end - start) / furi_hal_cortex_instructions_per_microsecond();
+    model->frame_us_average += ((int32_t)model->frame_us - (int32_t)model->frame_us_average) / 8;
+
+    // This frame shows every change made so far; so time the oldest, from its key to here.
+    if(model->change_pending) {
+        pirate_latency_record(
+            &model->latency,
+            (end - model->change_arrival) / furi_hal_cortex_instructions_per_microsecond());
+        model->change_pending = false;
+    }
+
+    // If this is a frame repeats were held back for, have them applied now it's drawn; not
+    // whenever the next key event happens along.
+    PirateInput* pirate_input = model->pirate_input;
+    if(pirate_input->frame_pending && pirate_input->view_dispatcher &&
+       !pirate_input->frame_event_pending) {
+        pirate_input->frame_event_pending = true;
+        view_dispatcher_send_custom_event(pirate_input->view_dispatcher, pirate_input->frame_event);
+    }
+    pirate_input->frame_pending = false;
+}
 
-                canvas_draw_glyph(
-                    canvas,
-                    keyboard_origin_x + keys[column].x,
-                    keyboard_origin_y + keys[column].y,
-                    keys[column].value);
+/**
+ * @brief Apply a single key press
+ *
+ * @param model
+ * @param key
+ * @param type
+ * @return true if the press meant something to us
+ */
+static bool pirate_input_handle_key(PirateInputModel* model, InputKey key, InputType type) {
+    if(type == InputTypeShort || type == InputTypeRepeat) {
+        switch(key) {
+        case InputKeyLeft:
+            pirate_input_handle_left(model);
+            return true;
+        case InputKeyRight:
+            pirate_input_handle_right(model);
+            return true;
+        case InputKeyUp:
+            pirate_input_handle_up(model);
+            return true;
+        case InputKeyDown:
+            pirate_input_handle_down(model);
+            return true;
+        case InputKeyOk:
+            // Holding send queues the command; it mustn't then repeat-send it.
+            if((type == InputTypeShort) || !pirate_input_send_selected(model)) {
+                pirate_input_handle_ok(model);
             }
+            return true;
+        default:
+            break;
+        }
+    }
+
+    if((type == InputTypeLong) && (key == InputKeyOk)) {
+        if(pirate_input_send_selected(model)) {
+            pirate_input_handle_queue(model);
         }
+        return true;
     }
+
+    if((type == InputTypeLong || type == InputTypeRepeat) && key == InputKeyBack) {
+        pirate_input_backspace(model);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Note a change that's waiting to be drawn; unless an older one already is
+ *
+ * @param model
+ * @param arrival When the key behind the change came in, as a cycle count
+ */
+static void pirate_input_note_change(PirateInputModel* model, uint32_t arrival) {
+    if(!model->change_pending) {
+        model->change_arrival = arrival;
+        model->change_pending = true;
+    }
+}
+
+/**
+ * @brief Apply any repeats we've gathered up, in a single update
+ *
+ * @param pirate_input
+ */
+static void pirate_input_flush_repeats(PirateInput* pirate_input) {
+    if(!pirate_input->repeat_count) {
+        return;
+    }
+
+    // Flag the frame before asking for it; it may well be drawn before we're back.
+    pirate_input->frame_pending = true;
+    pirate_input->frame_requested = furi_get_tick();
+
+    with_view_model(
+        pirate_input->view, PirateInputModel * model, {
+            for(uint32_t i = 0; i < pirate_input->repeat_count; ++i) {
+                pirate_input_handle_key(model, pirate_input->repeat_key, InputTypeRepeat);
+            }
+            pirate_input_note_change(model, pirate_input->repeat_arrival);
+        }, true);
+
+    pirate_input->run_updates += 1;
+    pirate_input->repeat_count = 0;
 }
 
 /**
@@ -571,62 +1555,107 @@ static void pirate_input_view_draw_callback(Canvas* canvas, void* _model) {
 static bool pirate_input_view_input_callback(InputEvent* event, void* context) {
     PirateInput* pirate_input = context;
     furi_assert(pirate_input);
+    const uint32_t arrival = DWT->CYCCNT;
     bool consumed = false;
 
-    if(event->type == InputTypeShort || event->type == InputTypeRepeat) {
-        switch(event->key) {
-        case InputKeyLeft:
-            with_view_model(
-                pirate_input->view, PirateInputModel * model, {
-                    pirate_input_handle_left(model);
-                }, true);
-            consumed = true;
-            break;
-        case InputKeyRight:
-            with_view_model(
-                pirate_input->view, PirateInputModel * model, {
-                    pirate_input_handle_right(model);
-                }, true);
-            consumed = true;
-            break;
-        case InputKeyUp:
-            with_view_model(
-                pirate_input->view, PirateInputModel * model, {
-                    pirate_input_handle_up(model);
-                }, true);
-            consumed = true;
-            break;
-        case InputKeyDown:
-            with_view_model(
-                pirate_input->view, PirateInputModel * model, {
-                    pirate_input_handle_down(model);
-                }, true);
-            consumed = true;
-            break;
-        case InputKeyOk:
-            with_view_model(
-                pirate_input->view, PirateInputModel * model, {
-                    pirate_input_handle_ok(model);
-                }, true);
-            consumed = true;
-            break;
-        default:
-            break;
+    // Repeats come faster than we can draw them; rather than queue up behind the redraws,
+    // gather them, and apply them all once the last frame's on screen.
+    if(event->type == InputTypeRepeat) {
+        if(pirate_input->repeat_count && (pirate_input->repeat_key != event->key)) {
+            pirate_input_flush_repeats(pirate_input);
         }
-    }
+        if(!pirate_input->repeat_count) {
+            pirate_input->repeat_key = event->key;
+            pirate_input->repeat_arrival = arrival;
+        }
+
+        pirate_input->repeat_count += 1;
+        pirate_input->run_repeats += 1;
 
-    if((event->type == InputTypeLong || event->type == InputTypeRepeat) &&
-       event->key == InputKeyBack) {
-        with_view_model(
-            pirate_input->view, PirateInputModel * model, {
-                pirate_input_backspace(model);
-            }, true);
-        consumed = true;
+        if(!pirate_input->frame_pending ||
+           (furi_get_tick() - pirate_input->frame_requested >=
+            furi_ms_to_ticks(PIRATE_INPUT_FRAME_TIMEOUT_MS))) {
+            pirate_input_flush_repeats(pirate_input);
+        }
+        return true;
     }
 
+    // Anything else ends a run of repeats; what's left of it goes first, so keys stay in order.
+    // Then we only ask for a redraw if the key did something; releases, for one, don't.
+    pirate_input_flush_repeats(pirate_input);
+
+    with_view_model(
+        pirate_input->view, PirateInputModel * model, {
+            consumed = pirate_input_handle_key(model, event->key, event->type);
+            if(consumed) {
+                pirate_input_note_change(model, arrival);
+            }
+
+            // Held keys are where redraw cost shows up; report it once each is let go.
+            if((event->type == InputTypeRelease) && pirate_input->run_repeats) {
+                PirateLatencySummary latency;
+                pirate_latency_summarize(&model->latency, &latency);
+
+                FURI_LOG_D(
+                    "PirateInput",
+                    "held key: %lu repeats in %lu updates; input-to-pixel, overall, p50 %luus, p99 %luus, "
+                    "max %luus; redraw %luus average",
+                    (unsigned long)pirate_input->run_repeats,
+                    (unsigned long)pirate_input->run_updates,
+                    (unsigned long)latency.p50,
+                    (unsigned long)latency.p99,
+                    (unsigned long)latency.max,
+                    (unsigned long)model->frame_us_average);
+
+                pirate_input->run_repeats = 0;
+                pirate_input->run_updates = 0;
+            }
+        }, consumed);
+
     return consumed;
 }
 
+/**
+ * @brief Custom event callback; applies repeats held back for a frame that's now been drawn
+ *
+ * @param event
+ * @param context
+ * @return true if the event was the frame's
+ */
+static bool pirate_input_view_custom_callback(uint32_t event, void* context) {
+    PirateInput* pirate_input = context;
+    furi_assert(pirate_input);
+
+    if(!pirate_input->view_dispatcher || (event != pirate_input->frame_event)) {
+        return false;
+    }
+
+    pirate_input->frame_event_pending = false;
+    pirate_input_flush_repeats(pirate_input);
+    return true;
+}
+
+/**
+ * @brief Exit callback; hands the buffer back as a plain string
+ *
+ * @param context
+ */
+static void pirate_input_view_exit_callback(void* context) {
+    PirateInput* pirate_input = context;
+    furi_assert(pirate_input);
+
+    // Any repeats still held back were meant for this screen; they're dropped with it. An event
+    // still in flight goes to whichever view's next, which won't want it; so don't wait on it.
+    pirate_input->repeat_count = 0;
+    pirate_input->frame_pending = false;
+    pirate_input->frame_event_pending = false;
+
+    with_view_model(
+        pirate_input->view, PirateInputModel * model, {
+            pirate_input_close_gap(model);
+        }, false);
+}
+
 /**
  * @brief Reset all input-related data in model
  * 
@@ -636,10 +1665,16 @@ static void pirate_input_reset_model_input_data(PirateInputModel* model) {
     model->chars = NULL;
     model->char_count = 0;
     model->max_length = 0;
+    model->gap_start = 0;
+    model->token_count = 0;
     model->selected_char = 0;
     model->selected_row = 0;
     model->selected_column = 0;
     model->first_visible_char = 0;
+    model->history_age = 0;
+    model->predictions.count = 0;
+    model->predictions.replace = 0;
+    model->selected_prediction = 0;
 }
 
 /** 
@@ -649,17 +1684,36 @@ static void pirate_input_reset_model_input_data(PirateInputModel* model) {
  */
 PirateInput* pirate_input_alloc() {
     PirateInput* pirate_input = malloc(sizeof(PirateInput));
+    pirate_input->repeat_count = 0;
+    pirate_input->run_repeats = 0;
+    pirate_input->run_updates = 0;
+    pirate_input->frame_pending = false;
+    pirate_input->view_dispatcher = NULL;
+    pirate_input->frame_event = 0;
+    pirate_input->frame_event_pending = false;
     pirate_input->view = view_alloc();
     view_set_context(pirate_input->view, pirate_input);
     view_allocate_model(pirate_input->view, ViewModelTypeLocking, sizeof(PirateInputModel));
     view_set_draw_callback(pirate_input->view, pirate_input_view_draw_callback);
     view_set_input_callback(pirate_input->view, pirate_input_view_input_callback);
+    view_set_custom_callback(pirate_input->view, pirate_input_view_custom_callback);
+    view_set_exit_callback(pirate_input->view, pirate_input_view_exit_callback);
 
     with_view_model(
         pirate_input->view, PirateInputModel * model, {
             model->input_callback = NULL;
             model->changed_callback = NULL;
             model->callback_context = NULL;
+            model->history_callback = NULL;
+            model->history_context = NULL;
+            model->queue_callback = NULL;
+            model->queue_context = NULL;
+            model->queued = 0;
+            model->prediction_callback = NULL;
+            model->prediction_context = NULL;
+            model->change_pending = false;
+            model->pirate_input = pirate_input;
+            pirate_latency_reset(&model->latency);
             pirate_input_reset_model_input_data(model);
         }, false);
 
@@ -673,6 +1727,13 @@ PirateInput* pirate_input_alloc() {
  */
 void pirate_input_free(PirateInput* pirate_input) {
     furi_assert(pirate_input);
+
+    with_view_model(
+        pirate_input->view, PirateInputModel * model, {
+            free(model->keyboard_layer);
+            free(model->tokens);
+        }, false);
+
     view_free(pirate_input->view);
     free(pirate_input);
 }
@@ -715,21 +1776,149 @@ void pirate_input_set_result_callback(
     CharChangedCallback changed_callback,
     void* callback_context,
     char* chars,
-    uint8_t max_length) {
+    uint16_t max_length) {
 
     with_view_model(
         pirate_input->view,
         PirateInputModel * model,
         {
+            pirate_input_close_gap(model);
             pirate_input_reset_model_input_data(model);
             model->input_callback = input_callback;
             model->changed_callback = changed_callback;
             model->callback_context = callback_context;
             model->chars = chars;
-            model->char_count = strlen(chars);
+            model->char_count = chars ? strlen(chars) : 0;
             model->selected_char = model->char_count;
+            model->gap_start = model->char_count;
             model->max_length = max_length;
+            pirate_input_tokenize_all(model);
+            pirate_input_update_predictions(model);
+        },
+        false);
+}
+
+/**
+ * @brief Set the keyboard layout
+ *
+ * @param pirate_input command input instance
+ * @param layout the keyboard to show
+ */
+void pirate_input_set_layout(PirateInput* pirate_input, PirateInputLayout layout) {
+    with_view_model(
+        pirate_input->view,
+        PirateInputModel * model,
+        {
+            // The cached keyboard is of the old layout; it'll be rendered afresh on the next draw.
+            if(model->layout != layout) {
+                free(model->keyboard_layer);
+                model->keyboard_layer = NULL;
+                model->layout = layout;
+            }
+
+            if(model->selected_row >= 0) {
+                uint8_t size = pirate_input_get_row_size(model, model->selected_row);
+                model->selected_column = MIN(model->selected_column, size - 1);
+            }
+        },
+        true);
+}
+
+/**
+ * @brief Set the source of earlier commands
+ *
+ * @param pirate_input command input instance
+ * @param history_callback history callback fn
+ * @param history_context history callback context
+ */
+void pirate_input_set_history_callback(
+    PirateInput* pirate_input,
+    PirateInputHistoryCallback history_callback,
+    void* history_context) {
+    with_view_model(
+        pirate_input->view,
+        PirateInputModel * model,
+        {
+            model->history_callback = history_callback;
+            model->history_context = history_context;
+            model->history_age = 0;
+        },
+        false);
+}
+
+/**
+ * @brief Set who's told when OK is held on the send key
+ *
+ * @param pirate_input command input instance
+ * @param queue_callback queue callback fn
+ * @param queue_context queue callback context
+ */
+void pirate_input_set_queue_callback(
+    PirateInput* pirate_input,
+    PirateInputCallback queue_callback,
+    void* queue_context) {
+    with_view_model(
+        pirate_input->view,
+        PirateInputModel * model,
+        {
+            model->queue_callback = queue_callback;
+            model->queue_context = queue_context;
         },
         false);
 }
 
+/**
+ * @brief Set where to post word that a frame's been drawn
+ *
+ * @param pirate_input command input instance
+ * @param view_dispatcher the dispatcher the view's shown by, or NULL for none
+ * @param event custom event to post; the view consumes it
+ */
+void pirate_input_set_frame_event(
+    PirateInput* pirate_input,
+    ViewDispatcher* view_dispatcher,
+    uint32_t event) {
+    furi_assert(pirate_input);
+
+    pirate_input->view_dispatcher = view_dispatcher;
+    pirate_input->frame_event = event;
+    pirate_input->frame_event_pending = false;
+}
+
+/**
+ * @brief Set the number of commands shown as queued
+ *
+ * @param pirate_input command input instance
+ * @param queued number of commands queued; 0 shows nothing
+ */
+void pirate_input_set_queued(PirateInput* pirate_input, uint8_t queued) {
+    with_view_model(
+        pirate_input->view,
+        PirateInputModel * model,
+        {
+            model->queued = queued;
+        },
+        true);
+}
+
+/**
+ * @brief Set the source of predictions
+ *
+ * @param pirate_input command input instance
+ * @param prediction_callback prediction callback fn
+ * @param prediction_context prediction callback context
+ */
+void pirate_input_set_prediction_callback(
+    PirateInput* pirate_input,
+    PirateInputPredictionCallback prediction_callback,
+    void* prediction_context) {
+    with_view_model(
+        pirate_input->view,
+        PirateInputModel * model,
+        {
+            model->prediction_callback = prediction_callback;
+            model->prediction_context = prediction_context;
+            pirate_input_update_predictions(model);
+        },
+        true);
+}
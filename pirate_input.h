@@ -6,6 +6,9 @@
 #pragma once
 
 #include <gui/view.h>
+#include <gui/view_dispatcher.h>
+
+#include "lib/pirate_predict.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,6 +23,23 @@ typedef void (*PirateInputCallback)(void* context);
 /** callback that is executed when byte buffer is changed */
 typedef void (*CharChangedCallback)(void* context);
 
+/** Keyboards for each bus; they differ only in their punctuation */
+typedef enum {
+    PirateInputLayoutI2c,
+    PirateInputLayoutSpi,
+    PirateInputLayoutOneWire,
+} PirateInputLayout;
+
+/** callback that fetches an earlier command into the buffer; returns false if there isn't one */
+typedef bool (*PirateInputHistoryCallback)(void* context, uint32_t age, char* buffer, size_t size);
+
+/** callback that fills in what might come next, given the transaction typed so far; see pirate_predict() */
+typedef void (*PirateInputPredictionCallback)(
+    void* context,
+    const char* text,
+    size_t length,
+    PiratePredictions* predictions);
+
 /** Allocate and initialize byte input. This byte input is used to enter bytes.
  *
  * @return     PirateInput instance pointer
@@ -44,6 +64,10 @@ void pirate_input_reset(PirateInput *pirate_input);
 View* pirate_input_get_view(PirateInput* pirate_input);
 
 /** Set byte input result callback
+ *
+ * While the view is being edited, the buffer holds the text in two pieces, either side
+ * of the cursor. It's a plain null-terminated string again whenever a callback is
+ * called, and once the view is exited.
  *
  * @param      pirate_input        byte input instance
  * @param      input_callback    input callback fn
@@ -58,7 +82,78 @@ void pirate_input_set_result_callback(
     CharChangedCallback changed_callback,
     void* callback_context,
     char* buffer,
-    uint8_t max_length);
+    uint16_t max_length);
+
+/** Set the keyboard layout
+ *
+ * @param      pirate_input  byte input instance
+ * @param      layout        the keyboard to show; I2C's until told otherwise
+ */
+void pirate_input_set_layout(PirateInput* pirate_input, PirateInputLayout layout);
+
+/** Set the source of earlier commands
+ *
+ * With the input row selected, each press of Up replaces the buffer with the next
+ * older command: age 0 first, then 1, and so on.
+ *
+ * @param      pirate_input      byte input instance
+ * @param      history_callback  history callback fn, or NULL for no history
+ * @param      history_context   history callback context
+ */
+void pirate_input_set_history_callback(
+    PirateInput* pirate_input,
+    PirateInputHistoryCallback history_callback,
+    void* history_context);
+
+/** Set what happens when OK is held on the send key
+ *
+ * The buffer's a plain string again when the callback is called, as for the result
+ * callback; the callback's meant to queue the command, to be sent with the next.
+ *
+ * @param      pirate_input    byte input instance
+ * @param      queue_callback  queue callback fn, or NULL to do nothing
+ * @param      queue_context   queue callback context
+ */
+void pirate_input_set_queue_callback(
+    PirateInput* pirate_input,
+    PirateInputCallback queue_callback,
+    void* queue_context);
+
+/** Set where to post word that a frame's been drawn
+ *
+ * Repeats of a held key are held back while a frame's being drawn. The draw posts this
+ * event, which the view handles itself, so they're applied as soon as the frame's on
+ * screen; without it, they wait for the next key event.
+ *
+ * @param      pirate_input     byte input instance
+ * @param      view_dispatcher  the dispatcher the view's shown by, or NULL for none
+ * @param      event            custom event to post; the view consumes it
+ */
+void pirate_input_set_frame_event(
+    PirateInput* pirate_input,
+    ViewDispatcher* view_dispatcher,
+    uint32_t event);
+
+/** Set the number of commands shown as queued, beside the send key
+ *
+ * @param      pirate_input  byte input instance
+ * @param      queued        number of commands queued; 0 shows nothing
+ */
+void pirate_input_set_queued(PirateInput* pirate_input, uint8_t queued);
+
+/** Set the source of predictions, for the bar between the input row and the keyboard
+ *
+ * Whenever the cursor sits at the end of a word inside a transaction, the bar offers what
+ * the callback predicts; OK on one replaces the word being typed with it.
+ *
+ * @param      pirate_input         byte input instance
+ * @param      prediction_callback  prediction callback fn, or NULL for an empty bar
+ * @param      prediction_context   prediction callback context
+ */
+void pirate_input_set_prediction_callback(
+    PirateInput* pirate_input,
+    PirateInputPredictionCallback prediction_callback,
+    void* prediction_context);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,112 @@
+#include "pirate_onewire.h"
+
+#include <furi_hal.h>
+
+#include "bus/bus_onewire.h"
+
+#define PIRATE_ONEWIRE_SCAN_STACK_SIZE 1024
+
+struct PirateOneWireScanner {
+    FuriThread* thread;
+
+    ViewDispatcher* view_dispatcher;
+    uint32_t complete_event;
+
+    PirateOneWireBus bus;
+    PirateOneWireSearch search;
+
+    volatile bool busy;
+    volatile bool abort;
+    PirateOneWireScanResult result;
+};
+
+static int32_t pirate_onewire_scanner_worker(void* context) {
+    PirateOneWireScanner* scanner = context;
+    PirateOneWireScanResult* result = &scanner->result;
+    uint32_t cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+
+    memset(result, 0, sizeof(*result));
+    memset(&scanner->bus, 0, sizeof(scanner->bus));
+    pirate_onewire_search_reset(&scanner->search);
+
+    pirate_onewire_bus_acquire(&scanner->bus);
+    uint32_t search_start = DWT->CYCCNT;
+
+    for(;;) {
+        if(scanner->abort || result->count == PIRATE_ONEWIRE_SCAN_MAX_DEVICES) {
+            result->truncated = !scanner->search.done;
+            break;
+        }
+
+        if(!pirate_onewire_bus_search(&scanner->bus, &scanner->search)) {
+            result->bus_error = !scanner->search.done;
+            break;
+        }
+
+        memcpy(result->roms[result->count++], scanner->search.rom, sizeof(scanner->search.rom));
+    }
+
+    result->search_us = (DWT->CYCCNT - search_start) / cycles_per_us;
+    pirate_onewire_bus_release(&scanner->bus);
+
+    result->empty = !result->count && scanner->search.done;
+    result->slots = scanner->bus.slots;
+
+    scanner->busy = false;
+    view_dispatcher_send_custom_event(scanner->view_dispatcher, scanner->complete_event);
+    return 0;
+}
+
+PirateOneWireScanner* pirate_onewire_scanner_alloc(ViewDispatcher* view_dispatcher, uint32_t complete_event) {
+    PirateOneWireScanner* scanner = malloc(sizeof(PirateOneWireScanner));
+    memset(scanner, 0, sizeof(*scanner));
+
+    scanner->view_dispatcher = view_dispatcher;
+    scanner->complete_event = complete_event;
+    scanner->thread = furi_thread_alloc_ex(
+        "PirateOneWire", PIRATE_ONEWIRE_SCAN_STACK_SIZE, pirate_onewire_scanner_worker, scanner);
+
+    return scanner;
+}
+
+void pirate_onewire_scanner_free(PirateOneWireScanner* scanner) {
+    furi_assert(scanner);
+
+    pirate_onewire_scanner_stop(scanner);
+    furi_thread_free(scanner->thread);
+    free(scanner);
+}
+
+bool pirate_onewire_scanner_start(PirateOneWireScanner* scanner) {
+    furi_assert(scanner);
+
+    if(scanner->busy) {
+        return false;
+    }
+
+    // Reap the last search's thread before we reuse it.
+    furi_thread_join(scanner->thread);
+
+    scanner->abort = false;
+    scanner->busy = true;
+    furi_thread_start(scanner->thread);
+    return true;
+}
+
+bool pirate_onewire_scanner_is_busy(PirateOneWireScanner* scanner) {
+    furi_assert(scanner);
+    return scanner->busy;
+}
+
+void pirate_onewire_scanner_stop(PirateOneWireScanner* scanner) {
+    furi_assert(scanner);
+
+    // Each device is a few milliseconds on the wire, so this never waits long.
+    scanner->abort = true;
+    furi_thread_join(scanner->thread);
+}
+
+void pirate_onewire_scanner_get_result(PirateOneWireScanner* scanner, PirateOneWireScanResult* result) {
+    furi_assert(scanner);
+    memcpy(result, &scanner->result, sizeof(*result));
+}
@@ -0,0 +1,58 @@
+/**
+ * @file pirate_onewire.h
+ * 1-Wire ROM search: finds every device on the bus, by its 64-bit ROM code.
+ *
+ * The search runs on its own thread, under a single bus acquisition; each device takes a reset,
+ * the search command and 192 slots, all made by the timer, so the thread spends the search
+ * asleep. A bus of 20 sensors takes around a third of a second.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <gui/view_dispatcher.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Most devices we'll list; the search stops once it's found this many. */
+#define PIRATE_ONEWIRE_SCAN_MAX_DEVICES 32
+
+typedef struct {
+    /** ROM codes, in the order the search found them: family code first, CRC last. */
+    uint8_t roms[PIRATE_ONEWIRE_SCAN_MAX_DEVICES][8];
+    uint8_t count;
+
+    /** Whether nobody answered the first reset; and whether the search stopped before the end. */
+    bool empty;
+    bool truncated;
+    bool bus_error;
+
+    /** Time the whole search took, in microseconds; and the slots it took, resets included. */
+    uint32_t search_us;
+    uint32_t slots;
+} PirateOneWireScanResult;
+
+typedef struct PirateOneWireScanner PirateOneWireScanner;
+
+/**
+ * @param view_dispatcher   Receives our completion event.
+ * @param complete_event    Custom event sent when a search finishes.
+ */
+PirateOneWireScanner* pirate_onewire_scanner_alloc(ViewDispatcher* view_dispatcher, uint32_t complete_event);
+void pirate_onewire_scanner_free(PirateOneWireScanner* scanner);
+
+/** Starts a search on the scanner's thread. Returns false if one's already running. */
+bool pirate_onewire_scanner_start(PirateOneWireScanner* scanner);
+bool pirate_onewire_scanner_is_busy(PirateOneWireScanner* scanner);
+
+/** Cuts any search in progress short, after the device it's on; and waits until the bus is free. */
+void pirate_onewire_scanner_stop(PirateOneWireScanner* scanner);
+
+/** Fetches the result of the most recent search. */
+void pirate_onewire_scanner_get_result(PirateOneWireScanner* scanner, PirateOneWireScanResult* result);
+
+#ifdef __cplusplus
+}
+#endif
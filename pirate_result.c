@@ -0,0 +1,230 @@
+#include "pirate_result.h"
+
+#include <storage/storage.h>
+
+#include "lib/pirate_ring.h"
+
+#define PIRATE_RESULT_SPOOL_STACK_SIZE 2048
+
+typedef enum {
+    PirateResultFlagData = (1 << 0),
+    PirateResultFlagFlush = (1 << 1),
+    PirateResultFlagExit = (1 << 2),
+} PirateResultFlag;
+
+struct PirateResultStore {
+    PirateRing ring;
+    uint8_t ring_storage[PIRATE_RESULT_RING_SIZE];
+
+    Storage* storage;
+
+    /**
+     * Drains the ring to SD, when we're spooling. Both files are allocated once, up front,
+     * and only opened and closed per result; so running a command never touches the heap.
+     */
+    FuriThread* spool_thread;
+    FuriSemaphore* spool_flushed;
+    File* spool_file;
+    bool spooling;
+    volatile bool spool_failed;
+
+    /** Lazily opened when someone reads back a spooled result. */
+    File* reader;
+
+    /** Set to release a producer waiting on a full ring. */
+    volatile bool cancelled;
+};
+
+/**
+ * Spool thread: the consumer, when a result is too large for RAM.
+ */
+
+static void pirate_result_spool_drain(PirateResultStore* store) {
+    const uint8_t* data;
+    uint32_t available;
+
+    // Write straight out of the ring; no intermediate copies.
+    while((available = pirate_ring_peek_contiguous(&store->ring, &data)) > 0) {
+        if(!store->spool_failed &&
+           (storage_file_write(store->spool_file, data, available) != available)) {
+            // Keep draining even if the card's gone; otherwise our producer would wait forever.
+            store->spool_failed = true;
+        }
+
+        pirate_ring_consume(&store->ring, available);
+    }
+}
+
+static int32_t pirate_result_spool_worker(void* context) {
+    PirateResultStore* store = context;
+
+    while(true) {
+        uint32_t flags = furi_thread_flags_wait(
+            PirateResultFlagData | PirateResultFlagFlush | PirateResultFlagExit,
+            FuriFlagWaitAny,
+            FuriWaitForever);
+
+        if(flags & PirateResultFlagExit) {
+            break;
+        }
+
+        pirate_result_spool_drain(store);
+
+        if(flags & PirateResultFlagFlush) {
+            furi_semaphore_release(store->spool_flushed);
+        }
+    }
+
+    return 0;
+}
+
+static void pirate_result_store_close_reader(PirateResultStore* store) {
+    if(storage_file_is_open(store->reader)) {
+        storage_file_close(store->reader);
+    }
+}
+
+/**
+ * Public API.
+ */
+
+PirateResultStore* pirate_result_store_alloc(PirateArena* arena) {
+    PirateResultStore* store = pirate_arena_alloc(arena, sizeof(PirateResultStore));
+    furi_check(store);
+
+    pirate_ring_init(&store->ring, store->ring_storage, sizeof(store->ring_storage));
+
+    store->storage = furi_record_open(RECORD_STORAGE);
+    store->spool_file = storage_file_alloc(store->storage);
+    store->reader = storage_file_alloc(store->storage);
+    store->spool_flushed = furi_semaphore_alloc(1, 0);
+    store->spool_thread = furi_thread_alloc_ex(
+        "PirateSpool", PIRATE_RESULT_SPOOL_STACK_SIZE, pirate_result_spool_worker, store);
+    furi_thread_start(store->spool_thread);
+
+    return store;
+}
+
+void pirate_result_store_free(PirateResultStore* store) {
+    furi_assert(store);
+
+    furi_thread_flags_set(furi_thread_get_id(store->spool_thread), PirateResultFlagExit);
+    furi_thread_join(store->spool_thread);
+    furi_thread_free(store->spool_thread);
+    furi_semaphore_free(store->spool_flushed);
+
+    pirate_result_store_close_reader(store);
+    storage_file_free(store->reader);
+    storage_file_free(store->spool_file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+void pirate_result_store_begin(PirateResultStore* store, uint32_t expected) {
+    furi_assert(store);
+
+    pirate_result_store_close_reader(store);
+    pirate_ring_reset(&store->ring);
+
+    store->cancelled = false;
+    store->spool_failed = false;
+    store->spooling = (expected > PIRATE_RESULT_RING_SIZE);
+
+    // If this result won't fit in RAM, send it to the SD card as it arrives.
+    if(store->spooling) {
+        if(!storage_file_open(
+               store->spool_file, PIRATE_RESULT_SPOOL_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+            store->spool_failed = true;
+        }
+    }
+}
+
+bool pirate_result_store_write(PirateResultStore* store, const uint8_t* data, size_t length) {
+    FuriThreadId spool = furi_thread_get_id(store->spool_thread);
+
+    while(length) {
+        uint32_t written = pirate_ring_write(&store->ring, data, length);
+        data += written;
+        length -= written;
+
+        if(store->spooling) {
+            furi_thread_flags_set(spool, PirateResultFlagData);
+
+            // The ring's full; give the spool a moment to catch up.
+            if(length) {
+                if(store->cancelled) {
+                    return false;
+                }
+                furi_delay_tick(1);
+            }
+        } else if(length) {
+            // With no consumer, we're the only one touching the ring; keep the newest data.
+            pirate_ring_consume(&store->ring, MIN(length, PIRATE_RESULT_RING_SIZE));
+        }
+    }
+
+    return true;
+}
+
+void pirate_result_store_end(PirateResultStore* store) {
+    furi_assert(store);
+
+    if(!store->spooling) {
+        return;
+    }
+
+    // Wait for the spool to drain everything we've written, then close out the file.
+    furi_thread_flags_set(furi_thread_get_id(store->spool_thread), PirateResultFlagFlush);
+    furi_semaphore_acquire(store->spool_flushed, FuriWaitForever);
+
+    storage_file_close(store->spool_file);
+
+    if(store->spool_failed) {
+        FURI_LOG_E("PirateResult", "failed to spool result to SD");
+    }
+}
+
+void pirate_result_store_cancel(PirateResultStore* store) {
+    furi_assert(store);
+    store->cancelled = true;
+}
+
+uint32_t pirate_result_store_length(PirateResultStore* store) {
+    furi_assert(store);
+    return pirate_ring_head(&store->ring);
+}
+
+uint32_t pirate_result_store_get_stack_headroom(PirateResultStore* store) {
+    furi_assert(store);
+    return furi_thread_get_stack_space(furi_thread_get_id(store->spool_thread));
+}
+
+bool pirate_result_store_is_spooled(PirateResultStore* store) {
+    furi_assert(store);
+    return store->spooling && !store->spool_failed;
+}
+
+size_t pirate_result_store_read(
+    PirateResultStore* store,
+    uint32_t offset,
+    uint8_t* data,
+    size_t length) {
+    furi_assert(store);
+
+    // Recent data is still in RAM...
+    size_t count = pirate_ring_copy_at(&store->ring, offset, data, length);
+    if(count || !pirate_result_store_is_spooled(store)) {
+        return count;
+    }
+
+    // ... and older data has to come back from the card.
+    if(!storage_file_is_open(store->reader) &&
+       !storage_file_open(store->reader, PIRATE_RESULT_SPOOL_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        return 0;
+    }
+
+    if(!storage_file_seek(store->reader, offset, true)) {
+        return 0;
+    }
+
+    return storage_file_read(store->reader, data, length);
+}
@@ -0,0 +1,83 @@
+/**
+ * @file pirate_result.h
+ * Streaming store for data read from the bus.
+ *
+ * The engine writes into a fixed-size ring while a consumer drains it. Small results simply
+ * stay in the ring; results too large for it are spooled to the SD card as they arrive, so
+ * reads of any length run in constant memory. Either way, the data can be read back by offset.
+ */
+
+#pragma once
+
+#include <furi.h>
+
+#include "lib/pirate_arena.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bytes of result we hold in RAM. Must be a power of two. */
+#define PIRATE_RESULT_RING_SIZE 1024
+
+/** Where oversized results are spooled. */
+#define PIRATE_RESULT_SPOOL_PATH APP_DATA_PATH("result.bin")
+
+typedef struct PirateResultStore PirateResultStore;
+
+/**
+ * Allocates a store, and starts its spool thread.
+ *
+ * @param arena     Where the store and its ring live; pirate_result_store_free() doesn't give
+ *                  them back, so the arena must outlast the store.
+ */
+PirateResultStore* pirate_result_store_alloc(PirateArena* arena);
+void pirate_result_store_free(PirateResultStore* store);
+
+/**
+ * Producer: prepares the store for a new result, discarding the old one.
+ *
+ * @param store         The store to reset.
+ * @param expected      The number of bytes we expect to be written. If this won't fit
+ *                      in RAM, the result is spooled to SD as it's written.
+ */
+void pirate_result_store_begin(PirateResultStore* store, uint32_t expected);
+
+/**
+ * Producer: appends data to the current result.
+ *
+ * When spooling, blocks while the ring is full, until the spool catches up or the store is cancelled.
+ *
+ * @return False if the data couldn't all be stored.
+ */
+bool pirate_result_store_write(PirateResultStore* store, const uint8_t* data, size_t length);
+
+/** Producer: finishes the current result, waiting for any spooling to complete. */
+void pirate_result_store_end(PirateResultStore* store);
+
+/** Releases a producer blocked in pirate_result_store_write(). Safe to call from any thread. */
+void pirate_result_store_cancel(PirateResultStore* store);
+
+/** Returns the total length of the current result. */
+uint32_t pirate_result_store_length(PirateResultStore* store);
+
+/** Returns true iff the current result was spooled to SD. */
+bool pirate_result_store_is_spooled(PirateResultStore* store);
+
+/** Returns the least stack the spool thread has had to spare, in bytes, since it started. */
+uint32_t pirate_result_store_get_stack_headroom(PirateResultStore* store);
+
+/**
+ * Reads back part of a finished result, by offset.
+ *
+ * @return The number of bytes read; short if the data is no longer available.
+ */
+size_t pirate_result_store_read(
+    PirateResultStore* store,
+    uint32_t offset,
+    uint8_t* data,
+    size_t length);
+
+#ifdef __cplusplus
+}
+#endif
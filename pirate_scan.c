@@ -0,0 +1,95 @@
+#include "pirate_scan.h"
+
+#include <furi_hal.h>
+
+#define PIRATE_SCAN_STACK_SIZE 1024
+
+struct PirateScanner {
+    FuriThread* thread;
+
+    ViewDispatcher* view_dispatcher;
+    uint32_t complete_event;
+
+    volatile bool busy;
+    PirateScanResult result;
+};
+
+static int32_t pirate_scanner_worker(void* context) {
+    PirateScanner* scanner = context;
+    PirateScanResult* result = &scanner->result;
+    FuriHalI2cBusHandle* handle = &furi_hal_i2c_handle_external;
+    uint32_t cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+
+    memset(result, 0, sizeof(*result));
+
+    // Take the bus once for the whole sweep; per-address acquisition would cost more than the probes.
+    furi_hal_i2c_acquire(handle);
+    uint32_t sweep_start = DWT->CYCCNT;
+
+    for(uint8_t address = PIRATE_SCAN_FIRST_ADDRESS; address <= PIRATE_SCAN_LAST_ADDRESS; ++address) {
+        uint32_t probe_start = DWT->CYCCNT;
+
+        // An address-only write: start, address, stop. Nothing else touches the device.
+        bool present = furi_hal_i2c_is_device_ready(handle, address << 1, PIRATE_SCAN_TIMEOUT);
+        uint32_t probe_us = (DWT->CYCCNT - probe_start) / cycles_per_us;
+
+        result->probe_us[address] = MIN(probe_us, (uint32_t)UINT16_MAX);
+        if(present) {
+            result->present[address / 8] |= 1 << (address % 8);
+            result->count += 1;
+        }
+    }
+
+    result->sweep_us = (DWT->CYCCNT - sweep_start) / cycles_per_us;
+    furi_hal_i2c_release(handle);
+
+    scanner->busy = false;
+    view_dispatcher_send_custom_event(scanner->view_dispatcher, scanner->complete_event);
+    return 0;
+}
+
+PirateScanner* pirate_scanner_alloc(ViewDispatcher* view_dispatcher, uint32_t complete_event) {
+    PirateScanner* scanner = malloc(sizeof(PirateScanner));
+    memset(scanner, 0, sizeof(*scanner));
+
+    scanner->view_dispatcher = view_dispatcher;
+    scanner->complete_event = complete_event;
+    scanner->thread =
+        furi_thread_alloc_ex("PirateScan", PIRATE_SCAN_STACK_SIZE, pirate_scanner_worker, scanner);
+
+    return scanner;
+}
+
+void pirate_scanner_free(PirateScanner* scanner) {
+    furi_assert(scanner);
+
+    // Sweeps are short; just let any in progress finish.
+    furi_thread_join(scanner->thread);
+    furi_thread_free(scanner->thread);
+    free(scanner);
+}
+
+bool pirate_scanner_start(PirateScanner* scanner) {
+    furi_assert(scanner);
+
+    if(scanner->busy) {
+        return false;
+    }
+
+    // Reap the last sweep's thread before we reuse it.
+    furi_thread_join(scanner->thread);
+
+    scanner->busy = true;
+    furi_thread_start(scanner->thread);
+    return true;
+}
+
+bool pirate_scanner_is_busy(PirateScanner* scanner) {
+    furi_assert(scanner);
+    return scanner->busy;
+}
+
+void pirate_scanner_get_result(PirateScanner* scanner, PirateScanResult* result) {
+    furi_assert(scanner);
+    memcpy(result, &scanner->result, sizeof(*result));
+}
@@ -0,0 +1,60 @@
+/**
+ * @file pirate_scan.h
+ * Fast I2C bus scanner.
+ *
+ * Sweeps every non-reserved 7-bit address with address-only probes, under a single bus
+ * acquisition, timing each probe with the cycle counter.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <gui/view_dispatcher.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Range of 7-bit addresses we probe; the rest are reserved by the I2C specification. */
+#define PIRATE_SCAN_FIRST_ADDRESS 0x08
+#define PIRATE_SCAN_LAST_ADDRESS 0x77
+
+/** Per-probe timeout, in milliseconds; the smallest the HAL will accept. */
+#define PIRATE_SCAN_TIMEOUT 1
+
+typedef struct {
+    /** Bitmap of the 7-bit addresses that acknowledged. */
+    uint8_t present[128 / 8];
+    uint8_t count;
+
+    /** Time each probe took, in microseconds. */
+    uint16_t probe_us[128];
+
+    /** Time the whole sweep took, in microseconds. */
+    uint32_t sweep_us;
+} PirateScanResult;
+
+/** Returns true iff the given 7-bit address acknowledged. */
+static inline bool pirate_scan_result_is_present(const PirateScanResult* result, uint8_t address) {
+    return result->present[address / 8] & (1 << (address % 8));
+}
+
+typedef struct PirateScanner PirateScanner;
+
+/**
+ * @param view_dispatcher   Receives our completion event.
+ * @param complete_event    Custom event sent when a sweep finishes.
+ */
+PirateScanner* pirate_scanner_alloc(ViewDispatcher* view_dispatcher, uint32_t complete_event);
+void pirate_scanner_free(PirateScanner* scanner);
+
+/** Starts a sweep on the scanner's thread. Returns false if one's already running. */
+bool pirate_scanner_start(PirateScanner* scanner);
+bool pirate_scanner_is_busy(PirateScanner* scanner);
+
+/** Fetches the result of the most recent sweep. */
+void pirate_scanner_get_result(PirateScanner* scanner, PirateScanResult* result);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,212 @@
+#include "pirate_scan_grid.h"
+#include <furi.h>
+
+struct PirateScanGrid {
+    View* view;
+};
+
+typedef struct {
+    PirateScanResult result;
+    bool scanning;
+
+    /** The address whose details are shown in the header. */
+    uint8_t selected;
+
+    PirateScanGridCallback callback;
+    void* callback_context;
+} PirateScanGridModel;
+
+/** The grid has one cell per 7-bit address: sixteen columns, eight rows. */
+static const uint8_t grid_columns = 16;
+static const uint8_t grid_origin_y = 14;
+static const uint8_t cell_width = 8;
+static const uint8_t cell_height = 6;
+
+/**
+ * @brief Draw the summary line, and the selected address' details
+ */
+static void pirate_scan_grid_draw_header(Canvas* canvas, PirateScanGridModel* model) {
+    char text[32];
+
+    if(model->scanning) {
+        canvas_draw_str(canvas, 0, 9, "Scanning...");
+        return;
+    }
+
+    snprintf(
+        text,
+        sizeof(text),
+        "%u found, %lu.%lu ms",
+        model->result.count,
+        (unsigned long)(model->result.sweep_us / 1000),
+        (unsigned long)(model->result.sweep_us % 1000 / 100));
+    canvas_draw_str(canvas, 0, 9, text);
+
+    snprintf(
+        text,
+        sizeof(text),
+        "%02X:%uus",
+        model->selected,
+        model->result.probe_us[model->selected]);
+    canvas_draw_str_aligned(canvas, 127, 9, AlignRight, AlignBottom, text);
+}
+
+/**
+ * @brief Draw callback
+ */
+static void pirate_scan_grid_draw_callback(Canvas* canvas, void* _model) {
+    PirateScanGridModel* model = _model;
+
+    canvas_clear(canvas);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_set_font(canvas, FontSecondary);
+
+    pirate_scan_grid_draw_header(canvas, model);
+
+    for(uint8_t address = PIRATE_SCAN_FIRST_ADDRESS; address <= PIRATE_SCAN_LAST_ADDRESS; ++address) {
+        uint8_t x = (address % grid_columns) * cell_width;
+        uint8_t y = grid_origin_y + (address / grid_columns) * cell_height;
+
+        // Devices that answered get a solid cell; everything else just a dot.
+        if(!model->scanning && pirate_scan_result_is_present(&model->result, address)) {
+            canvas_draw_box(canvas, x + 1, y + 1, cell_width - 2, cell_height - 2);
+        } else {
+            canvas_draw_dot(canvas, x + cell_width / 2, y + cell_height / 2);
+        }
+
+        if(!model->scanning && address == model->selected) {
+            canvas_draw_frame(canvas, x, y, cell_width, cell_height);
+        }
+    }
+}
+
+/**
+ * @brief Moves the selection, keeping it within the scanned range
+ */
+static void pirate_scan_grid_move(PirateScanGridModel* model, int8_t offset) {
+    int16_t selected = model->selected + offset;
+
+    if(selected >= PIRATE_SCAN_FIRST_ADDRESS && selected <= PIRATE_SCAN_LAST_ADDRESS) {
+        model->selected = selected;
+    }
+}
+
+/**
+ * @brief Input callback
+ */
+static bool pirate_scan_grid_input_callback(InputEvent* event, void* context) {
+    PirateScanGrid* scan_grid = context;
+    furi_assert(scan_grid);
+    bool consumed = false;
+
+    if(event->type != InputTypeShort && event->type != InputTypeRepeat) {
+        return false;
+    }
+
+    switch(event->key) {
+    case InputKeyLeft:
+    case InputKeyRight:
+    case InputKeyUp:
+    case InputKeyDown: {
+        int8_t offset = (event->key == InputKeyLeft)  ? -1 :
+                        (event->key == InputKeyRight) ? 1 :
+                        (event->key == InputKeyUp)    ? -grid_columns :
+                                                        grid_columns;
+        with_view_model(
+            scan_grid->view, PirateScanGridModel * model, {
+                pirate_scan_grid_move(model, offset);
+            }, true);
+        consumed = true;
+        break;
+    }
+    case InputKeyOk: {
+        PirateScanGridCallback callback = NULL;
+        void* callback_context = NULL;
+
+        with_view_model(
+            scan_grid->view, PirateScanGridModel * model, {
+                callback = model->callback;
+                callback_context = model->callback_context;
+            }, false);
+
+        // Call out after we've let go of the model, so the callback is free to update us.
+        if(callback) {
+            callback(callback_context);
+        }
+        consumed = true;
+        break;
+    }
+    default:
+        break;
+    }
+
+    return consumed;
+}
+
+PirateScanGrid* pirate_scan_grid_alloc() {
+    PirateScanGrid* scan_grid = malloc(sizeof(PirateScanGrid));
+    scan_grid->view = view_alloc();
+    view_set_context(scan_grid->view, scan_grid);
+    view_allocate_model(scan_grid->view, ViewModelTypeLocking, sizeof(PirateScanGridModel));
+    view_set_draw_callback(scan_grid->view, pirate_scan_grid_draw_callback);
+    view_set_input_callback(scan_grid->view, pirate_scan_grid_input_callback);
+
+    with_view_model(
+        scan_grid->view, PirateScanGridModel * model, {
+            memset(model, 0, sizeof(*model));
+            model->selected = PIRATE_SCAN_FIRST_ADDRESS;
+        }, false);
+
+    return scan_grid;
+}
+
+void pirate_scan_grid_free(PirateScanGrid* scan_grid) {
+    furi_assert(scan_grid);
+    view_free(scan_grid->view);
+    free(scan_grid);
+}
+
+View* pirate_scan_grid_get_view(PirateScanGrid* scan_grid) {
+    furi_assert(scan_grid);
+    return scan_grid->view;
+}
+
+void pirate_scan_grid_set_rescan_callback(
+    PirateScanGrid* scan_grid,
+    PirateScanGridCallback callback,
+    void* context) {
+    furi_assert(scan_grid);
+
+    with_view_model(
+        scan_grid->view, PirateScanGridModel * model, {
+            model->callback = callback;
+            model->callback_context = context;
+        }, false);
+}
+
+void pirate_scan_grid_set_scanning(PirateScanGrid* scan_grid) {
+    furi_assert(scan_grid);
+
+    with_view_model(
+        scan_grid->view, PirateScanGridModel * model, {
+            model->scanning = true;
+        }, true);
+}
+
+void pirate_scan_grid_set_result(PirateScanGrid* scan_grid, const PirateScanResult* result) {
+    furi_assert(scan_grid);
+
+    with_view_model(
+        scan_grid->view, PirateScanGridModel * model, {
+            memcpy(&model->result, result, sizeof(*result));
+            model->scanning = false;
+
+            // Jump to the first device we found, as that's usually what we're interested in.
+            for(uint8_t address = PIRATE_SCAN_FIRST_ADDRESS; address <= PIRATE_SCAN_LAST_ADDRESS; ++address) {
+                if(pirate_scan_result_is_present(result, address)) {
+                    model->selected = address;
+                    break;
+                }
+            }
+        }, true);
+}
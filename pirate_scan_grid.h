@@ -0,0 +1,41 @@
+/**
+ * @file pirate_scan_grid.h
+ * GUI: grid view of an I2C bus scan.
+ */
+
+#pragma once
+
+#include <gui/view.h>
+
+#include "pirate_scan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct PirateScanGrid PirateScanGrid;
+
+/** callback that is executed when the user asks for another sweep */
+typedef void (*PirateScanGridCallback)(void* context);
+
+PirateScanGrid* pirate_scan_grid_alloc();
+void pirate_scan_grid_free(PirateScanGrid* scan_grid);
+
+/** Get scan view, for adding to a view dispatcher. */
+View* pirate_scan_grid_get_view(PirateScanGrid* scan_grid);
+
+/** Sets the callback run when OK is pressed. */
+void pirate_scan_grid_set_rescan_callback(
+    PirateScanGrid* scan_grid,
+    PirateScanGridCallback callback,
+    void* context);
+
+/** Shows that a sweep is in progress. */
+void pirate_scan_grid_set_scanning(PirateScanGrid* scan_grid);
+
+/** Shows the given sweep's results. */
+void pirate_scan_grid_set_result(PirateScanGrid* scan_grid, const PirateScanResult* result);
+
+#ifdef __cplusplus
+}
+#endif
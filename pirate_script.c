@@ -0,0 +1,161 @@
+#include "pirate_script.h"
+
+/** Starts a line comment; everything from here to the newline is ignored. */
+#define PIRATE_SCRIPT_COMMENT '#'
+
+/** Refills our chunk from the file. */
+static bool pirate_script_refill(PirateScript* script) {
+    size_t read = storage_file_read(script->file, script->chunk, sizeof(script->chunk));
+
+    // A short read is the end of the file; unless the card says otherwise.
+    if((read < sizeof(script->chunk)) && !storage_file_eof(script->file)) {
+        return false;
+    }
+
+    script->chunk_length = read;
+    script->chunk_position = 0;
+    script->end_of_file = (read < sizeof(script->chunk));
+    return true;
+}
+
+/** Reads the next line of the file into our line buffer, without its newline. */
+static PirateScriptStatus pirate_script_read_line(PirateScript* script) {
+    bool found_any = false;
+    bool too_long = false;
+
+    script->line_length = 0;
+
+    while(true) {
+        if(script->chunk_position == script->chunk_length) {
+            if(script->end_of_file) {
+                // A last line without a newline still counts; but if there's nothing left, we're done.
+                if(!found_any) {
+                    return PirateScriptStatusEnd;
+                }
+                break;
+            }
+            if(!pirate_script_refill(script)) {
+                return PirateScriptStatusReadFailed;
+            }
+            continue;
+        }
+
+        const char* start = &script->chunk[script->chunk_position];
+        size_t available = script->chunk_length - script->chunk_position;
+        const char* newline = memchr(start, '\n', available);
+        size_t span = newline ? (size_t)(newline - start) : available;
+
+        // Lines that don't fit are still read through to their end, so we stay in step with the file.
+        if(script->line_length + span > PIRATE_SCRIPT_LINE_MAX) {
+            too_long = true;
+        } else {
+            memcpy(&script->line[script->line_length], start, span);
+            script->line_length += span;
+        }
+
+        script->chunk_position += span;
+        found_any = true;
+
+        if(newline) {
+            script->chunk_position += 1;
+            break;
+        }
+    }
+
+    script->line_number += 1;
+    script->line[script->line_length] = 0;
+
+    return too_long ? PirateScriptStatusLineTooLong : PirateScriptStatusOk;
+}
+
+/** Trims comments and line endings from the current line; returns true if anything's left. */
+static bool pirate_script_trim_line(PirateScript* script) {
+    char* comment = memchr(script->line, PIRATE_SCRIPT_COMMENT, script->line_length);
+    if(comment) {
+        script->line_length = comment - script->line;
+    }
+
+    // Accept files with DOS line endings.
+    if(script->line_length && (script->line[script->line_length - 1] == '\r')) {
+        script->line_length -= 1;
+    }
+    script->line[script->line_length] = 0;
+
+    for(size_t i = 0; i < script->line_length; ++i) {
+        if(!pirate_is_separator(script->line[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Public API.
+ */
+
+bool pirate_script_open(PirateScript* script, File* file, const char* path) {
+    furi_assert(script);
+    furi_assert(file);
+
+    memset(script, 0, sizeof(*script));
+
+    if(!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        storage_file_close(file);
+        return false;
+    }
+
+    script->file = file;
+    return true;
+}
+
+void pirate_script_close(PirateScript* script) {
+    furi_assert(script);
+
+    if(script->file) {
+        storage_file_close(script->file);
+        script->file = NULL;
+    }
+}
+
+PirateScriptStatus pirate_script_next(PirateScript* script, PirateProgram* program) {
+    furi_assert(script);
+
+    if(!script->file) {
+        return PirateScriptStatusOpenFailed;
+    }
+
+    while(true) {
+        PirateScriptStatus status = pirate_script_read_line(script);
+        if(status != PirateScriptStatusOk) {
+            return status;
+        }
+
+        // Blank lines and comments don't run anything.
+        if(!pirate_script_trim_line(script)) {
+            continue;
+        }
+
+        script->error = pirate_compile(script->line, script->line_length, program, &script->error_offset);
+        return (script->error == PirateErrorNone) ? PirateScriptStatusOk : PirateScriptStatusCompileFailed;
+    }
+}
+
+const char* pirate_script_status_description(PirateScriptStatus status) {
+    switch(status) {
+    case PirateScriptStatusOk:
+        return "OK";
+    case PirateScriptStatusEnd:
+        return "Done";
+    case PirateScriptStatusOpenFailed:
+        return "Can't open script";
+    case PirateScriptStatusReadFailed:
+        return "SD card error";
+    case PirateScriptStatusLineTooLong:
+        return "Line too long";
+    case PirateScriptStatusCompileFailed:
+        return "Syntax error";
+    }
+
+    return "Unknown status";
+}
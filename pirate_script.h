@@ -0,0 +1,95 @@
+/**
+ * @file pirate_script.h
+ * Reads .pirate script files off the SD card, one command at a time.
+ *
+ * A script is a plain-text file with one command per line; blank lines are skipped, and
+ * anything after a '#' is a comment. The file is streamed through a small, fixed read buffer,
+ * and only the current line is ever held in RAM; so a script can be as long as the card allows.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <storage/storage.h>
+
+#include "lib/libpirate.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Where we look for scripts, and what they're called. */
+#define PIRATE_SCRIPT_DIRECTORY EXT_PATH("apps_data/pirate")
+#define PIRATE_SCRIPT_EXTENSION ".pirate"
+
+/** How much of the file we read from the card at once. */
+#define PIRATE_SCRIPT_READ_SIZE 128
+
+/** Longest line we accept, not counting its newline. */
+#define PIRATE_SCRIPT_LINE_MAX 255
+
+typedef enum {
+    PirateScriptStatusOk,
+    PirateScriptStatusEnd, //< no more commands; not an error
+    PirateScriptStatusOpenFailed,
+    PirateScriptStatusReadFailed,
+    PirateScriptStatusLineTooLong,
+    PirateScriptStatusCompileFailed,
+} PirateScriptStatus;
+
+/**
+ * State for reading a script. Holds nothing but the open file and its two fixed buffers,
+ * so it's cheap to embed in whatever runs it.
+ */
+typedef struct {
+    File* file;
+
+    /** The chunk of the file we're working through. */
+    char chunk[PIRATE_SCRIPT_READ_SIZE];
+    uint16_t chunk_length;
+    uint16_t chunk_position;
+    bool end_of_file;
+
+    /** The line being assembled; always null terminated. */
+    char line[PIRATE_SCRIPT_LINE_MAX + 1];
+    uint16_t line_length;
+
+    /** Number of the line most recently read, counting from 1. */
+    uint32_t line_number;
+
+    /** Details of the last compile failure. */
+    PirateError error;
+    size_t error_offset;
+} PirateScript;
+
+/**
+ * Opens a script for reading.
+ *
+ * @param script    The script state to populate.
+ * @param file      A closed file to read the script through; the caller keeps ownership, so
+ *                  one file can serve every script run.
+ * @param path      The script file to read.
+ * @return False if the file couldn't be opened; the script needs no closing in that case.
+ */
+bool pirate_script_open(PirateScript* script, File* file, const char* path);
+
+/** Closes a script, but not its file's allocation; safe to call on a script that was never opened. */
+void pirate_script_close(PirateScript* script);
+
+/**
+ * Reads and compiles the script's next command.
+ *
+ * @param script    The script to read from.
+ * @param program   Populated with the compiled command.
+ * @return PirateScriptStatusOk with a program ready to run; PirateScriptStatusEnd once the
+ *         script is exhausted; or the reason we couldn't continue. On failure, the offending
+ *         line is left in script->line_number.
+ */
+PirateScriptStatus pirate_script_next(PirateScript* script, PirateProgram* program);
+
+/** Returns a short, human-readable description of a script status. */
+const char* pirate_script_status_description(PirateScriptStatus status);
+
+#ifdef __cplusplus
+}
+#endif
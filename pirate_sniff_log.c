@@ -0,0 +1,170 @@
+#include "pirate_sniff_log.h"
+#include <furi.h>
+
+struct PirateSniffLog {
+    View* view;
+};
+
+typedef struct {
+    /** Our copy of the sniffer's transcript; the same ring of lines, by the same numbers. */
+    char lines[PIRATE_SNIFFER_LINES][PIRATE_SNIFFER_LINE_LENGTH + 1];
+    uint32_t line_count;
+
+    /** How many lines back from the newest we're looking; zero follows new traffic. */
+    uint32_t scroll;
+
+    PirateSnifferStats stats;
+} PirateSniffLogModel;
+
+static const uint8_t header_height = 10;
+static const uint8_t line_height = 9;
+static const uint8_t visible_lines = 6;
+
+/** Returns the number of transcript lines we still hold. */
+static uint32_t pirate_sniff_log_held(PirateSniffLogModel* model) {
+    return MIN(model->line_count, (uint32_t)PIRATE_SNIFFER_LINES);
+}
+
+/**
+ * @brief Draw the capture counters; overruns are the ones that matter, so they're called out
+ */
+static void pirate_sniff_log_draw_header(Canvas* canvas, PirateSniffLogModel* model) {
+    char text[32];
+
+    snprintf(text, sizeof(text), "%lu txn", (unsigned long)model->stats.transactions);
+    canvas_draw_str(canvas, 0, 8, text);
+
+    if(model->stats.overruns || model->stats.late) {
+        snprintf(
+            text,
+            sizeof(text),
+            "LOST %lu",
+            (unsigned long)(model->stats.overruns + model->stats.late));
+    } else {
+        snprintf(text, sizeof(text), "%lu edges", (unsigned long)model->stats.samples);
+    }
+    canvas_draw_str_aligned(canvas, 127, 8, AlignRight, AlignBottom, text);
+    canvas_draw_line(canvas, 0, header_height - 1, 127, header_height - 1);
+}
+
+/**
+ * @brief Draw callback
+ */
+static void pirate_sniff_log_draw_callback(Canvas* canvas, void* _model) {
+    PirateSniffLogModel* model = _model;
+
+    canvas_clear(canvas);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_set_font(canvas, FontSecondary);
+
+    pirate_sniff_log_draw_header(canvas, model);
+
+    if(!model->line_count) {
+        canvas_draw_str_aligned(canvas, 64, 36, AlignCenter, AlignCenter, "Listening on C0/C1...");
+        return;
+    }
+
+    // Draw from the bottom up, so the newest line we're showing sits at the bottom of the screen.
+    uint32_t held = pirate_sniff_log_held(model);
+    uint32_t last = model->line_count - 1 - model->scroll;
+
+    for(uint8_t row = 0; row < visible_lines && row < held - model->scroll; ++row) {
+        uint32_t number = last - row;
+        uint8_t y = header_height + line_height * (visible_lines - row);
+
+        canvas_draw_str(canvas, 0, y - 1, model->lines[number % PIRATE_SNIFFER_LINES]);
+    }
+}
+
+/**
+ * @brief Input callback
+ */
+static bool pirate_sniff_log_input_callback(InputEvent* event, void* context) {
+    PirateSniffLog* sniff_log = context;
+    furi_assert(sniff_log);
+
+    if(event->type != InputTypeShort && event->type != InputTypeRepeat) {
+        return false;
+    }
+    if(event->key != InputKeyUp && event->key != InputKeyDown) {
+        return false;
+    }
+
+    with_view_model(
+        sniff_log->view, PirateSniffLogModel * model, {
+            uint32_t held = pirate_sniff_log_held(model);
+            uint32_t limit = (held > visible_lines) ? held - visible_lines : 0;
+
+            if(event->key == InputKeyUp && model->scroll < limit) {
+                model->scroll += 1;
+            } else if(event->key == InputKeyDown && model->scroll) {
+                model->scroll -= 1;
+            }
+        }, true);
+
+    return true;
+}
+
+PirateSniffLog* pirate_sniff_log_alloc() {
+    PirateSniffLog* sniff_log = malloc(sizeof(PirateSniffLog));
+    sniff_log->view = view_alloc();
+    view_set_context(sniff_log->view, sniff_log);
+    view_allocate_model(sniff_log->view, ViewModelTypeLocking, sizeof(PirateSniffLogModel));
+    view_set_draw_callback(sniff_log->view, pirate_sniff_log_draw_callback);
+    view_set_input_callback(sniff_log->view, pirate_sniff_log_input_callback);
+
+    pirate_sniff_log_reset(sniff_log);
+    return sniff_log;
+}
+
+void pirate_sniff_log_free(PirateSniffLog* sniff_log) {
+    furi_assert(sniff_log);
+    view_free(sniff_log->view);
+    free(sniff_log);
+}
+
+View* pirate_sniff_log_get_view(PirateSniffLog* sniff_log) {
+    furi_assert(sniff_log);
+    return sniff_log->view;
+}
+
+void pirate_sniff_log_reset(PirateSniffLog* sniff_log) {
+    furi_assert(sniff_log);
+
+    with_view_model(
+        sniff_log->view, PirateSniffLogModel * model, {
+            memset(model, 0, sizeof(*model));
+        }, true);
+}
+
+void pirate_sniff_log_set_line(PirateSniffLog* sniff_log, uint32_t number, const char* text) {
+    furi_assert(sniff_log);
+
+    with_view_model(
+        sniff_log->view, PirateSniffLogModel * model, {
+            char* line = model->lines[number % PIRATE_SNIFFER_LINES];
+
+            snprintf(line, PIRATE_SNIFFER_LINE_LENGTH + 1, "%s", text);
+
+            // If we've scrolled back, keep the same lines on screen as new ones arrive below.
+            if(number >= model->line_count) {
+                if(model->scroll) {
+                    model->scroll += number + 1 - model->line_count;
+                }
+                model->line_count = number + 1;
+            }
+
+            uint32_t held = pirate_sniff_log_held(model);
+            uint32_t limit = (held > visible_lines) ? held - visible_lines : 0;
+            model->scroll = MIN(model->scroll, limit);
+        }, false);
+}
+
+void pirate_sniff_log_set_stats(PirateSniffLog* sniff_log, const PirateSnifferStats* stats) {
+    furi_assert(sniff_log);
+
+    with_view_model(
+        sniff_log->view, PirateSniffLogModel * model, {
+            memcpy(&model->stats, stats, sizeof(*stats));
+        }, true);
+}
@@ -0,0 +1,35 @@
+/**
+ * @file pirate_sniff_log.h
+ * GUI: scrolling transcript of sniffed I2C traffic.
+ */
+
+#pragma once
+
+#include <gui/view.h>
+
+#include "pirate_sniffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct PirateSniffLog PirateSniffLog;
+
+PirateSniffLog* pirate_sniff_log_alloc();
+void pirate_sniff_log_free(PirateSniffLog* sniff_log);
+
+/** Get sniffer view, for adding to a view dispatcher. */
+View* pirate_sniff_log_get_view(PirateSniffLog* sniff_log);
+
+/** Empties the transcript, and returns to following its newest line. */
+void pirate_sniff_log_reset(PirateSniffLog* sniff_log);
+
+/** Sets the text of a transcript line, by its number; lines we no longer have room for scroll off. */
+void pirate_sniff_log_set_line(PirateSniffLog* sniff_log, uint32_t number, const char* text);
+
+/** Updates the capture statistics in the header, and redraws. */
+void pirate_sniff_log_set_stats(PirateSniffLog* sniff_log, const PirateSnifferStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
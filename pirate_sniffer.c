@@ -0,0 +1,298 @@
+#include "pirate_sniffer.h"
+#include "pirate_update.h"
+
+#include "lib/pirate_i2c_decoder.h"
+#include "lib/pirate_ring.h"
+
+#include <furi_hal.h>
+
+#define PIRATE_SNIFFER_STACK_SIZE 1024
+
+/** The external bus' pins; both live on the same port, so one read samples them together. */
+#define PIRATE_SNIFFER_SCL (&gpio_ext_pc0)
+#define PIRATE_SNIFFER_SDA (&gpio_ext_pc1)
+
+typedef enum {
+    PirateSnifferFlagExit = (1 << 0),
+} PirateSnifferFlag;
+
+struct PirateSniffer {
+    FuriThread* thread;
+
+    /** Where we report updates. */
+    PirateUpdateNotifier updates;
+
+    /** Filled by our interrupts; drained by our thread. */
+    PirateRing capture;
+    uint8_t capture_storage[PIRATE_SNIFFER_CAPTURE_SIZE];
+    volatile uint32_t overruns;
+    volatile uint32_t late;
+
+    PirateI2cDecoder decoder;
+    uint32_t transactions;
+
+    /** The transcript; a ring of lines, guarded by our mutex. */
+    FuriMutex* mutex;
+    char lines[PIRATE_SNIFFER_LINES][PIRATE_SNIFFER_LINE_LENGTH + 1];
+    uint8_t line_lengths[PIRATE_SNIFFER_LINES];
+    uint32_t line_count;
+
+    bool running;
+};
+
+/**
+ * Capture; runs in interrupt context, so does as little as it possibly can.
+ */
+
+static inline void pirate_sniffer_capture(PirateSniffer* sniffer, uint8_t edge) {
+    uint32_t levels = PIRATE_SNIFFER_SCL->port->IDR;
+    uint8_t sample = edge;
+
+    if(levels & PIRATE_SNIFFER_SCL->pin) {
+        sample |= PIRATE_I2C_SAMPLE_SCL;
+    } else if(edge) {
+        sniffer->late += 1;
+    }
+    if(levels & PIRATE_SNIFFER_SDA->pin) {
+        sample |= PIRATE_I2C_SAMPLE_SDA;
+    }
+
+    if(!pirate_ring_put(&sniffer->capture, sample)) {
+        sniffer->overruns += 1;
+    }
+}
+
+static void pirate_sniffer_scl_callback(void* context) {
+    pirate_sniffer_capture(context, PIRATE_I2C_SAMPLE_CLOCK);
+}
+
+static void pirate_sniffer_sda_callback(void* context) {
+    pirate_sniffer_capture(context, 0);
+}
+
+/**
+ * Transcript; called from our thread, with the mutex held.
+ */
+
+static void pirate_sniffer_new_line(PirateSniffer* sniffer) {
+    uint32_t line = sniffer->line_count++ % PIRATE_SNIFFER_LINES;
+
+    sniffer->lines[line][0] = 0;
+    sniffer->line_lengths[line] = 0;
+}
+
+/** Adds a token to the transcript, wrapping to a new line if it won't fit on this one. */
+static void pirate_sniffer_append(PirateSniffer* sniffer, const char* token, bool spaced) {
+    size_t length = strlen(token);
+
+    if(!sniffer->line_count) {
+        pirate_sniffer_new_line(sniffer);
+    }
+
+    uint32_t line = (sniffer->line_count - 1) % PIRATE_SNIFFER_LINES;
+    uint8_t used = sniffer->line_lengths[line];
+    spaced = spaced && used;
+
+    if(used + spaced + length > PIRATE_SNIFFER_LINE_LENGTH) {
+        pirate_sniffer_new_line(sniffer);
+        line = (sniffer->line_count - 1) % PIRATE_SNIFFER_LINES;
+        used = 0;
+        spaced = false;
+    }
+
+    if(spaced) {
+        sniffer->lines[line][used++] = ' ';
+    }
+    memcpy(&sniffer->lines[line][used], token, length + 1);
+    sniffer->line_lengths[line] = used + length;
+}
+
+/** Writes out an event in Bus Pirate notation: [A0+ 00+ [A1+ 12+ 34-] */
+static void pirate_sniffer_record(PirateSniffer* sniffer, const PirateI2cEvent* event) {
+    char token[8];
+
+    switch(event->type) {
+    case PirateI2cEventStart:
+        // Each transaction gets a fresh line, so they're easy to pick out.
+        sniffer->transactions += 1;
+        if(sniffer->line_count &&
+           sniffer->line_lengths[(sniffer->line_count - 1) % PIRATE_SNIFFER_LINES]) {
+            pirate_sniffer_new_line(sniffer);
+        }
+        pirate_sniffer_append(sniffer, "[", false);
+        break;
+    case PirateI2cEventRestart:
+        pirate_sniffer_append(sniffer, "[", true);
+        break;
+    case PirateI2cEventStop:
+        pirate_sniffer_append(sniffer, "]", false);
+        break;
+    case PirateI2cEventAddress:
+    case PirateI2cEventData: {
+        uint32_t line = (sniffer->line_count - 1) % PIRATE_SNIFFER_LINES;
+        bool after_start = sniffer->line_lengths[line] &&
+                           (sniffer->lines[line][sniffer->line_lengths[line] - 1] == '[');
+
+        snprintf(token, sizeof(token), "%02X%c", event->value, event->ack ? '+' : '-');
+        pirate_sniffer_append(sniffer, token, !after_start);
+        break;
+    }
+    }
+}
+
+/**
+ * Decoder thread.
+ */
+
+/** Decodes everything captured so far. Returns true iff there was anything. */
+static bool pirate_sniffer_drain(PirateSniffer* sniffer) {
+    const uint8_t* samples;
+    uint32_t count;
+    bool drained = false;
+
+    // Take the lock once per drain rather than per event; the GUI only needs it a few times a second.
+    furi_mutex_acquire(sniffer->mutex, FuriWaitForever);
+
+    while((count = pirate_ring_peek_contiguous(&sniffer->capture, &samples))) {
+        for(uint32_t i = 0; i < count; ++i) {
+            PirateI2cEvent event;
+
+            if(pirate_i2c_decoder_feed(&sniffer->decoder, samples[i], &event)) {
+                pirate_sniffer_record(sniffer, &event);
+            }
+        }
+
+        pirate_ring_consume(&sniffer->capture, count);
+        drained = true;
+    }
+
+    furi_mutex_release(sniffer->mutex);
+    return drained;
+}
+
+static int32_t pirate_sniffer_worker(void* context) {
+    PirateSniffer* sniffer = context;
+    bool dirty = false;
+
+    while(true) {
+        // Samples arrive far too often to signal us for each; so we just check back every tick.
+        uint32_t flags = furi_thread_flags_wait(PirateSnifferFlagExit, FuriFlagWaitAny, 1);
+        if(!(flags & FuriFlagError) && (flags & PirateSnifferFlagExit)) {
+            break;
+        }
+
+        dirty |= pirate_sniffer_drain(sniffer);
+        if(dirty && pirate_update_notifier_request(&sniffer->updates)) {
+            dirty = false;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Public API; called from the GUI thread.
+ */
+
+PirateSniffer* pirate_sniffer_alloc(ViewDispatcher* view_dispatcher, uint32_t update_event) {
+    PirateSniffer* sniffer = malloc(sizeof(PirateSniffer));
+    memset(sniffer, 0, sizeof(*sniffer));
+
+    pirate_update_notifier_init(
+        &sniffer->updates, view_dispatcher, update_event, PIRATE_SNIFFER_UPDATE_INTERVAL);
+    sniffer->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    sniffer->thread = furi_thread_alloc_ex(
+        "PirateSniff", PIRATE_SNIFFER_STACK_SIZE, pirate_sniffer_worker, sniffer);
+
+    pirate_ring_init(&sniffer->capture, sniffer->capture_storage, sizeof(sniffer->capture_storage));
+
+    return sniffer;
+}
+
+void pirate_sniffer_free(PirateSniffer* sniffer) {
+    furi_assert(sniffer);
+
+    pirate_sniffer_stop(sniffer);
+    furi_thread_free(sniffer->thread);
+    furi_mutex_free(sniffer->mutex);
+    free(sniffer);
+}
+
+bool pirate_sniffer_start(PirateSniffer* sniffer) {
+    furi_assert(sniffer);
+
+    if(sniffer->running) {
+        return false;
+    }
+
+    // Neither the edge interrupts nor our thread are up yet; so the ring and transcript are ours.
+    pirate_ring_reset(&sniffer->capture);
+    pirate_i2c_decoder_reset(&sniffer->decoder);
+    sniffer->overruns = 0;
+    sniffer->late = 0;
+    sniffer->transactions = 0;
+    sniffer->line_count = 0;
+    pirate_update_notifier_reset(&sniffer->updates);
+
+    sniffer->running = true;
+    furi_thread_start(sniffer->thread);
+
+    // We only ever listen: no pulls, so we don't load the bus we're watching.
+    furi_hal_gpio_init(PIRATE_SNIFFER_SCL, GpioModeInterruptRise, GpioPullNo, GpioSpeedVeryHigh);
+    furi_hal_gpio_init(PIRATE_SNIFFER_SDA, GpioModeInterruptRiseFall, GpioPullNo, GpioSpeedVeryHigh);
+    furi_hal_gpio_add_int_callback(PIRATE_SNIFFER_SCL, pirate_sniffer_scl_callback, sniffer);
+    furi_hal_gpio_add_int_callback(PIRATE_SNIFFER_SDA, pirate_sniffer_sda_callback, sniffer);
+
+    return true;
+}
+
+void pirate_sniffer_stop(PirateSniffer* sniffer) {
+    furi_assert(sniffer);
+
+    if(!sniffer->running) {
+        return;
+    }
+
+    // Unhook the edges before the thread goes, so nothing's left filling a ring nobody drains.
+    furi_hal_gpio_remove_int_callback(PIRATE_SNIFFER_SCL);
+    furi_hal_gpio_remove_int_callback(PIRATE_SNIFFER_SDA);
+    furi_hal_gpio_init_simple(PIRATE_SNIFFER_SCL, GpioModeAnalog);
+    furi_hal_gpio_init_simple(PIRATE_SNIFFER_SDA, GpioModeAnalog);
+
+    furi_thread_flags_set(furi_thread_get_id(sniffer->thread), PirateSnifferFlagExit);
+    furi_thread_join(sniffer->thread);
+    sniffer->running = false;
+}
+
+void pirate_sniffer_get_stats(PirateSniffer* sniffer, PirateSnifferStats* stats) {
+    furi_assert(sniffer);
+
+    stats->samples = pirate_ring_head(&sniffer->capture);
+    stats->overruns = sniffer->overruns;
+    stats->late = sniffer->late;
+    stats->transactions = sniffer->transactions;
+}
+
+uint32_t pirate_sniffer_read_lines(
+    PirateSniffer* sniffer,
+    uint32_t first,
+    PirateSnifferLineCallback callback,
+    void* context) {
+    furi_assert(sniffer);
+
+    furi_mutex_acquire(sniffer->mutex, FuriWaitForever);
+
+    uint32_t count = sniffer->line_count;
+    if(count > PIRATE_SNIFFER_LINES) {
+        first = MAX(first, count - PIRATE_SNIFFER_LINES);
+    }
+
+    for(uint32_t number = first; number < count; ++number) {
+        callback(context, number, sniffer->lines[number % PIRATE_SNIFFER_LINES]);
+    }
+
+    pirate_update_notifier_ack(&sniffer->updates);
+    furi_mutex_release(sniffer->mutex);
+
+    return count;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file pirate_sniffer.h
+ * Passive I2C sniffer.
+ *
+ * Edges on the external bus' SCL and SDA pins are captured by interrupt: each one samples both
+ * lines into a lock-free ring, and nothing more. A background thread drains the ring through
+ * the I2C decoder, and builds up a transcript of what it saw a line at a time; so the GUI only
+ * ever has to copy the lines that changed.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <gui/view_dispatcher.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of captured samples we can hold; at 400 kHz, about ten milliseconds' worth. */
+#define PIRATE_SNIFFER_CAPTURE_SIZE 8192
+
+/** Number of transcript lines we keep, and the longest each can be. */
+#define PIRATE_SNIFFER_LINES 32
+#define PIRATE_SNIFFER_LINE_LENGTH 24
+
+/** Minimum time between our update events, in milliseconds; the screen can't show more. */
+#define PIRATE_SNIFFER_UPDATE_INTERVAL 100
+
+typedef struct {
+    /** Edges captured, and edges we had to drop because the ring was full. */
+    uint32_t samples;
+    uint32_t overruns;
+
+    /** Clock edges whose interrupt ran so late that SCL had already fallen again. */
+    uint32_t late;
+
+    /** Transactions we've seen begin. */
+    uint32_t transactions;
+} PirateSnifferStats;
+
+typedef struct PirateSniffer PirateSniffer;
+
+/** Called with each transcript line requested; text is null terminated. */
+typedef void (*PirateSnifferLineCallback)(void* context, uint32_t number, const char* text);
+
+/**
+ * @param view_dispatcher   Receives our update events.
+ * @param update_event      Custom event sent when the transcript or stats have changed.
+ */
+PirateSniffer* pirate_sniffer_alloc(ViewDispatcher* view_dispatcher, uint32_t update_event);
+void pirate_sniffer_free(PirateSniffer* sniffer);
+
+/** Starts capturing, with an empty transcript. Returns false if we're already running. */
+bool pirate_sniffer_start(PirateSniffer* sniffer);
+
+/** Stops capturing, and hands the bus' pins back. Safe to call if we're not running. */
+void pirate_sniffer_stop(PirateSniffer* sniffer);
+
+void pirate_sniffer_get_stats(PirateSniffer* sniffer, PirateSnifferStats* stats);
+
+/**
+ * Reads back transcript lines, and allows the next update event to be sent.
+ *
+ * @param sniffer   The sniffer to read from.
+ * @param first     The first line wanted. Lines too old to still be held are skipped.
+ * @param callback  Called with each line, oldest first.
+ * @param context   Passed to the callback.
+ * @return The number of lines ever started. The last of them may still be growing;
+ *         so re-read it next time.
+ */
+uint32_t pirate_sniffer_read_lines(
+    PirateSniffer* sniffer,
+    uint32_t first,
+    PirateSnifferLineCallback callback,
+    void* context);
+
+#ifdef __cplusplus
+}
+#endif
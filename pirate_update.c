@@ -0,0 +1,35 @@
+#include "pirate_update.h"
+
+void pirate_update_notifier_init(
+    PirateUpdateNotifier* notifier,
+    ViewDispatcher* view_dispatcher,
+    uint32_t event,
+    uint32_t interval) {
+    notifier->view_dispatcher = view_dispatcher;
+    notifier->event = event;
+    notifier->interval = interval;
+    pirate_update_notifier_reset(notifier);
+}
+
+void pirate_update_notifier_reset(PirateUpdateNotifier* notifier) {
+    notifier->pending = false;
+    notifier->last_sent = furi_get_tick();
+}
+
+bool pirate_update_notifier_request(PirateUpdateNotifier* notifier) {
+    uint32_t now = furi_get_tick();
+
+    // Only ever keep one update in flight, and no more than the screen can show.
+    if(notifier->pending || (now - notifier->last_sent < furi_ms_to_ticks(notifier->interval))) {
+        return false;
+    }
+
+    notifier->pending = true;
+    notifier->last_sent = now;
+    view_dispatcher_send_custom_event(notifier->view_dispatcher, notifier->event);
+    return true;
+}
+
+void pirate_update_notifier_ack(PirateUpdateNotifier* notifier) {
+    notifier->pending = false;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file pirate_update.h
+ * Rate-limited update events, from a worker thread to the GUI.
+ *
+ * A worker that wants the screen redrawn asks for an update; which sends its custom event, unless
+ * one's still in flight, or the last went out less than an interval ago. Once the GUI has read
+ * whatever it's being told about, it acknowledges the update, and the next may go. So however
+ * busy the worker gets, the view dispatcher's queue never holds more than one of our events.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <gui/view_dispatcher.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    ViewDispatcher* view_dispatcher;
+    uint32_t event;
+    uint32_t interval;
+
+    /** Set by the worker as it sends an event; cleared by the GUI thread, once it's read the news. */
+    volatile bool pending;
+    uint32_t last_sent;
+} PirateUpdateNotifier;
+
+/**
+ * @param view_dispatcher   Receives our update events.
+ * @param event             The custom event we send.
+ * @param interval          Minimum time between events, in milliseconds.
+ */
+void pirate_update_notifier_init(
+    PirateUpdateNotifier* notifier,
+    ViewDispatcher* view_dispatcher,
+    uint32_t event,
+    uint32_t interval);
+
+/** Forgets any update in flight, and starts the interval afresh; only while the worker's stopped. */
+void pirate_update_notifier_reset(PirateUpdateNotifier* notifier);
+
+/**
+ * Sends an update event, if we may; called from the worker thread.
+ *
+ * @return True iff the event was sent; if not, the worker should ask again later.
+ */
+bool pirate_update_notifier_request(PirateUpdateNotifier* notifier);
+
+/** Marks the update in flight as read; called from the GUI thread, once it's read the worker's state. */
+void pirate_update_notifier_ack(PirateUpdateNotifier* notifier);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,88 @@
+#include "scene_bbio.h"
+
+/** Appends a rate in bytes per second; kilobytes, to one decimal place, once it's big enough. */
+static void pirate_scene_bbio_cat_rate(FuriString *text, const char *label, uint32_t rate) {
+    if (rate >= 10000) {
+        furi_string_cat_printf(text, "%s %lu.%lu kB/s\n", label, (unsigned long)(rate / 1000),
+                               (unsigned long)((rate % 1000) / 100));
+    } else {
+        furi_string_cat_printf(text, "%s %lu B/s\n", label, (unsigned long)rate);
+    }
+}
+
+/** Shows what the host's doing with us; rebuilt with each update, which only ever comes a few times a second. */
+static void pirate_scene_bbio_show_stats(PirateApp *app) {
+    PirateBbioStats stats;
+    FuriString *text = furi_string_alloc();
+
+    pirate_bbio_get_stats(app->bbio, &stats);
+
+    if (!stats.connected) {
+        furi_string_cat_str(text, "Waiting for USB host...\n");
+    } else {
+        switch (stats.mode) {
+            case PirateBbioModeTerminal:
+                furi_string_cat_str(text, "Connected; terminal\n");
+                break;
+            case PirateBbioModeBitbang:
+                furi_string_cat_str(text, "Binary mode\n");
+                break;
+            case PirateBbioModeSpi:
+                furi_string_cat_printf(text, "Raw SPI, %lu kHz\n", (unsigned long)stats.spi_speed);
+                break;
+            case PirateBbioModeI2c:
+                furi_string_cat_printf(text, "Raw I2C, %lu kHz\n", (unsigned long)stats.i2c_speed);
+                break;
+        }
+    }
+
+    // Bulk SPI is what this is for, mostly; so show both what the host sees, and what the bus managed.
+    furi_string_cat_printf(text, "SPI %lu B\n", (unsigned long)stats.spi_bytes);
+    pirate_scene_bbio_cat_rate(text, "USB", stats.spi_rate);
+    pirate_scene_bbio_cat_rate(text, "Bus", stats.spi_bus_rate);
+    furi_string_cat_printf(text, "I2C %lu B, %lu errors", (unsigned long)stats.i2c_bytes, (unsigned long)stats.errors);
+
+    widget_reset(app->widget);
+    widget_add_string_element(app->widget, 64, 0, AlignCenter, AlignTop, FontPrimary, "Bus Pirate BBIO");
+    widget_add_string_multiline_element(app->widget, 0, 12, AlignLeft, AlignTop, FontSecondary, furi_string_get_cstr(text));
+
+    furi_string_free(text);
+}
+
+void pirate_scene_bbio_on_enter(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    // USB may already be spoken for; if so, say so, and let the user back out.
+    if (!pirate_bbio_start(app->bbio)) {
+        FURI_LOG_W(TAG, "couldn't take over USB");
+
+        widget_reset(app->widget);
+        widget_add_string_multiline_element(app->widget, 64, 32, AlignCenter, AlignCenter, FontSecondary,
+                                            "USB is busy.\nPress Back.");
+        view_dispatcher_switch_to_view(app->view_dispatcher, PirateWidgetView);
+        return;
+    }
+
+    pirate_scene_bbio_show_stats(app);
+    view_dispatcher_switch_to_view(app->view_dispatcher, PirateWidgetView);
+}
+
+bool pirate_scene_bbio_on_event(void* context, SceneManagerEvent event) {
+    PirateApp *app = (PirateApp*)context;
+    bool consumed = false;
+
+    if (event.type == SceneManagerEventTypeCustom && event.event == PirateBbioUpdated) {
+        pirate_scene_bbio_show_stats(app);
+        consumed = true;
+    }
+
+    // Back leaves the scene; the host loses us as we go.
+    return consumed;
+}
+
+void pirate_scene_bbio_on_exit(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    pirate_bbio_stop(app->bbio);
+    widget_reset(app->widget);
+}
@@ -0,0 +1,46 @@
+#include "scene_bridge.h"
+
+void pirate_scene_bridge_on_enter(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    // The USART or USB may already be spoken for; if so, say so, and let the user back out.
+    if (!pirate_bridge_start(app->bridge)) {
+        FURI_LOG_W(TAG, "couldn't take over the USART and USB");
+
+        widget_reset(app->widget);
+        widget_add_string_multiline_element(app->widget, 64, 32, AlignCenter, AlignCenter, FontSecondary,
+                                            "USART or USB is busy.\nPress Back.");
+        view_dispatcher_switch_to_view(app->view_dispatcher, PirateWidgetView);
+        return;
+    }
+
+    PirateBridgeStats stats;
+    pirate_bridge_get_stats(app->bridge, &stats);
+    pirate_bridge_meter_reset(app->bridge_meter);
+    pirate_bridge_meter_set_stats(app->bridge_meter, &stats);
+    view_dispatcher_switch_to_view(app->view_dispatcher, PirateBridgeView);
+}
+
+bool pirate_scene_bridge_on_event(void* context, SceneManagerEvent event) {
+    PirateApp *app = (PirateApp*)context;
+    bool consumed = false;
+
+    // All we ever copy over is the counters; the data itself never comes near this thread.
+    if (event.type == SceneManagerEventTypeCustom && event.event == PirateBridgeUpdated) {
+        PirateBridgeStats stats;
+
+        pirate_bridge_get_stats(app->bridge, &stats);
+        pirate_bridge_meter_set_stats(app->bridge_meter, &stats);
+        consumed = true;
+    }
+
+    // Back leaves the scene; the bridge comes down as we go.
+    return consumed;
+}
+
+void pirate_scene_bridge_on_exit(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    pirate_bridge_stop(app->bridge);
+    widget_reset(app->widget);
+}
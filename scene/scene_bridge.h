@@ -0,0 +1,10 @@
+#pragma once
+#include "../pirate_app.h"
+
+void pirate_scene_bridge_on_enter(void* app);
+bool pirate_scene_bridge_on_event(void* app, SceneManagerEvent event);
+void pirate_scene_bridge_on_exit(void* app);
+
+typedef enum {
+    PirateBridgeUpdated = 0x600,
+} PirateBridgeEvent;
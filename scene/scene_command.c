@@ -8,10 +8,26 @@ void pirate_scene_command_result_callback(void* context) {
     view_dispatcher_send_custom_event(app->view_dispatcher, PirateInputComplete);
 }
 
-void pirate_scene_command_on_enter(void* context) {
+void pirate_scene_command_queue_callback(void* context) {
     PirateApp *app = (PirateApp*)context;
+    view_dispatcher_send_custom_event(app->view_dispatcher, PirateInputQueued);
+}
+
+bool pirate_scene_command_history_callback(void* context, uint32_t age, char* buffer, size_t size) {
+    PirateApp *app = (PirateApp*)context;
+
+    // Recalled commands come straight off the SD card, one at a time.
+    return pirate_history_get(app->history, age, buffer, size);
+}
+
+void pirate_scene_command_prediction_callback(void* context, const char* text, size_t length, PiratePredictions* predictions) {
+    PirateApp *app = (PirateApp*)context;
+    pirate_predict(&app->predictor, text, length, predictions);
+}
+
+/** Points the editor at our command buffer; it picks up whatever the buffer holds now. */
+static void pirate_scene_command_attach_input(PirateApp *app) {
 
-    // Set up our input buffer.
     // Note that we lie and say our buffer is one shorter than it is; as an extra NULL safety.
     pirate_input_set_result_callback(app->input,
                                      pirate_scene_command_result_callback,
@@ -19,6 +35,63 @@ void pirate_scene_command_on_enter(void* context) {
                                      app,
                                      app->command,
                                      sizeof(app->command) - 1);
+}
+
+/**
+ * Compiles our command, and adds it to the engine's batch; or, having said why, returns false if
+ * it doesn't make sense, or there's no room for it. Commands too long for one program go in as
+ * several, split between transactions, much as a script is run line by line.
+ */
+static bool pirate_scene_command_queue(PirateApp *app) {
+    PirateError error;
+    size_t error_offset = 0;
+
+    // This only lexes and validates the command if we haven't run it recently.
+    const PirateProgram *program = pirate_cache_get(app->programs, app->command, &error, &error_offset);
+
+    if (program != NULL) {
+        error = PirateErrorNone;
+        if (pirate_engine_queue(app->engine, program)) {
+            return true;
+        }
+    } else if ((error == PirateErrorProgramTooLong) &&
+               pirate_engine_queue_long(app->engine, app->command, &error, &error_offset)) {
+        return true;
+    }
+
+    if (error != PirateErrorNone) {
+        FURI_LOG_W(TAG, "can't run command: %s (at column %u)",
+                   pirate_error_description(error), (unsigned)error_offset);
+    } else {
+        FURI_LOG_W(TAG, "engine busy, or batch full; not running command");
+    }
+    return false;
+}
+
+void pirate_scene_command_on_enter(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    // Set up our input buffer.
+    pirate_scene_command_attach_input(app);
+    pirate_input_set_history_callback(app->input, pirate_scene_command_history_callback, app);
+    pirate_input_set_prediction_callback(app->input, pirate_scene_command_prediction_callback, app);
+
+    // Holding send queues the command instead, to go out with the next one sent.
+    pirate_input_set_queue_callback(app->input, pirate_scene_command_queue_callback, app);
+    pirate_input_set_queued(app->input, pirate_engine_queue_length(app->engine));
+
+    // The same editor serves every bus; each gets its own keyboard. 1-Wire has no clock to set,
+    // so its keyboard has no '@'.
+    if (app->operation == SPIOperation) {
+        pirate_input_set_layout(app->input, PirateInputLayoutSpi);
+        pirate_engine_set_bus(app->engine, PirateEngineBusSpi);
+    } else if (app->operation == OneWireOperation) {
+        pirate_input_set_layout(app->input, PirateInputLayoutOneWire);
+        pirate_engine_set_bus(app->engine, PirateEngineBusOneWire);
+    } else {
+        pirate_input_set_layout(app->input, PirateInputLayoutI2c);
+        pirate_engine_set_bus(app->engine, PirateEngineBusI2c);
+    }
 
     view_dispatcher_switch_to_view(app->view_dispatcher, PirateInputView);
 }
@@ -32,20 +105,72 @@ bool pirate_scene_command_on_event(void* context, SceneManagerEvent event) {
         // If the user hit the back button, move back to the menu.
         // Do not clear the command; in case the user accidentally hit back.
         case SceneManagerEventTypeBack:
-            scene_manager_next_scene(app->scene_manager, PirateSceneStart);
+
+            // If a command is still running, the first press just cancels it; and if some are
+            // queued, the first press just forgets them.
+            if (pirate_engine_is_busy(app->engine)) {
+                pirate_engine_abort(app->engine);
+            } else if (pirate_engine_queue_length(app->engine)) {
+                pirate_engine_clear_queue(app->engine);
+                pirate_input_set_queued(app->input, 0);
+            } else {
+                scene_manager_next_scene(app->scene_manager, PirateSceneStart);
+            }
+
             consumed = true;
             break;
 
             // Handle custom events, which are our main "a menu item was selected" event.
         case SceneManagerEventTypeCustom:
             switch(event.event) {
-                case PirateInputComplete:
+                case PirateInputComplete: {
+
+                    // Hand the command off to the engine, which runs it on its own thread;
+                    // we'll hear back via PirateCommandExecuted. If it's still busy with the last
+                    // command, just drop this one; and if the command doesn't make sense, leave
+                    // the user in the editor so they can fix it. With commands queued, this one
+                    // goes last in their batch; and the whole batch goes to the bus at once.
+                    bool started = pirate_scene_command_queue(app) && pirate_engine_run_queue(app->engine);
+
+                    if (started) {
+                        pirate_input_set_queued(app->input, 0);
 
-                    // FIXME: actually run the command and show the result
+                        if (!pirate_history_append(app->history, app->command)) {
+                            FURI_LOG_W(TAG, "couldn't add command to history");
+                        }
+                        pirate_predict_learn(&app->predictor, app->command);
+                    }
 
-                    scene_manager_next_scene(app->scene_manager, PirateSceneStart);
                     consumed = true;
                     break;
+                }
+
+                case PirateInputQueued: {
+                    if (!pirate_scene_command_queue(app)) {
+                        consumed = true;
+                        break;
+                    }
+
+                    if (!pirate_history_append(app->history, app->command)) {
+                        FURI_LOG_W(TAG, "couldn't add command to history");
+                    }
+                    pirate_predict_learn(&app->predictor, app->command);
+
+                    // Start the next command afresh; Up brings back the one just queued.
+                    pirate_reset_command(app);
+                    pirate_scene_command_attach_input(app);
+                    pirate_input_set_queued(app->input, pirate_engine_queue_length(app->engine));
+
+                    consumed = true;
+                    break;
+                }
+
+                case PirateCommandExecuted: {
+                    scene_manager_next_scene(app->scene_manager, PirateSceneResult);
+
+                    consumed = true;
+                    break;
+                }
             }
 
     default:
@@ -59,6 +184,12 @@ bool pirate_scene_command_on_event(void* context, SceneManagerEvent event) {
 
 void pirate_scene_command_on_exit(void* context) {
     PirateApp *app = (PirateApp*)context;
-    UNUSED(app);
+    pirate_input_set_history_callback(app->input, NULL, NULL);
+    pirate_input_set_prediction_callback(app->input, NULL, NULL);
+    pirate_input_set_queue_callback(app->input, NULL, NULL);
+
+    // Queued commands were written for this bus; they mustn't follow us anywhere else.
+    pirate_engine_clear_queue(app->engine);
+    pirate_input_set_queued(app->input, 0);
 }
 
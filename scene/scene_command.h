@@ -7,6 +7,14 @@ void pirate_scene_command_on_exit(void* app);
 
 typedef enum {
     PirateInputComplete,
+    PirateInputQueued,
+
+    // Posted by the execution engine. Kept well clear of the menu's event numbers,
+    // as it can arrive after the user has left this scene.
+    PirateCommandExecuted = 0x100,
+
+    // Posted by the command input once a frame's drawn; the input view handles it itself.
+    PirateInputFrameDrawn,
 } PirateInputEvent;
 
 
@@ -0,0 +1,135 @@
+#include "scene_eeprom.h"
+
+typedef enum {
+    PirateEepromStateSelecting,
+    PirateEepromStateDumping,
+    PirateEepromStateDone,
+} PirateEepromState;
+
+static void pirate_scene_eeprom_submenu_callback(void* context, uint32_t index) {
+    PirateApp* app = (PirateApp*)context;
+    scene_manager_handle_custom_event(app->scene_manager, index);
+}
+
+static void pirate_scene_eeprom_show_parts(PirateApp *app) {
+    submenu_reset(app->submenu);
+    submenu_set_header(app->submenu, "EEPROM at 0xA0");
+
+    for (size_t i = 0; i < pirate_eeprom_part_count; ++i) {
+        submenu_add_item(app->submenu, pirate_eeprom_parts[i].name, i, pirate_scene_eeprom_submenu_callback, app);
+    }
+
+    scene_manager_set_scene_state(app->scene_manager, PirateSceneEeprom, PirateEepromStateSelecting);
+    view_dispatcher_switch_to_view(app->view_dispatcher, PirateSubmenuView);
+}
+
+/** Replaces the widget's contents with the given text. */
+static void pirate_scene_eeprom_show_text(PirateApp *app, FuriString *text) {
+    widget_reset(app->widget);
+    widget_add_string_multiline_element(app->widget, 64, 32, AlignCenter, AlignCenter, FontSecondary, furi_string_get_cstr(text));
+}
+
+static void pirate_scene_eeprom_show_progress(PirateApp *app) {
+    FuriString *text = furi_string_alloc();
+
+    furi_string_printf(text, "Dumping %s...\n%lu / %lu bytes",
+                       app->eeprom_part->name,
+                       (unsigned long)pirate_eeprom_dump_get_progress(app->eeprom),
+                       (unsigned long)app->eeprom_part->size);
+    pirate_scene_eeprom_show_text(app, text);
+
+    furi_string_free(text);
+}
+
+static void pirate_scene_eeprom_show_result(PirateApp *app) {
+    PirateEepromResult result;
+    FuriString *text = furi_string_alloc();
+
+    pirate_eeprom_dump_get_result(app->eeprom, &result);
+    furi_string_printf(text, "%s: %lu bytes\nin %lu ms (%lu B/s)",
+                       pirate_eeprom_status_description(result.status),
+                       (unsigned long)result.bytes_written,
+                       (unsigned long)result.duration_ms,
+                       (unsigned long)((uint64_t)result.bytes_written * 1000 / MAX(result.duration_ms, 1U)));
+    if (result.status == PirateEepromStatusOk) {
+        furi_string_cat_printf(text, "\nSaved as %s.bin", app->eeprom_part->name);
+    }
+    pirate_scene_eeprom_show_text(app, text);
+
+    furi_string_free(text);
+}
+
+static void pirate_scene_eeprom_start(PirateApp *app, const PirateEepromPart *part) {
+    FuriString *path = furi_string_alloc_printf(APP_DATA_PATH("%s.bin"), part->name);
+
+    app->eeprom_part = part;
+    if (pirate_eeprom_dump_start(app->eeprom, part, PIRATE_EEPROM_DEFAULT_ADDRESS, furi_string_get_cstr(path))) {
+        scene_manager_set_scene_state(app->scene_manager, PirateSceneEeprom, PirateEepromStateDumping);
+        pirate_scene_eeprom_show_progress(app);
+        view_dispatcher_switch_to_view(app->view_dispatcher, PirateWidgetView);
+    }
+
+    furi_string_free(path);
+}
+
+void pirate_scene_eeprom_on_enter(void* context) {
+    PirateApp *app = (PirateApp*)context;
+    pirate_scene_eeprom_show_parts(app);
+}
+
+bool pirate_scene_eeprom_on_event(void* context, SceneManagerEvent event) {
+    PirateApp *app = (PirateApp*)context;
+    uint32_t state = scene_manager_get_scene_state(app->scene_manager, PirateSceneEeprom);
+    bool consumed = false;
+
+    switch(event.type) {
+
+        // Back cancels a running dump, then returns to the part list, then to the menu.
+        case SceneManagerEventTypeBack:
+            if (state == PirateEepromStateDumping) {
+                pirate_eeprom_dump_abort(app->eeprom);
+                consumed = true;
+            } else if (state == PirateEepromStateDone) {
+                pirate_scene_eeprom_show_parts(app);
+                consumed = true;
+            }
+            break;
+
+        case SceneManagerEventTypeCustom:
+            switch(event.event) {
+                case PirateEepromDumpProgress:
+                    if (state == PirateEepromStateDumping) {
+                        pirate_scene_eeprom_show_progress(app);
+                    }
+                    consumed = true;
+                    break;
+
+                case PirateEepromDumpComplete:
+                    scene_manager_set_scene_state(app->scene_manager, PirateSceneEeprom, PirateEepromStateDone);
+                    pirate_scene_eeprom_show_result(app);
+                    consumed = true;
+                    break;
+
+                default:
+                    if ((state == PirateEepromStateSelecting) && (event.event < pirate_eeprom_part_count)) {
+                        pirate_scene_eeprom_start(app, &pirate_eeprom_parts[event.event]);
+                        consumed = true;
+                    }
+                    break;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return consumed;
+}
+
+void pirate_scene_eeprom_on_exit(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    submenu_reset(app->submenu);
+    widget_reset(app->widget);
+}
+
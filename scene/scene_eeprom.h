@@ -0,0 +1,14 @@
+#pragma once
+#include "../pirate_app.h"
+
+void pirate_scene_eeprom_on_enter(void* app);
+bool pirate_scene_eeprom_on_event(void* app, SceneManagerEvent event);
+void pirate_scene_eeprom_on_exit(void* app);
+
+// Part selections are sent as their index into pirate_eeprom_parts;
+// the dumper's events are kept clear of those, and of the command engine's.
+typedef enum {
+    PirateEepromDumpProgress = 0x200,
+    PirateEepromDumpComplete,
+} PirateEepromEvent;
+
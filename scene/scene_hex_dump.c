@@ -0,0 +1,24 @@
+#include "scene_hex_dump.h"
+
+void pirate_scene_hex_dump_on_enter(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    // The engine's finished with the store by the time we're here, so it'll hold still.
+    pirate_hex_dump_set_result(app->hex_dump, app->results);
+    view_dispatcher_switch_to_view(app->view_dispatcher, PirateHexDumpView);
+}
+
+bool pirate_scene_hex_dump_on_event(void* context, SceneManagerEvent event) {
+    UNUSED(context);
+    UNUSED(event);
+
+    // Back takes us to the result summary, which the scene manager handles for us.
+    return false;
+}
+
+void pirate_scene_hex_dump_on_exit(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    // Let go of the store, as the next command will change it under us.
+    pirate_hex_dump_set_result(app->hex_dump, NULL);
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include "../pirate_app.h"
+
+void pirate_scene_hex_dump_on_enter(void* app);
+bool pirate_scene_hex_dump_on_event(void* app, SceneManagerEvent event);
+void pirate_scene_hex_dump_on_exit(void* app);
@@ -0,0 +1,60 @@
+#include "scene_memory.h"
+
+static void pirate_scene_memory_refresh_callback(GuiButtonType button, InputType type, void* context) {
+    PirateApp *app = (PirateApp*)context;
+    UNUSED(button);
+
+    if (type == InputTypeShort) {
+        view_dispatcher_send_custom_event(app->view_dispatcher, PirateMemoryRefreshRequested);
+    }
+}
+
+static void pirate_scene_memory_show(PirateApp *app) {
+    size_t capacity = pirate_arena_capacity(&app->arena);
+    size_t high_water = pirate_arena_high_water(&app->arena);
+    char text[192];
+
+    // The arena's peak includes whatever runs have borrowed from it; what's left is our headroom.
+    // Stacks are reported the same way: the least they've ever had spare.
+    snprintf(text, sizeof(text),
+             "Arena: %lu of %lu B in use\n"
+             "Peak %lu B; %lu B spare\n"
+             "Stack spare, at worst:\n"
+             "App %lu B, engine %lu B\n"
+             "Spool %lu B",
+             (unsigned long)pirate_arena_used(&app->arena),
+             (unsigned long)capacity,
+             (unsigned long)high_water,
+             (unsigned long)(capacity - high_water),
+             (unsigned long)furi_thread_get_stack_space(furi_thread_get_current_id()),
+             (unsigned long)pirate_engine_get_stack_headroom(app->engine),
+             (unsigned long)pirate_result_store_get_stack_headroom(app->results));
+
+    widget_reset(app->widget);
+    widget_add_text_scroll_element(app->widget, 0, 0, 128, 51, text);
+    widget_add_button_element(app->widget, GuiButtonTypeRight, "Refresh", pirate_scene_memory_refresh_callback, app);
+
+    view_dispatcher_switch_to_view(app->view_dispatcher, PirateWidgetView);
+}
+
+void pirate_scene_memory_on_enter(void* context) {
+    PirateApp *app = (PirateApp*)context;
+    pirate_scene_memory_show(app);
+}
+
+bool pirate_scene_memory_on_event(void* context, SceneManagerEvent event) {
+    PirateApp *app = (PirateApp*)context;
+
+    if ((event.type == SceneManagerEventTypeCustom) && (event.event == PirateMemoryRefreshRequested)) {
+        pirate_scene_memory_show(app);
+        return true;
+    }
+
+    // Otherwise, let the scene manager take us back to the menu.
+    return false;
+}
+
+void pirate_scene_memory_on_exit(void* context) {
+    PirateApp *app = (PirateApp*)context;
+    widget_reset(app->widget);
+}
@@ -0,0 +1,89 @@
+#include "scene_onewire.h"
+
+static void pirate_scene_onewire_button_callback(GuiButtonType button, InputType type, void* context) {
+    PirateApp* app = (PirateApp*)context;
+
+    if (button == GuiButtonTypeCenter && type == InputTypeShort) {
+        view_dispatcher_send_custom_event(app->view_dispatcher, PirateOneWireSearchRequested);
+    }
+}
+
+static void pirate_scene_onewire_show_searching(PirateApp *app) {
+    widget_reset(app->widget);
+    widget_add_string_multiline_element(app->widget, 64, 32, AlignCenter, AlignCenter, FontSecondary,
+                                        "Searching 1-Wire bus...");
+}
+
+/** Lists what the search found, one ROM code a line, as family code and serial number. */
+static void pirate_scene_onewire_show_result(PirateApp *app) {
+    PirateOneWireScanResult result;
+    FuriString *text = furi_string_alloc();
+
+    pirate_onewire_scanner_get_result(app->onewire_scanner, &result);
+
+    if (result.bus_error) {
+        furi_string_cat_str(text, "Bus error; is the line\nstuck low?\n");
+    } else if (result.empty) {
+        furi_string_cat_str(text, "No devices answered.\nCheck the pull-up.\n");
+    }
+
+    if (result.count) {
+        furi_string_cat_printf(text, "%u device%s in %lu ms%s\n", (unsigned)result.count, (result.count == 1) ? "" : "s",
+                               (unsigned long)(result.search_us / 1000), result.truncated ? "+" : "");
+    }
+
+    for (size_t i = 0; i < result.count; ++i) {
+        const uint8_t *rom = result.roms[i];
+        furi_string_cat_printf(text, "%02X-%02X%02X%02X%02X%02X%02X\n",
+                               rom[0], rom[6], rom[5], rom[4], rom[3], rom[2], rom[1]);
+    }
+
+    widget_reset(app->widget);
+    widget_add_text_scroll_element(app->widget, 0, 0, 128, 50, furi_string_get_cstr(text));
+    widget_add_button_element(app->widget, GuiButtonTypeCenter, "Search", pirate_scene_onewire_button_callback, app);
+
+    furi_string_free(text);
+}
+
+static void pirate_scene_onewire_start(PirateApp *app) {
+    if (pirate_onewire_scanner_start(app->onewire_scanner)) {
+        pirate_scene_onewire_show_searching(app);
+    }
+}
+
+void pirate_scene_onewire_on_enter(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    view_dispatcher_switch_to_view(app->view_dispatcher, PirateWidgetView);
+    pirate_scene_onewire_start(app);
+}
+
+bool pirate_scene_onewire_on_event(void* context, SceneManagerEvent event) {
+    PirateApp *app = (PirateApp*)context;
+    bool consumed = false;
+
+    if (event.type == SceneManagerEventTypeCustom) {
+        switch(event.event) {
+            case PirateOneWireSearchRequested:
+                pirate_scene_onewire_start(app);
+                consumed = true;
+                break;
+
+            case PirateOneWireSearchComplete:
+                pirate_scene_onewire_show_result(app);
+                consumed = true;
+                break;
+        }
+    }
+
+    // Back leaves straight away; on_exit cuts any search short.
+    return consumed;
+}
+
+void pirate_scene_onewire_on_exit(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    // The command editor may want the bus next; so the search has to be off it before we go.
+    pirate_onewire_scanner_stop(app->onewire_scanner);
+    widget_reset(app->widget);
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "../pirate_app.h"
+
+void pirate_scene_onewire_on_enter(void* app);
+bool pirate_scene_onewire_on_event(void* app, SceneManagerEvent event);
+void pirate_scene_onewire_on_exit(void* app);
+
+typedef enum {
+    PirateOneWireSearchRequested = 0x800,
+    PirateOneWireSearchComplete,
+} PirateOneWireEvent;
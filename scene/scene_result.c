@@ -0,0 +1,185 @@
+#include "scene_result.h"
+
+/** Smallest transfer worth quoting a throughput for; below this, per-transaction overhead dominates. */
+#define PIRATE_RESULT_THROUGHPUT_BYTES 64
+
+typedef enum {
+    PirateResultStateShown,
+    PirateResultStateExported,
+} PirateResultState;
+
+/** Appends a cycle count to the text, as microseconds to one decimal place. */
+static void pirate_scene_result_cat_us(FuriString *text, uint32_t cycles, uint32_t cycles_per_us) {
+    uint64_t tenths = (uint64_t)cycles * 10 / MAX(cycles_per_us, 1U);
+    furi_string_cat_printf(text, "%lu.%lu", (unsigned long)(tenths / 10), (unsigned long)(tenths % 10));
+}
+
+static void pirate_scene_result_export_callback(GuiButtonType button, InputType type, void* context) {
+    PirateApp *app = (PirateApp*)context;
+    UNUSED(button);
+
+    if (type == InputTypeShort) {
+        view_dispatcher_send_custom_event(app->view_dispatcher, PirateResultExportRequested);
+    }
+}
+
+static void pirate_scene_result_dump_callback(GuiButtonType button, InputType type, void* context) {
+    PirateApp *app = (PirateApp*)context;
+    UNUSED(button);
+
+    if (type == InputTypeShort) {
+        view_dispatcher_send_custom_event(app->view_dispatcher, PirateResultDumpRequested);
+    }
+}
+
+static bool pirate_scene_result_export(PirateApp *app) {
+    PirateEngineResult result;
+    pirate_engine_get_result(app->engine, &result);
+
+    const char *command = result.script ? furi_string_get_cstr(app->script_path) : app->command;
+    if (!pirate_engine_result_export(&result, command)) {
+        FURI_LOG_W(TAG, "couldn't export latency statistics");
+        return false;
+    }
+
+    return true;
+}
+
+static void pirate_scene_result_show(PirateApp *app) {
+    uint32_t state = scene_manager_get_scene_state(app->scene_manager, PirateSceneResult);
+    PirateEngineResult result;
+
+    pirate_engine_get_result(app->engine, &result);
+
+    // Summarize the run...
+    FuriString *text = furi_string_alloc();
+
+    // ... including, for scripts, how far we got.
+    if (result.script) {
+        if (result.script_status == PirateScriptStatusEnd) {
+            furi_string_cat_printf(text, "Script: %lu commands\n", (unsigned long)result.commands);
+        } else if (result.script_status == PirateScriptStatusOpenFailed) {
+            furi_string_cat_printf(text, "%s\n", pirate_script_status_description(result.script_status));
+        } else if (result.script_status == PirateScriptStatusCompileFailed) {
+            furi_string_cat_printf(text, "Line %lu: %s\n",
+                                   (unsigned long)result.script_line,
+                                   pirate_error_description(result.compile_error));
+        } else if (result.script_status == PirateScriptStatusOk) {
+            // The script was fine; the bus stopped it.
+            furi_string_cat_printf(text, "Stopped at line %lu\n", (unsigned long)result.script_line);
+        } else {
+            furi_string_cat_printf(text, "Line %lu: %s\n",
+                                   (unsigned long)result.script_line,
+                                   pirate_script_status_description(result.script_status));
+        }
+    }
+
+    // ... or, for batches, how many of the commands got to run.
+    if (result.batch_length > 1) {
+        furi_string_cat_printf(text, "Batch: %lu of %lu commands\n",
+                               (unsigned long)result.commands,
+                               (unsigned long)result.batch_length);
+    }
+
+    furi_string_cat_printf(text, "%s: %lu bytes in %lu ms\n",
+                       pirate_exec_status_description(result.status),
+                       (unsigned long)result.bytes_read,
+                       (unsigned long)result.duration_ms);
+
+    // Looping commands are typically stress tests; so report how fast we went.
+    if (result.transactions > 1) {
+        furi_string_cat_printf(text, "%lu transactions, %lu/s\n",
+                               (unsigned long)result.transactions,
+                               (unsigned long)pirate_engine_result_transactions_per_second(&result));
+    }
+
+    // Bulk transfers -- SPI flash, mostly -- are judged on throughput; so show what the bus managed.
+    if (result.bytes_written + result.bytes_read >= PIRATE_RESULT_THROUGHPUT_BYTES) {
+        uint32_t rate = pirate_engine_result_bytes_per_second(&result);
+
+        furi_string_cat_printf(text, "%lu B out, ", (unsigned long)result.bytes_written);
+        if (rate >= 10000) {
+            furi_string_cat_printf(text, "%lu kB/s\n", (unsigned long)(rate / 1000));
+        } else {
+            furi_string_cat_printf(text, "%lu B/s\n", (unsigned long)rate);
+        }
+    }
+
+    // Show where the time went: in the device's transactions, or between them.
+    if (result.latency.count) {
+        const char *labels[] = {"Latency us: ", "-", ", avg ", "\np50 ", "  p90 ", "  p99 "};
+        const uint32_t values[] = {result.latency.min, result.latency.max, result.latency.mean,
+                                   result.latency.p50, result.latency.p90, result.latency.p99};
+
+        for (size_t i = 0; i < COUNT_OF(values); ++i) {
+            furi_string_cat_str(text, labels[i]);
+            pirate_scene_result_cat_us(text, values[i], result.cycles_per_us);
+        }
+        furi_string_cat_str(text, "\n");
+    }
+    if (result.gaps.count) {
+        furi_string_cat_str(text, "Between: avg ");
+        pirate_scene_result_cat_us(text, result.gaps.mean, result.cycles_per_us);
+        furi_string_cat_str(text, ", max ");
+        pirate_scene_result_cat_us(text, result.gaps.max, result.cycles_per_us);
+        furi_string_cat_str(text, "\n");
+    }
+    if (state == PirateResultStateExported) {
+        furi_string_cat_str(text, "Latency saved to SD.\n");
+    }
+
+    // Whatever we read gets a view of its own, which only ever formats what's on screen.
+    if (pirate_result_store_is_spooled(app->results)) {
+        furi_string_cat_printf(text, "Full result saved to SD.\n");
+    }
+
+    widget_reset(app->widget);
+
+    // Leave room for the data and export buttons, if there's anything to see or export.
+    bool data = (pirate_result_store_length(app->results) != 0);
+    bool exportable = (result.latency.count && (state != PirateResultStateExported));
+
+    widget_add_text_scroll_element(app->widget, 0, 0, 128, (data || exportable) ? 51 : 64, furi_string_get_cstr(text));
+    if (data) {
+        widget_add_button_element(app->widget, GuiButtonTypeLeft, "Data", pirate_scene_result_dump_callback, app);
+    }
+    if (exportable) {
+        widget_add_button_element(app->widget, GuiButtonTypeRight, "Save", pirate_scene_result_export_callback, app);
+    }
+    furi_string_free(text);
+
+    view_dispatcher_switch_to_view(app->view_dispatcher, PirateWidgetView);
+}
+
+void pirate_scene_result_on_enter(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    scene_manager_set_scene_state(app->scene_manager, PirateSceneResult, PirateResultStateShown);
+    pirate_scene_result_show(app);
+}
+
+bool pirate_scene_result_on_event(void* context, SceneManagerEvent event) {
+    PirateApp *app = (PirateApp*)context;
+
+    if ((event.type == SceneManagerEventTypeCustom) && (event.event == PirateResultDumpRequested)) {
+        scene_manager_next_scene(app->scene_manager, PirateSceneHexDump);
+        return true;
+    }
+
+    if ((event.type == SceneManagerEventTypeCustom) && (event.event == PirateResultExportRequested)) {
+        if (pirate_scene_result_export(app)) {
+            scene_manager_set_scene_state(app->scene_manager, PirateSceneResult, PirateResultStateExported);
+            pirate_scene_result_show(app);
+        }
+        return true;
+    }
+
+    // Otherwise, let the scene manager take us back to the command editor.
+    return false;
+}
+
+void pirate_scene_result_on_exit(void* context) {
+    PirateApp *app = (PirateApp*)context;
+    widget_reset(app->widget);
+}
+
@@ -0,0 +1,13 @@
+#pragma once
+#include "../pirate_app.h"
+
+void pirate_scene_result_on_enter(void* app);
+bool pirate_scene_result_on_event(void* app, SceneManagerEvent event);
+void pirate_scene_result_on_exit(void* app);
+
+
+// Kept clear of the menu's, and every other scene's, event numbers.
+typedef enum {
+    PirateResultExportRequested = 0x400,
+    PirateResultDumpRequested,
+} PirateResultEvent;
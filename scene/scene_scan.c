@@ -0,0 +1,53 @@
+#include "scene_scan.h"
+
+static void pirate_scene_scan_rescan_callback(void* context) {
+    PirateApp* app = (PirateApp*)context;
+    view_dispatcher_send_custom_event(app->view_dispatcher, PirateScanRequested);
+}
+
+static void pirate_scene_scan_start(PirateApp *app) {
+    if (pirate_scanner_start(app->scanner)) {
+        pirate_scan_grid_set_scanning(app->scan_grid);
+    }
+}
+
+void pirate_scene_scan_on_enter(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    pirate_scan_grid_set_rescan_callback(app->scan_grid, pirate_scene_scan_rescan_callback, app);
+    view_dispatcher_switch_to_view(app->view_dispatcher, PirateScanView);
+
+    pirate_scene_scan_start(app);
+}
+
+bool pirate_scene_scan_on_event(void* context, SceneManagerEvent event) {
+    PirateApp *app = (PirateApp*)context;
+    bool consumed = false;
+
+    if (event.type == SceneManagerEventTypeCustom) {
+        switch(event.event) {
+            case PirateScanRequested:
+                pirate_scene_scan_start(app);
+                consumed = true;
+                break;
+
+            case PirateScanComplete: {
+                PirateScanResult result;
+
+                pirate_scanner_get_result(app->scanner, &result);
+                pirate_scan_grid_set_result(app->scan_grid, &result);
+                consumed = true;
+                break;
+            }
+        }
+    }
+
+    // A sweep takes a few milliseconds at most, so there's nothing to cancel on Back;
+    // let the scene manager take us back to the menu.
+    return consumed;
+}
+
+void pirate_scene_scan_on_exit(void* context) {
+    PirateApp *app = (PirateApp*)context;
+    pirate_scan_grid_set_rescan_callback(app->scan_grid, NULL, NULL);
+}
@@ -0,0 +1,83 @@
+#include "scene_script.h"
+#include "scene_command.h"
+
+#include <assets_icons.h>
+#include <dialogs/dialogs.h>
+
+/** Asks the user for a script; returns false if they didn't pick one. */
+static bool pirate_scene_script_select(PirateApp *app) {
+    DialogsFileBrowserOptions options;
+
+    dialog_file_browser_set_basic_options(&options, PIRATE_SCRIPT_EXTENSION, &I_file_10px);
+    options.base_path = PIRATE_SCRIPT_DIRECTORY;
+
+    // We start from the last script we ran, so running it again is just a press of OK.
+    return dialog_file_browser_show(app->dialogs, app->script_path, app->script_path, &options);
+}
+
+static void pirate_scene_script_show_progress(PirateApp *app) {
+    const char *path = furi_string_get_cstr(app->script_path);
+    const char *name = strrchr(path, '/');
+
+    FuriString *text = furi_string_alloc_printf("Running %s...\nBack to abort", name ? name + 1 : path);
+
+    widget_reset(app->widget);
+    widget_add_string_multiline_element(app->widget, 64, 32, AlignCenter, AlignCenter, FontSecondary, furi_string_get_cstr(text));
+    view_dispatcher_switch_to_view(app->view_dispatcher, PirateWidgetView);
+
+    furi_string_free(text);
+}
+
+void pirate_scene_script_on_enter(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    // If the user backs out of the browser, so do we.
+    if (!pirate_scene_script_select(app)) {
+        scene_manager_previous_scene(app->scene_manager);
+        return;
+    }
+
+    // Scripts are written for I2C. The engine streams them off the card itself; we'll hear back
+    // once, when it's done.
+    pirate_engine_set_bus(app->engine, PirateEngineBusI2c);
+    if (!pirate_engine_run_script(app->engine, furi_string_get_cstr(app->script_path))) {
+        FURI_LOG_W(TAG, "engine busy, or script path too long; not running script");
+        scene_manager_previous_scene(app->scene_manager);
+        return;
+    }
+
+    pirate_scene_script_show_progress(app);
+}
+
+bool pirate_scene_script_on_event(void* context, SceneManagerEvent event) {
+    PirateApp *app = (PirateApp*)context;
+    bool consumed = false;
+
+    switch(event.type) {
+
+        // Back aborts the script; we'll move on to its result as soon as the engine stops.
+        case SceneManagerEventTypeBack:
+            if (pirate_engine_is_busy(app->engine)) {
+                pirate_engine_abort(app->engine);
+                consumed = true;
+            }
+            break;
+
+        case SceneManagerEventTypeCustom:
+            if (event.event == PirateCommandExecuted) {
+                scene_manager_next_scene(app->scene_manager, PirateSceneResult);
+                consumed = true;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return consumed;
+}
+
+void pirate_scene_script_on_exit(void* context) {
+    PirateApp *app = (PirateApp*)context;
+    widget_reset(app->widget);
+}
@@ -0,0 +1,50 @@
+#include "scene_sniff.h"
+
+static void pirate_scene_sniff_line_callback(void* context, uint32_t number, const char* text) {
+    PirateApp* app = (PirateApp*)context;
+    pirate_sniff_log_set_line(app->sniff_log, number, text);
+}
+
+/** Copies over whatever's changed in the transcript since we last looked. */
+static void pirate_scene_sniff_update(PirateApp *app) {
+    PirateSnifferStats stats;
+
+    // Our scene state is the first line that might have changed: the one that was still growing last time.
+    uint32_t first = scene_manager_get_scene_state(app->scene_manager, PirateSceneSniff);
+    uint32_t count = pirate_sniffer_read_lines(app->sniffer, first, pirate_scene_sniff_line_callback, app);
+
+    if (count) {
+        scene_manager_set_scene_state(app->scene_manager, PirateSceneSniff, count - 1);
+    }
+
+    pirate_sniffer_get_stats(app->sniffer, &stats);
+    pirate_sniff_log_set_stats(app->sniff_log, &stats);
+}
+
+void pirate_scene_sniff_on_enter(void* context) {
+    PirateApp *app = (PirateApp*)context;
+
+    scene_manager_set_scene_state(app->scene_manager, PirateSceneSniff, 0);
+    pirate_sniff_log_reset(app->sniff_log);
+    view_dispatcher_switch_to_view(app->view_dispatcher, PirateSniffView);
+
+    pirate_sniffer_start(app->sniffer);
+}
+
+bool pirate_scene_sniff_on_event(void* context, SceneManagerEvent event) {
+    PirateApp *app = (PirateApp*)context;
+    bool consumed = false;
+
+    if (event.type == SceneManagerEventTypeCustom && event.event == PirateSniffUpdated) {
+        pirate_scene_sniff_update(app);
+        consumed = true;
+    }
+
+    // Back leaves the scene; capture stops as we go.
+    return consumed;
+}
+
+void pirate_scene_sniff_on_exit(void* context) {
+    PirateApp *app = (PirateApp*)context;
+    pirate_sniffer_stop(app->sniffer);
+}
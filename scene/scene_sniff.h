@@ -0,0 +1,10 @@
+#pragma once
+#include "../pirate_app.h"
+
+void pirate_scene_sniff_on_enter(void* app);
+bool pirate_scene_sniff_on_event(void* app, SceneManagerEvent event);
+void pirate_scene_sniff_on_exit(void* app);
+
+typedef enum {
+    PirateSniffUpdated = 0x500,
+} PirateSniffEvent;
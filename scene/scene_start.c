@@ -8,6 +8,36 @@ void pirate_scene_start_submenu_callback(void* context, uint32_t index) {
         case I2CMenuItem:
             scene_manager_handle_custom_event(app->scene_manager, I2CCommandEvent);
             break;
+        case EepromDumpMenuItem:
+            scene_manager_handle_custom_event(app->scene_manager, EepromDumpCommandEvent);
+            break;
+        case ScanMenuItem:
+            scene_manager_handle_custom_event(app->scene_manager, ScanCommandEvent);
+            break;
+        case ScriptMenuItem:
+            scene_manager_handle_custom_event(app->scene_manager, ScriptCommandEvent);
+            break;
+        case SniffMenuItem:
+            scene_manager_handle_custom_event(app->scene_manager, SniffCommandEvent);
+            break;
+        case SPIMenuItem:
+            scene_manager_handle_custom_event(app->scene_manager, SPICommandEvent);
+            break;
+        case BridgeMenuItem:
+            scene_manager_handle_custom_event(app->scene_manager, BridgeCommandEvent);
+            break;
+        case BbioMenuItem:
+            scene_manager_handle_custom_event(app->scene_manager, BbioCommandEvent);
+            break;
+        case OneWireMenuItem:
+            scene_manager_handle_custom_event(app->scene_manager, OneWireCommandEvent);
+            break;
+        case OneWireSearchMenuItem:
+            scene_manager_handle_custom_event(app->scene_manager, OneWireSearchCommandEvent);
+            break;
+        case MemoryMenuItem:
+            scene_manager_handle_custom_event(app->scene_manager, MemoryCommandEvent);
+            break;
     }
 }
 
@@ -18,6 +48,16 @@ void pirate_scene_start_on_enter(void *context) {
     submenu_set_header(app->submenu, "Flipper Pirate");
 
     submenu_add_item(app->submenu, "I2C Command", I2CMenuItem, pirate_scene_start_submenu_callback, app);
+    submenu_add_item(app->submenu, "I2C EEPROM Dump", EepromDumpMenuItem, pirate_scene_start_submenu_callback, app);
+    submenu_add_item(app->submenu, "I2C Scan", ScanMenuItem, pirate_scene_start_submenu_callback, app);
+    submenu_add_item(app->submenu, "Run Script", ScriptMenuItem, pirate_scene_start_submenu_callback, app);
+    submenu_add_item(app->submenu, "I2C Sniffer", SniffMenuItem, pirate_scene_start_submenu_callback, app);
+    submenu_add_item(app->submenu, "SPI Command", SPIMenuItem, pirate_scene_start_submenu_callback, app);
+    submenu_add_item(app->submenu, "USB-UART Bridge", BridgeMenuItem, pirate_scene_start_submenu_callback, app);
+    submenu_add_item(app->submenu, "Bus Pirate BBIO (USB)", BbioMenuItem, pirate_scene_start_submenu_callback, app);
+    submenu_add_item(app->submenu, "1-Wire Command", OneWireMenuItem, pirate_scene_start_submenu_callback, app);
+    submenu_add_item(app->submenu, "1-Wire Search", OneWireSearchMenuItem, pirate_scene_start_submenu_callback, app);
+    submenu_add_item(app->submenu, "Memory Usage", MemoryMenuItem, pirate_scene_start_submenu_callback, app);
     view_dispatcher_switch_to_view(app->view_dispatcher, PirateSubmenuView);
 }
 
@@ -47,6 +87,77 @@ bool pirate_scene_start_on_event(void* context, SceneManagerEvent event) {
                     scene_manager_next_scene(app->scene_manager, PirateSceneCommand);
                     consumed = true;
                     break;
+
+                case EepromDumpMenuItem:
+                    app->operation = EepromDumpOperation;
+                    scene_manager_next_scene(app->scene_manager, PirateSceneEeprom);
+                    consumed = true;
+                    break;
+
+                case ScanMenuItem:
+                    app->operation = ScanOperation;
+                    scene_manager_next_scene(app->scene_manager, PirateSceneScan);
+                    consumed = true;
+                    break;
+
+                case ScriptMenuItem:
+                    app->operation = ScriptOperation;
+                    scene_manager_next_scene(app->scene_manager, PirateSceneScript);
+                    consumed = true;
+                    break;
+
+                case SniffMenuItem:
+                    app->operation = SniffOperation;
+                    scene_manager_next_scene(app->scene_manager, PirateSceneSniff);
+                    consumed = true;
+                    break;
+
+                case SPIMenuItem:
+
+                    // SPI commands share the command editor; but an I2C command makes no sense here.
+                    if (app->operation != SPIOperation) {
+                        pirate_reset_command(app);
+                        app->operation = SPIOperation;
+                    }
+
+                    scene_manager_next_scene(app->scene_manager, PirateSceneCommand);
+                    consumed = true;
+                    break;
+
+                case BridgeMenuItem:
+                    app->operation = BridgeOperation;
+                    scene_manager_next_scene(app->scene_manager, PirateSceneBridge);
+                    consumed = true;
+                    break;
+
+                case BbioMenuItem:
+                    app->operation = BbioOperation;
+                    scene_manager_next_scene(app->scene_manager, PirateSceneBbio);
+                    consumed = true;
+                    break;
+
+                case OneWireMenuItem:
+                    if (app->operation != OneWireOperation) {
+                        pirate_reset_command(app);
+                        app->operation = OneWireOperation;
+                    }
+
+                    scene_manager_next_scene(app->scene_manager, PirateSceneCommand);
+                    consumed = true;
+                    break;
+
+                case OneWireSearchMenuItem:
+                    app->operation = OneWireSearchOperation;
+                    scene_manager_next_scene(app->scene_manager, PirateSceneOneWire);
+                    consumed = true;
+                    break;
+
+                case MemoryMenuItem:
+
+                    // Just a look at our own footprint; whatever we were doing is left as it was.
+                    scene_manager_next_scene(app->scene_manager, PirateSceneMemory);
+                    consumed = true;
+                    break;
             }
 
         default:
@@ -7,10 +7,30 @@ void pirate_scene_start_on_exit(void* app);
 
 typedef enum {
     I2CCommandEvent,
+    EepromDumpCommandEvent,
+    ScanCommandEvent,
+    ScriptCommandEvent,
+    SniffCommandEvent,
+    SPICommandEvent,
+    BridgeCommandEvent,
+    BbioCommandEvent,
+    OneWireCommandEvent,
+    OneWireSearchCommandEvent,
+    MemoryCommandEvent,
 } PirateCommandEvent;
 
 
 typedef enum {
     I2CMenuItem,
+    EepromDumpMenuItem,
+    ScanMenuItem,
+    ScriptMenuItem,
+    SniffMenuItem,
+    SPIMenuItem,
+    BridgeMenuItem,
+    BbioMenuItem,
+    OneWireMenuItem,
+    OneWireSearchMenuItem,
+    MemoryMenuItem,
 } PirateCommandMenuItem;
 
@@ -16,22 +16,62 @@
 
 #include "scene_start.h"
 #include "scene_command.h"
+#include "scene_result.h"
+#include "scene_eeprom.h"
+#include "scene_scan.h"
+#include "scene_script.h"
+#include "scene_sniff.h"
+#include "scene_bridge.h"
+#include "scene_bbio.h"
+#include "scene_onewire.h"
+#include "scene_hex_dump.h"
+#include "scene_memory.h"
 
 
 /** collection of all scene on_enter handlers, indexed by scene number */
 void (*const pirate_scene_on_enter_handlers[])(void*) = {
     pirate_scene_start_on_enter,
-    pirate_scene_command_on_enter};
+    pirate_scene_command_on_enter,
+    pirate_scene_result_on_enter,
+    pirate_scene_eeprom_on_enter,
+    pirate_scene_scan_on_enter,
+    pirate_scene_script_on_enter,
+    pirate_scene_sniff_on_enter,
+    pirate_scene_bridge_on_enter,
+    pirate_scene_bbio_on_enter,
+    pirate_scene_onewire_on_enter,
+    pirate_scene_hex_dump_on_enter,
+    pirate_scene_memory_on_enter};
 
 /** collection of all scene on event handlers */
 bool (*const pirate_scene_on_event_handlers[])(void*, SceneManagerEvent) = {
     pirate_scene_start_on_event,
-    pirate_scene_command_on_event};
+    pirate_scene_command_on_event,
+    pirate_scene_result_on_event,
+    pirate_scene_eeprom_on_event,
+    pirate_scene_scan_on_event,
+    pirate_scene_script_on_event,
+    pirate_scene_sniff_on_event,
+    pirate_scene_bridge_on_event,
+    pirate_scene_bbio_on_event,
+    pirate_scene_onewire_on_event,
+    pirate_scene_hex_dump_on_event,
+    pirate_scene_memory_on_event};
 
 /** collection of all scene on exit handlers */
 void (*const pirate_scene_on_exit_handlers[])(void*) = {
     pirate_scene_start_on_exit,
-    pirate_scene_command_on_exit};
+    pirate_scene_command_on_exit,
+    pirate_scene_result_on_exit,
+    pirate_scene_eeprom_on_exit,
+    pirate_scene_scan_on_exit,
+    pirate_scene_script_on_exit,
+    pirate_scene_sniff_on_exit,
+    pirate_scene_bridge_on_exit,
+    pirate_scene_bbio_on_exit,
+    pirate_scene_onewire_on_exit,
+    pirate_scene_hex_dump_on_exit,
+    pirate_scene_memory_on_exit};
 
 
 const SceneManagerHandlers pirate_scene_manager_handlers = {
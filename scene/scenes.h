@@ -10,6 +10,16 @@
 typedef enum {
     PirateSceneStart,
     PirateSceneCommand,
+    PirateSceneResult,
+    PirateSceneEeprom,
+    PirateSceneScan,
+    PirateSceneScript,
+    PirateSceneSniff,
+    PirateSceneBridge,
+    PirateSceneBbio,
+    PirateSceneOneWire,
+    PirateSceneHexDump,
+    PirateSceneMemory,
 
     PIRATE_SCENE_COUNT
 } PirateScene;
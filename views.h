@@ -8,7 +8,12 @@
 /** List of views we support. */
 typedef enum {
     PirateSubmenuView,
-    PirateInputView
+    PirateInputView,
+    PirateWidgetView,
+    PirateScanView,
+    PirateSniffView,
+    PirateBridgeView,
+    PirateHexDumpView
 } PirateView;
 
 #endif //UNLEASHED_FIRMWARE_VIEWS_H